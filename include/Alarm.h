@@ -2,6 +2,7 @@
 #include <Arduino.h>
 #include <RTClib.h>
 #include "TimeManager.h"
+#include "Buzzer.h"
 
 // Bitmask for days of the week
 const uint8_t DAY_SUN = 1 << 0;
@@ -77,6 +78,12 @@ public:
    */
   uint8_t getLastDismissedDay() const { return _lastDismissedDay; }
 
+  /**
+   * @brief Gets the beep pattern the alarm rings with before the continuous stage.
+   * @return The pattern; one with no steps means the standard slow/fast ramp.
+   */
+  const BuzzerPattern &getBuzzerPattern() const { return _pattern; }
+
   /**
    * @brief Sets the unique identifier of the alarm.
    * @param id The new ID for the alarm.
@@ -132,6 +139,12 @@ public:
    */
   void setLastDismissedDay(uint8_t day) { _lastDismissedDay = day; }
 
+  /**
+   * @brief Sets the beep pattern the alarm rings with.
+   * @param pattern The pattern, or one with no steps for the standard ramp.
+   */
+  void setBuzzerPattern(const BuzzerPattern &pattern) { _pattern = pattern; }
+
   /**
    * @brief Snoozes the alarm for a user-defined duration.
    * @param snoozeMinutes The duration in minutes to snooze for.
@@ -217,4 +230,5 @@ private:
   bool _snoozed = false;
   uint32_t _snoozeUntil = 0;     // Unix timestamp for reboot resilience
   uint8_t _lastDismissedDay = 8; // 8 is an invalid day to ensure it can ring on first boot
+  BuzzerPattern _pattern;        // No steps = the standard ramp
 };
@@ -5,15 +5,18 @@
 #include <Arduino.h>
 #include "Alarm.h"
 #include "TimeManager.h"
+#include "Buzzer.h"
 #include <freertos/semphr.h>
 
 /**
  * @class AlarmManager
  * @brief Manages the physical ringing of an alarm (buzzer and display).
  *
- * This singleton class is a simple "ringer" service. It controls the buzzer,
- * coordinates with the DisplayManager to show the ringing screen, and keeps
- * track of the currently active alarm. The logic for snoozing and dismissing
+ * This singleton class is a simple "ringer" service. It steps the buzzer
+ * through the ramp stages, coordinates with the DisplayManager to show the
+ * ringing screen, and keeps track of the currently active alarm. The beeps
+ * themselves are timed by the Buzzer, so only stage changes depend on
+ * `update()` being called. The logic for snoozing and dismissing
  * is handled by the Alarm class itself.
  */
 class AlarmManager
@@ -83,18 +86,18 @@ private:
     STAGE_CONTINUOUS
   };
 
-  enum BuzzerState
-  {
-    BEEP_OFF,
-    BEEP_ON
-  };
+  /**
+   * @brief Starts the buzzer on the current ramp stage.
+   *
+   * The slow and fast stages play the alarm's own pattern if it has one.
+   */
+  void startStage();
 
   bool _isRinging;
   int _activeAlarmId;
   RampStage _rampStage;
-  BuzzerState _buzzerState;
   uint32_t _alarmStartTimestamp; // Unix timestamp
-  unsigned long _lastBeepTime;
+  BuzzerPattern _pattern;        // The ringing alarm's pattern; no steps = the standard ramp
 
   // --- Deferred Resume Logic ---
   bool _resumeAlarmOnBoot = false;
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Alarm;
+
+// Structure to hold an alarm's next occurrence time and its ID
+struct NextAlarmTime
+{
+  DateTime time;
+  uint8_t id;
+
+  bool operator<(const NextAlarmTime &other) const
+  {
+    return time < other.time;
+  }
+};
+
+/**
+ * @class AlarmSchedule
+ * @brief The next ring time of every enabled alarm, kept sorted soonest first.
+ *
+ * Rather than recomputing every alarm each minute, the schedule keeps the
+ * schedule-relevant part of each alarm as last seen. `sync()` diffs a new
+ * alarm table against it and re-places only the alarms that were added,
+ * edited, snoozed or removed, and `advance()` only re-places the entries at
+ * the front whose time has come. The soonest alarms are therefore always at
+ * the start, so reading the next one or two costs nothing.
+ *
+ * The schedule is not locked; its owner serialises access.
+ */
+class AlarmSchedule
+{
+public:
+  /// @brief The part of an alarm that decides when it rings next.
+  struct Rule
+  {
+    uint8_t id;
+    bool enabled;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t days;
+    bool snoozed;
+    uint32_t snoozeUntil;
+
+    bool operator==(const Rule &other) const
+    {
+      return id == other.id && enabled == other.enabled && hour == other.hour && minute == other.minute &&
+             days == other.days && snoozed == other.snoozed && snoozeUntil == other.snoozeUntil;
+    }
+    bool operator!=(const Rule &other) const { return !(*this == other); }
+  };
+
+  /**
+   * @brief Takes the schedule-relevant fields of an alarm.
+   * @param alarm The alarm.
+   * @return Its rule.
+   */
+  static Rule ruleFor(const Alarm &alarm);
+
+  /**
+   * @brief Works out when a rule rings next after `now`.
+   *
+   * A snoozed alarm rings when its snooze ends; otherwise it rings at its
+   * hour and minute on the first matching day, today only if that minute is
+   * still to come.
+   * @param rule The rule.
+   * @param now The current time.
+   * @param time Set to the next ring time, if there is one.
+   * @return False if the rule is disabled or never rings.
+   */
+  static bool nextRingTime(const Rule &rule, const DateTime &now, DateTime &time);
+
+  /**
+   * @brief Brings the schedule up to date with an alarm table.
+   *
+   * Only alarms whose rule differs from the last sync are re-placed, then
+   * the schedule is advanced to `now`.
+   * @param alarms The current alarms.
+   * @param now The current time.
+   */
+  void sync(const std::vector<Alarm> &alarms, const DateTime &now);
+
+  /**
+   * @brief Re-places the alarms whose ring time is no longer in the future.
+   *
+   * If the clock has gone backwards since the last call, every alarm is
+   * re-placed instead.
+   * @param now The current time.
+   */
+  void advance(const DateTime &now);
+
+  /**
+   * @brief Re-places every alarm.
+   * @param now The current time.
+   */
+  void rebuild(const DateTime &now);
+
+  /**
+   * @brief Copies the soonest alarms.
+   * @param count The most to copy.
+   * @return Up to `count` alarms, soonest first.
+   */
+  std::vector<NextAlarmTime> next(size_t count) const;
+
+  /**
+   * @brief Counts the alarms that have a next ring time.
+   * @return The number of scheduled alarms.
+   */
+  size_t size() const { return _order.size(); }
+
+private:
+  /**
+   * @brief Inserts an enabled rule at its next ring time, if it has one.
+   */
+  void place(const Rule &rule, const DateTime &now);
+
+  /**
+   * @brief Removes an alarm's entry, if it has one.
+   */
+  void unplace(uint8_t id);
+
+  std::vector<Rule> _rules;          ///< Every alarm as of the last sync, by ID.
+  std::vector<NextAlarmTime> _order; ///< Scheduled alarms, soonest first.
+  uint32_t _evaluatedAt = 0;         ///< Unix time of the last advance.
+};
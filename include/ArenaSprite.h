@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class SpriteArena
+ * @brief A preallocated PSRAM block that long-lived sprites are carved from.
+ *
+ * Allocation is a simple bump of an offset, and memory is never returned to
+ * the arena. Page sprites are created once and kept for the lifetime of the
+ * firmware, so page entry never touches the heap allocator.
+ */
+class SpriteArena
+{
+public:
+  /**
+   * @brief Reserves the arena's memory.
+   * @param size The size of the arena in bytes.
+   * @return True if the memory was reserved.
+   */
+  bool begin(size_t size);
+
+  /**
+   * @brief Carves a zeroed, 4-byte aligned block out of the arena.
+   * @param bytes The number of bytes needed.
+   * @return The block, or nullptr if the arena is exhausted.
+   */
+  uint8_t *allocate(size_t bytes);
+
+  size_t used() const { return _used; }
+  size_t capacity() const { return _size; }
+
+private:
+  uint8_t *_base = nullptr;
+  size_t _size = 0;
+  size_t _used = 0;
+};
+
+/**
+ * @class ArenaSprite
+ * @brief A TFT_eSprite whose pixel buffer comes from the DisplayManager's sprite arena.
+ *
+ * At 4 bpp the sprite is palettized: drawing colors are palette indices, and
+ * the palette is generated from theme colors with `setRamp()`. TFT_eSPI's
+ * smooth-font renderer blends the foreground and background *values*, so with
+ * the paper at a low index and the ink at a high one, the blend of two
+ * indices lands on the matching step of the ramp between them and
+ * anti-aliasing keeps working.
+ *
+ * If the arena is exhausted the buffer is allocated on its own in PSRAM,
+ * with the same layout, and freed again by `deleteSprite()`. TFT_eSprite's
+ * own allocator is never used, so the palette and color depth are always
+ * the ones set here.
+ */
+class ArenaSprite : public TFT_eSprite
+{
+public:
+  static constexpr uint8_t PAPER = 0; ///< Palette index of the background for a single ramp.
+  static constexpr uint8_t INK = 15;  ///< Palette index of the foreground for a single ramp.
+
+  /**
+   * @brief Constructs a new ArenaSprite.
+   * @param tft A pointer to the TFT_eSPI driver instance.
+   * @param colorDepth The sprite's color depth (4 or 16).
+   */
+  ArenaSprite(TFT_eSPI *tft, uint8_t colorDepth = 4);
+  ~ArenaSprite();
+
+  /**
+   * @brief Creates the sprite in the arena. Hides `TFT_eSprite::createSprite()`.
+   * @param width The sprite width in pixels.
+   * @param height The sprite height in pixels.
+   * @return A pointer to the pixel buffer, or nullptr if neither the arena nor PSRAM had room.
+   */
+  void *createSprite(int16_t width, int16_t height);
+
+  /**
+   * @brief Releases the sprite. Arena memory is not reclaimed; a PSRAM fallback buffer is freed.
+   */
+  void deleteSprite();
+
+  /**
+   * @brief Fills palette entries `paper`..`ink` with a blend from one color to another.
+   * @param paper The index of the first entry (the background end of the ramp).
+   * @param ink The index of the last entry; must be greater than `paper`.
+   * @param paperColor The RGB565 color at `paper`.
+   * @param inkColor The RGB565 color at `ink`.
+   */
+  void setPaletteRamp(uint8_t paper, uint8_t ink, uint16_t paperColor, uint16_t inkColor);
+
+  /**
+   * @brief Sets a full 16-step ramp and selects it for text (INK on PAPER).
+   * @param fg The RGB565 text color.
+   * @param bg The RGB565 background color.
+   */
+  void setRamp(uint16_t fg, uint16_t bg);
+
+  bool isInArena() const { return _inArena; }
+
+private:
+  uint16_t _palette[16] = {};
+  bool _inArena = false;
+  bool _ownsBuffer = false; ///< The buffer is a PSRAM fallback of our own, not arena memory.
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+#include "JsonResponse.h"
+
+/**
+ * @class Benchmark
+ * @brief Times a piece of firmware code on the device itself.
+ *
+ * `measure()` runs an operation a fixed number of times back to back and
+ * reports its throughput and the JSON allocator blocks it took per run, so
+ * the cost of the API builders and the alarm scheduler can be compared
+ * before and after a change on the same board.
+ */
+class Benchmark
+{
+public:
+  static constexpr uint32_t DEFAULT_ITERATIONS = 50; ///< Runs per operation when none are requested.
+  static constexpr uint32_t MAX_ITERATIONS = 1000;   ///< Cap that keeps a whole suite to a few seconds.
+
+  /// @brief What one measured operation cost.
+  struct Result
+  {
+    uint32_t iterations;
+    uint32_t totalUs;   ///< Wall time for all iterations, in microseconds.
+    float opsPerSec;
+    float allocsPerOp;  ///< JsonResponse allocator calls per iteration.
+  };
+
+  /**
+   * @brief Runs an operation repeatedly and measures it.
+   * @param iterations How many times to run it.
+   * @param op The operation; called with no arguments.
+   * @return The measurement.
+   */
+  template <typename Op>
+  static Result measure(uint32_t iterations, Op op)
+  {
+    JsonResponse &json = JsonResponse::getInstance();
+    uint32_t allocsBefore = json.allocations();
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+      op();
+    }
+    Result result;
+    result.iterations = iterations;
+    result.totalUs = max<uint32_t>(micros() - start, 1);
+    result.opsPerSec = iterations * 1000000.0f / result.totalUs;
+    result.allocsPerOp = (float)(json.allocations() - allocsBefore) / iterations;
+    return result;
+  }
+};
@@ -3,16 +3,38 @@
 #define BUTTON_MANAGER_H
 
 #include <Arduino.h>
+#include <atomic>
+
+/// @brief What a button did, as decoded from its press and release edges.
+enum ButtonGestureType : uint8_t
+{
+  BUTTON_GESTURE_PRESS,   ///< The button went down.
+  BUTTON_GESTURE_HOLD,    ///< Still held, every BUTTON_HOLD_INTERVAL until released or LONG.
+  BUTTON_GESTURE_LONG,    ///< Held for the long-press time; sent once, while still held.
+  BUTTON_GESTURE_SHORT,   ///< Released before the long-press time.
+  BUTTON_GESTURE_DOUBLE,  ///< Follows a SHORT that came within BUTTON_DOUBLE_PRESS_WINDOW of the previous one.
+  BUTTON_GESTURE_RELEASE, ///< The button went up; follows any SHORT or DOUBLE.
+};
+
+/// @brief One decoded gesture.
+struct ButtonGesture
+{
+  ButtonGestureType type;
+  unsigned long heldMs; ///< Time since the press; the whole press for SHORT, DOUBLE and RELEASE.
+};
 
 /**
  * @class ButtonManager
  * @brief Manages a physical button using interrupts to detect presses and their duration.
  *
- * This class encapsulates the logic for a hardware button, including debouncing
- * and interrupt handling. It is designed to be used with a button connected to
- * a GPIO pin, configured with an internal pull-up. The manager can be attached
- * or detached at runtime, allowing the button's function to be enabled or
- * disabled as needed.
+ * The ISR debounces the pin and pushes timestamped press and release edges
+ * into a lock-free single-producer, single-consumer ring, then wakes the
+ * consumer task. The consumer drains the ring with `nextGesture()`, which
+ * decodes the edges into short, long, double and hold-progress gestures,
+ * so no edge is lost or coalesced between two of its passes. It is designed
+ * to be used with a button connected to a GPIO pin, configured with an
+ * internal pull-up. The manager can be attached or detached at runtime,
+ * allowing the button's function to be enabled or disabled as needed.
  */
 class ButtonManager
 {
@@ -39,34 +61,69 @@ public:
   void detach();
 
   /**
-   * @brief Gets the duration of the last button press.
-   * @return The duration in milliseconds.
+   * @brief Sets how long a press must be held to count as LONG.
+   * @param ms The hold time, or 0 to report every press as SHORT however long it is.
    */
-  unsigned long getPressDuration();
+  void setLongPressTime(unsigned long ms);
 
   /**
-   * @brief Checks if a new button press has been detected since the last check.
-   * @return True if a new press is available, false otherwise.
+   * @brief Gets the next gesture, decoding queued edges as needed.
+   *
+   * Call from the consumer task only, until it returns false.
+   * @param now The current millis(), for HOLD and LONG while the button is held.
+   * @param gesture Receives the gesture.
+   * @return False once there is nothing more to report.
    */
-  bool newPressAvailable();
+  bool nextGesture(unsigned long now, ButtonGesture &gesture);
 
   /**
-   * @brief Clears the flag indicating a new press is available.
+   * @brief Sets a task to notify from the ISR whenever the button goes down or up.
+   * @param task The task to wake with `vTaskNotifyGiveFromISR()`, or NULL for none.
    */
-  void clearNewPress();
+  void setNotifyTask(TaskHandle_t task);
 
 private:
+  static constexpr uint32_t EDGE_QUEUE_SIZE = 16; ///< Edges the ISR can queue; a power of two.
+
+  /// @brief One debounced change of the pin.
+  struct Edge
+  {
+    uint32_t atMs;
+    bool pressed;
+  };
+
   /**
    * @brief The Interrupt Service Routine (ISR) that handles button press events.
    * @param arg A pointer to the ButtonManager instance.
    */
   static void IRAM_ATTR handleInterrupt(void *arg);
+
+  bool popEdge(Edge &edge);
+  void decode(const Edge &edge);
+  void emit(ButtonGestureType type, unsigned long heldMs);
+
   int _pin;
-  volatile unsigned long _pressDuration;
-  volatile bool _newPress;
+
+  // Shared with the ISR.
+  Edge _edges[EDGE_QUEUE_SIZE];
+  std::atomic<uint32_t> _edgeHead{0}; ///< Edges pushed; written by the ISR.
+  std::atomic<uint32_t> _edgeTail{0}; ///< Edges popped; written by the consumer.
   unsigned long _lastInterruptTime;
-  unsigned long _buttonPressTime;
+  TaskHandle_t _notifyTask = NULL;
   portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+  // Decoder state, used by the consumer only.
+  unsigned long _longPressMs = 0;
+  bool _holding = false;
+  bool _longSent = false;
+  bool _shortPending = false; ///< The last press was SHORT, so the next may be DOUBLE.
+  unsigned long _pressedAt = 0;
+  unsigned long _lastEdgeAt = 0;
+  unsigned long _lastHoldAt = 0;
+  unsigned long _lastShortAt = 0;
+  ButtonGesture _gestures[3];  ///< Decoded but not yet returned; a release makes up to three.
+  uint8_t _gestureCount = 0;
+  uint8_t _gestureNext = 0;
 };
 
 #endif // BUTTON_MANAGER_H
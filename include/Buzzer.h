@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <cstdint>
+
+/// @brief A repeating beep rhythm: alternating on and off times, starting with on.
+struct BuzzerPattern
+{
+  static constexpr uint8_t MAX_STEPS = 8;       ///< Most on/off steps a pattern can hold.
+  static constexpr uint16_t MIN_STEP_MS = 10;   ///< Shortest step accepted.
+  static constexpr uint16_t MAX_STEP_MS = 10000; ///< Longest step accepted.
+
+  uint8_t count = 0;                ///< Steps used; an even number, or 0 for no pattern.
+  uint16_t stepsMs[MAX_STEPS] = {}; ///< Step durations in milliseconds, on first.
+
+  /**
+   * @brief Checks that the pattern can be played.
+   * @return True if the step count is even and every step is within range.
+   */
+  bool isValid() const
+  {
+    if (count == 0 || count > MAX_STEPS || count % 2 != 0)
+    {
+      return false;
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+      if (stepsMs[i] < MIN_STEP_MS || stepsMs[i] > MAX_STEP_MS)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator==(const BuzzerPattern &other) const
+  {
+    if (count != other.count)
+    {
+      return false;
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+      if (stepsMs[i] != other.stepsMs[i])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool operator!=(const BuzzerPattern &other) const { return !(*this == other); }
+};
+
+/**
+ * @class Buzzer
+ * @brief Plays beep patterns on the active buzzer from a one-shot esp_timer.
+ *
+ * Each step re-arms the timer for the next edge, aimed at an absolute time
+ * so dispatch delays don't add up, and the pin is switched in the timer's
+ * callback. Beep timing is therefore independent of the main loop and of
+ * render stalls, and costs a few microseconds per edge.
+ */
+class Buzzer
+{
+public:
+  /**
+   * @brief Gets the singleton instance of the Buzzer.
+   * @return A reference to the Buzzer instance.
+   */
+  static Buzzer &getInstance()
+  {
+    static Buzzer instance;
+    return instance;
+  }
+
+  /**
+   * @brief Sets up the buzzer pin, off, and creates the timer.
+   */
+  void begin();
+
+  /**
+   * @brief Starts repeating a pattern from its first on step.
+   * @param pattern The pattern; an invalid one turns the buzzer off.
+   */
+  void play(const BuzzerPattern &pattern);
+
+  /**
+   * @brief Turns the buzzer on until `stop()` or `play()`.
+   */
+  void on();
+
+  /**
+   * @brief Turns the buzzer off and stops any pattern.
+   */
+  void stop();
+
+  Buzzer(const Buzzer &) = delete;
+  Buzzer &operator=(const Buzzer &) = delete;
+
+private:
+  Buzzer() = default;
+
+  /**
+   * @brief Switches the pin for the current step and arms the timer for the next one.
+   * Must be called inside the critical section.
+   */
+  void startStep();
+
+  /**
+   * @brief The timer callback; moves on to the next step.
+   * @param arg The Buzzer instance.
+   */
+  static void onTimer(void *arg);
+
+  esp_timer_handle_t _timer = nullptr;
+  BuzzerPattern _pattern;
+  uint8_t _step = 0;
+  int64_t _stepEndMicros = 0; ///< esp_timer_get_time() when the current step ends.
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
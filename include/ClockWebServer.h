@@ -6,6 +6,8 @@
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
 #include <ESPmDNS.h>
+#include "Constants.h"
+#include "WebAsset.h"
 
 /**
  * @class ClockWebServer
@@ -46,6 +48,14 @@ public:
    */
   void setupMDNS();
 
+  /**
+   * @brief Pushes changed device state to `/api/events` subscribers.
+   *
+   * Call this regularly from one task. It is rate-limited internally and
+   * does nothing while no client is subscribed.
+   */
+  void publishEvents();
+
   // Delete copy constructor and assignment operator.
   ClockWebServer(const ClockWebServer &) = delete;
   void operator=(const ClockWebServer &) = delete;
@@ -134,8 +144,40 @@ private:
    */
   String settingsProcessor(const String &var);
 
+  /**
+   * @brief Sends a pre-compressed asset, or 304 if the client's copy is current.
+   * @param request The incoming web request.
+   * @param asset The asset to send.
+   */
+  void sendAsset(AsyncWebServerRequest *request, const WebAsset &asset);
+
+  /**
+   * @brief Streams a precompiled page template as a chunked response.
+   * @param request The incoming web request.
+   * @param page The page's segment table.
+   * @param resolve Returns the value of a placeholder.
+   */
+  void sendTemplate(AsyncWebServerRequest *request, const PageTemplate &page, AwsTemplateProcessor resolve);
+
+  /**
+   * @brief Registers a route behind admission control and latency tracking.
+   *
+   * Takes the same arguments as `AsyncWebServer::on()`.
+   */
+  void route(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+             ArUploadHandlerFunction onUpload = nullptr, ArBodyHandlerFunction onBody = nullptr);
+
   /// The actual server instance.
   AsyncWebServer server;
+  /// Server-sent events channel for live device state.
+  AsyncEventSource events;
+
+  static constexpr int EVENT_TOPIC_COUNT = 5; ///< Number of topics pushed on `events`.
+  uint64_t _eventKeys[EVENT_TOPIC_COUNT] = {}; ///< Generation key each topic was last pushed at.
+  uint32_t _eventId = 0;                       ///< ID of the last event sent.
+  unsigned long _lastEventPoll = 0;
+  volatile bool _eventsResync = false; ///< Set when a client connects, so every topic is re-sent.
+  char _eventBuffer[EVENTS_BUFFER_SIZE];
   /// Flag indicating if the server is in captive portal mode.
   bool _captivePortalActive;
 };
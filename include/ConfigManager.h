@@ -4,14 +4,17 @@
 
 #include <Arduino.h>
 #include "Alarm.h"
+#include "LogLevel.h"
 #include <Preferences.h>
 #include <vector>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
 const int LEGACY_ALARMS_COUNT = 5;  // Default number of alarms for legacy data migration
 const int DEFAULT_ALARMS_COUNT = 2; // Default number of alarms for new installs/resets
 const int MAX_ALLOWED_ALARMS = 20;  // Maximum number of alarms allowed
+const int CONFIG_SNAPSHOT_SLOTS = 4; // Published settings snapshots kept for lock-free readers
 
 // Default Colors
 static constexpr const char *DEFAULT_BACKGROUND_COLOR = "#000000";
@@ -56,9 +59,238 @@ static constexpr const char *DEFAULT_ADDRESS = "";
 static constexpr int DEFAULT_DEFAULT_PAGE = 0;
 static constexpr float DEFAULT_LAT = 0.0;
 static constexpr float DEFAULT_LON = 0.0;
-// 0: Clock, 1: Weather, 2: Info, 3: Weather+Clock
+// 0: Clock, 1: Weather, 2: Info, 3: Weather+Clock, 4: Forecast
 // Using a C-style array for default initializer which can be easily converted to vector
-static constexpr int DEFAULT_ENABLED_PAGES[] = {0, 1, 3, 2};
+static constexpr int DEFAULT_ENABLED_PAGES[] = {0, 1, 4, 3, 2};
+
+/**
+ * @brief A persisted setting, as tracked by the save mask.
+ *
+ * Each field is one Preferences key, except CONFIG_FIELD_RINGING_ALARM (the
+ * ringing alarm's id and start time) and CONFIG_FIELD_ALARMS (the alarm table,
+ * which is diffed per key when saved).
+ */
+enum ConfigField
+{
+  CONFIG_FIELD_WIFI_SSID,
+  CONFIG_FIELD_WIFI_PASSWORD,
+  CONFIG_FIELD_HOSTNAME,
+  CONFIG_FIELD_WIFI_CREDS_VALID,
+  CONFIG_FIELD_RINGING_ALARM,
+  CONFIG_FIELD_AUTO_BRIGHTNESS,
+  CONFIG_FIELD_BRIGHTNESS,
+  CONFIG_FIELD_AUTO_BRIGHTNESS_START_HOUR,
+  CONFIG_FIELD_AUTO_BRIGHTNESS_END_HOUR,
+  CONFIG_FIELD_DAY_BRIGHTNESS,
+  CONFIG_FIELD_NIGHT_BRIGHTNESS,
+  CONFIG_FIELD_USE_24_HOUR_FORMAT,
+  CONFIG_FIELD_USE_CELSIUS,
+  CONFIG_FIELD_SCREEN_FLIPPED,
+  CONFIG_FIELD_INVERT_COLORS,
+  CONFIG_FIELD_TIMEZONE,
+  CONFIG_FIELD_IS_DST,
+  CONFIG_FIELD_SNOOZE_DURATION,
+  CONFIG_FIELD_DISMISS_DURATION,
+  CONFIG_FIELD_TEMP_CORRECTION_ENABLED,
+  CONFIG_FIELD_TEMP_CORRECTION,
+  CONFIG_FIELD_LOG_LEVELS,
+  CONFIG_FIELD_ADDRESS,
+  CONFIG_FIELD_ENABLED_PAGES,
+  CONFIG_FIELD_DEFAULT_PAGE,
+  CONFIG_FIELD_LAT,
+  CONFIG_FIELD_LON,
+  CONFIG_FIELD_BACKGROUND_COLOR,
+  CONFIG_FIELD_TIME_COLOR,
+  CONFIG_FIELD_TOD_COLOR,
+  CONFIG_FIELD_SECONDS_COLOR,
+  CONFIG_FIELD_DAY_OF_WEEK_COLOR,
+  CONFIG_FIELD_DATE_COLOR,
+  CONFIG_FIELD_TEMP_COLOR,
+  CONFIG_FIELD_HUMIDITY_COLOR,
+  CONFIG_FIELD_ALARM_ICON_COLOR,
+  CONFIG_FIELD_SNOOZE_ICON_COLOR,
+  CONFIG_FIELD_ALARM_TEXT_COLOR,
+  CONFIG_FIELD_ERROR_TEXT_COLOR,
+  CONFIG_FIELD_WEATHER_TEMP_COLOR,
+  CONFIG_FIELD_WEATHER_FORECAST_COLOR,
+  CONFIG_FIELD_ALARMS,
+  CONFIG_FIELD_COUNT
+};
+
+static_assert(CONFIG_FIELD_COUNT <= 64, "The save mask holds at most 64 fields");
+
+/**
+ * @brief What a settings change affects, as bits of a change mask.
+ *
+ * Every ConfigField belongs to exactly one category, so a subsystem can ask
+ * only about the changes it has to act on.
+ */
+enum ConfigChange
+{
+  CONFIG_CHANGE_THEME = 1 << 0,            ///< Display colors.
+  CONFIG_CHANGE_LAYOUT = 1 << 1,           ///< Enabled pages, default page, screen flip and inversion.
+  CONFIG_CHANGE_FORMAT = 1 << 2,           ///< 12/24-hour clock and temperature unit.
+  CONFIG_CHANGE_TIMEZONE = 1 << 3,         ///< Timezone and the DST flag.
+  CONFIG_CHANGE_ALARMS = 1 << 4,           ///< The alarm table.
+  CONFIG_CHANGE_BRIGHTNESS = 1 << 5,       ///< Manual and automatic brightness.
+  CONFIG_CHANGE_NETWORK = 1 << 6,          ///< WiFi credentials and hostname.
+  CONFIG_CHANGE_WEATHER_LOCATION = 1 << 7, ///< Address and coordinates.
+  CONFIG_CHANGE_OTHER = 1 << 8,            ///< Everything read only when used: durations, correction, log levels.
+  CONFIG_CHANGE_ALL = (1 << 9) - 1
+};
+
+const int CONFIG_CHANGE_COUNT = 9; // Categories in ConfigChange
+
+/**
+ * @struct ConfigChangeCursor
+ * @brief One subscriber's view of which changes it has already handled.
+ *
+ * Each subscriber keeps its own cursor, so several of them can follow the
+ * same change without clearing it for the others.
+ */
+struct ConfigChangeCursor
+{
+  uint32_t seen[CONFIG_CHANGE_COUNT] = {}; ///< The change count of each category when last polled.
+};
+
+/**
+ * @struct ConfigSaveStats
+ * @brief Cost of the saves made since boot.
+ */
+struct ConfigSaveStats
+{
+  uint32_t saves;          ///< Calls to save() that wrote anything.
+  uint32_t totalWrites;    ///< Preferences writes and removals made by those saves.
+  uint32_t lastWrites;     ///< Writes made by the last save.
+  uint32_t lastDurationUs; ///< How long the last save took.
+  uint32_t maxDurationUs;  ///< The slowest save.
+};
+
+/**
+ * @brief Where the settings were loaded from at boot.
+ */
+enum ConfigLoadSource
+{
+  CONFIG_LOAD_DEFAULTS, ///< First boot: nothing stored yet.
+  CONFIG_LOAD_BLOB,     ///< The settings blob.
+  CONFIG_LOAD_KEYS      ///< The per-key format of earlier firmware, migrated to the blob.
+};
+
+/**
+ * @struct ConfigLoadStats
+ * @brief Cost of the boot-time settings load.
+ */
+struct ConfigLoadStats
+{
+  uint32_t durationUs;     ///< How long load() took, alarms included.
+  ConfigLoadSource source; ///< Where the settings came from.
+};
+
+/**
+ * @struct AlarmSummary
+ * @brief Facts about the alarm table, kept up to date as it changes.
+ */
+struct AlarmSummary
+{
+  uint32_t generation;          ///< The getAlarmGeneration() value this summary describes.
+  bool anyEnabled;              ///< At least one alarm is enabled.
+  bool anySnoozed;              ///< At least one alarm is snoozed, enabled or not.
+  bool anyEnabledSnoozed;       ///< At least one enabled alarm is snoozed.
+  uint32_t earliestSnoozeUntil; ///< The soonest snooze end, or 0 if nothing is snoozed.
+};
+
+/**
+ * @struct Theme
+ * @brief The display colors, already converted from hex strings to RGB565.
+ */
+struct Theme
+{
+  uint16_t background;
+  uint16_t time;
+  uint16_t tod;
+  uint16_t seconds;
+  uint16_t dayOfWeek;
+  uint16_t date;
+  uint16_t temp;
+  uint16_t humidity;
+  uint16_t alarmIcon;
+  uint16_t snoozeIcon;
+  uint16_t alarmText;
+  uint16_t errorText;
+  uint16_t weatherTemp;
+  uint16_t weatherForecast;
+};
+
+/**
+ * @struct ConfigSnapshot
+ * @brief An immutable copy of the settings read while drawing and sampling.
+ *
+ * Published by ConfigManager whenever one of these settings changes, and read
+ * through ConfigSnapshotRef without taking the settings lock or copying
+ * Strings. Text settings are truncated to fit their arrays.
+ */
+struct ConfigSnapshot
+{
+  bool autoBrightness;
+  uint8_t brightness;
+  uint8_t autoBrightnessStartHour;
+  uint8_t autoBrightnessEndHour;
+  uint8_t dayBrightness;
+  uint8_t nightBrightness;
+  bool use24HourFormat;
+  bool useCelsius;
+  bool screenFlipped;
+  bool invertColors;
+  bool isDst;
+  bool tempCorrectionEnabled;
+  float tempCorrection;
+  uint8_t snoozeDuration;
+  uint8_t dismissDuration;
+  int defaultPage;
+  float lat;
+  float lon;
+  Theme theme;
+  uint32_t themeGeneration; ///< The getThemeGeneration() value `theme` was built at.
+  char timezone[64];
+  char address[128];
+};
+
+/**
+ * @class ConfigSnapshotRef
+ * @brief Holds a published ConfigSnapshot so it is not reused while being read.
+ *
+ * Keep one for the length of a frame or a calculation, not across frames:
+ * while held, the snapshot's slot cannot carry a newer publication.
+ */
+class ConfigSnapshotRef
+{
+public:
+  /// @brief One slot of the ConfigManager's snapshot ring.
+  struct Slot
+  {
+    ConfigSnapshot snapshot;
+    std::atomic<uint32_t> readers{0}; ///< ConfigSnapshotRefs currently holding the slot.
+  };
+
+  explicit ConfigSnapshotRef(Slot *slot) : _slot(slot) {}
+  ConfigSnapshotRef(ConfigSnapshotRef &&other) : _slot(other._slot) { other._slot = nullptr; }
+  ~ConfigSnapshotRef()
+  {
+    if (_slot != nullptr)
+    {
+      _slot->readers.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  const ConfigSnapshot &operator*() const { return _slot->snapshot; }
+  const ConfigSnapshot *operator->() const { return &_slot->snapshot; }
+
+  ConfigSnapshotRef(const ConfigSnapshotRef &) = delete;
+  ConfigSnapshotRef &operator=(const ConfigSnapshotRef &) = delete;
+
+private:
+  Slot *_slot;
+};
 
 /**
  * @class ConfigManager
@@ -71,6 +303,37 @@ static constexpr int DEFAULT_ENABLED_PAGES[] = {0, 1, 3, 2};
 class ConfigManager
 {
 public:
+  /**
+   * @class Transaction
+   * @brief Applies a batch of setter calls as one change.
+   *
+   * While a Transaction is alive on a task, the settings lock is held, so
+   * other tasks see either none or all of the batch. Setters on the owning
+   * task stage their values as usual, but the theme rebuild, the snapshot
+   * publication, the change notification and the debounced save all happen
+   * once, when the outermost Transaction ends. Transactions may nest.
+   */
+  class Transaction
+  {
+  public:
+    /**
+     * @brief Begins a transaction on the settings.
+     * @param config The ConfigManager to change.
+     */
+    explicit Transaction(ConfigManager &config);
+
+    /**
+     * @brief Commits the transaction.
+     */
+    ~Transaction();
+
+    Transaction(const Transaction &) = delete;
+    Transaction &operator=(const Transaction &) = delete;
+
+  private:
+    ConfigManager &_config;
+  };
+
   /**
    * @brief Gets the singleton instance of the ConfigManager.
    * @return A reference to the singleton ConfigManager instance.
@@ -99,7 +362,7 @@ public:
   void loop();
 
   /**
-   * @brief Saves the current configuration to the JSON file.
+   * @brief Writes the settings changed since the last save to Preferences.
    * @return True if the save was successful, false otherwise.
    */
   bool save();
@@ -147,12 +410,28 @@ public:
   int getNumAlarms() const;
 
   /**
-   * @brief Gets the snooze-until timestamp of the first snoozed alarm.
-   * @details Zero-allocation alternative to getAllAlarms() for snooze countdown display.
+   * @brief Gets the earliest snooze-until timestamp of the snoozed alarms.
+   * @details Read from the alarm summary, for the snooze countdown display.
    * @return The snooze-until unix timestamp, or 0 if no alarm is snoozed.
    */
   time_t getFirstSnoozedUntil() const;
 
+  /**
+   * @brief Gets the alarm table generation without taking the settings lock.
+   *
+   * The number increases every time an alarm is changed, added or removed,
+   * so callers can keep an AlarmSummary or a copy of the table and only
+   * fetch it again when the generation moves.
+   * @return The current alarm table generation (never 0).
+   */
+  uint32_t getAlarmGeneration() const { return _alarmGeneration.load(); }
+
+  /**
+   * @brief Gets the enabled/snoozed summary of the alarm table.
+   * @return A copy of the summary, without copying the table.
+   */
+  AlarmSummary getAlarmSummary() const;
+
   /**
    * @brief Replaces the current list of alarms with a new one.
    * Assigns new IDs to alarms with ID -1.
@@ -262,6 +541,13 @@ public:
    */
   bool isTempCorrectionEnabled() const;
 
+  /**
+   * @brief Gets the runtime log threshold of a module.
+   * @param module The module.
+   * @return The most verbose level logged for the module.
+   */
+  LogLevel getLogLevel(LogModule module) const;
+
   /**
    * @brief Checks if Daylight Saving Time is currently active.
    * @return True if DST is active, false otherwise.
@@ -354,6 +640,41 @@ public:
    */
   String getWeatherForecastColor() const;
 
+  /**
+   * @brief Gets all display colors in RGB565, parsed when they were last set.
+   * @return A copy of the current theme.
+   */
+  Theme getTheme() const;
+
+  /**
+   * @brief Gets the theme generation number.
+   *
+   * The number increases every time a display color changes, so callers can
+   * cache the colors they derived from the theme and skip that work while the
+   * generation they saw is still current.
+   * @return The current theme generation (never 0).
+   */
+  uint32_t getThemeGeneration() const;
+
+  /**
+   * @brief Gets the settings generation number.
+   *
+   * The number increases every time a setting is written, so callers can
+   * tell whether a view they built from the settings may be stale.
+   * @return The current settings generation.
+   */
+  uint32_t getGeneration() const;
+
+  /**
+   * @brief Gets the current settings snapshot without taking the settings lock.
+   *
+   * Costs a few atomic operations and never allocates, so it suits code that
+   * runs every frame. The snapshot reflects the settings as of the last
+   * change and stays valid, unchanged, for as long as the reference is held.
+   * @return A reference to the current snapshot.
+   */
+  ConfigSnapshotRef snapshot() const;
+
   /**
    * @brief Gets the ID of the alarm that was ringing at shutdown.
    * @return The ID of the alarm, or -1 if none.
@@ -409,6 +730,13 @@ public:
    */
   void setTempCorrection(float value);
 
+  /**
+   * @brief Sets the runtime log threshold of a module and applies it to SerialLog.
+   * @param module The module.
+   * @param level The most verbose level to log for the module.
+   */
+  void setLogLevel(LogModule module, LogLevel level);
+
   /**
    * @brief Gets the stored Address/Location.
    * @return The Address as a String.
@@ -664,15 +992,23 @@ public:
   void setWeatherForecastColor(const String &color);
 
   /**
-   * @brief Checks if the configuration has been modified since the last save.
-   * @return True if the configuration is "dirty", false otherwise.
+   * @brief Gets the categories changed since this cursor was last polled, and advances it.
+   * @param cursor The subscriber's cursor.
+   * @return A mask of ConfigChange bits, 0 if nothing changed.
+   */
+  uint32_t takeChanges(ConfigChangeCursor &cursor) const;
+
+  /**
+   * @brief Gets the cost of the saves made since boot.
+   * @return The save statistics.
    */
-  bool isDirty() const;
+  ConfigSaveStats getSaveStats() const;
 
   /**
-   * @brief Clears the dirty flag, usually after handling the changes.
+   * @brief Gets how the settings were loaded at boot and how long that took.
+   * @return The load statistics.
    */
-  void clearDirtyFlag();
+  ConfigLoadStats getLoadStats() const;
 
   /**
    * @brief Saves the state of a ringing alarm to persistent storage.
@@ -726,6 +1062,7 @@ private:
   String timezone = DEFAULT_TIMEZONE;
   bool tempCorrectionEnabled = DEFAULT_TEMP_CORRECTION_ENABLED;
   float tempCorrection = DEFAULT_TEMP_CORRECTION;
+  uint8_t logLevels[LOG_MODULE_COUNT];
   bool isDst = DEFAULT_IS_DST;
   uint8_t snoozeDuration = DEFAULT_SNOOZE_DURATION;
   uint8_t dismissDuration = DEFAULT_DISMISS_DURATION;
@@ -750,15 +1087,89 @@ private:
   String errorTextColor = DEFAULT_ERROR_TEXT_COLOR;
   String weatherTempColor = DEFAULT_WEATHER_TEMP_COLOR;
   String weatherForecastColor = DEFAULT_WEATHER_FORECAST_COLOR;
-
-  bool _isDirty;
+  Theme _theme;
+  uint32_t _themeGeneration;
+  uint32_t _generation = 0;
+  mutable ConfigSnapshotRef::Slot _snapshots[CONFIG_SNAPSHOT_SLOTS];
+  std::atomic<ConfigSnapshotRef::Slot *> _currentSnapshot{nullptr};
+  size_t _snapshotSlot = 0; ///< The slot last published.
+
+  uint64_t _dirtyFields = 0; ///< Bit per ConfigField changed since the last save.
+  uint32_t _changeCounts[CONFIG_CHANGE_COUNT] = {}; ///< Changes made so far in each ConfigChange category.
+  int _transactionDepth = 0;          ///< Open Transactions on the task holding the lock.
+  uint32_t _transactionChanges = 0;   ///< ConfigChange bits staged by the open Transaction.
+  bool _transactionSave = false;      ///< A save was requested during the Transaction.
+  bool _transactionTheme = false;     ///< A color changed during the Transaction.
+  bool _transactionPublish = false;   ///< A snapshot publication was requested during the Transaction.
+  bool _transactionCheckDst = false;  ///< The timezone changed during the Transaction.
   bool _savePending;
   unsigned long _saveDebounceTimer;
   std::vector<Alarm> _alarms;
+  std::vector<Alarm> _savedAlarms; ///< The alarm table as last written, for diffing.
+  AlarmSummary _alarmSummary = {};
+  std::atomic<uint32_t> _alarmGeneration{0};
   int _nextAlarmId;
+  int _savedNextAlarmId = -1;
+  ConfigSaveStats _saveStats = {};
+  ConfigLoadStats _loadStats = {};
+  bool _legacyKeysPresent = false; ///< Per-key settings of earlier firmware are still stored.
+  static String ConfigManager::*const BLOB_STRINGS[];
   Preferences _preferences;
   mutable SemaphoreHandle_t _mutex;
 
   void load();
   void setDefaults();
+
+  /**
+   * @brief Reads the settings from the one-key-per-setting format of earlier firmware.
+   */
+  void loadKeys();
+
+  /**
+   * @brief Reads the settings blob in one NVS call.
+   * @return True if the blob was valid and the settings were loaded from it.
+   */
+  bool loadBlob();
+
+  /**
+   * @brief Writes all the blob's settings in one NVS call.
+   * @return True if the whole blob was written.
+   */
+  bool saveBlob();
+
+  /**
+   * @brief Removes the per-setting keys of earlier firmware.
+   * @return The number of keys removed.
+   */
+  uint32_t removeLegacyKeys();
+
+  /**
+   * @brief Flags a setting as changed, for save() and takeChanges().
+   * @param field The setting.
+   */
+  void markDirty(ConfigField field);
+
+  /**
+   * @brief Counts a change in each of the given categories.
+   * @param changes A mask of ConfigChange bits.
+   */
+  void noteChanges(uint32_t changes);
+
+  /**
+   * @brief Writes the alarm keys that differ from the last saved table.
+   * @return The number of Preferences writes and removals made.
+   */
+  uint32_t saveAlarms();
+
+  /**
+   * @brief Recomputes the alarm summary and bumps the alarm generation. Call after changing `_alarms`.
+   */
+  void alarmsChanged();
+  void applyLogLevels();
+  void rebuildTheme();
+
+  /**
+   * @brief Publishes a new snapshot if the snapshotted settings have changed.
+   */
+  void publishSnapshot();
 };
@@ -16,14 +16,30 @@
 
 // --- Timing Constants (in milliseconds) ---
 #define LOOP_INTERVAL 100                  ///< The target interval for the main application loop.
+#define LOGIC_TASK_INTERVAL 100            ///< Time the logic task sleeps between passes.
+#define LOGIC_TASK_PORTAL_INTERVAL 10      ///< ...while the captive portal's DNS server needs answering.
 #define DEBOUNCE_DELAY 50                  ///< Debounce delay for button interrupts.
+#define BUTTON_HOLD_INTERVAL 100           ///< Time between hold-progress reports while a button is held.
+#define BUTTON_DOUBLE_PRESS_WINDOW 400     ///< Most time from one short press's release to the next press for a double press.
 #define FACTORY_RESET_HOLD_TIME 10000      ///< Time to hold the BOOT button for a runtime factory reset.
 #define BOOT_FACTORY_RESET_HOLD_TIME 30000 ///< Time to hold the SNOOZE button at boot for a factory reset.
 #define SETUP_CANCEL_DELAY 2000            ///< Duration to display the "Reset cancelled" message.
 #define WEB_SERVER_STABILIZATION_DELAY 100 ///< Brief delay to allow the web server to stabilize after starting.
+#define WEB_ASSET_CACHE_CONTROL "no-cache" ///< Lets browsers keep pre-compressed pages but revalidate them by ETag.
+#define EVENTS_POLL_INTERVAL 250           ///< How often the /api/events channel checks for state changes, in ms.
+#define EVENTS_STATS_INTERVAL 5000         ///< How often the system stats topic is pushed, in ms.
+#define EVENTS_BUFFER_SIZE 1024            ///< Largest serialized /api/events message, in bytes.
+#define REQUEST_BODY_POOL_SLOTS 4          ///< POST bodies that can be collected at the same time.
+#define REQUEST_BODY_MAX_SIZE 8192         ///< Largest POST body in bytes a pooled buffer holds.
+#define HTTP_MAX_INFLIGHT_STATIC 4         ///< Concurrent requests for pages.
+#define HTTP_MAX_INFLIGHT_API_READ 4       ///< Concurrent GET requests to /api routes.
+#define HTTP_MAX_INFLIGHT_API_WRITE 2      ///< Concurrent requests that change state.
+#define HTTP_MAX_INFLIGHT_OTA 1            ///< Concurrent firmware uploads.
 #define OFFLINE_MODE_MESSAGE_DELAY 5000    ///< Duration to display the "Offline Mode" message.
 #define PREFERENCES_NAMESPACE "clock_config"
 #define SAVE_DEBOUNCE_DELAY 5000 // 5 seconds
+#define RTC_FREE_RUNNING true               ///< Serve time reads from the ESP32 timer anchored to the RTC rather than over I2C.
+#define RTC_RESYNC_INTERVAL (10UL * 60UL * 1000UL) ///< How often the free-running clock is re-anchored to the RTC's second edge.
 
 // --- Alarm Constants ---
 #define ALARM_RESUME_DELAY_MS 5000    ///< Delay after boot before resuming a ringing alarm.
@@ -55,6 +71,95 @@
 #define ALARM_ICON_Y 5                ///< Y-coordinate of the alarm indicator icon.
 #define ALARM_ICON_WIDTH 18           ///< Width of the alarm indicator icon's bounding box.
 #define ALARM_ICON_HEIGHT 18          ///< Height of the alarm indicator icon's bounding box.
+#define DISPLAY_DMA_BUFFER_SIZE 12288 ///< Size in bytes of each of the two DMA sprite push buffers.
+#define SPRITE_ARENA_SIZE (640 * 1024) ///< Size in bytes of the PSRAM arena that page and widget layer sprites are carved from.
+#define PAGE_PRERENDER_ENABLED true    ///< Keep the next page pre-rendered in a PSRAM back buffer for instant cycling.
+
+// --- Render Task Constants ---
+#define RENDER_TASK_STACK_SIZE 8192 ///< Stack size of the render task, in bytes.
+#define RENDER_TASK_PRIORITY 2      ///< Above loop() so a frame starts right on the second edge.
+#define RENDER_TASK_CORE 1          ///< Render on the application core, away from WiFi on core 0.
+#define RENDER_EDGE_SPIN_US 1000    ///< How long before a predicted second edge the render task stops sleeping and spins.
+
+// --- Clock Discipline Constants ---
+#define DRIFT_MAX_SAMPLES 16                        ///< RTC-vs-NTP comparisons kept for the drift fit.
+#define DRIFT_MIN_SAMPLES 4                         ///< Comparisons needed before the fit is trusted.
+#define DRIFT_MIN_SPAN (6UL * 60UL * 60UL)          ///< Seconds the comparisons must span before the fit is trusted.
+#define DRIFT_RESYNC_US 20000                       ///< Offset from NTP, in us, past which the RTC is stepped.
+#define DRIFT_TRIM_MIN_PPM 0.2f                     ///< Smallest fitted error worth trimming out.
+#define DS3231_AGING_PPM_PER_LSB 0.1f               ///< Frequency change per step of the DS3231 aging offset.
+#define NTP_SYNC_INTERVAL_MIN (60UL * 60UL * 1000UL)     ///< SNTP poll interval while the RTC is being trimmed, in ms.
+#define NTP_SYNC_INTERVAL_MAX (8UL * 60UL * 60UL * 1000UL) ///< SNTP poll interval once the RTC holds its rate, in ms.
+
+// --- I2C Bus Task Constants ---
+#define I2C_TASK_STACK_SIZE 4096 ///< Stack size of the I2C bus task, in bytes.
+#define I2C_TASK_PRIORITY 2      ///< Above the logic task, so a queued RTC write lands promptly.
+#define I2C_TASK_CORE 0          ///< Off the render core, so a slow BME280 read never delays a frame.
+#define I2C_QUEUE_LENGTH 8       ///< Writes and read requests that can wait for the bus task.
+
+// --- Log Queue Constants ---
+#define LOG_QUEUE_SLOTS 256            ///< Slots in the log queue; must be a power of two.
+#define LOG_SLOT_TEXT_SIZE 104         ///< Bytes of log text each queue slot holds; keeps a slot at 128 bytes.
+#define LOG_TASK_NAME_SIZE 8           ///< Bytes of the logging task's name kept with each line.
+#define LOG_DRAIN_TASK_STACK_SIZE 6144 ///< Stack size of the log drain task, in bytes.
+#define LOG_DRAIN_TASK_PRIORITY 1      ///< Below the render task, so logging never delays a frame.
+#define LOG_DRAIN_TASK_CORE 0          ///< Drain on the protocol core, away from rendering and alarms.
+#define LOG_WS_BATCH_INTERVAL 100      ///< Longest a line waits before being sent to /ws/log clients, in ms.
+#define LOG_WS_BATCH_SIZE 1024         ///< Bytes of pending log text that send a /ws/log batch early.
+#define LOG_WS_MAX_CLIENT_QUEUE 4      ///< Queued frames above which a slow /ws/log client skips batches.
+#define LOG_WS_HISTORY_SIZE (32 * 1024) ///< Bytes of recent console output replayed to a /ws/log client on connect.
+#define LOG_WS_REPLAY_CHUNK 8192       ///< Largest frame used to replay the history.
+
+// --- Log Store Constants ---
+#define LOG_STORE_DIR "/log"              ///< LittleFS directory holding the log segments and their index.
+#define LOG_STORE_SEGMENTS 8              ///< Segments kept; the oldest is removed when a new one starts.
+#define LOG_STORE_SEGMENT_SIZE (64 * 1024) ///< Size in bytes at which a segment is closed.
+#define LOG_STORE_BLOCK_SIZE 4096         ///< LittleFS block size; log text is written a block at a time.
+#define LOG_STORE_SYNC_INTERVAL 5000      ///< Longest an unfinished block stays in RAM, in ms.
+
+// --- WiFi Constants ---
+#define WIFI_CONNECT_TIMEOUT 15000       ///< Time given a full scan-and-connect at boot, in ms.
+#define WIFI_FAST_CONNECT_TIMEOUT 5000   ///< Time given a direct connect to the remembered access point, in ms.
+#define WIFI_FAST_CONNECT_NAMESPACE "wifi_fast" ///< Preferences namespace holding the last good access point and lease.
+#define WIFI_REUSE_DHCP_LEASE false      ///< Reapply the last DHCP lease as a static address on a direct connect, skipping DHCP. Only safe where the router reserves that address for the clock.
+#define WIFI_SCAN_MAX_RESULTS 24         ///< Networks kept from a scan, strongest first.
+#define WIFI_SCAN_FRESHNESS 15000        ///< A scan younger than this is served again instead of starting another, in ms.
+
+// --- Weather Cache Constants ---
+#define WEATHER_CACHE_PATH "/weather.json"        ///< LittleFS file holding the last fetched weather.
+#define WEATHER_CACHE_MAX_AGE (6UL * 60UL * 60UL) ///< Age in seconds past which cached weather is no longer shown.
+
+// --- Geocoding Cache Constants ---
+#define GEOCODING_CACHE_PATH "/geocode.json" ///< LittleFS file holding recently resolved locations.
+#define GEOCODING_CACHE_ENTRIES 8            ///< Locations kept; the least recently used is dropped.
+
+// --- HTTPS Client Constants ---
+#define HTTPS_CONNECT_TIMEOUT 15     ///< TLS handshake timeout, in seconds.
+#define HTTPS_RESPONSE_TIMEOUT 15000 ///< HTTP response timeout in ms, well under the 30s WDT.
+#define HTTPS_IDLE_TIMEOUT 30000     ///< A kept-alive connection unused this long is closed, in ms.
+
+// --- OTA Constants ---
+#define OTA_CHUNK_SIZE 4096     ///< Bytes read from the network, hashed and written to flash at a time.
+#define OTA_PIPELINE_BUFFERS 3  ///< Chunks in flight between the network reader and the flash writer.
+#define OTA_READER_CORE 0       ///< The download runs next to the WiFi stack...
+#define OTA_WRITER_CORE 1       ///< ...and hashing and flash writes on the application core.
+
+// --- Power Constants ---
+#define POWER_MANAGEMENT true      ///< Scale the CPU clock with load through esp_pm instead of running flat out.
+#define POWER_MIN_CPU_FREQ_MHZ 80  ///< Clock the CPU drops to when no power lock is held.
+
+// --- Telemetry Constants ---
+#define TELEMETRY_SAMPLE_INTERVAL 10000 ///< Time between task and heap samples, in ms.
+#define TELEMETRY_RING_SIZE 60          ///< Samples kept, i.e. the last ten minutes.
+#define TELEMETRY_MAX_TASKS 32          ///< Most FreeRTOS tasks a sample can list.
+
+// --- Sensor History Constants ---
+#define SENSOR_HISTORY_SAMPLES 28800    ///< Slots kept, one per sensor read: 24 hours at 3 s, 4 bytes each in PSRAM.
+#define SENSOR_HISTORY_MAX_POINTS 720   ///< Most points /api/sensors/history returns; a finer step is coarsened to fit.
+
+// --- Crash Journal Constants ---
+#define CRASH_JOURNAL_RECORDS 32      ///< Most recent lines kept in RTC memory across a reset.
+#define CRASH_JOURNAL_MESSAGE_SIZE 48 ///< Bytes of each line's text the journal keeps.
 
 // --- Brightness Constants ---
 const int BRIGHTNESS_MIN = 5;
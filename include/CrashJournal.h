@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include "Constants.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class CrashJournal
+ * @brief The last log lines, kept in RTC memory so they survive a crash.
+ *
+ * Lines are stored as fixed-size records in a ring of CRASH_JOURNAL_RECORDS,
+ * each holding the time, the logging task and core, the level and the start
+ * of the text. A record never straddles the end of the ring, so appending is
+ * two memcpys and a few stores, with no per-byte work.
+ *
+ * On boot the previous session's records are copied out before the ring is
+ * reused, and are available through `previousRecord()` until the next reset.
+ */
+class CrashJournal
+{
+public:
+  /// @brief One journal line.
+  struct Record
+  {
+    uint32_t time;                            ///< time() when logged; seconds since boot before the clock was set.
+    uint32_t uptimeMs;                        ///< millis() when logged.
+    char task[LOG_TASK_NAME_SIZE];            ///< The logging task's name; not terminated when it fills the array.
+    uint8_t core;                             ///< The core the task ran on.
+    uint8_t level;                            ///< The line's LogLevel.
+    uint8_t length;                           ///< Bytes used in `message`.
+    uint8_t reserved;
+    char message[CRASH_JOURNAL_MESSAGE_SIZE]; ///< The start of the line, without the trailing newline.
+  };
+
+  /**
+   * @brief Gets the singleton instance of the CrashJournal.
+   *
+   * The first call takes over the previous session's records.
+   * @return A reference to the CrashJournal instance.
+   */
+  static CrashJournal &getInstance()
+  {
+    static CrashJournal instance;
+    return instance;
+  }
+
+  /**
+   * @brief Appends a line, truncated to CRASH_JOURNAL_MESSAGE_SIZE bytes.
+   *
+   * Only the log drain task calls this, so records need no locking.
+   * @param time time() when the line was logged.
+   * @param uptimeMs millis() when the line was logged.
+   * @param task The logging task's name, LOG_TASK_NAME_SIZE bytes.
+   * @param core The core the task ran on.
+   * @param level The line's LogLevel.
+   * @param message The line's text.
+   * @param length The length of the text in bytes.
+   */
+  void append(uint32_t time, uint32_t uptimeMs, const char *task, uint8_t core, uint8_t level, const char *message, size_t length);
+
+  /**
+   * @brief Counts the records kept from the previous session.
+   * @return The number of records.
+   */
+  size_t previousCount() const { return _previousCount; }
+
+  /**
+   * @brief Gets a record from the previous session.
+   * @param index The record, oldest first.
+   * @return The record.
+   */
+  const Record &previousRecord(size_t index) const { return _previous[index]; }
+
+  /**
+   * @brief Gets the reason for the last reset.
+   * @return The reset reason.
+   */
+  esp_reset_reason_t resetReason() const { return _resetReason; }
+
+  /**
+   * @brief Checks whether the last reset was a crash: a panic, a watchdog or a brownout.
+   * @return True for a crash.
+   */
+  bool wasCrash() const;
+
+  /**
+   * @brief Describes a reset reason.
+   * @param reason The reset reason.
+   * @return A readable name.
+   */
+  static const char *resetReasonName(esp_reset_reason_t reason);
+
+  CrashJournal(const CrashJournal &) = delete;
+  CrashJournal &operator=(const CrashJournal &) = delete;
+
+private:
+  CrashJournal();
+
+  Record *_previous = nullptr; ///< The previous session's records, in PSRAM.
+  size_t _previousCount = 0;
+  esp_reset_reason_t _resetReason;
+};
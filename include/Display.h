@@ -82,9 +82,67 @@ public:
 
   /**
    * @brief Unlocks the TFT mutex.
+   *
+   * Any sprite pushes still in flight are drained first, so the next holder
+   * of the lock always finds the SPI bus idle.
    */
   void unlock();
 
+  /**
+   * @brief Pushes a sprite to the screen through the DMA pipeline.
+   *
+   * The sprite is copied band by band into two alternating DMA buffers, so the
+   * CPU prepares the next band (or the next sprite) while the previous one is
+   * still on the bus. The sprite may be redrawn as soon as this returns.
+   * Falls back to a blocking `pushSprite()` when DMA is unavailable.
+   * The display must be locked by the caller.
+   *
+   * @param sprite The sprite to push.
+   * @param x The screen x-coordinate of the sprite's top-left corner.
+   * @param y The screen y-coordinate of the sprite's top-left corner.
+   */
+  void pushSprite(TFT_eSprite &sprite, int32_t x, int32_t y);
+
+  /**
+   * @brief Pushes a rectangular region of a sprite through the DMA pipeline.
+   *
+   * Only the region is transferred; it lands where it would if the whole
+   * sprite were pushed at (x, y). The display must be locked by the caller.
+   *
+   * @param sprite The sprite to push from.
+   * @param x The screen x-coordinate the sprite's top-left corner maps to.
+   * @param y The screen y-coordinate the sprite's top-left corner maps to.
+   * @param sx The x-coordinate of the region within the sprite.
+   * @param sy The y-coordinate of the region within the sprite.
+   * @param sw The width of the region.
+   * @param sh The height of the region.
+   */
+  void pushSprite(TFT_eSprite &sprite, int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
+
+  /**
+   * @brief Waits for all queued sprite pushes to complete.
+   *
+   * Must be called before drawing directly to the TFT after a `pushSprite()`
+   * within the same lock. `unlock()` calls this automatically.
+   */
+  void flushPushes();
+
+  /**
+   * @brief Redirects sprite pushes into an off-screen frame instead of the panel.
+   *
+   * While capturing, `pushSprite()` composes into `frame` at the same screen
+   * coordinates, so a page can be rendered ahead of time without knowing it.
+   * The display must be locked by the caller until `endCapture()`.
+   *
+   * @param frame A full-screen 16 bpp sprite to compose into.
+   */
+  void beginCapture(TFT_eSprite *frame);
+
+  /**
+   * @brief Stops redirecting sprite pushes; they go to the panel again.
+   */
+  void endCapture() { _captureFrame = nullptr; }
+
 private:
   /**
    * @brief Private constructor to enforce the singleton pattern.
@@ -93,6 +151,7 @@ private:
 
   void _updateRotation();
   void _updateInversion();
+  void _initDmaPipeline();
 
   // --- Private Members ---
 
@@ -102,4 +161,12 @@ private:
   unsigned long _lastFlashTime = 0;
 
   SemaphoreHandle_t tft_mutex; ///< Mutex for thread-safe access to the TFT.
+
+  // --- DMA Push Pipeline ---
+  uint8_t *_dmaBuffers[2] = {nullptr, nullptr}; ///< Double-buffered DMA staging areas.
+  uint8_t _dmaBufferIndex = 0;                  ///< Index of the buffer to fill next.
+  bool _dmaReady = false;                       ///< True if DMA was initialized successfully.
+  bool _dmaInTransaction = false;               ///< True while an SPI transaction is held open for DMA.
+
+  TFT_eSprite *_captureFrame = nullptr; ///< Off-screen frame that pushes are redirected into, if any.
 };
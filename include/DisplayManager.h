@@ -1,9 +1,40 @@
 #pragma once
 
 #include "Page.h"
+#include "ArenaSprite.h"
 #include <vector>
 #include <memory> // For std::unique_ptr
 #include <TFT_eSPI.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/**
+ * @brief Reasons for waking the render task, delivered as task notification bits.
+ */
+enum RenderEvent : uint32_t
+{
+  RENDER_EVENT_SECOND = 1 << 0,  ///< The RTC's second changed.
+  RENDER_EVENT_CONFIG = 1 << 1,  ///< Settings changed or a refresh was requested.
+  RENDER_EVENT_ALARM = 1 << 2,   ///< An alarm started, stopped, or was snoozed.
+  RENDER_EVENT_BUTTON = 1 << 3,  ///< The button state changed (e.g. dismiss progress).
+};
+
+/**
+ * @brief How late new seconds reached the screen, measured from the second edge.
+ *
+ * Each second frame counts once, from the edge of the second it shows to the
+ * moment the page's sprite pushes had all landed.
+ */
+struct EdgeLatencyStats
+{
+  static constexpr int BUCKETS = 7;
+  static constexpr uint16_t BUCKET_LIMITS_MS[BUCKETS - 1] = {1, 2, 5, 10, 20, 50}; ///< Upper bounds; the last bucket has none.
+
+  uint32_t frames;           ///< Second frames measured since boot.
+  uint32_t buckets[BUCKETS]; ///< Frames per latency bucket.
+  uint32_t lastUs;           ///< Latency of the last frame.
+  uint32_t maxUs;            ///< Worst latency since boot.
+};
 
 /**
  * @class DisplayManager
@@ -70,10 +101,26 @@ public:
 
   /**
    * @brief Updates the currently active page.
-   * This should be called in the main application loop.
+   * This is called by the render task; other tasks should use `requestRender()`.
    */
   void update();
 
+  /**
+   * @brief Starts the render task that drives `update()`.
+   *
+   * The task sleeps until the next RTC second edge or until it is notified
+   * through `requestRender()`, so frames start right after the second changes.
+   */
+  void startRenderTask();
+
+  /**
+   * @brief Wakes the render task to draw a frame as soon as possible.
+   *
+   * Before the render task is started, this renders synchronously instead.
+   * @param events A bitmask of `RenderEvent` values describing the reason.
+   */
+  void requestRender(uint32_t events);
+
   /**
    * @brief Forces the current page to refresh its content.
    */
@@ -89,6 +136,14 @@ public:
    */
   void requestFullRefresh();
 
+  /**
+   * @brief Rebuilds the pre-rendered next page after the next frame.
+   *
+   * The back frame is only rebuilt when something it depends on changed, so
+   * call this when the enabled-page order changes without a refresh.
+   */
+  void invalidateBackFrame();
+
   /**
    * @brief Draws or erases the alarm indicator icon on the display.
    * @param enabled True to draw the icon, false to erase it.
@@ -125,6 +180,18 @@ public:
    */
   void showErrorScreen(const char *message);
 
+  /**
+   * @brief Gets the PSRAM arena that page sprites are allocated from.
+   * @return A reference to the sprite arena.
+   */
+  SpriteArena &spriteArena() { return _spriteArena; }
+
+  /**
+   * @brief Gets the edge-to-screen latency of the second frames.
+   * @return A copy of the histogram.
+   */
+  EdgeLatencyStats getEdgeLatencyStats() const;
+
 private:
   /**
    * @brief Private constructor to enforce the singleton pattern.
@@ -133,6 +200,54 @@ private:
 
   void initAlarmSprite();
   void renderAlarmOverlay();
+  void initBackFrame();
+
+  /**
+   * @brief Gets the index of the page that follows the current one in the enabled-page order.
+   * @return The next page's index.
+   */
+  int nextPageIndex();
+
+  /**
+   * @brief Renders the next page into the back frame if it isn't there already.
+   *
+   * Called by the render task after a frame, in the time left before the next
+   * second. The page is entered with the back frame as its drawing target, so
+   * it is fully set up when it becomes current. Does nothing until a page
+   * change, a refresh or invalidateBackFrame() marks the back frame stale.
+   */
+  void prerenderNextPage();
+
+  /**
+   * @brief Lets the current page draw the next second's content ahead of time.
+   *
+   * Called by the render task after a frame while the clock is free running,
+   * so the frame at the next edge only has to push what changed.
+   */
+  void prerenderNextSecond();
+
+  /**
+   * @brief Adds the last frame to the edge latency histogram.
+   * @param edgeMicros esp_timer_get_time() at the edge of the second the frame shows.
+   */
+  void recordEdgeLatency(int64_t edgeMicros);
+
+  /**
+   * @brief Brings the pre-rendered page up to date and sends the back frame to the screen.
+   * Must be called with the display locked, after the page became current.
+   */
+  void showBackFrame();
+
+  /**
+   * @brief Discards the pre-rendered page. Must be called with the display locked.
+   */
+  void dropBackPage();
+
+  /**
+   * @brief The render task's entry point.
+   * @param param Unused.
+   */
+  static void renderTask(void *param);
 
   TFT_eSPI *_tft;                            ///< Pointer to the main TFT object.
   std::vector<std::unique_ptr<Page>> _pages; ///< A list of all available pages.
@@ -142,9 +257,22 @@ private:
   bool _isSnoozing = false;                  ///< Tracks the snooze state of the icon.
   bool _partialRefresh = false;
   bool _fullRefresh = false;
+  TaskHandle_t _renderTaskHandle = nullptr;  ///< Handle of the render task, once started.
+  int64_t _pagePushedMicros = 0;             ///< esp_timer_get_time() when the last frame's page pushes had landed.
+
+  EdgeLatencyStats _edgeLatency = {};
+  mutable portMUX_TYPE _edgeLatencyMux = portMUX_INITIALIZER_UNLOCKED;
+
+  SpriteArena _spriteArena; ///< Backing memory for all long-lived page sprites.
+
+  // Next-page pre-rendering
+  ArenaSprite *_backFrame = nullptr; ///< Full-screen frame holding the pre-rendered next page.
+  int _backPageIndex = -1;           ///< Index of the page in the back frame, or -1 if none.
+  bool _backFrameStale = true;       ///< True if the back frame must be rebuilt before it can be used.
 
   // Alarm Overlay
-  TFT_eSprite *_alarmSprite;
+  ArenaSprite *_alarmSprite;
+  uint32_t _alarmThemeGeneration = 0; ///< Theme generation the alarm palette was built from.
   float _dismissProgress = 0.0f;
   bool _wasAlarmActive = false;
 };
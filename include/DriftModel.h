@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Constants.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class DriftModel
+ * @brief Fits the RTC's frequency error from repeated comparisons with NTP.
+ *
+ * Each sample is the RTC's offset from NTP at some NTP time. The offsets of
+ * a clock with a steady frequency error lie on a line, and its slope in
+ * microseconds per second is the error in ppm. When the RTC is stepped back
+ * into line, `step()` records the correction so later samples stay on the
+ * same line and the fit can carry on.
+ *
+ * The model is not locked; its owner serialises access.
+ */
+class DriftModel
+{
+public:
+  /**
+   * @brief Adds a comparison.
+   * @param time The NTP time of the comparison, in seconds.
+   * @param offsetUs How far the RTC was ahead of NTP, in microseconds.
+   */
+  void add(uint32_t time, int64_t offsetUs);
+
+  /**
+   * @brief Notes that the RTC was stepped by `correctionUs`.
+   * @param correctionUs The amount the RTC was moved forward, in microseconds.
+   */
+  void step(int64_t correctionUs);
+
+  /**
+   * @brief Drops every sample, e.g. after the RTC's frequency was trimmed.
+   */
+  void reset();
+
+  /**
+   * @brief Fits a line through the samples.
+   *
+   * Needs DRIFT_MIN_SAMPLES samples spanning DRIFT_MIN_SPAN seconds.
+   * @param ppm Receives the frequency error; positive when the RTC runs fast.
+   * @return True if there were enough samples to fit.
+   */
+  bool fit(float &ppm) const;
+
+  /**
+   * @brief Counts the samples held.
+   * @return The number of samples.
+   */
+  size_t count() const { return _count; }
+
+private:
+  /// @brief One comparison, with any later steps taken out.
+  struct Sample
+  {
+    uint32_t time;
+    int64_t offsetUs;
+  };
+
+  Sample _samples[DRIFT_MAX_SAMPLES];
+  size_t _count = 0; ///< Samples held; the oldest are overwritten once full.
+  size_t _next = 0;  ///< Where the next sample goes.
+  int64_t _stepUs = 0; ///< Total of the steps since the first sample.
+};
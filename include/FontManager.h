@@ -0,0 +1,140 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * @brief Handles for the smooth fonts in `include/fonts/`.
+ */
+enum FontId : uint8_t
+{
+  FONT_CENTURY_GOTHIC_28,
+  FONT_CENTURY_GOTHIC_BOLD_48,
+  FONT_DSEG14_MODERN_BOLD_32,
+  FONT_DSEG14_MODERN_BOLD_48,
+  FONT_DSEG7_MODERN_BOLD_48,
+  FONT_DSEG7_MODERN_BOLD_70,
+  FONT_DSEG7_MODERN_BOLD_104,
+  FONT_COUNT ///< Number of fonts; not a valid handle.
+};
+
+/**
+ * @class FontManager
+ * @brief Parses each smooth font once and shares the parsed metrics.
+ *
+ * `TFT_eSPI::loadFont()` re-reads the VLW header and allocates a fresh copy
+ * of the glyph index every time it is called. The FontManager parses each
+ * font a single time, keeps the metrics and glyph tables resident, and
+ * switches a TFT or sprite to a font by pointing it at the shared tables.
+ *
+ * A target that has been given a font with `use()` must be detached with
+ * `release()` (never `unloadFont()` or `loadFont()`) before it is destroyed
+ * or given a font another way, since those would free the shared tables.
+ */
+class FontManager
+{
+public:
+  /**
+   * @brief Gets the singleton instance of the FontManager.
+   * @return A reference to the singleton FontManager instance.
+   */
+  static FontManager &getInstance()
+  {
+    static FontManager instance;
+    return instance;
+  }
+
+  /**
+   * @brief Parses every font up front.
+   * @param tft The TFT_eSPI driver, used to host the scratch sprite for parsing.
+   */
+  void begin(TFT_eSPI *tft);
+
+  /**
+   * @brief Switches a TFT or sprite to a font without re-parsing it.
+   * @param target The TFT_eSPI instance or sprite to draw with the font.
+   * @param id The font to use.
+   * @return False if the font could not be parsed.
+   */
+  bool use(TFT_eSPI &target, FontId id);
+
+  /**
+   * @brief Detaches any smooth font from a target, reverting it to the built-in fonts.
+   * @param target The TFT_eSPI instance or sprite.
+   */
+  void release(TFT_eSPI &target);
+
+  /**
+   * @brief Gets a font's line height without attaching it to anything.
+   * @param id The font to measure.
+   * @return The line height in pixels, or 0 if the font could not be parsed.
+   */
+  int16_t fontHeight(FontId id);
+
+  /**
+   * @brief Gets the number of times a font was parsed in the last full second.
+   */
+  uint32_t loadsPerSecond();
+
+  /**
+   * @brief Gets the number of times a target switched font in the last full second.
+   */
+  uint32_t switchesPerSecond();
+
+  /**
+   * @brief Gets the total number of font parses since boot.
+   */
+  uint32_t totalLoads() const { return _totalLoads; }
+
+  /**
+   * @brief Gets the total number of font switches since boot.
+   */
+  uint32_t totalSwitches() const { return _totalSwitches; }
+
+private:
+  FontManager();
+  FontManager(const FontManager &) = delete;
+  FontManager &operator=(const FontManager &) = delete;
+
+  /**
+   * @brief Counts events in whole-second buckets.
+   */
+  struct RateCounter
+  {
+    uint32_t second = 0;   ///< millis() / 1000 of the current bucket.
+    uint32_t count = 0;    ///< Events in the current bucket.
+    uint32_t previous = 0; ///< Events in the bucket before it.
+
+    void add(uint32_t now);
+    uint32_t perSecond(uint32_t now) const;
+  };
+
+  /// @brief The parsed, resident form of one font.
+  struct Entry
+  {
+    const uint8_t *array;
+    bool parsed;
+    TFT_eSPI::fontMetrics metrics;
+    uint16_t *gUnicode;
+    uint8_t *gHeight;
+    uint8_t *gWidth;
+    uint8_t *gxAdvance;
+    int16_t *gdY;
+    int8_t *gdX;
+    uint32_t *gBitmap;
+  };
+
+  Entry *ensureParsed(FontId id);
+  bool isShared(const TFT_eSPI &target) const;
+  static void detach(TFT_eSPI &target);
+
+  TFT_eSPI *_tft = nullptr;
+  Entry _entries[FONT_COUNT];
+  RateCounter _loads;
+  RateCounter _switches;
+  uint32_t _totalLoads = 0;
+  uint32_t _totalSwitches = 0;
+  SemaphoreHandle_t _mutex;
+};
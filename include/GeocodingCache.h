@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include <cstdint>
+
+/**
+ * @class GeocodingCache
+ * @brief Remembers the last few locations resolved, so they skip the geocoding API.
+ *
+ * Queries are normalized (case, surrounding and repeated spaces, spaces
+ * around commas) before they are looked up, so "Paris, tx" and
+ * " paris,TX " share an entry. The entries are kept most recently used
+ * first and saved to LittleFS whenever they change, so the cache survives
+ * reboots and a factory reset that keeps Wi-Fi.
+ */
+class GeocodingCache
+{
+public:
+  /**
+   * @brief Gets the singleton instance of the GeocodingCache.
+   * @return A reference to the GeocodingCache instance.
+   */
+  static GeocodingCache &getInstance()
+  {
+    static GeocodingCache instance;
+    return instance;
+  }
+
+  /**
+   * @brief Loads the saved entries. Call once LittleFS is mounted.
+   */
+  void begin();
+
+  /**
+   * @brief Looks a query up, making it the most recently used on a hit.
+   * @param query The location as the user typed it.
+   * @param resolvedAddress Receives the address it resolved to.
+   * @param lat Receives the latitude.
+   * @param lon Receives the longitude.
+   * @return True on a hit.
+   */
+  bool lookup(const String &query, String &resolvedAddress, float &lat, float &lon);
+
+  /**
+   * @brief Records a resolved query, dropping the least recently used entry if full.
+   * @param query The location as the user typed it.
+   * @param resolvedAddress The address it resolved to.
+   * @param lat The latitude.
+   * @param lon The longitude.
+   */
+  void store(const String &query, const String &resolvedAddress, float lat, float lon);
+
+  /**
+   * @brief Forgets every entry and removes the saved file.
+   */
+  void clear();
+
+  GeocodingCache(const GeocodingCache &) = delete;
+  GeocodingCache &operator=(const GeocodingCache &) = delete;
+
+private:
+  GeocodingCache();
+
+  static constexpr size_t QUERY_SIZE = 64;   ///< Longest normalized query cached, with its terminator.
+  static constexpr size_t ADDRESS_SIZE = 96; ///< Longest address kept; longer ones are cut.
+
+  struct Entry
+  {
+    char query[QUERY_SIZE];
+    char address[ADDRESS_SIZE];
+    float lat;
+    float lon;
+  };
+
+  /**
+   * @brief Normalizes a query into a cache key.
+   * @param query The location as the user typed it.
+   * @param key Receives the key.
+   * @return False if the query is empty or too long to cache.
+   */
+  static bool normalize(const String &query, char (&key)[QUERY_SIZE]);
+
+  /// @brief Finds a key's entry. Call with `_mutex` held.
+  int find(const char *key) const;
+
+  /// @brief Moves an entry to the front, shifting the ones before it back. Call with `_mutex` held.
+  void promote(int index);
+
+  /// @brief Writes the entries to LittleFS. Call with `_mutex` held.
+  void save() const;
+
+  Entry _entries[GEOCODING_CACHE_ENTRIES]; ///< Most recently used first.
+  uint8_t _count = 0;
+  SemaphoreHandle_t _mutex;
+};
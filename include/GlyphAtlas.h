@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "FontManager.h"
+#include <cstdint>
+
+/**
+ * @class GlyphAtlas
+ * @brief A cache of pre-rasterized smooth-font glyphs for a fixed character set.
+ *
+ * Each glyph is rendered once for a given foreground/background color pair
+ * into an RGB565 tile in PSRAM. Strings made up of those glyphs are then
+ * drawn into a sprite with plain row copies instead of per-pixel alpha
+ * blending. The atlas is rebuilt lazily on the next draw after the colors
+ * change.
+ */
+class GlyphAtlas
+{
+public:
+  /**
+   * @brief Constructs a new GlyphAtlas.
+   * @param tft A pointer to the TFT_eSPI driver, used for the scratch sprite.
+   * @param font The smooth font the glyphs are rendered with.
+   * @param glyphs The characters to cache (e.g., "0123456789:").
+   */
+  GlyphAtlas(TFT_eSPI *tft, FontId font, const char *glyphs);
+  ~GlyphAtlas();
+
+  GlyphAtlas(const GlyphAtlas &) = delete;
+  GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+  /**
+   * @brief Sets the colors the glyphs are rendered with.
+   *
+   * The cached tiles are discarded if the colors differ from the current ones.
+   * @param fg The foreground (text) color.
+   * @param bg The background color.
+   */
+  void setColors(uint16_t fg, uint16_t bg);
+
+  /**
+   * @brief Discards all cached tiles. They are rebuilt on the next draw.
+   */
+  void invalidate();
+
+  /**
+   * @brief Draws a string into a 16-bit sprite using the cached glyph tiles.
+   *
+   * Positioning follows TFT_eSPI's `drawString()` for the given datum.
+   * Baseline datums are not supported.
+   *
+   * @param sprite The destination sprite.
+   * @param text The string to draw.
+   * @param x The x-coordinate of the datum point.
+   * @param y The y-coordinate of the datum point.
+   * @param datum The TFT_eSPI text datum (e.g., MR_DATUM).
+   * @return False if the string contains an uncached character or the atlas
+   *         could not be built; the caller should fall back to `drawString()`.
+   */
+  bool drawString(TFT_eSprite &sprite, const char *text, int32_t x, int32_t y, uint8_t datum);
+
+  /**
+   * @brief Gets the width a string would occupy when drawn from the atlas.
+   * @param text The string to measure.
+   * @return The width in pixels, or -1 if the string cannot be drawn.
+   */
+  int32_t textWidth(const char *text);
+
+  /**
+   * @brief Gets the height of every tile in the atlas (the font's line height).
+   * @return The tile height in pixels, or 0 if the atlas could not be built.
+   */
+  int32_t tileHeight();
+
+  /**
+   * @brief Gets the width of a glyph's tile (its advance).
+   * @param c The character to look up.
+   * @return The tile width in pixels, or -1 if the glyph is not cached.
+   */
+  int32_t glyphWidth(char c);
+
+  /**
+   * @brief Copies a single glyph tile into a sprite.
+   * @param sprite The destination 16-bit sprite.
+   * @param c The character to draw.
+   * @param x The x-coordinate of the tile's top-left corner in the sprite.
+   * @param y The y-coordinate of the tile's top-left corner in the sprite.
+   * @return False if the glyph is not cached.
+   */
+  bool drawGlyph(TFT_eSprite &sprite, char c, int32_t x, int32_t y);
+
+private:
+  static constexpr int MAX_GLYPHS = 16; ///< Maximum size of the cached character set.
+
+  struct Tile
+  {
+    char glyph;
+    int16_t width;
+    uint16_t *pixels; ///< width * _height pixels in sprite (byte-swapped RGB565) order.
+  };
+
+  bool ensureBuilt();
+  const Tile *findTile(char c) const;
+
+  TFT_eSPI *_tft;
+  FontId _font;
+  char _glyphs[MAX_GLYPHS + 1];
+  Tile _tiles[MAX_GLYPHS];
+  int _tileCount = 0;
+  int16_t _height = 0;
+  uint16_t _fg = TFT_WHITE;
+  uint16_t _bg = TFT_BLACK;
+  bool _built = false;
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include <cstdint>
+
+/// @brief The classes that web routes are admitted and capped by.
+enum RouteClass
+{
+  ROUTE_STATIC,    ///< Pages and other GETs outside /api.
+  ROUTE_API_READ,  ///< GET requests to /api.
+  ROUTE_API_WRITE, ///< Requests that change state.
+  ROUTE_OTA,       ///< Firmware uploads.
+  ROUTE_CLASS_COUNT
+};
+
+/**
+ * @class HttpAdmission
+ * @brief Caps in-flight web requests per route class and records what each route costs.
+ *
+ * A request is admitted on its first callback and counts against its class
+ * until the client disconnects, which is when the response has been sent.
+ * A request over its class limit is turned away with 503, so a burst of
+ * traffic queues in the browser instead of on the locks the render and
+ * alarm paths share with the handlers.
+ *
+ * Every handler callback is timed, along with the time the callback spent
+ * waiting for LockGuard mutexes. A handler can hold a lock for at most its own
+ * run time, so the per-route maximum is an upper bound on how long the web UI
+ * can make another task wait.
+ */
+class HttpAdmission
+{
+public:
+  static constexpr int MAX_ROUTES = 48; ///< Routes whose statistics are tracked.
+  static constexpr int RING_SIZE = 32;  ///< Latency samples kept per route.
+  static constexpr int MAX_IN_FLIGHT = HTTP_MAX_INFLIGHT_STATIC + HTTP_MAX_INFLIGHT_API_READ +
+                                       HTTP_MAX_INFLIGHT_API_WRITE + HTTP_MAX_INFLIGHT_OTA;
+  static constexpr int MAX_REJECTED = 16; ///< Rejected requests remembered; lwIP's default limit on open TCP connections.
+
+  /// @brief Admission figures for one route class.
+  struct ClassStats
+  {
+    uint32_t inFlight; ///< Requests currently admitted.
+    uint32_t limit;    ///< Most requests admitted at once.
+    uint32_t admitted; ///< Requests admitted since boot.
+    uint32_t rejected; ///< Requests turned away since boot.
+  };
+
+  /// @brief Latency figures for one route.
+  struct RouteStats
+  {
+    const char *uri;
+    RouteClass routeClass;
+    uint32_t requests;      ///< Requests completed.
+    uint32_t rejected;      ///< Requests turned away.
+    uint32_t p95Us;         ///< 95th percentile handler time over the ring.
+    uint32_t maxUs;         ///< Longest handler time since boot.
+    uint32_t lockWaitP95Us; ///< 95th percentile lock wait over the ring.
+    uint32_t lockWaitMaxUs; ///< Longest lock wait since boot.
+  };
+
+  /**
+   * @brief Gets the singleton instance of the HttpAdmission.
+   * @return A reference to the HttpAdmission instance.
+   */
+  static HttpAdmission &getInstance()
+  {
+    static HttpAdmission instance;
+    return instance;
+  }
+
+  /**
+   * @brief Classifies a route by its path and methods.
+   * @param uri The route path.
+   * @param method The methods the route accepts.
+   * @return The route's class.
+   */
+  static RouteClass classify(const char *uri, WebRequestMethodComposite method);
+
+  /**
+   * @brief Registers a route for statistics.
+   * @param uri The route path; must be a string literal.
+   * @param routeClass The route's class.
+   * @return The route ID to pass to the other calls, or -1 once MAX_ROUTES are registered.
+   */
+  int addRoute(const char *uri, RouteClass routeClass);
+
+  /**
+   * @brief Admits a request, unless its class is full. Admitting twice is harmless.
+   *
+   * A request that is turned away is remembered until `finish()`, so its
+   * later callbacks can tell it was already answered.
+   * @param request The request.
+   * @param route The route ID.
+   * @return True if the request may be handled.
+   */
+  bool admit(AsyncWebServerRequest *request, int route);
+
+  /**
+   * @brief Checks whether a request was admitted.
+   */
+  bool isAdmitted(AsyncWebServerRequest *request);
+
+  /**
+   * @brief Checks whether a request was turned away by `admit()`.
+   */
+  bool isRejected(AsyncWebServerRequest *request);
+
+  /**
+   * @brief Starts timing a handler callback on the calling task.
+   */
+  void beginCallback();
+
+  /**
+   * @brief Stops timing a handler callback and charges it to the request.
+   * @param request The request the callback ran for.
+   */
+  void endCallback(AsyncWebServerRequest *request);
+
+  /**
+   * @brief Releases a request's admission and records its totals, or forgets its rejection.
+   * @param request The request, once its client has disconnected.
+   */
+  void finish(AsyncWebServerRequest *request);
+
+  void getClassStats(RouteClass routeClass, ClassStats &stats);
+
+  /**
+   * @brief Copies one route's statistics.
+   * @param route The route ID.
+   * @param stats Receives the statistics.
+   * @return False if no route has that ID.
+   */
+  bool getRouteStats(int route, RouteStats &stats);
+
+private:
+  HttpAdmission();
+  HttpAdmission(const HttpAdmission &) = delete;
+  HttpAdmission &operator=(const HttpAdmission &) = delete;
+
+  /// @brief An admitted request and the handler time charged to it so far.
+  struct InFlight
+  {
+    AsyncWebServerRequest *request;
+    int route;
+    uint32_t handlerUs;
+    uint32_t lockWaitUs;
+  };
+
+  /// @brief The registered routes and their most recent samples.
+  struct Route
+  {
+    const char *uri;
+    RouteClass routeClass;
+    uint32_t requests;
+    uint32_t rejected;
+    uint32_t maxUs;
+    uint32_t lockWaitMaxUs;
+    uint32_t handlerUs[RING_SIZE];
+    uint32_t lockWaitUs[RING_SIZE];
+    uint16_t next;
+    uint16_t count;
+  };
+
+  InFlight *find(AsyncWebServerRequest *request);
+  static uint32_t p95(const uint32_t *ring, int count);
+
+  Route *_routes = nullptr; ///< MAX_ROUTES entries, in PSRAM.
+  int _routeCount = 0;
+  InFlight _inFlight[MAX_IN_FLIGHT] = {};
+  AsyncWebServerRequest *_rejected[MAX_REJECTED] = {};
+  ClassStats _classes[ROUTE_CLASS_COUNT] = {};
+  uint32_t _callbackStart = 0;
+  SemaphoreHandle_t _mutex;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include <cstdint>
+
+/// @brief The servers the clock fetches from; each has its own connection.
+enum HttpsHost
+{
+  HTTPS_HOST_WEATHER,         ///< api.open-meteo.com
+  HTTPS_HOST_GEOCODING,       ///< geocoding-api.open-meteo.com
+  HTTPS_HOST_GITHUB_API,      ///< api.github.com
+  HTTPS_HOST_GITHUB_DOWNLOAD, ///< github.com release assets, which redirect to a CDN.
+  HTTPS_HOST_COUNT
+};
+
+/// @brief Per-host request counters and timings, for the stats API.
+struct HttpsHostStats
+{
+  const char *host;         ///< The host name.
+  uint32_t requests;        ///< Requests made.
+  uint32_t reused;          ///< Requests sent on a kept-alive connection.
+  uint32_t handshakes;      ///< New TLS connections made.
+  uint32_t failures;        ///< Requests that got no HTTP response.
+  uint32_t lastHandshakeMs; ///< Time taken by the latest TLS handshake.
+  uint32_t maxHandshakeMs;  ///< Longest TLS handshake.
+  uint32_t lastTransferMs;  ///< Time from sending the latest request to reading its body.
+  uint32_t maxTransferMs;   ///< Longest request-to-body time.
+};
+
+/**
+ * @class HttpsClient
+ * @brief Owns the outbound HTTPS connections, one per host.
+ *
+ * Each host keeps its `WiFiClientSecure` and `HTTPClient` between requests,
+ * so a request that follows another to the same host within
+ * HTTPS_IDLE_TIMEOUT goes out on the open connection and skips the TLS
+ * handshake and its transient heap. `closeIdle()` closes connections that
+ * have sat unused longer than that, freeing their TLS buffers.
+ *
+ * A host's connection is held by one `Request` at a time; a second task
+ * asking for the same host waits.
+ */
+class HttpsClient
+{
+public:
+  /**
+   * @brief Gets the singleton instance of the HttpsClient.
+   * @return A reference to the HttpsClient instance.
+   */
+  static HttpsClient &getInstance()
+  {
+    static HttpsClient instance;
+    return instance;
+  }
+
+  /**
+   * @class Request
+   * @brief Holds a host's connection for one request.
+   *
+   * Call `end()` once the body has been read, so the transfer time covers
+   * only the request; the destructor ends the request if that wasn't done.
+   * A task that deletes itself must call `end()` first, since its
+   * destructors never run.
+   */
+  class Request
+  {
+  public:
+    /**
+     * @brief Takes the host's connection, waiting while another task has it.
+     * @param host The host the request goes to.
+     */
+    explicit Request(HttpsHost host);
+    ~Request();
+
+    /**
+     * @brief Sends a GET, on the open connection if there is one.
+     *
+     * If a kept-alive connection turns out to have been dropped by the
+     * server, the request is retried once on a new connection.
+     * @param url The full https:// URL.
+     * @return The HTTP status code, or a negative HTTPC_ERROR_* code.
+     */
+    int get(const String &url);
+
+    /**
+     * @brief Gets the HTTP client, for reading the response.
+     * @return The host's HTTP client.
+     */
+    HTTPClient &http();
+
+    /**
+     * @brief Finishes the request, keeping the connection open if the server allows it.
+     */
+    void end();
+
+    Request(const Request &) = delete;
+    Request &operator=(const Request &) = delete;
+
+  private:
+    HttpsHost _host;
+    bool _held = false;      ///< Whether the connection is still held.
+    int64_t _sentMicros = 0; ///< esp_timer_get_time() when the request was sent; 0 if never.
+  };
+
+  /**
+   * @brief Closes connections that have been idle for HTTPS_IDLE_TIMEOUT.
+   * Call periodically; a connection that's in use is skipped.
+   */
+  void closeIdle();
+
+  /**
+   * @brief Gets a host's request counters and timings.
+   * @param host The host.
+   * @return The stats.
+   */
+  HttpsHostStats getStats(HttpsHost host) const;
+
+  HttpsClient(const HttpsClient &) = delete;
+  HttpsClient &operator=(const HttpsClient &) = delete;
+
+private:
+  HttpsClient();
+
+  /// @brief One host's connection and its bookkeeping.
+  struct Connection
+  {
+    WiFiClientSecure client;
+    HTTPClient http;
+    SemaphoreHandle_t mutex;
+    bool keepAlive;         ///< False for hosts whose responses redirect elsewhere.
+    char connectedHost[64]; ///< Host the client is connected to; empty if none.
+    unsigned long lastUsed; ///< millis() when the last request ended.
+    HttpsHostStats stats;
+  };
+
+  /**
+   * @brief Opens a TLS connection to a URL's host, timing the handshake.
+   * @param connection The connection to open.
+   * @param url The URL being requested.
+   * @return True if connected.
+   */
+  bool connect(Connection &connection, const String &url);
+
+  Connection _connections[HTTPS_HOST_COUNT];
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include <cstdint>
+
+/// @brief Bus activity counters, for the stats API.
+struct I2cBusStats
+{
+  uint32_t transactions; ///< Times the bus was taken, by any task.
+  uint32_t writesQueued; ///< Writes handed to the bus task.
+  uint32_t maxWaitUs;    ///< Longest wait to take the bus.
+  uint32_t sensorAgeMs;  ///< Age of the cached sensor readings.
+};
+
+/**
+ * @class I2cBus
+ * @brief Owns the I2C bus shared by the DS3231 and the BME280.
+ *
+ * A task pinned to I2C_TASK_CORE reads the sensors in one batch halfway
+ * through every SENSOR_UPDATE_INTERVAL slot of SensorHistory and publishes
+ * them through SensorModule's cache, so no other task waits on a slow BME280
+ * read. Writes that callers don't need to wait for, such as setting the
+ * RTC, are queued and run on the same task.
+ *
+ * Anything that still has to talk to a device directly, such as hunting for
+ * the RTC's second edge or programming its alarms, takes a `Lock` first, so
+ * transactions from different tasks and cores never interleave.
+ */
+class I2cBus
+{
+public:
+  /// @brief Called on the bus task once a queued RTC write has been made.
+  /// @param time The time written.
+  /// @param writtenMicros esp_timer_get_time() as the write started.
+  typedef void (*RtcAdjustedCallback)(const DateTime &time, int64_t writtenMicros);
+
+  /**
+   * @brief Gets the singleton instance of the I2cBus.
+   * @return A reference to the I2cBus instance.
+   */
+  static I2cBus &getInstance()
+  {
+    static I2cBus instance;
+    return instance;
+  }
+
+  /**
+   * @class Lock
+   * @brief Holds the bus for a run of direct transactions.
+   *
+   * The lock is recursive, so a holder may call code that takes it again.
+   */
+  class Lock
+  {
+  public:
+    Lock();
+    ~Lock();
+    Lock(const Lock &) = delete;
+    Lock &operator=(const Lock &) = delete;
+  };
+
+  /**
+   * @brief Starts the bus task. Call once the sensors are set up.
+   */
+  void startTask();
+
+  /**
+   * @brief Queues a write of the RTC's time.
+   *
+   * Before the task is started the write is made straight away.
+   * @param time The new local time.
+   * @param atMicros esp_timer_get_time() at which to make the write, so the
+   *                 RTC's second starts then; 0 to write as soon as possible.
+   * @param done Called after the write, on the writing task; may be null.
+   */
+  void queueRtcAdjust(const DateTime &time, int64_t atMicros, RtcAdjustedCallback done);
+
+  /**
+   * @brief Asks the bus task to read the sensors now rather than at the next interval.
+   */
+  void requestSensorRead();
+
+  /**
+   * @brief Gets the bus activity counters.
+   * @return The counters.
+   */
+  I2cBusStats getStats() const;
+
+  I2cBus(const I2cBus &) = delete;
+  I2cBus &operator=(const I2cBus &) = delete;
+
+private:
+  I2cBus();
+
+  /// @brief The kinds of work queued for the bus task.
+  enum RequestType
+  {
+    I2C_REQUEST_RTC_ADJUST,
+    I2C_REQUEST_SENSOR_READ
+  };
+
+  /// @brief One queued piece of work.
+  struct Request
+  {
+    RequestType type;
+    uint32_t time;    ///< For I2C_REQUEST_RTC_ADJUST, the unixtime to write.
+    int64_t atMicros; ///< For I2C_REQUEST_RTC_ADJUST, when to write it; 0 = now.
+    RtcAdjustedCallback done;
+  };
+
+  /**
+   * @brief Runs one queued request.
+   * @param request The request.
+   */
+  void handle(const Request &request);
+
+  /**
+   * @brief The bus task loop.
+   * @param param The I2cBus instance.
+   */
+  static void busTask(void *param);
+
+  SemaphoreHandle_t _mutex;
+  QueueHandle_t _queue;
+  TaskHandle_t _taskHandle = nullptr;
+  unsigned long _lastSensorRead = 0; ///< millis() of the last batch read.
+  int64_t _nextSensorReadMs = 0;     ///< esp_timer time, in ms, of the next scheduled batch read.
+
+  uint32_t _transactions = 0;
+  uint32_t _writesQueued = 0;
+  uint32_t _maxWaitUs = 0;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class JsonResponse
+ * @brief Sends `/api` JSON replies without building them in the internal heap.
+ *
+ * Handlers create their document with `allocator()`, so its pool lives in
+ * PSRAM, and hand it to `send()`. The document is measured, serialized once
+ * into a PSRAM buffer of exactly that size, and streamed from there; the
+ * buffer is freed when the response is done. No `String` copy of the body is
+ * ever made.
+ *
+ * Endpoints whose payload only changes with some generation counters can
+ * use `sendCached()` instead: the serialized bytes are kept with the key they
+ * were built for, and repeat requests with the same key are served as a copy
+ * without rebuilding the document.
+ *
+ * The serialized size and cache hits of every endpoint are recorded so the
+ * largest and most rebuilt replies can be spotted from `/api/system/stats`.
+ */
+class JsonResponse
+{
+public:
+  static constexpr int MAX_ENDPOINTS = 16; ///< Number of endpoints whose sizes are tracked.
+
+  /// @brief Serialized sizes recorded for one endpoint.
+  struct EndpointStats
+  {
+    const char *endpoint; ///< The endpoint path.
+    uint32_t requests;    ///< Replies sent.
+    uint32_t lastBytes;   ///< Size of the latest reply.
+    uint32_t maxBytes;    ///< Size of the largest reply.
+    uint32_t cacheHits;   ///< Replies served from the cache by `sendCached()`.
+    uint32_t cacheMisses; ///< Replies `sendCached()` had to build.
+  };
+
+  /// @brief Fills a document with an endpoint's payload.
+  using Builder = void (*)(JsonDocument &doc);
+
+  /**
+   * @brief Gets the singleton instance of the JsonResponse.
+   * @return A reference to the JsonResponse instance.
+   */
+  static JsonResponse &getInstance()
+  {
+    static JsonResponse instance;
+    return instance;
+  }
+
+  /**
+   * @brief Gets the PSRAM allocator that API documents should be created with.
+   * @return The allocator, for `JsonDocument doc(JsonResponse::getInstance().allocator());`.
+   */
+  ArduinoJson::Allocator *allocator();
+
+  /**
+   * @brief Counts the blocks `allocator()` has handed out or resized since boot.
+   */
+  uint32_t allocations();
+
+  /**
+   * @brief Serializes a document and sends it as the reply to a request.
+   * @param request The incoming web request.
+   * @param endpoint The endpoint path the size is recorded under; must be a string literal.
+   * @param doc The document to send.
+   * @param code The HTTP status code.
+   */
+  void send(AsyncWebServerRequest *request, const char *endpoint, const JsonDocument &doc, int code = 200);
+
+  /**
+   * @brief Sends an endpoint's cached reply, rebuilding it only when its key changed.
+   * @param request The incoming web request.
+   * @param endpoint The endpoint path the reply is cached under; must be a string literal.
+   * @param key Packs every generation and setting the payload depends on.
+   * @param build Fills the document on a cache miss.
+   */
+  void sendCached(AsyncWebServerRequest *request, const char *endpoint, uint64_t key, Builder build);
+
+  /**
+   * @brief Copies the size statistics of one tracked endpoint.
+   * @param index The endpoint's slot, from 0 to MAX_ENDPOINTS - 1.
+   * @param stats Receives the statistics.
+   * @return False if the slot is unused.
+   */
+  bool getEndpointStats(int index, EndpointStats &stats);
+
+private:
+  JsonResponse();
+  JsonResponse(const JsonResponse &) = delete;
+  JsonResponse &operator=(const JsonResponse &) = delete;
+
+  /// @brief The last reply `sendCached()` built for an endpoint.
+  struct CacheEntry
+  {
+    std::shared_ptr<char> body; ///< Shared with responses still streaming it.
+    size_t length;
+    uint64_t key;
+  };
+
+  int slotFor(const char *endpoint);
+  std::shared_ptr<char> serialize(const JsonDocument &doc, size_t &length);
+  void stream(AsyncWebServerRequest *request, std::shared_ptr<char> body, size_t length, int code);
+
+  EndpointStats _endpoints[MAX_ENDPOINTS] = {};
+  CacheEntry _cache[MAX_ENDPOINTS];
+  SemaphoreHandle_t _mutex;
+};
@@ -2,14 +2,41 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+#include <cstdint>
+
+/**
+ * @brief Measures how long one task spends waiting for LockGuard mutexes.
+ *
+ * While `task` is set, every lock taken on that task adds its wait time to
+ * `waitUs`. Locks taken on other tasks only pay one comparison.
+ */
+struct LockWaitProbe
+{
+  static TaskHandle_t task; ///< The task being measured, or nullptr.
+  static uint32_t waitUs;   ///< Microseconds waited since the probe was last reset.
+
+  static bool active() { return task != nullptr && task == xTaskGetCurrentTaskHandle(); }
+};
 
 class LockGuard
 {
 public:
   LockGuard(SemaphoreHandle_t mutex) : _mutex(mutex)
   {
-    if (_mutex)
+    if (!_mutex)
+      return;
+    if (LockWaitProbe::active())
+    {
+      int64_t start = esp_timer_get_time();
+      xSemaphoreTake(_mutex, portMAX_DELAY);
+      LockWaitProbe::waitUs += (uint32_t)(esp_timer_get_time() - start);
+    }
+    else
+    {
       xSemaphoreTake(_mutex, portMAX_DELAY);
+    }
   }
   ~LockGuard()
   {
@@ -26,8 +53,18 @@ class RecursiveLockGuard
 public:
   RecursiveLockGuard(SemaphoreHandle_t mutex) : _mutex(mutex)
   {
-    if (_mutex)
+    if (!_mutex)
+      return;
+    if (LockWaitProbe::active())
+    {
+      int64_t start = esp_timer_get_time();
+      xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+      LockWaitProbe::waitUs += (uint32_t)(esp_timer_get_time() - start);
+    }
+    else
+    {
       xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    }
   }
   ~RecursiveLockGuard()
   {
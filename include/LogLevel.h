@@ -0,0 +1,45 @@
+#pragma once
+
+/// @brief Severity of a log message. A message is kept when its level is at or below the threshold.
+enum LogLevel
+{
+  LOG_LEVEL_NONE,    ///< As a threshold: log nothing.
+  LOG_LEVEL_ERROR,   ///< Something failed.
+  LOG_LEVEL_WARN,    ///< Something unexpected that was recovered from.
+  LOG_LEVEL_INFO,    ///< State changes worth keeping in the log.
+  LOG_LEVEL_DEBUG,   ///< Detail for tracking down a problem.
+  LOG_LEVEL_VERBOSE, ///< Per-tick or per-frame detail.
+};
+
+/// @brief Level names, as used by the crash log API.
+static constexpr const char *LOG_LEVEL_NAMES[] = {"none", "error", "warn", "info", "debug", "verbose"};
+
+/// @brief The subsystem a log message comes from, each with its own runtime threshold.
+enum LogModule
+{
+  LOG_MODULE_SYSTEM,
+  LOG_MODULE_ALARM,
+  LOG_MODULE_TIME,
+  LOG_MODULE_DISPLAY,
+  LOG_MODULE_WEB,
+  LOG_MODULE_WIFI,
+  LOG_MODULE_WEATHER,
+  LOG_MODULE_CONFIG,
+  LOG_MODULE_SENSOR,
+  LOG_MODULE_UPDATE,
+  LOG_MODULE_COUNT
+};
+
+/// @brief Module names, as used by the settings API and page.
+static constexpr const char *LOG_MODULE_NAMES[LOG_MODULE_COUNT] = {
+    "system", "alarm", "time", "display", "web", "wifi", "weather", "config", "sensor", "update"};
+
+static constexpr LogLevel DEFAULT_LOG_LEVEL = LOG_LEVEL_INFO; ///< Runtime threshold of every module by default.
+
+/**
+ * Messages above this level are compiled out entirely, arguments included.
+ * Set it with -DLOG_COMPILE_LEVEL=<0-5> in platformio.ini.
+ */
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 3 // LOG_LEVEL_INFO
+#endif
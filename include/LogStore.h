@@ -0,0 +1,132 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class LogStore
+ * @brief The persistent system log, kept as a ring of fixed-size segment files.
+ *
+ * Lines are gathered into a block-sized buffer and written through one
+ * long-lived handle to the newest segment, one whole LittleFS block at a time.
+ * `sync()` also writes the unfinished block, but only up to the end of that
+ * block, so later writes stay block-aligned. When a segment reaches
+ * LOG_STORE_SEGMENT_SIZE a new one is started and, once there are
+ * LOG_STORE_SEGMENTS, the oldest is removed.
+ *
+ * A small index file records each segment's sequence number and the time it
+ * was started, so a reader can skip straight to the segments after a given
+ * time. The log reads as the segments concatenated oldest first.
+ */
+class LogStore
+{
+public:
+  /// @brief One segment as seen by a reader.
+  struct Segment
+  {
+    uint32_t sequence;  ///< Grows by one per segment; names the file.
+    uint32_t startTime; ///< time() when the segment was started.
+    uint32_t size;      ///< Bytes in the segment.
+  };
+
+  /**
+   * @brief Gets the singleton instance of the LogStore.
+   * @return A reference to the LogStore instance.
+   */
+  static LogStore &getInstance()
+  {
+    static LogStore instance;
+    return instance;
+  }
+
+  /**
+   * @brief Loads the index and opens the newest segment. Call once LittleFS is mounted.
+   *
+   * Also removes the single-file log used by earlier firmware.
+   */
+  void begin();
+
+  /**
+   * @brief Adds log text, writing out each block as it fills.
+   *
+   * Before `begin()` the text is held in the block buffer until it is full.
+   * @param text The text.
+   * @param length The length of the text in bytes.
+   */
+  void append(const char *text, size_t length);
+
+  /**
+   * @brief Writes the unfinished block out and flushes the segment file.
+   */
+  void sync();
+
+  /**
+   * @brief Syncs if there is unwritten text and `interval` ms have passed since the last sync.
+   * @param interval The sync interval in ms.
+   */
+  void syncIfDue(unsigned long interval);
+
+  /**
+   * @brief Closes the newest segment and starts a new one.
+   */
+  void roll();
+
+  /**
+   * @brief Syncs and lists the segments, oldest first.
+   * @param out Receives up to LOG_STORE_SEGMENTS entries.
+   * @return The number of segments.
+   */
+  size_t snapshot(Segment *out);
+
+  /**
+   * @brief Formats the path of a segment file.
+   * @param buf The buffer to write the path to.
+   * @param size The size of the buffer.
+   * @param sequence The segment's sequence number.
+   */
+  static void segmentPath(char *buf, size_t size, uint32_t sequence);
+
+  LogStore(const LogStore &) = delete;
+  LogStore &operator=(const LogStore &) = delete;
+
+private:
+  LogStore();
+
+  /// @brief An index entry as stored in the index file.
+  struct IndexEntry
+  {
+    uint32_t sequence;
+    uint32_t startTime;
+  };
+
+  IndexEntry _index[LOG_STORE_SEGMENTS];
+  size_t _count = 0;           ///< Segments in `_index`; the last one is being written.
+  File _active;                ///< The newest segment, kept open for appending.
+  uint32_t _activeSize = 0;    ///< Bytes written to the newest segment.
+  char *_block = nullptr;      ///< LOG_STORE_BLOCK_SIZE bytes, in PSRAM.
+  size_t _fill = 0;            ///< Bytes of the current block filled.
+  size_t _written = 0;         ///< Bytes of the current block already in the file.
+  unsigned long _lastSync = 0; ///< millis() of the last sync.
+  SemaphoreHandle_t _mutex;
+
+  /**
+   * @brief Writes the part of the block not yet in the file, and rolls the segment when it is full.
+   */
+  void writePending();
+
+  /**
+   * @brief Adds a new segment to the index and opens it, removing the oldest if needed.
+   */
+  void startSegment();
+
+  /**
+   * @brief Writes the index file.
+   */
+  void saveIndex();
+};
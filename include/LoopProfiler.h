@@ -0,0 +1,168 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <cstdint>
+
+/**
+ * Scope timers are compiled in unless this is 0; at 0 every
+ * LOOP_PROFILE_SCOPE() and LOOP_PROFILE_WAKE() expands to nothing.
+ * Set it with -DLOOP_PROFILER_ENABLED=0 in platformio.ini.
+ */
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED 1
+#endif
+
+/// @brief The timed steps of loop() and the logic task.
+enum LoopScope : uint8_t
+{
+  LOOP_SCOPE_ALARMS,         ///< loop(): alarmManager.update()
+  LOOP_SCOPE_SNOOZE,         ///< loop(): RTC alarm handling and snooze states
+  LOOP_SCOPE_BRIGHTNESS,     ///< loop(): display.updateBrightness()
+  LOOP_SCOPE_CONFIG_CHANGES, ///< loop(): reacting to changed settings
+  LOOP_SCOPE_ALARM_STATE,    ///< loop(): the alarm state machine to the end of loop(), alarm icon included
+  LOOP_SCOPE_ALARM_ICON,     ///< loop(): displayManager.drawAlarmIcon()
+  LOOP_SCOPE_WIFI,           ///< Logic task: DNS and wifiManager.handleConnection()
+  LOOP_SCOPE_CONFIG,         ///< Logic task: config.loop()
+  LOOP_SCOPE_WEATHER,        ///< Logic task: weatherService.loop()
+  LOOP_SCOPE_NTP,            ///< Logic task: NTP update and drift checks
+  LOOP_SCOPE_EVENTS,         ///< Logic task: publishing /api/events
+  LOOP_SCOPE_COUNT
+};
+
+/// @brief Scope names, as used by the perf endpoint.
+static constexpr const char *LOOP_SCOPE_NAMES[LOOP_SCOPE_COUNT] = {
+    "loop.alarms", "loop.snooze", "loop.brightness", "loop.configChanges", "loop.alarmState", "loop.alarmIcon",
+    "logic.wifi", "logic.config", "logic.weather", "logic.ntp", "logic.events"};
+
+/**
+ * @class LoopProfiler
+ * @brief Times the steps of loop() and the logic task, and the loop's period.
+ *
+ * A `LOOP_PROFILE_SCOPE()` at the top of a block times that block with
+ * esp_timer, which unlike the cycle counter keeps its rate while the
+ * power manager scales the CPU clock, and stores the duration in its scope's ring. The last
+ * `WINDOW` durations of each scope give its min/avg/p99/max. loop() also
+ * reports each wake, and the deviation of its period from `LOOP_INTERVAL`
+ * is counted into a histogram; wakes an ISR caused early are counted apart.
+ *
+ * Every scope is recorded from a single task and each record is a few
+ * stores under a spinlock, so the timers can stay in release builds.
+ */
+class LoopProfiler
+{
+public:
+  static constexpr int WINDOW = 128;       ///< Durations kept per scope.
+  static constexpr int JITTER_BUCKETS = 7; ///< Period deviation buckets, the last one unbounded.
+  static const uint32_t JITTER_LIMITS_US[JITTER_BUCKETS - 1]; ///< Upper bound of every bucket but the last.
+
+  /// @brief Durations of one scope over its window, in microseconds.
+  struct ScopeStats
+  {
+    uint32_t calls; ///< Calls since boot.
+    uint32_t minUs;
+    uint32_t avgUs;
+    uint32_t p99Us;
+    uint32_t maxUs;
+  };
+
+  /// @brief Deviation of loop()'s period from LOOP_INTERVAL since boot.
+  struct JitterStats
+  {
+    uint32_t periods;    ///< Wakes on the timer, counted into the buckets.
+    uint32_t earlyWakes; ///< Wakes an ISR caused before the interval was up.
+    uint32_t maxUs;      ///< Largest deviation seen.
+    uint64_t totalUs;    ///< Sum of the deviations.
+    uint32_t buckets[JITTER_BUCKETS];
+  };
+
+  /**
+   * @brief Gets the singleton instance of the LoopProfiler.
+   * @return A reference to the LoopProfiler instance.
+   */
+  static LoopProfiler &getInstance()
+  {
+    static LoopProfiler instance;
+    return instance;
+  }
+
+  /// @brief Whether the scope timers are compiled in.
+  static constexpr bool isEnabled() { return LOOP_PROFILER_ENABLED; }
+
+  /**
+   * @brief Stores one timed run of a scope.
+   * @param scope The scope.
+   * @param us Its duration in microseconds.
+   */
+  void record(LoopScope scope, uint32_t us);
+
+  /**
+   * @brief Notes that loop() woke up, for the period histogram.
+   * @param wokenEarly True if an ISR woke it before `LOOP_INTERVAL` was up.
+   */
+  void markLoopWake(bool wokenEarly);
+
+  /**
+   * @brief Computes the statistics of one scope's window.
+   * @param scope The scope.
+   * @param stats Receives the statistics.
+   * @return False if the scope has not run yet.
+   */
+  bool getScopeStats(LoopScope scope, ScopeStats &stats);
+
+  /**
+   * @brief Copies the loop period histogram.
+   * @param stats Receives the histogram.
+   */
+  void getJitterStats(JitterStats &stats);
+
+  LoopProfiler(const LoopProfiler &) = delete;
+  LoopProfiler &operator=(const LoopProfiler &) = delete;
+
+private:
+  LoopProfiler() = default;
+
+  /// @brief The most recent durations of one scope, in microseconds.
+  struct Ring
+  {
+    uint32_t us[WINDOW];
+    uint16_t next;
+    uint16_t count;
+    uint32_t calls;
+  };
+
+  Ring _rings[LOOP_SCOPE_COUNT] = {};
+  JitterStats _jitter = {};
+  uint32_t _lastWakeUs = 0;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+/**
+ * @class ScopeTimer
+ * @brief Records the time from its construction to the end of its block.
+ */
+class ScopeTimer
+{
+public:
+  explicit ScopeTimer(LoopScope scope) : _scope(scope), _start(esp_timer_get_time()) {}
+  ~ScopeTimer() { LoopProfiler::getInstance().record(_scope, (uint32_t)(esp_timer_get_time() - _start)); }
+
+  ScopeTimer(const ScopeTimer &) = delete;
+  ScopeTimer &operator=(const ScopeTimer &) = delete;
+
+private:
+  LoopScope _scope;
+  int64_t _start;
+};
+
+#define LOOP_PROFILE_CONCAT_(a, b) a##b
+#define LOOP_PROFILE_CONCAT(a, b) LOOP_PROFILE_CONCAT_(a, b)
+
+/// @brief Times the rest of the enclosing block as `scope`.
+#if LOOP_PROFILER_ENABLED
+#define LOOP_PROFILE_SCOPE(scope) ScopeTimer LOOP_PROFILE_CONCAT(_scopeTimer, __LINE__)(scope)
+#define LOOP_PROFILE_WAKE(wokenEarly) LoopProfiler::getInstance().markLoopWake(wokenEarly)
+#else
+#define LOOP_PROFILE_SCOPE(scope) ((void)0)
+#define LOOP_PROFILE_WAKE(wokenEarly) ((void)(wokenEarly))
+#endif
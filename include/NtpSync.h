@@ -97,4 +97,26 @@ void resetNtpSync();
  * @return A DateTime object representing the current NTP time. If the sync
  *         fails, the returned object will be invalid (`!isValid()`).
  */
-DateTime getNtpTime();
\ No newline at end of file
+DateTime getNtpTime();
+
+/**
+ * @brief Reads the system clock, kept by the SNTP daemon, as local time to the microsecond.
+ * @param localUs Receives the local time, in microseconds since the epoch.
+ * @param readMicros Receives esp_timer_get_time() at the moment of the read.
+ * @return False if the system clock has never been set.
+ */
+bool getNtpTimeMicros(int64_t &localUs, int64_t &readMicros);
+
+/**
+ * @brief Checks whether the SNTP daemon has set the system clock since the last call.
+ *
+ * Each daemon sync is a fresh comparison point for the RTC drift model.
+ * @return True once per daemon sync.
+ */
+bool takeSntpSyncEvent();
+
+/**
+ * @brief Changes how often the SNTP daemon polls its server.
+ * @param intervalMs The poll interval, in ms.
+ */
+void setNtpSyncInterval(uint32_t intervalMs);
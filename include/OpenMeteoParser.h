@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+#include "WeatherService.h"
+#include <cstdint>
+
+/**
+ * @class OpenMeteoParser
+ * @brief Parses an Open-Meteo forecast response as it streams in.
+ *
+ * The parser is a `Stream` sink for `HTTPClient::writeToStream()`, so the
+ * body goes from the socket buffer into the parser a chunk at a time without
+ * ever being held whole. It tracks only the container nesting and the keys
+ * of the two outer levels, and writes each value it knows straight into the
+ * `WeatherData` and the fixed arrays of the `WeatherForecast`. Its memory is
+ * the object itself, whatever the size of the response; hours and days past
+ * the arrays' capacity are skipped.
+ *
+ * It also samples the free internal heap as each chunk arrives, so a fetch
+ * can report how far it drew the heap down.
+ */
+class OpenMeteoParser : public Stream
+{
+public:
+  /**
+   * @brief Starts a parse.
+   * @param current Receives the `current` block and the first sunrise and sunset.
+   * @param forecast Receives the `hourly` and `daily` series; null to skip them.
+   */
+  OpenMeteoParser(WeatherData &current, WeatherForecast *forecast);
+
+  /**
+   * @brief Checks that the whole response was read and understood.
+   * @return True if the document was well formed and had a `current` block.
+   */
+  bool finish() const;
+
+  /// @brief Bytes of body parsed.
+  size_t bytes() const { return _bytes; }
+
+  /// @brief The least free internal heap seen while the body arrived.
+  size_t minFreeHeap() const { return _minFreeHeap; }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+
+private:
+  static constexpr uint8_t MAX_DEPTH = 4;   ///< Deepest nesting expected; deeper fails the parse.
+  static constexpr uint8_t KEY_LEVELS = 2;  ///< Levels whose current key is kept.
+  static constexpr uint8_t TOKEN_SIZE = 32; ///< Longest key or value kept; longer ones are cut.
+
+  enum LexState : uint8_t
+  {
+    LEX_VALUE,         ///< Between tokens.
+    LEX_STRING,        ///< Inside a string.
+    LEX_STRING_ESCAPE, ///< After a backslash in a string.
+    LEX_LITERAL        ///< Inside a number, true, false or null.
+  };
+
+  /// @brief Feeds one character to the lexer.
+  void feed(char c);
+  void open(char type);
+  void close(char type);
+  void append(char c);
+
+  /// @brief Handles a completed string, either a key or a value.
+  void endString();
+
+  /**
+   * @brief Stores a scalar value if its path is one the clock uses.
+   * @param isString Whether the token was a quoted string.
+   */
+  void value(bool isString);
+  void currentValue(const char *key);
+  void seriesValue(const char *block, const char *key, uint16_t index);
+
+  WeatherData &_current;
+  WeatherForecast *_forecast;
+
+  LexState _lex = LEX_VALUE;
+  uint8_t _depth = 0;
+  char _types[MAX_DEPTH] = {};        ///< '{' or '[' for each open container.
+  uint16_t _index[MAX_DEPTH] = {};    ///< Element index within each open array.
+  char _keys[KEY_LEVELS][TOKEN_SIZE] = {};
+  bool _expectKey = false;
+  char _token[TOKEN_SIZE] = {};
+  uint8_t _tokenLength = 0;
+
+  bool _sawRoot = false;
+  bool _sawCurrent = false;
+  bool _failed = false;
+  size_t _bytes = 0;
+  size_t _minFreeHeap = SIZE_MAX;
+};
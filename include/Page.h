@@ -1,6 +1,8 @@
 #pragma once
 
 #include <TFT_eSPI.h>
+#include <RTClib.h>
+#include "Display.h"
 
 /**
  * @class Page
@@ -48,4 +50,44 @@ public:
    * @param fullRefresh If true, a full redraw is required.
    */
   virtual void refresh(TFT_eSPI &tft, bool fullRefresh) {}
+
+  /**
+   * @brief Called after a frame to draw what the next second will show ahead of time.
+   *
+   * Whatever is drawn here must stay off the screen until the next `render()`,
+   * which then only has to push it. Pages that don't show the seconds can
+   * ignore it.
+   * @param next The time the next second will show.
+   */
+  virtual void prerenderSecond(const DateTime &next) {}
+
+protected:
+  /**
+   * @brief Pushes a sprite to the screen through the display's DMA pipeline.
+   *
+   * Use this instead of `TFT_eSprite::pushSprite()` so the transfer overlaps
+   * with rasterizing the next sprite.
+   * @param sprite The sprite to push.
+   * @param x The screen x-coordinate.
+   * @param y The screen y-coordinate.
+   */
+  void pushSprite(TFT_eSprite &sprite, int32_t x, int32_t y)
+  {
+    Display::getInstance().pushSprite(sprite, x, y);
+  }
+
+  /**
+   * @brief Pushes a region of a sprite through the display's DMA pipeline.
+   * @param sprite The sprite to push from.
+   * @param x The screen x-coordinate the sprite's top-left corner maps to.
+   * @param y The screen y-coordinate the sprite's top-left corner maps to.
+   * @param sx The x-coordinate of the region within the sprite.
+   * @param sy The y-coordinate of the region within the sprite.
+   * @param sw The width of the region.
+   * @param sh The height of the region.
+   */
+  void pushSprite(TFT_eSprite &sprite, int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t sw, int32_t sh)
+  {
+    Display::getInstance().pushSprite(sprite, x, y, sx, sy, sw, sh);
+  }
 };
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_pm.h>
+#include "Constants.h"
+#include <cstdint>
+
+/// @brief The activities that hold the CPU at full speed while they run.
+enum PowerLockKind : uint8_t
+{
+  POWER_LOCK_DISPLAY, ///< SPI transfers to the TFT, for as long as the display is locked.
+  POWER_LOCK_NETWORK, ///< Outbound HTTPS requests, so TLS runs at full speed.
+  POWER_LOCK_OTA,     ///< A firmware update, from start to reboot or failure.
+  POWER_LOCK_COUNT
+};
+
+/// @brief Lock names, as used by the perf endpoint.
+static constexpr const char *POWER_LOCK_NAMES[POWER_LOCK_COUNT] = {"display", "network", "ota"};
+
+/// @brief The CPU clocks residency is counted for.
+static constexpr uint16_t POWER_FREQUENCIES_MHZ[] = {80, 160, 240};
+static constexpr int POWER_FREQUENCY_COUNT = sizeof(POWER_FREQUENCIES_MHZ) / sizeof(POWER_FREQUENCIES_MHZ[0]);
+
+/**
+ * @class PowerManager
+ * @brief Runs the CPU slow whenever nothing needs it fast.
+ *
+ * `begin()` configures esp_pm to scale the CPU between
+ * `POWER_MIN_CPU_FREQ_MHZ` and the boot frequency. The tasks already block
+ * on notifications, queues and timers, so the CPU is idle between the
+ * loop's 100 ms passes and the render task's frames.
+ *
+ * The activities in `PowerLockKind` hold a PM lock for as long as they
+ * run; counted `acquire()`/`release()` pairs nest. Light sleep is not used:
+ * it needs tickless idle, which the precompiled Arduino framework is not
+ * built with. If that framework is also built without PM support, esp_pm
+ * refuses the configuration and the CPU stays at the boot frequency.
+ *
+ * A tick hook on core 0 samples the CPU clock every tick, so the
+ * residency at each frequency shows what the scaling actually achieved.
+ */
+class PowerManager
+{
+public:
+  /// @brief How long one lock has been held.
+  struct LockStats
+  {
+    uint32_t acquisitions; ///< Times it went from free to held.
+    uint64_t heldUs;       ///< Total time held, including the current hold.
+    bool held;
+  };
+
+  /**
+   * @brief Gets the singleton instance of the PowerManager.
+   * @return A reference to the PowerManager instance.
+   */
+  static PowerManager &getInstance()
+  {
+    static PowerManager instance;
+    return instance;
+  }
+
+  /**
+   * @brief Turns on frequency scaling.
+   */
+  void begin();
+
+  /// @brief Whether esp_pm accepted the configuration, i.e. the clock is being scaled.
+  bool isActive() const { return _active; }
+
+  /**
+   * @brief Holds the CPU at full speed until the matching `release()`.
+   * @param kind The activity.
+   */
+  void acquire(PowerLockKind kind);
+
+  /**
+   * @brief Ends one `acquire()` of an activity.
+   * @param kind The activity.
+   */
+  void release(PowerLockKind kind);
+
+  /**
+   * @brief Gets one lock's statistics.
+   * @param kind The lock.
+   * @param stats Receives the statistics.
+   */
+  void getLockStats(PowerLockKind kind, LockStats &stats);
+
+  /**
+   * @brief Gets the time spent at each CPU clock since `begin()`.
+   * @param residencyMs Receives one figure per entry of `POWER_FREQUENCIES_MHZ`, in ms.
+   * @return The total sampled time, in ms; 0 if the tick hook could not be registered.
+   */
+  uint32_t getResidency(uint32_t residencyMs[POWER_FREQUENCY_COUNT]) const;
+
+  PowerManager(const PowerManager &) = delete;
+  PowerManager &operator=(const PowerManager &) = delete;
+
+private:
+  PowerManager();
+
+  static void IRAM_ATTR onTick();
+
+  // Written only by the tick hook on core 0.
+  static volatile uint32_t s_frequencyTicks[POWER_FREQUENCY_COUNT];
+
+  esp_pm_lock_handle_t _locks[POWER_LOCK_COUNT] = {};
+  uint16_t _holds[POWER_LOCK_COUNT] = {}; ///< Outstanding acquires of each lock.
+  int64_t _heldSince[POWER_LOCK_COUNT] = {};
+  LockStats _stats[POWER_LOCK_COUNT] = {};
+  bool _active = false;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <cstdint>
+
+/**
+ * @class RenderProfiler
+ * @brief Records what each rendered frame cost, per page.
+ *
+ * The render task brackets every frame with `beginFrame()` / `endFrame()`,
+ * and the display reports the time and pixels of each sprite push in
+ * between. The last `RING_SIZE` frames of every page are kept in a fixed
+ * ring, from which p50/p95/max figures are computed on request.
+ *
+ * Collection is off by default. While it is off, every hook returns after
+ * testing a single flag.
+ */
+class RenderProfiler
+{
+public:
+  static constexpr int MAX_PAGES = 8;  ///< Number of page indices that are tracked.
+  static constexpr int RING_SIZE = 64; ///< Frames kept per page.
+
+  /// @brief p50, p95 and maximum of one quantity over the frames in a ring.
+  struct Percentiles
+  {
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t max;
+  };
+
+  /// @brief Summary of the frames recorded for one page.
+  struct PageStats
+  {
+    uint32_t frames;       ///< Frames in the ring (at most RING_SIZE).
+    Percentiles frameUs;   ///< Whole frame, in microseconds.
+    Percentiles rasterUs;  ///< Frame time not spent pushing pixels, in microseconds.
+    Percentiles pushUs;    ///< Time spent queuing and draining sprite pushes, in microseconds.
+    Percentiles pixels;    ///< Pixels pushed per frame.
+    uint32_t fontLoads;    ///< Font parses during the frames in the ring.
+    uint32_t fontSwitches; ///< Font switches during the frames in the ring.
+  };
+
+  /**
+   * @brief Gets the singleton instance of the RenderProfiler.
+   * @return A reference to the RenderProfiler instance.
+   */
+  static RenderProfiler &getInstance()
+  {
+    static RenderProfiler instance;
+    return instance;
+  }
+
+  /**
+   * @brief Turns collection on or off. Turning it on starts with empty rings.
+   * @param enabled True to record frames.
+   */
+  void setEnabled(bool enabled);
+
+  bool isEnabled() const { return _enabled; }
+
+  /**
+   * @brief Starts timing a frame.
+   * @param page The index of the page being rendered.
+   */
+  void beginFrame(int page);
+
+  /**
+   * @brief Finishes the current frame and stores it in its page's ring.
+   */
+  void endFrame();
+
+  /**
+   * @brief Adds a sprite push to the current frame. Ignored outside a frame.
+   * @param us The time the push took, in microseconds.
+   * @param pixels The number of pixels pushed.
+   */
+  void addPush(uint32_t us, uint32_t pixels)
+  {
+    if (_inFrame)
+    {
+      _pushUs += us;
+      _pixels += pixels;
+    }
+  }
+
+  /**
+   * @brief Computes the statistics of one page's ring.
+   * @param page The page index.
+   * @param stats Receives the statistics.
+   * @return False if no frames were recorded for the page.
+   */
+  bool getPageStats(int page, PageStats &stats);
+
+private:
+  RenderProfiler();
+  RenderProfiler(const RenderProfiler &) = delete;
+  RenderProfiler &operator=(const RenderProfiler &) = delete;
+
+  /// @brief One recorded frame.
+  struct Sample
+  {
+    uint32_t frameUs;
+    uint32_t pushUs;
+    uint32_t pixels;
+    uint16_t fontLoads;
+    uint16_t fontSwitches;
+  };
+
+  /// @brief The most recent frames of one page.
+  struct Ring
+  {
+    Sample samples[RING_SIZE];
+    uint16_t next;
+    uint16_t count;
+  };
+
+  static Percentiles percentiles(uint32_t *values, int count);
+
+  volatile bool _enabled = false;
+  bool _inFrame = false;
+  int _page = -1;
+  uint32_t _frameStart = 0;
+  uint32_t _pushUs = 0;
+  uint32_t _pixels = 0;
+  uint32_t _fontLoadsAtStart = 0;
+  uint32_t _fontSwitchesAtStart = 0;
+
+  Ring _rings[MAX_PAGES];
+  SemaphoreHandle_t _mutex;
+};
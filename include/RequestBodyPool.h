@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct RequestBody
+ * @brief A POST body collected into one of the pool's buffers.
+ */
+struct RequestBody
+{
+  char *data;    ///< The body bytes, followed by a terminating zero once complete.
+  size_t length; ///< Bytes received so far.
+  size_t total;  ///< The request's Content-Length.
+};
+
+/**
+ * @class RequestBodyPool
+ * @brief A fixed set of PSRAM buffers that POST bodies are gathered into.
+ *
+ * The buffers are reserved once, so collecting a body never touches the
+ * internal heap, and a free slot is found in O(1) from a bitmask. Each body is
+ * checked against its Content-Length before any data is kept: a body over the
+ * handler's limit gets 413, and a request that finds every slot busy gets
+ * 503. The body is parsed straight out of its buffer.
+ *
+ * Handlers use `collect()` from their body callback and `release()` from
+ * their request callback. Routes registered through ClockWebServer also
+ * release the slot when the client disconnects first.
+ */
+class RequestBodyPool
+{
+public:
+  static constexpr int SLOTS = REQUEST_BODY_POOL_SLOTS;
+  static constexpr size_t SLOT_SIZE = REQUEST_BODY_MAX_SIZE + 1; ///< The largest body plus its terminator.
+
+  /**
+   * @brief Gets the singleton instance of the RequestBodyPool.
+   * @return A reference to the RequestBodyPool instance.
+   */
+  static RequestBodyPool &getInstance()
+  {
+    static RequestBodyPool instance;
+    return instance;
+  }
+
+  /**
+   * @brief Adds a body chunk to the request's buffer, taking a slot on the first chunk.
+   *
+   * Sends 411, 413 or 503 itself when the body cannot be collected.
+   * @param request The request the chunk belongs to.
+   * @param data The chunk.
+   * @param len The chunk length.
+   * @param index The chunk's offset in the body.
+   * @param total The Content-Length of the body.
+   * @param limit The largest body the handler accepts; at most REQUEST_BODY_MAX_SIZE.
+   * @return The complete body after its last chunk, otherwise nullptr.
+   */
+  RequestBody *collect(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total, size_t limit);
+
+  /**
+   * @brief Returns the request's buffer to the pool, if it holds one.
+   * @param request The request.
+   */
+  void release(AsyncWebServerRequest *request);
+
+  /// @brief Requests turned away with 503 because every slot was busy.
+  uint32_t rejectedBusy() const { return _rejectedBusy; }
+
+  /// @brief Requests turned away with 411 or 413.
+  uint32_t rejectedSize() const { return _rejectedSize; }
+
+private:
+  RequestBodyPool();
+  RequestBodyPool(const RequestBodyPool &) = delete;
+  RequestBodyPool &operator=(const RequestBodyPool &) = delete;
+
+  RequestBody *acquire(size_t total);
+
+  uint8_t *_storage = nullptr;
+  RequestBody _bodies[SLOTS] = {};
+  uint32_t _freeMask; ///< Bit i is set while slot i is free.
+  uint32_t _rejectedBusy = 0;
+  uint32_t _rejectedSize = 0;
+  SemaphoreHandle_t _mutex;
+};
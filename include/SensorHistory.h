@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include <cstdint>
+
+/**
+ * @class SensorHistory
+ * @brief Keeps the last 24 hours of filtered indoor readings in PSRAM.
+ *
+ * Time is divided into slots of `SENSOR_UPDATE_INTERVAL`, and the ring holds
+ * one sample per slot: the last `SENSOR_HISTORY_SAMPLES` of them. A reading
+ * taken in a slot that already has one replaces it, and slots with no
+ * reading are stored as gaps, so the time of every sample follows from its
+ * position alone and nothing but the values needs storing.
+ *
+ * Values are kept as int16 hundredths of a degree Celsius and of a percent,
+ * 4 bytes a sample. `read()` averages runs of samples, so callers can ask
+ * for a coarser series than the ring holds.
+ */
+class SensorHistory
+{
+public:
+  static constexpr int16_t GAP = INT16_MIN; ///< Stored for a missing value.
+
+  /// @brief One averaged point of a `read()`; NAN where every sample was a gap.
+  struct Point
+  {
+    float temperatureC;
+    float humidity;
+  };
+
+  /// @brief Receives the points of a `read()`, oldest first.
+  using PointSink = void (*)(const Point &point, void *context);
+
+  /**
+   * @brief Gets the singleton instance of the SensorHistory.
+   * @return A reference to the SensorHistory instance.
+   */
+  static SensorHistory &getInstance()
+  {
+    static SensorHistory instance;
+    return instance;
+  }
+
+  /**
+   * @brief Allocates the ring in PSRAM; until then `record()` is ignored.
+   */
+  void begin();
+
+  /**
+   * @brief Stores a reading in the current slot.
+   * @param temperatureC The filtered temperature, or NAN if there is none.
+   * @param humidity The filtered relative humidity, or NAN if there is none.
+   */
+  void record(float temperatureC, float humidity);
+
+  /**
+   * @brief Averages the ring into points of `step` samples each, oldest first.
+   *
+   * Points cover whole multiples of `step` slots, so repeated requests line
+   * up with each other; the oldest and newest points may cover fewer samples.
+   * @param step Samples per point; at least 1.
+   * @param sink Called with each point.
+   * @param context Passed to `sink`.
+   * @param newestAgeMs Receives the milliseconds since the newest point's first slot began.
+   * @return The number of points produced.
+   */
+  int read(uint32_t step, PointSink sink, void *context, uint32_t &newestAgeMs);
+
+  /**
+   * @brief Gets how many samples the ring holds, gaps included.
+   */
+  uint32_t size();
+
+  SensorHistory(const SensorHistory &) = delete;
+  SensorHistory &operator=(const SensorHistory &) = delete;
+
+private:
+  SensorHistory();
+
+  /// @brief One slot of the ring.
+  struct Sample
+  {
+    int16_t temperature; ///< Hundredths of a degree Celsius, or GAP.
+    int16_t humidity;    ///< Hundredths of a percent, or GAP.
+  };
+
+  static int16_t encode(float value);
+  void push(const Sample &sample);
+
+  Sample *_samples = nullptr; ///< SENSOR_HISTORY_SAMPLES entries, in PSRAM.
+  uint32_t _next = 0;         ///< Where the next slot goes.
+  uint32_t _count = 0;
+  int64_t _newestSlot = -1;   ///< Slot number of the newest sample; -1 = none yet.
+  SemaphoreHandle_t _mutex;
+};
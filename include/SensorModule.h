@@ -39,12 +39,31 @@ void setupSensors();
 /// @brief The interval for reading sensor data, in milliseconds.
 const unsigned long SENSOR_UPDATE_INTERVAL = 3000; // 3 seconds
 
+/// @brief BME280 temperature oversampling; each step doubles the conversion time.
+const Adafruit_BME280::sensor_sampling BME280_TEMP_OVERSAMPLING = Adafruit_BME280::SAMPLING_X2;
+
+/// @brief BME280 humidity oversampling.
+const Adafruit_BME280::sensor_sampling BME280_HUMIDITY_OVERSAMPLING = Adafruit_BME280::SAMPLING_X2;
+
+/// @brief Readings the median filter picks from, before smoothing.
+const int SENSOR_MEDIAN_WINDOW = 3;
+
+/// @brief Weight of each new reading in the moving average; 0.25 at 3 s settles in about 12 s.
+const float SENSOR_SMOOTHING = 0.25f;
+
+/// @brief How far, in Celsius, the smoothed temperature must move before the display follows.
+const float SENSOR_TEMP_HYSTERESIS_C = 0.3f;
+
+/// @brief How far, in percent, the smoothed humidity must move before the display follows.
+const float SENSOR_HUMIDITY_HYSTERESIS = 1.0f;
+
 /**
  * @brief Handles periodic reading of sensor data.
  *
  * This function checks if the update interval has passed and, if so,
- * reads the latest data from the sensors and updates a local cache.
- * It is designed to be called continuously from the main loop.
+ * triggers a BME280 forced-mode measurement, filters the readings and
+ * updates a local cache and the SensorHistory.
+ * Once the I2C bus task is running only it calls this.
  * @param force If true, forces an immediate sensor read, ignoring the interval.
  */
 void handleSensorUpdates(bool force = false);
@@ -55,15 +74,35 @@ void handleSensorUpdates(bool force = false);
  */
 bool isRtcFound();
 
+/// @brief The latest sensor readings, in Celsius, as published by the I2C bus task.
+struct SensorReadings
+{
+  float bmeTemperatureC;     ///< Corrected and smoothed BME280 temperature.
+  float humidity;            ///< Corrected and smoothed relative humidity; -1 when the BME280 is missing.
+  float displayTemperatureC; ///< The BME280, or else the RTC, temperature, held within SENSOR_TEMP_HYSTERESIS_C.
+  float displayHumidity;     ///< `humidity`, held within SENSOR_HUMIDITY_HYSTERESIS; -1 when the BME280 is missing.
+  float rtcTemperatureC;     ///< The DS3231's temperature.
+  float coreTemperatureC;    ///< The ESP32-S3's internal temperature.
+  bool bmeFound;
+  bool rtcFound;
+  uint32_t sampledAtMs;      ///< millis() when the batch was read. 0 = never.
+};
+
 /**
- * @brief Gets the last cached temperature reading.
- * @return The cached temperature, converted to the user's preferred unit.
+ * @brief Copies the latest sensor readings without touching the bus.
+ * @return The readings, with the time they were taken.
+ */
+SensorReadings getSensorReadings();
+
+/**
+ * @brief Gets the temperature the display shows.
+ * @return The held temperature, converted to the user's preferred unit.
  */
 float getTemperature();
 
 /**
- * @brief Gets the last cached humidity reading.
- * @return The cached relative humidity as a float.
+ * @brief Gets the humidity the display shows.
+ * @return The held relative humidity, or -1 if the BME280 is not available.
  */
 float getHumidity();
 
@@ -89,4 +128,14 @@ float getRtcTemperature();
  * @brief Gets the last cached temperature reading from the ESP32-S3's internal sensor.
  * @return The cached temperature, converted to the user's preferred unit.
  */
-float getCoreTemperature();
\ No newline at end of file
+float getCoreTemperature();
+
+/**
+ * @brief Gets the sensor generation number.
+ *
+ * The number increases whenever a sensor update changes a reading at the
+ * 0.1-degree/percent resolution the web UI shows, or a sensor appears or
+ * disappears.
+ * @return The current sensor generation.
+ */
+uint32_t getSensorGeneration();
\ No newline at end of file
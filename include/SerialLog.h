@@ -3,9 +3,49 @@
 
 #include <Arduino.h>
 #include <AsyncWebSocket.h>
-#include <LittleFS.h>
-#include <FS.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Constants.h"
+#include "LogLevel.h"
+
+/**
+ * @brief Logs a printf-style message at a level, for a module.
+ *
+ * Messages above LOG_COMPILE_LEVEL compile to nothing; the rest are formatted
+ * only when the module's runtime threshold lets them through.
+ */
+#define LOG_AT(level, module, format, ...)                                                   \
+  do                                                                                         \
+  {                                                                                          \
+    if ((level) <= LOG_COMPILE_LEVEL && SerialLog::getInstance().isEnabled(module, level))   \
+      SerialLog::getInstance().log(level, format, ##__VA_ARGS__);                           \
+  } while (0)
+
+#define LOG_E(module, format, ...) LOG_AT(LOG_LEVEL_ERROR, module, format, ##__VA_ARGS__)
+#define LOG_W(module, format, ...) LOG_AT(LOG_LEVEL_WARN, module, format, ##__VA_ARGS__)
+#define LOG_I(module, format, ...) LOG_AT(LOG_LEVEL_INFO, module, format, ##__VA_ARGS__)
+#define LOG_D(module, format, ...) LOG_AT(LOG_LEVEL_DEBUG, module, format, ##__VA_ARGS__)
+#define LOG_V(module, format, ...) LOG_AT(LOG_LEVEL_VERBOSE, module, format, ##__VA_ARGS__)
+
+/**
+ * @brief Logs a printf-style message, formatting it later on the drain task.
+ *
+ * The caller only stores the format pointer and the raw arguments. The format
+ * must be a string literal and the arguments numbers or enums; the format is
+ * still checked against them at compile time. Filtered like LOG_AT().
+ */
+#define LOG_DEFERRED(level, module, format, ...)                                             \
+  do                                                                                         \
+  {                                                                                          \
+    (void)sizeof(snprintf(nullptr, 0, "" format, ##__VA_ARGS__));                            \
+    if ((level) <= LOG_COMPILE_LEVEL && SerialLog::getInstance().isEnabled(module, level))   \
+      SerialLog::getInstance().deferred(level, "" format, ##__VA_ARGS__);                    \
+  } while (0)
 
 /**
  * @class SerialLog
@@ -15,6 +55,18 @@
  * runtime and, when enabled, sends all log messages to both the hardware
  * Serial port and a WebSocket endpoint (`/ws/log`). This allows for remote
  * debugging via the web interface.
+ *
+ * Logging never blocks the caller. `print()` and `printf()` only copy the
+ * line into a fixed lock-free ring in PSRAM; a low-priority drain task owns
+ * Serial, the WebSocket and the log file and writes the lines out. When the
+ * ring is full the line is dropped and counted, and the drain task reports
+ * the count once it catches up.
+ *
+ * WebSocket clients get the console output in batches, sent every
+ * LOG_WS_BATCH_INTERVAL ms or once LOG_WS_BATCH_SIZE bytes are pending. A
+ * client whose send queue is backed up skips batches and is told how much it
+ * missed. A newly connected client first gets the last LOG_WS_HISTORY_SIZE
+ * bytes from an in-memory history ring.
  */
 class SerialLog
 {
@@ -31,11 +83,6 @@ public:
    */
   void begin(AsyncWebServer *server);
 
-  /**
-   * @brief Handles periodic tasks, such as flushing the log buffer.
-   */
-  void loop();
-
   /**
    * @brief Prints a message to the serial port and WebSocket.
    * @param message The message to print.
@@ -49,6 +96,53 @@ public:
    */
   void printf(const char *format, ...);
 
+  /**
+   * @brief Prints a formatted message at a level. Use the LOG_* macros.
+   * @param level The message's level, kept in the crash journal.
+   * @param format The format string (a la printf).
+   * @param ... The arguments for the format string.
+   */
+  void log(LogLevel level, const char *format, ...);
+
+  /**
+   * @brief Queues a message to be formatted by the drain task. Use LOG_DEFERRED.
+   * @param level The message's level.
+   * @param format A format string with static storage duration.
+   * @param args Numeric or enum arguments for the format string.
+   */
+  template <typename... Args>
+  void deferred(LogLevel level, const char *format, Args... args)
+  {
+    static_assert((... && (std::is_arithmetic<Args>::value || std::is_enum<Args>::value)),
+                  "deferred log arguments must be numbers or enums");
+    static_assert(sizeof(format) + (sizeof(Args) + ... + 0) <= LOG_SLOT_TEXT_SIZE,
+                  "deferred log arguments do not fit a log slot");
+    if (!_consoleLoggingEnabled && !_fileLoggingEnabled)
+      return;
+
+    char packed[sizeof(format) + (sizeof(Args) + ... + 0)];
+    char *out = packed;
+    memcpy(out, &format, sizeof(format));
+    out += sizeof(format);
+    ((memcpy(out, &args, sizeof(Args)), out += sizeof(Args)), ...);
+    enqueueDeferred(level, formatPacked<Args...>, packed, sizeof(packed));
+  }
+
+  /**
+   * @brief Checks a message against its module's runtime threshold.
+   * @param module The module the message comes from.
+   * @param level The message's level.
+   * @return True if the message should be logged.
+   */
+  bool isEnabled(LogModule module, LogLevel level) const { return level <= _moduleLevels[module]; }
+
+  /**
+   * @brief Sets the runtime threshold of a module. ConfigManager keeps these in sync with its settings.
+   * @param module The module.
+   * @param level The most verbose level to log.
+   */
+  void setModuleLevel(LogModule module, LogLevel level) { _moduleLevels[module] = level; }
+
   /**
    * @brief Enables or disables console (Serial/WebSocket) logging.
    * @param enabled True to enable, false to disable.
@@ -68,21 +162,21 @@ public:
   void setLoggingEnabled(bool enabled);
 
   /**
-   * @brief Manually rotates the log file.
+   * @brief Starts a new segment of the persistent log.
    * Thread-safe.
    */
   void rotate();
 
   /**
-   * @brief Gets the log file path.
-   * @return The path to the log file.
+   * @brief Logs the reason for the last reset.
    */
-  static const char *getLogFilePath() { return LOG_FILE_PATH; }
+  void logResetReason();
 
   /**
-   * @brief Logs the reason for the last reset.
+   * @brief Counts the lines dropped because the log queue was full.
+   * @return The number of dropped lines since boot.
    */
-  void logResetReason();
+  uint32_t droppedLines() const { return _dropped.load(std::memory_order_relaxed); }
 
 private:
   /**
@@ -94,36 +188,174 @@ private:
   AsyncWebSocket _ws;
 
   // Flags to control logging outputs
-  bool _consoleLoggingEnabled = true;
-  bool _fileLoggingEnabled = true;
+  volatile bool _consoleLoggingEnabled = true;
+  volatile bool _fileLoggingEnabled = true;
+  volatile uint8_t _moduleLevels[LOG_MODULE_COUNT];
 
-  // WebSocket event handler.
-  static void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
+  static constexpr uint32_t QUEUE_MASK = LOG_QUEUE_SLOTS - 1;
+  static constexpr size_t MAX_SLOTS_PER_LINE = 16; ///< Longer lines are truncated.
+  static_assert((LOG_QUEUE_SLOTS & QUEUE_MASK) == 0, "LOG_QUEUE_SLOTS must be a power of two");
+  static_assert(MAX_SLOTS_PER_LINE * LOG_SLOT_TEXT_SIZE * 4 < LOG_WS_HISTORY_SIZE, "LOG_WS_HISTORY_SIZE must hold several full lines");
 
-  // Constants for file logging
-  static const char *LOG_FILE_PATH;
-  static const size_t MAX_LOG_SIZE;
-  static const size_t BUFFER_THRESHOLD;
-  static const unsigned long FLUSH_INTERVAL;
+  /// @brief Formats a deferred message from its packed format pointer and arguments.
+  using Formatter = int (*)(char *out, size_t size, const char *packed);
+
+  /// @brief When, where and at what level a line was logged.
+  struct LineInfo
+  {
+    uint32_t uptimeMs;             ///< millis() when the line was logged.
+    uint8_t level;                 ///< The line's LogLevel.
+    uint8_t core;                  ///< The core the logging task ran on.
+    char task[LOG_TASK_NAME_SIZE]; ///< The logging task's name; not terminated when it fills the array.
+  };
+
+  /// @brief One queued piece of a log line.
+  struct LogSlot
+  {
+    LineInfo info;
+    Formatter formatter; ///< Set for deferred messages, whose `text` holds the packed arguments.
+    uint16_t length;     ///< Bytes used in `text`.
+    bool continued;      ///< The line goes on in the next slot.
+    char text[LOG_SLOT_TEXT_SIZE];
+  };
+
+  LogSlot *_slots = nullptr; ///< LOG_QUEUE_SLOTS entries, in PSRAM.
+  /// Per-slot sequence numbers; kept in internal RAM so the atomics never touch PSRAM.
+  std::atomic<uint32_t> _sequence[LOG_QUEUE_SLOTS];
+  std::atomic<uint32_t> _enqueuePos{0};
+  uint32_t _dequeuePos = 0; ///< Only touched by the drain task.
+  std::atomic<uint32_t> _dropped{0};
+  uint32_t _droppedReported = 0;
+  TaskHandle_t _drainTaskHandle = nullptr;
+  String _line; ///< The line being reassembled by the drain task.
 
-  // Buffering members
-  String _logBuffer;
-  unsigned long _lastFlushTime;
-  SemaphoreHandle_t _mutex;
+  /// @brief Delivery state of one /ws/log client, owned by the drain task.
+  struct WsClientState
+  {
+    uint32_t id;           ///< The client's id; 0 marks a free entry.
+    uint32_t skippedBytes; ///< Log text skipped while the client was backed up.
+  };
+
+  static constexpr size_t MAX_WS_CLIENTS = 8;
+  WsClientState _wsClients[MAX_WS_CLIENTS] = {};
+  char *_history = nullptr;   ///< LOG_WS_HISTORY_SIZE bytes of recent console output, in PSRAM.
+  uint32_t _historyTotal = 0; ///< Bytes ever written to `_history`.
+  String _wsBatch;            ///< Console output not yet sent to WebSocket clients.
+  unsigned long _wsBatchStart = 0;
+  std::atomic<bool> _wsClientConnected{false}; ///< Set on connect so the drain task replays the history promptly.
 
   /**
-   * @brief Writes a message to the log buffer.
-   * @param message The message to write.
+   * @brief Describes a line being logged by the calling task.
+   * @param level The line's level.
+   * @return The line's info.
    */
-  void logToFile(const char *message);
+  static LineInfo currentLineInfo(LogLevel level);
+
+  /**
+   * @brief Copies a line into the queue and wakes the drain task. Never blocks.
+   * @param level The line's level.
+   * @param text The line.
+   * @param length The length of the line in bytes.
+   */
+  void enqueue(LogLevel level, const char *text, size_t length);
+
+  /**
+   * @brief Formats a message and queues it.
+   * @param level The message's level.
+   * @param format The format string.
+   * @param args The arguments for the format string.
+   */
+  void vlog(LogLevel level, const char *format, va_list args);
+
+  /**
+   * @brief Queues a deferred message in a single slot. Never blocks.
+   * @param level The message's level.
+   * @param formatter Formats the message on the drain task.
+   * @param packed The format pointer followed by the raw arguments.
+   * @param length The size of `packed` in bytes.
+   */
+  void enqueueDeferred(LogLevel level, Formatter formatter, const char *packed, size_t length);
+
+  /**
+   * @brief Claims consecutive queue slots.
+   * @param count The number of slots.
+   * @param pos Receives the position of the first slot.
+   * @return False if the slots are not free; the line is counted as dropped.
+   */
+  bool claim(size_t count, uint32_t &pos);
+
+  /// @brief Reads the next packed argument of type T and steps past it.
+  template <typename T>
+  static T unpack(const char *&packed)
+  {
+    T value;
+    memcpy(&value, packed, sizeof(T));
+    packed += sizeof(T);
+    return value;
+  }
+
+  template <typename Tuple, size_t... I>
+  static int formatTuple(char *out, size_t size, const char *format, const Tuple &args, std::index_sequence<I...>)
+  {
+    return snprintf(out, size, format, std::get<I>(args)...);
+  }
+
+  /// @brief The Formatter instantiated by `deferred()` for its argument types.
+  template <typename... Args>
+  static int formatPacked(char *out, size_t size, const char *packed)
+  {
+    const char *format = unpack<const char *>(packed);
+    // Braced initialization unpacks the arguments left to right.
+    std::tuple<Args...> args{unpack<Args>(packed)...};
+    return formatTuple(out, size, format, args, std::index_sequence_for<Args...>());
+  }
 
   /**
-   * @brief Flushes the log buffer to the file in LittleFS.
+   * @brief Writes every queued line out and flushes the file when due.
    */
-  void flush();
+  void drain();
 
   /**
-   * @brief Rotates the log file when it exceeds the maximum size.
+   * @brief Writes one line to Serial, the WebSocket, the crash journal and the file.
+   * @param info When, where and at what level the line was logged.
+   * @param message The line's text.
    */
-  void rotateLogFile();
+  void emit(const LineInfo &info, const String &message);
+
+  /**
+   * @brief Sends the pending batch to every WebSocket client that can take it.
+   *
+   * Clients seen for the first time get the history replayed first.
+   */
+  void sendBatch();
+
+  /**
+   * @brief Sends a client the history up to a position, starting at a line boundary.
+   * @param client The client.
+   * @param end The `_historyTotal` position to stop at.
+   */
+  void replayHistory(AsyncWebSocketClient &client, uint32_t end);
+
+  /**
+   * @brief Finds the delivery state of a WebSocket client.
+   * @param id The client's id, or 0 for a free entry.
+   * @return The entry, or nullptr if there is none.
+   */
+  WsClientState *findWsClient(uint32_t id);
+
+  static void drainTask(void *param);
+
+  // WebSocket event handler.
+  static void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
+
+  // How often unwritten log text is synced to the LogStore, in ms.
+  static const unsigned long FLUSH_INTERVAL;
+
+  SemaphoreHandle_t _mutex; ///< Held by the drain task while it writes lines out.
+
+  /**
+   * @brief Writes a message to the persistent LogStore.
+   * @param message The message to write.
+   */
+  void logToFile(const char *message);
 };
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "Constants.h"
+#include <cstdint>
+
+/**
+ * @class Telemetry
+ * @brief Samples task CPU share, stack headroom and heap at a fixed interval.
+ *
+ * The logic task calls `sample()` every `TELEMETRY_SAMPLE_INTERVAL`, and the
+ * last `TELEMETRY_RING_SIZE` samples are kept in a fixed ring. Each sample
+ * holds the internal and PSRAM heaps and, for the tasks in `TASK_NAMES`,
+ * the share of one core each used since the previous sample and the least
+ * stack each has had free.
+ *
+ * The precompiled framework has no FreeRTOS run-time stats, so CPU shares
+ * are sampled instead: a tick hook on each core counts the tick interrupts
+ * that land while a tracked task is running. A task's share is its ticks
+ * over one core's ticks, accurate to a tick per interval; a task that runs
+ * for less than a tick after waking on one is undercounted.
+ */
+class Telemetry
+{
+public:
+  static constexpr int TRACKED_TASKS = 7;               ///< Number of tasks in `TASK_NAMES`.
+  static const char *const TASK_NAMES[TRACKED_TASKS]; ///< The tasks sampled, by FreeRTOS name.
+  static constexpr uint16_t CPU_UNKNOWN = UINT16_MAX;   ///< `cpuPermille` of a task with no share this sample.
+
+  /// @brief One tracked task in a sample.
+  struct TaskSample
+  {
+    bool present;            ///< The task existed when sampled.
+    uint16_t cpuPermille;    ///< Tenths of a percent of one core since the previous sample, or CPU_UNKNOWN.
+    uint32_t stackFreeBytes; ///< Least stack the task has had free since it started.
+  };
+
+  /// @brief One heap region in a sample.
+  struct HeapSample
+  {
+    uint32_t freeBytes;
+    uint32_t minFreeBytes;      ///< Lowest `freeBytes` since boot.
+    uint32_t largestFreeBlock;  ///< Largest single allocation that would succeed.
+  };
+
+  /// @brief Everything recorded at one sampling.
+  struct Sample
+  {
+    uint32_t uptimeSeconds;
+    HeapSample internal;
+    HeapSample psram;
+    TaskSample tasks[TRACKED_TASKS]; ///< In `TASK_NAMES` order.
+  };
+
+  /**
+   * @brief Gets the singleton instance of the Telemetry.
+   * @return A reference to the Telemetry instance.
+   */
+  static Telemetry &getInstance()
+  {
+    static Telemetry instance;
+    return instance;
+  }
+
+  /**
+   * @brief Takes a sample if `TELEMETRY_SAMPLE_INTERVAL` has passed since the last one.
+   */
+  void loop();
+
+  /**
+   * @brief Takes a sample now and stores it in the ring.
+   */
+  void sample();
+
+  /**
+   * @brief Gets the number of samples in the ring.
+   */
+  int sampleCount();
+
+  /**
+   * @brief Copies a sample out of the ring.
+   * @param age 0 for the newest sample, 1 for the one before it, and so on.
+   * @param sample Receives the sample.
+   * @return False if the ring holds fewer than `age + 1` samples.
+   */
+  bool getSample(int age, Sample &sample);
+
+  Telemetry(const Telemetry &) = delete;
+  Telemetry &operator=(const Telemetry &) = delete;
+
+private:
+  Telemetry();
+
+  /// @brief Fills a heap region's figures.
+  static void sampleHeap(uint32_t caps, HeapSample &heap);
+
+  static void IRAM_ATTR onTick();
+
+  // Shared with the tick hooks; each counter is only written from one core at a time.
+  static volatile TaskHandle_t s_tickHandles[TRACKED_TASKS]; ///< The tasks the hooks count for.
+  static volatile uint32_t s_taskTicks[TRACKED_TASKS];
+  static volatile uint32_t s_coreTicks[portNUM_PROCESSORS];
+
+  Sample _ring[TELEMETRY_RING_SIZE];
+  uint16_t _next = 0;
+  uint16_t _count = 0;
+  unsigned long _lastSample = 0;
+
+  // Only touched by `sample()`, which runs on the logic task.
+  TaskStatus_t _taskStatus[TELEMETRY_MAX_TASKS]; ///< Scratch for `uxTaskGetSystemState()`.
+  uint32_t _lastTaskTicks[TRACKED_TASKS] = {};
+  uint32_t _lastCoreTicks = 0; ///< Sum of `s_coreTicks` at the previous sample.
+
+  SemaphoreHandle_t _mutex;
+};
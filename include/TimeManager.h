@@ -7,17 +7,24 @@
 #include <vector>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include "AlarmSchedule.h"
+#include "DriftModel.h"
 
-// Structure to hold an alarm's next occurrence time and its ID
-struct NextAlarmTime
-{
-  DateTime time;
-  uint8_t id;
+class Alarm;
 
-  bool operator<(const NextAlarmTime &other) const
-  {
-    return time < other.time;
-  }
+/// @brief How the clock has been kept, for the stats API.
+struct RtcClockStats
+{
+  bool freeRunning;               ///< Time is being served from the ESP32 timer.
+  uint32_t transactionsPerMinute; ///< RTC time reads and writes over the last full minute.
+  uint32_t resyncs;               ///< Times the free-running clock was re-anchored to the RTC.
+  int32_t lastResyncOffsetUs;     ///< How far the timer had drifted from the RTC at the last resync.
+  int64_t lastNtpOffsetUs;        ///< How far the RTC was ahead of NTP at the last comparison.
+  float driftPpm;                 ///< The last fitted RTC frequency error; positive when fast.
+  bool driftFitted;               ///< `driftPpm` has been fitted at least once.
+  size_t driftSamples;            ///< Comparisons in the drift model.
+  int agingOffset;                ///< The DS3231 aging offset, or TimeManager::AGING_OFFSET_UNKNOWN.
+  uint32_t ntpSyncInterval;       ///< The SNTP daemon's poll interval, in ms.
 };
 
 /**
@@ -52,12 +59,39 @@ public:
   /**
    * @brief Updates the time manager's state.
    *
-   * This method should be called repeatedly in the main loop. It handles
-   * periodic tasks, such as the daily NTP sync check.
+   * This method should be called repeatedly by the render task. It handles
+   * periodic tasks, such as the daily NTP sync check. Calls made before the
+   * next RTC poll is due return immediately.
    * @return true if a time update occurred (typically once per second).
    */
   bool update();
 
+  /**
+   * @brief Gets the time until `update()` will next poll the clock.
+   *
+   * While free running this is the time to the ESP32 timer's next second.
+   * Otherwise, once the phase of the RTC's second edge is known, polling is skipped for
+   * most of each second and runs every millisecond just around the predicted
+   * edge, so callers can sleep until then.
+   * @return The number of milliseconds until the next poll is due (0 if due now).
+   */
+  uint32_t msUntilNextPoll() const;
+
+  /**
+   * @brief Predicts when the displayed second next changes.
+   *
+   * Only known while free running. If the current second hasn't been picked
+   * up by `update()` yet, its edge is returned, which is already past.
+   * @return esp_timer_get_time() at the next second edge, or 0 if not free running.
+   */
+  int64_t nextSecondEdgeMicros() const;
+
+  /**
+   * @brief Gets when the second last picked up by `update()` began.
+   * @return esp_timer_get_time() at that second edge, or 0 if it wasn't pinned down.
+   */
+  int64_t lastSecondEdgeMicros() const;
+
   /**
    * @brief Checks all alarms to see if any snoozed alarms should be re-triggered.
    */
@@ -92,6 +126,14 @@ public:
    */
   void getFormattedTime(char *buf, size_t bufSize) const;
 
+  /**
+   * @brief Formats a given time the way `getFormattedTime()` formats the current one.
+   * @param time The time to format.
+   * @param buf Output buffer (must be >= 6 bytes for "HH:MM" + null).
+   * @param bufSize Size of the buffer.
+   */
+  void formatTime(const DateTime &time, char *buf, size_t bufSize) const;
+
   /**
    * @brief Gets the current date, formatted for display.
    * @return A String containing the formatted date (e.g., "JAN 1").
@@ -166,11 +208,33 @@ public:
   bool is24HourFormat() const;
 
   /**
-   * @brief Gets the current time from the RTC.
+   * @brief Gets the current time.
+   *
+   * With RTC_FREE_RUNNING, once the RTC's second edge has been found the
+   * time is worked out from the ESP32 timer, re-anchored to the RTC every
+   * RTC_RESYNC_INTERVAL and whenever the RTC is set, so this makes no I2C
+   * transaction. Before that, and without RTC_FREE_RUNNING, the RTC is read.
    * @return A DateTime object representing the current time.
    */
   DateTime getRTCTime() const;
 
+  /**
+   * @brief Queues a write of the time to the RTC and re-anchors the free-running clock to it.
+   *
+   * The write itself is made by the I2C bus task.
+   * @param time The new local time.
+   * @param atMicros esp_timer_get_time() at which `time` begins, within the
+   *                 next second, so the RTC's second edge lands there; 0 to
+   *                 write as soon as possible.
+   */
+  void adjustRTC(const DateTime &time, int64_t atMicros = 0);
+
+  /**
+   * @brief Gets how the clock has been kept.
+   * @return The free-running state and RTC bus counts.
+   */
+  RtcClockStats getRtcClockStats() const;
+
   /**
    * @brief Checks if the RTC has been set to a valid time.
    * @return True if the time is valid (year > 2000), false otherwise.
@@ -186,14 +250,18 @@ public:
   void checkDailySync();
 
   /**
-   * @brief Periodically checks RTC drift against NTP and resyncs if needed.
+   * @brief Compares the RTC with NTP after each SNTP daemon sync and trims its drift.
    *
-   * This function is designed to be called in the main loop. It checks the
-   * time drift at a defined interval (e.g., every 4 hours) and triggers a
-   * non-blocking NTP sync if the drift exceeds a specified threshold.
+   * This function is designed to be called in the main loop. Each comparison
+   * feeds a fit of the RTC's frequency error, which is corrected through the
+   * DS3231's aging offset; the RTC is only stepped when it is more than
+   * DRIFT_RESYNC_US out.
    */
   void checkDriftAndResync();
 
+  /// @brief `RtcClockStats::agingOffset` before the register has been read.
+  static constexpr int AGING_OFFSET_UNKNOWN = 1000;
+
   /**
    * @brief Checks for DST transitions and updates the RTC if needed.
    */
@@ -217,13 +285,20 @@ public:
 
   /**
    * @brief Gets the next upcoming alarms.
+   *
+   * Read from the front of the schedule, so this copies at most `count`
+   * entries whatever the number of alarms.
    * @param count The number of upcoming alarms to retrieve.
    * @return A vector of NextAlarmTime structures.
    */
   std::vector<NextAlarmTime> getNextAlarms(int count) const;
 
   /**
-   * @brief Re-calculates and caches the next upcoming alarms.
+   * @brief Brings the schedule of upcoming alarms up to date.
+   *
+   * The alarm table is only re-read when its generation has moved, and then
+   * only the changed alarms are re-placed; otherwise just the alarms whose
+   * time has come are moved on to their next occurrence.
    * @param now The current time, used to avoid re-reading from RTC if available.
    */
   void updateNextAlarmsCache(const DateTime &now);
@@ -233,6 +308,17 @@ public:
    */
   void updateNextAlarmsCache();
 
+  /**
+   * @brief Works out when each enabled alarm rings next, soonest first.
+   *
+   * Recomputes every alarm from scratch; the benchmark compares it with the
+   * incremental schedule.
+   * @param alarms The alarms to schedule.
+   * @param now The current time.
+   * @return The next ring time of every alarm that has one.
+   */
+  static std::vector<NextAlarmTime> computeNextAlarms(const std::vector<Alarm> &alarms, const DateTime &now);
+
 private:
   // Timestamp of the last DST evaluation (millis()).
   unsigned long _lastDstCheck = 0;
@@ -254,24 +340,115 @@ private:
   /// @brief The interval at which the `update` method runs its checks, in milliseconds.
   static constexpr unsigned long UPDATE_INTERVAL = 50; // 50 milliseconds
 
+  /// @brief How long before the predicted second edge to start polling every millisecond.
+  static constexpr unsigned long SECOND_EDGE_GUARD_MS = 3;
+
+  /// @brief How long after the predicted edge to keep searching before the lock is considered lost.
+  static constexpr unsigned long SECOND_EDGE_SEARCH_MS = 20;
+
+  /// @brief millis() at the earliest moment the last second edge could have occurred. 0 = unknown.
+  unsigned long _secondEdgeMillis = 0;
+
+  /// @brief The widest window, in ms, a second edge can be narrowed to and still be anchored to.
+  static constexpr unsigned long ANCHOR_MAX_GAP_MS = 3;
+
+  /// @brief esp_timer_get_time() at the last poll.
+  int64_t _lastPollMicros = 0;
+
+  /// @brief esp_timer_get_time() at the edge of the last second picked up. 0 = not pinned down.
+  int64_t _lastEdgeMicros = 0;
+
+  uint32_t _anchorTime = 0;        ///< Local unixtime the RTC changed to at `_anchorMicros`. 0 = not free running.
+  int64_t _anchorMicros = 0;       ///< esp_timer_get_time() at that second edge.
+  unsigned long _anchorMillis = 0; ///< millis() when anchored, for the resync interval.
+  uint32_t _lastAnchorTime = 0;    ///< The last anchor, kept through resyncs to measure drift. 0 = none.
+  int64_t _lastAnchorMicros = 0;
+  int32_t _lastResyncOffsetUs = 0;
+  uint32_t _resyncs = 0;
+
+  mutable uint32_t _rtcTransactions = 0; ///< RTC time reads and writes since boot.
+  uint32_t _rtcTransactionsAtMinute = 0;
+  uint32_t _rtcTransactionsPerMinute = 0;
+  unsigned long _rtcMinuteStart = 0;
+  mutable int8_t _rtcLostPower = -1; ///< The RTC's oscillator-stop flag. -1 = not read yet.
+
   uint8_t _lastDecodedSecond = 61;
 
   /// @brief Cached time snapshot from the last successful second transition.
   /// This ensures consistent time data between update detection and rendering.
   DateTime _cachedTime;
 
-  /// @brief Timestamp of the last drift check.
-  unsigned long lastDriftCheck = 0;
+  DriftModel _driftModel;
+  bool _driftMeasurePending = false; ///< Compare the next RTC edge with the system clock.
+  bool _driftSampleReady = false;    ///< A comparison is waiting for `checkDriftAndResync()`.
+  bool _driftStepExpected = false;   ///< The next RTC write is the drift model's own step.
+  uint32_t _driftSampleTime = 0;
+  int64_t _driftSampleOffsetUs = 0;
+  int64_t _lastNtpOffsetUs = 0;
+  float _driftPpm = 0;
+  bool _driftFitted = false;
+  int _agingOffset = AGING_OFFSET_UNKNOWN;
+  uint32_t _ntpSyncInterval = NTP_SYNC_INTERVAL_MIN;
 
   bool _rtc_alarms_initialized = false;
   int8_t _rtcAlarm1Id = -1; ///< The ID of the alarm associated with RTC alarm 1.
   int8_t _rtcAlarm2Id = -1; ///< The ID of the alarm associated with RTC alarm 2.
 
-  std::vector<NextAlarmTime> _cachedNextAlarms;
+  AlarmSchedule _schedule;
+  uint32_t _scheduleGeneration = 0; ///< The alarm generation `_schedule` was last synced at.
+  bool _scheduleSynced = false;
   uint8_t _lastCacheUpdateMinute = 255;
 
   mutable SemaphoreHandle_t _mutex;
 
+  /**
+   * @brief Reads the time from the RTC over I2C.
+   * @return The RTC's time, or an invalid DateTime if there is no RTC.
+   */
+  DateTime readRTC() const;
+
+  /**
+   * @brief Works out the time from the anchor and the ESP32 timer.
+   * @note The caller holds the mutex and has checked that the clock is anchored.
+   * @return The current local time.
+   */
+  DateTime clockTime() const;
+
+  /**
+   * @brief Re-anchors the free-running clock once the I2C bus task has written the RTC.
+   * @param time The time written.
+   * @param writtenMicros esp_timer_get_time() as the write started.
+   */
+  static void onRtcAdjusted(const DateTime &time, int64_t writtenMicros);
+
+  /**
+   * @brief Starts the free-running clock from an RTC second edge.
+   * @param time The time the RTC changed to.
+   * @param edgeMicros esp_timer_get_time() at the edge.
+   */
+  void anchorClock(const DateTime &time, int64_t edgeMicros);
+
+  /**
+   * @brief Compares an RTC second edge with the system clock, if a comparison is pending.
+   * @param time The time the RTC changed to.
+   * @param edgeMicros esp_timer_get_time() at the edge.
+   */
+  void measureDrift(const DateTime &time, int64_t edgeMicros);
+
+  /**
+   * @brief Reads the DS3231's aging offset register.
+   * @param offset Receives the offset.
+   * @return False if the RTC did not answer.
+   */
+  bool readAgingOffset(int8_t &offset);
+
+  /**
+   * @brief Writes the DS3231's aging offset register and starts a temperature conversion.
+   * @param offset The new offset.
+   * @return False if the RTC did not answer.
+   */
+  bool writeAgingOffset(int8_t offset);
+
   /**
    * @brief Clears both hardware alarms on the RTC.
    */
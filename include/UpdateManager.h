@@ -14,6 +14,19 @@
 
 #define GITHUB_REPO "KennethDoerflein/ESP32Clock"
 
+/// @brief Progress and pipeline timings of a firmware download or upload, for the status API.
+struct OtaProgress
+{
+    bool active;            ///< A download is running.
+    uint32_t bytes;         ///< Bytes hashed and written to flash.
+    int32_t total;          ///< Image size, or -1 if the server didn't say.
+    uint32_t elapsedMs;     ///< Time since the download started, or its length once done.
+    uint32_t kbPerSecond;   ///< Average throughput over `elapsedMs`.
+    uint32_t readerStallMs; ///< Time the network reader waited for a free buffer, i.e. flash was behind. GitHub only.
+    uint32_t writerStallMs; ///< Time the flash writer waited for data, i.e. the network was behind. GitHub only.
+    uint32_t flashMs;       ///< Time the writer spent hashing and in Update.write().
+};
+
 /**
  * @class UpdateManager
  * @brief Manages firmware updates from file uploads and GitHub releases.
@@ -38,16 +51,23 @@ public:
 
     /**
      * @brief Processes a chunk of the firmware file during an upload.
+     *
+     * Each chunk is hashed as it is written, so endUpdate() can check the
+     * image's signature without holding it.
      * @param data A pointer to the data chunk.
      * @param len The length of the data chunk.
      * @param index The starting index of the chunk.
-     * @param total The total size of the firmware file.
+     * @param total The total size of the upload.
+     * @param signatureHex The hex-encoded Ed25519 signature of the image; read with the first chunk.
      */
-    void handleFileUpload(uint8_t *data, size_t len, size_t index, size_t total);
+    void handleFileUpload(uint8_t *data, size_t len, size_t index, size_t total, const String &signatureHex);
 
 
     /**
      * @brief Finalizes the update process with verification.
+     *
+     * The uploaded image becomes the boot partition only if its signature
+     * verifies, when an OTA key is configured.
      * @return True if the update was successful, false otherwise.
      */
     bool endUpdate();
@@ -64,6 +84,20 @@ public:
      */
     bool isUpdateInProgress();
 
+    /**
+     * @brief Gets the update generation number.
+     *
+     * The number increases every time an update starts or finishes.
+     * @return The current update generation.
+     */
+    uint32_t getGeneration() const;
+
+    /**
+     * @brief Gets the progress of the current or last firmware download or upload.
+     * @return A snapshot of the progress.
+     */
+    OtaProgress getDownloadProgress() const;
+
     /**
      * @brief Gets the last verification error message.
      * @return Error message or empty string if no error.
@@ -80,8 +114,14 @@ private:
 
     bool _updateFailed = false;
     bool _updateInProgress = false;
+    bool _uploadVerified = false; ///< The upload came with a signature to check in endUpdate().
+    uint8_t _uploadSignature[FirmwareVerifier::ED25519_SIGNATURE_SIZE];
+    FirmwareVerifier::SHA256Context _uploadSha;
+    volatile uint32_t _generation = 0;
     String _lastError;
 
+    void setUpdateInProgress(bool inProgress);
+
 
     // GitHub update data structure
     struct GithubUpdateInfo
@@ -89,11 +129,41 @@ private:
         String firmwareUrl;
         String signatureUrl;
         String checksumUrl;
+        String patchUrl; ///< Delta patch against the running version, if the release has one.
     };
 
     static void runGithubUpdateTask(void *pvParameters);
-    bool downloadAndVerifyFile(WiFiClientSecure &client, const String &url,
-                               uint8_t *buffer, size_t bufferSize, size_t &bytesRead);
-    bool verifyFirmwareSignature(const uint8_t *firmwareData, size_t firmwareLen,
-                                  const uint8_t *signature);
+
+    /**
+     * @brief Streams a firmware response into the OTA partition, hashing it on the way.
+     * @param http The client holding the response.
+     * @param contentLength The body size, or -1 if the server didn't say.
+     * @param signature The image's Ed25519 signature, or null to skip verification.
+     * @return True if the image was written, verified and marked bootable.
+     */
+    static bool streamFirmware(HTTPClient &http, int contentLength, const uint8_t *signature);
+
+    /**
+     * @brief Rebuilds the new image from a delta patch and the running partition.
+     *
+     * Copy ranges are read from the running partition and literal ranges
+     * from the patch, and the result is streamed into the OTA partition.
+     * @param http The client holding the patch response.
+     * @param signature The new image's Ed25519 signature, or null to skip verification.
+     * @return True if the image was rebuilt, verified and marked bootable.
+     */
+    static bool applyFirmwarePatch(HTTPClient &http, const uint8_t *signature);
+
+    /// @brief The buffers and queues shared by the download's reader and writer.
+    struct FirmwarePipeline;
+
+    /**
+     * @brief Hashes and flashes the buffers the reader fills, until it sends an empty one.
+     * @param parameter The FirmwarePipeline.
+     */
+    static void firmwareWriterTask(void *parameter);
+
+    OtaProgress _progress = {};   ///< Guarded by `_progressMux`.
+    unsigned long _progressStart = 0;
+    mutable portMUX_TYPE _progressMux = portMUX_INITIALIZER_UNLOCKED;
 };
@@ -3,7 +3,17 @@
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
-
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief The current weather.
+ *
+ * Fixed size and trivially copyable, so a copy never allocates. The
+ * condition is kept as its WMO code and turned into text with
+ * `WeatherService::getConditionFromWMO()` when it is drawn.
+ */
 struct WeatherData
 {
   float temp = 0.0;
@@ -11,7 +21,7 @@ struct WeatherData
   float humidity = 0.0;
   float windSpeed = 0.0;
   int rainChance = 0;
-  String condition = "";
+  int16_t weatherCode = -1; ///< WMO weather code; -1 if unknown.
 
   float uvIndex = 0.0;
   int cloudCover = 0;
@@ -19,10 +29,55 @@ struct WeatherData
   float visibility = 0.0;
   int windDirection = 0;
   float windGusts = 0.0;
-  String sunrise = "";
-  String sunset = "";
+  int16_t sunriseMinutes = -1; ///< Local time of sunrise in minutes since midnight; -1 if unknown.
+  int16_t sunsetMinutes = -1;  ///< Local time of sunset in minutes since midnight; -1 if unknown.
 
+  uint32_t fetchedAt = 0;  ///< Local unixtime of the fetch; 0 if unknown.
+  uint32_t generation = 0; ///< Bumped every time the weather is replaced.
   bool isValid = false;
+  bool isStale = false; ///< Loaded from the cache at boot and not fetched since.
+};
+
+static_assert(std::is_trivially_copyable<WeatherData>::value, "WeatherData is copied under a seqlock");
+
+/**
+ * @brief The hourly and daily forecast, in fixed-size arrays.
+ *
+ * Times are local unixtimes, like the RTC's. Temperatures are in °F, as
+ * fetched. Entries past `hourCount` and `dayCount` are unused.
+ */
+struct WeatherForecast
+{
+  static constexpr uint8_t HOURS = 24; ///< Hourly points kept, from the hour of the fetch.
+  static constexpr uint8_t DAYS = 5;   ///< Days kept, from today.
+
+  uint8_t hourCount = 0;
+  uint32_t hourTime[HOURS] = {}; ///< Start of each hour.
+  float hourTemp[HOURS] = {};
+  uint8_t hourRain[HOURS] = {};  ///< Precipitation probability in percent.
+  int16_t hourCode[HOURS] = {};  ///< WMO weather code.
+
+  uint8_t dayCount = 0;
+  uint32_t dayTime[DAYS] = {}; ///< Midnight starting each day.
+  float dayHigh[DAYS] = {};
+  float dayLow[DAYS] = {};
+  uint8_t dayRain[DAYS] = {};  ///< Highest precipitation probability in percent.
+  int16_t dayCode[DAYS] = {};  ///< WMO weather code.
+
+  uint32_t generation = 0; ///< Bumped every time the forecast is replaced.
+};
+
+static_assert(std::is_trivially_copyable<WeatherForecast>::value, "WeatherForecast is copied under a seqlock");
+
+/// @brief Counters for the weather fetches, for the stats API.
+struct WeatherFetchStats
+{
+  uint32_t fetches;       ///< Responses parsed, successfully or not.
+  uint32_t parseFailures; ///< Responses that could not be parsed.
+  uint32_t lastBytes;     ///< Body size of the latest response.
+  uint32_t lastMs;        ///< Time from sending the latest request to the end of its parse.
+  uint32_t lastPeakHeap;  ///< Internal heap the latest fetch took at its peak, in bytes.
+  uint32_t maxPeakHeap;   ///< Highest `lastPeakHeap` since boot.
 };
 
 class WeatherService
@@ -36,8 +91,53 @@ public:
 
   void begin();
   void loop();
+
+  /**
+   * @brief Copies the current weather.
+   *
+   * The copy is taken under a seqlock, so it takes no lock and never waits
+   * on the weather task for more than the few bytes of a write.
+   * @return The current weather.
+   */
   WeatherData getCurrentWeather() const;
 
+  /**
+   * @brief Gets the generation of the current weather without copying it.
+   *
+   * Equal to `WeatherData::generation` of the current weather, so a reader
+   * can tell whether its copy is still current.
+   * @return The weather generation; 0 before any weather was loaded.
+   */
+  uint32_t getWeatherGeneration() const { return _weatherSeq.load(std::memory_order_acquire) / 2; }
+
+  /**
+   * @brief Copies the forecast, under a seqlock like `getCurrentWeather()`.
+   * @param forecast Receives the forecast.
+   * @return False if there is no forecast yet.
+   */
+  bool getForecast(WeatherForecast &forecast) const;
+
+  /**
+   * @brief Gets the generation of the forecast without copying it.
+   * @return The forecast generation; 0 before any forecast was fetched.
+   */
+  uint32_t getForecastGeneration() const { return _forecastSeq.load(std::memory_order_acquire) / 2; }
+
+  /**
+   * @brief Gets the fetch counters and the heap the latest fetch took.
+   * @return The counters.
+   */
+  WeatherFetchStats getFetchStats() const;
+
+  /**
+   * @brief Gets the weather generation number.
+   *
+   * The number increases every time the current weather or the geocoding
+   * result changes, so callers can tell whether anything new is available.
+   * @return The current weather generation.
+   */
+  uint32_t getGeneration() const;
+
   // Called by the persistent background task
   void updateWeather();
   void updateLocation();
@@ -64,10 +164,12 @@ public:
 
   /**
    * @brief Resolves an address string to coordinates and a formatted name.
-   * This is a non-blocking request. The actual resolution happens in the background.
+   * This is a non-blocking request. The actual resolution happens in the background,
+   * unless the query is in the GeocodingCache: then the location is saved at once
+   * and getGeocodingResult() already holds it when this returns.
    *
    * @param query The address/location to search for.
-   * @return true if the request was successfully queued, false otherwise.
+   * @return true if the request was queued or answered from the cache, false otherwise.
    */
   bool resolveLocationAsync(const String &query);
 
@@ -87,10 +189,48 @@ private:
   /// @brief Entry point for the persistent weather task. Runs forever.
   static void weatherTaskEntry(void *parameter);
 
+  /**
+   * @brief Replaces the current weather, stamping it with the next generation.
+   * @param data The new weather.
+   */
+  void publishWeather(const WeatherData &data);
+
+  /**
+   * @brief Replaces the forecast with the one just parsed into `_forecastScratch`.
+   */
+  void publishForecast();
+
+  /**
+   * @brief Marks the current weather invalid if it is still the stale cached copy.
+   * @return True if it was dropped.
+   */
+  bool dropStaleWeather();
+
+  /**
+   * @brief Loads the weather saved by the last successful fetch, marked stale.
+   *
+   * The cache is ignored if it was fetched for another location.
+   */
+  void loadCache();
+
+  /**
+   * @brief Saves the weather so it can be shown straight after the next boot.
+   * @param data The weather just fetched.
+   * @param lat The latitude it was fetched for.
+   * @param lon The longitude it was fetched for.
+   */
+  void saveCache(const WeatherData &data, float lat, float lon);
+
   /// @brief Blocking geocoding helper. Called only from weatherTaskEntry.
   bool resolveLocation(const String &query, String &resolvedAddress, float &lat, float &lon);
 
-  WeatherData _currentWeather;
+  WeatherData _currentWeather;             ///< Written only under `_weatherMux`, read under `_weatherSeq`.
+  std::atomic<uint32_t> _weatherSeq{0};    ///< Odd while `_currentWeather` is being written.
+  portMUX_TYPE _weatherMux = portMUX_INITIALIZER_UNLOCKED;
+  WeatherForecast *_forecast = nullptr;        ///< In PSRAM; written only under `_weatherMux`, read under `_forecastSeq`.
+  WeatherForecast *_forecastScratch = nullptr; ///< In PSRAM; the weather task parses into it.
+  std::atomic<uint32_t> _forecastSeq{0};       ///< Odd while `_forecast` is being written.
+  WeatherFetchStats _fetchStats = {};          ///< Guarded by `_mutex`.
   unsigned long _lastUpdate;
 
   mutable SemaphoreHandle_t _mutex;
@@ -100,4 +240,6 @@ private:
   // Geocoding request state
   String _geocodingQuery;
   GeocodingResult _geocodingResult;
+
+  uint32_t _generation = 0; ///< Bumped under `_mutex` whenever weather or geocoding state changes.
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct WebAsset
+ * @brief A pre-compressed page that is served straight from flash.
+ *
+ * Instances are generated into `WebAssets.h` by `scripts/build_web_assets.py`
+ * at build time. `data` holds the gzipped body, and `etag` is a quoted hash of
+ * it, so the tag changes exactly when the content does.
+ */
+struct WebAsset
+{
+  const uint8_t *data;     ///< Gzipped body, in PROGMEM.
+  size_t length;           ///< Length of `data` in bytes.
+  const char *etag;        ///< Strong ETag, including the quotes.
+  const char *contentType; ///< MIME type of the uncompressed body.
+};
+
+/**
+ * @struct PageSegment
+ * @brief One literal chunk of a page template and the placeholder after it.
+ */
+struct PageSegment
+{
+  uint16_t length; ///< Length of the literal chunk in bytes.
+  const char *var; ///< Placeholder name that follows the chunk, or nullptr for the last segment.
+};
+
+/**
+ * @struct PageTemplate
+ * @brief A page split at build time into literal chunks and placeholders.
+ *
+ * `text` holds every literal chunk back to back, so a segment's chunk starts
+ * where the previous one ended. Placeholders with a value fixed at build
+ * time are already expanded into the text.
+ */
+struct PageTemplate
+{
+  const char *text;            ///< Concatenated literal chunks, in PROGMEM.
+  const PageSegment *segments; ///< The segment table.
+  size_t count;                ///< Number of entries in `segments`.
+  const char *contentType;     ///< MIME type of the page.
+};
@@ -8,6 +8,10 @@
  * All content is stored as C-style string literals in PROGMEM to conserve RAM.
  * The pages use a simple template system where placeholders like %VAR% are
  * replaced by dynamic content in the main C++ code.
+ *
+ * `scripts/build_web_assets.py` precompiles these pages into `WebAssets.h` at
+ * build time: static pages are gzipped, and templated pages are split into
+ * segment tables so placeholders are not searched for on every request.
  */
 
 /**
@@ -220,10 +224,7 @@ const char WEATHER_PAGE_HTML[] PROGMEM = R"rawliteral(
             });
     });
 
-    function fetchWeather() {
-        fetch('/api/weather')
-            .then(response => response.json())
-            .then(data => {
+    function renderWeather(data) {
                 if (data.isValid) {
                     tempEl.textContent = data.temp.toFixed(1);
                     unitEl.textContent = data.unit;
@@ -257,7 +258,12 @@ const char WEATHER_PAGE_HTML[] PROGMEM = R"rawliteral(
                     weatherDisplay.classList.add('d-none');
                     weatherError.classList.remove('d-none');
                 }
-            })
+    }
+
+    function fetchWeather() {
+        fetch('/api/weather')
+            .then(response => response.json())
+            .then(renderWeather)
             .catch(err => {
                 console.error(err);
                 weatherDisplay.classList.add('d-none');
@@ -294,8 +300,14 @@ const char WEATHER_PAGE_HTML[] PROGMEM = R"rawliteral(
     // Initial fetch
     fetchWeather();
     
-    // Refresh periodically
-    setInterval(fetchWeather, 10000);
+    if (window.EventSource) {
+        // The device pushes the weather whenever it is refreshed
+        const events = new EventSource('/api/events');
+        events.addEventListener('weather', (e) => renderWeather(JSON.parse(e.data)));
+    } else {
+        // Refresh periodically
+        setInterval(fetchWeather, 10000);
+    }
   </script>
   <script src="https://cdn.jsdelivr.net/npm/bootstrap@5.3.3/dist/js/bootstrap.bundle.min.js"></script>
 </body>
@@ -432,6 +444,13 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             <p class="fs-4 mb-0" id="rtc-temp"></p>
           </div>
         </div>
+        <div id="sensor-history" class="mt-3" style="display: none;">
+          <svg id="history-temp" class="w-100" style="height: 60px;" preserveAspectRatio="none"><polyline fill="none" stroke="#dc3545" stroke-width="2" vector-effect="non-scaling-stroke" /></svg>
+          <svg id="history-humidity" class="w-100" style="height: 60px;" preserveAspectRatio="none"><polyline fill="none" stroke="#0d6efd" stroke-width="2" vector-effect="non-scaling-stroke" /></svg>
+          <div class="d-flex justify-content-between text-muted small">
+            <span id="history-span"></span><span id="history-range"></span><span>now</span>
+          </div>
+        </div>
       </div>
       <div class="card-footer text-center text-muted small">
         IP: %IP_ADDRESS% &bull; Hostname: %HOSTNAME%.local
@@ -445,11 +464,49 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
       const bmeTempEl = document.getElementById('bme-temp');
       const bmeHumidityEl = document.getElementById('bme-humidity');
       const rtcTempEl = document.getElementById('rtc-temp');
+      const historyEl = document.getElementById('sensor-history');
+      const historyTempEl = document.getElementById('history-temp');
+      const historyHumidityEl = document.getElementById('history-humidity');
+      const historySpanEl = document.getElementById('history-span');
+      const historyRangeEl = document.getElementById('history-range');
+
+      // Plots one series, scaled to its own range; returns [min, max] or null if there is too little to draw.
+      function drawHistory(svg, values) {
+        const known = values.filter(v => v !== null);
+        const line = svg.querySelector('polyline');
+        if (known.length < 2) {
+          line.setAttribute('points', '');
+          return null;
+        }
+        const min = Math.min(...known);
+        const max = Math.max(...known);
+        const span = Math.max(max - min, 1);
+        svg.setAttribute('viewBox', `0 0 ${values.length - 1} 60`);
+        const points = [];
+        values.forEach((v, i) => {
+          if (v !== null) points.push(`${i},${(58 - (v - min) / span * 56).toFixed(1)}`);
+        });
+        line.setAttribute('points', points.join(' '));
+        return [min, max];
+      }
 
-      function updateSensorReadings() {
-        fetch('/api/sensors')
+      function updateSensorHistory() {
+        fetch('/api/sensors/history?step=300')
           .then(response => response.json())
           .then(data => {
+            const temp = drawHistory(historyTempEl, data.temperature);
+            const humidity = drawHistory(historyHumidityEl, data.humidity);
+            if (!temp) return;
+            const range = `${(temp[0] / data.scale).toFixed(1)}-${(temp[1] / data.scale).toFixed(1)}°${data.unit}`;
+            const humidityRange = humidity ? ` / ${(humidity[0] / data.scale).toFixed(0)}-${(humidity[1] / data.scale).toFixed(0)}%` : '';
+            historyRangeEl.textContent = range + humidityRange;
+            historySpanEl.textContent = `-${(data.temperature.length * data.step / 3600).toFixed(1)} h`;
+            historyEl.style.display = 'block';
+          })
+          .catch(error => console.error('Error fetching sensor history:', error));
+      }
+
+      function renderSensorReadings(data) {
             if (data.bmeFound) {
               bmeTempEl.textContent = `${data.bmeTemp}°${data.unit}`;
               bmeHumidityEl.textContent = `${data.bmeHumidity}%`;
@@ -465,14 +522,27 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             } else {
               rtcTempEl.textContent = 'N/A';
             }
-          })
+      }
+
+      function updateSensorReadings() {
+        fetch('/api/sensors')
+          .then(response => response.json())
+          .then(renderSensorReadings)
           .catch(error => console.error('Error fetching sensor data:', error));
       }
 
       // Initial update
       updateSensorReadings();
-      // Update sensors every 3 seconds
-      setInterval(updateSensorReadings, 3000);
+      updateSensorHistory();
+      setInterval(updateSensorHistory, 300000);
+      if (window.EventSource) {
+        // The device pushes new readings as they change
+        const events = new EventSource('/api/events');
+        events.addEventListener('sensors', (e) => renderSensorReadings(JSON.parse(e.data)));
+      } else {
+        // Update sensors every 3 seconds
+        setInterval(updateSensorReadings, 3000);
+      }
     });
   </script>
 </body>
@@ -1103,6 +1173,7 @@ const char SETTINGS_PAGE_HTML[] PROGMEM = R"rawliteral(
                     <option value="1" %DEFAULT_PAGE_SELECTED_1%>Weather</option>
                     <option value="2">System Info</option>
                     <option value="3" %DEFAULT_PAGE_SELECTED_3%>Clock + Weather</option>
+                    <option value="4" %DEFAULT_PAGE_SELECTED_4%>Forecast</option>
                   </select>
                 </div>
                 <div class="mb-3 p-3 border rounded">
@@ -1113,6 +1184,15 @@ const char SETTINGS_PAGE_HTML[] PROGMEM = R"rawliteral(
                   <label for="dismiss-duration" class="form-label">Hold to Dismiss (seconds)</label>
                   <input type="number" class="form-control" id="dismiss-duration" name="dismissDuration" min="1" max="10" value="%DISMISS_DURATION%">
                 </div>
+                <div class="mb-3 p-3 border rounded">
+                  <label class="form-label">Log Levels</label>
+                  <div class="text-muted small mb-2">
+                    Most detailed messages to log from each part of the clock.
+                  </div>
+                  <div id="log-levels-list">
+                    <!-- Items injected by JS -->
+                  </div>
+                </div>
               </form>
               <div class="d-grid gap-2 mt-3">
                 <button type="button" id="reset-general-btn" class="btn btn-danger" title="Reset all general settings to their default values.">Reset General Settings</button>
@@ -1239,11 +1319,12 @@ const char SETTINGS_PAGE_HTML[] PROGMEM = R"rawliteral(
         0: "Clock",
         1: "Weather",
         2: "System Info",
-        3: "Clock + Weather"
+        3: "Clock + Weather",
+        4: "Forecast"
       };
 
       // All available pages in the system (could be dynamic, but hardcoded for now based on main.cpp)
-      const ALL_PAGE_IDS = [0, 1, 3, 2]; // Default preferred order
+      const ALL_PAGE_IDS = [0, 1, 4, 3, 2]; // Default preferred order
 
       const STATUS_INDICATORS = {
         SAVED: '<i class="bi bi-check-circle-fill text-success"></i> <span class="text-muted">Saved</span>',
@@ -1411,6 +1492,44 @@ const char SETTINGS_PAGE_HTML[] PROGMEM = R"rawliteral(
           return enabled;
       }
 
+      const LOG_LEVEL_NAMES = ["None", "Error", "Warn", "Info", "Debug", "Verbose"];
+
+      function renderLogLevels(levels) {
+          const listEl = document.getElementById('log-levels-list');
+          listEl.innerHTML = '';
+          Object.entries(levels || {}).forEach(([module, level]) => {
+              const row = document.createElement('div');
+              row.className = 'd-flex justify-content-between align-items-center mb-2';
+
+              const label = document.createElement('span');
+              label.className = 'text-capitalize';
+              label.textContent = module;
+
+              const select = document.createElement('select');
+              select.className = 'form-select form-select-sm w-auto';
+              select.dataset.logModule = module;
+              LOG_LEVEL_NAMES.forEach((name, value) => {
+                  const option = document.createElement('option');
+                  option.value = value;
+                  option.textContent = name;
+                  option.selected = value === level;
+                  select.appendChild(option);
+              });
+
+              row.appendChild(label);
+              row.appendChild(select);
+              listEl.appendChild(row);
+          });
+      }
+
+      function getLogLevelsFromUI() {
+          const levels = {};
+          document.querySelectorAll('#log-levels-list select').forEach(select => {
+              levels[select.dataset.logModule] = parseInt(select.value);
+          });
+          return levels;
+      }
+
       function updateGeneralSettingsUI(settings) {
         autoBrightnessEl.checked = settings.autoBrightness || false;
         celsiusEl.checked = settings.useCelsius || false;
@@ -1435,6 +1554,7 @@ const char SETTINGS_PAGE_HTML[] PROGMEM = R"rawliteral(
         }
         
         renderPageOrderList(settings.enabledPages);
+        renderLogLevels(settings.logLevels);
 
         // Manually trigger UI updates that depend on these values
         updateBrightnessUI(settings);
@@ -1502,7 +1622,8 @@ const char SETTINGS_PAGE_HTML[] PROGMEM = R"rawliteral(
           enabledPages: getEnabledPagesFromUI(),
           snoozeDuration: parseInt(document.getElementById('snooze-duration').value),
           dismissDuration: parseInt(document.getElementById('dismiss-duration').value),
-          tempCorrection: parseFloat(document.getElementById('temp-correction').value)
+          tempCorrection: parseFloat(document.getElementById('temp-correction').value),
+          logLevels: getLogLevelsFromUI()
         };
 
         if (!settings.useCelsius) {
@@ -2072,8 +2193,12 @@ const char SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
             <div class="card mb-4">
               <div class="card-body">
                 <h5 class="card-title d-flex align-items-center"><i class="bi bi-upload me-2"></i>Manual Update</h5>
-                <p class="card-text text-muted small">Select a .bin file from your computer to upload and flash.</p>
+                <p class="card-text text-muted small">Select a .bin file from your computer and the firmware.sig released with it to upload and flash.</p>
                 <form id="upload-form">
+                  <div class="input-group mb-2">
+                    <span class="input-group-text">Signature</span>
+                    <input type="file" class="form-control" id="firmware-signature" accept=".sig" title="Select the firmware.sig file released with the firmware.">
+                  </div>
                   <div class="input-group">
                     <input type="file" class="form-control" id="firmware" name="firmware" accept=".bin" required title="Select a .bin firmware file.">
                     <button class="btn btn-primary" type="submit" title="Upload the selected firmware file.">Upload</button>
@@ -2170,10 +2295,7 @@ const char SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
     const wifiRssiEl = document.getElementById('wifi-rssi');
     const coreTempEl = document.getElementById('core-temp');
 
-    function updateSystemStats() {
-        fetch('/api/system/stats')
-            .then(response => response.json())
-            .then(data => {
+    function renderSystemStats(data) {
                 if (data.freeHeap) {
                     freeRamEl.textContent = `${(data.freeHeap / 1024).toFixed(2)} KB`;
                 } else {
@@ -2201,14 +2323,25 @@ const char SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
                 } else {
                     coreTempEl.textContent = 'N/A';
                 }
-            })
+    }
+
+    function updateSystemStats() {
+        fetch('/api/system/stats')
+            .then(response => response.json())
+            .then(renderSystemStats)
             .catch(error => console.error('Error fetching system stats:', error));
     }
 
     // Initial update
     updateSystemStats();
-    // Update system stats every 5 seconds
-    setInterval(updateSystemStats, 5000);
+    // The device pushes stats and update progress; fall back to polling without EventSource
+    const events = window.EventSource ? new EventSource('/api/events') : null;
+    if (events) {
+        events.addEventListener('stats', (e) => renderSystemStats(JSON.parse(e.data)));
+    } else {
+        // Update system stats every 5 seconds
+        setInterval(updateSystemStats, 5000);
+    }
 
     window.addEventListener('beforeunload', (event) => {
       if (isUpdating) {
@@ -2217,35 +2350,81 @@ const char SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
       }
     });
 
+    function onUpdateStatus(data) {
+      if (data.inProgress) {
+        const download = data.download;
+        if (download && download.active && download.total > 0) {
+          const percent = Math.floor(download.bytes * 100 / download.total);
+          showStatus(`Updating firmware... ${percent}% (${download.kbPerSecond} KB/s)`, 'info');
+        } else {
+          showStatus('Updating firmware... please wait.', 'info');
+        }
+        setButtonsDisabled(true);
+      } else {
+        stopPollingStatus();
+        showStatus('Update complete. Device will reboot shortly.', 'success');
+        setButtonsDisabled(false); // Re-enable buttons now
+        isUpdating = false;
+      }
+    }
+
+    function onUpdateConnectionLost() {
+      // The connection drops when the device reboots. This is an expected "success" case.
+      stopPollingStatus();
+      showStatus('Update complete. Device is rebooting...', 'success');
+      setButtonsDisabled(false); // Re-enable buttons now
+      isUpdating = false;
+    }
+
+    function stopPollingStatus() {
+      clearInterval(pollInterval);
+      if (events) {
+        events.removeEventListener('update', onUpdateEvent);
+        events.removeEventListener('error', onUpdateConnectionLost);
+      }
+    }
+
+    function onUpdateEvent(e) {
+      onUpdateStatus(JSON.parse(e.data));
+    }
+
     function startPollingStatus() {
+      if (events) {
+        events.addEventListener('update', onUpdateEvent);
+        events.addEventListener('error', onUpdateConnectionLost);
+        return;
+      }
       pollInterval = setInterval(() => {
         fetch('/api/update/status')
           .then(r => {
             if (!r.ok) { throw new Error('Network error or device rebooting'); }
             return r.json();
           })
-          .then(data => {
-            if (data.inProgress) {
-              showStatus('Updating firmware... please wait.', 'info');
-              setButtonsDisabled(true);
-            } else {
-              // Update finished, but polling caught it.
-              clearInterval(pollInterval);
-              showStatus('Update complete. Device will reboot shortly.', 'success');
-              setButtonsDisabled(false); // Re-enable buttons now
-              isUpdating = false;
-            }
-          })
-          .catch((error) => {
-            // Fetch fails if device reboots. This is an expected "success" case.
-            clearInterval(pollInterval);
-            showStatus('Update complete. Device is rebooting...', 'success');
-            setButtonsDisabled(false); // Re-enable buttons now
-            isUpdating = false;
-          });
+          .then(onUpdateStatus)
+          .catch(onUpdateConnectionLost); // Fetch fails if device reboots.
       }, 2500);
     }
 
+    // Shows the bytes flashed so far while an upload runs; returns a function that stops it.
+    function watchUploadProgress() {
+      const onProgress = (data) => {
+        const download = data.download;
+        if (isUpdating && download && download.active && download.total > 0) {
+          const percent = Math.min(100, Math.floor(download.bytes * 100 / download.total));
+          showStatus(`Uploading firmware... ${percent}% (${download.kbPerSecond} KB/s). Do not close this page.`);
+        }
+      };
+      if (events) {
+        const onEvent = (e) => onProgress(JSON.parse(e.data));
+        events.addEventListener('update', onEvent);
+        return () => events.removeEventListener('update', onEvent);
+      }
+      const timer = setInterval(() => {
+        fetch('/api/update/status').then(r => r.json()).then(onProgress).catch(() => {});
+      }, 2000);
+      return () => clearInterval(timer);
+    }
+
     function showStatus(message, type = 'info') {
       statusDiv.innerHTML = `<div class="alert alert-${type} d-flex align-items-center" role="alert">
           ${type === 'info' ? '<div class="spinner-border spinner-border-sm me-2" role="status"><span class="visually-hidden">Loading...</span></div>' : ''}
@@ -2289,7 +2468,7 @@ const char SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
         setSystemButtonsDisabled(disabled);
     }
 
-    uploadForm.addEventListener('submit', function(e) {
+    uploadForm.addEventListener('submit', async function(e) {
       e.preventDefault();
       if (!fileInput.files.length) {
         showStatus('Please select a firmware file first.', 'warning');
@@ -2298,16 +2477,28 @@ const char SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
       showStatus('Uploading firmware... Do not close this page.');
       setButtonsDisabled(true);
       isUpdating = true; // Set flag to prevent navigation
+      const stopProgress = watchUploadProgress();
+
+      // The detached signature travels as a header, so the device has it before the first chunk.
+      const headers = {};
+      const signatureInput = document.getElementById('firmware-signature');
+      if (signatureInput.files.length) {
+        headers['X-Firmware-Signature'] = (await signatureInput.files[0].text()).trim();
+      }
 
       const formData = new FormData(this);
       fetch('/update', {
         method: 'POST',
+        headers: headers,
         body: formData
       })
       .then(response => {
+        stopProgress();
         if (!response.ok) {
           // Server sent a 500 or other error
-          throw new Error(`Server responded with status: ${response.status} ${response.statusText}`);
+          return response.text().then(text => {
+            throw new Error(text || `Server responded with status: ${response.status} ${response.statusText}`);
+          });
         }
         return response.text();
       })
@@ -2328,6 +2519,7 @@ const char SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
       .catch(error => {
         // This catch block will be hit if the server reboots *before* sending a response,
         // OR if the response.ok was false.
+        stopProgress();
         showStatus(`Upload failed: ${error.message}`, 'danger');
         setButtonsDisabled(false);
         isUpdating = false;
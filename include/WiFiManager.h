@@ -3,10 +3,12 @@
 #pragma once
 
 #include <Arduino.h>
+#include <ArduinoJson.h>
 #include <DNSServer.h>
 #include <memory>
 #include <WiFi.h>
 #include <freertos/semphr.h>
+#include "Constants.h"
 
 /**
  * @class WiFiManager
@@ -36,7 +38,9 @@ public:
   /**
    * @brief Initializes the WiFi module and attempts to connect.
    *
-   * If credentials are saved, it tries to connect. If not, or if connection
+   * If credentials are saved, it tries to connect, going straight to the
+   * access point and channel that worked last time before falling back to a
+   * full scan. If not, or if connection
    * fails and credentials are invalid, it starts the captive portal.
    *
    * @return True if the captive portal was started, false otherwise.
@@ -69,15 +73,25 @@ public:
   bool isCaptivePortal() const;
 
   /**
-   * @brief Starts a non-blocking WiFi scan.
+   * @brief Starts a non-blocking WiFi scan, unless one is running or the last is still fresh.
+   * @return True if a scan is running; false if the last results are being kept.
    */
-  void startScan();
+  bool startScan();
 
   /**
-   * @brief Gets the results of the WiFi scan as a JSON string.
-   * @return A JSON string containing scan results or status.
+   * @brief Takes the results of a finished scan, freeing the driver's copy.
+   *
+   * Call before getScanResults(); the returned generation changes whenever
+   * what getScanResults() would write does.
+   * @return The scan generation.
+   */
+  uint32_t pollScan();
+
+  /**
+   * @brief Gets the results of the WiFi scan as JSON.
+   * @param doc Receives the scan results or status.
    */
-  String getScanResults();
+  void getScanResults(JsonDocument &doc);
 
   /**
    * @brief Gets the configured hostname.
@@ -153,6 +167,60 @@ private:
   // Helper to start the captive portal
   void startCaptivePortal();
 
+  /// @brief The access point and lease of the last good connection, kept in Preferences.
+  struct FastConnectRecord
+  {
+    uint8_t version;
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip; ///< The DHCP lease: address, gateway, mask and first DNS server.
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+  };
+
+  /**
+   * @brief Loads the record of the last good connection.
+   * @param ssid The network about to be joined; a record for another one is ignored.
+   * @return True if there is a usable record for `ssid`, now in `_fastConnect`.
+   */
+  bool loadFastConnect(const String &ssid);
+
+  /**
+   * @brief Records the current connection's access point and lease, if they changed.
+   * @param ssid The network joined.
+   */
+  void saveFastConnect(const String &ssid);
+
+  /**
+   * @brief Waits for the event handler to report an IP address.
+   * @param timeout The longest wait, in ms.
+   * @return True if connected in time.
+   */
+  bool waitForConnection(unsigned long timeout);
+
+  /// @brief One network from a scan.
+  struct ScanEntry
+  {
+    char ssid[33];
+    int8_t rssi;
+    uint8_t channel;
+    wifi_auth_mode_t encryption;
+  };
+
+  /// @brief Copies a finished scan into `_scanResults`, one entry per SSID. Call with `_mutex` held.
+  void captureScan(int16_t count);
+
+  ScanEntry _scanResults[WIFI_SCAN_MAX_RESULTS]; ///< Strongest first, guarded by `_mutex`.
+  uint8_t _scanCount = 0;
+  bool _hasScan = false;         ///< `_scanResults` holds a finished scan.
+  bool _scanRunning = false;     ///< A scan started by startScan() hasn't been taken yet.
+  unsigned long _scanTime = 0;   ///< When the held scan finished.
+  uint32_t _scanGeneration = 0;  ///< Bumped whenever a scan starts, finishes or fails.
+
+  FastConnectRecord _fastConnect = {}; ///< What Preferences holds, so unchanged connections aren't rewritten.
+
   // Flag to communicate connection result from event handler
   static volatile bool _connectionResult;
 
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "ArenaSprite.h"
+#include "FontManager.h"
+#include <cstdint>
+
+/**
+ * @class Widget
+ * @brief A retained-mode UI element with a fixed bounding box on the screen.
+ *
+ * A widget keeps the last value it was given and only marks itself dirty when
+ * a setter changes something visible. A `WidgetLayer` redraws and pushes just
+ * the dirty widgets' boxes, so a page never has to clear the whole screen to
+ * update a single field.
+ */
+class Widget
+{
+public:
+  /**
+   * @brief Constructs a new Widget.
+   * @param x The screen x-coordinate of the bounding box.
+   * @param y The screen y-coordinate of the bounding box.
+   * @param w The width of the bounding box.
+   * @param h The height of the bounding box.
+   */
+  Widget(int16_t x, int16_t y, int16_t w, int16_t h) : _x(x), _y(y), _w(w), _h(h) {}
+  virtual ~Widget() {}
+
+  /**
+   * @brief Sets the color the bounding box is cleared to before drawing.
+   * @param bg The background color.
+   */
+  void setBackground(uint16_t bg);
+
+  /**
+   * @brief Forces the widget to be redrawn on the next render.
+   */
+  void invalidate() { _dirty = true; }
+
+  bool isDirty() const { return _dirty; }
+  int16_t x() const { return _x; }
+  int16_t y() const { return _y; }
+  int16_t width() const { return _w; }
+  int16_t height() const { return _h; }
+  uint16_t background() const { return _bg; }
+
+  /**
+   * @brief Draws the widget's content.
+   * @param sprite A sprite whose top-left `width()` x `height()` pixels map to
+   *               the bounding box. It has already been cleared to the background.
+   */
+  virtual void draw(TFT_eSprite &sprite) = 0;
+
+  /**
+   * @brief Clears the dirty flag once the widget has been pushed to the screen.
+   */
+  void markClean() { _dirty = false; }
+
+protected:
+  int16_t _x, _y, _w, _h;
+  uint16_t _bg = TFT_BLACK;
+  bool _dirty = true;
+};
+
+/**
+ * @class LabelWidget
+ * @brief A single line of text, positioned by a TFT_eSPI datum within its box.
+ *
+ * Either one of the built-in numbered fonts or a FontManager smooth font can be used.
+ */
+class LabelWidget : public Widget
+{
+public:
+  static constexpr size_t MAX_TEXT = 64; ///< Maximum label length, including the terminator.
+
+  LabelWidget(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t datum = MC_DATUM)
+      : Widget(x, y, w, h), _datum(datum) {}
+
+  /**
+   * @brief Sets the label's text. The widget is only marked dirty if it changed.
+   * @param text The new text (truncated to MAX_TEXT - 1 characters).
+   */
+  void setText(const char *text);
+
+  /**
+   * @brief Sets the label's text from a printf-style format string.
+   */
+  void setTextf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+  void setColor(uint16_t color);
+  void setFont(uint8_t font);
+  void setSmoothFont(FontId font);
+
+  const char *text() const { return _text; }
+
+  void draw(TFT_eSprite &sprite) override;
+
+private:
+  char _text[MAX_TEXT] = {};
+  uint16_t _color = TFT_WHITE;
+  uint8_t _font = 2;
+  FontId _smoothFont = FONT_COUNT; ///< FONT_COUNT = use the built-in `_font`.
+  uint8_t _datum;
+};
+
+/**
+ * @class ValueWidget
+ * @brief A formatted number followed by an optional degree mark and unit.
+ *
+ * The number, mark, and unit are laid out as one group centered horizontally
+ * in the box and top-aligned, so a unit in a smaller font reads as a
+ * superscript. The value is formatted into a fixed buffer and compared as
+ * text, so changes below the displayed precision do not cause a redraw.
+ */
+class ValueWidget : public Widget
+{
+public:
+  ValueWidget(int16_t x, int16_t y, int16_t w, int16_t h) : Widget(x, y, w, h) {}
+
+  /**
+   * @brief Sets the displayed value.
+   * @param value The number to show.
+   * @param decimals The number of digits after the decimal point.
+   */
+  void setValue(float value, uint8_t decimals);
+
+  /**
+   * @brief Sets the unit drawn after the value.
+   * @param unit The unit text (e.g., "F", "%", "km/h").
+   * @param degree True to draw a degree circle between the value and the unit.
+   * @param gap The spacing in pixels between the value and the unit.
+   */
+  void setUnit(const char *unit, bool degree = false, uint8_t gap = 2);
+
+  void setColor(uint16_t color);
+
+  /**
+   * @brief Sets the built-in fonts used for the value and the unit.
+   * @param valueFont The font number for the value.
+   * @param unitFont The font number for the unit.
+   * @param degreeRadius The radius of the degree circle, in pixels.
+   */
+  void setFonts(uint8_t valueFont, uint8_t unitFont, uint8_t degreeRadius = 2);
+
+  void draw(TFT_eSprite &sprite) override;
+
+private:
+  char _value[16] = {};
+  char _unit[8] = {};
+  bool _degree = false;
+  uint8_t _gap = 2;
+  uint16_t _color = TFT_WHITE;
+  uint8_t _valueFont = 4;
+  uint8_t _unitFont = 4;
+  uint8_t _degreeRadius = 2;
+};
+
+/**
+ * @class IconWidget
+ * @brief A small procedurally drawn icon selected by an integer state.
+ *
+ * The drawing function is only called again when the state or color changes.
+ */
+class IconWidget : public Widget
+{
+public:
+  /**
+   * @brief Draws the icon into the top-left `w` x `h` pixels of the sprite.
+   */
+  using DrawFn = void (*)(TFT_eSprite &sprite, int16_t w, int16_t h, uint16_t color, uint16_t bg, int32_t state);
+
+  IconWidget(int16_t x, int16_t y, int16_t w, int16_t h, DrawFn drawFn)
+      : Widget(x, y, w, h), _drawFn(drawFn) {}
+
+  void setState(int32_t state);
+  void setColor(uint16_t color);
+
+  void draw(TFT_eSprite &sprite) override;
+
+private:
+  DrawFn _drawFn;
+  int32_t _state = 0;
+  uint16_t _color = TFT_WHITE;
+};
+
+/**
+ * @class WidgetLayer
+ * @brief A set of widgets that share one scratch sprite for rendering.
+ *
+ * The sprite is sized to the largest widget box and carved from the sprite
+ * arena once, by `begin()`, so entering a page never allocates. Each dirty
+ * widget is cleared, drawn into the sprite's top-left corner, and pushed as
+ * a region through the display's DMA pipeline.
+ */
+class WidgetLayer
+{
+public:
+  static constexpr int MAX_WIDGETS = 16; ///< Maximum number of widgets in one layer.
+
+  explicit WidgetLayer(TFT_eSPI *tft);
+  ~WidgetLayer();
+
+  WidgetLayer(const WidgetLayer &) = delete;
+  WidgetLayer &operator=(const WidgetLayer &) = delete;
+
+  /**
+   * @brief Adds a widget to the layer. The layer does not take ownership.
+   * @return False if the layer is full, or the widget is larger than the sprite `begin()` created.
+   */
+  bool add(Widget &widget);
+
+  /**
+   * @brief Creates the scratch sprite, sized to the widgets added so far.
+   * @return False if there was no memory for it; `render()` then draws nothing.
+   */
+  bool begin();
+
+  /// @brief Whether `begin()` created the scratch sprite.
+  bool isReady() const { return _sprite.created(); }
+
+  /**
+   * @brief Clears the screen and says the page could not get its sprite.
+   *
+   * For pages whose layer is not ready, in place of their widgets.
+   * @param tft The screen or frame the page renders to.
+   * @param bg The background color.
+   */
+  static void drawUnavailable(TFT_eSPI &tft, uint16_t bg);
+
+  /**
+   * @brief Sets the background color of every widget in the layer.
+   */
+  void setBackground(uint16_t bg);
+
+  /**
+   * @brief Marks every widget dirty, e.g. after the screen was cleared.
+   */
+  void invalidateAll();
+
+  /**
+   * @brief Redraws and pushes the dirty widgets.
+   * @return The number of widgets that were redrawn.
+   */
+  int render();
+
+  /**
+   * @brief Unloads any smooth font from the scratch sprite. The sprite itself is kept.
+   */
+  void release();
+
+private:
+  ArenaSprite _sprite;
+  Widget *_widgets[MAX_WIDGETS] = {};
+  int _count = 0;
+  int16_t _spriteW = 0;
+  int16_t _spriteH = 0;
+};
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Page.h"
+#include "ConfigManager.h"
+#include "GlyphAtlas.h"
+#include "ArenaSprite.h"
 #include <TFT_eSPI.h>
 #include <cstdint>
 #include <cstring>
@@ -50,7 +53,22 @@ public:
   virtual void render(TFT_eSPI &tft) override;
   virtual void refresh(TFT_eSPI &tft, bool fullRefresh) override;
 
+  /**
+   * @brief Draws the next second's seconds cells, and at a minute's end the
+   *        next time's cells, into their sprites without pushing them.
+   * @param next The time the next second will show.
+   */
+  virtual void prerenderSecond(const DateTime &next) override;
+
 protected:
+  /// @brief A span of glyph cells drawn into a sprite ahead of time but not yet pushed.
+  struct PendingCells
+  {
+    bool ready;     ///< True while the sprite holds cells the screen doesn't show yet.
+    int32_t dirtyX; ///< Left edge of the span, in sprite coordinates.
+    int32_t dirtyW; ///< Width of the span.
+  };
+
   virtual void setupSprites(TFT_eSPI &tft);
   virtual void setupLayout(TFT_eSPI &tft);
 
@@ -68,7 +86,12 @@ protected:
   virtual void drawSeconds(TFT_eSPI &tft);
   virtual void drawNextAlarms(TFT_eSPI &tft, const char *alarm1, const char *alarm2);
 
-  virtual void updateSpriteColors();
+  /**
+   * @brief Applies the configured theme to the sprites if it changed since the last call.
+   * @param force True to reapply the theme even if its generation is unchanged.
+   */
+  void applyTheme(bool force = false);
+  virtual void updateSpriteColors(const Theme &theme);
   void updateDisplayData(DisplayData &data);
 
   // --- Shared helpers for subclasses ---
@@ -83,22 +106,77 @@ protected:
   /// @brief Resets the common clock fields to force a full redraw on next render.
   void resetClockFields(ClockDisplayBase &base);
 
+  /// @brief Forgets what the time and seconds sprites show, so their next draw repaints every cell.
+  void invalidateGlyphCells();
+
+  /**
+   * @brief Redraws only the glyph cells of a right-aligned string that changed.
+   *
+   * Compares `text` against `shown` (what the sprite currently holds) cell by
+   * cell from the right edge and repaints only the differing cells. An empty
+   * `shown` repaints the whole sprite.
+   *
+   * @param sprite The sprite to draw into.
+   * @param atlas The glyph atlas for the sprite's font and colors.
+   * @param text The new string.
+   * @param shown The string the sprite currently shows; updated to `text`.
+   * @param shownSize The size of the `shown` buffer.
+   * @param right The x-coordinate of the string's right edge.
+   * @param top The y-coordinate of the top of the glyph row.
+   * @param dirtyX Receives the left edge of the changed span.
+   * @param dirtyW Receives the width of the changed span (0 if nothing changed).
+   * @return False if the atlas cannot draw `text`; the caller must redraw normally.
+   */
+  bool drawGlyphCells(TFT_eSprite &sprite, GlyphAtlas &atlas, const char *text, char *shown, size_t shownSize,
+                      int32_t right, int32_t top, int32_t &dirtyX, int32_t &dirtyW);
+
+  /**
+   * @brief Like `drawGlyphCells()`, but also takes in any cells drawn ahead of time.
+   *
+   * The changed span is widened to cover the pending cells, which then count
+   * as pushed. If `text` is what was pre-rendered, nothing is drawn and the
+   * span is exactly the pending one.
+   * @return False if the atlas cannot draw `text`; the caller must redraw normally.
+   */
+  bool drawGlyphCells(TFT_eSprite &sprite, GlyphAtlas &atlas, const char *text, char *shown, size_t shownSize,
+                      int32_t right, int32_t top, PendingCells &pending, int32_t &dirtyX, int32_t &dirtyW);
+
+  /**
+   * @brief Draws glyph cells ahead of time and adds them to `pending`.
+   */
+  void prerenderGlyphCells(TFT_eSprite &sprite, GlyphAtlas &atlas, const char *text, char *shown, size_t shownSize,
+                           int32_t right, int32_t top, PendingCells &pending);
+
   // Flag to track sprite creation
   bool _spritesCreated = false;
 
-  // Sprites for this page, initialized in the constructor
-  TFT_eSprite _sprClock;
-  TFT_eSprite _sprDayOfWeek;
-  TFT_eSprite _sprDate;
-  TFT_eSprite _sprTemp;
-  TFT_eSprite _sprHumidity;
-  TFT_eSprite _sprTOD;
-  TFT_eSprite _sprSeconds;
-  TFT_eSprite _sprNextAlarm1;
-  TFT_eSprite _sprNextAlarm2;
+  // Sprites for this page, initialized in the constructor. The clock and
+  // seconds sprites are 16 bpp for the glyph atlases; the rest are 4 bpp.
+  ArenaSprite _sprClock;
+  ArenaSprite _sprDayOfWeek;
+  ArenaSprite _sprDate;
+  ArenaSprite _sprTemp;
+  ArenaSprite _sprHumidity;
+  ArenaSprite _sprTOD;
+  ArenaSprite _sprSeconds;
+  ArenaSprite _sprNextAlarm1;
+  ArenaSprite _sprNextAlarm2;
+
+  // Pre-rasterized digit glyphs for the hottest draw paths
+  GlyphAtlas _clockAtlas;
+  GlyphAtlas _secondsAtlas;
+
+  // What the time and seconds sprites currently show, for per-cell diffing
+  char _shownTime[8] = {};
+  char _shownSeconds[4] = {};
+
+  // Cells drawn ahead of the next second edge, waiting for the next render
+  PendingCells _pendingTime = {};
+  PendingCells _pendingSeconds = {};
 
   // Cached values to prevent unnecessary redraws
   DisplayData _lastData;
+  uint32_t _themeGeneration = 0; ///< Theme generation the sprite colors were built from.
 
   // Layout position variables
   int _clockX;
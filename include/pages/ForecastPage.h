@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Page.h"
+#include "Widget.h"
+#include "WeatherService.h"
+#include "ConfigManager.h"
+
+/**
+ * @class HourlyChartWidget
+ * @brief The next 24 hours as a temperature line over precipitation bars.
+ *
+ * Draws from the page's forecast copy; the page invalidates it when that
+ * copy or the units change.
+ */
+class HourlyChartWidget : public Widget
+{
+public:
+  HourlyChartWidget(int16_t x, int16_t y, int16_t w, int16_t h, const WeatherForecast &forecast)
+      : Widget(x, y, w, h), _forecast(forecast) {}
+
+  /**
+   * @brief Sets the display settings the chart depends on.
+   * @param celsius Whether to label temperatures in °C.
+   * @param use24Hour Whether to label hours as 0-23.
+   */
+  void setFormat(bool celsius, bool use24Hour);
+
+  /**
+   * @brief Sets the colors of the line and labels, the rain bars and the axis text.
+   */
+  void setColors(uint16_t line, uint16_t rain, uint16_t text);
+
+  void draw(TFT_eSprite &sprite) override;
+
+private:
+  const WeatherForecast &_forecast;
+  bool _celsius = false;
+  bool _use24Hour = false;
+  uint16_t _lineColor = TFT_WHITE;
+  uint16_t _rainColor = TFT_BLUE;
+  uint16_t _textColor = TFT_WHITE;
+};
+
+/**
+ * @class ForecastDayWidget
+ * @brief One day's column: weekday, high/low, condition and rain chance.
+ */
+class ForecastDayWidget : public Widget
+{
+public:
+  ForecastDayWidget(int16_t x, int16_t y, int16_t w, int16_t h, const WeatherForecast &forecast, uint8_t day)
+      : Widget(x, y, w, h), _forecast(forecast), _day(day) {}
+
+  /**
+   * @brief Sets whether to show temperatures in °C.
+   */
+  void setCelsius(bool celsius);
+
+  /**
+   * @brief Sets the colors of the temperatures and of the other text.
+   */
+  void setColors(uint16_t temp, uint16_t text);
+
+  void draw(TFT_eSprite &sprite) override;
+
+private:
+  const WeatherForecast &_forecast;
+  uint8_t _day;
+  bool _celsius = false;
+  uint16_t _tempColor = TFT_WHITE;
+  uint16_t _textColor = TFT_WHITE;
+};
+
+/**
+ * @class ForecastPage
+ * @brief A page showing the hourly forecast for the next day and the next five days.
+ *
+ * The page keeps its own copy of the forecast in PSRAM, refreshed only when
+ * the forecast generation changes, and its widgets draw from that copy.
+ */
+class ForecastPage : public Page
+{
+public:
+  explicit ForecastPage(TFT_eSPI *tft);
+  virtual ~ForecastPage();
+
+  void onEnter(TFT_eSPI &tft) override;
+  void onExit() override;
+  void update() override;
+  void render(TFT_eSPI &tft) override;
+  void refresh(TFT_eSPI &tft, bool fullRefresh) override;
+
+private:
+  /// @brief Reads colors and units from the configuration into the widgets.
+  void applyConfig();
+
+  static constexpr uint8_t DAYS = WeatherForecast::DAYS;
+
+  WeatherForecast *_forecast; ///< The copy the widgets draw from, in PSRAM.
+  uint16_t _bgColor = TFT_BLACK;
+  uint32_t _themeGeneration = 0;     ///< Theme generation the widget colors were set from.
+  ConfigChangeCursor _configChanges; ///< Settings changes already applied to the widgets.
+  uint32_t _forecastGeneration = UINT32_MAX; ///< Forecast generation held in `_forecast`.
+  bool _hasData = false;
+  bool _needsClear = true; ///< Clear the screen before the next render (layer switch).
+
+  // Shown once a forecast has been fetched.
+  WidgetLayer _dataLayer;
+  LabelWidget _title;
+  HourlyChartWidget _chart;
+  ForecastDayWidget _days[DAYS];
+  LabelWidget _attribution;
+
+  // Shown until the first successful fetch.
+  WidgetLayer _statusLayer;
+  LabelWidget _statusTitle;
+  LabelWidget _statusDetail;
+};
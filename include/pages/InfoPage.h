@@ -1,20 +1,46 @@
 #pragma once
 
 #include "Page.h"
+#include "Widget.h"
 #include <TFT_eSPI.h>
 
 /**
  * @class InfoPage
- * @brief A simple page that displays static information.
+ * @brief A simple page that displays device and network information.
+ *
+ * The fields are retained widgets, so the page can follow network changes
+ * (a new IP address after a reconnect, the signal strength) while only
+ * redrawing the lines that changed.
  */
 class InfoPage : public Page
 {
 public:
-  InfoPage();
+  explicit InfoPage(TFT_eSPI *tft);
   virtual ~InfoPage();
 
   void onEnter(TFT_eSPI &tft) override;
   void onExit() override;
   void update() override;
   void render(TFT_eSPI &tft) override;
-};
\ No newline at end of file
+
+private:
+  /**
+   * @brief Draws a four-bar signal strength icon; `state` is the number of lit bars.
+   */
+  static void drawSignalBars(TFT_eSprite &sprite, int16_t w, int16_t h, uint16_t color, uint16_t bg, int32_t state);
+
+  /// @brief Summarizes the page with the highest p95 frame time into the render row.
+  void updateRenderSummary();
+
+  /// @brief Summarizes the loop step with the highest p99 and the loop's worst jitter into the loop row.
+  void updateLoopSummary();
+
+  WidgetLayer _layer;
+  LabelWidget _title;
+  LabelWidget _host;
+  LabelWidget _ip;
+  LabelWidget _version;
+  LabelWidget _render; ///< Render profiler summary for the slowest page.
+  LabelWidget _loop;   ///< Loop profiler summary for the slowest step.
+  IconWidget _signal;
+};
@@ -13,8 +13,7 @@ struct WeatherClockDisplayData : public ClockDisplayBase
 {
   float indoorTemp;
   float indoorHumidity;
-  float outdoorTemp;
-  String outdoorCondition;
+  uint32_t weatherGeneration; ///< WeatherService::getWeatherGeneration() of the outdoor weather.
   char nextAlarm[16];
 };
 
@@ -45,14 +44,20 @@ private:
   void drawBottomAlarm(TFT_eSPI &tft, const char *alarmText);
   void drawIndoorHumidity(TFT_eSPI &tft);
 
-  void updateSpriteColors() override;
+  void updateSpriteColors(const Theme &theme) override;
   void updateDisplayData(WeatherClockDisplayData &data);
 
+  // Palette indices of the two ramps in the 4 bpp weather sprite.
+  static constexpr uint8_t WEATHER_TEMP_PAPER = 0;
+  static constexpr uint8_t WEATHER_TEMP_INK = 7;
+  static constexpr uint8_t WEATHER_FORECAST_PAPER = 8;
+  static constexpr uint8_t WEATHER_FORECAST_INK = 15;
+
   // Sprites
-  TFT_eSprite _sprWeather;        // Row 2
-  TFT_eSprite _sprIndoorTemp;     // Row 4 Left
-  TFT_eSprite _sprBottomAlarm;    // Row 4 Center
-  TFT_eSprite _sprIndoorHumidity; // Row 4 Right
+  ArenaSprite _sprWeather;        // Row 2
+  ArenaSprite _sprIndoorTemp;     // Row 4 Left
+  ArenaSprite _sprBottomAlarm;    // Row 4 Center
+  ArenaSprite _sprIndoorHumidity; // Row 4 Right
 
   // Cached values
   WeatherClockDisplayData _lastWeatherData;
@@ -1,12 +1,22 @@
 #pragma once
 
 #include "Page.h"
+#include "Widget.h"
 #include "WeatherService.h"
 #include "ConfigManager.h"
 
+/**
+ * @class WeatherPage
+ * @brief A page showing the current weather conditions in detail.
+ *
+ * Every field is a retained widget, so a weather or settings update only
+ * redraws the boxes whose text actually changed.
+ */
 class WeatherPage : public Page
 {
 public:
+  explicit WeatherPage(TFT_eSPI *tft);
+
   void onEnter(TFT_eSPI &tft) override;
   void onExit() override;
   void update() override;
@@ -14,11 +24,37 @@ public:
   void refresh(TFT_eSPI &tft, bool fullRefresh) override;
 
 private:
-  unsigned long _lastRenderTime = 0;
-  WeatherData _lastWeatherData;
-  bool _needsRedraw = true;
+  /// @brief Reads colors, units and the address from the configuration into the widgets.
+  void applyConfig();
+
+  /// @brief Copies the latest weather data into the widgets.
+  void applyWeather(const WeatherData &data);
+
+  uint16_t _bgColor = TFT_BLACK;
+  uint32_t _themeGeneration = 0; ///< Theme generation the widget colors were set from.
+  ConfigChangeCursor _configChanges; ///< Settings changes already applied to the widgets.
+  bool _celsius = false;
+  bool _hasData = false;
+  uint32_t _weatherGeneration = UINT32_MAX; ///< Weather generation shown by the widgets.
+  bool _needsClear = true; ///< Clear the screen before the next render (layer switch).
+
+  // Shown while weather data is available.
+  WidgetLayer _dataLayer;
+  LabelWidget _location;
+  ValueWidget _temp;
+  LabelWidget _condition;
+  LabelWidget _feelsLikeLabel;
+  ValueWidget _feelsLike;
+  LabelWidget _humidityLabel;
+  ValueWidget _humidity;
+  LabelWidget _windLabel;
+  ValueWidget _wind;
+  LabelWidget _rainLabel;
+  ValueWidget _rain;
+  LabelWidget _attribution;
 
-  // Helpers
-  void drawWeather(TFT_eSPI &tft);
-  uint16_t getConditionColor(const String &condition);
+  // Shown until the first successful fetch.
+  WidgetLayer _statusLayer;
+  LabelWidget _statusTitle;
+  LabelWidget _statusDetail;
 };
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+build_web_assets.py - Pre-compress the static web UI pages for ESP32Clock
+
+Reads the raw-literal pages in include/WebContent.h and expands the
+placeholders whose values are fixed at build time (the shared <head>, the
+serial log tab). It then writes include/WebAssets.h with:
+
+  - one gzipped PROGMEM byte array and content-hash ETag per static page, and
+  - one segment table per templated page: the page text with its placeholders
+    cut out, plus the length of each literal chunk and the placeholder that
+    follows it, so the server never has to scan the page for '%'.
+
+It runs automatically as a PlatformIO extra script, and can also be run by
+hand from the project root:
+
+    python scripts/build_web_assets.py
+
+The header is only rewritten when its content changes, so unchanged pages do
+not trigger a rebuild.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+# Placeholders that are replaced by other WebContent.h literals.
+STATIC_PLACEHOLDERS = {
+    "HEAD": "BOOTSTRAP_HEAD",
+    "SERIAL_LOG_TAB": "SERIAL_LOG_TAB_HTML",
+    "SERIAL_LOG_TAB_PANE": "SERIAL_LOG_TAB_PANE_HTML",
+    "SERIAL_LOG_SCRIPT": "SERIAL_LOG_SCRIPT_JS",
+}
+
+# (generated asset name, source literal, content type, served through the template processor)
+ASSETS = [
+    ("ALARMS_PAGE", "ALARMS_PAGE_HTML", "text/html", True),
+    ("SYSTEM_PAGE", "SYSTEM_PAGE_HTML", "text/html", True),
+    ("SIMPLE_WIFI_SETUP_PAGE", "SIMPLE_WIFI_SETUP_HTML", "text/html", False),
+]
+
+# (generated template name, source literal, content type) for pages with per-request values
+TEMPLATES = [
+    ("INDEX_PAGE", "INDEX_HTML", "text/html"),
+    ("WIFI_CONFIG_PAGE", "WIFI_CONFIG_HTML", "text/html"),
+    ("SETTINGS_PAGE", "SETTINGS_PAGE_HTML", "text/html"),
+    ("WEATHER_PAGE", "WEATHER_PAGE_HTML", "text/html"),
+]
+
+LITERAL_RE = re.compile(r'const char (\w+)\[\] PROGMEM = R"rawliteral\((.*?)\)rawliteral";', re.S)
+PLACEHOLDER_RE = re.compile(r"%([A-Z0-9_]*)%")
+
+
+def expand(body, literals, templated):
+    """Expands the build-time placeholders the way the server's processor would."""
+    if not templated:
+        return body
+
+    def replace(match):
+        name = match.group(1)
+        if name == "":
+            return "%"  # "%%" is the template escape for a literal percent sign.
+        if name in STATIC_PLACEHOLDERS:
+            return literals[STATIC_PLACEHOLDERS[name]]
+        raise ValueError(f"placeholder %{name}% is not known at build time")
+
+    return PLACEHOLDER_RE.sub(replace, body)
+
+
+def split_segments(body, literals):
+    """Splits a page into (literal chunk, placeholder or None) pairs.
+
+    Build-time placeholders and "%%" are folded into the literal chunks, so only
+    the placeholders that need a value at request time remain.
+    """
+    segments = []
+    chunk = ""
+    position = 0
+    for match in PLACEHOLDER_RE.finditer(body):
+        chunk += body[position : match.start()]
+        position = match.end()
+        name = match.group(1)
+        if name == "":
+            chunk += "%"
+        elif name in STATIC_PLACEHOLDERS:
+            chunk += literals[STATIC_PLACEHOLDERS[name]]
+        else:
+            segments.append((chunk, name))
+            chunk = ""
+    segments.append((chunk + body[position:], None))
+    return segments
+
+
+def template_code(name, literal, content_type, literals):
+    segments = split_segments(literals[literal], literals)
+    table = []
+    for chunk, var in segments:
+        length = len(chunk.encode("utf-8"))
+        if length > 0xFFFF:
+            raise ValueError(f"{literal}: literal chunk of {length} bytes does not fit a segment")
+        table.append(f'    {{{length}, "{var}"}},' if var else f"    {{{length}, nullptr}},")
+    text = "".join(chunk for chunk, _ in segments)
+    print(f"build_web_assets: {literal} {len(segments) - 1} slots, {len(text.encode('utf-8'))} literal bytes")
+    return [
+        f"// {literal}: {len(segments) - 1} placeholders",
+        f'static const char {name}_TEXT[] PROGMEM = R"rawliteral({text})rawliteral";',
+        f"static const PageSegment {name}_SEGMENTS[] = {{",
+        *table,
+        "};",
+        f'static const PageTemplate {name}_TEMPLATE = {{{name}_TEXT, {name}_SEGMENTS, '
+        f'sizeof({name}_SEGMENTS) / sizeof({name}_SEGMENTS[0]), "{content_type}"}};',
+        "",
+    ]
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 20):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i : i + 20]) + ",")
+    return "\n".join(lines)
+
+
+def generate(project_dir):
+    source_path = os.path.join(project_dir, "include", "WebContent.h")
+    output_path = os.path.join(project_dir, "include", "WebAssets.h")
+
+    with open(source_path, "r", encoding="utf-8") as f:
+        literals = {m.group(1): m.group(2) for m in LITERAL_RE.finditer(f.read())}
+
+    parts = [
+        "// Generated by scripts/build_web_assets.py from WebContent.h. Do not edit.",
+        "",
+        "#pragma once",
+        "",
+        '#include "WebAsset.h"',
+        "",
+        "#define WEB_ASSETS_AVAILABLE 1",
+        "",
+    ]
+    for name, literal, content_type, templated in ASSETS:
+        body = expand(literals[literal], literals, templated).encode("utf-8")
+        # mtime=0 keeps the output, and therefore the ETag, reproducible.
+        data = gzip.compress(body, compresslevel=9, mtime=0)
+        etag = hashlib.sha256(data).hexdigest()[:16]
+        parts += [
+            f"// {literal}: {len(body)} bytes, {len(data)} gzipped",
+            f"static const uint8_t {name}_GZ[] PROGMEM = {{",
+            c_bytes(data),
+            "};",
+            f'static const WebAsset {name}_ASSET = {{{name}_GZ, sizeof({name}_GZ), "\\"{etag}\\"", "{content_type}"}};',
+            "",
+        ]
+        print(f"build_web_assets: {literal} {len(body)} -> {len(data)} bytes, ETag {etag}")
+    for name, literal, content_type in TEMPLATES:
+        parts += template_code(name, literal, content_type, literals)
+
+    content = "\n".join(parts)
+    if os.path.exists(output_path):
+        with open(output_path, "r", encoding="utf-8") as f:
+            if f.read() == content:
+                return
+    with open(output_path, "w", encoding="utf-8") as f:
+        f.write(content)
+    print(f"build_web_assets: wrote {output_path}")
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(sys.argv[0]))))
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+make_firmware_patch.py - Build a delta OTA patch between two ESP32Clock firmware images
+
+The clock rebuilds the new image by copying unchanged ranges out of its
+running partition and taking only the changed bytes from the patch, so a
+release that touches a little code costs a small download. The fonts and the
+web pages, which make up most of the image, are copied.
+
+Usage:
+    python scripts/make_firmware_patch.py <old firmware.bin> <new firmware.bin> <output.patch>
+
+Example:
+    python scripts/make_firmware_patch.py v1.4.0/firmware.bin .pio/build/esp32s3_n16r8/firmware.bin firmware-v1.4.0.patch
+
+The patch is published as firmware-<old version>.patch next to firmware.bin
+and firmware.sig. It needs no signature of its own: the clock checks the
+rebuilt image against firmware.sig before it will boot it, exactly as for a
+full download.
+
+Format (little-endian):
+    header  "ECDP", u8 version, 3 reserved bytes,
+            u32 source size, 32-byte source SHA-256,
+            u32 target size, 32-byte target SHA-256
+    ops     u8 0: end
+            u8 1, u32 offset, u32 length: copy from the running image
+            u8 2, u32 length, bytes: insert literal bytes
+"""
+
+import hashlib
+import os
+import struct
+import sys
+
+MAGIC = b"ECDP"
+VERSION = 1
+BLOCK = 32      # Bytes hashed to find a match; shorter runs are sent as literals.
+MIN_COPY = 48   # A copy op costs 9 bytes, so shorter matches aren't worth one.
+
+OP_END = 0
+OP_COPY = 1
+OP_INSERT = 2
+
+
+def index_source(source):
+    """Maps every BLOCK-aligned block of the source to its first offset."""
+    blocks = {}
+    for offset in range(0, len(source) - BLOCK + 1, BLOCK):
+        blocks.setdefault(source[offset:offset + BLOCK], offset)
+    return blocks
+
+
+def diff(source, target):
+    """Yields ("copy", offset, length) and ("insert", bytes) ops rebuilding target."""
+    blocks = index_source(source)
+    literal_start = 0
+    position = 0
+    while position + BLOCK <= len(target):
+        match = blocks.get(target[position:position + BLOCK])
+        if match is None:
+            position += 1
+            continue
+
+        # Grow the match backwards into pending literals, then forwards.
+        start, source_start = position, match
+        while start > literal_start and source_start > 0 and target[start - 1] == source[source_start - 1]:
+            start -= 1
+            source_start -= 1
+        end, source_end = position + BLOCK, match + BLOCK
+        while end < len(target) and source_end < len(source) and target[end] == source[source_end]:
+            end += 1
+            source_end += 1
+
+        if end - start < MIN_COPY:
+            position += 1
+            continue
+        if start > literal_start:
+            yield ("insert", target[literal_start:start])
+        yield ("copy", source_start, end - start)
+        literal_start = position = end
+
+    if literal_start < len(target):
+        yield ("insert", target[literal_start:])
+
+
+def main():
+    if len(sys.argv) < 4:
+        print("Usage: python make_firmware_patch.py <old firmware.bin> <new firmware.bin> <output.patch>")
+        sys.exit(1)
+
+    old_path, new_path, patch_path = sys.argv[1], sys.argv[2], sys.argv[3]
+    for path in (old_path, new_path):
+        if not os.path.exists(path):
+            print(f"ERROR: Firmware file not found: {path}")
+            sys.exit(1)
+
+    with open(old_path, "rb") as f:
+        source = f.read()
+    with open(new_path, "rb") as f:
+        target = f.read()
+    print(f"Old firmware: {len(source)} bytes")
+    print(f"New firmware: {len(target)} bytes")
+
+    patch = bytearray()
+    patch += struct.pack("<4sB3xI32sI32s", MAGIC, VERSION,
+                         len(source), hashlib.sha256(source).digest(),
+                         len(target), hashlib.sha256(target).digest())
+    copied = inserted = 0
+    for op in diff(source, target):
+        if op[0] == "copy":
+            patch += struct.pack("<BII", OP_COPY, op[1], op[2])
+            copied += op[2]
+        else:
+            patch += struct.pack("<BI", OP_INSERT, len(op[1]))
+            patch += op[1]
+            inserted += len(op[1])
+    patch += struct.pack("<B", OP_END)
+
+    with open(patch_path, "wb") as f:
+        f.write(patch)
+    print(f"Copied {copied} bytes, inserted {inserted} bytes")
+    print(f"Patch written to: {patch_path} ({len(patch)} bytes, {100 * len(patch) / len(target):.1f}% of the image)")
+
+
+if __name__ == "__main__":
+    main()
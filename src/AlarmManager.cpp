@@ -2,8 +2,8 @@
  * @file AlarmManager.cpp
  * @brief Implements the AlarmManager class for handling alarm ringing logic.
  *
- * This file contains the implementation of the AlarmManager, which controls
- * the physical buzzer, manages the alarm sound progression (ramping), and
+ * This file contains the implementation of the AlarmManager, which drives
+ * the buzzer, manages the alarm sound progression (ramping), and
  * handles auto-shutoff and resuming alarms after a reboot.
  */
 
@@ -31,8 +31,7 @@ AlarmManager::AlarmManager() : _isRinging(false), _activeAlarmId(-1)
  */
 void AlarmManager::begin()
 {
-  pinMode(BUZZER_PIN, OUTPUT);
-  digitalWrite(BUZZER_PIN, LOW);
+  Buzzer::getInstance().begin();
 
   // --- Check for a ringing alarm at startup ---
   int8_t ringingAlarmId = ConfigManager::getInstance().getRingingAlarmId();
@@ -42,15 +41,15 @@ void AlarmManager::begin()
     _resumeAlarmOnBoot = true;
     _pendingResumeAlarmId = ringingAlarmId;
     _pendingResumeTimestamp = ConfigManager::getInstance().getRingingAlarmStartTimestamp();
-    SerialLog::getInstance().print("AlarmManager: Pending resume for alarm.\n");
+    LOG_I(LOG_MODULE_ALARM, "AlarmManager: Pending resume for alarm.\n");
   }
 }
 
 /**
  * @brief Updates the state of the ringing alarm.
  *
- * This method should be called in the main loop. It handles the progressive
- * ramping of the alarm sound, from slow beeps to a continuous tone. It also
+ * This method should be called in the main loop. It moves the buzzer through
+ * the ramp stages, from slow beeps to a continuous tone. It also
  * contains the logic for automatically shutting off the alarm after a prolonged
  * period.
  */
@@ -85,53 +84,54 @@ void AlarmManager::update()
   // --- Auto-off Logic ---
   if (alarmElapsedSeconds >= ALARM_AUTO_OFF_SECONDS)
   {
-    SerialLog::getInstance().print("AlarmManager: Auto-stopping alarm after 30 minutes.\n");
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "AlarmManager: Auto-stopping alarm after 30 minutes.\n");
     stop();
     return;
   }
 
   if (_rampStage == STAGE_SLOW_BEEP && alarmElapsedSeconds >= (STAGE1_DURATION_MS / 1000))
   {
-    SerialLog::getInstance().print("AlarmManager: Ramping to STAGE_FAST_BEEP\n");
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "AlarmManager: Ramping to STAGE_FAST_BEEP\n");
     _rampStage = STAGE_FAST_BEEP;
+    if (!_pattern.isValid())
+    {
+      startStage(); // An alarm's own pattern carries on unchanged.
+    }
   }
   else if (_rampStage == STAGE_FAST_BEEP && alarmElapsedSeconds >= ((STAGE1_DURATION_MS + STAGE2_DURATION_MS) / 1000))
   {
-    SerialLog::getInstance().print("AlarmManager: Ramping to STAGE_CONTINUOUS\n");
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "AlarmManager: Ramping to STAGE_CONTINUOUS\n");
     _rampStage = STAGE_CONTINUOUS;
-    digitalWrite(BUZZER_PIN, HIGH); // Turn buzzer on permanently for this stage
-    return;                         // Skip beeping logic
+    startStage();
   }
+}
 
+/**
+ * @brief Starts the buzzer on the current ramp stage.
+ *
+ * An alarm's own pattern replaces both beeping stages, so it keeps its
+ * rhythm until the continuous tone takes over.
+ */
+void AlarmManager::startStage()
+{
+  Buzzer &buzzer = Buzzer::getInstance();
   if (_rampStage == STAGE_CONTINUOUS)
   {
-    return; // Buzzer is already on
+    buzzer.on();
+    return;
   }
 
-  // --- Beeping Logic ---
-  unsigned long currentTime = millis();
-  unsigned long beepOnDuration = (_rampStage == STAGE_SLOW_BEEP) ? SLOW_BEEP_ON_MS : FAST_BEEP_ON_MS;
-  unsigned long beepOffDuration = (_rampStage == STAGE_SLOW_BEEP) ? SLOW_BEEP_OFF_MS : FAST_BEEP_OFF_MS;
-  unsigned long beepElapsedTime = currentTime - _lastBeepTime;
-
-  if (_buzzerState == BEEP_ON)
+  if (_pattern.isValid())
   {
-    if (beepElapsedTime >= beepOnDuration)
-    {
-      _buzzerState = BEEP_OFF;
-      _lastBeepTime = currentTime;
-      digitalWrite(BUZZER_PIN, LOW);
-    }
-  }
-  else // BEEP_OFF
-  {
-    if (beepElapsedTime >= beepOffDuration)
-    {
-      _buzzerState = BEEP_ON;
-      _lastBeepTime = currentTime;
-      digitalWrite(BUZZER_PIN, HIGH);
-    }
+    buzzer.play(_pattern);
+    return;
   }
+
+  BuzzerPattern pattern;
+  pattern.count = 2;
+  pattern.stepsMs[0] = (_rampStage == STAGE_SLOW_BEEP) ? SLOW_BEEP_ON_MS : FAST_BEEP_ON_MS;
+  pattern.stepsMs[1] = (_rampStage == STAGE_SLOW_BEEP) ? SLOW_BEEP_OFF_MS : FAST_BEEP_OFF_MS;
+  buzzer.play(pattern);
 }
 
 /**
@@ -147,8 +147,8 @@ void AlarmManager::stop()
   if (!_isRinging)
     return;
 
-  SerialLog::getInstance().printf("Stopping alarm ID %d\n", _activeAlarmId);
-  digitalWrite(BUZZER_PIN, LOW); // Ensure buzzer is off
+  LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Stopping alarm ID %d\n", _activeAlarmId);
+  Buzzer::getInstance().stop(); // Ensure buzzer is off
   _isRinging = false;
   _activeAlarmId = -1;
 
@@ -160,7 +160,7 @@ void AlarmManager::stop()
 
   // --- Reset state machine ---
   _rampStage = STAGE_SLOW_BEEP;
-  _buzzerState = BEEP_OFF;
+  _pattern = BuzzerPattern();
 
   Display::getInstance().setBacklightFlashing(false);
 
@@ -203,14 +203,13 @@ void AlarmManager::trigger(uint8_t alarmId)
   if (_isRinging)
     return; // Don't trigger if another is already active
 
-  SerialLog::getInstance().printf("Triggering alarm ID %d\n", alarmId);
+  LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Triggering alarm ID %d\n", alarmId);
 
   // --- Initialize the ramping alarm state ---
   _alarmStartTimestamp = TimeManager::getInstance().getRTCTime().unixtime();
-  _lastBeepTime = millis();
+  _pattern = ConfigManager::getInstance().getAlarmById(alarmId).getBuzzerPattern();
   _rampStage = STAGE_SLOW_BEEP;
-  _buzzerState = BEEP_ON;
-  digitalWrite(BUZZER_PIN, HIGH); // Start with the buzzer on
+  startStage(); // Starts with the buzzer on
   _isRinging = true;
   _activeAlarmId = alarmId;
 
@@ -243,15 +242,12 @@ void AlarmManager::resume(uint8_t alarmId, uint32_t startTimestamp)
   if (_isRinging)
     return;
 
-  SerialLog::getInstance().printf("Resuming ringing alarm ID %d\n", alarmId);
+  LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Resuming ringing alarm ID %d\n", alarmId);
   _isRinging = true;
   _activeAlarmId = alarmId;
   _alarmStartTimestamp = startTimestamp;
 
-  // We don't know the buzzer state from before the reboot, so start it
-  _lastBeepTime = millis();
-  _buzzerState = BEEP_ON;
-  digitalWrite(BUZZER_PIN, HIGH);
+  _pattern = ConfigManager::getInstance().getAlarmById(alarmId).getBuzzerPattern();
 
   // Re-evaluate the ramp stage based on how long it's been ringing.
   uint32_t now = TimeManager::getInstance().getRTCTime().unixtime();
@@ -260,7 +256,7 @@ void AlarmManager::resume(uint8_t alarmId, uint32_t startTimestamp)
   // In this case, start fresh from STAGE_SLOW_BEEP to be safe.
   uint32_t alarmElapsedSeconds = 0;
   if (!TimeManager::getInstance().isTimeSet() || now < _alarmStartTimestamp) {
-    SerialLog::getInstance().print("AlarmManager: RTC time invalid at resume, starting from STAGE_SLOW_BEEP.\n");
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "AlarmManager: RTC time invalid at resume, starting from STAGE_SLOW_BEEP.\n");
     _rampStage = STAGE_SLOW_BEEP;
   } else {
     alarmElapsedSeconds = now - _alarmStartTimestamp;
@@ -278,7 +274,9 @@ void AlarmManager::resume(uint8_t alarmId, uint32_t startTimestamp)
       _rampStage = STAGE_SLOW_BEEP;
     }
   }
-  SerialLog::getInstance().printf("Resumed at ramp stage %d\n", _rampStage);
+  LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Resumed at ramp stage %d\n", _rampStage);
+  // Whatever the buzzer was doing before the reboot, start the stage afresh.
+  startStage();
 
   // Flash backlight
   Display::getInstance().setBacklightFlashing(true);
@@ -0,0 +1,217 @@
+/**
+ * @file AlarmSchedule.cpp
+ * @brief Implements the incrementally maintained alarm schedule.
+ */
+#include "AlarmSchedule.h"
+#include "Alarm.h"
+#include <algorithm>
+
+/**
+ * @brief Takes the schedule-relevant fields of an alarm.
+ * @param alarm The alarm.
+ * @return Its rule.
+ */
+AlarmSchedule::Rule AlarmSchedule::ruleFor(const Alarm &alarm)
+{
+  return {alarm.getId(), alarm.isEnabled(), alarm.getHour(), alarm.getMinute(),
+          alarm.getDays(), alarm.isSnoozed(), alarm.getSnoozeUntil()};
+}
+
+/**
+ * @brief Works out when a rule rings next after `now`.
+ * @param rule The rule.
+ * @param now The current time.
+ * @param time Set to the next ring time, if there is one.
+ * @return False if the rule is disabled or never rings.
+ */
+bool AlarmSchedule::nextRingTime(const Rule &rule, const DateTime &now, DateTime &time)
+{
+  if (!rule.enabled)
+  {
+    return false;
+  }
+
+  // If the alarm is snoozed, the next ring time is the snooze end time.
+  if (rule.snoozed)
+  {
+    time = DateTime(rule.snoozeUntil);
+    return true;
+  }
+
+  // Check today
+  if (rule.hour > now.hour() || (rule.hour == now.hour() && rule.minute > now.minute()))
+  {
+    if (rule.days == 0 || (rule.days & (1 << now.dayOfTheWeek())))
+    {
+      time = DateTime(now.year(), now.month(), now.day(), rule.hour, rule.minute, 0);
+      return true;
+    }
+  }
+
+  // Check for the next 7 days
+  for (int i = 1; i <= 7; ++i)
+  {
+    uint8_t dayOfWeek = (now.dayOfTheWeek() + i) % 7;
+    if (rule.days == 0 || (rule.days & (1 << dayOfWeek)))
+    {
+      DateTime next = now + TimeSpan(i, 0, 0, 0);
+      time = DateTime(next.year(), next.month(), next.day(), rule.hour, rule.minute, 0);
+      return true;
+    }
+  }
+
+  return false; // No valid ring time found
+}
+
+/**
+ * @brief Brings the schedule up to date with an alarm table.
+ *
+ * Both the old and the new rules are sorted by ID and walked together, so
+ * finding the changes is linear; each change is an erase and a binary-search
+ * insert into the order.
+ * @param alarms The current alarms.
+ * @param now The current time.
+ */
+void AlarmSchedule::sync(const std::vector<Alarm> &alarms, const DateTime &now)
+{
+  std::vector<Rule> rules;
+  rules.reserve(alarms.size());
+  for (const auto &alarm : alarms)
+  {
+    rules.push_back(ruleFor(alarm));
+  }
+  std::sort(rules.begin(), rules.end(), [](const Rule &a, const Rule &b)
+            { return a.id < b.id; });
+
+  auto oldRule = _rules.begin();
+  auto newRule = rules.begin();
+  while (oldRule != _rules.end() || newRule != rules.end())
+  {
+    if (newRule == rules.end() || (oldRule != _rules.end() && oldRule->id < newRule->id))
+    {
+      unplace(oldRule->id);
+      ++oldRule;
+    }
+    else if (oldRule == _rules.end() || newRule->id < oldRule->id)
+    {
+      place(*newRule, now);
+      ++newRule;
+    }
+    else
+    {
+      if (*oldRule != *newRule)
+      {
+        unplace(oldRule->id);
+        place(*newRule, now);
+      }
+      ++oldRule;
+      ++newRule;
+    }
+  }
+  _rules = std::move(rules);
+
+  advance(now);
+}
+
+/**
+ * @brief Re-places the alarms whose ring time is no longer in the future.
+ *
+ * Ring times fall on a whole minute, so an entry is due once the clock
+ * reaches its minute; recomputing it then moves it to its next occurrence.
+ * A snoozed alarm whose snooze has ended stays due until it is re-synced.
+ * @param now The current time.
+ */
+void AlarmSchedule::advance(const DateTime &now)
+{
+  if (now.unixtime() < _evaluatedAt)
+  {
+    rebuild(now);
+    return;
+  }
+  _evaluatedAt = now.unixtime();
+
+  auto firstLater = std::find_if(_order.begin(), _order.end(), [&now](const NextAlarmTime &entry)
+                                 { return entry.time > now; });
+  if (firstLater == _order.begin())
+  {
+    return;
+  }
+
+  std::vector<uint8_t> due;
+  due.reserve(firstLater - _order.begin());
+  for (auto entry = _order.begin(); entry != firstLater; ++entry)
+  {
+    due.push_back(entry->id);
+  }
+  _order.erase(_order.begin(), firstLater);
+
+  for (uint8_t id : due)
+  {
+    auto rule = std::lower_bound(_rules.begin(), _rules.end(), id, [](const Rule &r, uint8_t value)
+                                 { return r.id < value; });
+    if (rule != _rules.end() && rule->id == id)
+    {
+      place(*rule, now);
+    }
+  }
+}
+
+/**
+ * @brief Re-places every alarm.
+ * @param now The current time.
+ */
+void AlarmSchedule::rebuild(const DateTime &now)
+{
+  _order.clear();
+  for (const auto &rule : _rules)
+  {
+    place(rule, now);
+  }
+  _evaluatedAt = now.unixtime();
+}
+
+/**
+ * @brief Copies the soonest alarms.
+ * @param count The most to copy.
+ * @return Up to `count` alarms, soonest first.
+ */
+std::vector<NextAlarmTime> AlarmSchedule::next(size_t count) const
+{
+  count = std::min(count, _order.size());
+  return std::vector<NextAlarmTime>(_order.begin(), _order.begin() + count);
+}
+
+/**
+ * @brief Inserts an enabled rule at its next ring time, if it has one.
+ *
+ * Disabled rules are kept in `_rules` so edits are still diffed, but never
+ * get an entry. Alarms ringing at the same time keep the order they were
+ * placed in.
+ */
+void AlarmSchedule::place(const Rule &rule, const DateTime &now)
+{
+  if (!rule.enabled)
+  {
+    return;
+  }
+  DateTime time;
+  if (!nextRingTime(rule, now, time))
+  {
+    return;
+  }
+  NextAlarmTime entry = {time, rule.id};
+  _order.insert(std::upper_bound(_order.begin(), _order.end(), entry), entry);
+}
+
+/**
+ * @brief Removes an alarm's entry, if it has one.
+ */
+void AlarmSchedule::unplace(uint8_t id)
+{
+  auto entry = std::find_if(_order.begin(), _order.end(), [id](const NextAlarmTime &e)
+                            { return e.id == id; });
+  if (entry != _order.end())
+  {
+    _order.erase(entry);
+  }
+}
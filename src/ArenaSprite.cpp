@@ -0,0 +1,156 @@
+/**
+ * @file ArenaSprite.cpp
+ * @brief Implements the PSRAM sprite arena and arena-backed palettized sprites.
+ *
+ * `TFT_eSprite` only allocates its own buffers (and, once DMA is enabled,
+ * places them in internal RAM). `ArenaSprite::createSprite()` instead sets up
+ * the same sprite state around a block carved from the arena, or allocated
+ * in PSRAM when the arena is full.
+ */
+
+#include "ArenaSprite.h"
+#include "DisplayManager.h"
+#include "FontManager.h"
+#include "SerialLog.h"
+#include <esp32-hal-psram.h>
+
+bool SpriteArena::begin(size_t size)
+{
+  if (_base != nullptr)
+  {
+    return true;
+  }
+  _base = (uint8_t *)ps_malloc(size);
+  if (_base == nullptr)
+  {
+    LOG_E(LOG_MODULE_DISPLAY, "SpriteArena: failed to reserve %u bytes.\n", (unsigned)size);
+    return false;
+  }
+  _size = size;
+  _used = 0;
+  return true;
+}
+
+uint8_t *SpriteArena::allocate(size_t bytes)
+{
+  size_t aligned = (bytes + 3) & ~(size_t)3;
+  if (_base == nullptr || _used + aligned > _size)
+  {
+    return nullptr;
+  }
+  uint8_t *block = _base + _used;
+  _used += aligned;
+  memset(block, 0, aligned);
+  return block;
+}
+
+/**
+ * @brief Constructs a new ArenaSprite. No memory is reserved until `createSprite()`.
+ * @param tft A pointer to the TFT_eSPI driver instance.
+ * @param colorDepth The sprite's color depth (4 or 16).
+ */
+ArenaSprite::ArenaSprite(TFT_eSPI *tft, uint8_t colorDepth) : TFT_eSprite(tft)
+{
+  setColorDepth(colorDepth);
+  _colorMap = _palette; // Never let TFT_eSprite allocate a palette.
+}
+
+/**
+ * @brief Destroys the ArenaSprite without handing arena memory to `free()`.
+ */
+ArenaSprite::~ArenaSprite()
+{
+  FontManager::getInstance().release(*this);
+  deleteSprite();
+  _colorMap = nullptr;
+}
+
+void *ArenaSprite::createSprite(int16_t width, int16_t height)
+{
+  if (_created)
+  {
+    return _img8_1;
+  }
+  if (width < 1 || height < 1 || (_bpp != 4 && _bpp != 16))
+  {
+    return nullptr;
+  }
+
+  // Same layout as TFT_eSprite::callocSprite(), including the extra "off screen" pixel.
+  int32_t imageWidth = (_bpp == 4) ? ((width + 1) & 0xFFFE) : width;
+  size_t bytes = (_bpp == 4) ? ((imageWidth * height) >> 1) + 1 : ((size_t)width * height + 1) * sizeof(uint16_t);
+
+  uint8_t *buffer = DisplayManager::getInstance().spriteArena().allocate(bytes);
+  bool inArena = buffer != nullptr;
+  if (!inArena)
+  {
+    LOG_W(LOG_MODULE_DISPLAY, "ArenaSprite: arena full, allocating %dx%d sprite in PSRAM.\n", width, height);
+    buffer = (uint8_t *)ps_calloc(1, bytes);
+    if (buffer == nullptr)
+    {
+      LOG_E(LOG_MODULE_DISPLAY, "ArenaSprite: no PSRAM for %u bytes.\n", (unsigned)bytes);
+      return nullptr;
+    }
+  }
+
+  _iwidth = imageWidth;
+  _dwidth = _bitwidth = width;
+  _iheight = _dheight = height;
+  cursor_x = 0;
+  cursor_y = 0;
+  _sx = 0;
+  _sy = 0;
+  _sw = width;
+  _sh = height;
+  _scolor = TFT_BLACK;
+
+  _img8 = buffer;
+  _img8_1 = buffer;
+  _img8_2 = buffer;
+  _img = (uint16_t *)buffer;
+  _img4 = buffer;
+
+  _created = true;
+  _inArena = inArena;
+  _ownsBuffer = !inArena;
+  rotation = 0;
+  setViewport(0, 0, _dwidth, _dheight);
+  setPivot(_iwidth / 2, _iheight / 2);
+  return _img8_1;
+}
+
+void ArenaSprite::deleteSprite()
+{
+  if (!_created)
+  {
+    return;
+  }
+  if (_ownsBuffer)
+  {
+    free(_img8_1);
+  }
+  _created = false;
+  _inArena = false;
+  _ownsBuffer = false;
+  _img8 = _img8_1 = _img8_2 = _img4 = nullptr;
+  _img = nullptr;
+}
+
+void ArenaSprite::setPaletteRamp(uint8_t paper, uint8_t ink, uint16_t paperColor, uint16_t inkColor)
+{
+  if (ink > 15 || paper >= ink)
+  {
+    return;
+  }
+  uint8_t steps = ink - paper;
+  for (uint8_t i = 0; i <= steps; i++)
+  {
+    _palette[paper + i] = alphaBlend(i * 255 / steps, inkColor, paperColor);
+  }
+}
+
+void ArenaSprite::setRamp(uint16_t fg, uint16_t bg)
+{
+  setPaletteRamp(PAPER, INK, bg, fg);
+  setTextColor(INK, PAPER);
+}
@@ -3,8 +3,8 @@
  * @brief Implements the ButtonManager class for handling hardware button interrupts.
  *
  * This file contains the implementation for the ButtonManager, which uses
- * hardware interrupts to detect button presses and releases, calculates the
- * press duration, and provides a debounced interface for the main application.
+ * hardware interrupts to queue debounced press and release edges, and
+ * decodes them into gestures for the main application.
  */
 #include "ButtonManager.h"
 #include "Constants.h"
@@ -14,7 +14,7 @@
  * @param pin The GPIO pin the button is connected to.
  */
 ButtonManager::ButtonManager(int pin)
-    : _pin(pin), _pressDuration(0), _newPress(false), _lastInterruptTime(0), _buttonPressTime(0)
+    : _pin(pin), _lastInterruptTime(0)
 {
 }
 
@@ -43,8 +43,7 @@ void ButtonManager::attach()
 /**
  * @brief Detaches the interrupt handler from the button's pin.
  *
- * This disables the button's ability to trigger events, which is useful when
- * polling is required (e.g., when an alarm is ringing).
+ * This disables the button's ability to trigger events.
  */
 void ButtonManager::detach()
 {
@@ -54,81 +53,186 @@ void ButtonManager::detach()
 /**
  * @brief The Interrupt Service Routine (ISR) for the button.
  *
- * This static method is called by the ESP32's interrupt system. It handles
- * debouncing and records the press and release times to calculate the duration.
- * This method should not be called directly.
+ * This static method is called by the ESP32's interrupt system. It debounces
+ * the pin and queues each change of level with its time. If the queue is
+ * full the edge is dropped; `nextGesture()` recovers a lost release from the
+ * pin level. This method should not be called directly.
  *
  * @param arg A void pointer to the ButtonManager instance.
  */
 void IRAM_ATTR ButtonManager::handleInterrupt(void *arg)
 {
   ButtonManager *instance = static_cast<ButtonManager *>(arg);
-  portENTER_CRITICAL_ISR(&instance->_mux);
   unsigned long interruptTime = millis();
 
   if (interruptTime - instance->_lastInterruptTime < DEBOUNCE_DELAY)
   {
-    portEXIT_CRITICAL_ISR(&instance->_mux);
     return;
   }
   instance->_lastInterruptTime = interruptTime;
+  bool pressed = digitalRead(instance->_pin) == LOW;
 
-  if (digitalRead(instance->_pin) == LOW)
+  uint32_t head = instance->_edgeHead.load(std::memory_order_relaxed);
+  if (head - instance->_edgeTail.load(std::memory_order_acquire) >= EDGE_QUEUE_SIZE)
   {
-    instance->_buttonPressTime = interruptTime;
+    return;
   }
-  else
+  instance->_edges[head % EDGE_QUEUE_SIZE] = {(uint32_t)interruptTime, pressed};
+  instance->_edgeHead.store(head + 1, std::memory_order_release);
+
+  // Wake the consumer so it reacts to the edge instead of waiting out its interval.
+  if (instance->_notifyTask != NULL)
   {
-    if (instance->_buttonPressTime > 0)
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(instance->_notifyTask, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken)
     {
-      instance->_pressDuration = interruptTime - instance->_buttonPressTime;
-      instance->_newPress = true;
-      instance->_buttonPressTime = 0;
+      portYIELD_FROM_ISR();
     }
   }
-  portEXIT_CRITICAL_ISR(&instance->_mux);
 }
 
 /**
- * @brief Gets the duration of the last recorded button press.
- *
- * This function is thread-safe and can be called from the main loop.
- *
- * @return The press duration in milliseconds.
+ * @brief Takes the oldest queued edge.
+ * @param edge Receives the edge.
+ * @return False if the queue is empty.
  */
-unsigned long ButtonManager::getPressDuration()
+bool ButtonManager::popEdge(Edge &edge)
 {
-  portENTER_CRITICAL(&_mux);
-  unsigned long duration = _pressDuration;
-  portEXIT_CRITICAL(&_mux);
-  return duration;
+  uint32_t tail = _edgeTail.load(std::memory_order_relaxed);
+  if (tail == _edgeHead.load(std::memory_order_acquire))
+  {
+    return false;
+  }
+  edge = _edges[tail % EDGE_QUEUE_SIZE];
+  _edgeTail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Queues a decoded gesture for `nextGesture()` to return.
+ */
+void ButtonManager::emit(ButtonGestureType type, unsigned long heldMs)
+{
+  if (_gestureCount < sizeof(_gestures) / sizeof(_gestures[0]))
+  {
+    _gestures[_gestureCount++] = {type, heldMs};
+  }
 }
 
 /**
- * @brief Checks if a new button press has been registered.
+ * @brief Turns one edge into the gestures it completes.
+ * @param edge The edge.
+ */
+void ButtonManager::decode(const Edge &edge)
+{
+  _lastEdgeAt = edge.atMs;
+  if (edge.pressed)
+  {
+    if (_holding)
+    {
+      return;
+    }
+    _holding = true;
+    _longSent = false;
+    _pressedAt = edge.atMs;
+    _lastHoldAt = edge.atMs;
+    emit(BUTTON_GESTURE_PRESS, 0);
+    return;
+  }
+
+  if (!_holding)
+  {
+    return;
+  }
+  _holding = false;
+  unsigned long held = edge.atMs - _pressedAt;
+  if (!_longSent)
+  {
+    emit(BUTTON_GESTURE_SHORT, held);
+    if (_shortPending && _pressedAt - _lastShortAt <= BUTTON_DOUBLE_PRESS_WINDOW)
+    {
+      emit(BUTTON_GESTURE_DOUBLE, held);
+      _shortPending = false;
+    }
+    else
+    {
+      _shortPending = true;
+      _lastShortAt = edge.atMs;
+    }
+  }
+  else
+  {
+    _shortPending = false;
+  }
+  emit(BUTTON_GESTURE_RELEASE, held);
+}
+
+/**
+ * @brief Sets how long a press must be held to count as LONG.
+ * @param ms The hold time, or 0 to report every press as SHORT however long it is.
+ */
+void ButtonManager::setLongPressTime(unsigned long ms)
+{
+  _longPressMs = ms;
+}
+
+/**
+ * @brief Gets the next gesture, decoding queued edges as needed.
  *
- * This function is thread-safe. It returns true if a new press has occurred
- * since the last time `clearNewPress()` was called.
+ * Queued edges are decoded first, in order. Once the queue is empty and the
+ * button is still held, LONG is reported when the long-press time is up and
+ * HOLD every BUTTON_HOLD_INTERVAL before that. A release whose edge was
+ * lost, to the debounce window or a full queue, is picked up from the pin.
  *
- * @return True if a new press is available, false otherwise.
+ * @param now The current millis(), for HOLD and LONG while the button is held.
+ * @param gesture Receives the gesture.
+ * @return False once there is nothing more to report.
  */
-bool ButtonManager::newPressAvailable()
+bool ButtonManager::nextGesture(unsigned long now, ButtonGesture &gesture)
 {
-  portENTER_CRITICAL(&_mux);
-  bool available = _newPress;
-  portEXIT_CRITICAL(&_mux);
-  return available;
+  if (_gestureNext == _gestureCount)
+  {
+    _gestureNext = _gestureCount = 0;
+    Edge edge;
+    while (_gestureCount == 0 && popEdge(edge))
+    {
+      decode(edge);
+    }
+    if (_gestureCount == 0 && _holding)
+    {
+      unsigned long held = now - _pressedAt;
+      if (now - _lastEdgeAt >= DEBOUNCE_DELAY && digitalRead(_pin) == HIGH)
+      {
+        decode({(uint32_t)now, false});
+      }
+      else if (_longPressMs > 0 && !_longSent && held >= _longPressMs)
+      {
+        _longSent = true;
+        emit(BUTTON_GESTURE_LONG, held);
+      }
+      else if (!_longSent && now - _lastHoldAt >= BUTTON_HOLD_INTERVAL)
+      {
+        _lastHoldAt = now;
+        emit(BUTTON_GESTURE_HOLD, held);
+      }
+    }
+    if (_gestureCount == 0)
+    {
+      return false;
+    }
+  }
+  gesture = _gestures[_gestureNext++];
+  return true;
 }
 
 /**
- * @brief Clears the new press flag.
- *
- * This should be called after processing a new button press to reset the state.
- * This function is thread-safe.
+ * @brief Sets the task to notify when the button goes down or up.
+ * @param task The task handle, or NULL to disable notifications.
  */
-void ButtonManager::clearNewPress()
+void ButtonManager::setNotifyTask(TaskHandle_t task)
 {
   portENTER_CRITICAL(&_mux);
-  _newPress = false;
+  _notifyTask = task;
   portEXIT_CRITICAL(&_mux);
 }
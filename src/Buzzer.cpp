@@ -0,0 +1,110 @@
+/**
+ * @file Buzzer.cpp
+ * @brief Implements the timer-driven buzzer pattern player.
+ */
+#include "Buzzer.h"
+#include "Constants.h"
+#include <driver/gpio.h>
+
+/**
+ * @brief Sets up the buzzer pin, off, and creates the timer.
+ */
+void Buzzer::begin()
+{
+  pinMode(BUZZER_PIN, OUTPUT);
+  digitalWrite(BUZZER_PIN, LOW);
+
+  if (_timer == nullptr)
+  {
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = this;
+    args.name = "buzzer";
+    esp_timer_create(&args, &_timer);
+  }
+}
+
+/**
+ * @brief Starts repeating a pattern from its first on step.
+ * @param pattern The pattern; an invalid one turns the buzzer off.
+ */
+void Buzzer::play(const BuzzerPattern &pattern)
+{
+  portENTER_CRITICAL(&_mux);
+  esp_timer_stop(_timer);
+  if (pattern.isValid())
+  {
+    _pattern = pattern;
+    _step = 0;
+    _stepEndMicros = esp_timer_get_time();
+    startStep();
+  }
+  else
+  {
+    _pattern.count = 0;
+    gpio_set_level((gpio_num_t)BUZZER_PIN, 0);
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief Turns the buzzer on until `stop()` or `play()`.
+ */
+void Buzzer::on()
+{
+  portENTER_CRITICAL(&_mux);
+  esp_timer_stop(_timer);
+  _pattern.count = 0;
+  gpio_set_level((gpio_num_t)BUZZER_PIN, 1);
+  portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief Turns the buzzer off and stops any pattern.
+ */
+void Buzzer::stop()
+{
+  portENTER_CRITICAL(&_mux);
+  esp_timer_stop(_timer);
+  _pattern.count = 0;
+  gpio_set_level((gpio_num_t)BUZZER_PIN, 0);
+  portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief Switches the pin for the current step and arms the timer for its end.
+ *
+ * Steps are timed from where the previous one should have ended, not from
+ * when its callback ran. If the timer fell a whole step behind, the pattern
+ * is re-based on the current time instead of trying to catch up.
+ */
+void Buzzer::startStep()
+{
+  gpio_set_level((gpio_num_t)BUZZER_PIN, _step % 2 == 0 ? 1 : 0);
+
+  int64_t stepUs = (int64_t)_pattern.stepsMs[_step] * 1000;
+  int64_t now = esp_timer_get_time();
+  _stepEndMicros += stepUs;
+  if (_stepEndMicros <= now)
+  {
+    _stepEndMicros = now + stepUs;
+  }
+  esp_timer_start_once(_timer, _stepEndMicros - now);
+}
+
+/**
+ * @brief The timer callback; moves on to the next step.
+ * @param arg The Buzzer instance.
+ */
+void Buzzer::onTimer(void *arg)
+{
+  Buzzer *buzzer = static_cast<Buzzer *>(arg);
+  portENTER_CRITICAL(&buzzer->_mux);
+  // A play() or stop() between this firing and now has already taken over.
+  if (buzzer->_pattern.count != 0 && !esp_timer_is_active(buzzer->_timer))
+  {
+    buzzer->_step = (buzzer->_step + 1) % buzzer->_pattern.count;
+    buzzer->startStep();
+  }
+  portEXIT_CRITICAL(&buzzer->_mux);
+}
@@ -17,14 +17,13 @@
 #include "TimeManager.h"
 #include "SensorModule.h"
 #include "AlarmManager.h"
-#include "fonts/DSEG7ModernBold104.h"
-#include "fonts/DSEG14ModernBold32.h"
-#include "fonts/DSEG14ModernBold48.h"
-#include "fonts/DSEG7ModernBold48.h"
-#include "fonts/CenturyGothicBold48.h"
+#include "FontManager.h"
 
 #include <Arduino.h>
 
+// Characters that can appear in the time and seconds strings.
+static const char *CLOCK_GLYPHS = "0123456789: ";
+
 /**
  * @brief Constructs a new ClockPage.
  *
@@ -34,8 +33,9 @@
  * @param tft A pointer to the TFT_eSPI driver instance.
  */
 ClockPage::ClockPage(TFT_eSPI *tft)
-    : _sprClock(tft), _sprDayOfWeek(tft), _sprDate(tft), _sprTemp(tft), _sprHumidity(tft), _sprTOD(tft), _sprSeconds(tft),
-      _sprNextAlarm1(tft), _sprNextAlarm2(tft), _tft(tft)
+    : _sprClock(tft, 16), _sprDayOfWeek(tft), _sprDate(tft), _sprTemp(tft), _sprHumidity(tft), _sprTOD(tft), _sprSeconds(tft, 16),
+      _sprNextAlarm1(tft), _sprNextAlarm2(tft),
+      _clockAtlas(tft, FONT_DSEG7_MODERN_BOLD_104, CLOCK_GLYPHS), _secondsAtlas(tft, FONT_DSEG7_MODERN_BOLD_48, CLOCK_GLYPHS), _tft(tft)
 {
   // Sprites are initialized in the member initializer list
 }
@@ -62,7 +62,7 @@ ClockPage::~ClockPage()
  */
 void ClockPage::onEnter(TFT_eSPI &tft)
 {
-  updateSpriteColors();
+  applyTheme();
   tft.fillScreen(_bgColor);
 
   if (!_spritesCreated)
@@ -74,6 +74,7 @@ void ClockPage::onEnter(TFT_eSPI &tft)
 
   // Force a redraw of all elements
   _lastData = {};
+  invalidateGlyphCells();
 }
 
 /**
@@ -135,6 +136,34 @@ void ClockPage::render(TFT_eSPI &tft)
   }
 }
 
+/**
+ * @brief Draws the digits the next second will show, so its frame only has to push them.
+ *
+ * The seconds change every second; the time only when the next second starts
+ * a new minute. The AM/PM indicator is cheap and is left to the next frame.
+ *
+ * @param next The time the next second will show.
+ */
+void ClockPage::prerenderSecond(const DateTime &next)
+{
+  if (!_spritesCreated)
+  {
+    return;
+  }
+
+  char secondsStr[4];
+  snprintf(secondsStr, sizeof(secondsStr), "%02d", next.second());
+  prerenderGlyphCells(_sprSeconds, _secondsAtlas, secondsStr, _shownSeconds, sizeof(_shownSeconds), _sprSeconds.width(), 0, _pendingSeconds);
+
+  if (next.second() == 0)
+  {
+    char timeStr[8];
+    TimeManager::getInstance().formatTime(next, timeStr, sizeof(timeStr));
+    int32_t clockTop = _sprClock.height() / 2 - _clockAtlas.tileHeight() / 2;
+    prerenderGlyphCells(_sprClock, _clockAtlas, timeStr, _shownTime, sizeof(_shownTime), _sprClock.width(), clockTop, _pendingTime);
+  }
+}
+
 /**
  * @brief Calculates the positions of all sprites on the screen.
  *
@@ -152,9 +181,7 @@ void ClockPage::setupLayout(TFT_eSPI &tft)
   int screenHeight = tft.height();
 
   // --- Bottom Rows Layout (Date and Sensors) ---
-  tft.loadFont(DSEG14ModernBold32);
-  int fontHeight = tft.fontHeight();
-  tft.unloadFont(); // Unload to prevent bleeding into other pages
+  int fontHeight = FontManager::getInstance().fontHeight(FONT_DSEG14_MODERN_BOLD_32);
   _alarmRowY = screenHeight - (fontHeight * 3 + MARGIN + 80);
   _dateY = screenHeight - (fontHeight * 2 + MARGIN + 55);
   _sensorY = screenHeight - (fontHeight + MARGIN + 20);
@@ -214,87 +241,100 @@ void ClockPage::setupSprites(TFT_eSPI &tft)
 {
   setupClockSprites(tft);
   setupSensorSprites(tft);
-  updateSpriteColors();
+  applyTheme(true);
 }
 
 void ClockPage::setupClockSprites(TFT_eSPI &tft)
 {
   _sprClock.createSprite(CLOCK_SPRITE_WIDTH, CLOCK_SPRITE_HEIGHT);
-  _sprClock.loadFont(DSEG7ModernBold104);
+  FontManager::getInstance().use(_sprClock, FONT_DSEG7_MODERN_BOLD_104);
   _sprClock.setTextDatum(MR_DATUM);
 
   _sprTOD.createSprite(TOD_SPRITE_WIDTH, TOD_SPRITE_HEIGHT);
-  _sprTOD.loadFont(DSEG14ModernBold32);
+  FontManager::getInstance().use(_sprTOD, FONT_DSEG14_MODERN_BOLD_32);
   _sprTOD.setTextDatum(TR_DATUM);
 
   _sprSeconds.createSprite(SECONDS_SPRITE_WIDTH, SECONDS_SPRITE_HEIGHT);
-  _sprSeconds.loadFont(DSEG7ModernBold48);
+  FontManager::getInstance().use(_sprSeconds, FONT_DSEG7_MODERN_BOLD_48);
   _sprSeconds.setTextDatum(TR_DATUM);
 
   _sprDayOfWeek.createSprite(tft.width() / 2 - MARGIN, DAY_OF_WEEK_SPRITE_HEIGHT);
-  _sprDayOfWeek.loadFont(DSEG14ModernBold48);
+  FontManager::getInstance().use(_sprDayOfWeek, FONT_DSEG14_MODERN_BOLD_48);
   _sprDayOfWeek.setTextDatum(ML_DATUM);
 
   _sprDate.createSprite(tft.width() / 2 - MARGIN, DATE_SPRITE_HEIGHT);
-  _sprDate.loadFont(DSEG14ModernBold48);
+  FontManager::getInstance().use(_sprDate, FONT_DSEG14_MODERN_BOLD_48);
   _sprDate.setTextDatum(MR_DATUM);
 }
 
 void ClockPage::setupSensorSprites(TFT_eSPI &tft)
 {
   _sprNextAlarm1.createSprite(tft.width() / 2 - MARGIN, DAY_OF_WEEK_SPRITE_HEIGHT); // Reusing height
-  _sprNextAlarm1.loadFont(DSEG14ModernBold32);
+  FontManager::getInstance().use(_sprNextAlarm1, FONT_DSEG14_MODERN_BOLD_32);
   _sprNextAlarm1.setTextDatum(ML_DATUM);
 
   _sprNextAlarm2.createSprite(tft.width() / 2 - MARGIN, DAY_OF_WEEK_SPRITE_HEIGHT); // Reusing height
-  _sprNextAlarm2.loadFont(DSEG14ModernBold32);
+  FontManager::getInstance().use(_sprNextAlarm2, FONT_DSEG14_MODERN_BOLD_32);
   _sprNextAlarm2.setTextDatum(MR_DATUM);
 
   _sprTemp.createSprite(tft.width() / 2 - MARGIN, TEMP_SPRITE_HEIGHT);
-  _sprTemp.loadFont(DSEG14ModernBold48);
+  FontManager::getInstance().use(_sprTemp, FONT_DSEG14_MODERN_BOLD_48);
   _sprTemp.setTextDatum(ML_DATUM);
 
   _sprHumidity.createSprite(tft.width() / 2 - MARGIN, HUMIDITY_SPRITE_HEIGHT);
-  _sprHumidity.loadFont(DSEG14ModernBold48);
+  FontManager::getInstance().use(_sprHumidity, FONT_DSEG14_MODERN_BOLD_48);
   _sprHumidity.setTextDatum(MR_DATUM);
 }
 
 /**
- * @brief Updates the colors of all sprites from the configuration.
+ * @brief Rebuilds the sprite colors when the configured theme has changed.
  *
- * This method reads the latest color settings from the ConfigManager, converts
- * them from hex strings to RGB565 format, and applies them to the text
- * color of each sprite.
+ * The theme generation is compared with the one the colors were last built
+ * from, so an unchanged theme costs a single lookup.
  */
-void ClockPage::updateSpriteColors()
+void ClockPage::applyTheme(bool force)
 {
-  auto &config = ConfigManager::getInstance();
-  _bgColor = hexToRGB565(config.getBackgroundColor());
-  uint16_t timeColor = hexToRGB565(config.getTimeColor());
-  uint16_t todColor = hexToRGB565(config.getTodColor());
-  uint16_t secondsColor = hexToRGB565(config.getSecondsColor());
-  uint16_t dayOfWeekColor = hexToRGB565(config.getDayOfWeekColor());
-  uint16_t dateColor = hexToRGB565(config.getDateColor());
-  uint16_t tempColor = hexToRGB565(config.getTempColor());
-  uint16_t humidityColor = hexToRGB565(config.getHumidityColor());
-  uint16_t alarmColor = hexToRGB565(config.getAlarmTextColor());
-
-  _sprClock.setTextColor(timeColor, _bgColor);
-  _sprTOD.setTextColor(todColor, _bgColor);
-  _sprSeconds.setTextColor(secondsColor, _bgColor);
-  _sprDayOfWeek.setTextColor(dayOfWeekColor, _bgColor);
-  _sprDate.setTextColor(dateColor, _bgColor);
-  _sprTemp.setTextColor(tempColor, _bgColor);
-  _sprHumidity.setTextColor(humidityColor, _bgColor);
-  _sprNextAlarm1.setTextColor(alarmColor, _bgColor);
-  _sprNextAlarm2.setTextColor(alarmColor, _bgColor);
+  ConfigSnapshotRef config = ConfigManager::getInstance().snapshot();
+  if (!force && config->themeGeneration == _themeGeneration)
+  {
+    return;
+  }
+  _themeGeneration = config->themeGeneration;
+  updateSpriteColors(config->theme);
+}
+
+/**
+ * @brief Updates the colors of all sprites from the theme.
+ *
+ * This method applies the theme's RGB565 colors to the palette or text color
+ * of each sprite. The glyph atlases are invalidated if their colors changed.
+ *
+ * @param theme The display colors to apply.
+ */
+void ClockPage::updateSpriteColors(const Theme &theme)
+{
+  _bgColor = theme.background;
+
+  _sprClock.setTextColor(theme.time, _bgColor);
+  _sprTOD.setRamp(theme.tod, _bgColor);
+  _sprSeconds.setTextColor(theme.seconds, _bgColor);
+  _sprDayOfWeek.setRamp(theme.dayOfWeek, _bgColor);
+  _sprDate.setRamp(theme.date, _bgColor);
+  _sprTemp.setRamp(theme.temp, _bgColor);
+  _sprHumidity.setRamp(theme.humidity, _bgColor);
+  _sprNextAlarm1.setRamp(theme.alarmText, _bgColor);
+  _sprNextAlarm2.setRamp(theme.alarmText, _bgColor);
+
+  _clockAtlas.setColors(theme.time, _bgColor);
+  _secondsAtlas.setColors(theme.seconds, _bgColor);
 }
 
 /**
  * @brief Draws the main clock time (HH:MM) and AM/PM indicator.
  *
  * This function renders the current time into the clock sprite and pushes it
- * to the screen. If not in 24-hour format, it also renders the AM/PM
+ * to the screen. Only the digit cells that changed since the last draw are
+ * repainted and pushed. If not in 24-hour format, it also renders the AM/PM
  * indicator into its own sprite.
  *
  * @param tft A reference to the TFT_eSPI driver instance (not directly used,
@@ -309,21 +349,33 @@ void ClockPage::drawClock(TFT_eSPI &tft)
   timeManager.getFormattedTime(timeStr, sizeof(timeStr));
   timeManager.getTOD(todStr, sizeof(todStr));
 
-  _sprClock.fillSprite(_bgColor);
-  _sprClock.drawString(timeStr, _sprClock.width(), _sprClock.height() / 2);
+  int32_t dirtyX, dirtyW;
+  int32_t clockTop = _sprClock.height() / 2 - _clockAtlas.tileHeight() / 2;
+  if (drawGlyphCells(_sprClock, _clockAtlas, timeStr, _shownTime, sizeof(_shownTime), _sprClock.width(), clockTop, _pendingTime, dirtyX, dirtyW))
+  {
+#ifdef DEBUG_BORDERS
+    _sprClock.drawRect(0, 0, _sprClock.width(), _sprClock.height(), TFT_RED);
+#endif
+    pushSprite(_sprClock, _clockX, _clockY, dirtyX, clockTop, dirtyW, _clockAtlas.tileHeight());
+  }
+  else
+  {
+    _sprClock.fillSprite(_bgColor);
+    _sprClock.drawString(timeStr, _sprClock.width(), _sprClock.height() / 2);
 #ifdef DEBUG_BORDERS
-  _sprClock.drawRect(0, 0, _sprClock.width(), _sprClock.height(), TFT_RED);
+    _sprClock.drawRect(0, 0, _sprClock.width(), _sprClock.height(), TFT_RED);
 #endif
-  _sprClock.pushSprite(_clockX, _clockY);
+    pushSprite(_sprClock, _clockX, _clockY);
+  }
 
   if (!is24Hour)
   {
-    _sprTOD.fillSprite(_bgColor);
+    _sprTOD.fillSprite(ArenaSprite::PAPER);
     _sprTOD.drawString(todStr, _sprTOD.width(), 0);
 #ifdef DEBUG_BORDERS
-    _sprTOD.drawRect(0, 0, _sprTOD.width(), _sprTOD.height(), TFT_GREEN);
+    _sprTOD.drawRect(0, 0, _sprTOD.width(), _sprTOD.height(), ArenaSprite::INK);
 #endif
-    _sprTOD.pushSprite(_todX, _todY);
+    pushSprite(_sprTOD, _todX, _todY);
   }
 }
 
@@ -335,12 +387,23 @@ void ClockPage::drawSeconds(TFT_eSPI &tft)
 {
   char secondsStr[4];
   TimeManager::getInstance().getFormattedSeconds(secondsStr, sizeof(secondsStr));
-  _sprSeconds.fillSprite(_bgColor);
-  _sprSeconds.drawString(secondsStr, _sprSeconds.width(), 0);
+  int32_t dirtyX, dirtyW;
+  if (drawGlyphCells(_sprSeconds, _secondsAtlas, secondsStr, _shownSeconds, sizeof(_shownSeconds), _sprSeconds.width(), 0, _pendingSeconds, dirtyX, dirtyW))
+  {
+#ifdef DEBUG_BORDERS
+    _sprSeconds.drawRect(0, 0, _sprSeconds.width(), _sprSeconds.height(), TFT_MAGENTA);
+#endif
+    pushSprite(_sprSeconds, _secondsX, _secondsY, dirtyX, 0, dirtyW, _secondsAtlas.tileHeight());
+  }
+  else
+  {
+    _sprSeconds.fillSprite(_bgColor);
+    _sprSeconds.drawString(secondsStr, _sprSeconds.width(), 0);
 #ifdef DEBUG_BORDERS
-  _sprSeconds.drawRect(0, 0, _sprSeconds.width(), _sprSeconds.height(), TFT_MAGENTA);
+    _sprSeconds.drawRect(0, 0, _sprSeconds.width(), _sprSeconds.height(), TFT_MAGENTA);
 #endif
-  _sprSeconds.pushSprite(_secondsX, _secondsY);
+    pushSprite(_sprSeconds, _secondsX, _secondsY);
+  }
 }
 
 /**
@@ -351,12 +414,12 @@ void ClockPage::drawDayOfWeek(TFT_eSPI &tft)
 {
   char dayStr[4];
   TimeManager::getInstance().getDayOfWeek(dayStr, sizeof(dayStr));
-  _sprDayOfWeek.fillSprite(_bgColor);
+  _sprDayOfWeek.fillSprite(ArenaSprite::PAPER);
   _sprDayOfWeek.drawString(dayStr, 0, _sprDayOfWeek.height() / 2);
 #ifdef DEBUG_BORDERS
-  _sprDayOfWeek.drawRect(0, 0, _sprDayOfWeek.width(), _sprDayOfWeek.height(), TFT_BLUE);
+  _sprDayOfWeek.drawRect(0, 0, _sprDayOfWeek.width(), _sprDayOfWeek.height(), ArenaSprite::INK);
 #endif
-  _sprDayOfWeek.pushSprite(MARGIN, _dateY);
+  pushSprite(_sprDayOfWeek, MARGIN, _dateY);
 }
 
 /**
@@ -367,29 +430,29 @@ void ClockPage::drawDate(TFT_eSPI &tft)
 {
   char dateStr[12];
   TimeManager::getInstance().getFormattedDate(dateStr, sizeof(dateStr));
-  _sprDate.fillSprite(_bgColor);
+  _sprDate.fillSprite(ArenaSprite::PAPER);
   _sprDate.drawString(dateStr, _sprDate.width(), _sprDate.height() / 2);
 #ifdef DEBUG_BORDERS
-  _sprDate.drawRect(0, 0, _sprDate.width(), _sprDate.height(), TFT_YELLOW);
+  _sprDate.drawRect(0, 0, _sprDate.width(), _sprDate.height(), ArenaSprite::INK);
 #endif
-  _sprDate.pushSprite(tft.width() / 2, _dateY);
+  pushSprite(_sprDate, tft.width() / 2, _dateY);
 }
 
 void ClockPage::drawNextAlarms(TFT_eSPI &tft, const char *alarm1, const char *alarm2)
 {
-  _sprNextAlarm1.fillSprite(_bgColor);
+  _sprNextAlarm1.fillSprite(ArenaSprite::PAPER);
   if (alarm1[0] != '\0')
   {
     _sprNextAlarm1.drawString(alarm1, 0, _sprNextAlarm1.height() / 2);
   }
-  _sprNextAlarm1.pushSprite(MARGIN, _alarmRowY);
+  pushSprite(_sprNextAlarm1, MARGIN, _alarmRowY);
 
-  _sprNextAlarm2.fillSprite(_bgColor);
+  _sprNextAlarm2.fillSprite(ArenaSprite::PAPER);
   if (alarm2[0] != '\0')
   {
     _sprNextAlarm2.drawString(alarm2, _sprNextAlarm2.width(), _sprNextAlarm2.height() / 2);
   }
-  _sprNextAlarm2.pushSprite(tft.width() / 2, _alarmRowY);
+  pushSprite(_sprNextAlarm2, tft.width() / 2, _alarmRowY);
 }
 
 /**
@@ -404,8 +467,8 @@ void ClockPage::drawTemperature(TFT_eSPI &tft)
 {
   float temp = getTemperature();
 
-  _sprTemp.fillSprite(_bgColor);
-  _sprTemp.loadFont(DSEG14ModernBold48);
+  _sprTemp.fillSprite(ArenaSprite::PAPER);
+  FontManager::getInstance().use(_sprTemp, FONT_DSEG14_MODERN_BOLD_48);
 
   char tempBuf[16];
   snprintf(tempBuf, sizeof(tempBuf), "%.0f", temp);
@@ -418,9 +481,9 @@ void ClockPage::drawTemperature(TFT_eSPI &tft)
   int circleY = (_sprTemp.height() / 2) - (fontHeight / 2) + circleRadius;
   _sprTemp.fillCircle(circleX, circleY, circleRadius, _sprTemp.textcolor);
 
-  _sprTemp.loadFont(DSEG14ModernBold32);
+  FontManager::getInstance().use(_sprTemp, FONT_DSEG14_MODERN_BOLD_32);
   _sprTemp.setTextDatum(TL_DATUM);
-  char unit = ConfigManager::getInstance().isCelsius() ? 'C' : 'F';
+  char unit = ConfigManager::getInstance().snapshot()->useCelsius ? 'C' : 'F';
   char unitBuf[2] = {unit, '\0'};
   int unitX = circleX + circleRadius + 2;
   int unitY = (_sprTemp.height() / 2) - (fontHeight / 2);
@@ -428,9 +491,9 @@ void ClockPage::drawTemperature(TFT_eSPI &tft)
   _sprTemp.setTextDatum(ML_DATUM);
 
 #ifdef DEBUG_BORDERS
-  _sprTemp.drawRect(0, 0, _sprTemp.width(), _sprTemp.height(), TFT_ORANGE);
+  _sprTemp.drawRect(0, 0, _sprTemp.width(), _sprTemp.height(), ArenaSprite::INK);
 #endif
-  _sprTemp.pushSprite(MARGIN, _sensorY);
+  pushSprite(_sprTemp, MARGIN, _sensorY);
 }
 
 /**
@@ -453,13 +516,13 @@ void ClockPage::drawHumidity(TFT_eSPI &tft)
     snprintf(buf, sizeof(buf), "%.0f%%", humidity);
   }
 
-  _sprHumidity.fillSprite(_bgColor);
+  _sprHumidity.fillSprite(ArenaSprite::PAPER);
   _sprHumidity.drawString(buf, _sprHumidity.width(), _sprHumidity.height() / 2);
 
 #ifdef DEBUG_BORDERS
-  _sprHumidity.drawRect(0, 0, _sprHumidity.width(), _sprHumidity.height(), TFT_CYAN);
+  _sprHumidity.drawRect(0, 0, _sprHumidity.width(), _sprHumidity.height(), ArenaSprite::INK);
 #endif
-  _sprHumidity.pushSprite(tft.width() / 2, _sensorY);
+  pushSprite(_sprHumidity, tft.width() / 2, _sensorY);
 }
 
 /**
@@ -534,19 +597,18 @@ void ClockPage::updateDisplayData(DisplayData &data)
  */
 void ClockPage::refresh(TFT_eSPI &tft, bool fullRefresh)
 {
-  auto &config = ConfigManager::getInstance();
-  updateSpriteColors();
+  applyTheme();
 
   if (fullRefresh)
   {
     tft.fillScreen(_bgColor);
   }
 
-  if (config.is24HourFormat())
+  if (ConfigManager::getInstance().snapshot()->use24HourFormat)
   {
     // In 24-hour mode, ensure the TOD sprite is cleared immediately on refresh.
-    _sprTOD.fillSprite(_bgColor);
-    _sprTOD.pushSprite(_todX, _todY);
+    _sprTOD.fillSprite(ArenaSprite::PAPER);
+    pushSprite(_sprTOD, _todX, _todY);
   }
 
   // Force a redraw of all common clock elements
@@ -598,9 +660,135 @@ void ClockPage::renderClockElements(TFT_eSPI &tft, const ClockDisplayBase &curre
 
 void ClockPage::resetClockFields(ClockDisplayBase &base)
 {
+  invalidateGlyphCells();
+
   strncpy(base.time, " ", sizeof(base.time));
   strncpy(base.date, " ", sizeof(base.date));
   strncpy(base.dayOfWeek, " ", sizeof(base.dayOfWeek));
   strncpy(base.tod, " ", sizeof(base.tod));
   strncpy(base.seconds, " ", sizeof(base.seconds));
 }
+
+void ClockPage::invalidateGlyphCells()
+{
+  _shownTime[0] = '\0';
+  _shownSeconds[0] = '\0';
+  _pendingTime.ready = false;
+  _pendingSeconds.ready = false;
+}
+
+/**
+ * @brief Adds one span to another. An empty span leaves the other unchanged.
+ */
+static void mergeSpan(int32_t &x, int32_t &w, int32_t otherX, int32_t otherW)
+{
+  if (otherW <= 0)
+  {
+    return;
+  }
+  if (w <= 0)
+  {
+    x = otherX;
+    w = otherW;
+    return;
+  }
+  int32_t right = max(x + w, otherX + otherW);
+  x = min(x, otherX);
+  w = right - x;
+}
+
+bool ClockPage::drawGlyphCells(TFT_eSprite &sprite, GlyphAtlas &atlas, const char *text, char *shown, size_t shownSize,
+                               int32_t right, int32_t top, PendingCells &pending, int32_t &dirtyX, int32_t &dirtyW)
+{
+  bool drawn = drawGlyphCells(sprite, atlas, text, shown, shownSize, right, top, dirtyX, dirtyW);
+  if (drawn && pending.ready)
+  {
+    mergeSpan(dirtyX, dirtyW, pending.dirtyX, pending.dirtyW);
+  }
+  pending.ready = false;
+  return drawn;
+}
+
+void ClockPage::prerenderGlyphCells(TFT_eSprite &sprite, GlyphAtlas &atlas, const char *text, char *shown, size_t shownSize,
+                                    int32_t right, int32_t top, PendingCells &pending)
+{
+  if (shown[0] == '\0')
+  {
+    return; // Needs a full redraw, which the next frame does anyway.
+  }
+  int32_t dirtyX, dirtyW;
+  if (!drawGlyphCells(sprite, atlas, text, shown, shownSize, right, top, dirtyX, dirtyW))
+  {
+    pending.ready = false; // The sprite is now unknown; the next frame repaints it.
+    return;
+  }
+  if (!pending.ready)
+  {
+    pending.dirtyX = dirtyX;
+    pending.dirtyW = 0;
+    pending.ready = true;
+  }
+  mergeSpan(pending.dirtyX, pending.dirtyW, dirtyX, dirtyW);
+}
+
+bool ClockPage::drawGlyphCells(TFT_eSprite &sprite, GlyphAtlas &atlas, const char *text, char *shown, size_t shownSize,
+                               int32_t right, int32_t top, int32_t &dirtyX, int32_t &dirtyW)
+{
+  int32_t tileHeight = atlas.tileHeight();
+  if (tileHeight <= 0 || atlas.textWidth(text) < 0)
+  {
+    shown[0] = '\0';
+    return false;
+  }
+
+  if (shown[0] == '\0')
+  {
+    // The sprite's contents are unknown; redraw every cell.
+    sprite.fillSprite(_bgColor);
+    atlas.drawString(sprite, text, right, top, TR_DATUM);
+    dirtyX = 0;
+    dirtyW = sprite.width();
+  }
+  else
+  {
+    // Walk both strings from the right edge, one glyph cell at a time. A cell
+    // is dirty if its glyph or its position changed.
+    int32_t newLen = strlen(text);
+    int32_t oldLen = strlen(shown);
+    int32_t newRight = right;
+    int32_t oldRight = right;
+    int32_t x0 = right;
+    int32_t x1 = right;
+
+    for (int32_t k = 0; k < max(newLen, oldLen); k++)
+    {
+      char newGlyph = (k < newLen) ? text[newLen - 1 - k] : '\0';
+      char oldGlyph = (k < oldLen) ? shown[oldLen - 1 - k] : '\0';
+      int32_t newLeft = newRight - (newGlyph ? atlas.glyphWidth(newGlyph) : 0);
+      int32_t oldLeft = oldRight - (oldGlyph ? atlas.glyphWidth(oldGlyph) : 0);
+
+      if (newGlyph != oldGlyph || newLeft != oldLeft)
+      {
+        // Anything right of newRight was already repainted by the cells before.
+        int32_t left = min(newLeft, oldLeft);
+        sprite.fillRect(left, top, newRight - left, tileHeight, _bgColor);
+        if (newGlyph)
+        {
+          atlas.drawGlyph(sprite, newGlyph, newLeft, top);
+        }
+        x0 = min(x0, left);
+        x1 = max(x1, newRight);
+      }
+
+      newRight = newLeft;
+      oldRight = oldLeft;
+    }
+
+    dirtyX = x0;
+    dirtyW = x1 - x0;
+  }
+
+  strncpy(shown, text, shownSize - 1);
+  shown[shownSize - 1] = '\0';
+  return true;
+}
@@ -16,10 +16,25 @@
 #include <ArduinoJson.h>
 #include <AsyncTCP.h>
 #include <WiFi.h>
+#include <memory>
 #include "SensorModule.h"
+#include "I2cBus.h"
 #include "Display.h"
+#include "FontManager.h"
+#include "RenderProfiler.h"
+#include "Telemetry.h"
+#include "LoopProfiler.h"
+#include "PowerManager.h"
+#include "SensorHistory.h"
+#include "JsonResponse.h"
+#include "RequestBodyPool.h"
+#include "HttpAdmission.h"
+#include "Benchmark.h"
 #include "UpdateManager.h"
+#include "HttpsClient.h"
 #include "SerialLog.h"
+#include "LogStore.h"
+#include "CrashJournal.h"
 #include "NtpSync.h"
 #include "AlarmManager.h"
 #include "Constants.h"
@@ -34,6 +49,794 @@
 #include "version.h.default"
 #endif
 
+#if __has_include("WebAssets.h")
+// Generated at build time by scripts/build_web_assets.py.
+#include "WebAssets.h"
+#endif
+
+/**
+ * @brief Adds a `{p50, p95, max}` object to a JSON object.
+ * @param parent The object to add to.
+ * @param key The key of the new object.
+ * @param values The percentiles to write.
+ */
+static void addPercentiles(JsonObject parent, const char *key, const RenderProfiler::Percentiles &values)
+{
+  JsonObject group = parent[key].to<JsonObject>();
+  group["p50"] = values.p50;
+  group["p95"] = values.p95;
+  group["max"] = values.max;
+}
+
+/**
+ * @brief Appends one benchmark measurement to a JSON array.
+ * @param results The array to append to.
+ * @param name The name of the measured operation.
+ * @param result The measurement.
+ */
+static void addBenchmarkResult(JsonArray results, const char *name, const Benchmark::Result &result)
+{
+  JsonObject entry = results.add<JsonObject>();
+  entry["name"] = name;
+  entry["iterations"] = result.iterations;
+  entry["totalUs"] = result.totalUs;
+  entry["opsPerSec"] = result.opsPerSec;
+  entry["allocsPerOp"] = result.allocsPerOp;
+}
+
+/**
+ * @brief Fills a document with the result of the last geocoding request.
+ * @param doc The document to fill.
+ */
+static void buildGeocodingJson(JsonDocument &doc)
+{
+  auto result = WeatherService::getInstance().getGeocodingResult();
+
+  doc["pending"] = result.pending;
+  doc["success"] = result.success;
+
+  if (!result.pending && result.success)
+  {
+    doc["resolvedAddress"] = result.resolvedAddress;
+    doc["lat"] = result.lat;
+    doc["lon"] = result.lon;
+  }
+}
+
+/**
+ * @brief Formats a time of day as "05:12", or "5:12 AM" in 12-hour format.
+ * @param minutes Minutes since midnight; a negative value gives an empty string.
+ * @param is24Hour True for the 24-hour format.
+ * @param buf The output buffer.
+ * @param bufSize The size of the buffer.
+ */
+static void formatMinutesOfDay(int minutes, bool is24Hour, char *buf, size_t bufSize)
+{
+  if (minutes < 0)
+  {
+    buf[0] = '\0';
+    return;
+  }
+  int hour = minutes / 60;
+  int minute = minutes % 60;
+  if (is24Hour)
+  {
+    snprintf(buf, bufSize, "%02d:%02d", hour, minute);
+    return;
+  }
+  int hour12 = hour % 12;
+  if (hour12 == 0)
+    hour12 = 12;
+  snprintf(buf, bufSize, "%d:%02d %s", hour12, minute, hour < 12 ? "AM" : "PM");
+}
+
+/**
+ * @brief Fills a document with the current weather, in the user's units and time format.
+ * @param doc The document to fill.
+ */
+static void buildWeatherJson(JsonDocument &doc)
+{
+  WeatherData data = WeatherService::getInstance().getCurrentWeather();
+
+  bool isMetric = ConfigManager::getInstance().isCelsius();
+  float temp = data.temp; // WeatherService stores temp in Fahrenheit
+  float feelsLike = data.feelsLike;
+  float windSpeed = data.windSpeed;
+
+  if (isMetric)
+  {
+    temp = (temp - 32.0f) * 5.0f / 9.0f;
+    feelsLike = (feelsLike - 32.0f) * 5.0f / 9.0f;
+    windSpeed = windSpeed * 1.60934f; // mph to km/h
+  }
+
+  doc["temp"] = temp;
+  doc["feelsLike"] = feelsLike;
+  doc["humidity"] = data.humidity;
+  doc["windSpeed"] = windSpeed;
+  doc["rainChance"] = data.rainChance;
+  doc["condition"] = WeatherService::getConditionFromWMO(data.weatherCode);
+
+  doc["uvIndex"] = data.uvIndex;
+  doc["cloudCover"] = data.cloudCover;
+  doc["pressure"] = data.pressure;     // hPa
+  doc["visibility"] = data.visibility; // meters
+  doc["windDirection"] = WeatherService::getWindDirectionStr(data.windDirection);
+  doc["windGusts"] = isMetric ? (data.windGusts * 1.60934f) : data.windGusts; // Convert gusts if metric
+
+  bool is24Hour = ConfigManager::getInstance().is24HourFormat();
+  char sunrise[12];
+  char sunset[12];
+  formatMinutesOfDay(data.sunriseMinutes, is24Hour, sunrise, sizeof(sunrise));
+  formatMinutesOfDay(data.sunsetMinutes, is24Hour, sunset, sizeof(sunset));
+
+  doc["sunrise"] = sunrise;
+  doc["sunset"] = sunset;
+
+  doc["isValid"] = data.isValid;
+  doc["stale"] = data.isStale;
+  doc["fetchedAt"] = data.fetchedAt;
+  doc["unit"] = isMetric ? "C" : "F";
+  doc["windUnit"] = isMetric ? "km/h" : "mph";
+}
+
+/**
+ * @brief Fills a document with the configured alarms.
+ * @param doc The document to fill.
+ */
+static void buildAlarmsJson(JsonDocument &doc)
+{
+  JsonArray alarmsArray = doc.to<JsonArray>();
+
+  std::vector<Alarm> alarms = ConfigManager::getInstance().getAllAlarms();
+  for (const auto &alarm : alarms)
+  {
+    JsonObject alarmObj = alarmsArray.add<JsonObject>();
+    alarmObj["id"] = alarm.getId();
+    alarmObj["enabled"] = alarm.isEnabled();
+    alarmObj["hour"] = alarm.getHour();
+    alarmObj["minute"] = alarm.getMinute();
+    alarmObj["days"] = alarm.getDays();
+    const BuzzerPattern &pattern = alarm.getBuzzerPattern();
+    JsonArray steps = alarmObj["pattern"].to<JsonArray>();
+    for (uint8_t i = 0; i < pattern.count; i++)
+    {
+      steps.add(pattern.stepsMs[i]);
+    }
+  }
+}
+
+/**
+ * @brief Fills a document with the general settings.
+ * @param doc The document to fill.
+ */
+static void buildSettingsJson(JsonDocument &doc)
+{
+  auto &config = ConfigManager::getInstance();
+  doc["autoBrightness"] = config.isAutoBrightness();
+  doc["brightness"] = config.getBrightness();
+  doc["autoBrightnessStartHour"] = config.getAutoBrightnessStartHour();
+  doc["autoBrightnessEndHour"] = config.getAutoBrightnessEndHour();
+  doc["dayBrightness"] = config.getDayBrightness();
+  doc["nightBrightness"] = config.getNightBrightness();
+  doc["actualBrightness"] = Display::getInstance().getActualBrightness();
+  doc["use24HourFormat"] = config.is24HourFormat();
+  doc["useCelsius"] = config.isCelsius();
+  doc["screenFlipped"] = config.isScreenFlipped();
+  doc["invertColors"] = config.isInvertColors();
+  doc["timezone"] = config.getTimezone();
+  doc["address"] = config.getAddress();
+
+  JsonArray pagesArray = doc["enabledPages"].to<JsonArray>();
+  for (int pageId : config.getEnabledPages())
+  {
+    pagesArray.add(pageId);
+  }
+
+  doc["defaultPage"] = config.getDefaultPage();
+  doc["snoozeDuration"] = config.getSnoozeDuration();
+  doc["dismissDuration"] = config.getDismissDuration();
+  doc["tempCorrectionEnabled"] = config.isTempCorrectionEnabled();
+  doc["tempCorrection"] = config.getTempCorrection();
+
+  JsonObject logLevels = doc["logLevels"].to<JsonObject>();
+  for (int i = 0; i < LOG_MODULE_COUNT; i++)
+  {
+    logLevels[LOG_MODULE_NAMES[i]] = (int)config.getLogLevel((LogModule)i);
+  }
+}
+
+/**
+ * @brief Fills a document with the local sensor readings.
+ * @param doc The document to fill.
+ */
+static void buildSensorsJson(JsonDocument &doc)
+{
+  doc["bmeFound"] = isBmeFound();
+  if (isBmeFound())
+  {
+    doc["bmeTemp"] = String(getBmeTemperature(), 1);
+    doc["bmeHumidity"] = String(getSensorReadings().humidity, 1);
+  }
+  if (isRtcFound())
+  {
+    doc["rtcTemp"] = String(getRtcTemperature(), 1);
+  }
+  doc["unit"] = ConfigManager::getInstance().isCelsius() ? "C" : "F";
+}
+
+/// @brief Where `addHistoryPoint()` puts the points of a sensor history read.
+struct HistoryPoints
+{
+  JsonArray temperature;
+  JsonArray humidity;
+  bool celsius;
+};
+
+/// @brief Adds one history point, in tenths of the user's unit, or null for a gap.
+static void addHistoryPoint(const SensorHistory::Point &point, void *context)
+{
+  HistoryPoints *points = static_cast<HistoryPoints *>(context);
+  if (isnan(point.temperatureC))
+  {
+    points->temperature.add(nullptr);
+  }
+  else
+  {
+    float temp = points->celsius ? point.temperatureC : point.temperatureC * 9.0f / 5.0f + 32.0f;
+    points->temperature.add(lroundf(temp * 10));
+  }
+  if (isnan(point.humidity))
+  {
+    points->humidity.add(nullptr);
+  }
+  else
+  {
+    points->humidity.add(lroundf(point.humidity * 10));
+  }
+}
+
+/**
+ * @brief Fills a document with the indoor sensor history, oldest point first.
+ *
+ * Values are integers in tenths, to keep the reply compact. The step is
+ * rounded to whole sensor reads and raised until the day fits in
+ * SENSOR_HISTORY_MAX_POINTS.
+ * @param doc The document to fill.
+ * @param stepSeconds The requested seconds per point.
+ */
+static void buildSensorHistoryJson(JsonDocument &doc, uint32_t stepSeconds)
+{
+  SensorHistory &history = SensorHistory::getInstance();
+  uint32_t step = max<uint32_t>(1, stepSeconds * 1000 / SENSOR_UPDATE_INTERVAL);
+  uint32_t minStep = (history.size() + SENSOR_HISTORY_MAX_POINTS - 1) / SENSOR_HISTORY_MAX_POINTS;
+  step = max(step, minStep);
+
+  HistoryPoints points;
+  points.celsius = ConfigManager::getInstance().isCelsius();
+  doc["unit"] = points.celsius ? "C" : "F";
+  doc["scale"] = 10;
+  doc["step"] = step * SENSOR_UPDATE_INTERVAL / 1000;
+  points.temperature = doc["temperature"].to<JsonArray>();
+  points.humidity = doc["humidity"].to<JsonArray>();
+  uint32_t newestAgeMs;
+  history.read(step, addHistoryPoint, &points, newestAgeMs);
+  doc["newestAgeMs"] = newestAgeMs;
+}
+
+/**
+ * @brief Fills a document with the basic system figures shown on the system page.
+ * @param doc The document to fill.
+ */
+static void buildSystemSummaryJson(JsonDocument &doc)
+{
+  doc["freeHeap"] = ESP.getFreeHeap();
+  doc["uptime"] = millis();
+  doc["rssi"] = WiFi.RSSI();
+  doc["coreTemp"] = String(getCoreTemperature(), 1);
+  doc["unit"] = ConfigManager::getInstance().isCelsius() ? "C" : "F";
+}
+
+/// @brief Adds one heap region of a telemetry sample.
+static void addHeapSample(JsonObject parent, const char *key, const Telemetry::HeapSample &heap)
+{
+  JsonObject entry = parent[key].to<JsonObject>();
+  entry["free"] = heap.freeBytes;
+  entry["minFree"] = heap.minFreeBytes;
+  entry["largestBlock"] = heap.largestFreeBlock;
+}
+
+/**
+ * @brief Fills a document with the telemetry ring, newest sample first.
+ * @param doc The document to fill.
+ */
+static void buildPerfJson(JsonDocument &doc)
+{
+  Telemetry &telemetry = Telemetry::getInstance();
+  doc["intervalMs"] = TELEMETRY_SAMPLE_INTERVAL;
+  JsonArray samples = doc["samples"].to<JsonArray>();
+  Telemetry::Sample sample;
+  for (int age = 0; telemetry.getSample(age, sample); age++)
+  {
+    JsonObject entry = samples.add<JsonObject>();
+    entry["uptime"] = sample.uptimeSeconds;
+    addHeapSample(entry, "internal", sample.internal);
+    addHeapSample(entry, "psram", sample.psram);
+    JsonObject tasks = entry["tasks"].to<JsonObject>();
+    for (int i = 0; i < Telemetry::TRACKED_TASKS; i++)
+    {
+      const Telemetry::TaskSample &task = sample.tasks[i];
+      if (!task.present)
+      {
+        continue;
+      }
+      JsonObject item = tasks[Telemetry::TASK_NAMES[i]].to<JsonObject>();
+      if (task.cpuPermille != Telemetry::CPU_UNKNOWN)
+      {
+        item["cpu"] = task.cpuPermille / 10.0f;
+      }
+      item["stackFree"] = task.stackFreeBytes;
+    }
+  }
+
+  PowerManager &power = PowerManager::getInstance();
+  JsonObject powerInfo = doc["power"].to<JsonObject>();
+  powerInfo["scaling"] = power.isActive();
+  JsonObject locks = powerInfo["locks"].to<JsonObject>();
+  for (int i = 0; i < POWER_LOCK_COUNT; i++)
+  {
+    PowerManager::LockStats stats;
+    power.getLockStats((PowerLockKind)i, stats);
+    JsonObject entry = locks[POWER_LOCK_NAMES[i]].to<JsonObject>();
+    entry["held"] = stats.held;
+    entry["acquisitions"] = stats.acquisitions;
+    entry["heldMs"] = stats.heldUs / 1000;
+  }
+  uint32_t residencyMs[POWER_FREQUENCY_COUNT];
+  if (power.getResidency(residencyMs) > 0)
+  {
+    JsonArray residency = powerInfo["residency"].to<JsonArray>();
+    for (int i = 0; i < POWER_FREQUENCY_COUNT; i++)
+    {
+      JsonObject entry = residency.add<JsonObject>();
+      entry["cpuMhz"] = POWER_FREQUENCIES_MHZ[i];
+      entry["ms"] = residencyMs[i];
+    }
+  }
+
+  JsonObject loop = doc["loop"].to<JsonObject>();
+  loop["enabled"] = LoopProfiler::isEnabled();
+  if (!LoopProfiler::isEnabled())
+  {
+    return;
+  }
+  LoopProfiler &profiler = LoopProfiler::getInstance();
+  JsonArray scopes = loop["scopes"].to<JsonArray>();
+  for (int i = 0; i < LOOP_SCOPE_COUNT; i++)
+  {
+    LoopProfiler::ScopeStats stats;
+    if (!profiler.getScopeStats((LoopScope)i, stats))
+    {
+      continue;
+    }
+    JsonObject entry = scopes.add<JsonObject>();
+    entry["name"] = LOOP_SCOPE_NAMES[i];
+    entry["calls"] = stats.calls;
+    entry["minUs"] = stats.minUs;
+    entry["avgUs"] = stats.avgUs;
+    entry["p99Us"] = stats.p99Us;
+    entry["maxUs"] = stats.maxUs;
+  }
+  LoopProfiler::JitterStats jitter;
+  profiler.getJitterStats(jitter);
+  JsonObject period = loop["jitter"].to<JsonObject>();
+  period["periods"] = jitter.periods;
+  period["earlyWakes"] = jitter.earlyWakes;
+  period["maxUs"] = jitter.maxUs;
+  JsonArray histogram = period["histogram"].to<JsonArray>();
+  for (int bucket = 0; bucket < LoopProfiler::JITTER_BUCKETS; bucket++)
+  {
+    JsonObject entry = histogram.add<JsonObject>();
+    if (bucket < LoopProfiler::JITTER_BUCKETS - 1)
+    {
+      entry["belowUs"] = LoopProfiler::JITTER_LIMITS_US[bucket];
+    }
+    entry["periods"] = jitter.buckets[bucket];
+  }
+}
+
+/**
+ * @brief Writes the newest telemetry sample in the Prometheus text format.
+ * @param text Receives the metrics.
+ * @return False if nothing has been sampled yet.
+ */
+static bool buildPerfPrometheus(String &text)
+{
+  Telemetry::Sample sample;
+  if (!Telemetry::getInstance().getSample(0, sample))
+  {
+    return false;
+  }
+
+  char line[128];
+  text.reserve(4096);
+  text += "# TYPE esp32clock_uptime_seconds gauge\n";
+  snprintf(line, sizeof(line), "esp32clock_uptime_seconds %lu\n", (unsigned long)sample.uptimeSeconds);
+  text += line;
+
+  static const char *const HEAP_METRICS[] = {"free_bytes", "min_free_bytes", "largest_free_block_bytes"};
+  static const char *const REGION_NAMES[] = {"internal", "psram"};
+  const Telemetry::HeapSample *regions[] = {&sample.internal, &sample.psram};
+  for (int metric = 0; metric < 3; metric++)
+  {
+    snprintf(line, sizeof(line), "# TYPE esp32clock_heap_%s gauge\n", HEAP_METRICS[metric]);
+    text += line;
+    for (int region = 0; region < 2; region++)
+    {
+      const Telemetry::HeapSample &heap = *regions[region];
+      uint32_t value = metric == 0 ? heap.freeBytes : metric == 1 ? heap.minFreeBytes : heap.largestFreeBlock;
+      snprintf(line, sizeof(line), "esp32clock_heap_%s{region=\"%s\"} %lu\n", HEAP_METRICS[metric], REGION_NAMES[region],
+               (unsigned long)value);
+      text += line;
+    }
+  }
+
+  text += "# TYPE esp32clock_task_stack_free_bytes gauge\n";
+  for (int i = 0; i < Telemetry::TRACKED_TASKS; i++)
+  {
+    if (sample.tasks[i].present)
+    {
+      snprintf(line, sizeof(line), "esp32clock_task_stack_free_bytes{task=\"%s\"} %lu\n", Telemetry::TASK_NAMES[i],
+               (unsigned long)sample.tasks[i].stackFreeBytes);
+      text += line;
+    }
+  }
+  text += "# TYPE esp32clock_task_cpu_percent gauge\n";
+  for (int i = 0; i < Telemetry::TRACKED_TASKS; i++)
+  {
+    const Telemetry::TaskSample &task = sample.tasks[i];
+    if (task.present && task.cpuPermille != Telemetry::CPU_UNKNOWN)
+    {
+      snprintf(line, sizeof(line), "esp32clock_task_cpu_percent{task=\"%s\"} %u.%u\n", Telemetry::TASK_NAMES[i],
+               task.cpuPermille / 10, task.cpuPermille % 10);
+      text += line;
+    }
+  }
+
+  PowerManager &power = PowerManager::getInstance();
+  text += "# TYPE esp32clock_power_lock_held_seconds_total counter\n";
+  for (int i = 0; i < POWER_LOCK_COUNT; i++)
+  {
+    PowerManager::LockStats stats;
+    power.getLockStats((PowerLockKind)i, stats);
+    snprintf(line, sizeof(line), "esp32clock_power_lock_held_seconds_total{lock=\"%s\"} %.3f\n", POWER_LOCK_NAMES[i],
+             stats.heldUs / 1e6);
+    text += line;
+  }
+  uint32_t residencyMs[POWER_FREQUENCY_COUNT];
+  if (power.getResidency(residencyMs) > 0)
+  {
+    text += "# TYPE esp32clock_cpu_frequency_seconds_total counter\n";
+    for (int i = 0; i < POWER_FREQUENCY_COUNT; i++)
+    {
+      snprintf(line, sizeof(line), "esp32clock_cpu_frequency_seconds_total{cpu_mhz=\"%u\"} %.3f\n",
+               POWER_FREQUENCIES_MHZ[i], residencyMs[i] / 1e3);
+      text += line;
+    }
+  }
+
+  if (LoopProfiler::isEnabled())
+  {
+    LoopProfiler &profiler = LoopProfiler::getInstance();
+    text += "# TYPE esp32clock_scope_duration_us gauge\n";
+    for (int i = 0; i < LOOP_SCOPE_COUNT; i++)
+    {
+      LoopProfiler::ScopeStats stats;
+      if (!profiler.getScopeStats((LoopScope)i, stats))
+      {
+        continue;
+      }
+      const char *const statNames[] = {"min", "avg", "p99", "max"};
+      const uint32_t values[] = {stats.minUs, stats.avgUs, stats.p99Us, stats.maxUs};
+      for (int stat = 0; stat < 4; stat++)
+      {
+        snprintf(line, sizeof(line), "esp32clock_scope_duration_us{scope=\"%s\",stat=\"%s\"} %lu\n", LOOP_SCOPE_NAMES[i],
+                 statNames[stat], (unsigned long)values[stat]);
+        text += line;
+      }
+    }
+
+    // The period histogram in Prometheus form: cumulative buckets keyed by upper bound, in seconds.
+    LoopProfiler::JitterStats jitter;
+    profiler.getJitterStats(jitter);
+    text += "# TYPE esp32clock_loop_jitter_seconds histogram\n";
+    uint32_t cumulative = 0;
+    for (int bucket = 0; bucket < LoopProfiler::JITTER_BUCKETS; bucket++)
+    {
+      cumulative += jitter.buckets[bucket];
+      if (bucket < LoopProfiler::JITTER_BUCKETS - 1)
+      {
+        snprintf(line, sizeof(line), "esp32clock_loop_jitter_seconds_bucket{le=\"%g\"} %lu\n",
+                 LoopProfiler::JITTER_LIMITS_US[bucket] / 1e6, (unsigned long)cumulative);
+      }
+      else
+      {
+        snprintf(line, sizeof(line), "esp32clock_loop_jitter_seconds_bucket{le=\"+Inf\"} %lu\n", (unsigned long)cumulative);
+      }
+      text += line;
+    }
+    snprintf(line, sizeof(line), "esp32clock_loop_jitter_seconds_sum %.6f\n", jitter.totalUs / 1e6);
+    text += line;
+    snprintf(line, sizeof(line), "esp32clock_loop_jitter_seconds_count %lu\n", (unsigned long)jitter.periods);
+    text += line;
+    text += "# TYPE esp32clock_loop_early_wakes_total counter\n";
+    snprintf(line, sizeof(line), "esp32clock_loop_early_wakes_total %lu\n", (unsigned long)jitter.earlyWakes);
+    text += line;
+  }
+  return true;
+}
+
+/**
+ * @brief Fills a document with the firmware update state.
+ * @param doc The document to fill.
+ */
+static void buildUpdateStatusJson(JsonDocument &doc)
+{
+  doc["inProgress"] = UpdateManager::getInstance().isUpdateInProgress();
+
+  OtaProgress progress = UpdateManager::getInstance().getDownloadProgress();
+  if (progress.active || progress.bytes > 0)
+  {
+    JsonObject download = doc["download"].to<JsonObject>();
+    download["active"] = progress.active;
+    download["bytes"] = progress.bytes;
+    download["total"] = progress.total;
+    download["elapsedMs"] = progress.elapsedMs;
+    download["kbPerSecond"] = progress.kbPerSecond;
+    download["readerStallMs"] = progress.readerStallMs;
+    download["writerStallMs"] = progress.writerStallMs;
+    download["flashMs"] = progress.flashMs;
+  }
+}
+
+/**
+ * @brief Fills a document with the crash journal kept from the previous session.
+ * @param doc The document to fill.
+ */
+static void buildCrashLogJson(JsonDocument &doc)
+{
+  CrashJournal &journal = CrashJournal::getInstance();
+  doc["resetReason"] = CrashJournal::resetReasonName(journal.resetReason());
+  doc["crashed"] = journal.wasCrash();
+
+  JsonArray records = doc["records"].to<JsonArray>();
+  for (size_t i = 0; i < journal.previousCount(); i++)
+  {
+    const CrashJournal::Record &record = journal.previousRecord(i);
+    JsonObject entry = records.add<JsonObject>();
+    entry["time"] = record.time;
+    entry["uptimeMs"] = record.uptimeMs;
+    entry["task"] = String(record.task, strnlen(record.task, LOG_TASK_NAME_SIZE));
+    entry["core"] = record.core;
+    entry["level"] = LOG_LEVEL_NAMES[std::min<uint8_t>(record.level, LOG_LEVEL_VERBOSE)];
+    entry["message"] = String(record.message, record.length);
+  }
+}
+
+/**
+ * @brief The part of the persistent log one download streams.
+ *
+ * The segment list is taken when the request arrives, so text logged during
+ * the download is not included. The segment being read is kept open between
+ * filler calls.
+ */
+struct LogDownload
+{
+  LogStore::Segment segments[LOG_STORE_SEGMENTS];
+  size_t count = 0;     ///< Entries in `segments`.
+  size_t first = 0;     ///< First segment in the download.
+  size_t openIndex = 0; ///< Segment `file` belongs to.
+  File file;
+};
+
+/**
+ * @brief Parses a single `bytes=` range against the log size.
+ * @param header The Range header value.
+ * @param total The size of the log being downloaded.
+ * @param start Receives the first byte.
+ * @param end Receives one past the last byte.
+ * @return False if the range cannot be satisfied.
+ */
+static bool parseByteRange(const String &header, size_t total, size_t &start, size_t &end)
+{
+  int dash = header.indexOf('-');
+  if (dash < 0)
+  {
+    return false;
+  }
+  String first = header.substring(6, dash);
+  String last = header.substring(dash + 1);
+  first.trim();
+  last.trim();
+
+  if (first.length() == 0)
+  {
+    // bytes=-N: the last N bytes.
+    size_t suffix = last.toInt();
+    if (suffix == 0)
+    {
+      return false;
+    }
+    start = total > suffix ? total - suffix : 0;
+    end = total;
+  }
+  else
+  {
+    start = first.toInt();
+    end = last.length() > 0 ? (size_t)last.toInt() + 1 : total;
+    end = std::min(end, total);
+  }
+  return start < end;
+}
+
+/**
+ * @brief Copies log bytes from a download's segments.
+ *
+ * A segment removed by rotation since the request arrived reads as newlines,
+ * so the response still has the length it announced.
+ *
+ * @param download The download.
+ * @param position Offset of the first byte, counted from the download's first segment.
+ * @param buffer The buffer to fill.
+ * @param maxLen The size of the buffer.
+ * @return The bytes copied; at most the rest of the segment holding `position`.
+ */
+static size_t readLogDownload(LogDownload &download, size_t position, uint8_t *buffer, size_t maxLen)
+{
+  size_t index = download.first;
+  while (index < download.count && position >= download.segments[index].size)
+  {
+    position -= download.segments[index].size;
+    index++;
+  }
+  if (index == download.count)
+  {
+    return 0;
+  }
+
+  size_t length = std::min<size_t>(maxLen, download.segments[index].size - position);
+  if (!download.file || download.openIndex != index)
+  {
+    char path[32];
+    LogStore::segmentPath(path, sizeof(path), download.segments[index].sequence);
+    download.file = LittleFS.open(path, "r");
+    download.openIndex = index;
+  }
+
+  size_t copied = 0;
+  if (download.file && (download.file.position() == position || download.file.seek(position)))
+  {
+    copied = download.file.read(buffer, length);
+  }
+  memset(buffer + copied, '\n', length - copied);
+  return length;
+}
+
+/**
+ * @brief Streams the persistent log.
+ *
+ * `?since=<unix time>` starts at the segment that was being written at that
+ * time. A single `Range: bytes=` range is then honoured against what is
+ * left, so `Range: bytes=-8192` fetches just the tail.
+ *
+ * @param request The request.
+ */
+static void sendLogDownload(AsyncWebServerRequest *request)
+{
+  std::shared_ptr<LogDownload> download = std::make_shared<LogDownload>();
+  download->count = LogStore::getInstance().snapshot(download->segments);
+  if (download->count == 0)
+  {
+    request->send(404, "text/plain", "Log file not found");
+    return;
+  }
+
+  if (request->hasParam("since"))
+  {
+    uint32_t since = request->getParam("since")->value().toInt();
+    for (size_t i = 1; i < download->count; i++)
+    {
+      if (download->segments[i].startTime <= since)
+      {
+        download->first = i;
+      }
+    }
+  }
+
+  size_t total = 0;
+  for (size_t i = download->first; i < download->count; i++)
+  {
+    total += download->segments[i].size;
+  }
+
+  size_t start = 0;
+  size_t end = total;
+  bool partial = false;
+  if (request->hasHeader("Range"))
+  {
+    String range = request->getHeader("Range")->value();
+    // Multiple ranges are not supported; the whole log is sent instead.
+    if (range.startsWith("bytes=") && range.indexOf(',') < 0)
+    {
+      if (!parseByteRange(range, total, start, end))
+      {
+        AsyncWebServerResponse *response = request->beginResponse(416, "text/plain", "Range Not Satisfiable");
+        response->addHeader("Content-Range", "bytes */" + String(total));
+        request->send(response);
+        return;
+      }
+      partial = true;
+    }
+  }
+
+  AsyncWebServerResponse *response = request->beginResponse(
+      "text/plain", end - start, [download, start](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+      { return readLogDownload(*download, start + index, buffer, maxLen); });
+  if (response == nullptr)
+  {
+    request->send(500, "text/plain", "Internal Server Error: Could not open log file");
+    return;
+  }
+  response->addHeader("Accept-Ranges", "bytes");
+  response->addHeader("Content-Disposition", "attachment; filename=\"system.log\"");
+  if (partial)
+  {
+    response->setCode(206);
+    response->addHeader("Content-Range", "bytes " + String(start) + "-" + String(end - 1) + "/" + String(total));
+  }
+  request->send(response);
+}
+
+/**
+ * @brief A state topic pushed on `/api/events`.
+ *
+ * A topic is re-sent whenever its key changes. The key packs the generation
+ * counters of the state the payload is built from, so unchanged state costs
+ * one comparison per poll no matter how many clients are subscribed.
+ */
+struct EventTopic
+{
+  const char *name;                  ///< SSE event name.
+  uint64_t (*key)();                 ///< Current generation key.
+  void (*build)(JsonDocument &doc); ///< Fills the payload.
+};
+
+/**
+ * @brief Packs two generation counters, or a counter and a setting, into one key.
+ */
+static uint64_t generationKey(uint32_t primary, uint32_t secondary)
+{
+  return ((uint64_t)primary << 32) | secondary;
+}
+
+static const EventTopic eventTopics[] = {
+    {"sensors", []
+     { return generationKey(getSensorGeneration(), ConfigManager::getInstance().getGeneration()); },
+     buildSensorsJson},
+    {"weather", []
+     { return generationKey(WeatherService::getInstance().getGeneration(), ConfigManager::getInstance().getGeneration()); },
+     buildWeatherJson},
+    {"geocoding", []
+     { return generationKey(WeatherService::getInstance().getGeneration(), 0); },
+     buildGeocodingJson},
+    {"update", []
+     { return generationKey(UpdateManager::getInstance().getGeneration(), UpdateManager::getInstance().getDownloadProgress().bytes / 65536); },
+     buildUpdateStatusJson},
+    {"stats", []
+     { return generationKey(millis() / EVENTS_STATS_INTERVAL, ConfigManager::getInstance().getGeneration()); },
+     buildSystemSummaryJson},
+};
+
 /**
  * @brief Gets the singleton instance of the ClockWebServer.
  * @return A reference to the singleton instance.
@@ -48,7 +851,7 @@ ClockWebServer &ClockWebServer::getInstance()
  * @brief Constructs a new ClockWebServer.
  * Initializes the web server on port 80.
  */
-ClockWebServer::ClockWebServer() : server(80), _captivePortalActive(false) {}
+ClockWebServer::ClockWebServer() : server(80), events("/api/events"), _captivePortalActive(false) {}
 
 /**
  * @brief Enables captive portal mode.
@@ -79,17 +882,17 @@ void ClockWebServer::begin()
     // First, we handle the specific URLs that operating systems use for their
     // connectivity checks. Responding correctly to these prevents the OS from
     // disconnecting or opening its own browser window.
-    server.on("/connecttest.txt", HTTP_GET, [](AsyncWebServerRequest *request)
-              { request->send(200, "text/plain", "Microsoft Connect Test"); });
-    server.on("/generate_204", HTTP_GET, [](AsyncWebServerRequest *request)
-              { request->send(204); });
-    server.on("/hotspot-detect.html", HTTP_GET, [](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", "<!DOCTYPE html><HTML><HEAD><TITLE>Success</TITLE></HEAD><BODY>Success</BODY></HTML>"); });
+    route("/connecttest.txt", HTTP_GET, [](AsyncWebServerRequest *request)
+          { request->send(200, "text/plain", "Microsoft Connect Test"); });
+    route("/generate_204", HTTP_GET, [](AsyncWebServerRequest *request)
+          { request->send(204); });
+    route("/hotspot-detect.html", HTTP_GET, [](AsyncWebServerRequest *request)
+          { request->send(200, "text/html", "<!DOCTYPE html><HTML><HEAD><TITLE>Success</TITLE></HEAD><BODY>Success</BODY></HTML>"); });
 
     // Next, we define the actual setup page that the user should see.
     // This is served from the root URL of the ESP32's IP address.
-    server.on("/", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { onCaptivePortalRequest(request); });
+    route("/", HTTP_GET, [this](AsyncWebServerRequest *request)
+          { onCaptivePortalRequest(request); });
 
     // Finally, we use the onNotFound handler as a catch-all. If the user's browser
     // requests any other page (e.g., google.com, msn.com), we don't serve content.
@@ -103,23 +906,37 @@ void ClockWebServer::begin()
   }
   else
   {
-    server.on("/", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { onRootRequest(request); });
-    server.on("/wifi", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { onWifiRequest(request); });
-    server.on("/settings", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { onSettingsRequest(request); });
-
-    server.on("/alarms", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { onAlarmsRequest(request); });
-
-    server.on("/weather", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send_P(200, "text/html", WEATHER_PAGE_HTML, [this](const String &var)
-                                { return processor(var); }); });
+    route("/", HTTP_GET, [this](AsyncWebServerRequest *request)
+          { onRootRequest(request); });
+    route("/wifi", HTTP_GET, [this](AsyncWebServerRequest *request)
+          { onWifiRequest(request); });
+    route("/settings", HTTP_GET, [this](AsyncWebServerRequest *request)
+          { onSettingsRequest(request); });
+
+    route("/alarms", HTTP_GET, [this](AsyncWebServerRequest *request)
+          { onAlarmsRequest(request); });
+
+    // --- Live State Events ---
+    // Pages subscribe here instead of polling; publishEvents() pushes a topic
+    // only when its generation changes.
+    events.onConnect([this](AsyncEventSourceClient *client)
+                     { _eventsResync = true; });
+    server.addHandler(&events);
+
+    route("/weather", HTTP_GET, [this](AsyncWebServerRequest *request)
+          {
+#ifdef WEB_ASSETS_AVAILABLE
+            sendTemplate(request, WEATHER_PAGE_TEMPLATE, [this](const String &var)
+                         { return processor(var); });
+#else
+            request->send_P(200, "text/html", WEATHER_PAGE_HTML, [this](const String &var)
+                            { return processor(var); });
+#endif
+          });
 
     // --- API Handlers for Weather ---
-    server.on("/api/weather/location", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
+    route("/api/weather/location", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
         if (request->hasParam("address", true)) {
             String address = request->getParam("address", true)->value();
             
@@ -133,6 +950,14 @@ void ClockWebServer::begin()
             }
 
             if (WeatherService::getInstance().resolveLocationAsync(address)) {
+                if (!WeatherService::getInstance().getGeocodingResult().pending) {
+                    // Answered from the geocoding cache; the location is already saved.
+                    JsonDocument doc(JsonResponse::getInstance().allocator());
+                    buildGeocodingJson(doc);
+                    doc["message"] = "Location saved.";
+                    JsonResponse::getInstance().send(request, "/api/weather/location", doc);
+                    return;
+                }
                 request->send(200, "application/json", "{\"success\":true,\"message\":\"Search started.\",\"pending\":true}");
             } else {
                 request->send(200, "application/json", "{\"success\":false,\"message\":\"Search already in progress or system busy.\"}");
@@ -141,161 +966,43 @@ void ClockWebServer::begin()
             request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing address parameter.\"}");
         } });
 
-    server.on("/api/weather/geocoding-status", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
+    route("/api/weather/geocoding-status", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
         // Read-only: config is already written by the background weather task.
         // This endpoint only reports the result so the UI can react.
-        auto result = WeatherService::getInstance().getGeocodingResult();
-
-        JsonDocument doc;
-        doc["pending"] = result.pending;
-        doc["success"] = result.success;
-
-        if (!result.pending && result.success) {
-            doc["resolvedAddress"] = result.resolvedAddress;
-            doc["lat"] = result.lat;
-            doc["lon"] = result.lon;
-        }
-
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        JsonDocument doc(JsonResponse::getInstance().allocator());
+        buildGeocodingJson(doc);
+        JsonResponse::getInstance().send(request, "/api/weather/geocoding-status", doc);
     });
 
-    server.on("/api/weather", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-      auto& weatherService = WeatherService::getInstance();
-      WeatherData data = weatherService.getCurrentWeather();
-      JsonDocument doc;
-
-      bool isMetric = ConfigManager::getInstance().isCelsius();
-      float temp = data.temp; // WeatherService stores temp in Fahrenheit
-      float feelsLike = data.feelsLike;
-      float windSpeed = data.windSpeed;
-
-      if (isMetric) {
-          temp = (temp - 32.0f) * 5.0f / 9.0f;
-          feelsLike = (feelsLike - 32.0f) * 5.0f / 9.0f;
-          windSpeed = windSpeed * 1.60934f; // mph to km/h
-      }
-
-      doc["temp"] = temp;
-      doc["feelsLike"] = feelsLike;
-      doc["humidity"] = data.humidity;
-      doc["windSpeed"] = windSpeed;
-      doc["rainChance"] = data.rainChance;
-      doc["condition"] = data.condition;
-      
-      doc["uvIndex"] = data.uvIndex;
-      doc["cloudCover"] = data.cloudCover;
-      doc["pressure"] = data.pressure; // hPa
-      doc["visibility"] = data.visibility; // meters
-      doc["windDirection"] = WeatherService::getWindDirectionStr(data.windDirection);
-      doc["windGusts"] = isMetric ? (data.windGusts * 1.60934f) : data.windGusts; // Convert gusts if metric
-      
-      String sunrise = data.sunrise;
-      String sunset = data.sunset;
-
-      if (!ConfigManager::getInstance().is24HourFormat()) {
-          auto to12h = [](String time) -> String {
-              int sep = time.indexOf(':');
-              if (sep == -1) return time;
-              int h = time.substring(0, sep).toInt();
-              String m = time.substring(sep + 1);
-              String suffix = " AM";
-              if (h >= 12) {
-                  suffix = " PM";
-                  if (h > 12) h -= 12;
-              }
-              if (h == 0) h = 12;
-              return String(h) + ":" + m + suffix;
-          };
-          sunrise = to12h(sunrise);
-          sunset = to12h(sunset);
-      }
-
-      doc["sunrise"] = sunrise;
-      doc["sunset"] = sunset;
-
-      doc["isValid"] = data.isValid;
-      doc["unit"] = isMetric ? "C" : "F";
-      doc["windUnit"] = isMetric ? "km/h" : "mph";
-      
-      String response;
-      serializeJson(doc, response);
-      request->send(200, "application/json", response); });
+    route("/api/weather", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      JsonResponse::getInstance().sendCached(request, "/api/weather",
+                                             generationKey(WeatherService::getInstance().getGeneration(), ConfigManager::getInstance().getGeneration()),
+                                             buildWeatherJson); });
 
-    server.on("/api/weather/sync", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
+    route("/api/weather/sync", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
       WeatherService::getInstance().forceUpdate();
       request->send(200, "text/plain", "Weather sync started."); });
 
     // --- API Handlers for Alarms ---
-    server.on("/api/alarms", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-      auto& config = ConfigManager::getInstance();
-      JsonDocument doc;
-      JsonArray alarmsArray = doc.to<JsonArray>();
-
-      std::vector<Alarm> alarms = config.getAllAlarms();
-      for (const auto &alarm : alarms) {
-        JsonObject alarmObj = alarmsArray.add<JsonObject>();
-        alarmObj["id"] = alarm.getId();
-        alarmObj["enabled"] = alarm.isEnabled();
-        alarmObj["hour"] = alarm.getHour();
-        alarmObj["minute"] = alarm.getMinute();
-        alarmObj["days"] = alarm.getDays();
-      }
-      
-      String response;
-      serializeJson(doc, response);
-      request->send(200, "application/json", response); });
-
-    server.on("/api/alarms/save", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
-        if (request->_tempObject) {
-            delete (std::vector<uint8_t>*)request->_tempObject;
-            request->_tempObject = nullptr;
-        } }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
-              {
-        
-        if (index == 0) {
-          // Early-reject if Content-Length is known. If total == 0, client is using
-          // chunked transfer — the cumulative check below is the backstop.
-          if (total > 0 && total > 8192) {
-            request->send(413, "text/plain", "Payload too large");
-            return;
-          }
-          
-          request->_tempObject = new std::vector<uint8_t>();
-          request->onDisconnect([request]() {
-            if (request->_tempObject) {
-              delete (std::vector<uint8_t>*)request->_tempObject;
-              request->_tempObject = nullptr;
-            }
-          });
-        }
-
-        if (!request->_tempObject) return;
+    route("/api/alarms", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      JsonResponse::getInstance().sendCached(request, "/api/alarms", generationKey(ConfigManager::getInstance().getGeneration(), 0),
+                                             buildAlarmsJson); });
 
-        std::vector<uint8_t>* buffer = (std::vector<uint8_t>*)request->_tempObject;
-        
-        // Safety check for cumulative size
-        if (buffer->size() + len > 8192) {
-             delete buffer;
-             request->_tempObject = nullptr;
-             request->send(413, "text/plain", "Payload too large");
-             return;
-        }
+    route("/api/alarms/save", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
+        RequestBodyPool::getInstance().release(request); }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+          {
         
-        buffer->insert(buffer->end(), data, data + len);
-
-        if (index + len == total) {
-          // All data has been received.
-          JsonDocument doc;
-          DeserializationError error = deserializeJson(doc, buffer->data(), buffer->size());
-          delete buffer; // Clean up the buffer
-          request->_tempObject = nullptr;
+        RequestBody *body = RequestBodyPool::getInstance().collect(request, data, len, index, total, 8192);
+        if (body != nullptr) {
+          // Parse straight from the pooled buffer, then hand it back before doing the work.
+          JsonDocument doc(JsonResponse::getInstance().allocator());
+          DeserializationError error = deserializeJson(doc, body->data, body->length);
+          RequestBodyPool::getInstance().release(request);
 
           if (error) {
             request->send(400, "text/plain", "Invalid JSON");
@@ -335,6 +1042,26 @@ void ClockWebServer::begin()
               alarm.setId(id); // -1 will be assigned a new ID by ConfigManager
             }
 
+            // An alarm's own beep pattern: on/off steps in ms, starting with on.
+            // Leaving the key out keeps the saved pattern; [] restores the ramp.
+            JsonArray steps = alarmObj["pattern"];
+            if (!steps.isNull()) {
+              BuzzerPattern pattern;
+              if (steps.size() > BuzzerPattern::MAX_STEPS) {
+                request->send(400, "text/plain", "Too many pattern steps. Max limit is " + String(BuzzerPattern::MAX_STEPS));
+                return;
+              }
+              for (JsonVariant step : steps) {
+                pattern.stepsMs[pattern.count++] = step | 0;
+              }
+              if (pattern.count > 0 && !pattern.isValid()) {
+                request->send(400, "text/plain", "A pattern needs an even number of steps of " + String(BuzzerPattern::MIN_STEP_MS) +
+                                                     "-" + String(BuzzerPattern::MAX_STEP_MS) + " ms");
+                return;
+              }
+              alarm.setBuzzerPattern(pattern);
+            }
+
             bool isEnabled = alarmObj["enabled"] | false;
             
             // If the alarm is being disabled and it's the one currently ringing, stop it.
@@ -370,92 +1097,32 @@ void ClockWebServer::begin()
           // Force an immediate update of the alarm cache and RTC hardware alarms
           TimeManager::getInstance().setNextAlarms();
 
-          request->send(200, "text/plain", "Alarms saved successfully!");
-        } });
-
-    // --- API Handlers for Settings ---
-    server.on("/api/settings", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-      auto& config = ConfigManager::getInstance();
-      JsonDocument doc;
-      doc["autoBrightness"] = config.isAutoBrightness();
-      doc["brightness"] = config.getBrightness();
-      doc["autoBrightnessStartHour"] = config.getAutoBrightnessStartHour();
-      doc["autoBrightnessEndHour"] = config.getAutoBrightnessEndHour();
-      doc["dayBrightness"] = config.getDayBrightness();
-      doc["nightBrightness"] = config.getNightBrightness();
-      doc["actualBrightness"] = Display::getInstance().getActualBrightness();
-      doc["use24HourFormat"] = config.is24HourFormat();
-      doc["useCelsius"] = config.isCelsius();
-      doc["screenFlipped"] = config.isScreenFlipped();
-      doc["invertColors"] = config.isInvertColors();
-      doc["timezone"] = config.getTimezone();
-      doc["address"] = config.getAddress();
-      
-      JsonArray pagesArray = doc["enabledPages"].to<JsonArray>();
-      for (int pageId : config.getEnabledPages()) {
-        pagesArray.add(pageId);
-      }
-
-      doc["defaultPage"] = config.getDefaultPage();
-      doc["snoozeDuration"] = config.getSnoozeDuration();
-      doc["dismissDuration"] = config.getDismissDuration();
-      doc["tempCorrectionEnabled"] = config.isTempCorrectionEnabled();
-      doc["tempCorrection"] = config.getTempCorrection();
-      
-      String response;
-      serializeJson(doc, response);
-      request->send(200, "application/json", response); });
-
-    // API handler for settings save
-    server.on(
-        "/api/settings/save", HTTP_POST, [](AsyncWebServerRequest *request)
-        {
-            if (request->_tempObject) {
-                delete (std::vector<uint8_t>*)request->_tempObject;
-                request->_tempObject = nullptr;
-            } },
-        NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len,
-           size_t index, size_t total)
-        {
-          if (index == 0)
-          {
-            if (total > 0 && total > 4096) {
-              request->send(413, "text/plain", "Payload too large");
-              return;
-            }
-            request->_tempObject = new std::vector<uint8_t>();
-            request->onDisconnect([request]() {
-              if (request->_tempObject) {
-                delete (std::vector<uint8_t>*)request->_tempObject;
-                request->_tempObject = nullptr;
-              }
-            });
-          }
-
-          if (!request->_tempObject)
-            return;
-
-          std::vector<uint8_t> *buffer =
-              (std::vector<uint8_t> *)request->_tempObject;
-
-          if (buffer->size() + len > 4096) {
-              delete buffer;
-              request->_tempObject = nullptr;
-              request->send(413, "text/plain", "Payload too large");
-              return;
-          }
-
-          buffer->insert(buffer->end(), data, data + len);
+          request->send(200, "text/plain", "Alarms saved successfully!");
+        } });
 
-          if (index + len == total)
+    // --- API Handlers for Settings ---
+    route("/api/settings", HTTP_GET, [](AsyncWebServerRequest *request)
           {
-            JsonDocument doc;
-            DeserializationError error = deserializeJson(doc, buffer->data(), buffer->size());
+      // actualBrightness follows auto-brightness without any setting being written.
+      JsonResponse::getInstance().sendCached(request, "/api/settings",
+                                             generationKey(ConfigManager::getInstance().getGeneration(), Display::getInstance().getActualBrightness()),
+                                             buildSettingsJson); });
 
-            delete buffer;
-            request->_tempObject = nullptr;
+    // API handler for settings save
+    route(
+        "/api/settings/save", HTTP_POST, [](AsyncWebServerRequest *request)
+        {
+            RequestBodyPool::getInstance().release(request); },
+        NULL,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len,
+           size_t index, size_t total)
+        {
+          RequestBody *body = RequestBodyPool::getInstance().collect(request, data, len, index, total, 4096);
+          if (body != nullptr)
+          {
+            JsonDocument doc(JsonResponse::getInstance().allocator());
+            DeserializationError error = deserializeJson(doc, body->data, body->length);
+            RequestBodyPool::getInstance().release(request);
 
             if (error)
             {
@@ -470,33 +1137,51 @@ void ClockWebServer::begin()
               bool oldInvertColors = config.isInvertColors();
               float oldTempCorrection = config.getTempCorrection();
               bool oldTempCorrectionEnabled = config.isTempCorrectionEnabled();
-              config.setAutoBrightness(doc["autoBrightness"]);
-              config.setBrightness(doc["brightness"]);
-              config.setAutoBrightnessStartHour(doc["autoBrightnessStartHour"]);
-              config.setAutoBrightnessEndHour(doc["autoBrightnessEndHour"]);
-              config.setDayBrightness(doc["dayBrightness"]);
-              config.setNightBrightness(doc["nightBrightness"]);
-              config.set24HourFormat(doc["use24HourFormat"]);
-              config.setCelsius(doc["useCelsius"]);
-              config.setScreenFlipped(doc["screenFlipped"]);
-              config.setInvertColors(doc["invertColors"]);
-              config.setTimezone(doc["timezone"]);
-
-              if (doc["enabledPages"].is<JsonArray>())
               {
-                std::vector<int> pages;
-                for (int id : doc["enabledPages"].as<JsonArray>())
+                // Apply the whole form as one change.
+                ConfigManager::Transaction transaction(config);
+                config.setAutoBrightness(doc["autoBrightness"]);
+                config.setBrightness(doc["brightness"]);
+                config.setAutoBrightnessStartHour(doc["autoBrightnessStartHour"]);
+                config.setAutoBrightnessEndHour(doc["autoBrightnessEndHour"]);
+                config.setDayBrightness(doc["dayBrightness"]);
+                config.setNightBrightness(doc["nightBrightness"]);
+                config.set24HourFormat(doc["use24HourFormat"]);
+                config.setCelsius(doc["useCelsius"]);
+                config.setScreenFlipped(doc["screenFlipped"]);
+                config.setInvertColors(doc["invertColors"]);
+                config.setTimezone(doc["timezone"]);
+
+                if (doc["enabledPages"].is<JsonArray>())
                 {
-                  pages.push_back(id);
+                  std::vector<int> pages;
+                  for (int id : doc["enabledPages"].as<JsonArray>())
+                  {
+                    pages.push_back(id);
+                  }
+                  config.setEnabledPages(pages);
+                  DisplayManager::getInstance().invalidateBackFrame();
                 }
-                config.setEnabledPages(pages);
-              }
 
-              config.setDefaultPage(doc["defaultPage"]);
-              config.setSnoozeDuration(doc["snoozeDuration"]);
-              config.setDismissDuration(doc["dismissDuration"]);
-              config.setTempCorrectionEnabled(doc["tempCorrectionEnabled"]);
-              config.setTempCorrection(doc["tempCorrection"]);
+                config.setDefaultPage(doc["defaultPage"]);
+                config.setSnoozeDuration(doc["snoozeDuration"]);
+                config.setDismissDuration(doc["dismissDuration"]);
+                config.setTempCorrectionEnabled(doc["tempCorrectionEnabled"]);
+                config.setTempCorrection(doc["tempCorrection"]);
+
+                JsonObject logLevels = doc["logLevels"];
+                if (logLevels)
+                {
+                  for (int i = 0; i < LOG_MODULE_COUNT; i++)
+                  {
+                    JsonVariant level = logLevels[LOG_MODULE_NAMES[i]];
+                    if (level.is<int>())
+                    {
+                      config.setLogLevel((LogModule)i, (LogLevel)constrain(level.as<int>(), (int)LOG_LEVEL_NONE, (int)LOG_LEVEL_VERBOSE));
+                    }
+                  }
+                }
+              }
 
               if (oldScreenFlipped != config.isScreenFlipped())
               {
@@ -517,7 +1202,7 @@ void ClockWebServer::begin()
 
               if (oldTempCorrection != config.getTempCorrection() || oldTempCorrectionEnabled != config.isTempCorrectionEnabled())
               {
-                handleSensorUpdates(true);
+                I2cBus::getInstance().requestSensorRead();
               }
 
               request->send(200, "text/plain", "Settings saved!");
@@ -525,8 +1210,8 @@ void ClockWebServer::begin()
           }
         });
 
-    server.on("/api/settings/reset", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
+    route("/api/settings/reset", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
       auto &config = ConfigManager::getInstance();
       bool oldScreenFlipped = config.isScreenFlipped();
       config.resetGeneralSettingsToDefaults();
@@ -539,10 +1224,10 @@ void ClockWebServer::begin()
       request->send(200, "text/plain", "General settings reset!"); });
 
     // --- API Handlers for Display ---
-    server.on("/api/display", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
+    route("/api/display", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
       auto& config = ConfigManager::getInstance();
-      JsonDocument doc;
+      JsonDocument doc(JsonResponse::getInstance().allocator());
       doc["backgroundColor"] = config.getBackgroundColor();
       doc["timeColor"] = config.getTimeColor();
       doc["todColor"] = config.getTodColor();
@@ -554,93 +1239,306 @@ void ClockWebServer::begin()
       doc["weatherTempColor"] = config.getWeatherTempColor();
       doc["weatherForecastColor"] = config.getWeatherForecastColor();
       
-      String response;
-      serializeJson(doc, response);
-      request->send(200, "application/json", response); });
+      JsonResponse::getInstance().send(request, "/api/display", doc); });
 
-    server.on("/api/sensors", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-      JsonDocument doc;
-      doc["bmeFound"] = isBmeFound();
-      if (isBmeFound()) {
-        doc["bmeTemp"] = String(getBmeTemperature(), 1);
-        doc["bmeHumidity"] = String(getHumidity(), 1);
+    route("/api/sensors", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      JsonDocument doc(JsonResponse::getInstance().allocator());
+      buildSensorsJson(doc);
+      JsonResponse::getInstance().send(request, "/api/sensors", doc); });
+
+    route("/api/sensors/history", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      uint32_t stepSeconds = 0;
+      if (request->hasParam("step")) {
+        stepSeconds = constrain(request->getParam("step")->value().toInt(), 0L, 86400L);
       }
-      if (isRtcFound()) {
-        doc["rtcTemp"] = String(getRtcTemperature(), 1);
+      JsonDocument doc(JsonResponse::getInstance().allocator());
+      buildSensorHistoryJson(doc, stepSeconds);
+      JsonResponse::getInstance().send(request, "/api/sensors/history", doc); });
+
+    route("/api/system/stats", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      JsonDocument doc(JsonResponse::getInstance().allocator());
+      buildSystemSummaryJson(doc);
+      doc["fontLoadsPerSec"] = FontManager::getInstance().loadsPerSecond();
+      doc["fontSwitchesPerSec"] = FontManager::getInstance().switchesPerSecond();
+      doc["fontLoadsTotal"] = FontManager::getInstance().totalLoads();
+      doc["bodyRejectedBusy"] = RequestBodyPool::getInstance().rejectedBusy();
+      doc["bodyRejectedSize"] = RequestBodyPool::getInstance().rejectedSize();
+      doc["logDropped"] = SerialLog::getInstance().droppedLines();
+
+      ConfigSaveStats saveStats = ConfigManager::getInstance().getSaveStats();
+      JsonObject configSave = doc["configSave"].to<JsonObject>();
+      configSave["saves"] = saveStats.saves;
+      configSave["totalWrites"] = saveStats.totalWrites;
+      configSave["lastWrites"] = saveStats.lastWrites;
+      configSave["lastUs"] = saveStats.lastDurationUs;
+      configSave["maxUs"] = saveStats.maxDurationUs;
+
+      static const char *const LOAD_SOURCES[] = {"defaults", "blob", "keys"};
+      ConfigLoadStats loadStats = ConfigManager::getInstance().getLoadStats();
+      JsonObject configLoad = doc["configLoad"].to<JsonObject>();
+      configLoad["us"] = loadStats.durationUs;
+      configLoad["source"] = LOAD_SOURCES[loadStats.source];
+
+      RtcClockStats rtcStats = TimeManager::getInstance().getRtcClockStats();
+      JsonObject rtc = doc["rtc"].to<JsonObject>();
+      rtc["freeRunning"] = rtcStats.freeRunning;
+      rtc["transactionsPerMinute"] = rtcStats.transactionsPerMinute;
+      rtc["resyncs"] = rtcStats.resyncs;
+      rtc["lastResyncOffsetUs"] = rtcStats.lastResyncOffsetUs;
+      rtc["ntpOffsetUs"] = rtcStats.lastNtpOffsetUs;
+      if (rtcStats.driftFitted)
+      {
+        rtc["driftPpm"] = rtcStats.driftPpm;
       }
-      doc["unit"] = ConfigManager::getInstance().isCelsius() ? "C" : "F";
-      
-      String response;
-      serializeJson(doc, response);
-      request->send(200, "application/json", response); });
+      rtc["driftSamples"] = rtcStats.driftSamples;
+      if (rtcStats.agingOffset != TimeManager::AGING_OFFSET_UNKNOWN)
+      {
+        rtc["agingOffset"] = rtcStats.agingOffset;
+      }
+      rtc["ntpIntervalMin"] = rtcStats.ntpSyncInterval / 60000;
 
-    server.on("/api/system/stats", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-      JsonDocument doc;
-      doc["freeHeap"] = ESP.getFreeHeap();
-      doc["uptime"] = millis();
-      doc["rssi"] = WiFi.RSSI();
-      doc["coreTemp"] = String(getCoreTemperature(), 1);
-      doc["unit"] = ConfigManager::getInstance().isCelsius() ? "C" : "F";
-      
-      String response;
-      serializeJson(doc, response);
-      request->send(200, "application/json", response); });
+      I2cBusStats busStats = I2cBus::getInstance().getStats();
+      JsonObject i2c = doc["i2c"].to<JsonObject>();
+      i2c["transactions"] = busStats.transactions;
+      i2c["writesQueued"] = busStats.writesQueued;
+      i2c["maxWaitUs"] = busStats.maxWaitUs;
+      i2c["sensorAgeMs"] = busStats.sensorAgeMs;
 
-    server.on("/api/system/ntp-sync", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
-      startNtpSync();
-      request->send(200, "text/plain", "NTP sync started successfully."); });
+      JsonArray https = doc["https"].to<JsonArray>();
+      for (int host = 0; host < HTTPS_HOST_COUNT; host++)
+      {
+        HttpsHostStats hostStats = HttpsClient::getInstance().getStats((HttpsHost)host);
+        JsonObject entry = https.add<JsonObject>();
+        entry["host"] = hostStats.host;
+        entry["requests"] = hostStats.requests;
+        entry["reused"] = hostStats.reused;
+        entry["handshakes"] = hostStats.handshakes;
+        entry["failures"] = hostStats.failures;
+        entry["lastHandshakeMs"] = hostStats.lastHandshakeMs;
+        entry["maxHandshakeMs"] = hostStats.maxHandshakeMs;
+        entry["lastTransferMs"] = hostStats.lastTransferMs;
+        entry["maxTransferMs"] = hostStats.maxTransferMs;
+      }
 
-    server.on(
-        "/api/display/save", HTTP_POST, [](AsyncWebServerRequest *request)
+      WeatherFetchStats fetchStats = WeatherService::getInstance().getFetchStats();
+      JsonObject weather = doc["weather"].to<JsonObject>();
+      weather["fetches"] = fetchStats.fetches;
+      weather["parseFailures"] = fetchStats.parseFailures;
+      weather["lastBytes"] = fetchStats.lastBytes;
+      weather["lastMs"] = fetchStats.lastMs;
+      weather["lastPeakHeap"] = fetchStats.lastPeakHeap;
+      weather["maxPeakHeap"] = fetchStats.maxPeakHeap;
+
+      RenderProfiler &profiler = RenderProfiler::getInstance();
+      JsonObject render = doc["render"].to<JsonObject>();
+      render["enabled"] = profiler.isEnabled();
+      EdgeLatencyStats latency = DisplayManager::getInstance().getEdgeLatencyStats();
+      JsonObject edge = render["edgeLatency"].to<JsonObject>();
+      edge["frames"] = latency.frames;
+      edge["lastUs"] = latency.lastUs;
+      edge["maxUs"] = latency.maxUs;
+      JsonArray histogram = edge["histogram"].to<JsonArray>();
+      for (int bucket = 0; bucket < EdgeLatencyStats::BUCKETS; bucket++)
+      {
+        JsonObject entry = histogram.add<JsonObject>();
+        if (bucket < EdgeLatencyStats::BUCKETS - 1)
         {
-            if (request->_tempObject) {
-                delete (std::vector<uint8_t>*)request->_tempObject;
-                request->_tempObject = nullptr;
-            } },
-        NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len,
-           size_t index, size_t total)
+          entry["belowMs"] = EdgeLatencyStats::BUCKET_LIMITS_MS[bucket];
+        }
+        entry["frames"] = latency.buckets[bucket];
+      }
+      JsonArray pages = render["pages"].to<JsonArray>();
+      for (int page = 0; page < RenderProfiler::MAX_PAGES; page++)
+      {
+        RenderProfiler::PageStats stats;
+        if (!profiler.getPageStats(page, stats))
         {
-          if (index == 0)
+          continue;
+        }
+        JsonObject entry = pages.add<JsonObject>();
+        entry["page"] = page;
+        entry["frames"] = stats.frames;
+        addPercentiles(entry, "frameUs", stats.frameUs);
+        addPercentiles(entry, "rasterUs", stats.rasterUs);
+        addPercentiles(entry, "pushUs", stats.pushUs);
+        addPercentiles(entry, "pixels", stats.pixels);
+        entry["fontLoads"] = stats.fontLoads;
+        entry["fontSwitches"] = stats.fontSwitches;
+      }
+
+      JsonArray api = doc["api"].to<JsonArray>();
+      for (int i = 0; i < JsonResponse::MAX_ENDPOINTS; i++)
+      {
+        JsonResponse::EndpointStats stats;
+        if (!JsonResponse::getInstance().getEndpointStats(i, stats))
+        {
+          break;
+        }
+        JsonObject entry = api.add<JsonObject>();
+        entry["endpoint"] = stats.endpoint;
+        entry["requests"] = stats.requests;
+        entry["lastBytes"] = stats.lastBytes;
+        entry["maxBytes"] = stats.maxBytes;
+        entry["cacheHits"] = stats.cacheHits;
+        entry["cacheMisses"] = stats.cacheMisses;
+      }
+
+      JsonResponse::getInstance().send(request, "/api/system/stats", doc); });
+
+    // format=prometheus serves the newest sample for scraping; the default is the whole ring as JSON.
+    route("/api/system/perf", HTTP_GET, [](AsyncWebServerRequest *request)
           {
-            // Early-reject on known Content-Length; chunked fallback handled cumulatively below.
-            if (total > 0 && total > 4096) {
-              request->send(413, "text/plain", "Payload too large");
-              return;
-            }
-            request->_tempObject = new std::vector<uint8_t>();
-            request->onDisconnect([request]() {
-              if (request->_tempObject) {
-                delete (std::vector<uint8_t>*)request->_tempObject;
-                request->_tempObject = nullptr;
-              }
-            });
-          }
+      if (request->hasParam("format") && request->getParam("format")->value() == "prometheus") {
+        String text;
+        if (!buildPerfPrometheus(text)) {
+          request->send(503, "text/plain", "No telemetry sample yet.");
+          return;
+        }
+        request->send(200, "text/plain; version=0.0.4", text);
+        return;
+      }
+      JsonDocument doc(JsonResponse::getInstance().allocator());
+      buildPerfJson(doc);
+      JsonResponse::getInstance().send(request, "/api/system/perf", doc); });
 
-          if (!request->_tempObject)
-            return;
+    route("/api/system/http-stats", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      static const char *const classNames[ROUTE_CLASS_COUNT] = {"static", "apiRead", "apiWrite", "ota"};
+      HttpAdmission &admission = HttpAdmission::getInstance();
+      JsonDocument doc(JsonResponse::getInstance().allocator());
 
-          std::vector<uint8_t> *buffer =
-              (std::vector<uint8_t> *)request->_tempObject;
+      JsonArray classes = doc["classes"].to<JsonArray>();
+      for (int i = 0; i < ROUTE_CLASS_COUNT; i++)
+      {
+        HttpAdmission::ClassStats stats;
+        admission.getClassStats((RouteClass)i, stats);
+        JsonObject entry = classes.add<JsonObject>();
+        entry["name"] = classNames[i];
+        entry["inFlight"] = stats.inFlight;
+        entry["limit"] = stats.limit;
+        entry["admitted"] = stats.admitted;
+        entry["rejected"] = stats.rejected;
+      }
 
-          if (buffer->size() + len > 4096) {
-              delete buffer;
-              request->_tempObject = nullptr;
-              request->send(413, "text/plain", "Payload too large");
-              return;
-          }
+      JsonArray routes = doc["routes"].to<JsonArray>();
+      HttpAdmission::RouteStats stats;
+      for (int i = 0; admission.getRouteStats(i, stats); i++)
+      {
+        JsonObject entry = routes.add<JsonObject>();
+        entry["uri"] = stats.uri;
+        entry["class"] = classNames[stats.routeClass];
+        entry["requests"] = stats.requests;
+        entry["rejected"] = stats.rejected;
+        entry["p95Us"] = stats.p95Us;
+        entry["maxUs"] = stats.maxUs;
+        entry["lockWaitP95Us"] = stats.lockWaitP95Us;
+        entry["lockWaitMaxUs"] = stats.lockWaitMaxUs;
+      }
+
+      JsonResponse::getInstance().send(request, "/api/system/http-stats", doc); });
+
+    // Runs on the web server task and blocks it until done, so it is capped at MAX_ITERATIONS.
+    route("/api/system/benchmark", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
+      uint32_t iterations = Benchmark::DEFAULT_ITERATIONS;
+      if (request->hasParam("iterations", true)) {
+        iterations = constrain(request->getParam("iterations", true)->value().toInt(), 1L, (long)Benchmark::MAX_ITERATIONS);
+      }
+
+      struct
+      {
+        const char *name;
+        JsonResponse::Builder build;
+      } builders[] = {
+          {"buildWeatherJson", buildWeatherJson},
+          {"buildGeocodingJson", buildGeocodingJson},
+          {"buildAlarmsJson", buildAlarmsJson},
+          {"buildSettingsJson", buildSettingsJson},
+          {"buildSensorsJson", buildSensorsJson},
+          {"buildSystemSummaryJson", buildSystemSummaryJson},
+          {"buildUpdateStatusJson", buildUpdateStatusJson},
+      };
+
+      JsonDocument doc(JsonResponse::getInstance().allocator());
+      JsonArray results = doc["results"].to<JsonArray>();
+      for (const auto &builder : builders)
+      {
+        // Build and measure, which is all a reply costs before it is streamed.
+        addBenchmarkResult(results, builder.name, Benchmark::measure(iterations, [&builder]()
+                                                                      {
+          JsonDocument payload(JsonResponse::getInstance().allocator());
+          builder.build(payload);
+          measureJson(payload); }));
+      }
+
+      // Synthetic alarm sets, so the scheduler can be compared independently of the saved alarms.
+      DateTime now = TimeManager::getInstance().getCachedTime();
+      static const uint8_t alarmCounts[] = {1, 8, 32, 128};
+      for (uint8_t count : alarmCounts)
+      {
+        std::vector<Alarm> alarms(count);
+        for (uint8_t i = 0; i < count; i++)
+        {
+          alarms[i].setId(i);
+          alarms[i].setHour((i * 7) % 24);
+          alarms[i].setMinute((i * 13) % 60);
+          alarms[i].setDays(i % 2 == 0 ? 0x7F : 1 << (i % 7));
+          alarms[i].setEnabled(true);
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "computeNextAlarms/%u", count);
+        addBenchmarkResult(results, name, Benchmark::measure(iterations, [&alarms, &now]()
+                                                              { TimeManager::computeNextAlarms(alarms, now); }));
+
+        // The incremental schedule: one alarm edited per sync, and reading the next two.
+        AlarmSchedule schedule;
+        schedule.sync(alarms, now);
+        uint32_t edits = 0;
+        snprintf(name, sizeof(name), "AlarmSchedule.sync/%u", count);
+        addBenchmarkResult(results, name, Benchmark::measure(iterations, [&alarms, &schedule, &edits, &now, count]()
+                                                              {
+          Alarm &alarm = alarms[edits++ % count];
+          alarm.setMinute((alarm.getMinute() + 1) % 60);
+          schedule.sync(alarms, now); }));
+        snprintf(name, sizeof(name), "AlarmSchedule.next/%u", count);
+        addBenchmarkResult(results, name, Benchmark::measure(iterations, [&schedule]()
+                                                              { schedule.next(2); }));
+      }
+
+      JsonResponse::getInstance().send(request, "/api/system/benchmark", doc); });
+
+    route("/api/system/profiler", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
+      if (!request->hasParam("enabled", true)) {
+        request->send(400, "text/plain", "Missing 'enabled' parameter.");
+        return;
+      }
+      bool enabled = request->getParam("enabled", true)->value() == "true";
+      RenderProfiler::getInstance().setEnabled(enabled);
+      request->send(200, "text/plain", enabled ? "Render profiler enabled." : "Render profiler disabled."); });
 
-          buffer->insert(buffer->end(), data, data + len);
+    route("/api/system/ntp-sync", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
+      startNtpSync();
+      request->send(200, "text/plain", "NTP sync started successfully."); });
 
-          if (index + len == total)
+    route(
+        "/api/display/save", HTTP_POST, [](AsyncWebServerRequest *request)
+        {
+            RequestBodyPool::getInstance().release(request); },
+        NULL,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len,
+           size_t index, size_t total)
+        {
+          RequestBody *body = RequestBodyPool::getInstance().collect(request, data, len, index, total, 4096);
+          if (body != nullptr)
           {
-            JsonDocument doc;
-            DeserializationError error = deserializeJson(doc, buffer->data(), buffer->size());
-            delete buffer;
-            request->_tempObject = nullptr;
+            JsonDocument doc(JsonResponse::getInstance().allocator());
+            DeserializationError error = deserializeJson(doc, body->data, body->length);
+            RequestBodyPool::getInstance().release(request);
 
             if (error)
             {
@@ -652,16 +1550,20 @@ void ClockWebServer::begin()
               String oldBgColor = config.getBackgroundColor();
               String newBgColor = doc["backgroundColor"].as<String>();
 
-              config.setBackgroundColor(newBgColor);
-              config.setTimeColor(doc["timeColor"].as<String>());
-              config.setTodColor(doc["todColor"].as<String>());
-              config.setSecondsColor(doc["secondsColor"].as<String>());
-              config.setDayOfWeekColor(doc["dayOfWeekColor"].as<String>());
-              config.setDateColor(doc["dateColor"].as<String>());
-              config.setTempColor(doc["tempColor"].as<String>());
-              config.setHumidityColor(doc["humidityColor"].as<String>());
-              config.setWeatherTempColor(doc["weatherTempColor"].as<String>());
-              config.setWeatherForecastColor(doc["weatherForecastColor"].as<String>());
+              {
+                // One theme rebuild and one snapshot for the whole palette.
+                ConfigManager::Transaction transaction(config);
+                config.setBackgroundColor(newBgColor);
+                config.setTimeColor(doc["timeColor"].as<String>());
+                config.setTodColor(doc["todColor"].as<String>());
+                config.setSecondsColor(doc["secondsColor"].as<String>());
+                config.setDayOfWeekColor(doc["dayOfWeekColor"].as<String>());
+                config.setDateColor(doc["dateColor"].as<String>());
+                config.setTempColor(doc["tempColor"].as<String>());
+                config.setHumidityColor(doc["humidityColor"].as<String>());
+                config.setWeatherTempColor(doc["weatherTempColor"].as<String>());
+                config.setWeatherForecastColor(doc["weatherForecastColor"].as<String>());
+              }
 
               if (oldBgColor != newBgColor)
               {
@@ -677,16 +1579,16 @@ void ClockWebServer::begin()
           }
         });
 
-    server.on("/api/display/reset", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
+    route("/api/display/reset", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
       auto &config = ConfigManager::getInstance();
       config.resetDisplayToDefaults();
       DisplayManager::getInstance().requestFullRefresh();
 
       request->send(200, "text/plain", "Display settings reset!"); });
 
-    server.on("/api/wifi/hostname", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
+    route("/api/wifi/hostname", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
         if (request->hasParam("hostname", true)) {
             String hostname = request->getParam("hostname", true)->value();
 
@@ -702,13 +1604,13 @@ void ClockWebServer::begin()
             request->send(400, "text/plain", "Hostname not provided.");
         } });
 
-    server.on("/reboot", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
+    route("/reboot", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
       request->send(200, "text/plain", "Rebooting...");
       request->onDisconnect([](){ ESP.restart(); }); });
 
-    server.on("/factory-reset", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
+    route("/factory-reset", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
       if (UpdateManager::getInstance().isUpdateInProgress())
       {
         request->send(409, "text/plain", "Update in progress. Cannot perform factory reset.");
@@ -720,8 +1622,8 @@ void ClockWebServer::begin()
         ESP.restart(); 
       }); });
 
-    server.on("/factory-reset-except-wifi", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
+    route("/factory-reset-except-wifi", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
       if (UpdateManager::getInstance().isUpdateInProgress())
       {
         request->send(409, "text/plain", "Update in progress. Cannot perform factory reset.");
@@ -733,11 +1635,17 @@ void ClockWebServer::begin()
         ESP.restart(); 
       }); });
 
-    server.on("/system", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send_P(200, "text/html", SYSTEM_PAGE_HTML, [this](const String &var)
-                                { return processor(var); }); });
+    route("/system", HTTP_GET, [this](AsyncWebServerRequest *request)
+          {
+#ifdef WEB_ASSETS_AVAILABLE
+            sendAsset(request, SYSTEM_PAGE_ASSET);
+#else
+            request->send_P(200, "text/html", SYSTEM_PAGE_HTML, [this](const String &var)
+                            { return processor(var); });
+#endif
+          });
 
-    server.on(
+    route(
         "/update", HTTP_POST,
         [](AsyncWebServerRequest *request)
         {
@@ -751,7 +1659,20 @@ void ClockWebServer::begin()
             request->send(409, "text/plain", "An update is already in progress.");
             return;
           }
-          UpdateManager::getInstance().handleFileUpload(data, len, index, request->contentLength());
+          // The detached signature comes as a header, or as a form field sent before the file.
+          String signature;
+          if (index == 0)
+          {
+            if (request->hasHeader("X-Firmware-Signature"))
+            {
+              signature = request->header("X-Firmware-Signature");
+            }
+            else if (request->hasParam("signature", true))
+            {
+              signature = request->getParam("signature", true)->value();
+            }
+          }
+          UpdateManager::getInstance().handleFileUpload(data, len, index, request->contentLength(), signature);
           if (final)
           {
             if (UpdateManager::getInstance().endUpdate())
@@ -762,39 +1683,34 @@ void ClockWebServer::begin()
             }
             else
             {
-              request->send(500, "text/plain", "Update failed. Check serial monitor for details.");
+              String error = UpdateManager::getInstance().getLastError();
+              request->send(500, "text/plain", error.isEmpty() ? String("Update failed. Check serial monitor for details.") : "Update failed: " + error);
             }
           }
         });
 
-    server.on("/api/update/github", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
+    route("/api/update/github", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
       String status = UpdateManager::getInstance().handleGithubUpdate();
       request->send(200, "text/plain", status); });
 
-    server.on("/api/update/status", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-      bool inProgress = UpdateManager::getInstance().isUpdateInProgress();
-      request->send(200, "application/json", String("{\"inProgress\":") + (inProgress ? "true" : "false") + "}"); });
+    route("/api/update/status", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      JsonDocument doc(JsonResponse::getInstance().allocator());
+      buildUpdateStatusJson(doc);
+      JsonResponse::getInstance().send(request, "/api/update/status", doc); });
 
-    server.on("/api/log/download", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-        if (!LittleFS.exists(SerialLog::getLogFilePath()))
-        {
-          request->send(404, "text/plain", "Log file not found");
-          return;
-        }
-        AsyncWebServerResponse *response = request->beginResponse(LittleFS, SerialLog::getLogFilePath(), "text/plain", true);
-        if (response == nullptr)
-        {
-          request->send(500, "text/plain", "Internal Server Error: Could not open log file");
-          return;
-        }
-        response->addHeader("Content-Disposition", "attachment; filename=\"system.log\"");
-        request->send(response); });
+    route("/api/log/download", HTTP_GET, [](AsyncWebServerRequest *request)
+          { sendLogDownload(request); });
 
-    server.on("/api/log/rotate", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
+    route("/api/log/crash", HTTP_GET, [](AsyncWebServerRequest *request)
+          {
+      JsonDocument doc(JsonResponse::getInstance().allocator());
+      buildCrashLogJson(doc);
+      JsonResponse::getInstance().send(request, "/api/log/crash", doc); });
+
+    route("/api/log/rotate", HTTP_POST, [](AsyncWebServerRequest *request)
+          {
       SerialLog::getInstance().rotate();
       request->send(200, "text/plain", "Log rotated successfully."); });
 
@@ -802,33 +1718,80 @@ void ClockWebServer::begin()
   }
 
   // This route is shared between normal and captive portal modes.
-  server.on("/wifi/save", HTTP_POST, [this](AsyncWebServerRequest *request)
-            { onWifiSaveRequest(request); });
+  route("/wifi/save", HTTP_POST, [this](AsyncWebServerRequest *request)
+        { onWifiSaveRequest(request); });
 
-  server.on("/wifi/test", HTTP_POST, [this](AsyncWebServerRequest *request)
-            { onWifiTestRequest(request); });
+  route("/wifi/test", HTTP_POST, [this](AsyncWebServerRequest *request)
+        { onWifiTestRequest(request); });
 
-  server.on("/wifi/status", HTTP_GET, [this](AsyncWebServerRequest *request)
-            { onWifiStatusRequest(request); });
+  route("/wifi/status", HTTP_GET, [this](AsyncWebServerRequest *request)
+        { onWifiStatusRequest(request); });
 
-  server.on("/api/wifi/scan", HTTP_GET, [](AsyncWebServerRequest *request)
-            {
+  route("/api/wifi/scan", HTTP_GET, [](AsyncWebServerRequest *request)
+        {
     auto &wifiManager = WiFiManager::getInstance();
-    if (request->hasParam("start") && request->getParam("start")->value() == "true")
+    if (request->hasParam("start") && request->getParam("start")->value() == "true" && wifiManager.startScan())
     {
-      wifiManager.startScan();
       // Immediately return a scanning status
       request->send(200, "application/json", "{\"status\":\"scanning\"}");
     }
     else
     {
-      String json = wifiManager.getScanResults();
-      request->send(200, "application/json", json);
+      // Polls, and scans asked for while the last is fresh, share one serialized copy.
+      uint32_t generation = wifiManager.pollScan();
+      JsonResponse::getInstance().sendCached(request, "/api/wifi/scan", generation, [](JsonDocument &doc)
+                                             { WiFiManager::getInstance().getScanResults(doc); });
     } });
 
   server.begin();
 }
 
+/**
+ * @brief Pushes changed device state to `/api/events` subscribers.
+ *
+ * Every topic whose generation key moved since it was last sent is rebuilt
+ * and sent to all clients, with a rising event ID. A newly connected client
+ * triggers a resend of every topic so it starts from a full snapshot.
+ */
+void ClockWebServer::publishEvents()
+{
+  static_assert(sizeof(eventTopics) / sizeof(eventTopics[0]) == EVENT_TOPIC_COUNT, "EVENT_TOPIC_COUNT is out of date");
+
+  unsigned long now = millis();
+  if (_captivePortalActive || now - _lastEventPoll < EVENTS_POLL_INTERVAL)
+  {
+    return;
+  }
+  _lastEventPoll = now;
+  if (events.count() == 0)
+  {
+    return;
+  }
+
+  bool resync = _eventsResync;
+  _eventsResync = false;
+  for (int i = 0; i < EVENT_TOPIC_COUNT; i++)
+  {
+    const EventTopic &topic = eventTopics[i];
+    uint64_t key = topic.key();
+    if (!resync && key == _eventKeys[i])
+    {
+      continue;
+    }
+    _eventKeys[i] = key;
+
+    JsonDocument doc(JsonResponse::getInstance().allocator());
+    topic.build(doc);
+    if (measureJson(doc) >= sizeof(_eventBuffer))
+    {
+      LOG_W(LOG_MODULE_WEB, "Events: '%s' payload does not fit in %u bytes.\n", topic.name, (unsigned)sizeof(_eventBuffer));
+      continue;
+    }
+    serializeJson(doc, _eventBuffer, sizeof(_eventBuffer));
+    events.send(_eventBuffer, topic.name, ++_eventId);
+  }
+}
+
 /**
  * @brief Handles requests to the root URL ("/").
  * Serves the main index page.
@@ -836,8 +1799,13 @@ void ClockWebServer::begin()
  */
 void ClockWebServer::onRootRequest(AsyncWebServerRequest *request)
 {
+#ifdef WEB_ASSETS_AVAILABLE
+  sendTemplate(request, INDEX_PAGE_TEMPLATE, [this](const String &var)
+               { return processor(var); });
+#else
   request->send_P(200, "text/html", INDEX_HTML, [this](const String &var)
                   { return processor(var); });
+#endif
 }
 
 /**
@@ -846,8 +1814,13 @@ void ClockWebServer::onRootRequest(AsyncWebServerRequest *request)
  */
 void ClockWebServer::onWifiRequest(AsyncWebServerRequest *request)
 {
+#ifdef WEB_ASSETS_AVAILABLE
+  sendTemplate(request, WIFI_CONFIG_PAGE_TEMPLATE, [this](const String &var)
+               { return processor(var); });
+#else
   request->send_P(200, "text/html", WIFI_CONFIG_HTML, [this](const String &var)
                   { return processor(var); });
+#endif
 }
 
 /**
@@ -856,8 +1829,13 @@ void ClockWebServer::onWifiRequest(AsyncWebServerRequest *request)
  */
 void ClockWebServer::onSettingsRequest(AsyncWebServerRequest *request)
 {
+#ifdef WEB_ASSETS_AVAILABLE
+  sendTemplate(request, SETTINGS_PAGE_TEMPLATE, [this](const String &var)
+               { return settingsProcessor(var); });
+#else
   request->send_P(200, "text/html", SETTINGS_PAGE_HTML, [this](const String &var)
                   { return settingsProcessor(var); });
+#endif
 }
 
 /**
@@ -866,8 +1844,12 @@ void ClockWebServer::onSettingsRequest(AsyncWebServerRequest *request)
  */
 void ClockWebServer::onAlarmsRequest(AsyncWebServerRequest *request)
 {
+#ifdef WEB_ASSETS_AVAILABLE
+  sendAsset(request, ALARMS_PAGE_ASSET);
+#else
   request->send_P(200, "text/html", ALARMS_PAGE_HTML, [this](const String &var)
                   { return processor(var); });
+#endif
 }
 
 /**
@@ -969,7 +1951,230 @@ void ClockWebServer::onWifiStatusRequest(AsyncWebServerRequest *request)
  */
 void ClockWebServer::onCaptivePortalRequest(AsyncWebServerRequest *request)
 {
+#ifdef WEB_ASSETS_AVAILABLE
+  sendAsset(request, SIMPLE_WIFI_SETUP_PAGE_ASSET);
+#else
   request->send_P(200, "text/html", SIMPLE_WIFI_SETUP_HTML);
+#endif
+}
+
+/**
+ * @brief Sends a pre-compressed asset, or 304 if the client's copy is current.
+ *
+ * The body is written straight from flash with `Content-Encoding: gzip`, so
+ * it never passes through the template processor or RAM.
+ * @param request The incoming web request.
+ * @param asset The asset to send.
+ */
+void ClockWebServer::sendAsset(AsyncWebServerRequest *request, const WebAsset &asset)
+{
+  if (request->hasHeader("If-None-Match") &&
+      request->getHeader("If-None-Match")->value().indexOf(asset.etag) >= 0)
+  {
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", WEB_ASSET_CACHE_CONTROL);
+    request->send(response);
+    return;
+  }
+
+  AsyncWebServerResponse *response = request->beginResponse_P(200, asset.contentType, asset.data, asset.length);
+  response->addHeader("Content-Encoding", "gzip");
+  response->addHeader("ETag", asset.etag);
+  response->addHeader("Cache-Control", WEB_ASSET_CACHE_CONTROL);
+  request->send(response);
+}
+
+/**
+ * @brief Tracks how far a chunked template response has got.
+ */
+struct TemplateStream
+{
+  const PageTemplate *page;
+  size_t segment = 0;    ///< Index of the segment being sent.
+  size_t textOffset = 0; ///< Offset of that segment's literal chunk in `page->text`.
+  size_t sent = 0;       ///< Bytes of the current chunk or value already sent.
+  bool inValue = false;  ///< True once the chunk is done and the placeholder value is being sent.
+  String value;          ///< The current placeholder's value.
+};
+
+/**
+ * @brief Streams a precompiled page template as a chunked response.
+ *
+ * Literal chunks are copied straight from flash. The resolver is only called
+ * once per placeholder, when the stream reaches it, so the page is never
+ * scanned for `%` and only the dynamic values are held in RAM.
+ * @param request The incoming web request.
+ * @param page The page's segment table.
+ * @param resolve Returns the value of a placeholder.
+ */
+void ClockWebServer::sendTemplate(AsyncWebServerRequest *request, const PageTemplate &page, AwsTemplateProcessor resolve)
+{
+  std::shared_ptr<TemplateStream> stream = std::make_shared<TemplateStream>();
+  stream->page = &page;
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      page.contentType, [stream, resolve](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+      {
+        const PageTemplate &tpl = *stream->page;
+        size_t written = 0;
+        while (written < maxLen && stream->segment < tpl.count)
+        {
+          const PageSegment &segment = tpl.segments[stream->segment];
+          if (!stream->inValue)
+          {
+            size_t n = min(maxLen - written, (size_t)segment.length - stream->sent);
+            memcpy_P(buffer + written, tpl.text + stream->textOffset + stream->sent, n);
+            written += n;
+            stream->sent += n;
+            if (stream->sent < segment.length)
+            {
+              break;
+            }
+            stream->textOffset += segment.length;
+            stream->sent = 0;
+            if (segment.var == nullptr)
+            {
+              stream->segment++;
+              continue;
+            }
+            stream->value = resolve(String(segment.var));
+            stream->inValue = true;
+          }
+
+          size_t n = min(maxLen - written, (size_t)stream->value.length() - stream->sent);
+          memcpy(buffer + written, stream->value.c_str() + stream->sent, n);
+          written += n;
+          stream->sent += n;
+          if (stream->sent < stream->value.length())
+          {
+            break;
+          }
+          stream->inValue = false;
+          stream->sent = 0;
+          stream->value = String();
+          stream->segment++;
+        }
+        return written; });
+  request->send(response);
+}
+
+/**
+ * @brief Sends the reply for a request its route class has no room for.
+ */
+static void rejectBusy(AsyncWebServerRequest *request)
+{
+  AsyncWebServerResponse *response = request->beginResponse(503, "text/plain", "Server busy, try again");
+  response->addHeader("Retry-After", "1");
+  request->send(response);
+}
+
+/**
+ * @brief Admits a request and arranges for its admission, or its rejection, to end with the connection.
+ * @return False if the request was turned away with 503.
+ */
+static bool admitRequest(AsyncWebServerRequest *request, int route)
+{
+  HttpAdmission &admission = HttpAdmission::getInstance();
+  if (admission.isAdmitted(request))
+  {
+    return true;
+  }
+  // A request holds a single disconnect callback, so the body pool is released here too.
+  request->onDisconnect([request]()
+                        {
+    RequestBodyPool::getInstance().release(request);
+    HttpAdmission::getInstance().finish(request); });
+  if (!admission.admit(request, route))
+  {
+    rejectBusy(request);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Registers a route behind admission control and latency tracking.
+ *
+ * Requests are admitted on their first callback: the first body or upload
+ * chunk for routes that take one, the request callback otherwise. Every
+ * callback of an admitted request is timed; callbacks of a rejected request
+ * are skipped. A request that reaches the request callback of such a route
+ * without its body or upload handler having run is admitted there and
+ * answered: an empty body goes to the body handler, which refuses it with
+ * 411, and anything else gets 400.
+ */
+void ClockWebServer::route(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                           ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody)
+{
+  int id = HttpAdmission::getInstance().addRoute(uri, HttpAdmission::classify(uri, method));
+  if (id < 0)
+  {
+    server.on(uri, method, onRequest, onUpload, onBody);
+    return;
+  }
+  bool streamed = onUpload != nullptr || onBody != nullptr;
+
+  ArRequestHandlerFunction requestFn = [id, streamed, onRequest, onBody](AsyncWebServerRequest *request)
+  {
+    HttpAdmission &admission = HttpAdmission::getInstance();
+    if (admission.isRejected(request))
+    {
+      return; // Already answered with 503.
+    }
+    bool unstreamed = streamed && !admission.isAdmitted(request);
+    if (!admitRequest(request, id))
+    {
+      return;
+    }
+    admission.beginCallback();
+    if (unstreamed)
+    {
+      // No body or upload chunk reached the route's handlers, so nothing has answered yet.
+      if (onBody != nullptr && request->contentLength() == 0)
+      {
+        onBody(request, nullptr, 0, 0, 0);
+      }
+      else
+      {
+        request->send(400, "text/plain", onBody != nullptr ? "Unsupported request body" : "Missing file upload");
+      }
+    }
+    onRequest(request);
+    admission.endCallback(request);
+  };
+
+  ArUploadHandlerFunction uploadFn = nullptr;
+  if (onUpload != nullptr)
+  {
+    uploadFn = [id, onUpload](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+    {
+      if (index == 0 ? !admitRequest(request, id) : !HttpAdmission::getInstance().isAdmitted(request))
+      {
+        return;
+      }
+      HttpAdmission::getInstance().beginCallback();
+      onUpload(request, filename, index, data, len, final);
+      HttpAdmission::getInstance().endCallback(request);
+    };
+  }
+
+  ArBodyHandlerFunction bodyFn = nullptr;
+  if (onBody != nullptr)
+  {
+    bodyFn = [id, onBody](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+    {
+      if (index == 0 ? !admitRequest(request, id) : !HttpAdmission::getInstance().isAdmitted(request))
+      {
+        return;
+      }
+      HttpAdmission::getInstance().beginCallback();
+      onBody(request, data, len, index, total);
+      HttpAdmission::getInstance().endCallback(request);
+    };
+  }
+
+  server.on(uri, method, requestFn, uploadFn, bodyFn);
 }
 
 /**
@@ -1040,12 +2245,12 @@ void ClockWebServer::setupMDNS()
   String hostname = WiFiManager::getInstance().getHostname();
   if (MDNS.begin(hostname.c_str()))
   {
-    SerialLog::getInstance().print("mDNS responder started\n");
+    LOG_I(LOG_MODULE_WEB, "mDNS responder started\n");
     MDNS.addService("http", "tcp", 80); // Advertise the web server
   }
   else
   {
-    SerialLog::getInstance().print("Error starting mDNS!\n");
+    LOG_E(LOG_MODULE_WEB, "Error starting mDNS!\n");
   }
 }
 
@@ -1210,6 +2415,8 @@ String ClockWebServer::settingsProcessor(const String &var)
     return config.getDefaultPage() == 1 ? "selected" : "";
   if (var == "DEFAULT_PAGE_SELECTED_3")
     return config.getDefaultPage() == 3 ? "selected" : "";
+  if (var == "DEFAULT_PAGE_SELECTED_4")
+    return config.getDefaultPage() == 4 ? "selected" : "";
 
   // Timezone selections
   String timezone = config.getTimezone();
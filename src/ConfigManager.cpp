@@ -15,13 +15,150 @@
 #include "Constants.h"
 #include "LockGuard.h"
 #include "UpdateManager.h"
+#include "GeocodingCache.h"
+#include "Utils.h"
+#include <esp_timer.h>
+#include <esp_rom_crc.h>
+#include <algorithm>
+
+/// @brief The ConfigChange category of each ConfigField, in ConfigField order.
+static const uint16_t FIELD_CHANGES[] = {
+    CONFIG_CHANGE_NETWORK,          // WIFI_SSID
+    CONFIG_CHANGE_NETWORK,          // WIFI_PASSWORD
+    CONFIG_CHANGE_NETWORK,          // HOSTNAME
+    CONFIG_CHANGE_NETWORK,          // WIFI_CREDS_VALID
+    CONFIG_CHANGE_OTHER,            // RINGING_ALARM
+    CONFIG_CHANGE_BRIGHTNESS,       // AUTO_BRIGHTNESS
+    CONFIG_CHANGE_BRIGHTNESS,       // BRIGHTNESS
+    CONFIG_CHANGE_BRIGHTNESS,       // AUTO_BRIGHTNESS_START_HOUR
+    CONFIG_CHANGE_BRIGHTNESS,       // AUTO_BRIGHTNESS_END_HOUR
+    CONFIG_CHANGE_BRIGHTNESS,       // DAY_BRIGHTNESS
+    CONFIG_CHANGE_BRIGHTNESS,       // NIGHT_BRIGHTNESS
+    CONFIG_CHANGE_FORMAT,           // USE_24_HOUR_FORMAT
+    CONFIG_CHANGE_FORMAT,           // USE_CELSIUS
+    CONFIG_CHANGE_LAYOUT,           // SCREEN_FLIPPED
+    CONFIG_CHANGE_LAYOUT,           // INVERT_COLORS
+    CONFIG_CHANGE_TIMEZONE,         // TIMEZONE
+    CONFIG_CHANGE_TIMEZONE,         // IS_DST
+    CONFIG_CHANGE_OTHER,            // SNOOZE_DURATION
+    CONFIG_CHANGE_OTHER,            // DISMISS_DURATION
+    CONFIG_CHANGE_OTHER,            // TEMP_CORRECTION_ENABLED
+    CONFIG_CHANGE_OTHER,            // TEMP_CORRECTION
+    CONFIG_CHANGE_OTHER,            // LOG_LEVELS
+    CONFIG_CHANGE_WEATHER_LOCATION, // ADDRESS
+    CONFIG_CHANGE_LAYOUT,           // ENABLED_PAGES
+    CONFIG_CHANGE_LAYOUT,           // DEFAULT_PAGE
+    CONFIG_CHANGE_WEATHER_LOCATION, // LAT
+    CONFIG_CHANGE_WEATHER_LOCATION, // LON
+    CONFIG_CHANGE_THEME,            // BACKGROUND_COLOR
+    CONFIG_CHANGE_THEME,            // TIME_COLOR
+    CONFIG_CHANGE_THEME,            // TOD_COLOR
+    CONFIG_CHANGE_THEME,            // SECONDS_COLOR
+    CONFIG_CHANGE_THEME,            // DAY_OF_WEEK_COLOR
+    CONFIG_CHANGE_THEME,            // DATE_COLOR
+    CONFIG_CHANGE_THEME,            // TEMP_COLOR
+    CONFIG_CHANGE_THEME,            // HUMIDITY_COLOR
+    CONFIG_CHANGE_THEME,            // ALARM_ICON_COLOR
+    CONFIG_CHANGE_THEME,            // SNOOZE_ICON_COLOR
+    CONFIG_CHANGE_THEME,            // ALARM_TEXT_COLOR
+    CONFIG_CHANGE_THEME,            // ERROR_TEXT_COLOR
+    CONFIG_CHANGE_THEME,            // WEATHER_TEMP_COLOR
+    CONFIG_CHANGE_THEME,            // WEATHER_FORECAST_COLOR
+    CONFIG_CHANGE_ALARMS,           // ALARMS
+};
+static_assert(sizeof(FIELD_CHANGES) / sizeof(FIELD_CHANGES[0]) == CONFIG_FIELD_COUNT, "FIELD_CHANGES needs one entry per ConfigField");
+
+// --- Settings blob ---
+// Every setting except the ringing alarm state and the alarm table is kept
+// under one NVS key: a BlobHeader, a BlobSettings, then the string settings
+// as NUL-terminated entries in BLOB_STRINGS order. Bump CONFIG_BLOB_VERSION
+// whenever that layout changes; a blob of another version is ignored.
+#define CONFIG_BLOB_KEY "settings"
+#define CONFIG_BLOB_MAGIC 0xC5E7
+#define CONFIG_BLOB_VERSION 1
+#define CONFIG_BLOB_MAX_PAGES 8
+#define CONFIG_BLOB_LOG_LEVELS 16
+
+/// @brief The ConfigFields stored in the blob.
+static constexpr uint64_t BLOB_FIELDS = ((1ULL << CONFIG_FIELD_COUNT) - 1) & ~(1ULL << CONFIG_FIELD_RINGING_ALARM) & ~(1ULL << CONFIG_FIELD_ALARMS);
+
+struct BlobHeader
+{
+  uint16_t magic;
+  uint16_t version;
+  uint32_t length; ///< Bytes in the whole blob, header included.
+  uint32_t crc;    ///< CRC-32 of everything after the header.
+};
+
+struct BlobSettings
+{
+  uint8_t wifiCredsValid;
+  uint8_t autoBrightness;
+  uint8_t brightness;
+  uint8_t autoBrightnessStartHour;
+  uint8_t autoBrightnessEndHour;
+  uint8_t dayBrightness;
+  uint8_t nightBrightness;
+  uint8_t use24HourFormat;
+  uint8_t useCelsius;
+  uint8_t screenFlipped;
+  uint8_t invertColors;
+  uint8_t isDst;
+  uint8_t snoozeDuration;
+  uint8_t dismissDuration;
+  uint8_t tempCorrectionEnabled;
+  uint8_t pageCount;
+  uint8_t logLevels[CONFIG_BLOB_LOG_LEVELS];
+  int8_t pages[CONFIG_BLOB_MAX_PAGES];
+  int32_t defaultPage;
+  float tempCorrection;
+  float lat;
+  float lon;
+};
+
+static_assert(LOG_MODULE_COUNT <= CONFIG_BLOB_LOG_LEVELS, "Log levels no longer fit the settings blob");
+
+/// @brief The string settings, in the order they follow BlobSettings.
+String ConfigManager::*const ConfigManager::BLOB_STRINGS[] = {
+    &ConfigManager::wifiSSID,
+    &ConfigManager::wifiPassword,
+    &ConfigManager::hostname,
+    &ConfigManager::timezone,
+    &ConfigManager::address,
+    &ConfigManager::backgroundColor,
+    &ConfigManager::timeColor,
+    &ConfigManager::todColor,
+    &ConfigManager::secondsColor,
+    &ConfigManager::dayOfWeekColor,
+    &ConfigManager::dateColor,
+    &ConfigManager::tempColor,
+    &ConfigManager::humidityColor,
+    &ConfigManager::alarmIconColor,
+    &ConfigManager::snoozeIconColor,
+    &ConfigManager::alarmTextColor,
+    &ConfigManager::errorTextColor,
+    &ConfigManager::weatherTempColor,
+    &ConfigManager::weatherForecastColor,
+};
+
+/// @brief The per-setting keys of earlier firmware, removed once the blob is written.
+static const char *const LEGACY_KEYS[] = {
+    "wifiSSID", "wifiPass", "hostname", "wifiValid", "autoBright", "brightness",
+    "autoBrStartHr", "autoBrEndHr", "dayBright", "nightBright", "is24Hour", "useCelsius",
+    "screenFlip", "invertColors", "timezone", "isDst", "snoozeDur", "dismissDur",
+    "tempCorrEn", "tempCorr", "logLevels", "address", "zipCode", "pageOrder",
+    "defaultPage", "lat", "lon", "bgClr", "timeClr", "todClr", "secondsClr",
+    "dayOfWeekClr", "dateClr", "tempClr", "humidityClr", "alarmIconClr", "snzIconClr",
+    "alarmTextClr", "errorTextClr", "weaTempClr", "weaFcstClr"};
 
 /**
  * @brief Private constructor to enforce the singleton pattern.
  */
-ConfigManager::ConfigManager() : _isDirty(false), _savePending(false), _saveDebounceTimer(0), _nextAlarmId(0)
+ConfigManager::ConfigManager() : _themeGeneration(0), _savePending(false), _saveDebounceTimer(0), _nextAlarmId(0)
 {
   _mutex = xSemaphoreCreateRecursiveMutex();
+  rebuildTheme();
+  alarmsChanged();
 }
 
 /**
@@ -60,8 +197,15 @@ void ConfigManager::loop()
 void ConfigManager::scheduleSave()
 {
   RecursiveLockGuard lock(_mutex);
+  if (_transactionDepth > 0)
+  {
+    _transactionSave = true;
+    return;
+  }
   _savePending = true;
   _saveDebounceTimer = millis();
+  _generation++;
+  publishSnapshot();
 }
 
 /**
@@ -111,6 +255,8 @@ void ConfigManager::setDefaults()
   dismissDuration = DEFAULT_DISMISS_DURATION;
   tempCorrectionEnabled = DEFAULT_TEMP_CORRECTION_ENABLED;
   tempCorrection = DEFAULT_TEMP_CORRECTION;
+  memset(logLevels, DEFAULT_LOG_LEVEL, sizeof(logLevels));
+  applyLogLevels();
   address = DEFAULT_ADDRESS;
   enabledPages.assign(std::begin(DEFAULT_ENABLED_PAGES), std::end(DEFAULT_ENABLED_PAGES));
   defaultPage = DEFAULT_DEFAULT_PAGE;
@@ -131,6 +277,7 @@ void ConfigManager::setDefaults()
   errorTextColor = DEFAULT_ERROR_TEXT_COLOR;
   weatherTempColor = DEFAULT_WEATHER_TEMP_COLOR;
   weatherForecastColor = DEFAULT_WEATHER_FORECAST_COLOR;
+  rebuildTheme();
 
   _alarms.clear();
   for (int i = 0; i < DEFAULT_ALARMS_COUNT; ++i)
@@ -140,8 +287,15 @@ void ConfigManager::setDefaults()
     _alarms.push_back(alarm);
   }
   _nextAlarmId = DEFAULT_ALARMS_COUNT;
+  alarmsChanged();
+
+  // Everything is rewritten, including the whole alarm table.
+  _dirtyFields = ~0ULL;
+  noteChanges(CONFIG_CHANGE_ALL);
+  _savedAlarms.clear();
+  _savedNextAlarmId = -1;
 
-  SerialLog::getInstance().print("Loaded default configuration.");
+  LOG_I(LOG_MODULE_CONFIG, "Loaded default configuration.");
 }
 
 /**
@@ -149,94 +303,47 @@ void ConfigManager::setDefaults()
  *
  * Checks for a "first boot" flag. If it's the first time the device has
  * run, it loads the default settings and saves them. Otherwise, it reads
- * each configuration value from flash memory.
+ * the settings blob, falling back once to the per-key format of earlier
+ * firmware, which is then migrated to the blob. How long this took is kept
+ * for getLoadStats().
  */
 void ConfigManager::load()
 {
+  // Readers see the loaded settings, and any migrations, all at once.
+  Transaction transaction(*this);
+  int64_t startUs = esp_timer_get_time();
+
   // Check if this is the first boot
   bool firstBoot = !_preferences.getBool("firstBootDone", false);
   if (firstBoot)
   {
-    SerialLog::getInstance().print("First boot detected. Loading default configuration.");
+    LOG_I(LOG_MODULE_CONFIG, "First boot detected. Loading default configuration.");
     setDefaults();
     save(); // Save defaults to preferences
     _preferences.putBool("firstBootDone", true);
+    _loadStats = {(uint32_t)(esp_timer_get_time() - startUs), CONFIG_LOAD_DEFAULTS};
     return;
   }
 
-  SerialLog::getInstance().print("Loading configuration from Preferences...");
+  LOG_D(LOG_MODULE_CONFIG, "Loading configuration from Preferences...");
 
   RecursiveLockGuard lock(_mutex);
-  // Load each setting from the Preferences
-  wifiSSID = _preferences.getString("wifiSSID", DEFAULT_WIFI_SSID);
-  wifiPassword = _preferences.getString("wifiPass", DEFAULT_WIFI_PASSWORD);
-  hostname = _preferences.getString("hostname", DEFAULT_HOSTNAME);
-  wifiCredsValid = _preferences.getBool("wifiValid", DEFAULT_WIFI_CREDS_VALID);
   ringingAlarmId = _preferences.getChar("ringAlarmId", DEFAULT_RINGING_ALARM_ID);
   ringingAlarmStartTimestamp = _preferences.getUInt("ringAlarmTS", DEFAULT_RINGING_ALARM_TIMESTAMP);
-  autoBrightness = _preferences.getBool("autoBright", DEFAULT_AUTO_BRIGHTNESS);
-  brightness = _preferences.getUChar("brightness", DEFAULT_BRIGHTNESS);
-  autoBrightnessStartHour = _preferences.getUChar("autoBrStartHr", DEFAULT_AUTO_BRIGHTNESS_START_HOUR);
-  autoBrightnessEndHour = _preferences.getUChar("autoBrEndHr", DEFAULT_AUTO_BRIGHTNESS_END_HOUR);
-  dayBrightness = _preferences.getUChar("dayBright", DEFAULT_DAY_BRIGHTNESS);
-  nightBrightness = _preferences.getUChar("nightBright", DEFAULT_NIGHT_BRIGHTNESS);
-  use24HourFormat = _preferences.getBool("is24Hour", DEFAULT_USE_24_HOUR_FORMAT);
-  useCelsius = _preferences.getBool("useCelsius", DEFAULT_USE_CELSIUS);
-  screenFlipped = _preferences.getBool("screenFlip", DEFAULT_SCREEN_FLIPPED);
-  invertColors = _preferences.getBool("invertColors", DEFAULT_INVERT_COLORS);
-  timezone = _preferences.getString("timezone", DEFAULT_TIMEZONE);
-  setenv("TZ", timezone.c_str(), 1);
-  tzset();
-  isDst = _preferences.getBool("isDst", DEFAULT_IS_DST);
-  snoozeDuration = _preferences.getUChar("snoozeDur", DEFAULT_SNOOZE_DURATION);
-  dismissDuration = _preferences.getUChar("dismissDur", DEFAULT_DISMISS_DURATION);
-  tempCorrectionEnabled = _preferences.getBool("tempCorrEn", DEFAULT_TEMP_CORRECTION_ENABLED);
-  tempCorrection = _preferences.getFloat("tempCorr", DEFAULT_TEMP_CORRECTION);
 
-  // Try to load address, fall back to zipCode for migration
-  address = _preferences.getString("address", "");
-  if (address.isEmpty())
+  ConfigLoadSource source = CONFIG_LOAD_BLOB;
+  if (!loadBlob())
   {
-    address = _preferences.getString("zipCode", DEFAULT_ADDRESS);
+    // Firmware before the blob, or a blob that failed its checks.
+    LOG_I(LOG_MODULE_CONFIG, "No valid settings blob, reading per-key settings.");
+    loadKeys();
+    source = CONFIG_LOAD_KEYS;
+    _dirtyFields |= BLOB_FIELDS; // Written as a blob on the next save, which drops the keys.
+    _legacyKeysPresent = true;
   }
-
-  String pagesStr = _preferences.getString("pageOrder", "");
-  enabledPages.clear();
-  if (pagesStr.length() > 0)
-  {
-    int start = 0;
-    int end = pagesStr.indexOf(',');
-    while (end != -1)
-    {
-      enabledPages.push_back(pagesStr.substring(start, end).toInt());
-      start = end + 1;
-      end = pagesStr.indexOf(',', start);
-    }
-    enabledPages.push_back(pagesStr.substring(start).toInt());
-  }
-  else
-  {
-    enabledPages.assign(std::begin(DEFAULT_ENABLED_PAGES), std::end(DEFAULT_ENABLED_PAGES));
-  }
-
-  defaultPage = _preferences.getInt("defaultPage", DEFAULT_DEFAULT_PAGE);
-  lat = _preferences.getFloat("lat", DEFAULT_LAT);
-  lon = _preferences.getFloat("lon", DEFAULT_LON);
-
-  backgroundColor = _preferences.getString("bgClr", DEFAULT_BACKGROUND_COLOR);
-  timeColor = _preferences.getString("timeClr", DEFAULT_TIME_COLOR);
-  todColor = _preferences.getString("todClr", DEFAULT_TOD_COLOR);
-  secondsColor = _preferences.getString("secondsClr", DEFAULT_SECONDS_COLOR);
-  dayOfWeekColor = _preferences.getString("dayOfWeekClr", DEFAULT_DAY_OF_WEEK_COLOR);
-  dateColor = _preferences.getString("dateClr", DEFAULT_DATE_COLOR);
-  tempColor = _preferences.getString("tempClr", DEFAULT_TEMP_COLOR);
-  humidityColor = _preferences.getString("humidityClr", DEFAULT_HUMIDITY_COLOR);
-  alarmIconColor = _preferences.getString("alarmIconClr", DEFAULT_ALARM_ICON_COLOR);
-  snoozeIconColor = _preferences.getString("snzIconClr", DEFAULT_SNOOZE_ICON_COLOR);
-  alarmTextColor = _preferences.getString("alarmTextClr", DEFAULT_ALARM_TEXT_COLOR);
-  errorTextColor = _preferences.getString("errorTextClr", DEFAULT_ERROR_TEXT_COLOR);
-  weatherTempColor = _preferences.getString("weaTempClr", DEFAULT_WEATHER_TEMP_COLOR);
-  weatherForecastColor = _preferences.getString("weaFcstClr", DEFAULT_WEATHER_FORECAST_COLOR);
+  setenv("TZ", timezone.c_str(), 1);
+  tzset();
+  applyLogLevels();
 
   // Validate colors to prevent issues with URL-encoded values
   if (backgroundColor.startsWith("%"))
@@ -267,6 +374,7 @@ void ConfigManager::load()
     weatherTempColor = DEFAULT_WEATHER_TEMP_COLOR;
   if (weatherForecastColor.startsWith("%"))
     weatherForecastColor = DEFAULT_WEATHER_FORECAST_COLOR;
+  rebuildTheme();
 
   // Load alarms
   _alarms.clear();
@@ -298,6 +406,7 @@ void ConfigManager::load()
       _alarms.push_back(alarm);
     }
     _nextAlarmId = LEGACY_ALARMS_COUNT;
+    markDirty(CONFIG_FIELD_ALARMS);
   }
   else
   {
@@ -324,21 +433,279 @@ void ConfigManager::load()
       alarm.setSnoozeState(snoozed, snoozeUntil);
       snprintf(key, sizeof(key), "a_%d_lastDis", i);
       alarm.setLastDismissedDay(_preferences.getUChar(key, 8));
+      snprintf(key, sizeof(key), "a_%d_pat", i);
+      if (_preferences.isKey(key))
+      {
+        BuzzerPattern pattern;
+        size_t length = _preferences.getBytesLength(key);
+        if (length <= sizeof(pattern.stepsMs))
+        {
+          _preferences.getBytes(key, pattern.stepsMs, length);
+          pattern.count = length / sizeof(pattern.stepsMs[0]);
+        }
+        if (pattern.isValid())
+        {
+          alarm.setBuzzerPattern(pattern);
+        }
+      }
       _alarms.push_back(alarm);
     }
+    _savedAlarms = _alarms;
+    _savedNextAlarmId = _nextAlarmId;
+  }
+  alarmsChanged();
+  publishSnapshot();
+  if (_dirtyFields != 0)
+  {
+    // Persist what was migrated from older firmware.
+    scheduleSave();
+  }
+
+  _loadStats = {(uint32_t)(esp_timer_get_time() - startUs), source};
+  LOG_I(LOG_MODULE_CONFIG, "Configuration loaded successfully.");
+}
+
+/**
+ * @brief Reads the settings from the one-key-per-setting format of earlier firmware.
+ *
+ * Also migrates the older `zipCode` key to `address`.
+ */
+void ConfigManager::loadKeys()
+{
+  wifiSSID = _preferences.getString("wifiSSID", DEFAULT_WIFI_SSID);
+  wifiPassword = _preferences.getString("wifiPass", DEFAULT_WIFI_PASSWORD);
+  hostname = _preferences.getString("hostname", DEFAULT_HOSTNAME);
+  wifiCredsValid = _preferences.getBool("wifiValid", DEFAULT_WIFI_CREDS_VALID);
+  autoBrightness = _preferences.getBool("autoBright", DEFAULT_AUTO_BRIGHTNESS);
+  brightness = _preferences.getUChar("brightness", DEFAULT_BRIGHTNESS);
+  autoBrightnessStartHour = _preferences.getUChar("autoBrStartHr", DEFAULT_AUTO_BRIGHTNESS_START_HOUR);
+  autoBrightnessEndHour = _preferences.getUChar("autoBrEndHr", DEFAULT_AUTO_BRIGHTNESS_END_HOUR);
+  dayBrightness = _preferences.getUChar("dayBright", DEFAULT_DAY_BRIGHTNESS);
+  nightBrightness = _preferences.getUChar("nightBright", DEFAULT_NIGHT_BRIGHTNESS);
+  use24HourFormat = _preferences.getBool("is24Hour", DEFAULT_USE_24_HOUR_FORMAT);
+  useCelsius = _preferences.getBool("useCelsius", DEFAULT_USE_CELSIUS);
+  screenFlipped = _preferences.getBool("screenFlip", DEFAULT_SCREEN_FLIPPED);
+  invertColors = _preferences.getBool("invertColors", DEFAULT_INVERT_COLORS);
+  timezone = _preferences.getString("timezone", DEFAULT_TIMEZONE);
+  isDst = _preferences.getBool("isDst", DEFAULT_IS_DST);
+  snoozeDuration = _preferences.getUChar("snoozeDur", DEFAULT_SNOOZE_DURATION);
+  dismissDuration = _preferences.getUChar("dismissDur", DEFAULT_DISMISS_DURATION);
+  tempCorrectionEnabled = _preferences.getBool("tempCorrEn", DEFAULT_TEMP_CORRECTION_ENABLED);
+  tempCorrection = _preferences.getFloat("tempCorr", DEFAULT_TEMP_CORRECTION);
+  if (!_preferences.isKey("logLevels") || _preferences.getBytes("logLevels", logLevels, sizeof(logLevels)) != sizeof(logLevels))
+  {
+    memset(logLevels, DEFAULT_LOG_LEVEL, sizeof(logLevels));
+  }
+
+  // Try to load address, fall back to zipCode for migration
+  address = _preferences.getString("address", "");
+  if (address.isEmpty())
+  {
+    address = _preferences.getString("zipCode", DEFAULT_ADDRESS);
+    if (!address.isEmpty())
+    {
+      markDirty(CONFIG_FIELD_ADDRESS);
+    }
   }
 
-  SerialLog::getInstance().print("Configuration loaded successfully.");
+  String pagesStr = _preferences.getString("pageOrder", "");
+  enabledPages.clear();
+  if (pagesStr.length() > 0)
+  {
+    int start = 0;
+    int end = pagesStr.indexOf(',');
+    while (end != -1)
+    {
+      enabledPages.push_back(pagesStr.substring(start, end).toInt());
+      start = end + 1;
+      end = pagesStr.indexOf(',', start);
+    }
+    enabledPages.push_back(pagesStr.substring(start).toInt());
+  }
+  else
+  {
+    enabledPages.assign(std::begin(DEFAULT_ENABLED_PAGES), std::end(DEFAULT_ENABLED_PAGES));
+  }
+
+  defaultPage = _preferences.getInt("defaultPage", DEFAULT_DEFAULT_PAGE);
+  lat = _preferences.getFloat("lat", DEFAULT_LAT);
+  lon = _preferences.getFloat("lon", DEFAULT_LON);
+
+  backgroundColor = _preferences.getString("bgClr", DEFAULT_BACKGROUND_COLOR);
+  timeColor = _preferences.getString("timeClr", DEFAULT_TIME_COLOR);
+  todColor = _preferences.getString("todClr", DEFAULT_TOD_COLOR);
+  secondsColor = _preferences.getString("secondsClr", DEFAULT_SECONDS_COLOR);
+  dayOfWeekColor = _preferences.getString("dayOfWeekClr", DEFAULT_DAY_OF_WEEK_COLOR);
+  dateColor = _preferences.getString("dateClr", DEFAULT_DATE_COLOR);
+  tempColor = _preferences.getString("tempClr", DEFAULT_TEMP_COLOR);
+  humidityColor = _preferences.getString("humidityClr", DEFAULT_HUMIDITY_COLOR);
+  alarmIconColor = _preferences.getString("alarmIconClr", DEFAULT_ALARM_ICON_COLOR);
+  snoozeIconColor = _preferences.getString("snzIconClr", DEFAULT_SNOOZE_ICON_COLOR);
+  alarmTextColor = _preferences.getString("alarmTextClr", DEFAULT_ALARM_TEXT_COLOR);
+  errorTextColor = _preferences.getString("errorTextClr", DEFAULT_ERROR_TEXT_COLOR);
+  weatherTempColor = _preferences.getString("weaTempClr", DEFAULT_WEATHER_TEMP_COLOR);
+  weatherForecastColor = _preferences.getString("weaFcstClr", DEFAULT_WEATHER_FORECAST_COLOR);
 }
 
 /**
- * @brief Saves the current configuration to persistent storage.
+ * @brief Reads the settings blob in one NVS call.
  *
- * Writes all configuration variables to flash memory using the Preferences
- * library.
+ * Nothing is assigned unless the magic, version, length and CRC all match
+ * and every string is terminated inside the blob.
+ * @return True if the settings were loaded from the blob.
+ */
+bool ConfigManager::loadBlob()
+{
+  size_t length = _preferences.getBytesLength(CONFIG_BLOB_KEY);
+  if (length < sizeof(BlobHeader) + sizeof(BlobSettings))
+  {
+    return false;
+  }
+  std::vector<uint8_t> blob(length);
+  if (_preferences.getBytes(CONFIG_BLOB_KEY, blob.data(), length) != length)
+  {
+    return false;
+  }
+
+  BlobHeader header;
+  memcpy(&header, blob.data(), sizeof(header));
+  const uint8_t *body = blob.data() + sizeof(header);
+  size_t bodyLength = length - sizeof(header);
+  if (header.magic != CONFIG_BLOB_MAGIC || header.version != CONFIG_BLOB_VERSION || header.length != length ||
+      header.crc != esp_rom_crc32_le(0, body, bodyLength))
+  {
+    return false;
+  }
+
+  const char *strings[sizeof(BLOB_STRINGS) / sizeof(BLOB_STRINGS[0])];
+  const char *cursor = (const char *)body + sizeof(BlobSettings);
+  const char *end = (const char *)body + bodyLength;
+  for (const char *&string : strings)
+  {
+    const char *terminator = (const char *)memchr(cursor, '\0', end - cursor);
+    if (terminator == nullptr)
+    {
+      return false;
+    }
+    string = cursor;
+    cursor = terminator + 1;
+  }
+
+  BlobSettings settings;
+  memcpy(&settings, body, sizeof(settings));
+  wifiCredsValid = settings.wifiCredsValid;
+  autoBrightness = settings.autoBrightness;
+  brightness = settings.brightness;
+  autoBrightnessStartHour = settings.autoBrightnessStartHour;
+  autoBrightnessEndHour = settings.autoBrightnessEndHour;
+  dayBrightness = settings.dayBrightness;
+  nightBrightness = settings.nightBrightness;
+  use24HourFormat = settings.use24HourFormat;
+  useCelsius = settings.useCelsius;
+  screenFlipped = settings.screenFlipped;
+  invertColors = settings.invertColors;
+  isDst = settings.isDst;
+  snoozeDuration = settings.snoozeDuration;
+  dismissDuration = settings.dismissDuration;
+  tempCorrectionEnabled = settings.tempCorrectionEnabled;
+  memcpy(logLevels, settings.logLevels, sizeof(logLevels));
+  enabledPages.assign(settings.pages, settings.pages + std::min<uint8_t>(settings.pageCount, CONFIG_BLOB_MAX_PAGES));
+  defaultPage = settings.defaultPage;
+  tempCorrection = settings.tempCorrection;
+  lat = settings.lat;
+  lon = settings.lon;
+
+  for (size_t i = 0; i < sizeof(BLOB_STRINGS) / sizeof(BLOB_STRINGS[0]); i++)
+  {
+    this->*BLOB_STRINGS[i] = strings[i];
+  }
+  return true;
+}
+
+/**
+ * @brief Writes all the blob's settings in one NVS call.
  *
- * @return True on success, false on failure (though Preferences does not
- *         currently indicate failure).
+ * Only the first CONFIG_BLOB_MAX_PAGES enabled pages are kept.
+ * @return True if the whole blob was written.
+ */
+bool ConfigManager::saveBlob()
+{
+  BlobSettings settings = {};
+  settings.wifiCredsValid = wifiCredsValid;
+  settings.autoBrightness = autoBrightness;
+  settings.brightness = brightness;
+  settings.autoBrightnessStartHour = autoBrightnessStartHour;
+  settings.autoBrightnessEndHour = autoBrightnessEndHour;
+  settings.dayBrightness = dayBrightness;
+  settings.nightBrightness = nightBrightness;
+  settings.use24HourFormat = use24HourFormat;
+  settings.useCelsius = useCelsius;
+  settings.screenFlipped = screenFlipped;
+  settings.invertColors = invertColors;
+  settings.isDst = isDst;
+  settings.snoozeDuration = snoozeDuration;
+  settings.dismissDuration = dismissDuration;
+  settings.tempCorrectionEnabled = tempCorrectionEnabled;
+  memcpy(settings.logLevels, logLevels, sizeof(logLevels));
+  settings.pageCount = std::min<size_t>(enabledPages.size(), CONFIG_BLOB_MAX_PAGES);
+  for (size_t i = 0; i < settings.pageCount; i++)
+  {
+    settings.pages[i] = enabledPages[i];
+  }
+  settings.defaultPage = defaultPage;
+  settings.tempCorrection = tempCorrection;
+  settings.lat = lat;
+  settings.lon = lon;
+
+  size_t length = sizeof(BlobHeader) + sizeof(BlobSettings);
+  for (String ConfigManager::*field : BLOB_STRINGS)
+  {
+    length += (this->*field).length() + 1;
+  }
+
+  std::vector<uint8_t> blob(length);
+  uint8_t *body = blob.data() + sizeof(BlobHeader);
+  memcpy(body, &settings, sizeof(settings));
+  uint8_t *cursor = body + sizeof(settings);
+  for (String ConfigManager::*field : BLOB_STRINGS)
+  {
+    const String &value = this->*field;
+    memcpy(cursor, value.c_str(), value.length() + 1);
+    cursor += value.length() + 1;
+  }
+
+  BlobHeader header = {CONFIG_BLOB_MAGIC, CONFIG_BLOB_VERSION, (uint32_t)length, esp_rom_crc32_le(0, body, length - sizeof(BlobHeader))};
+  memcpy(blob.data(), &header, sizeof(header));
+  return _preferences.putBytes(CONFIG_BLOB_KEY, blob.data(), length) == length;
+}
+
+/**
+ * @brief Removes the per-setting keys of earlier firmware.
+ * @return The number of keys removed.
+ */
+uint32_t ConfigManager::removeLegacyKeys()
+{
+  uint32_t removed = 0;
+  for (const char *key : LEGACY_KEYS)
+  {
+    if (_preferences.isKey(key) && _preferences.remove(key))
+    {
+      removed++;
+    }
+  }
+  return removed;
+}
+
+/**
+ * @brief Saves the changed settings to persistent storage.
+ *
+ * Nothing is written unless a field was flagged by markDirty() since the last
+ * save. The settings blob is rewritten in one NVS write when any of its fields
+ * changed; the ringing alarm state and the alarm table keep their own keys,
+ * and the alarm table is diffed per key. The cost of each save is kept for
+ * getSaveStats().
+ *
+ * @return True on success, false if the settings blob could not be written.
  */
 bool ConfigManager::save()
 {
@@ -346,116 +713,197 @@ bool ConfigManager::save()
     return false;
 
   RecursiveLockGuard lock(_mutex);
-  _preferences.putString("wifiSSID", wifiSSID);
-  _preferences.putString("wifiPass", wifiPassword);
-  _preferences.putString("hostname", hostname);
-  _preferences.putBool("wifiValid", wifiCredsValid);
-  _preferences.putChar("ringAlarmId", ringingAlarmId);
-  _preferences.putUInt("ringAlarmTS", ringingAlarmStartTimestamp);
-  _preferences.putBool("autoBright", autoBrightness);
-  _preferences.putUChar("brightness", brightness);
-  _preferences.putUChar("autoBrStartHr", autoBrightnessStartHour);
-  _preferences.putUChar("autoBrEndHr", autoBrightnessEndHour);
-  _preferences.putUChar("dayBright", dayBrightness);
-  _preferences.putUChar("nightBright", nightBrightness);
-  _preferences.putBool("is24Hour", use24HourFormat);
-  _preferences.putBool("useCelsius", useCelsius);
-  _preferences.putBool("screenFlip", screenFlipped);
-  _preferences.putBool("invertColors", invertColors);
-  _preferences.putString("timezone", timezone);
-  _preferences.putBool("isDst", isDst);
-  _preferences.putUChar("snoozeDur", snoozeDuration);
-  _preferences.putUChar("dismissDur", dismissDuration);
-  _preferences.putBool("tempCorrEn", tempCorrectionEnabled);
-  _preferences.putFloat("tempCorr", tempCorrection);
-  _preferences.putString("address", address);
-
-  String pagesStr = "";
-  for (size_t i = 0; i < enabledPages.size(); ++i)
-  {
-    pagesStr += String(enabledPages[i]);
-    if (i < enabledPages.size() - 1)
-      pagesStr += ",";
-  }
-  _preferences.putString("pageOrder", pagesStr);
-
-  _preferences.putInt("defaultPage", defaultPage);
-  _preferences.putFloat("lat", lat);
-  _preferences.putFloat("lon", lon);
-
-  _preferences.putString("bgClr", backgroundColor);
-  _preferences.putString("timeClr", timeColor);
-  _preferences.putString("todClr", todColor);
-  _preferences.putString("secondsClr", secondsColor);
-  _preferences.putString("dayOfWeekClr", dayOfWeekColor);
-  _preferences.putString("dateClr", dateColor);
-  _preferences.putString("tempClr", tempColor);
-  _preferences.putString("humidityClr", humidityColor);
-  _preferences.putString("alarmIconClr", alarmIconColor);
-  _preferences.putString("snzIconClr", snoozeIconColor);
-  _preferences.putString("alarmTextClr", alarmTextColor);
-  _preferences.putString("errorTextClr", errorTextColor);
-  _preferences.putString("weaTempClr", weatherTempColor);
-  _preferences.putString("weaFcstClr", weatherForecastColor);
-
-  // Save alarms
+  uint64_t dirty = _dirtyFields;
+  if (dirty == 0)
+  {
+    return true;
+  }
+
+  int64_t startUs = esp_timer_get_time();
+  uint32_t writes = 0;
+  uint64_t failed = 0;
+
+  if (dirty & BLOB_FIELDS)
+  {
+    if (saveBlob())
+    {
+      writes++;
+      if (_legacyKeysPresent)
+      {
+        writes += removeLegacyKeys();
+        _legacyKeysPresent = false;
+      }
+    }
+    else
+    {
+      LOG_E(LOG_MODULE_CONFIG, "ERROR: Failed to write the settings blob.");
+      failed = dirty & BLOB_FIELDS; // Retried on the next save.
+    }
+  }
+  if (dirty & (1ULL << CONFIG_FIELD_RINGING_ALARM))
+  {
+    _preferences.putChar("ringAlarmId", ringingAlarmId);
+    _preferences.putUInt("ringAlarmTS", ringingAlarmStartTimestamp);
+    writes += 2;
+  }
+
+  if (dirty & (1ULL << CONFIG_FIELD_ALARMS))
+  {
+    writes += saveAlarms();
+  }
+  _dirtyFields = failed;
+
+  uint32_t durationUs = esp_timer_get_time() - startUs;
+  _saveStats.saves++;
+  _saveStats.totalWrites += writes;
+  _saveStats.lastWrites = writes;
+  _saveStats.lastDurationUs = durationUs;
+  _saveStats.maxDurationUs = std::max(_saveStats.maxDurationUs, durationUs);
+
+  LOG_I(LOG_MODULE_CONFIG, "Configuration saved: %u writes in %u us.\n", (unsigned)writes, (unsigned)durationUs);
+  return failed == 0;
+}
+
+/**
+ * @brief Writes the alarm keys that differ from the last saved table.
+ *
+ * Alarms are stored by position, so an alarm is compared with the one saved
+ * at the same index and only its changed keys are written. Keys of alarms
+ * beyond the new end of the table are removed.
+ *
+ * @return The number of Preferences writes and removals made.
+ */
+uint32_t ConfigManager::saveAlarms()
+{
+  uint32_t writes = 0;
+
   int oldNumAlarms = _preferences.getInt("numAlarms", -1);
   if (oldNumAlarms == -1)
   {
     oldNumAlarms = LEGACY_ALARMS_COUNT;
   }
 
-  _preferences.putInt("numAlarms", _alarms.size());
-  _preferences.putInt("nextAlarmId", _nextAlarmId);
+  if (oldNumAlarms != (int)_alarms.size() || !_preferences.isKey("numAlarms"))
+  {
+    _preferences.putInt("numAlarms", _alarms.size());
+    writes++;
+  }
+  if (_savedNextAlarmId != _nextAlarmId)
+  {
+    _preferences.putInt("nextAlarmId", _nextAlarmId);
+    writes++;
+  }
 
   // Clean up orphaned alarms if the number of alarms has decreased
   if ((int)_alarms.size() < oldNumAlarms)
   {
+    static const char *const suffixes[] = {"id", "en", "hr", "min", "days", "snz", "snzUntil", "lastDis", "pat"};
     for (int i = _alarms.size(); i < oldNumAlarms; ++i)
     {
-      char key[16];
-      snprintf(key, sizeof(key), "a_%d_id", i);
-      _preferences.remove(key);
-      snprintf(key, sizeof(key), "a_%d_en", i);
-      _preferences.remove(key);
-      snprintf(key, sizeof(key), "a_%d_hr", i);
-      _preferences.remove(key);
-      snprintf(key, sizeof(key), "a_%d_min", i);
-      _preferences.remove(key);
-      snprintf(key, sizeof(key), "a_%d_days", i);
-      _preferences.remove(key);
-      snprintf(key, sizeof(key), "a_%d_snz", i);
-      _preferences.remove(key);
-      snprintf(key, sizeof(key), "a_%d_snzUntil", i);
-      _preferences.remove(key);
-      snprintf(key, sizeof(key), "a_%d_lastDis", i);
-      _preferences.remove(key);
+      for (const char *suffix : suffixes)
+      {
+        char key[16];
+        snprintf(key, sizeof(key), "a_%d_%s", i, suffix);
+        _preferences.remove(key);
+        writes++;
+      }
     }
   }
 
   for (size_t i = 0; i < _alarms.size(); ++i)
   {
+    const Alarm &alarm = _alarms[i];
+    const Alarm *saved = i < _savedAlarms.size() ? &_savedAlarms[i] : nullptr;
     char key[16];
-    snprintf(key, sizeof(key), "a_%zu_id", i);
-    _preferences.putUChar(key, _alarms[i].getId());
-    snprintf(key, sizeof(key), "a_%zu_en", i);
-    _preferences.putBool(key, _alarms[i].isEnabled());
-    snprintf(key, sizeof(key), "a_%zu_hr", i);
-    _preferences.putUChar(key, _alarms[i].getHour());
-    snprintf(key, sizeof(key), "a_%zu_min", i);
-    _preferences.putUChar(key, _alarms[i].getMinute());
-    snprintf(key, sizeof(key), "a_%zu_days", i);
-    _preferences.putUChar(key, _alarms[i].getDays());
-    snprintf(key, sizeof(key), "a_%zu_snz", i);
-    _preferences.putBool(key, _alarms[i].isSnoozed());
-    snprintf(key, sizeof(key), "a_%zu_snzUntil", i);
-    _preferences.putUInt(key, _alarms[i].getSnoozeUntil());
-    snprintf(key, sizeof(key), "a_%zu_lastDis", i);
-    _preferences.putUChar(key, _alarms[i].getLastDismissedDay());
-  }
-
-  SerialLog::getInstance().print("Configuration saved.");
-  return true;
+
+    if (saved == nullptr || saved->getId() != alarm.getId())
+    {
+      snprintf(key, sizeof(key), "a_%zu_id", i);
+      _preferences.putUChar(key, alarm.getId());
+      writes++;
+    }
+    if (saved == nullptr || saved->isEnabled() != alarm.isEnabled())
+    {
+      snprintf(key, sizeof(key), "a_%zu_en", i);
+      _preferences.putBool(key, alarm.isEnabled());
+      writes++;
+    }
+    if (saved == nullptr || saved->getHour() != alarm.getHour())
+    {
+      snprintf(key, sizeof(key), "a_%zu_hr", i);
+      _preferences.putUChar(key, alarm.getHour());
+      writes++;
+    }
+    if (saved == nullptr || saved->getMinute() != alarm.getMinute())
+    {
+      snprintf(key, sizeof(key), "a_%zu_min", i);
+      _preferences.putUChar(key, alarm.getMinute());
+      writes++;
+    }
+    if (saved == nullptr || saved->getDays() != alarm.getDays())
+    {
+      snprintf(key, sizeof(key), "a_%zu_days", i);
+      _preferences.putUChar(key, alarm.getDays());
+      writes++;
+    }
+    if (saved == nullptr || saved->isSnoozed() != alarm.isSnoozed())
+    {
+      snprintf(key, sizeof(key), "a_%zu_snz", i);
+      _preferences.putBool(key, alarm.isSnoozed());
+      writes++;
+    }
+    if (saved == nullptr || saved->getSnoozeUntil() != alarm.getSnoozeUntil())
+    {
+      snprintf(key, sizeof(key), "a_%zu_snzUntil", i);
+      _preferences.putUInt(key, alarm.getSnoozeUntil());
+      writes++;
+    }
+    if (saved == nullptr || saved->getLastDismissedDay() != alarm.getLastDismissedDay())
+    {
+      snprintf(key, sizeof(key), "a_%zu_lastDis", i);
+      _preferences.putUChar(key, alarm.getLastDismissedDay());
+      writes++;
+    }
+    if (saved == nullptr || saved->getBuzzerPattern() != alarm.getBuzzerPattern())
+    {
+      // Only alarms with their own pattern have the key.
+      const BuzzerPattern &pattern = alarm.getBuzzerPattern();
+      snprintf(key, sizeof(key), "a_%zu_pat", i);
+      if (pattern.count > 0)
+      {
+        _preferences.putBytes(key, pattern.stepsMs, pattern.count * sizeof(pattern.stepsMs[0]));
+      }
+      else
+      {
+        _preferences.remove(key);
+      }
+      writes++;
+    }
+  }
+
+  _savedAlarms = _alarms;
+  _savedNextAlarmId = _nextAlarmId;
+  return writes;
+}
+
+/**
+ * @brief Gets how the settings were loaded at boot and how long that took.
+ * @return The load statistics.
+ */
+ConfigLoadStats ConfigManager::getLoadStats() const
+{
+  RecursiveLockGuard lock(_mutex);
+  return _loadStats;
+}
+
+/**
+ * @brief Gets the cost of the saves made since boot.
+ * @return The save statistics.
+ */
+ConfigSaveStats ConfigManager::getSaveStats() const
+{
+  RecursiveLockGuard lock(_mutex);
+  return _saveStats;
 }
 
 /**
@@ -482,7 +930,7 @@ Alarm ConfigManager::getAlarmByIndex(int index) const
   RecursiveLockGuard lock(_mutex);
   if (index < 0 || index >= _alarms.size())
   {
-    SerialLog::getInstance().print("FATAL: Alarm index out of bounds!");
+    LOG_E(LOG_MODULE_CONFIG, "FATAL: Alarm index out of bounds!");
     // Return a default alarm or handle error appropriately.
     // Since we can't crash safely, returning a disabled alarm.
     return Alarm();
@@ -542,11 +990,12 @@ void ConfigManager::setAlarmByIndex(int index, const Alarm &alarm)
     RecursiveLockGuard lock(_mutex);
     if (index < 0 || index >= _alarms.size())
     {
-      SerialLog::getInstance().print("ERROR: Alarm index out of bounds!");
+      LOG_E(LOG_MODULE_CONFIG, "ERROR: Alarm index out of bounds!");
       return;
     }
     _alarms[index] = alarm;
-    _isDirty = true;
+    markDirty(CONFIG_FIELD_ALARMS);
+    alarmsChanged();
   }
   scheduleSave();
 }
@@ -566,7 +1015,8 @@ void ConfigManager::setAlarmById(int id, const Alarm &alarm)
       if (a.getId() == id)
       {
         a = alarm;
-        _isDirty = true;
+        markDirty(CONFIG_FIELD_ALARMS);
+        alarmsChanged();
         found = true;
         break;
       }
@@ -575,7 +1025,7 @@ void ConfigManager::setAlarmById(int id, const Alarm &alarm)
   if (found)
     scheduleSave();
   else
-    SerialLog::getInstance().printf("ERROR: Alarm ID %d not found for update!\n", id);
+    LOG_E(LOG_MODULE_CONFIG, "ERROR: Alarm ID %d not found for update!\n", id);
 }
 
 void ConfigManager::replaceAlarms(const std::vector<Alarm> &newAlarms)
@@ -595,7 +1045,8 @@ void ConfigManager::replaceAlarms(const std::vector<Alarm> &newAlarms)
       }
       _alarms.push_back(alarm);
     }
-    _isDirty = true;
+    markDirty(CONFIG_FIELD_ALARMS);
+    alarmsChanged();
   }
   scheduleSave();
 }
@@ -605,36 +1056,40 @@ void ConfigManager::replaceAlarms(const std::vector<Alarm> &newAlarms)
  *
  * This function erases all configuration settings, including saved WiFi
  * credentials, by clearing the entire Preferences namespace and erasing the
- * NVS partition. The device is then reset to its default state.
+ * NVS partition, and forgets the cached geocoding results. The device is
+ * then reset to its default state.
  */
 void ConfigManager::factoryReset()
 {
-  SerialLog::getInstance().print("Performing factory reset...\n");
+  LOG_I(LOG_MODULE_CONFIG, "Performing factory reset...\n");
 
   // Erase the NVS (Non-Volatile Storage) partition.
   // This is where the WiFi credentials are saved by the WiFi library.
-  SerialLog::getInstance().print("Erasing NVS to clear WiFi credentials...\n");
+  LOG_I(LOG_MODULE_CONFIG, "Erasing NVS to clear WiFi credentials...\n");
   esp_err_t err = nvs_flash_erase();
   if (err == ESP_OK)
   {
-    SerialLog::getInstance().print("NVS erased successfully.\n");
+    LOG_I(LOG_MODULE_CONFIG, "NVS erased successfully.\n");
   }
   else
   {
-    SerialLog::getInstance().print("Error erasing NVS.\n");
+    LOG_E(LOG_MODULE_CONFIG, "Error erasing NVS.\n");
   }
 
   // After erasing, the NVS needs to be re-initialized for the next boot.
   err = nvs_flash_init();
   if (err == ESP_OK)
   {
-    SerialLog::getInstance().print("NVS re-initialized successfully.\n");
+    LOG_I(LOG_MODULE_CONFIG, "NVS re-initialized successfully.\n");
   }
   else
   {
-    SerialLog::getInstance().print("Error re-initializing NVS.\n");
+    LOG_E(LOG_MODULE_CONFIG, "Error re-initializing NVS.\n");
   }
 
+  // Remembered locations go too; a reset that keeps Wi-Fi keeps them.
+  GeocodingCache::getInstance().clear();
+
   setDefaults();
   save();
 }
@@ -649,7 +1104,7 @@ void ConfigManager::factoryReset()
  */
 void ConfigManager::factoryResetExceptWiFi()
 {
-  SerialLog::getInstance().print("Performing factory reset, but keeping WiFi credentials...\n");
+  LOG_I(LOG_MODULE_CONFIG, "Performing factory reset, but keeping WiFi credentials...\n");
 
   // Preserve WiFi credentials
   String ssid = getWifiSSID();
@@ -696,7 +1151,11 @@ void ConfigManager::resetDisplayToDefaults()
 
   {
     RecursiveLockGuard lock(_mutex);
-    _isDirty = true;
+    rebuildTheme();
+    for (int field = CONFIG_FIELD_BACKGROUND_COLOR; field <= CONFIG_FIELD_WEATHER_FORECAST_COLOR; field++)
+    {
+      markDirty((ConfigField)field);
+    }
   }
   scheduleSave();
 }
@@ -722,6 +1181,8 @@ void ConfigManager::resetGeneralSettingsToDefaults()
     isDst = DEFAULT_IS_DST;
     tempCorrectionEnabled = DEFAULT_TEMP_CORRECTION_ENABLED;
     tempCorrection = DEFAULT_TEMP_CORRECTION;
+    memset(logLevels, DEFAULT_LOG_LEVEL, sizeof(logLevels));
+    applyLogLevels();
 
     snoozeDuration = DEFAULT_SNOOZE_DURATION;
     dismissDuration = DEFAULT_DISMISS_DURATION;
@@ -730,7 +1191,10 @@ void ConfigManager::resetGeneralSettingsToDefaults()
     defaultPage = DEFAULT_DEFAULT_PAGE;
     lat = DEFAULT_LAT;
     lon = DEFAULT_LON;
-    _isDirty = true;
+    for (int field = CONFIG_FIELD_AUTO_BRIGHTNESS; field <= CONFIG_FIELD_LON; field++)
+    {
+      markDirty((ConfigField)field);
+    }
   }
   scheduleSave();
 }
@@ -742,27 +1206,51 @@ void ConfigManager::resetGeneralSettingsToDefaults()
 bool ConfigManager::isAnyAlarmSnoozed() const
 {
   RecursiveLockGuard lock(_mutex);
-  for (const auto &alarm : _alarms)
-  {
-    if (alarm.isSnoozed())
-    {
-      return true;
-    }
-  }
-  return false;
+  return _alarmSummary.anySnoozed;
 }
 
 time_t ConfigManager::getFirstSnoozedUntil() const
 {
   RecursiveLockGuard lock(_mutex);
+  return _alarmSummary.earliestSnoozeUntil;
+}
+
+/**
+ * @brief Gets the enabled/snoozed summary of the alarm table.
+ * @return A copy of the summary.
+ */
+AlarmSummary ConfigManager::getAlarmSummary() const
+{
+  RecursiveLockGuard lock(_mutex);
+  return _alarmSummary;
+}
+
+/**
+ * @brief Recomputes the alarm summary and bumps the alarm generation.
+ *
+ * The generation is stored last, so a reader that sees the new number and
+ * then takes the lock gets a summary at least that new.
+ */
+void ConfigManager::alarmsChanged()
+{
+  RecursiveLockGuard lock(_mutex);
+  AlarmSummary summary = {};
   for (const auto &alarm : _alarms)
   {
+    summary.anyEnabled |= alarm.isEnabled();
     if (alarm.isSnoozed())
     {
-      return alarm.getSnoozeUntil();
+      summary.anySnoozed = true;
+      summary.anyEnabledSnoozed |= alarm.isEnabled();
+      if (summary.earliestSnoozeUntil == 0 || alarm.getSnoozeUntil() < summary.earliestSnoozeUntil)
+      {
+        summary.earliestSnoozeUntil = alarm.getSnoozeUntil();
+      }
     }
   }
-  return 0;
+  summary.generation = _alarmSummary.generation + 1;
+  _alarmSummary = summary;
+  _alarmGeneration.store(summary.generation);
 }
 
 // Getters
@@ -856,6 +1344,11 @@ bool ConfigManager::isTempCorrectionEnabled() const
   RecursiveLockGuard lock(_mutex);
   return tempCorrectionEnabled;
 }
+LogLevel ConfigManager::getLogLevel(LogModule module) const
+{
+  RecursiveLockGuard lock(_mutex);
+  return (LogLevel)logLevels[module];
+}
 bool ConfigManager::isDST() const
 {
   RecursiveLockGuard lock(_mutex);
@@ -931,6 +1424,145 @@ String ConfigManager::getWeatherForecastColor() const
   RecursiveLockGuard lock(_mutex);
   return weatherForecastColor;
 }
+
+Theme ConfigManager::getTheme() const
+{
+  RecursiveLockGuard lock(_mutex);
+  return _theme;
+}
+
+uint32_t ConfigManager::getThemeGeneration() const
+{
+  RecursiveLockGuard lock(_mutex);
+  return _themeGeneration;
+}
+
+uint32_t ConfigManager::getGeneration() const
+{
+  RecursiveLockGuard lock(_mutex);
+  return _generation;
+}
+
+/**
+ * @brief Re-parses the color strings into the RGB565 theme and bumps its generation.
+ *
+ * Called whenever a color is assigned, so readers never
+ * have to parse hex strings themselves.
+ */
+void ConfigManager::rebuildTheme()
+{
+  RecursiveLockGuard lock(_mutex);
+  if (_transactionDepth > 0)
+  {
+    _transactionTheme = true;
+    return;
+  }
+  _theme.background = hexToRGB565(backgroundColor);
+  _theme.time = hexToRGB565(timeColor);
+  _theme.tod = hexToRGB565(todColor);
+  _theme.seconds = hexToRGB565(secondsColor);
+  _theme.dayOfWeek = hexToRGB565(dayOfWeekColor);
+  _theme.date = hexToRGB565(dateColor);
+  _theme.temp = hexToRGB565(tempColor);
+  _theme.humidity = hexToRGB565(humidityColor);
+  _theme.alarmIcon = hexToRGB565(alarmIconColor);
+  _theme.snoozeIcon = hexToRGB565(snoozeIconColor);
+  _theme.alarmText = hexToRGB565(alarmTextColor);
+  _theme.errorText = hexToRGB565(errorTextColor);
+  _theme.weatherTemp = hexToRGB565(weatherTempColor);
+  _theme.weatherForecast = hexToRGB565(weatherForecastColor);
+  _themeGeneration++;
+  publishSnapshot();
+}
+
+/**
+ * @brief Gets the current settings snapshot without taking the settings lock.
+ *
+ * The reader marks the slot as held and then checks it is still the current
+ * one. If a publish moved on in between, the writer may already be refilling
+ * the slot, so the reader lets go and tries again with the newer snapshot.
+ * @return A reference to the current snapshot.
+ */
+ConfigSnapshotRef ConfigManager::snapshot() const
+{
+  while (true)
+  {
+    ConfigSnapshotRef::Slot *slot = _currentSnapshot.load();
+    slot->readers.fetch_add(1);
+    if (_currentSnapshot.load() == slot)
+    {
+      return ConfigSnapshotRef(slot);
+    }
+    slot->readers.fetch_sub(1);
+  }
+}
+
+/**
+ * @brief Publishes a new snapshot if the snapshotted settings have changed.
+ *
+ * The snapshot is built in a slot that is neither current nor held by a
+ * reader, then made current with a single atomic store. Slots are taken in
+ * turn, so a snapshot is only rewritten after CONFIG_SNAPSHOT_SLOTS - 1 newer
+ * ones, and only once its readers are done. Snapshots are compared bytewise,
+ * so the bursts of unchanged setters from the web UI publish nothing.
+ */
+void ConfigManager::publishSnapshot()
+{
+  RecursiveLockGuard lock(_mutex);
+  if (_transactionDepth > 0)
+  {
+    _transactionPublish = true;
+    return;
+  }
+  ConfigSnapshot next;
+  memset(&next, 0, sizeof(next)); // Zeroed padding keeps the memcmp below meaningful.
+  next.autoBrightness = autoBrightness;
+  next.brightness = brightness;
+  next.autoBrightnessStartHour = autoBrightnessStartHour;
+  next.autoBrightnessEndHour = autoBrightnessEndHour;
+  next.dayBrightness = dayBrightness;
+  next.nightBrightness = nightBrightness;
+  next.use24HourFormat = use24HourFormat;
+  next.useCelsius = useCelsius;
+  next.screenFlipped = screenFlipped;
+  next.invertColors = invertColors;
+  next.isDst = isDst;
+  next.tempCorrectionEnabled = tempCorrectionEnabled;
+  next.tempCorrection = tempCorrection;
+  next.snoozeDuration = snoozeDuration;
+  next.dismissDuration = dismissDuration;
+  next.defaultPage = defaultPage;
+  next.lat = lat;
+  next.lon = lon;
+  next.theme = _theme;
+  next.themeGeneration = _themeGeneration;
+  strlcpy(next.timezone, timezone.c_str(), sizeof(next.timezone));
+  strlcpy(next.address, address.c_str(), sizeof(next.address));
+
+  ConfigSnapshotRef::Slot *current = _currentSnapshot.load();
+  if (current != nullptr && memcmp(&current->snapshot, &next, sizeof(next)) == 0)
+  {
+    return;
+  }
+
+  while (true)
+  {
+    for (size_t i = 1; i <= CONFIG_SNAPSHOT_SLOTS; i++)
+    {
+      size_t index = (_snapshotSlot + i) % CONFIG_SNAPSHOT_SLOTS;
+      ConfigSnapshotRef::Slot *slot = &_snapshots[index];
+      if (slot != current && slot->readers.load() == 0)
+      {
+        memcpy(&slot->snapshot, &next, sizeof(next));
+        _snapshotSlot = index;
+        _currentSnapshot.store(slot);
+        return;
+      }
+    }
+    // Every other slot is held by a reader; they are released within a frame.
+    vTaskDelay(1);
+  }
+}
 int8_t ConfigManager::getRingingAlarmId() const
 {
   RecursiveLockGuard lock(_mutex);
@@ -971,15 +1603,105 @@ float ConfigManager::getLon() const
   RecursiveLockGuard lock(_mutex);
   return lon;
 }
-bool ConfigManager::isDirty() const
+
+/**
+ * @brief Flags a setting as changed. Called with the mutex held.
+ * @param field The setting.
+ */
+void ConfigManager::markDirty(ConfigField field)
+{
+  _dirtyFields |= 1ULL << field;
+  noteChanges(FIELD_CHANGES[field]);
+}
+
+/**
+ * @brief Counts a change in each of the given categories. Called with the mutex held.
+ * @param changes A mask of ConfigChange bits.
+ */
+void ConfigManager::noteChanges(uint32_t changes)
 {
-  RecursiveLockGuard lock(_mutex);
-  return _isDirty;
+  if (_transactionDepth > 0)
+  {
+    _transactionChanges |= changes;
+    return;
+  }
+  for (int i = 0; i < CONFIG_CHANGE_COUNT; i++)
+  {
+    if (changes & (1u << i))
+    {
+      _changeCounts[i]++;
+    }
+  }
+}
+
+/**
+ * @brief Begins a transaction, holding the settings lock until it ends.
+ * @param config The ConfigManager to change.
+ */
+ConfigManager::Transaction::Transaction(ConfigManager &config) : _config(config)
+{
+  xSemaphoreTakeRecursive(_config._mutex, portMAX_DELAY);
+  _config._transactionDepth++;
 }
-void ConfigManager::clearDirtyFlag()
+
+/**
+ * @brief Ends the transaction; the outermost one applies what was deferred.
+ *
+ * The theme is rebuilt before the snapshot is published, which happens
+ * before the change is announced, so a subscriber reacting to the change
+ * always reads the new values.
+ */
+ConfigManager::Transaction::~Transaction()
+{
+  bool checkDst = false;
+  if (--_config._transactionDepth == 0)
+  {
+    checkDst = _config._transactionCheckDst;
+    _config._transactionCheckDst = false;
+    if (_config._transactionTheme)
+    {
+      _config.rebuildTheme();
+    }
+    if (_config._transactionSave)
+    {
+      _config.scheduleSave();
+    }
+    if (_config._transactionPublish)
+    {
+      _config.publishSnapshot();
+    }
+    _config.noteChanges(_config._transactionChanges);
+    _config._transactionChanges = 0;
+    _config._transactionSave = false;
+    _config._transactionTheme = false;
+    _config._transactionPublish = false;
+  }
+  xSemaphoreGiveRecursive(_config._mutex);
+
+  if (checkDst)
+  {
+    TimeManager::getInstance().checkDST();
+  }
+}
+
+/**
+ * @brief Gets the categories changed since this cursor was last polled, and advances it.
+ * @param cursor The subscriber's cursor.
+ * @return A mask of ConfigChange bits, 0 if nothing changed.
+ */
+uint32_t ConfigManager::takeChanges(ConfigChangeCursor &cursor) const
 {
   RecursiveLockGuard lock(_mutex);
-  _isDirty = false;
+  uint32_t changes = 0;
+  for (int i = 0; i < CONFIG_CHANGE_COUNT; i++)
+  {
+    if (cursor.seen[i] != _changeCounts[i])
+    {
+      cursor.seen[i] = _changeCounts[i];
+      changes |= 1u << i;
+    }
+  }
+  return changes;
 }
 
 // Setters - Implemented here to properly manage locking
@@ -990,7 +1712,8 @@ void ConfigManager::setWifiSSID(const String &ssid)
     RecursiveLockGuard lock(_mutex);
     wifiSSID = ssid;
     wifiCredsValid = false;
-    _isDirty = true;
+    markDirty(CONFIG_FIELD_WIFI_SSID);
+    markDirty(CONFIG_FIELD_WIFI_CREDS_VALID);
   }
   scheduleSave();
 }
@@ -1001,7 +1724,8 @@ void ConfigManager::setWifiPassword(const String &password)
     RecursiveLockGuard lock(_mutex);
     wifiPassword = password;
     wifiCredsValid = false;
-    _isDirty = true;
+    markDirty(CONFIG_FIELD_WIFI_PASSWORD);
+    markDirty(CONFIG_FIELD_WIFI_CREDS_VALID);
   }
   scheduleSave();
 }
@@ -1011,7 +1735,7 @@ void ConfigManager::setHostname(const String &name)
   {
     RecursiveLockGuard lock(_mutex);
     hostname = name;
-    _isDirty = true;
+    markDirty(CONFIG_FIELD_HOSTNAME);
   }
   scheduleSave();
 }
@@ -1023,7 +1747,7 @@ void ConfigManager::setWifiCredsValid(bool valid)
     if (wifiCredsValid != valid)
     {
       wifiCredsValid = valid;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_WIFI_CREDS_VALID);
     }
   }
   scheduleSave();
@@ -1036,7 +1760,7 @@ void ConfigManager::setTempCorrectionEnabled(bool enabled)
     if (tempCorrectionEnabled != enabled)
     {
       tempCorrectionEnabled = enabled;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_TEMP_CORRECTION_ENABLED);
     }
   }
   scheduleSave();
@@ -1049,12 +1773,37 @@ void ConfigManager::setTempCorrection(float value)
     if (tempCorrection != value)
     {
       tempCorrection = value;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_TEMP_CORRECTION);
+    }
+  }
+  scheduleSave();
+}
+
+void ConfigManager::setLogLevel(LogModule module, LogLevel level)
+{
+  {
+    RecursiveLockGuard lock(_mutex);
+    if (logLevels[module] != level)
+    {
+      logLevels[module] = level;
+      SerialLog::getInstance().setModuleLevel(module, level);
+      markDirty(CONFIG_FIELD_LOG_LEVELS);
     }
   }
   scheduleSave();
 }
 
+/**
+ * @brief Pushes the stored log thresholds to SerialLog. Called with the mutex held.
+ */
+void ConfigManager::applyLogLevels()
+{
+  for (int i = 0; i < LOG_MODULE_COUNT; i++)
+  {
+    SerialLog::getInstance().setModuleLevel((LogModule)i, (LogLevel)logLevels[i]);
+  }
+}
+
 void ConfigManager::setAddress(const String &addr)
 {
   {
@@ -1062,7 +1811,7 @@ void ConfigManager::setAddress(const String &addr)
     if (address != addr)
     {
       address = addr;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_ADDRESS);
     }
   }
   scheduleSave();
@@ -1073,7 +1822,7 @@ void ConfigManager::setEnabledPages(const std::vector<int> &pages)
   {
     RecursiveLockGuard lock(_mutex);
     enabledPages = pages;
-    _isDirty = true;
+    markDirty(CONFIG_FIELD_ENABLED_PAGES);
   }
   scheduleSave();
 }
@@ -1085,7 +1834,7 @@ void ConfigManager::setDefaultPage(int page)
     if (defaultPage != page)
     {
       defaultPage = page;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_DEFAULT_PAGE);
     }
   }
   scheduleSave();
@@ -1098,7 +1847,7 @@ void ConfigManager::setLat(float latitude)
     if (lat != latitude)
     {
       lat = latitude;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_LAT);
     }
   }
   scheduleSave();
@@ -1111,7 +1860,7 @@ void ConfigManager::setLon(float longitude)
     if (lon != longitude)
     {
       lon = longitude;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_LON);
     }
   }
   scheduleSave();
@@ -1124,7 +1873,7 @@ void ConfigManager::setDST(bool active)
     if (isDst != active)
     {
       isDst = active;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_IS_DST);
     }
   }
   scheduleSave();
@@ -1137,7 +1886,7 @@ void ConfigManager::setInvertColors(bool inverted)
     if (invertColors != inverted)
     {
       invertColors = inverted;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_INVERT_COLORS);
     }
   }
   scheduleSave();
@@ -1150,7 +1899,7 @@ void ConfigManager::setSnoozeDuration(uint8_t duration)
     if (snoozeDuration != duration)
     {
       snoozeDuration = duration;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_SNOOZE_DURATION);
     }
   }
   scheduleSave();
@@ -1163,7 +1912,7 @@ void ConfigManager::setDismissDuration(uint8_t duration)
     if (dismissDuration != duration)
     {
       dismissDuration = duration;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_DISMISS_DURATION);
     }
   }
   scheduleSave();
@@ -1194,7 +1943,7 @@ void ConfigManager::setScreenFlipped(bool flipped)
     if (screenFlipped != flipped)
     {
       screenFlipped = flipped;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_SCREEN_FLIPPED);
     }
   }
   scheduleSave();
@@ -1207,7 +1956,7 @@ void ConfigManager::setAutoBrightness(bool enabled)
     if (autoBrightness != enabled)
     {
       autoBrightness = enabled;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_AUTO_BRIGHTNESS);
     }
   }
   scheduleSave();
@@ -1220,7 +1969,7 @@ void ConfigManager::setBrightness(uint8_t value)
     if (brightness != value)
     {
       brightness = value;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_BRIGHTNESS);
     }
   }
   scheduleSave();
@@ -1233,7 +1982,7 @@ void ConfigManager::setAutoBrightnessStartHour(uint8_t value)
     if (autoBrightnessStartHour != value)
     {
       autoBrightnessStartHour = value;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_AUTO_BRIGHTNESS_START_HOUR);
     }
   }
   scheduleSave();
@@ -1246,7 +1995,7 @@ void ConfigManager::setAutoBrightnessEndHour(uint8_t value)
     if (autoBrightnessEndHour != value)
     {
       autoBrightnessEndHour = value;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_AUTO_BRIGHTNESS_END_HOUR);
     }
   }
   scheduleSave();
@@ -1259,7 +2008,7 @@ void ConfigManager::setDayBrightness(uint8_t value)
     if (dayBrightness != value)
     {
       dayBrightness = value;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_DAY_BRIGHTNESS);
     }
   }
   scheduleSave();
@@ -1272,7 +2021,7 @@ void ConfigManager::setNightBrightness(uint8_t value)
     if (nightBrightness != value)
     {
       nightBrightness = value;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_NIGHT_BRIGHTNESS);
     }
   }
   scheduleSave();
@@ -1285,7 +2034,7 @@ void ConfigManager::set24HourFormat(bool enabled)
     if (use24HourFormat != enabled)
     {
       use24HourFormat = enabled;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_USE_24_HOUR_FORMAT);
     }
   }
   scheduleSave();
@@ -1298,7 +2047,7 @@ void ConfigManager::setCelsius(bool enabled)
     if (useCelsius != enabled)
     {
       useCelsius = enabled;
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_USE_CELSIUS);
     }
   }
   scheduleSave();
@@ -1313,12 +2062,23 @@ void ConfigManager::setTimezone(const String &tz)
       timezone = tz;
       setenv("TZ", timezone.c_str(), 1);
       tzset();
-      _isDirty = true;
+      markDirty(CONFIG_FIELD_TIMEZONE);
     }
   }
   // timezone change may also change whether DST should be active; force a
   // re-evaluation right away rather than waiting for the next tick in
   // TimeManager::update().
+  {
+    RecursiveLockGuard lock(_mutex);
+    if (_transactionDepth > 0)
+    {
+      // checkDST() takes the TimeManager lock, so it must not run while the
+      // Transaction holds ours; it runs once the Transaction ends.
+      _transactionCheckDst = true;
+      scheduleSave();
+      return;
+    }
+  }
   TimeManager::getInstance().checkDST();
   scheduleSave();
 }
@@ -1330,7 +2090,8 @@ void ConfigManager::setBackgroundColor(const String &color)
     if (backgroundColor != color)
     {
       backgroundColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_BACKGROUND_COLOR);
     }
   }
   scheduleSave();
@@ -1343,7 +2104,8 @@ void ConfigManager::setTimeColor(const String &color)
     if (timeColor != color)
     {
       timeColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_TIME_COLOR);
     }
   }
   scheduleSave();
@@ -1356,7 +2118,8 @@ void ConfigManager::setTodColor(const String &color)
     if (todColor != color)
     {
       todColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_TOD_COLOR);
     }
   }
   scheduleSave();
@@ -1369,7 +2132,8 @@ void ConfigManager::setSecondsColor(const String &color)
     if (secondsColor != color)
     {
       secondsColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_SECONDS_COLOR);
     }
   }
   scheduleSave();
@@ -1382,7 +2146,8 @@ void ConfigManager::setDayOfWeekColor(const String &color)
     if (dayOfWeekColor != color)
     {
       dayOfWeekColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_DAY_OF_WEEK_COLOR);
     }
   }
   scheduleSave();
@@ -1395,7 +2160,8 @@ void ConfigManager::setDateColor(const String &color)
     if (dateColor != color)
     {
       dateColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_DATE_COLOR);
     }
   }
   scheduleSave();
@@ -1408,7 +2174,8 @@ void ConfigManager::setTempColor(const String &color)
     if (tempColor != color)
     {
       tempColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_TEMP_COLOR);
     }
   }
   scheduleSave();
@@ -1421,7 +2188,8 @@ void ConfigManager::setHumidityColor(const String &color)
     if (humidityColor != color)
     {
       humidityColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_HUMIDITY_COLOR);
     }
   }
   scheduleSave();
@@ -1434,7 +2202,8 @@ void ConfigManager::setAlarmIconColor(const String &color)
     if (alarmIconColor != color)
     {
       alarmIconColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_ALARM_ICON_COLOR);
     }
   }
   scheduleSave();
@@ -1447,7 +2216,8 @@ void ConfigManager::setSnoozeIconColor(const String &color)
     if (snoozeIconColor != color)
     {
       snoozeIconColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_SNOOZE_ICON_COLOR);
     }
   }
   scheduleSave();
@@ -1460,7 +2230,8 @@ void ConfigManager::setAlarmTextColor(const String &color)
     if (alarmTextColor != color)
     {
       alarmTextColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_ALARM_TEXT_COLOR);
     }
   }
   scheduleSave();
@@ -1473,7 +2244,8 @@ void ConfigManager::setErrorTextColor(const String &color)
     if (errorTextColor != color)
     {
       errorTextColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_ERROR_TEXT_COLOR);
     }
   }
   scheduleSave();
@@ -1486,7 +2258,8 @@ void ConfigManager::setWeatherTempColor(const String &color)
     if (weatherTempColor != color)
     {
       weatherTempColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_WEATHER_TEMP_COLOR);
     }
   }
   scheduleSave();
@@ -1499,7 +2272,8 @@ void ConfigManager::setWeatherForecastColor(const String &color)
     if (weatherForecastColor != color)
     {
       weatherForecastColor = color;
-      _isDirty = true;
+      rebuildTheme();
+      markDirty(CONFIG_FIELD_WEATHER_FORECAST_COLOR);
     }
   }
   scheduleSave();
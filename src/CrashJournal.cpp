@@ -0,0 +1,126 @@
+/**
+ * @file CrashJournal.cpp
+ * @brief Implements the RTC-memory journal of the last log lines.
+ */
+#include "CrashJournal.h"
+#include <esp_attr.h>
+#include <esp32-hal-psram.h>
+#include <algorithm>
+#include <cstring>
+
+#define CRASH_JOURNAL_MAGIC 0xC7A5E001
+
+struct RtcCrashJournal
+{
+  uint32_t magic;
+  uint32_t count; ///< Records ever appended; the next one goes to `count % CRASH_JOURNAL_RECORDS`.
+  CrashJournal::Record records[CRASH_JOURNAL_RECORDS];
+};
+
+RTC_NOINIT_ATTR static RtcCrashJournal g_crashJournal;
+
+/**
+ * @brief Copies the previous session's records out and resets the ring.
+ *
+ * After a power-on reset RTC memory holds garbage, so it is not trusted
+ * even if the magic happens to match.
+ */
+CrashJournal::CrashJournal() : _resetReason(esp_reset_reason())
+{
+  if (g_crashJournal.magic == CRASH_JOURNAL_MAGIC && _resetReason != ESP_RST_POWERON)
+  {
+    size_t count = std::min<uint32_t>(g_crashJournal.count, CRASH_JOURNAL_RECORDS);
+    _previous = (Record *)ps_malloc(std::max<size_t>(count, 1) * sizeof(Record));
+    if (_previous != nullptr)
+    {
+      uint32_t first = g_crashJournal.count - count;
+      for (size_t i = 0; i < count; i++)
+      {
+        _previous[i] = g_crashJournal.records[(first + i) % CRASH_JOURNAL_RECORDS];
+        _previous[i].length = std::min<uint8_t>(_previous[i].length, CRASH_JOURNAL_MESSAGE_SIZE);
+      }
+      _previousCount = count;
+    }
+  }
+
+  g_crashJournal.magic = CRASH_JOURNAL_MAGIC;
+  g_crashJournal.count = 0;
+}
+
+/**
+ * @brief Appends a line, truncated to CRASH_JOURNAL_MESSAGE_SIZE bytes.
+ *
+ * The record is filled in before the count moves past it, so a crash in the
+ * middle of an append leaves the older records intact.
+ */
+void CrashJournal::append(uint32_t time, uint32_t uptimeMs, const char *task, uint8_t core, uint8_t level, const char *message, size_t length)
+{
+  if (length > 0 && message[length - 1] == '\n')
+  {
+    length--;
+  }
+  length = std::min<size_t>(length, CRASH_JOURNAL_MESSAGE_SIZE);
+
+  Record &record = g_crashJournal.records[g_crashJournal.count % CRASH_JOURNAL_RECORDS];
+  record.time = time;
+  record.uptimeMs = uptimeMs;
+  memcpy(record.task, task, LOG_TASK_NAME_SIZE);
+  record.core = core;
+  record.level = level;
+  record.length = length;
+  memcpy(record.message, message, length);
+  g_crashJournal.count++;
+}
+
+/**
+ * @brief Checks whether the last reset was a crash.
+ * @return True for a panic, a watchdog or a brownout.
+ */
+bool CrashJournal::wasCrash() const
+{
+  switch (_resetReason)
+  {
+  case ESP_RST_PANIC:
+  case ESP_RST_INT_WDT:
+  case ESP_RST_TASK_WDT:
+  case ESP_RST_WDT:
+  case ESP_RST_BROWNOUT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Describes a reset reason.
+ * @param reason The reset reason.
+ * @return A readable name.
+ */
+const char *CrashJournal::resetReasonName(esp_reset_reason_t reason)
+{
+  switch (reason)
+  {
+  case ESP_RST_POWERON:
+    return "Power On Reset";
+  case ESP_RST_EXT:
+    return "External Reset";
+  case ESP_RST_SW:
+    return "Software Reset";
+  case ESP_RST_PANIC:
+    return "Exception/Panic Reset";
+  case ESP_RST_INT_WDT:
+    return "Interrupt Watchdog Reset";
+  case ESP_RST_TASK_WDT:
+    return "Task Watchdog Reset";
+  case ESP_RST_WDT:
+    return "Other Watchdog Reset";
+  case ESP_RST_DEEPSLEEP:
+    return "Deep Sleep Reset";
+  case ESP_RST_BROWNOUT:
+    return "Brownout Reset";
+  case ESP_RST_SDIO:
+    return "SDIO Reset";
+  default:
+    return "Unknown Reset";
+  }
+}
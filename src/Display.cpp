@@ -3,15 +3,20 @@
  * @brief Implements the Display class for low-level screen and backlight control.
  *
  * This file contains the implementation for initializing the TFT display,
- * managing the backlight brightness using PWM, and drawing simple status
- * messages to the screen.
+ * managing the backlight brightness using PWM, drawing simple status
+ * messages to the screen, and pushing sprites through the DMA pipeline.
  */
 
 #include "Display.h"
 #include "ConfigManager.h"
+#include "Constants.h"
 #include "TimeManager.h"
-#include "fonts/CenturyGothic28.h"
+#include "SerialLog.h"
+#include "FontManager.h"
+#include "RenderProfiler.h"
+#include "PowerManager.h"
 #include <Arduino.h>
+#include <esp_heap_caps.h>
 
 // LEDC (LED Control) constants for managing the backlight PWM.
 #define TFT_BL 6               // Manually define the backlight pin here
@@ -19,6 +24,19 @@
 #define BACKLIGHT_FREQ 5000    // 5 kHz frequency
 #define BACKLIGHT_RESOLUTION 8 // 8-bit resolution (0-255)
 
+// TFT_eSPI only provides the DMA API on processors/buses that support it.
+#if defined(ESP32_DMA)
+#define DISPLAY_USE_DMA
+#endif
+
+// The ILI9488 only accepts 18-bit color over SPI, so DMA bands are expanded
+// to RGB666 (3 bytes per pixel) while they are copied into the DMA buffer.
+#ifdef ILI9488_DRIVER
+#define DMA_BYTES_PER_PIXEL 3
+#else
+#define DMA_BYTES_PER_PIXEL 2
+#endif
+
 /**
  * @brief Initializes the display and backlight.
  *
@@ -45,8 +63,372 @@ void Display::begin()
     tft.fillScreen(TFT_BLACK);
     _updateRotation();
     _updateInversion();
+    _initDmaPipeline();
     xSemaphoreGive(tft_mutex);
   }
+
+  // Parse the smooth fonts once, so pages and sprites can switch between them cheaply.
+  FontManager::getInstance().begin(&tft);
+}
+
+/**
+ * @brief Allocates the DMA staging buffers and enables TFT_eSPI's DMA engine.
+ *
+ * The buffers must live in DMA-capable internal RAM, as sprites themselves
+ * are allocated in PSRAM. If anything fails, `pushSprite()` silently falls
+ * back to blocking pushes. Must be called with the `tft_mutex` held.
+ */
+void Display::_initDmaPipeline()
+{
+#ifdef DISPLAY_USE_DMA
+  _dmaBuffers[0] = (uint8_t *)heap_caps_malloc(DISPLAY_DMA_BUFFER_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  _dmaBuffers[1] = (uint8_t *)heap_caps_malloc(DISPLAY_DMA_BUFFER_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+
+  _dmaReady = _dmaBuffers[0] && _dmaBuffers[1] && tft.initDMA();
+  if (!_dmaReady)
+  {
+    heap_caps_free(_dmaBuffers[0]);
+    heap_caps_free(_dmaBuffers[1]);
+    _dmaBuffers[0] = nullptr;
+    _dmaBuffers[1] = nullptr;
+    LOG_W(LOG_MODULE_DISPLAY, "Display: DMA unavailable, using blocking sprite pushes.\n");
+  }
+#endif
+}
+
+/**
+ * @brief Copies a band of sprite pixels into a DMA buffer in the panel's wire format.
+ *
+ * Sprite pixels are stored as byte-swapped RGB565, which is already the wire
+ * format for 16-bit panels. For the ILI9488 each pixel is expanded to RGB666
+ * the same way TFT_eSPI does it for blocking pushes.
+ *
+ * @param dst The destination DMA buffer.
+ * @param src The first sprite pixel of the band.
+ * @param count The number of pixels to copy.
+ */
+static inline void copyBandToDmaBuffer(uint8_t *dst, const uint16_t *src, uint32_t count)
+{
+#ifdef ILI9488_DRIVER
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint16_t color = (src[i] >> 8) | (src[i] << 8);
+    *dst++ = (color & 0xF800) >> 8;
+    *dst++ = (color & 0x07E0) >> 3;
+    *dst++ = (color & 0x001F) << 3;
+  }
+#else
+  memcpy(dst, src, count * 2);
+#endif
+}
+
+/**
+ * @brief Copies a band of 4 bpp palettized sprite pixels into a DMA buffer.
+ *
+ * @param dst The destination DMA buffer.
+ * @param row The first byte of the sprite row (two pixels per byte, even x in the high nibble).
+ * @param x The x-coordinate of the first pixel to copy within the row.
+ * @param count The number of pixels to copy.
+ * @param lut The palette, already converted to the panel's wire format.
+ */
+static inline void copyPalettizedToDmaBuffer(uint8_t *dst, const uint8_t *row, int32_t x, uint32_t count, const uint8_t *lut)
+{
+  for (uint32_t i = 0; i < count; i++, x++)
+  {
+    uint8_t pair = row[x >> 1];
+    const uint8_t *color = lut + ((x & 1) ? (pair & 0x0F) : (pair >> 4)) * DMA_BYTES_PER_PIXEL;
+    for (int b = 0; b < DMA_BYTES_PER_PIXEL; b++)
+    {
+      *dst++ = color[b];
+    }
+  }
+}
+
+/**
+ * @brief Copies a region of a sprite into a 16 bpp off-screen frame.
+ *
+ * Both sprites store byte-swapped RGB565, so 16 bpp rows are copied directly
+ * and 4 bpp pixels are looked up in a byte-swapped copy of the palette.
+ *
+ * @param frame The destination frame.
+ * @param sprite The source sprite.
+ * @param tx The frame x-coordinate of the region's top-left corner.
+ * @param ty The frame y-coordinate of the region's top-left corner.
+ * @param sx The x-coordinate of the region within the sprite.
+ * @param sy The y-coordinate of the region within the sprite.
+ * @param sw The width of the region.
+ * @param sh The height of the region.
+ */
+static void copySpriteToFrame(TFT_eSprite &frame, TFT_eSprite &sprite, int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh)
+{
+  int32_t frameW = frame.width();
+  int32_t frameH = frame.height();
+
+  // Clip the region to the frame.
+  if (tx < 0)
+  {
+    sx -= tx;
+    sw += tx;
+    tx = 0;
+  }
+  if (ty < 0)
+  {
+    sy -= ty;
+    sh += ty;
+    ty = 0;
+  }
+  sw = min(sw, frameW - tx);
+  sh = min(sh, frameH - ty);
+
+  uint16_t *dst = (uint16_t *)frame.getPointer();
+  const uint8_t *src = (const uint8_t *)sprite.getPointer();
+  if (sw <= 0 || sh <= 0 || dst == nullptr || src == nullptr)
+  {
+    return;
+  }
+
+  int32_t spriteW = sprite.width();
+  if (sprite.getColorDepth() == 16)
+  {
+    for (int32_t r = 0; r < sh; r++)
+    {
+      memcpy(dst + (ty + r) * frameW + tx, (const uint16_t *)src + (sy + r) * spriteW + sx, sw * sizeof(uint16_t));
+    }
+  }
+  else if (sprite.getColorDepth() == 4)
+  {
+    uint16_t lut[16];
+    for (uint8_t i = 0; i < 16; i++)
+    {
+      uint16_t color = sprite.getPaletteColor(i);
+      lut[i] = (color >> 8) | (color << 8);
+    }
+    const int32_t packedStride = ((spriteW + 1) & ~1) / 2;
+    for (int32_t r = 0; r < sh; r++)
+    {
+      const uint8_t *row = src + (sy + r) * packedStride;
+      uint16_t *out = dst + (ty + r) * frameW + tx;
+      for (int32_t x = sx; x < sx + sw; x++)
+      {
+        uint8_t pair = row[x >> 1];
+        *out++ = lut[(x & 1) ? (pair & 0x0F) : (pair >> 4)];
+      }
+    }
+  }
+  else
+  {
+    // Other depths are rare; go through the sprite's own pixel conversion.
+    for (int32_t r = 0; r < sh; r++)
+    {
+      for (int32_t c = 0; c < sw; c++)
+      {
+        frame.drawPixel(tx + c, ty + r, sprite.readPixel(sx + c, sy + r));
+      }
+    }
+  }
+}
+
+/**
+ * @brief Pushes a sprite to the screen through the double-buffered DMA pipeline.
+ *
+ * @param sprite The sprite to push.
+ * @param x The screen x-coordinate of the sprite's top-left corner.
+ * @param y The screen y-coordinate of the sprite's top-left corner.
+ */
+void Display::pushSprite(TFT_eSprite &sprite, int32_t x, int32_t y)
+{
+  pushSprite(sprite, x, y, 0, 0, sprite.width(), sprite.height());
+}
+
+/**
+ * @brief Pushes a rectangular region of a sprite through the DMA pipeline.
+ *
+ * The region is split into horizontal bands that fit in a DMA buffer. Each band
+ * is copied into the idle buffer while the other one is still being
+ * transmitted, then queued. This returns as soon as the last band is queued,
+ * leaving the final transfer to overlap with whatever the caller does next.
+ *
+ * @param sprite The sprite to push from.
+ * @param x The screen x-coordinate the sprite's top-left corner maps to.
+ * @param y The screen y-coordinate the sprite's top-left corner maps to.
+ * @param sx The x-coordinate of the region within the sprite.
+ * @param sy The y-coordinate of the region within the sprite.
+ * @param sw The width of the region.
+ * @param sh The height of the region.
+ */
+void Display::pushSprite(TFT_eSprite &sprite, int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t sw, int32_t sh)
+{
+  int32_t spriteW = sprite.width();
+  int32_t spriteH = sprite.height();
+
+  // Clip the region to the sprite.
+  if (sx < 0)
+  {
+    sw += sx;
+    sx = 0;
+  }
+  if (sy < 0)
+  {
+    sh += sy;
+    sy = 0;
+  }
+  sw = min(sw, spriteW - sx);
+  sh = min(sh, spriteH - sy);
+  if (sw <= 0 || sh <= 0)
+  {
+    return;
+  }
+
+  int32_t tx = x + sx;
+  int32_t ty = y + sy;
+
+  RenderProfiler &profiler = RenderProfiler::getInstance();
+  uint32_t pushStart = profiler.isEnabled() ? micros() : 0;
+
+  if (_captureFrame != nullptr)
+  {
+    copySpriteToFrame(*_captureFrame, sprite, tx, ty, sx, sy, sw, sh);
+    return;
+  }
+
+#ifdef DISPLAY_USE_DMA
+  const uint16_t *pixels = (const uint16_t *)sprite.getPointer();
+  const uint8_t colorDepth = sprite.getColorDepth();
+
+  int32_t rowsPerBand = DISPLAY_DMA_BUFFER_SIZE / (sw * DMA_BYTES_PER_PIXEL);
+#ifdef ILI9488_DRIVER
+  // DMA transfers are counted in 16-bit words, so RGB666 bands of an odd-width
+  // region need an even number of rows.
+  if (sw & 1)
+  {
+    rowsPerBand &= ~1;
+  }
+#endif
+
+  // Only fully on-screen 16-bit and 4-bit palettized sprites can take the DMA path.
+  bool canUseDma = _dmaReady && pixels != nullptr && (colorDepth == 16 || colorDepth == 4) && rowsPerBand > 0 &&
+                   tx >= 0 && ty >= 0 && tx + sw <= tft.width() && ty + sh <= tft.height();
+  if (canUseDma)
+  {
+    // For palettized sprites, convert the 16 palette entries to wire format once per push.
+    uint8_t lut[16 * DMA_BYTES_PER_PIXEL];
+    const int32_t packedStride = ((spriteW + 1) & ~1) / 2;
+    if (colorDepth == 4)
+    {
+      for (uint8_t i = 0; i < 16; i++)
+      {
+        uint16_t color = sprite.getPaletteColor(i);
+        uint16_t swapped = (color >> 8) | (color << 8);
+        copyBandToDmaBuffer(lut + i * DMA_BYTES_PER_PIXEL, &swapped, 1);
+      }
+    }
+
+    if (!_dmaInTransaction)
+    {
+      // Keep CS asserted across queued transfers until flushPushes().
+      tft.startWrite();
+      _dmaInTransaction = true;
+    }
+
+    // The buffer is already in wire format, so the driver must not swap it.
+    bool oldSwapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(false);
+
+    for (int32_t row = 0; row < sh; row += rowsPerBand)
+    {
+      int32_t rows = min(rowsPerBand, sh - row);
+      uint32_t bytes = rows * sw * DMA_BYTES_PER_PIXEL;
+
+      if (bytes & 1)
+      {
+        // Odd trailing RGB666 band; cannot be expressed as 16-bit words.
+        tft.dmaWait();
+        sprite.pushSprite(tx, ty + row, sx, sy + row, sw, rows);
+        continue;
+      }
+
+      // Fill the idle buffer while the other one is still on the bus.
+      uint8_t *buffer = _dmaBuffers[_dmaBufferIndex];
+      if (colorDepth == 4)
+      {
+        const uint8_t *packed = (const uint8_t *)pixels;
+        for (int32_t r = 0; r < rows; r++)
+        {
+          copyPalettizedToDmaBuffer(buffer + r * sw * DMA_BYTES_PER_PIXEL, packed + (sy + row + r) * packedStride, sx, sw, lut);
+        }
+      }
+      else if (sw == spriteW)
+      {
+        copyBandToDmaBuffer(buffer, pixels + (sy + row) * spriteW, rows * sw);
+      }
+      else
+      {
+        for (int32_t r = 0; r < rows; r++)
+        {
+          copyBandToDmaBuffer(buffer + r * sw * DMA_BYTES_PER_PIXEL, pixels + (sy + row + r) * spriteW + sx, sw);
+        }
+      }
+
+      tft.dmaWait();
+      tft.setAddrWindow(tx, ty + row, sw, rows);
+      tft.pushPixelsDMA((uint16_t *)buffer, bytes / 2);
+      _dmaBufferIndex ^= 1;
+    }
+
+    tft.setSwapBytes(oldSwapBytes);
+    if (profiler.isEnabled())
+    {
+      profiler.addPush(micros() - pushStart, sw * sh);
+    }
+    return;
+  }
+
+  flushPushes();
+#endif
+  if (sx == 0 && sy == 0 && sw == spriteW && sh == spriteH)
+  {
+    sprite.pushSprite(x, y);
+  }
+  else
+  {
+    sprite.pushSprite(tx, ty, sx, sy, sw, sh);
+  }
+  if (profiler.isEnabled())
+  {
+    profiler.addPush(micros() - pushStart, sw * sh);
+  }
+}
+
+/**
+ * @brief Waits for all queued DMA transfers and closes the SPI transaction.
+ */
+void Display::flushPushes()
+{
+#ifdef DISPLAY_USE_DMA
+  if (_dmaInTransaction)
+  {
+    RenderProfiler &profiler = RenderProfiler::getInstance();
+    uint32_t waitStart = profiler.isEnabled() ? micros() : 0;
+    tft.dmaWait();
+    tft.endWrite();
+    _dmaInTransaction = false;
+    if (profiler.isEnabled())
+    {
+      profiler.addPush(micros() - waitStart, 0);
+    }
+  }
+#endif
+}
+
+/**
+ * @brief Starts composing sprite pushes into an off-screen frame.
+ * @param frame The frame to compose into.
+ */
+void Display::beginCapture(TFT_eSprite *frame)
+{
+  // Anything already queued belongs on the panel.
+  flushPushes();
+  _captureFrame = frame;
 }
 
 /**
@@ -114,9 +496,9 @@ void Display::drawStatusMessage(const char *message)
     tft.fillScreen(TFT_BLACK);
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
     tft.setTextDatum(MC_DATUM);
-    tft.loadFont(CenturyGothic28);
+    FontManager::getInstance().use(tft, FONT_CENTURY_GOTHIC_28);
     tft.drawString(message, tft.width() / 2, tft.height() / 2);
-    tft.unloadFont(); // Unload font to free up memory
+    FontManager::getInstance().release(tft); // Back to the built-in fonts
     xSemaphoreGive(tft_mutex);
   }
 }
@@ -133,10 +515,10 @@ void Display::drawMultiLineStatusMessage(const char *line1, const char *line2)
     tft.fillScreen(TFT_BLACK);
     tft.setTextColor(TFT_WHITE, TFT_BLACK);
     tft.setTextDatum(MC_DATUM);
-    tft.loadFont(CenturyGothic28);
+    FontManager::getInstance().use(tft, FONT_CENTURY_GOTHIC_28);
     tft.drawString(line1, tft.width() / 2, tft.height() / 2 - 15);
     tft.drawString(line2, tft.width() / 2, tft.height() / 2 + 15);
-    tft.unloadFont(); // Unload font to free up memory
+    FontManager::getInstance().release(tft); // Back to the built-in fonts
     xSemaphoreGive(tft_mutex);
   }
 }
@@ -188,15 +570,15 @@ void Display::updateBrightness()
     return; // Skip normal brightness logic
   }
 
-  auto &config = ConfigManager::getInstance();
+  ConfigSnapshotRef config = ConfigManager::getInstance().snapshot();
   int dutyCycle;
 
   // Check if auto-brightness is enabled.
-  if (config.isAutoBrightness())
+  if (config->autoBrightness)
   {
     uint8_t hour = TimeManager::getInstance().getHour();
-    uint8_t startHour = config.getAutoBrightnessStartHour();
-    uint8_t endHour = config.getAutoBrightnessEndHour();
+    uint8_t startHour = config->autoBrightnessStartHour;
+    uint8_t endHour = config->autoBrightnessEndHour;
 
     // Determine if the current time is within the "day" period.
     bool isDayTime;
@@ -213,27 +595,27 @@ void Display::updateBrightness()
 
     if (isDayTime)
     {
-      dutyCycle = config.getDayBrightness();
+      dutyCycle = config->dayBrightness;
     }
     else
     {
-      dutyCycle = config.getNightBrightness();
+      dutyCycle = config->nightBrightness;
     }
   }
   else
   {
-    if (config.getBrightness() > 255)
+    if (config->brightness > 255)
     {
       dutyCycle = 255; // Clamp to max value
     }
-    else if (config.getBrightness() < 10)
+    else if (config->brightness < 10)
     {
       dutyCycle = 10; // Clamp to min value
     }
     else
     {
       // Use the manually set brightness value.
-      dutyCycle = config.getBrightness();
+      dutyCycle = config->brightness;
     }
   }
 
@@ -252,6 +634,8 @@ void Display::updateBrightness()
 void Display::lock()
 {
   xSemaphoreTake(tft_mutex, portMAX_DELAY);
+  // SPI and DMA transfers need the clocks running until the display is unlocked.
+  PowerManager::getInstance().acquire(POWER_LOCK_DISPLAY);
 }
 
 /**
@@ -262,5 +646,7 @@ void Display::lock()
  */
 void Display::unlock()
 {
+  flushPushes();
+  PowerManager::getInstance().release(POWER_LOCK_DISPLAY);
   xSemaphoreGive(tft_mutex);
 }
\ No newline at end of file
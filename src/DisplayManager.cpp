@@ -14,8 +14,17 @@
 #include "Display.h"
 #include "AlarmManager.h"
 #include "TimeManager.h"
-#include "fonts/CenturyGothicBold48.h"
+#include "FontManager.h"
 #include "SerialLog.h"
+#include "RenderProfiler.h"
+#include <esp_task_wdt.h>
+#include <esp_timer.h>
+
+// Palette indices of the 4 bpp alarm overlay sprite.
+static constexpr uint8_t ALARM_PALETTE_BACKGROUND = 0;
+static constexpr uint8_t ALARM_PALETTE_BAR = 1;
+static constexpr uint8_t ALARM_PALETTE_BUTTON = 2; ///< Start of the button-to-text ramp.
+static constexpr uint8_t ALARM_PALETTE_TEXT = 15;  ///< End of the button-to-text ramp.
 
 /**
  * @brief Private constructor to enforce the singleton pattern.
@@ -29,7 +38,35 @@ DisplayManager::DisplayManager() : _tft(nullptr), _currentPage(nullptr), _alarmS
 void DisplayManager::begin(TFT_eSPI &tft_instance)
 {
   this->_tft = &tft_instance;
+
+  size_t arenaSize = SPRITE_ARENA_SIZE;
+  if (PAGE_PRERENDER_ENABLED)
+  {
+    arenaSize += (size_t)_tft->width() * _tft->height() * sizeof(uint16_t) + 4;
+  }
+  _spriteArena.begin(arenaSize);
   initAlarmSprite();
+  if (PAGE_PRERENDER_ENABLED)
+  {
+    initBackFrame();
+  }
+}
+
+/**
+ * @brief Creates the full-screen back frame used to pre-render the next page.
+ *
+ * If it cannot be placed in the arena, pre-rendering is disabled and pages
+ * are entered directly on the screen as before.
+ */
+void DisplayManager::initBackFrame()
+{
+  _backFrame = new ArenaSprite(_tft, 16);
+  if (_backFrame->createSprite(_tft->width(), _tft->height()) == nullptr || !_backFrame->isInArena())
+  {
+    LOG_W(LOG_MODULE_DISPLAY, "DisplayManager: no room for the back frame, page pre-rendering disabled.\n");
+    delete _backFrame;
+    _backFrame = nullptr;
+  }
 }
 
 #include <utility> // For std::move
@@ -69,6 +106,12 @@ void DisplayManager::setPage(int index, bool forceRedraw)
   }
 
   Display::getInstance().lock();
+  bool prerendered = (index == _backPageIndex) && !forceRedraw;
+  if (!prerendered)
+  {
+    dropBackPage();
+  }
+
   if (_currentPage)
   {
     _currentPage->onExit();
@@ -76,7 +119,14 @@ void DisplayManager::setPage(int index, bool forceRedraw)
 
   _currentPageIndex = index;
   _currentPage = _pages[_currentPageIndex].get();
-  _currentPage->onEnter(*_tft);
+  if (prerendered)
+  {
+    showBackFrame();
+  }
+  else
+  {
+    _currentPage->onEnter(*_tft);
+  }
   Display::getInstance().unlock();
 
   // After a page change, the screen is cleared, so the icon is no longer visible.
@@ -95,38 +145,107 @@ void DisplayManager::setPage(int index, bool forceRedraw)
  */
 void DisplayManager::cyclePage()
 {
-  auto &config = ConfigManager::getInstance();
-  std::vector<int> enabled = config.getEnabledPages();
+  int nextIndex = nextPageIndex();
+  LOG_D(LOG_MODULE_DISPLAY, "Cycling to page index: %d\n", nextIndex);
+  setPage(nextIndex);
+}
+
+int DisplayManager::nextPageIndex()
+{
+  std::vector<int> enabled = ConfigManager::getInstance().getEnabledPages();
 
   if (enabled.empty())
   {
     // Fallback if nothing enabled
-    setPage(0);
-    return;
+    return 0;
   }
 
-  int currentIndex = _currentPageIndex;
-  int nextIndex = -1;
-
-  // Find current index in the enabled list
+  // Find current index in the enabled list, and go to the next one
   for (size_t i = 0; i < enabled.size(); ++i)
   {
-    if (enabled[i] == currentIndex)
+    if (enabled[i] == _currentPageIndex)
     {
-      // Found it, go to next
-      nextIndex = enabled[(i + 1) % enabled.size()];
-      break;
+      return enabled[(i + 1) % enabled.size()];
     }
   }
 
-  if (nextIndex == -1)
+  // Current page not in list, go to first enabled
+  return enabled[0];
+}
+
+void DisplayManager::prerenderNextPage()
+{
+  if (_backFrame == nullptr || _currentPage == nullptr)
   {
-    // Current page not in list, go to first enabled
-    nextIndex = enabled[0];
+    return;
   }
 
-  SerialLog::getInstance().printf("Cycling to page index: %d\n", nextIndex);
-  setPage(nextIndex);
+  if (!_backFrameStale)
+  {
+    return; // Nothing changed since the back frame was last built.
+  }
+
+  int nextIndex = nextPageIndex();
+  if (nextIndex == _backPageIndex)
+  {
+    _backFrameStale = false; // Already waiting in the back frame.
+    return;
+  }
+
+  Display &display = Display::getInstance();
+  display.lock();
+  dropBackPage();
+  _backFrameStale = false;
+  if (nextIndex >= 0 && nextIndex < (int)_pages.size() && nextIndex != _currentPageIndex)
+  {
+    int64_t start = esp_timer_get_time();
+    Page *page = _pages[nextIndex].get();
+    display.beginCapture(_backFrame);
+    page->onEnter(*_backFrame);
+    page->update();
+    page->render(*_backFrame);
+    display.endCapture();
+    _backPageIndex = nextIndex;
+    LOG_D(LOG_MODULE_DISPLAY, "Pre-rendered page %d in %lu us\n", nextIndex, (unsigned long)(esp_timer_get_time() - start));
+  }
+  display.unlock();
+}
+
+/**
+ * @brief Marks the back frame for a rebuild after the next frame.
+ */
+void DisplayManager::invalidateBackFrame()
+{
+  _backFrameStale = true;
+}
+
+/**
+ * @brief Shows the pre-rendered page with a single full-screen push.
+ *
+ * The page last drew into the back frame when it was pre-rendered, so one
+ * more incremental pass brings only the fields that changed since then (such
+ * as the seconds) up to date before the frame goes out.
+ */
+void DisplayManager::showBackFrame()
+{
+  Display &display = Display::getInstance();
+  display.beginCapture(_backFrame);
+  _currentPage->update();
+  _currentPage->render(*_backFrame);
+  display.endCapture();
+  display.pushSprite(*_backFrame, 0, 0);
+  _backPageIndex = -1;
+  _backFrameStale = true;
+}
+
+void DisplayManager::dropBackPage()
+{
+  if (_backPageIndex >= 0)
+  {
+    _pages[_backPageIndex]->onExit();
+    _backPageIndex = -1;
+  }
+  _backFrameStale = true;
 }
 
 /**
@@ -134,11 +253,20 @@ void DisplayManager::cyclePage()
  *
  * This should be called in the main application loop. It handles refresh
  * requests and then calls the `update()` and `render()` methods of the
- * current page.
+ * current page. When the RenderProfiler is enabled, the whole frame is
+ * recorded against the current page.
  */
 void DisplayManager::update()
 {
+  RenderProfiler &profiler = RenderProfiler::getInstance();
   Display::getInstance().lock();
+  profiler.beginFrame(_currentPageIndex);
+  if (_fullRefresh || _partialRefresh)
+  {
+    // The settings changed, so a pre-rendered page may be out of date.
+    dropBackPage();
+  }
+
   if (_fullRefresh)
   {
     if (_currentPage)
@@ -166,12 +294,182 @@ void DisplayManager::update()
     _currentPage->render(*_tft);
   }
 
+  // The overlay may draw directly to the TFT, so let the page's queued
+  // sprite pushes land first.
+  Display::getInstance().flushPushes();
+  _pagePushedMicros = esp_timer_get_time();
+
   // Render Alarm Overlay on top of everything
   renderAlarmOverlay();
 
+  // Drain the last pushes inside the frame so the profiler sees their cost.
+  Display::getInstance().flushPushes();
+  profiler.endFrame();
   Display::getInstance().unlock();
 }
 
+/**
+ * @brief Starts the render task pinned to the application core.
+ */
+void DisplayManager::startRenderTask()
+{
+  if (_renderTaskHandle != nullptr)
+  {
+    return;
+  }
+
+  xTaskCreatePinnedToCore(
+      renderTask,
+      "RenderTask",
+      RENDER_TASK_STACK_SIZE,
+      NULL,
+      RENDER_TASK_PRIORITY,
+      &_renderTaskHandle,
+      RENDER_TASK_CORE);
+}
+
+/**
+ * @brief The render task loop.
+ *
+ * Blocks on its task notification until either another task requests a frame
+ * or the next second is due.
+ *
+ * While the clock is free running the next second edge is known to the
+ * microsecond, so the task sleeps until RENDER_EDGE_SPIN_US before it and
+ * spins out the rest; the frame then starts on the edge rather than on the
+ * next scheduler tick. After the frame, the page draws the following second
+ * into its sprites, leaving only the pushes for the edge. Otherwise the RTC
+ * is polled every millisecond around the predicted second edge, so the frame
+ * for a new second starts within a millisecond or two of it.
+ *
+ * @param param Unused.
+ */
+void DisplayManager::renderTask(void *param)
+{
+  LOG_D(LOG_MODULE_DISPLAY, "Render Task started on Core 1\n");
+  esp_task_wdt_add(NULL);
+
+  auto &self = DisplayManager::getInstance();
+  auto &timeManager = TimeManager::getInstance();
+
+  for (;;)
+  {
+    uint32_t events = 0;
+    uint32_t waitMs;
+    int64_t edgeMicros = timeManager.nextSecondEdgeMicros();
+    if (edgeMicros != 0)
+    {
+      int64_t sleepUs = edgeMicros - esp_timer_get_time() - RENDER_EDGE_SPIN_US;
+      waitMs = sleepUs > 0 ? (uint32_t)(sleepUs / 1000) : 0;
+    }
+    else
+    {
+      waitMs = max((uint32_t)1, timeManager.msUntilNextPoll());
+    }
+    xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(waitMs));
+
+    if (edgeMicros != 0 && events == 0)
+    {
+      while (esp_timer_get_time() < edgeMicros)
+      {
+      }
+    }
+
+    if (timeManager.update())
+    {
+      events |= RENDER_EVENT_SECOND;
+    }
+
+    if (events != 0)
+    {
+      self.update();
+      if (events & RENDER_EVENT_SECOND)
+      {
+        self.recordEdgeLatency(timeManager.lastSecondEdgeMicros());
+      }
+      self.prerenderNextSecond();
+      self.prerenderNextPage();
+    }
+
+    esp_task_wdt_reset();
+  }
+}
+
+/**
+ * @brief Lets the current page draw the next second ahead of time.
+ *
+ * Only done while the clock is free running, when the next second is
+ * certain to be the current one plus one.
+ */
+void DisplayManager::prerenderNextSecond()
+{
+  auto &timeManager = TimeManager::getInstance();
+  if (_currentPage == nullptr || timeManager.nextSecondEdgeMicros() == 0)
+  {
+    return;
+  }
+
+  Display &display = Display::getInstance();
+  display.lock();
+  _currentPage->prerenderSecond(timeManager.getCachedTime() + TimeSpan(1));
+  display.unlock();
+}
+
+/**
+ * @brief Adds the last frame to the edge latency histogram.
+ * @param edgeMicros esp_timer_get_time() at the edge of the second the frame
+ *                   shows; 0 if the edge wasn't pinned down, and nothing is recorded.
+ */
+void DisplayManager::recordEdgeLatency(int64_t edgeMicros)
+{
+  if (edgeMicros == 0 || _pagePushedMicros < edgeMicros)
+  {
+    return;
+  }
+  uint32_t latencyUs = (uint32_t)(_pagePushedMicros - edgeMicros);
+  int bucket = 0;
+  while (bucket < EdgeLatencyStats::BUCKETS - 1 && latencyUs >= EdgeLatencyStats::BUCKET_LIMITS_MS[bucket] * 1000u)
+  {
+    bucket++;
+  }
+
+  portENTER_CRITICAL(&_edgeLatencyMux);
+  _edgeLatency.frames++;
+  _edgeLatency.buckets[bucket]++;
+  _edgeLatency.lastUs = latencyUs;
+  if (latencyUs > _edgeLatency.maxUs)
+  {
+    _edgeLatency.maxUs = latencyUs;
+  }
+  portEXIT_CRITICAL(&_edgeLatencyMux);
+}
+
+/**
+ * @brief Gets the edge-to-screen latency of the second frames.
+ * @return A copy of the histogram.
+ */
+EdgeLatencyStats DisplayManager::getEdgeLatencyStats() const
+{
+  portENTER_CRITICAL(&_edgeLatencyMux);
+  EdgeLatencyStats stats = _edgeLatency;
+  portEXIT_CRITICAL(&_edgeLatencyMux);
+  return stats;
+}
+
+/**
+ * @brief Wakes the render task, or renders synchronously if it isn't running yet.
+ * @param events A bitmask of `RenderEvent` values.
+ */
+void DisplayManager::requestRender(uint32_t events)
+{
+  if (_renderTaskHandle == nullptr)
+  {
+    update();
+    return;
+  }
+  xTaskNotify(_renderTaskHandle, events, eSetBits);
+}
+
 /**
  * @brief Requests a partial refresh of the display.
  *
@@ -181,6 +479,10 @@ void DisplayManager::update()
 void DisplayManager::requestPartialRefresh()
 {
   _partialRefresh = true;
+  if (_renderTaskHandle != nullptr)
+  {
+    xTaskNotify(_renderTaskHandle, RENDER_EVENT_CONFIG, eSetBits);
+  }
 }
 
 /**
@@ -192,6 +494,10 @@ void DisplayManager::requestPartialRefresh()
 void DisplayManager::requestFullRefresh()
 {
   _fullRefresh = true;
+  if (_renderTaskHandle != nullptr)
+  {
+    xTaskNotify(_renderTaskHandle, RENDER_EVENT_CONFIG, eSetBits);
+  }
 }
 
 /**
@@ -235,19 +541,19 @@ void DisplayManager::drawAlarmIcon(bool enabled, bool snoozing)
   Display::getInstance().lock();
   if (enabled)
   {
-    String colorHex = snoozing ? ConfigManager::getInstance().getSnoozeIconColor() : ConfigManager::getInstance().getAlarmIconColor();
-    uint16_t color = hexToRGB565(colorHex.c_str());
+    Theme theme = ConfigManager::getInstance().getTheme();
+    uint16_t color = snoozing ? theme.snoozeIcon : theme.alarmIcon;
     // Bell body using a rounded rectangle
     _tft->fillRoundRect(ALARM_ICON_X + 2, ALARM_ICON_Y, 12, 11, 4, color);
     // Bell lip/flare
     _tft->fillRect(ALARM_ICON_X, ALARM_ICON_Y + 10, 16, 3, color);
     // Clapper (small circle inside)
-    _tft->fillCircle(ALARM_ICON_X + 8, ALARM_ICON_Y + 12, 2, hexToRGB565(ConfigManager::getInstance().getBackgroundColor().c_str()));
+    _tft->fillCircle(ALARM_ICON_X + 8, ALARM_ICON_Y + 12, 2, theme.background);
   }
   else
   {
     // Erase the icon by drawing a black rectangle over its bounding box
-    _tft->fillRect(ALARM_ICON_X, ALARM_ICON_Y, ALARM_ICON_WIDTH, ALARM_ICON_HEIGHT, hexToRGB565(ConfigManager::getInstance().getBackgroundColor().c_str()));
+    _tft->fillRect(ALARM_ICON_X, ALARM_ICON_Y, ALARM_ICON_WIDTH, ALARM_ICON_HEIGHT, ConfigManager::getInstance().snapshot()->theme.background);
   }
   Display::getInstance().unlock();
 }
@@ -262,15 +568,16 @@ void DisplayManager::drawAlarmIcon(bool enabled, bool snoozing)
  */
 void DisplayManager::showErrorScreen(const char *message)
 {
+  Theme theme = ConfigManager::getInstance().getTheme();
   Display::getInstance().lock();
-  _tft->fillScreen(hexToRGB565(ConfigManager::getInstance().getBackgroundColor().c_str()));
+  _tft->fillScreen(theme.background);
   _tft->setTextDatum(MC_DATUM);
-  _tft->setTextColor(hexToRGB565(ConfigManager::getInstance().getErrorTextColor().c_str()));
+  _tft->setTextColor(theme.errorText);
   _tft->drawString(message, _tft->width() / 2, _tft->height() / 2, 4); // Use font 4 for a clear message
 
   // Reset text datum and color for any potential subsequent drawing
   _tft->setTextDatum(TL_DATUM);
-  _tft->setTextColor(hexToRGB565(ConfigManager::getInstance().getTimeColor().c_str()));
+  _tft->setTextColor(theme.time);
   Display::getInstance().unlock();
 }
 
@@ -278,11 +585,10 @@ void DisplayManager::initAlarmSprite()
 {
   if (_alarmSprite == nullptr)
   {
-    _alarmSprite = new TFT_eSprite(_tft);
-    _tft->loadFont(CenturyGothicBold48);
-    int textWidth = _tft->textWidth("ALARM");
+    _alarmSprite = new ArenaSprite(_tft);
+    FontManager::getInstance().use(*_alarmSprite, FONT_CENTURY_GOTHIC_BOLD_48);
+    int textWidth = _alarmSprite->textWidth("ALARM");
     _alarmSprite->createSprite(textWidth + ALARM_SPRITE_WIDTH_PADDING, ALARM_SPRITE_HEIGHT);
-    _tft->unloadFont();
   }
 }
 
@@ -306,13 +612,23 @@ void DisplayManager::renderAlarmOverlay()
 
   _wasAlarmActive = true;
 
-  uint16_t alarmColor = hexToRGB565(config.getAlarmTextColor().c_str());
-  uint16_t bgColor = hexToRGB565(config.getBackgroundColor().c_str());
+  ConfigSnapshotRef snapshot = config.snapshot();
+  if (snapshot->themeGeneration != _alarmThemeGeneration)
+  {
+    _alarmThemeGeneration = snapshot->themeGeneration;
+    const Theme &theme = snapshot->theme;
+
+    // Palette: the screen background, the progress bar, and a ramp from the
+    // button color to the (inverted) text color for the anti-aliased label.
+    _alarmSprite->setPaletteColor(ALARM_PALETTE_BACKGROUND, theme.background);
+    _alarmSprite->setPaletteColor(ALARM_PALETTE_BAR, TFT_WHITE);
+    _alarmSprite->setPaletteRamp(ALARM_PALETTE_BUTTON, ALARM_PALETTE_TEXT, theme.alarmText, theme.background);
+  }
 
   // Clear the sprite with the background color
-  _alarmSprite->fillSprite(bgColor);
+  _alarmSprite->fillSprite(ALARM_PALETTE_BACKGROUND);
 
-  _alarmSprite->loadFont(CenturyGothicBold48);
+  FontManager::getInstance().use(*_alarmSprite, FONT_CENTURY_GOTHIC_BOLD_48);
   _alarmSprite->setTextDatum(MC_DATUM);
 
   bool showButton = false;
@@ -346,10 +662,10 @@ void DisplayManager::renderAlarmOverlay()
   if (showButton)
   {
     // Draw the rounded button body
-    _alarmSprite->fillRoundRect(0, 0, _alarmSprite->width(), _alarmSprite->height(), 10, alarmColor);
+    _alarmSprite->fillRoundRect(0, 0, _alarmSprite->width(), _alarmSprite->height(), 10, ALARM_PALETTE_BUTTON);
 
     // Set text color to background color (inverted)
-    _alarmSprite->setTextColor(bgColor);
+    _alarmSprite->setTextColor(ALARM_PALETTE_TEXT, ALARM_PALETTE_BUTTON);
     _alarmSprite->drawString(text.c_str(), _alarmSprite->width() / 2, _alarmSprite->height() / 2);
 
     // Draw the progress bar if the button is being held
@@ -358,7 +674,7 @@ void DisplayManager::renderAlarmOverlay()
       int margin = 5;
       int availableWidth = _alarmSprite->width() - (2 * margin);
       int barWidth = availableWidth * _dismissProgress;
-      _alarmSprite->fillRoundRect(margin, _alarmSprite->height() - ALARM_PROGRESS_BAR_HEIGHT - margin, barWidth, ALARM_PROGRESS_BAR_HEIGHT, 3, TFT_WHITE);
+      _alarmSprite->fillRoundRect(margin, _alarmSprite->height() - ALARM_PROGRESS_BAR_HEIGHT - margin, barWidth, ALARM_PROGRESS_BAR_HEIGHT, 3, ALARM_PALETTE_BAR);
     }
   }
   else
@@ -371,7 +687,7 @@ void DisplayManager::renderAlarmOverlay()
   int x = (screenWidth - _alarmSprite->width()) / 2;
   int y = (screenHeight - _alarmSprite->height()) / 2;
 
-  _alarmSprite->pushSprite(x, y);
+  Display::getInstance().pushSprite(*_alarmSprite, x, y);
 }
 
 void DisplayManager::setDismissProgress(float progress)
@@ -389,7 +705,7 @@ void DisplayManager::clearAlarmOverlay()
     int x = (screenWidth - _alarmSprite->width()) / 2;
     int y = (screenHeight - _alarmSprite->height()) / 2;
 
-    uint16_t bgColor = hexToRGB565(ConfigManager::getInstance().getBackgroundColor().c_str());
+    uint16_t bgColor = ConfigManager::getInstance().snapshot()->theme.background;
     _tft->fillRect(x, y, _alarmSprite->width(), _alarmSprite->height(), bgColor);
   }
 }
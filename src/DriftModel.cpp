@@ -0,0 +1,88 @@
+/**
+ * @file DriftModel.cpp
+ * @brief Implements the least-squares fit of the RTC's frequency error.
+ */
+#include "DriftModel.h"
+
+/**
+ * @brief Adds a comparison, undoing the steps made since the first sample.
+ * @param time The NTP time of the comparison, in seconds.
+ * @param offsetUs How far the RTC was ahead of NTP, in microseconds.
+ */
+void DriftModel::add(uint32_t time, int64_t offsetUs)
+{
+  _samples[_next] = {time, offsetUs - _stepUs};
+  _next = (_next + 1) % DRIFT_MAX_SAMPLES;
+  if (_count < DRIFT_MAX_SAMPLES)
+  {
+    _count++;
+  }
+}
+
+/**
+ * @brief Notes that the RTC was stepped by `correctionUs`.
+ * @param correctionUs The amount the RTC was moved forward, in microseconds.
+ */
+void DriftModel::step(int64_t correctionUs)
+{
+  if (_count > 0)
+  {
+    _stepUs += correctionUs;
+  }
+}
+
+/**
+ * @brief Drops every sample.
+ */
+void DriftModel::reset()
+{
+  _count = 0;
+  _next = 0;
+  _stepUs = 0;
+}
+
+/**
+ * @brief Fits a line through the samples by least squares.
+ *
+ * Times and offsets are taken relative to the first sample, so the sums stay
+ * well inside a double's precision.
+ * @param ppm Receives the frequency error; positive when the RTC runs fast.
+ * @return True if there were enough samples to fit.
+ */
+bool DriftModel::fit(float &ppm) const
+{
+  if (_count < DRIFT_MIN_SAMPLES)
+  {
+    return false;
+  }
+
+  size_t first = (_next + DRIFT_MAX_SAMPLES - _count) % DRIFT_MAX_SAMPLES;
+  const Sample &origin = _samples[first];
+  uint32_t span = 0;
+  double sumT = 0, sumO = 0, sumTT = 0, sumTO = 0;
+  for (size_t i = 0; i < _count; i++)
+  {
+    const Sample &sample = _samples[(first + i) % DRIFT_MAX_SAMPLES];
+    double t = (double)(sample.time - origin.time);
+    double o = (double)(sample.offsetUs - origin.offsetUs);
+    sumT += t;
+    sumO += o;
+    sumTT += t * t;
+    sumTO += t * o;
+    span = sample.time - origin.time;
+  }
+  if (span < DRIFT_MIN_SPAN)
+  {
+    return false;
+  }
+
+  double n = (double)_count;
+  double denominator = n * sumTT - sumT * sumT;
+  if (denominator <= 0)
+  {
+    return false;
+  }
+  // Microseconds per second is parts per million.
+  ppm = (float)((n * sumTO - sumT * sumO) / denominator);
+  return true;
+}
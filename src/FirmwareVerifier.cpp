@@ -75,7 +75,7 @@ bool FirmwareVerifier::verifySignature(const uint8_t *hash, const uint8_t *signa
 {
     if (!hash || !signature || !publicKey)
     {
-        SerialLog::getInstance().print("Signature verification failed: null parameter\n");
+        LOG_E(LOG_MODULE_UPDATE, "Signature verification failed: null parameter\n");
         return false;
     }
 
@@ -85,11 +85,11 @@ bool FirmwareVerifier::verifySignature(const uint8_t *hash, const uint8_t *signa
 
     if (result != 0)
     {
-        SerialLog::getInstance().print("Signature verification failed: invalid signature\n");
+        LOG_E(LOG_MODULE_UPDATE, "Signature verification failed: invalid signature\n");
         return false;
     }
 
-    SerialLog::getInstance().print("Signature verification successful\n");
+    LOG_I(LOG_MODULE_UPDATE, "Signature verification successful\n");
     return true;
 }
 
@@ -112,8 +112,8 @@ bool FirmwareVerifier::parseHexSignature(const char *hexStr, uint8_t *sigOut)
     size_t len = strlen(hexStr);
     if (len != ED25519_SIGNATURE_SIZE * 2)
     {
-        SerialLog::getInstance().printf("Invalid signature hex length: %d (expected %d)\n",
-                                         len, ED25519_SIGNATURE_SIZE * 2);
+        LOG_E(LOG_MODULE_UPDATE, "Invalid signature hex length: %d (expected %d)\n",
+              len, ED25519_SIGNATURE_SIZE * 2);
         return false;
     }
 
@@ -123,7 +123,7 @@ bool FirmwareVerifier::parseHexSignature(const char *hexStr, uint8_t *sigOut)
         uint8_t low = hexCharToNibble(hexStr[i * 2 + 1]);
         if (high == 0xFF || low == 0xFF)
         {
-            SerialLog::getInstance().print("Invalid hex character in signature\n");
+            LOG_E(LOG_MODULE_UPDATE, "Invalid hex character in signature\n");
             return false;
         }
         sigOut[i] = (high << 4) | low;
@@ -140,8 +140,8 @@ bool FirmwareVerifier::parseHexHash(const char *hexStr, uint8_t *hashOut)
     size_t len = strlen(hexStr);
     if (len != SHA256_HASH_SIZE * 2)
     {
-        SerialLog::getInstance().printf("Invalid hash hex length: %d (expected %d)\n",
-                                         len, SHA256_HASH_SIZE * 2);
+        LOG_E(LOG_MODULE_UPDATE, "Invalid hash hex length: %d (expected %d)\n",
+              len, SHA256_HASH_SIZE * 2);
         return false;
     }
 
@@ -151,7 +151,7 @@ bool FirmwareVerifier::parseHexHash(const char *hexStr, uint8_t *hashOut)
         uint8_t low = hexCharToNibble(hexStr[i * 2 + 1]);
         if (high == 0xFF || low == 0xFF)
         {
-            SerialLog::getInstance().print("Invalid hex character in hash\n");
+            LOG_E(LOG_MODULE_UPDATE, "Invalid hex character in hash\n");
             return false;
         }
         hashOut[i] = (high << 4) | low;
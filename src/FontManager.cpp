@@ -0,0 +1,217 @@
+/**
+ * @file FontManager.cpp
+ * @brief Implements the FontManager cache of parsed smooth fonts.
+ *
+ * Parsing is delegated to TFT_eSPI's own `loadFont()` on a scratch sprite,
+ * after which the glyph tables are taken over by the manager. Switching a
+ * target to a font copies the metrics and table pointers into its public
+ * smooth-font state, which is exactly what `loadFont()` would have produced.
+ *
+ * This is also the only translation unit that includes the font arrays, so
+ * each font is stored in flash once.
+ */
+
+#include "FontManager.h"
+#include "LockGuard.h"
+#include "SerialLog.h"
+#include "fonts/CenturyGothic28.h"
+#include "fonts/CenturyGothicBold48.h"
+#include "fonts/DSEG14ModernBold32.h"
+#include "fonts/DSEG14ModernBold48.h"
+#include "fonts/DSEG7ModernBold48.h"
+#include "fonts/DSEG7ModernBold70.h"
+#include "fonts/DSEG7ModernBold104.h"
+
+FontManager::FontManager()
+{
+  _mutex = xSemaphoreCreateMutex();
+
+  const uint8_t *arrays[FONT_COUNT] = {
+      CenturyGothic28,
+      CenturyGothicBold48,
+      DSEG14ModernBold32,
+      DSEG14ModernBold48,
+      DSEG7ModernBold48,
+      DSEG7ModernBold70,
+      DSEG7ModernBold104,
+  };
+  for (int i = 0; i < FONT_COUNT; i++)
+  {
+    _entries[i] = {};
+    _entries[i].array = arrays[i];
+  }
+}
+
+void FontManager::begin(TFT_eSPI *tft)
+{
+  _tft = tft;
+  for (int i = 0; i < FONT_COUNT; i++)
+  {
+    ensureParsed((FontId)i);
+  }
+  LOG_D(LOG_MODULE_DISPLAY, "FontManager: %u fonts parsed.\n", (unsigned)_totalLoads);
+}
+
+/**
+ * @brief Parses a font on first use and takes ownership of its glyph tables.
+ * @return The entry, or nullptr if the font could not be parsed.
+ */
+FontManager::Entry *FontManager::ensureParsed(FontId id)
+{
+  if (id >= FONT_COUNT)
+  {
+    return nullptr;
+  }
+
+  LockGuard lock(_mutex);
+  Entry &entry = _entries[id];
+  if (entry.parsed)
+  {
+    return entry.gUnicode ? &entry : nullptr;
+  }
+  if (_tft == nullptr)
+  {
+    return nullptr;
+  }
+  entry.parsed = true; // Don't retry every frame if parsing fails.
+
+  TFT_eSprite scratch(_tft);
+  scratch.loadFont(entry.array);
+  _loads.add(millis() / 1000);
+  _totalLoads++;
+
+  if (!scratch.fontLoaded || scratch.gUnicode == nullptr)
+  {
+    scratch.unloadFont();
+    LOG_E(LOG_MODULE_DISPLAY, "FontManager: failed to parse font %u.\n", (unsigned)id);
+    return nullptr;
+  }
+
+  entry.metrics = scratch.gFont;
+  entry.gUnicode = scratch.gUnicode;
+  entry.gHeight = scratch.gHeight;
+  entry.gWidth = scratch.gWidth;
+  entry.gxAdvance = scratch.gxAdvance;
+  entry.gdY = scratch.gdY;
+  entry.gdX = scratch.gdX;
+  entry.gBitmap = scratch.gBitmap;
+  detach(scratch); // The tables now belong to the manager.
+  return &entry;
+}
+
+/**
+ * @brief Checks whether a target's glyph tables are ones owned by the manager.
+ */
+bool FontManager::isShared(const TFT_eSPI &target) const
+{
+  if (target.gUnicode == nullptr)
+  {
+    return false;
+  }
+  for (const Entry &entry : _entries)
+  {
+    if (entry.gUnicode == target.gUnicode)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Clears a target's smooth-font state without freeing the tables.
+ */
+void FontManager::detach(TFT_eSPI &target)
+{
+  target.gFont = {nullptr, 0, 0, 0, 0, 0, 0, 0};
+  target.gUnicode = nullptr;
+  target.gHeight = nullptr;
+  target.gWidth = nullptr;
+  target.gxAdvance = nullptr;
+  target.gdY = nullptr;
+  target.gdX = nullptr;
+  target.gBitmap = nullptr;
+  target.fontLoaded = false;
+}
+
+bool FontManager::use(TFT_eSPI &target, FontId id)
+{
+  Entry *entry = ensureParsed(id);
+  if (entry == nullptr)
+  {
+    return false;
+  }
+  if (target.fontLoaded && target.gUnicode == entry->gUnicode)
+  {
+    return true; // Already using this font.
+  }
+
+  release(target);
+  target.gFont = entry->metrics;
+  target.gUnicode = entry->gUnicode;
+  target.gHeight = entry->gHeight;
+  target.gWidth = entry->gWidth;
+  target.gxAdvance = entry->gxAdvance;
+  target.gdY = entry->gdY;
+  target.gdX = entry->gdX;
+  target.gBitmap = entry->gBitmap;
+#ifdef FONT_FS_AVAILABLE
+  target.fs_font = false; // Glyph bitmaps are read from the flash array.
+#endif
+  target.fontLoaded = true;
+
+  LockGuard lock(_mutex);
+  _switches.add(millis() / 1000);
+  _totalSwitches++;
+  return true;
+}
+
+void FontManager::release(TFT_eSPI &target)
+{
+  if (isShared(target))
+  {
+    detach(target);
+  }
+  else if (target.fontLoaded)
+  {
+    target.unloadFont(); // A font loaded directly with loadFont().
+  }
+}
+
+int16_t FontManager::fontHeight(FontId id)
+{
+  Entry *entry = ensureParsed(id);
+  return entry ? entry->metrics.yAdvance : 0;
+}
+
+uint32_t FontManager::loadsPerSecond()
+{
+  LockGuard lock(_mutex);
+  return _loads.perSecond(millis() / 1000);
+}
+
+uint32_t FontManager::switchesPerSecond()
+{
+  LockGuard lock(_mutex);
+  return _switches.perSecond(millis() / 1000);
+}
+
+void FontManager::RateCounter::add(uint32_t now)
+{
+  if (now != second)
+  {
+    previous = (now == second + 1) ? count : 0;
+    second = now;
+    count = 0;
+  }
+  count++;
+}
+
+uint32_t FontManager::RateCounter::perSecond(uint32_t now) const
+{
+  if (now == second)
+  {
+    return previous;
+  }
+  return (now == second + 1) ? count : 0;
+}
@@ -0,0 +1,379 @@
+#include "pages/ForecastPage.h"
+#include "ConfigManager.h"
+#include <RTClib.h>
+#include <new>
+
+// Layout for the landscape panel: rows sit at fixed heights, widths follow
+// the panel's width.
+namespace
+{
+  constexpr int16_t CHART_Y = 26;
+  constexpr int16_t CHART_H = 150;
+  constexpr int16_t DAY_Y = 184;
+  constexpr int16_t DAY_H = 108;
+
+  constexpr int16_t CHART_PAD_X = 14;   ///< Room at each end for the first and last labels.
+  constexpr int16_t CHART_LABEL_H = 18; ///< Hour labels under the plot.
+  constexpr int16_t CHART_VALUE_H = 18; ///< Temperature labels above the highest point.
+  constexpr uint8_t CHART_LABEL_EVERY = 3; ///< Hours between labels.
+  constexpr float CHART_MIN_RANGE = 10.0f; ///< Smallest temperature span the plot is scaled to.
+
+  /// @brief The width of each day column.
+  int16_t dayWidth(TFT_eSPI *tft)
+  {
+    return tft->width() / WeatherForecast::DAYS;
+  }
+
+  /// @brief The x-coordinate of a day column.
+  int16_t dayX(TFT_eSPI *tft, uint8_t day)
+  {
+    return day * dayWidth(tft);
+  }
+
+  const char *const DAY_NAMES[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+
+  float toDisplayTemp(float fahrenheit, bool celsius)
+  {
+    return celsius ? (fahrenheit - 32.0f) * 5.0f / 9.0f : fahrenheit;
+  }
+
+  /// @brief Draws a whole-degree temperature centered on (x, y) with a small degree circle.
+  void drawTemperature(TFT_eSprite &sprite, float value, int16_t x, int16_t y, uint8_t font, uint8_t radius, uint16_t color, uint16_t bg)
+  {
+    char text[8];
+    snprintf(text, sizeof(text), "%.0f", value);
+    int16_t width = sprite.textWidth(text, font);
+    int16_t left = x - (width + radius * 2 + 2) / 2;
+    sprite.setTextColor(color, bg);
+    sprite.setTextDatum(ML_DATUM);
+    sprite.drawString(text, left, y, font);
+    sprite.drawCircle(left + width + radius + 1, y - sprite.fontHeight(font) / 2 + radius + 2, radius, color);
+  }
+
+  /**
+   * @brief Allocates the page's forecast copy, in PSRAM when there is some.
+   */
+  WeatherForecast *allocateForecast()
+  {
+    void *block = ps_malloc(sizeof(WeatherForecast));
+    if (block == nullptr)
+    {
+      block = malloc(sizeof(WeatherForecast));
+    }
+    return new (block) WeatherForecast();
+  }
+}
+
+// --- HourlyChartWidget ---
+
+void HourlyChartWidget::setFormat(bool celsius, bool use24Hour)
+{
+  if (celsius != _celsius || use24Hour != _use24Hour)
+  {
+    _celsius = celsius;
+    _use24Hour = use24Hour;
+    _dirty = true;
+  }
+}
+
+void HourlyChartWidget::setColors(uint16_t line, uint16_t rain, uint16_t text)
+{
+  if (line != _lineColor || rain != _rainColor || text != _textColor)
+  {
+    _lineColor = line;
+    _rainColor = rain;
+    _textColor = text;
+    _dirty = true;
+  }
+}
+
+/**
+ * @brief Draws the rain bars, the temperature line and every third hour's labels.
+ *
+ * The temperature axis is fitted to the day's range, widened to at least
+ * CHART_MIN_RANGE so a flat day doesn't look like a swing. The bars use the
+ * full plot height for 100%.
+ */
+void HourlyChartWidget::draw(TFT_eSprite &sprite)
+{
+  uint8_t count = _forecast.hourCount;
+  if (count < 2)
+  {
+    return;
+  }
+
+  float temps[WeatherForecast::HOURS];
+  float low = 1e9f, high = -1e9f;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    temps[i] = toDisplayTemp(_forecast.hourTemp[i], _celsius);
+    low = min(low, temps[i]);
+    high = max(high, temps[i]);
+  }
+  if (high - low < CHART_MIN_RANGE)
+  {
+    float middle = (high + low) / 2;
+    low = middle - CHART_MIN_RANGE / 2;
+    high = middle + CHART_MIN_RANGE / 2;
+  }
+
+  int16_t plotTop = CHART_VALUE_H;
+  int16_t plotBottom = _h - CHART_LABEL_H;
+  int16_t plotH = plotBottom - plotTop;
+  float step = (float)(_w - 2 * CHART_PAD_X) / (count - 1);
+  int16_t barW = max(2, (int)step - 4);
+
+  int16_t xs[WeatherForecast::HOURS];
+  int16_t ys[WeatherForecast::HOURS];
+  for (uint8_t i = 0; i < count; i++)
+  {
+    xs[i] = CHART_PAD_X + (int16_t)(i * step + 0.5f);
+    ys[i] = plotBottom - 1 - (int16_t)((temps[i] - low) * (plotH - 1) / (high - low) + 0.5f);
+
+    int16_t barH = _forecast.hourRain[i] * plotH / 100;
+    if (barH > 0)
+    {
+      sprite.fillRect(xs[i] - barW / 2, plotBottom - barH, barW, barH, _rainColor);
+    }
+  }
+  sprite.drawFastHLine(0, plotBottom, _w, _textColor);
+
+  for (uint8_t i = 1; i < count; i++)
+  {
+    sprite.drawLine(xs[i - 1], ys[i - 1], xs[i], ys[i], _lineColor);
+    sprite.drawLine(xs[i - 1], ys[i - 1] + 1, xs[i], ys[i] + 1, _lineColor);
+  }
+
+  FontManager::getInstance().release(sprite);
+  for (uint8_t i = 0; i < count; i += CHART_LABEL_EVERY)
+  {
+    sprite.fillCircle(xs[i], ys[i], 3, _lineColor);
+
+    sprite.setTextColor(_lineColor, _bg);
+    sprite.setTextDatum(BC_DATUM);
+    char text[8];
+    snprintf(text, sizeof(text), "%.0f", temps[i]);
+    sprite.drawString(text, xs[i], ys[i] - 4, 2);
+
+    DateTime time(_forecast.hourTime[i]);
+    if (_use24Hour)
+    {
+      snprintf(text, sizeof(text), "%02d", time.hour());
+    }
+    else
+    {
+      int hour12 = time.hour() % 12;
+      snprintf(text, sizeof(text), "%d%s", hour12 == 0 ? 12 : hour12, time.hour() < 12 ? "a" : "p");
+    }
+    sprite.setTextColor(_textColor, _bg);
+    sprite.setTextDatum(TC_DATUM);
+    sprite.drawString(text, xs[i], plotBottom + 2, 2);
+  }
+}
+
+// --- ForecastDayWidget ---
+
+void ForecastDayWidget::setCelsius(bool celsius)
+{
+  if (celsius != _celsius)
+  {
+    _celsius = celsius;
+    _dirty = true;
+  }
+}
+
+void ForecastDayWidget::setColors(uint16_t temp, uint16_t text)
+{
+  if (temp != _tempColor || text != _textColor)
+  {
+    _tempColor = temp;
+    _textColor = text;
+    _dirty = true;
+  }
+}
+
+/**
+ * @brief Draws the weekday, high, low, condition and rain chance, top to bottom.
+ *
+ * A condition too wide for the column in font 2 falls back to font 1.
+ */
+void ForecastDayWidget::draw(TFT_eSprite &sprite)
+{
+  if (_day >= _forecast.dayCount)
+  {
+    return;
+  }
+
+  int16_t middle = _w / 2;
+  FontManager::getInstance().release(sprite);
+
+  sprite.setTextColor(_textColor, _bg);
+  sprite.setTextDatum(MC_DATUM);
+  const char *name = _day == 0 ? "Today" : DAY_NAMES[DateTime(_forecast.dayTime[_day]).dayOfTheWeek()];
+  sprite.drawString(name, middle, 12, 4);
+
+  drawTemperature(sprite, toDisplayTemp(_forecast.dayHigh[_day], _celsius), middle, 42, 4, 3, _tempColor, _bg);
+  drawTemperature(sprite, toDisplayTemp(_forecast.dayLow[_day], _celsius), middle, 66, 2, 2, _textColor, _bg);
+
+  const char *condition = WeatherService::getConditionFromWMO(_forecast.dayCode[_day]);
+  uint8_t font = sprite.textWidth(condition, 2) <= _w - 4 ? 2 : 1;
+  sprite.setTextDatum(MC_DATUM);
+  sprite.drawString(condition, middle, 84, font);
+
+  char rain[16];
+  snprintf(rain, sizeof(rain), "Rain %u%%", _forecast.dayRain[_day]);
+  sprite.drawString(rain, middle, 100, 2);
+}
+
+// --- ForecastPage ---
+
+ForecastPage::ForecastPage(TFT_eSPI *tft)
+    : _forecast(allocateForecast()),
+      _dataLayer(tft),
+      _title(0, 4, tft->width(), 20),
+      _chart(5, CHART_Y, tft->width() - 10, CHART_H, *_forecast),
+      _days{{dayX(tft, 0), DAY_Y, dayWidth(tft), DAY_H, *_forecast, 0},
+            {dayX(tft, 1), DAY_Y, dayWidth(tft), DAY_H, *_forecast, 1},
+            {dayX(tft, 2), DAY_Y, dayWidth(tft), DAY_H, *_forecast, 2},
+            {dayX(tft, 3), DAY_Y, dayWidth(tft), DAY_H, *_forecast, 3},
+            {dayX(tft, 4), DAY_Y, dayWidth(tft), DAY_H, *_forecast, 4}},
+      _attribution(0, tft->height() - 23, tft->width(), 18),
+      _statusLayer(tft),
+      _statusTitle(0, 145, tft->width(), 30),
+      _statusDetail(0, 180, tft->width(), 20)
+{
+  static_assert(WeatherForecast::DAYS == 5, "One initializer per day column");
+
+  _title.setFont(2);
+  _title.setText("Next 24 Hours");
+  _attribution.setFont(2);
+  _attribution.setColor(0x632C); // Dim gray, color565(100, 100, 100)
+  _attribution.setText("Weather data provided by open-meteo.com");
+
+  _dataLayer.add(_title);
+  _dataLayer.add(_chart);
+  for (ForecastDayWidget &day : _days)
+  {
+    _dataLayer.add(day);
+  }
+  _dataLayer.add(_attribution);
+
+  _statusTitle.setFont(4);
+  _statusTitle.setText("No Forecast Yet");
+  _statusDetail.setFont(2);
+
+  _statusLayer.add(_statusTitle);
+  _statusLayer.add(_statusDetail);
+
+  _dataLayer.begin();
+  _statusLayer.begin();
+}
+
+ForecastPage::~ForecastPage()
+{
+  free(_forecast);
+}
+
+void ForecastPage::onEnter(TFT_eSPI &tft)
+{
+  FontManager::getInstance().release(tft);
+  tft.setTextSize(1);
+  tft.setTextDatum(TL_DATUM);
+  applyConfig();
+  _needsClear = true;
+  update();
+  render(tft);
+}
+
+void ForecastPage::onExit()
+{
+  _dataLayer.release();
+  _statusLayer.release();
+}
+
+/**
+ * @brief Picks up settings changes and, when its generation has moved on, a new forecast.
+ */
+void ForecastPage::update()
+{
+  if (ConfigManager::getInstance().takeChanges(_configChanges) & (CONFIG_CHANGE_THEME | CONFIG_CHANGE_FORMAT | CONFIG_CHANGE_WEATHER_LOCATION))
+  {
+    applyConfig();
+  }
+
+  WeatherService &service = WeatherService::getInstance();
+  if (service.getForecastGeneration() == _forecastGeneration)
+  {
+    return;
+  }
+  bool hasData = service.getForecast(*_forecast);
+  _forecastGeneration = _forecast->generation;
+  if (hasData != _hasData)
+  {
+    _hasData = hasData;
+    _needsClear = true;
+  }
+  _chart.invalidate();
+  for (ForecastDayWidget &day : _days)
+  {
+    day.invalidate();
+  }
+}
+
+void ForecastPage::render(TFT_eSPI &tft)
+{
+  WidgetLayer &layer = _hasData ? _dataLayer : _statusLayer;
+  if (_needsClear)
+  {
+    tft.fillScreen(_bgColor);
+    layer.invalidateAll();
+    _needsClear = false;
+    if (!layer.isReady())
+    {
+      WidgetLayer::drawUnavailable(tft, _bgColor);
+    }
+  }
+  layer.render();
+}
+
+void ForecastPage::refresh(TFT_eSPI &tft, bool fullRefresh)
+{
+  applyConfig();
+  if (fullRefresh)
+  {
+    _needsClear = true;
+  }
+  update();
+  render(tft);
+}
+
+void ForecastPage::applyConfig()
+{
+  ConfigSnapshotRef config = ConfigManager::getInstance().snapshot();
+
+  if (config->themeGeneration != _themeGeneration)
+  {
+    _themeGeneration = config->themeGeneration;
+    const Theme &theme = config->theme;
+
+    _bgColor = theme.background;
+    _dataLayer.setBackground(_bgColor);
+    _statusLayer.setBackground(_bgColor);
+
+    _title.setColor(theme.weatherForecast);
+    _chart.setColors(theme.weatherTemp, theme.humidity, theme.weatherForecast);
+    for (ForecastDayWidget &day : _days)
+    {
+      day.setColors(theme.weatherTemp, theme.weatherForecast);
+    }
+    _statusTitle.setColor(theme.errorText);
+    _statusDetail.setColor(theme.errorText);
+  }
+
+  _chart.setFormat(config->useCelsius, config->use24HourFormat);
+  for (ForecastDayWidget &day : _days)
+  {
+    day.setCelsius(config->useCelsius);
+  }
+  _statusDetail.setText(config->address[0] == '\0' ? "Set Address" : "Updating...");
+}
@@ -0,0 +1,239 @@
+/**
+ * @file GeocodingCache.cpp
+ * @brief Implements the persistent cache of resolved locations.
+ */
+#include "GeocodingCache.h"
+#include "LockGuard.h"
+#include "SerialLog.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+static const int GEOCODING_CACHE_VERSION = 1;
+
+GeocodingCache::GeocodingCache()
+{
+  _mutex = xSemaphoreCreateMutex();
+}
+
+/**
+ * @brief Loads the saved entries. Call once LittleFS is mounted.
+ */
+void GeocodingCache::begin()
+{
+  File file = LittleFS.open(GEOCODING_CACHE_PATH, "r");
+  if (!file)
+  {
+    return;
+  }
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error || (doc["v"] | 0) != GEOCODING_CACHE_VERSION)
+  {
+    LOG_W(LOG_MODULE_WEATHER, "Geocoding: cache unreadable, ignored.\n");
+    return;
+  }
+
+  LockGuard lock(_mutex);
+  _count = 0;
+  for (JsonObject item : doc["entries"].as<JsonArray>())
+  {
+    if (_count >= GEOCODING_CACHE_ENTRIES)
+    {
+      break;
+    }
+    const char *query = item["q"] | "";
+    const char *address = item["a"] | "";
+    if (query[0] == '\0' || strlen(query) >= QUERY_SIZE || address[0] == '\0')
+    {
+      continue;
+    }
+    Entry &entry = _entries[_count++];
+    strlcpy(entry.query, query, sizeof(entry.query));
+    strlcpy(entry.address, address, sizeof(entry.address));
+    entry.lat = item["lat"] | 0.0f;
+    entry.lon = item["lon"] | 0.0f;
+  }
+  LOG_D(LOG_MODULE_WEATHER, "Geocoding: %u cached locations.\n", _count);
+}
+
+/**
+ * @brief Looks a query up, making it the most recently used on a hit.
+ * @param query The location as the user typed it.
+ * @param resolvedAddress Receives the address it resolved to.
+ * @param lat Receives the latitude.
+ * @param lon Receives the longitude.
+ * @return True on a hit.
+ */
+bool GeocodingCache::lookup(const String &query, String &resolvedAddress, float &lat, float &lon)
+{
+  char key[QUERY_SIZE];
+  if (!normalize(query, key))
+  {
+    return false;
+  }
+
+  LockGuard lock(_mutex);
+  int index = find(key);
+  if (index < 0)
+  {
+    return false;
+  }
+  Entry &entry = _entries[index];
+  resolvedAddress = entry.address;
+  lat = entry.lat;
+  lon = entry.lon;
+  if (index > 0)
+  {
+    promote(index);
+    save();
+  }
+  return true;
+}
+
+/**
+ * @brief Records a resolved query, dropping the least recently used entry if full.
+ * @param query The location as the user typed it.
+ * @param resolvedAddress The address it resolved to.
+ * @param lat The latitude.
+ * @param lon The longitude.
+ */
+void GeocodingCache::store(const String &query, const String &resolvedAddress, float lat, float lon)
+{
+  char key[QUERY_SIZE];
+  if (!normalize(query, key) || resolvedAddress.length() == 0)
+  {
+    return;
+  }
+
+  LockGuard lock(_mutex);
+  int index = find(key);
+  if (index < 0)
+  {
+    // A new entry takes the last slot, which is free or the least recently used.
+    if (_count < GEOCODING_CACHE_ENTRIES)
+    {
+      _count++;
+    }
+    index = _count - 1;
+    strlcpy(_entries[index].query, key, sizeof(_entries[index].query));
+  }
+  Entry &entry = _entries[index];
+  strlcpy(entry.address, resolvedAddress.c_str(), sizeof(entry.address));
+  entry.lat = lat;
+  entry.lon = lon;
+  promote(index);
+  save();
+}
+
+/**
+ * @brief Forgets every entry and removes the saved file.
+ */
+void GeocodingCache::clear()
+{
+  LockGuard lock(_mutex);
+  _count = 0;
+  LittleFS.remove(GEOCODING_CACHE_PATH);
+}
+
+/**
+ * @brief Normalizes a query into a cache key.
+ *
+ * Letters are lowercased, leading and trailing spaces dropped, runs of
+ * spaces collapsed to one and spaces next to a comma removed.
+ * @param query The location as the user typed it.
+ * @param key Receives the key.
+ * @return False if the query is empty or too long to cache.
+ */
+bool GeocodingCache::normalize(const String &query, char (&key)[QUERY_SIZE])
+{
+  size_t length = 0;
+  bool pendingSpace = false;
+  for (const char *c = query.c_str(); *c != '\0'; c++)
+  {
+    char ch = (char)tolower((unsigned char)*c);
+    if (isspace((unsigned char)ch))
+    {
+      pendingSpace = length > 0 && key[length - 1] != ',';
+      continue;
+    }
+    if (pendingSpace && ch != ',')
+    {
+      if (length >= QUERY_SIZE - 1)
+      {
+        return false;
+      }
+      key[length++] = ' ';
+    }
+    pendingSpace = false;
+    if (length >= QUERY_SIZE - 1)
+    {
+      return false;
+    }
+    key[length++] = ch;
+  }
+  key[length] = '\0';
+  return length > 0;
+}
+
+/// @brief Finds a key's entry. Call with `_mutex` held.
+int GeocodingCache::find(const char *key) const
+{
+  for (int i = 0; i < _count; i++)
+  {
+    if (strcmp(_entries[i].query, key) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/// @brief Moves an entry to the front, shifting the ones before it back. Call with `_mutex` held.
+void GeocodingCache::promote(int index)
+{
+  if (index <= 0)
+  {
+    return;
+  }
+  Entry entry = _entries[index];
+  memmove(&_entries[1], &_entries[0], index * sizeof(Entry));
+  _entries[0] = entry;
+}
+
+/**
+ * @brief Writes the entries to LittleFS. Call with `_mutex` held.
+ *
+ * The file is written under a temporary name and renamed over the old one,
+ * so a reset mid-write leaves the previous cache intact.
+ */
+void GeocodingCache::save() const
+{
+  JsonDocument doc;
+  doc["v"] = GEOCODING_CACHE_VERSION;
+  JsonArray entries = doc["entries"].to<JsonArray>();
+  for (int i = 0; i < _count; i++)
+  {
+    JsonObject item = entries.add<JsonObject>();
+    // The buffers outlive the document, so ArduinoJson can keep pointers to them.
+    item["q"] = (const char *)_entries[i].query;
+    item["a"] = (const char *)_entries[i].address;
+    item["lat"] = _entries[i].lat;
+    item["lon"] = _entries[i].lon;
+  }
+
+  static const char *TEMP_PATH = GEOCODING_CACHE_PATH ".tmp";
+  File file = LittleFS.open(TEMP_PATH, "w");
+  if (!file)
+  {
+    LOG_E(LOG_MODULE_WEATHER, "Geocoding: cannot write the cache.\n");
+    return;
+  }
+  bool written = serializeJson(doc, file) > 0;
+  file.close();
+  if (!written || !LittleFS.rename(TEMP_PATH, GEOCODING_CACHE_PATH))
+  {
+    LittleFS.remove(TEMP_PATH);
+    LOG_E(LOG_MODULE_WEATHER, "Geocoding: cannot write the cache.\n");
+  }
+}
@@ -0,0 +1,260 @@
+/**
+ * @file GlyphAtlas.cpp
+ * @brief Implements the GlyphAtlas cache of pre-rasterized smooth-font glyphs.
+ *
+ * Glyphs are rendered once through a scratch sprite with TFT_eSPI's own smooth
+ * font renderer, so the cached tiles are pixel-identical to a normal
+ * `drawString()`. Drawing a cached string is then a series of row copies.
+ */
+
+#include "GlyphAtlas.h"
+#include "SerialLog.h"
+#include <cstring>
+#include <esp32-hal-psram.h>
+
+/**
+ * @brief Constructs a new GlyphAtlas. No memory is allocated until the first draw.
+ * @param tft A pointer to the TFT_eSPI driver instance.
+ * @param font The smooth font used to render the glyphs.
+ * @param glyphs The characters to cache.
+ */
+GlyphAtlas::GlyphAtlas(TFT_eSPI *tft, FontId font, const char *glyphs)
+    : _tft(tft), _font(font)
+{
+  strncpy(_glyphs, glyphs, MAX_GLYPHS);
+  _glyphs[MAX_GLYPHS] = '\0';
+}
+
+/**
+ * @brief Destroys the GlyphAtlas and frees all cached tiles.
+ */
+GlyphAtlas::~GlyphAtlas()
+{
+  invalidate();
+}
+
+void GlyphAtlas::setColors(uint16_t fg, uint16_t bg)
+{
+  if (fg != _fg || bg != _bg)
+  {
+    _fg = fg;
+    _bg = bg;
+    invalidate();
+  }
+}
+
+void GlyphAtlas::invalidate()
+{
+  for (int i = 0; i < _tileCount; i++)
+  {
+    free(_tiles[i].pixels);
+    _tiles[i].pixels = nullptr;
+  }
+  _tileCount = 0;
+  _height = 0;
+  _built = false;
+}
+
+/**
+ * @brief Renders every glyph of the character set into its own PSRAM tile.
+ *
+ * A single scratch sprite large enough for the widest glyph is used for all
+ * of them, with the font attached from the FontManager.
+ *
+ * @return True if the atlas is ready for drawing.
+ */
+bool GlyphAtlas::ensureBuilt()
+{
+  if (_built)
+  {
+    return _tileCount > 0;
+  }
+  _built = true; // Don't retry every frame if allocation fails.
+
+  TFT_eSprite scratch(_tft);
+  scratch.setColorDepth(16);
+  FontManager::getInstance().use(scratch, _font);
+  _height = scratch.fontHeight();
+
+  int16_t maxWidth = 0;
+  for (const char *p = _glyphs; *p; p++)
+  {
+    char buf[2] = {*p, '\0'};
+    maxWidth = max(maxWidth, (int16_t)scratch.textWidth(buf));
+  }
+
+  if (maxWidth <= 0 || _height <= 0 || scratch.createSprite(maxWidth, _height) == nullptr)
+  {
+    FontManager::getInstance().release(scratch);
+    LOG_E(LOG_MODULE_DISPLAY, "GlyphAtlas: failed to create scratch sprite.\n");
+    return false;
+  }
+
+  scratch.setTextColor(_fg, _bg);
+  scratch.setTextDatum(TL_DATUM);
+  const uint16_t *src = (const uint16_t *)scratch.getPointer();
+
+  for (const char *p = _glyphs; *p && _tileCount < MAX_GLYPHS; p++)
+  {
+    char buf[2] = {*p, '\0'};
+    int16_t width = scratch.textWidth(buf);
+    size_t bytes = (size_t)width * _height * sizeof(uint16_t);
+
+    uint16_t *pixels = (uint16_t *)ps_malloc(bytes);
+    if (pixels == nullptr)
+    {
+      pixels = (uint16_t *)malloc(bytes);
+    }
+    if (pixels == nullptr)
+    {
+      LOG_E(LOG_MODULE_DISPLAY, "GlyphAtlas: out of memory.\n");
+      break;
+    }
+
+    scratch.fillSprite(_bg);
+    scratch.drawString(buf, 0, 0);
+    for (int16_t row = 0; row < _height; row++)
+    {
+      memcpy(pixels + row * width, src + row * maxWidth, width * sizeof(uint16_t));
+    }
+
+    _tiles[_tileCount++] = {*p, width, pixels};
+  }
+
+  scratch.deleteSprite();
+  FontManager::getInstance().release(scratch);
+
+  if (_tileCount != (int)strlen(_glyphs))
+  {
+    invalidate();
+    _built = true;
+    return false;
+  }
+  return true;
+}
+
+const GlyphAtlas::Tile *GlyphAtlas::findTile(char c) const
+{
+  for (int i = 0; i < _tileCount; i++)
+  {
+    if (_tiles[i].glyph == c)
+    {
+      return &_tiles[i];
+    }
+  }
+  return nullptr;
+}
+
+int32_t GlyphAtlas::textWidth(const char *text)
+{
+  if (!ensureBuilt())
+  {
+    return -1;
+  }
+
+  int32_t width = 0;
+  for (const char *p = text; *p; p++)
+  {
+    const Tile *tile = findTile(*p);
+    if (tile == nullptr)
+    {
+      return -1;
+    }
+    width += tile->width;
+  }
+  return width;
+}
+
+int32_t GlyphAtlas::tileHeight()
+{
+  return ensureBuilt() ? _height : 0;
+}
+
+int32_t GlyphAtlas::glyphWidth(char c)
+{
+  if (!ensureBuilt())
+  {
+    return -1;
+  }
+  const Tile *tile = findTile(c);
+  return tile ? tile->width : -1;
+}
+
+/**
+ * @brief Copies one glyph tile into a sprite, clipped to the sprite's bounds.
+ */
+bool GlyphAtlas::drawGlyph(TFT_eSprite &sprite, char c, int32_t x, int32_t y)
+{
+  if (!ensureBuilt())
+  {
+    return false;
+  }
+  const Tile *tile = findTile(c);
+  uint16_t *dst = (uint16_t *)sprite.getPointer();
+  if (tile == nullptr || dst == nullptr || sprite.getColorDepth() != 16)
+  {
+    return false;
+  }
+
+  int32_t spriteW = sprite.width();
+  int32_t spriteH = sprite.height();
+  int32_t x0 = max((int32_t)0, x);
+  int32_t x1 = min(spriteW, x + tile->width);
+  if (x1 <= x0)
+  {
+    return true; // Entirely outside horizontally.
+  }
+
+  for (int32_t row = 0; row < _height; row++)
+  {
+    int32_t dy = y + row;
+    if (dy < 0 || dy >= spriteH)
+    {
+      continue;
+    }
+    memcpy(dst + dy * spriteW + x0, tile->pixels + row * tile->width + (x0 - x), (x1 - x0) * sizeof(uint16_t));
+  }
+  return true;
+}
+
+/**
+ * @brief Draws a string from cached tiles with TFT_eSPI-compatible datum handling.
+ */
+bool GlyphAtlas::drawString(TFT_eSprite &sprite, const char *text, int32_t x, int32_t y, uint8_t datum)
+{
+  int32_t width = textWidth(text);
+  if (width < 0 || datum > BR_DATUM)
+  {
+    return false;
+  }
+
+  // Same offsets as TFT_eSPI::drawString(): column from datum % 3, row from datum / 3.
+  switch (datum % 3)
+  {
+  case 1:
+    x -= width / 2;
+    break;
+  case 2:
+    x -= width;
+    break;
+  }
+  switch (datum / 3)
+  {
+  case 1:
+    y -= _height / 2;
+    break;
+  case 2:
+    y -= _height;
+    break;
+  }
+
+  for (const char *p = text; *p; p++)
+  {
+    if (!drawGlyph(sprite, *p, x, y))
+    {
+      return false;
+    }
+    x += findTile(*p)->width;
+  }
+  return true;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file HttpAdmission.cpp
+ * @brief Implements per-class admission control and per-route latency statistics.
+ */
+
+#include "HttpAdmission.h"
+#include "LockGuard.h"
+#include <esp32-hal-psram.h>
+#include <algorithm>
+#include <cstring>
+
+HttpAdmission::HttpAdmission()
+{
+  _mutex = xSemaphoreCreateMutex();
+  _routes = (Route *)ps_calloc(MAX_ROUTES, sizeof(Route));
+  _classes[ROUTE_STATIC].limit = HTTP_MAX_INFLIGHT_STATIC;
+  _classes[ROUTE_API_READ].limit = HTTP_MAX_INFLIGHT_API_READ;
+  _classes[ROUTE_API_WRITE].limit = HTTP_MAX_INFLIGHT_API_WRITE;
+  _classes[ROUTE_OTA].limit = HTTP_MAX_INFLIGHT_OTA;
+}
+
+RouteClass HttpAdmission::classify(const char *uri, WebRequestMethodComposite method)
+{
+  if (strcmp(uri, "/update") == 0)
+  {
+    return ROUTE_OTA;
+  }
+  if (method != HTTP_GET)
+  {
+    return ROUTE_API_WRITE;
+  }
+  return strncmp(uri, "/api/", 5) == 0 ? ROUTE_API_READ : ROUTE_STATIC;
+}
+
+int HttpAdmission::addRoute(const char *uri, RouteClass routeClass)
+{
+  LockGuard lock(_mutex);
+  if (_routes == nullptr || _routeCount >= MAX_ROUTES)
+  {
+    return -1;
+  }
+  Route &route = _routes[_routeCount];
+  route.uri = uri;
+  route.routeClass = routeClass;
+  return _routeCount++;
+}
+
+/**
+ * @brief Finds a request's in-flight entry. Must be called with `_mutex` held.
+ */
+HttpAdmission::InFlight *HttpAdmission::find(AsyncWebServerRequest *request)
+{
+  for (InFlight &entry : _inFlight)
+  {
+    if (entry.request == request)
+    {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+bool HttpAdmission::admit(AsyncWebServerRequest *request, int route)
+{
+  if (route < 0)
+  {
+    return true; // Untracked routes are never capped.
+  }
+  LockGuard lock(_mutex);
+  if (find(request) != nullptr)
+  {
+    return true;
+  }
+  ClassStats &cls = _classes[_routes[route].routeClass];
+  InFlight *slot = find(nullptr);
+  if (cls.inFlight >= cls.limit || slot == nullptr)
+  {
+    cls.rejected++;
+    _routes[route].rejected++;
+    AsyncWebServerRequest **rejected = std::find(_rejected, _rejected + MAX_REJECTED, request);
+    if (rejected == _rejected + MAX_REJECTED)
+    {
+      rejected = std::find(_rejected, _rejected + MAX_REJECTED, nullptr);
+    }
+    if (rejected != _rejected + MAX_REJECTED)
+    {
+      *rejected = request;
+    }
+    return false;
+  }
+  cls.inFlight++;
+  cls.admitted++;
+  *slot = {request, route, 0, 0};
+  return true;
+}
+
+bool HttpAdmission::isAdmitted(AsyncWebServerRequest *request)
+{
+  LockGuard lock(_mutex);
+  return find(request) != nullptr;
+}
+
+bool HttpAdmission::isRejected(AsyncWebServerRequest *request)
+{
+  LockGuard lock(_mutex);
+  return std::find(_rejected, _rejected + MAX_REJECTED, request) != _rejected + MAX_REJECTED;
+}
+
+void HttpAdmission::beginCallback()
+{
+  // Callbacks all run on the AsyncTCP task, one at a time.
+  LockWaitProbe::waitUs = 0;
+  LockWaitProbe::task = xTaskGetCurrentTaskHandle();
+  _callbackStart = micros();
+}
+
+void HttpAdmission::endCallback(AsyncWebServerRequest *request)
+{
+  uint32_t elapsed = micros() - _callbackStart;
+  LockWaitProbe::task = nullptr;
+  uint32_t waited = LockWaitProbe::waitUs;
+
+  LockGuard lock(_mutex);
+  InFlight *entry = find(request);
+  if (entry != nullptr)
+  {
+    entry->handlerUs += elapsed;
+    entry->lockWaitUs += waited;
+  }
+}
+
+void HttpAdmission::finish(AsyncWebServerRequest *request)
+{
+  LockGuard lock(_mutex);
+  InFlight *entry = find(request);
+  if (entry == nullptr)
+  {
+    std::replace(_rejected, _rejected + MAX_REJECTED, request, (AsyncWebServerRequest *)nullptr);
+    return;
+  }
+  Route &route = _routes[entry->route];
+  _classes[route.routeClass].inFlight--;
+  route.requests++;
+  route.maxUs = max(route.maxUs, entry->handlerUs);
+  route.lockWaitMaxUs = max(route.lockWaitMaxUs, entry->lockWaitUs);
+  route.handlerUs[route.next] = entry->handlerUs;
+  route.lockWaitUs[route.next] = entry->lockWaitUs;
+  route.next = (route.next + 1) % RING_SIZE;
+  if (route.count < RING_SIZE)
+  {
+    route.count++;
+  }
+  *entry = {};
+}
+
+void HttpAdmission::getClassStats(RouteClass routeClass, ClassStats &stats)
+{
+  LockGuard lock(_mutex);
+  stats = _classes[routeClass];
+}
+
+/**
+ * @brief Reads the 95th percentile off a copy of a ring.
+ */
+uint32_t HttpAdmission::p95(const uint32_t *ring, int count)
+{
+  if (count == 0)
+  {
+    return 0;
+  }
+  uint32_t sorted[RING_SIZE];
+  memcpy(sorted, ring, count * sizeof(uint32_t));
+  std::sort(sorted, sorted + count);
+  return sorted[(count - 1) * 95 / 100];
+}
+
+bool HttpAdmission::getRouteStats(int route, RouteStats &stats)
+{
+  LockGuard lock(_mutex);
+  if (route < 0 || route >= _routeCount)
+  {
+    return false;
+  }
+  const Route &r = _routes[route];
+  stats.uri = r.uri;
+  stats.routeClass = r.routeClass;
+  stats.requests = r.requests;
+  stats.rejected = r.rejected;
+  stats.p95Us = p95(r.handlerUs, r.count);
+  stats.maxUs = r.maxUs;
+  stats.lockWaitP95Us = p95(r.lockWaitUs, r.count);
+  stats.lockWaitMaxUs = r.lockWaitMaxUs;
+  return true;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file HttpsClient.cpp
+ * @brief Implements the per-host outbound HTTPS connections.
+ */
+#include "HttpsClient.h"
+#include "SerialLog.h"
+#include "PowerManager.h"
+#include <esp_timer.h>
+
+/// @brief Host names, indexed by HttpsHost.
+static const char *const HOST_NAMES[HTTPS_HOST_COUNT] = {
+    "api.open-meteo.com",
+    "geocoding-api.open-meteo.com",
+    "api.github.com",
+    "github.com",
+};
+
+/**
+ * @brief Copies the host out of an https:// URL.
+ * @param url The URL.
+ * @param host Receives the host, or an empty string if the URL has none.
+ * @param size The size of `host`.
+ */
+static void urlHost(const String &url, char *host, size_t size)
+{
+  host[0] = '\0';
+  const char *start = url.c_str();
+  const char *scheme = strstr(start, "://");
+  if (scheme != nullptr)
+  {
+    start = scheme + 3;
+  }
+  size_t length = strcspn(start, "/:?");
+  if (length >= size)
+  {
+    return;
+  }
+  memcpy(host, start, length);
+  host[length] = '\0';
+}
+
+/**
+ * @brief Sets up each host's client and its lock.
+ *
+ * GitHub release assets redirect to a CDN, so that host follows redirects
+ * and closes its connection after each request; the others keep theirs
+ * open and don't follow redirects, so a kept connection is always to the
+ * host it was opened for.
+ */
+HttpsClient::HttpsClient()
+{
+  for (int host = 0; host < HTTPS_HOST_COUNT; host++)
+  {
+    Connection &connection = _connections[host];
+    connection.mutex = xSemaphoreCreateMutex();
+    connection.keepAlive = host != HTTPS_HOST_GITHUB_DOWNLOAD;
+    connection.connectedHost[0] = '\0';
+    connection.lastUsed = 0;
+    connection.stats = {};
+    connection.stats.host = HOST_NAMES[host];
+
+    connection.client.setInsecure();
+    connection.client.setTimeout(HTTPS_CONNECT_TIMEOUT);
+    connection.http.setTimeout(HTTPS_RESPONSE_TIMEOUT);
+    connection.http.setReuse(connection.keepAlive);
+    if (!connection.keepAlive)
+    {
+      connection.http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    }
+  }
+}
+
+/**
+ * @brief Takes the host's connection, waiting while another task has it.
+ * @param host The host the request goes to.
+ */
+HttpsClient::Request::Request(HttpsHost host) : _host(host)
+{
+  xSemaphoreTake(HttpsClient::getInstance()._connections[_host].mutex, portMAX_DELAY);
+  _held = true;
+  PowerManager::getInstance().acquire(POWER_LOCK_NETWORK);
+}
+
+/**
+ * @brief Ends the request if the caller didn't.
+ */
+HttpsClient::Request::~Request()
+{
+  end();
+}
+
+/**
+ * @brief Sends a GET, on the open connection if there is one.
+ * @param url The full https:// URL.
+ * @return The HTTP status code, or a negative HTTPC_ERROR_* code.
+ */
+int HttpsClient::Request::get(const String &url)
+{
+  HttpsClient &client = HttpsClient::getInstance();
+  Connection &connection = client._connections[_host];
+  connection.stats.requests++;
+
+  char host[sizeof(connection.connectedHost)];
+  urlHost(url, host, sizeof(host));
+  bool reused = connection.client.connected() && strcmp(host, connection.connectedHost) == 0;
+
+  for (;;)
+  {
+    if (!reused && !client.connect(connection, url))
+    {
+      connection.stats.failures++;
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    _sentMicros = esp_timer_get_time();
+    connection.http.begin(connection.client, url);
+    int httpCode = connection.http.GET();
+    if (httpCode >= 0)
+    {
+      if (reused)
+      {
+        connection.stats.reused++;
+      }
+      return httpCode;
+    }
+    if (!reused)
+    {
+      connection.stats.failures++;
+      return httpCode;
+    }
+
+    // The server closed the kept-alive connection; start again on a new one.
+    connection.http.end();
+    connection.client.stop();
+    connection.connectedHost[0] = '\0';
+    reused = false;
+  }
+}
+
+/**
+ * @brief Gets the HTTP client, for reading the response.
+ * @return The host's HTTP client.
+ */
+HTTPClient &HttpsClient::Request::http()
+{
+  return HttpsClient::getInstance()._connections[_host].http;
+}
+
+/**
+ * @brief Finishes the request and gives the connection back.
+ *
+ * `HTTPClient::end()` drains anything left of the body and keeps the
+ * connection only if both sides agreed to keep-alive.
+ */
+void HttpsClient::Request::end()
+{
+  if (!_held)
+  {
+    return;
+  }
+
+  Connection &connection = HttpsClient::getInstance()._connections[_host];
+  if (_sentMicros != 0)
+  {
+    uint32_t transferMs = (uint32_t)((esp_timer_get_time() - _sentMicros) / 1000);
+    connection.stats.lastTransferMs = transferMs;
+    if (transferMs > connection.stats.maxTransferMs)
+    {
+      connection.stats.maxTransferMs = transferMs;
+    }
+  }
+
+  connection.http.end();
+  if (!connection.client.connected())
+  {
+    connection.connectedHost[0] = '\0';
+  }
+  connection.lastUsed = millis();
+
+  _held = false;
+  PowerManager::getInstance().release(POWER_LOCK_NETWORK);
+  xSemaphoreGive(connection.mutex);
+}
+
+/**
+ * @brief Opens a TLS connection to a URL's host, timing the handshake.
+ *
+ * Connecting here rather than inside `HTTPClient::GET()` separates the
+ * handshake from the transfer; GET() then finds the client connected and
+ * uses it as it is.
+ * @param connection The connection to open.
+ * @param url The URL being requested.
+ * @return True if connected.
+ */
+bool HttpsClient::connect(Connection &connection, const String &url)
+{
+  connection.client.stop();
+  urlHost(url, connection.connectedHost, sizeof(connection.connectedHost));
+  if (connection.connectedHost[0] == '\0')
+  {
+    return false;
+  }
+
+  int64_t start = esp_timer_get_time();
+  if (!connection.client.connect(connection.connectedHost, 443))
+  {
+    LOG_E(LOG_MODULE_WEB, "HTTPS: could not connect to %s\n", connection.connectedHost);
+    connection.connectedHost[0] = '\0';
+    return false;
+  }
+  uint32_t handshakeMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+
+  connection.stats.handshakes++;
+  connection.stats.lastHandshakeMs = handshakeMs;
+  if (handshakeMs > connection.stats.maxHandshakeMs)
+  {
+    connection.stats.maxHandshakeMs = handshakeMs;
+  }
+  return true;
+}
+
+/**
+ * @brief Closes connections that have been idle for HTTPS_IDLE_TIMEOUT.
+ */
+void HttpsClient::closeIdle()
+{
+  unsigned long now = millis();
+  for (Connection &connection : _connections)
+  {
+    if (xSemaphoreTake(connection.mutex, 0) != pdTRUE)
+    {
+      continue; // In use.
+    }
+    if (connection.connectedHost[0] != '\0' && now - connection.lastUsed >= HTTPS_IDLE_TIMEOUT)
+    {
+      connection.client.stop();
+      connection.connectedHost[0] = '\0';
+    }
+    xSemaphoreGive(connection.mutex);
+  }
+}
+
+/**
+ * @brief Gets a host's request counters and timings.
+ * @param host The host.
+ * @return The stats.
+ */
+HttpsHostStats HttpsClient::getStats(HttpsHost host) const
+{
+  return _connections[host].stats;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file I2cBus.cpp
+ * @brief Implements the I2C bus task and lock.
+ */
+#include "I2cBus.h"
+#include "SensorModule.h"
+#include <esp_timer.h>
+
+/**
+ * @brief Creates the bus lock and the request queue.
+ */
+I2cBus::I2cBus()
+{
+  _mutex = xSemaphoreCreateRecursiveMutex();
+  _queue = xQueueCreate(I2C_QUEUE_LENGTH, sizeof(Request));
+}
+
+/**
+ * @brief Takes the bus, recording how long that took.
+ */
+I2cBus::Lock::Lock()
+{
+  I2cBus &bus = I2cBus::getInstance();
+  int64_t start = esp_timer_get_time();
+  xSemaphoreTakeRecursive(bus._mutex, portMAX_DELAY);
+  uint32_t waitUs = (uint32_t)(esp_timer_get_time() - start);
+  bus._transactions++;
+  if (waitUs > bus._maxWaitUs)
+  {
+    bus._maxWaitUs = waitUs;
+  }
+}
+
+/**
+ * @brief Gives the bus back.
+ */
+I2cBus::Lock::~Lock()
+{
+  xSemaphoreGiveRecursive(I2cBus::getInstance()._mutex);
+}
+
+/**
+ * @brief Gets the time of the first scheduled sensor read after a given time.
+ *
+ * Reads are made halfway through each SensorHistory slot, so a read that
+ * runs a little early or late still lands in its own slot.
+ * @param nowMs esp_timer time, in ms.
+ * @return esp_timer time, in ms, of the read.
+ */
+static int64_t nextSensorReadMs(int64_t nowMs)
+{
+  const int64_t interval = SENSOR_UPDATE_INTERVAL;
+  int64_t slot = nowMs / interval;
+  int64_t read = slot * interval + interval / 2;
+  return read > nowMs ? read : read + interval;
+}
+
+/**
+ * @brief Starts the bus task pinned to I2C_TASK_CORE.
+ */
+void I2cBus::startTask()
+{
+  if (_taskHandle != nullptr)
+  {
+    return;
+  }
+
+  _lastSensorRead = millis();
+  _nextSensorReadMs = nextSensorReadMs(esp_timer_get_time() / 1000);
+  xTaskCreatePinnedToCore(
+      busTask,
+      "I2cBus",
+      I2C_TASK_STACK_SIZE,
+      this,
+      I2C_TASK_PRIORITY,
+      &_taskHandle,
+      I2C_TASK_CORE);
+}
+
+/**
+ * @brief Queues a write of the RTC's time.
+ * @param time The new local time.
+ * @param atMicros esp_timer_get_time() at which to make the write; 0 = now.
+ * @param done Called after the write, on the writing task; may be null.
+ */
+void I2cBus::queueRtcAdjust(const DateTime &time, int64_t atMicros, RtcAdjustedCallback done)
+{
+  Request request = {I2C_REQUEST_RTC_ADJUST, time.unixtime(), atMicros, done};
+  if (_taskHandle == nullptr)
+  {
+    handle(request);
+    return;
+  }
+  _writesQueued++;
+  xQueueSend(_queue, &request, portMAX_DELAY);
+}
+
+/**
+ * @brief Asks the bus task to read the sensors now.
+ *
+ * If the queue is full a read is already pending, so the request is dropped.
+ */
+void I2cBus::requestSensorRead()
+{
+  Request request = {I2C_REQUEST_SENSOR_READ, 0, 0, nullptr};
+  xQueueSend(_queue, &request, 0);
+}
+
+/**
+ * @brief Gets the bus activity counters.
+ * @return The counters.
+ */
+I2cBusStats I2cBus::getStats() const
+{
+  I2cBusStats stats;
+  stats.transactions = _transactions;
+  stats.writesQueued = _writesQueued;
+  stats.maxWaitUs = _maxWaitUs;
+  stats.sensorAgeMs = millis() - _lastSensorRead;
+  return stats;
+}
+
+/**
+ * @brief Runs one queued request.
+ *
+ * A timed RTC write holds the bus task until its moment, at most a second.
+ * The callback runs after the bus is released, so it may take other locks.
+ * @param request The request.
+ */
+void I2cBus::handle(const Request &request)
+{
+  switch (request.type)
+  {
+  case I2C_REQUEST_RTC_ADJUST:
+  {
+    DateTime time(request.time);
+    int64_t writtenMicros;
+    // Sleep to within a tick of the write time, then take the bus and spin
+    // out the rest, so the write starts within a few microseconds of it.
+    int64_t waitUs = request.atMicros - esp_timer_get_time();
+    if (waitUs > 2000)
+    {
+      vTaskDelay(pdMS_TO_TICKS((waitUs - 1000) / 1000));
+    }
+    {
+      Lock lock;
+      while (esp_timer_get_time() < request.atMicros)
+      {
+      }
+      // The seconds register is written first, within a byte or two of the start.
+      writtenMicros = esp_timer_get_time();
+      RTC.adjust(time);
+    }
+    if (request.done != nullptr)
+    {
+      request.done(time, writtenMicros);
+    }
+    break;
+  }
+  case I2C_REQUEST_SENSOR_READ:
+    handleSensorUpdates(true);
+    _lastSensorRead = millis();
+    break;
+  }
+}
+
+/**
+ * @brief The bus task loop.
+ *
+ * Sleeps on the queue until either a request arrives or the next sensor
+ * read is due. A requested read does not move the schedule; it just
+ * refreshes the current slot.
+ *
+ * @param param The I2cBus instance.
+ */
+void I2cBus::busTask(void *param)
+{
+  I2cBus *bus = static_cast<I2cBus *>(param);
+  for (;;)
+  {
+    int64_t untilRead = bus->_nextSensorReadMs - esp_timer_get_time() / 1000;
+    TickType_t wait = untilRead <= 0 ? 0 : pdMS_TO_TICKS(untilRead);
+
+    Request request;
+    if (xQueueReceive(bus->_queue, &request, wait) == pdTRUE)
+    {
+      bus->handle(request);
+      continue;
+    }
+
+    handleSensorUpdates(true);
+    bus->_lastSensorRead = millis();
+    bus->_nextSensorReadMs = nextSensorReadMs(esp_timer_get_time() / 1000);
+  }
+}
@@ -4,12 +4,16 @@
  *
  * This file contains the implementation for the InfoPage, which shows details
  * like the device's hostname, IP address, and the current firmware version.
- * The content is static and rendered only once upon entering the page.
+ * The fields are refreshed every update, but only lines whose text changed
+ * are redrawn.
  */
 
 #include "pages/InfoPage.h"
-#include "fonts/CenturyGothic28.h"
+#include "FontManager.h"
+#include "RenderProfiler.h"
+#include "LoopProfiler.h"
 #include <WiFi.h>
+#include <cstdio>
 #if __has_include("version.h")
 // This file exists, so we'll include it.
 #include "version.h"
@@ -19,9 +23,33 @@
 #endif
 
 /**
- * @brief Constructs a new InfoPage.
+ * @brief Constructs a new InfoPage and lays out its widgets.
+ * @param tft A pointer to the TFT_eSPI driver instance.
  */
-InfoPage::InfoPage() {}
+InfoPage::InfoPage(TFT_eSPI *tft)
+    : _layer(tft),
+      _title(100, 25, tft->width() - 200, 30),
+      _host(20, 75, tft->width() - 40, 30, ML_DATUM),
+      _ip(20, 105, tft->width() - 40, 30, ML_DATUM),
+      _version(20, 135, tft->width() - 40, 30, ML_DATUM),
+      _render(20, 165, tft->width() - 40, 30, ML_DATUM),
+      _loop(20, 195, tft->width() - 40, 30, ML_DATUM),
+      _signal(tft->width() - 60, 25, 40, 30, drawSignalBars)
+{
+  LabelWidget *labels[] = {&_title, &_host, &_ip, &_version, &_render, &_loop};
+  for (LabelWidget *label : labels)
+  {
+    label->setSmoothFont(FONT_CENTURY_GOTHIC_28);
+    label->setColor(TFT_CYAN);
+    _layer.add(*label);
+  }
+  _title.setText("Info");
+  _version.setText("Version: " FIRMWARE_VERSION);
+  _signal.setColor(TFT_CYAN);
+  _layer.add(_signal);
+  _layer.setBackground(TFT_BLACK);
+  _layer.begin();
+}
 
 /**
  * @brief Destroys the InfoPage.
@@ -31,77 +59,149 @@ InfoPage::~InfoPage() {}
 /**
  * @brief Called when the page becomes the active view.
  *
- * Renders the static information to the screen. This is done only once, as
- * the content does not change.
+ * Clears the screen and draws every field.
  *
  * @param tft A reference to the TFT_eSPI driver instance.
  */
 void InfoPage::onEnter(TFT_eSPI &tft)
 {
   tft.fillScreen(TFT_BLACK);
-  tft.setTextColor(TFT_CYAN, TFT_BLACK);
-  tft.loadFont(CenturyGothic28);
-
-  // --- Title ---
-  tft.setTextDatum(MC_DATUM);
-  tft.drawString("Info", tft.width() / 2, 40);
-
-  // --- Info ---
-  tft.setTextDatum(ML_DATUM); // Left-align the info text
-  int y_pos = 90;
-  int x_pos = 20;
-
-  // Display Hostname
-  String hostname = "Host: ";
-  hostname += WiFi.getHostname();
-  hostname += ".local";
-  tft.drawString(hostname, x_pos, y_pos);
-
-  // Display IP Address
-  y_pos += 30;
-  String ip = "IP: ";
-  ip += WiFi.localIP().toString();
-  tft.drawString(ip, x_pos, y_pos);
-
-  // Display Version
-  y_pos += 30;
-  String version = "Version: ";
-  version += FIRMWARE_VERSION;
-  tft.drawString(version, x_pos, y_pos);
-
-  tft.unloadFont();
+  _layer.invalidateAll();
+  if (!_layer.isReady())
+  {
+    WidgetLayer::drawUnavailable(tft, TFT_BLACK);
+  }
+  update();
+  render(tft);
 }
 
 /**
  * @brief Called when the page is no longer the active view.
  *
- * This method is a no-op as there is no cleanup required for this simple page.
+ * Unloads the widget layer's smooth font; its scratch sprite is kept.
  */
 void InfoPage::onExit()
 {
-  // Nothing to do here
+  _layer.release();
 }
 
 /**
  * @brief Updates the internal state of the page.
  *
- * This method is a no-op because the page displays static information that
- * does not need to be updated in the main loop.
+ * Re-reads the hostname, IP address, signal strength and the render and
+ * loop profiler summaries. The widgets ignore values that have not changed.
  */
 void InfoPage::update()
 {
-  // Static content, nothing to do here
+  _host.setTextf("Host: %s.local", WiFi.getHostname());
+
+  char ip[16];
+  IPAddress addr = WiFi.localIP();
+  snprintf(ip, sizeof(ip), "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+  _ip.setTextf("IP: %s", ip);
+
+  int32_t bars = 0;
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    int8_t rssi = WiFi.RSSI();
+    bars = rssi >= -55 ? 4 : rssi >= -65 ? 3 : rssi >= -75 ? 2 : 1;
+  }
+  _signal.setState(bars);
+
+  updateRenderSummary();
+  updateLoopSummary();
+}
+
+void InfoPage::updateRenderSummary()
+{
+  RenderProfiler &profiler = RenderProfiler::getInstance();
+  if (!profiler.isEnabled())
+  {
+    _render.setText("Render: profiler off");
+    return;
+  }
+
+  int slowestPage = -1;
+  RenderProfiler::PageStats slowest = {};
+  for (int page = 0; page < RenderProfiler::MAX_PAGES; page++)
+  {
+    RenderProfiler::PageStats stats;
+    if (profiler.getPageStats(page, stats) && (slowestPage < 0 || stats.frameUs.p95 > slowest.frameUs.p95))
+    {
+      slowestPage = page;
+      slowest = stats;
+    }
+  }
+
+  if (slowestPage < 0)
+  {
+    _render.setText("Render: no frames yet");
+    return;
+  }
+  // p50/p95/max frame time in milliseconds
+  _render.setTextf("Render pg%d: %.1f/%.1f/%.1f ms", slowestPage, slowest.frameUs.p50 / 1000.0f,
+                   slowest.frameUs.p95 / 1000.0f, slowest.frameUs.max / 1000.0f);
+}
+
+void InfoPage::updateLoopSummary()
+{
+  if (!LoopProfiler::isEnabled())
+  {
+    _loop.setText("Loop: profiler off");
+    return;
+  }
+
+  LoopProfiler &profiler = LoopProfiler::getInstance();
+  int slowestScope = -1;
+  uint32_t slowestP99 = 0;
+  for (int i = 0; i < LOOP_SCOPE_COUNT; i++)
+  {
+    LoopProfiler::ScopeStats stats;
+    if (profiler.getScopeStats((LoopScope)i, stats) && (slowestScope < 0 || stats.p99Us > slowestP99))
+    {
+      slowestScope = i;
+      slowestP99 = stats.p99Us;
+    }
+  }
+
+  if (slowestScope < 0)
+  {
+    _loop.setText("Loop: no samples yet");
+    return;
+  }
+  LoopProfiler::JitterStats jitter;
+  profiler.getJitterStats(jitter);
+  // Slowest step's p99 / largest deviation from the loop interval, in milliseconds
+  _loop.setTextf("Loop %s: %.1f/%.1f ms", LOOP_SCOPE_NAMES[slowestScope], slowestP99 / 1000.0f, jitter.maxUs / 1000.0f);
 }
 
 /**
  * @brief Renders the page to the display.
  *
- * This method is a no-op because all rendering is done in the `onEnter`
- * method. The content is static and does not need to be redrawn repeatedly.
+ * Only widgets whose content changed since the last render are redrawn.
  *
  * @param tft A reference to the TFT_eSPI driver instance.
  */
 void InfoPage::render(TFT_eSPI &tft)
 {
-  // Static content, no need for continuous rendering
-}
\ No newline at end of file
+  _layer.render();
+}
+
+void InfoPage::drawSignalBars(TFT_eSprite &sprite, int16_t w, int16_t h, uint16_t color, uint16_t bg, int32_t state)
+{
+  const int16_t barW = w / 5;
+  const int16_t step = (w - barW) / 3;
+  for (int i = 0; i < 4; i++)
+  {
+    int16_t barH = h * (i + 1) / 4;
+    int16_t x = i * step;
+    if (i < state)
+    {
+      sprite.fillRect(x, h - barH, barW, barH, color);
+    }
+    else
+    {
+      sprite.drawRect(x, h - barH, barW, barH, TFT_DARKGREY);
+    }
+  }
+}
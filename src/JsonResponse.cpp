@@ -0,0 +1,204 @@
+/**
+ * @file JsonResponse.cpp
+ * @brief Implements PSRAM-backed serialization and caching of the web API's JSON replies.
+ */
+
+#include "JsonResponse.h"
+#include "LockGuard.h"
+#include <esp32-hal-psram.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+/**
+ * @brief An ArduinoJson allocator that prefers PSRAM and falls back to the heap.
+ */
+class PsramJsonAllocator : public ArduinoJson::Allocator
+{
+public:
+  void *allocate(size_t size) override
+  {
+    allocations++;
+    void *block = ps_malloc(size);
+    return block != nullptr ? block : malloc(size);
+  }
+
+  void deallocate(void *pointer) override
+  {
+    free(pointer);
+  }
+
+  void *reallocate(void *pointer, size_t newSize) override
+  {
+    allocations++;
+    void *block = ps_realloc(pointer, newSize);
+    return block != nullptr ? block : realloc(pointer, newSize);
+  }
+
+  std::atomic<uint32_t> allocations{0}; ///< Calls to allocate() and reallocate() since boot.
+};
+
+JsonResponse::JsonResponse()
+{
+  _mutex = xSemaphoreCreateMutex();
+}
+
+static PsramJsonAllocator &psramAllocator()
+{
+  static PsramJsonAllocator instance;
+  return instance;
+}
+
+ArduinoJson::Allocator *JsonResponse::allocator()
+{
+  return &psramAllocator();
+}
+
+uint32_t JsonResponse::allocations()
+{
+  return psramAllocator().allocations;
+}
+
+void JsonResponse::send(AsyncWebServerRequest *request, const char *endpoint, const JsonDocument &doc, int code)
+{
+  size_t length;
+  std::shared_ptr<char> body = serialize(doc, length);
+  {
+    LockGuard lock(_mutex);
+    int slot = slotFor(endpoint);
+    if (slot >= 0)
+    {
+      _endpoints[slot].requests++;
+      _endpoints[slot].lastBytes = length;
+      _endpoints[slot].maxBytes = max(_endpoints[slot].maxBytes, (uint32_t)length);
+    }
+  }
+  if (!body)
+  {
+    request->send(500, "text/plain", "Out of memory.");
+    return;
+  }
+  stream(request, body, length, code);
+}
+
+void JsonResponse::sendCached(AsyncWebServerRequest *request, const char *endpoint, uint64_t key, Builder build)
+{
+  std::shared_ptr<char> body;
+  size_t length = 0;
+  {
+    LockGuard lock(_mutex);
+    int slot = slotFor(endpoint);
+    if (slot >= 0)
+    {
+      _endpoints[slot].requests++;
+    }
+    if (slot >= 0 && _cache[slot].body && _cache[slot].key == key)
+    {
+      _endpoints[slot].cacheHits++;
+      body = _cache[slot].body;
+      length = _cache[slot].length;
+    }
+  }
+  if (body)
+  {
+    stream(request, body, length, 200);
+    return;
+  }
+
+  JsonDocument doc(allocator());
+  build(doc);
+  body = serialize(doc, length);
+  if (!body)
+  {
+    request->send(500, "text/plain", "Out of memory.");
+    return;
+  }
+  {
+    LockGuard lock(_mutex);
+    int slot = slotFor(endpoint);
+    if (slot >= 0)
+    {
+      _endpoints[slot].cacheMisses++;
+      _endpoints[slot].lastBytes = length;
+      _endpoints[slot].maxBytes = max(_endpoints[slot].maxBytes, (uint32_t)length);
+      _cache[slot] = {body, length, key};
+    }
+  }
+  stream(request, body, length, 200);
+}
+
+bool JsonResponse::getEndpointStats(int index, EndpointStats &stats)
+{
+  if (index < 0 || index >= MAX_ENDPOINTS)
+  {
+    return false;
+  }
+  LockGuard lock(_mutex);
+  if (_endpoints[index].endpoint == nullptr)
+  {
+    return false;
+  }
+  stats = _endpoints[index];
+  return true;
+}
+
+/**
+ * @brief Finds an endpoint's slot, claiming a free one if needed.
+ *
+ * Must be called with `_mutex` held.
+ * @return The slot index, or -1 if every slot belongs to another endpoint.
+ */
+int JsonResponse::slotFor(const char *endpoint)
+{
+  for (int i = 0; i < MAX_ENDPOINTS; i++)
+  {
+    EndpointStats &slot = _endpoints[i];
+    if (slot.endpoint == nullptr)
+    {
+      slot.endpoint = endpoint;
+    }
+    else if (strcmp(slot.endpoint, endpoint) != 0)
+    {
+      continue;
+    }
+    return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Serializes a document into a PSRAM buffer of exactly its size.
+ * @param doc The document.
+ * @param length Receives the serialized length, excluding the terminator.
+ * @return The buffer, or an empty pointer if it could not be allocated.
+ */
+std::shared_ptr<char> JsonResponse::serialize(const JsonDocument &doc, size_t &length)
+{
+  length = measureJson(doc);
+  char *body = (char *)allocator()->allocate(length + 1);
+  if (body == nullptr)
+  {
+    return nullptr;
+  }
+  serializeJson(doc, body, length + 1);
+  return std::shared_ptr<char>(body, [](char *p)
+                               { JsonResponse::getInstance().allocator()->deallocate(p); });
+}
+
+/**
+ * @brief Streams a serialized body as the reply to a request.
+ *
+ * The response reads the body lazily, so the filler holds a reference to it
+ * until the response is destroyed.
+ */
+void JsonResponse::stream(AsyncWebServerRequest *request, std::shared_ptr<char> body, size_t length, int code)
+{
+  AsyncWebServerResponse *response = request->beginResponse(
+      "application/json", length, [body, length](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+      {
+        size_t n = min(maxLen, length - index);
+        memcpy(buffer, body.get() + index, n);
+        return n; });
+  response->setCode(code);
+  request->send(response);
+}
@@ -0,0 +1,9 @@
+/**
+ * @file LockGuard.cpp
+ * @brief Storage for the LockWaitProbe.
+ */
+
+#include "LockGuard.h"
+
+TaskHandle_t LockWaitProbe::task = nullptr;
+uint32_t LockWaitProbe::waitUs = 0;
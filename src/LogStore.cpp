@@ -0,0 +1,283 @@
+/**
+ * @file LogStore.cpp
+ * @brief Implements the segmented persistent system log.
+ */
+#include "LogStore.h"
+#include "LockGuard.h"
+#include <esp32-hal-psram.h>
+#include <time.h>
+#include <algorithm>
+
+static_assert(LOG_STORE_SEGMENT_SIZE % LOG_STORE_BLOCK_SIZE == 0, "LOG_STORE_SEGMENT_SIZE must be a whole number of blocks");
+
+static const char *INDEX_PATH = LOG_STORE_DIR "/index";
+
+/**
+ * @brief Constructs the LogStore and reserves its block buffer.
+ */
+LogStore::LogStore()
+{
+  _mutex = xSemaphoreCreateRecursiveMutex();
+  _block = (char *)ps_malloc(LOG_STORE_BLOCK_SIZE);
+  if (_block == nullptr)
+  {
+    _block = (char *)malloc(LOG_STORE_BLOCK_SIZE);
+  }
+}
+
+/**
+ * @brief Formats the path of a segment file.
+ * @param buf The buffer to write the path to.
+ * @param size The size of the buffer.
+ * @param sequence The segment's sequence number.
+ */
+void LogStore::segmentPath(char *buf, size_t size, uint32_t sequence)
+{
+  snprintf(buf, size, LOG_STORE_DIR "/%08lx.log", (unsigned long)sequence);
+}
+
+/**
+ * @brief Loads the index and opens the newest segment.
+ *
+ * Index entries whose file is missing are dropped. If the newest segment was
+ * last synced mid-block, writing carries on from that offset in the block.
+ */
+void LogStore::begin()
+{
+  RecursiveLockGuard lock(_mutex);
+
+  // The single-file log of earlier firmware.
+  LittleFS.remove("/system.log");
+  LittleFS.remove("/system.log.old");
+
+  if (!LittleFS.exists(LOG_STORE_DIR))
+  {
+    LittleFS.mkdir(LOG_STORE_DIR);
+  }
+
+  IndexEntry stored[LOG_STORE_SEGMENTS];
+  size_t storedCount = 0;
+  File indexFile = LittleFS.open(INDEX_PATH, "r");
+  if (indexFile)
+  {
+    storedCount = indexFile.read((uint8_t *)stored, sizeof(stored)) / sizeof(IndexEntry);
+    indexFile.close();
+  }
+
+  _count = 0;
+  char path[32];
+  for (size_t i = 0; i < storedCount; i++)
+  {
+    segmentPath(path, sizeof(path), stored[i].sequence);
+    if (LittleFS.exists(path))
+    {
+      _index[_count++] = stored[i];
+    }
+  }
+
+  if (_count == 0)
+  {
+    startSegment();
+  }
+  else
+  {
+    segmentPath(path, sizeof(path), _index[_count - 1].sequence);
+    _active = LittleFS.open(path, "a");
+    _activeSize = _active ? _active.size() : 0;
+    if (storedCount != _count)
+    {
+      saveIndex();
+    }
+  }
+
+  // Text logged before begin() starts a fresh block after what is on disk.
+  size_t offset = _activeSize % LOG_STORE_BLOCK_SIZE;
+  if (offset + _fill > LOG_STORE_BLOCK_SIZE)
+  {
+    _fill = LOG_STORE_BLOCK_SIZE - offset;
+  }
+  memmove(_block + offset, _block, _fill);
+  _written = offset;
+  _fill += offset;
+  _lastSync = millis();
+  if (_fill == LOG_STORE_BLOCK_SIZE)
+  {
+    writePending();
+  }
+}
+
+/**
+ * @brief Adds log text, writing out each block as it fills.
+ * @param text The text.
+ * @param length The length of the text in bytes.
+ */
+void LogStore::append(const char *text, size_t length)
+{
+  RecursiveLockGuard lock(_mutex);
+  if (_block == nullptr)
+  {
+    return;
+  }
+
+  while (length > 0)
+  {
+    size_t chunk = std::min(length, LOG_STORE_BLOCK_SIZE - _fill);
+    memcpy(_block + _fill, text, chunk);
+    _fill += chunk;
+    text += chunk;
+    length -= chunk;
+
+    if (_fill == LOG_STORE_BLOCK_SIZE)
+    {
+      if (!_active)
+      {
+        // Not started yet: keep the first block and drop the rest.
+        return;
+      }
+      writePending();
+    }
+  }
+}
+
+/**
+ * @brief Writes the part of the block not yet in the file.
+ *
+ * Writes never go past the end of the block, so every write ends on a block
+ * boundary except the partial ones made by `sync()`.
+ */
+void LogStore::writePending()
+{
+  if (_active && _fill > _written)
+  {
+    size_t length = _active.write((const uint8_t *)_block + _written, _fill - _written);
+    _activeSize += length;
+  }
+  // A failed write loses the text rather than retrying on every line.
+  _written = _fill;
+
+  if (_fill == LOG_STORE_BLOCK_SIZE)
+  {
+    _fill = 0;
+    _written = 0;
+  }
+  if (_activeSize >= LOG_STORE_SEGMENT_SIZE)
+  {
+    roll();
+  }
+}
+
+/**
+ * @brief Writes the unfinished block out and flushes the segment file.
+ */
+void LogStore::sync()
+{
+  RecursiveLockGuard lock(_mutex);
+  writePending();
+  if (_active)
+  {
+    _active.flush();
+  }
+  _lastSync = millis();
+}
+
+/**
+ * @brief Syncs if there is unwritten text and the interval has passed.
+ * @param interval The sync interval in ms.
+ */
+void LogStore::syncIfDue(unsigned long interval)
+{
+  RecursiveLockGuard lock(_mutex);
+  if (_fill > _written && millis() - _lastSync >= interval)
+  {
+    sync();
+  }
+}
+
+/**
+ * @brief Closes the newest segment and starts a new one.
+ */
+void LogStore::roll()
+{
+  RecursiveLockGuard lock(_mutex);
+  if (!_active)
+  {
+    return;
+  }
+
+  if (_fill > _written)
+  {
+    _active.write((const uint8_t *)_block + _written, _fill - _written);
+  }
+  _fill = 0;
+  _written = 0;
+  _active.close();
+  startSegment();
+}
+
+/**
+ * @brief Adds a new segment to the index and opens it, removing the oldest if needed.
+ */
+void LogStore::startSegment()
+{
+  char path[32];
+  uint32_t sequence = _count > 0 ? _index[_count - 1].sequence + 1 : 1;
+
+  if (_count == LOG_STORE_SEGMENTS)
+  {
+    segmentPath(path, sizeof(path), _index[0].sequence);
+    LittleFS.remove(path);
+    memmove(_index, _index + 1, (LOG_STORE_SEGMENTS - 1) * sizeof(IndexEntry));
+    _count--;
+  }
+
+  _index[_count++] = {sequence, (uint32_t)time(nullptr)};
+  saveIndex();
+
+  segmentPath(path, sizeof(path), sequence);
+  _active = LittleFS.open(path, "w");
+  _activeSize = 0;
+}
+
+/**
+ * @brief Writes the index file.
+ */
+void LogStore::saveIndex()
+{
+  File indexFile = LittleFS.open(INDEX_PATH, "w");
+  if (indexFile)
+  {
+    indexFile.write((const uint8_t *)_index, _count * sizeof(IndexEntry));
+    indexFile.close();
+  }
+}
+
+/**
+ * @brief Syncs and lists the segments, oldest first.
+ *
+ * Sizes of the older segments are read from the files; the newest one's is
+ * tracked as it is written.
+ *
+ * @param out Receives up to LOG_STORE_SEGMENTS entries.
+ * @return The number of segments.
+ */
+size_t LogStore::snapshot(Segment *out)
+{
+  RecursiveLockGuard lock(_mutex);
+  sync();
+
+  char path[32];
+  for (size_t i = 0; i < _count; i++)
+  {
+    out[i].sequence = _index[i].sequence;
+    out[i].startTime = _index[i].startTime;
+    if (i + 1 == _count)
+    {
+      out[i].size = _activeSize;
+      continue;
+    }
+    segmentPath(path, sizeof(path), _index[i].sequence);
+    File segment = LittleFS.open(path, "r");
+    out[i].size = segment ? segment.size() : 0;
+  }
+  return _count;
+}
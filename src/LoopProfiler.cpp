@@ -0,0 +1,102 @@
+/**
+ * @file LoopProfiler.cpp
+ * @brief Implements the LoopProfiler's per-scope rings and loop period histogram.
+ */
+
+#include "LoopProfiler.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cstring>
+
+const uint32_t LoopProfiler::JITTER_LIMITS_US[JITTER_BUCKETS - 1] = {100, 500, 1000, 5000, 10000, 50000};
+
+void LoopProfiler::record(LoopScope scope, uint32_t us)
+{
+  if (scope >= LOOP_SCOPE_COUNT)
+  {
+    return;
+  }
+  portENTER_CRITICAL(&_mux);
+  Ring &ring = _rings[scope];
+  ring.us[ring.next] = us;
+  ring.next = (ring.next + 1) % WINDOW;
+  if (ring.count < WINDOW)
+  {
+    ring.count++;
+  }
+  ring.calls++;
+  portEXIT_CRITICAL(&_mux);
+}
+
+void LoopProfiler::markLoopWake(bool wokenEarly)
+{
+  uint32_t now = micros();
+  uint32_t period = now - _lastWakeUs;
+  bool first = _lastWakeUs == 0;
+  _lastWakeUs = now;
+  if (first)
+  {
+    return;
+  }
+
+  portENTER_CRITICAL(&_mux);
+  if (wokenEarly)
+  {
+    _jitter.earlyWakes++;
+  }
+  else
+  {
+    const uint32_t intervalUs = LOOP_INTERVAL * 1000;
+    uint32_t deviation = period > intervalUs ? period - intervalUs : intervalUs - period;
+    int bucket = 0;
+    while (bucket < JITTER_BUCKETS - 1 && deviation >= JITTER_LIMITS_US[bucket])
+    {
+      bucket++;
+    }
+    _jitter.buckets[bucket]++;
+    _jitter.periods++;
+    _jitter.maxUs = max(_jitter.maxUs, deviation);
+    _jitter.totalUs += deviation;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+bool LoopProfiler::getScopeStats(LoopScope scope, ScopeStats &stats)
+{
+  if (scope >= LOOP_SCOPE_COUNT)
+  {
+    return false;
+  }
+
+  uint32_t us[WINDOW];
+  int count;
+  portENTER_CRITICAL(&_mux);
+  const Ring &ring = _rings[scope];
+  count = ring.count;
+  stats.calls = ring.calls;
+  memcpy(us, ring.us, count * sizeof(uint32_t));
+  portEXIT_CRITICAL(&_mux);
+  if (count == 0)
+  {
+    return false;
+  }
+
+  std::sort(us, us + count);
+  uint64_t total = 0;
+  for (int i = 0; i < count; i++)
+  {
+    total += us[i];
+  }
+  stats.minUs = us[0];
+  stats.avgUs = (uint32_t)(total / count);
+  stats.p99Us = us[(count - 1) * 99 / 100];
+  stats.maxUs = us[count - 1];
+  return true;
+}
+
+void LoopProfiler::getJitterStats(JitterStats &stats)
+{
+  portENTER_CRITICAL(&_mux);
+  stats = _jitter;
+  portEXIT_CRITICAL(&_mux);
+}
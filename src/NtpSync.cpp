@@ -8,11 +8,30 @@
  */
 #include "NtpSync.h"
 #include "SensorModule.h"
+#include "TimeManager.h"
 #include "SerialLog.h"
 #include "ConfigManager.h"
 #include "LockGuard.h"
+#include "Constants.h"
 #include <Arduino.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+#include <atomic>
+
+/// @brief Set by the SNTP daemon each time it corrects the system clock.
+static std::atomic<bool> sntpSynced{false};
+
+/**
+ * @brief Notes that the SNTP daemon has just set the system clock.
+ * @details Runs on the lwIP task, so it only raises a flag.
+ * @param tv The time the clock was set to.
+ */
+static void onSntpSync(struct timeval *tv)
+{
+  sntpSynced.store(true);
+}
 
 /**
  * @brief One-time initialization of the SNTP client.
@@ -23,10 +42,12 @@
  */
 void initNtp()
 {
+  sntp_set_time_sync_notification_cb(onSntpSync);
+  sntp_set_sync_interval(NTP_SYNC_INTERVAL_MIN);
   configTime(0, 0, NTP_SERVER, BACKUP_NTP_SERVER, BACKUP2_NTP_SERVER);
   setenv("TZ", ConfigManager::getInstance().getTimezone().c_str(), 1);
   tzset();
-  SerialLog::getInstance().print("NTP: SNTP client initialized.\n");
+  LOG_D(LOG_MODULE_TIME, "NTP: SNTP client initialized.\n");
 }
 
 // --- Common NTP Constants ---
@@ -60,39 +81,50 @@ static unsigned long currentRetryDelay = 0;
 
 /**
  * @brief Processes the time data received from an NTP server.
- * @details Converts the tm struct to a DateTime and sets the hardware RTC.
- *          The ESP-IDF SNTP daemon already handles RTT compensation internally,
- *          so the time in `timeinfo` (from `getLocalTime`) is already accurate.
+ * @details Sets the hardware RTC to the next whole second, written at the
+ *          moment that second begins, so the RTC's second edge lines up with
+ *          NTP's rather than lagging it by the sub-second part. The ESP-IDF
+ *          SNTP daemon already handles RTT compensation internally, so the
+ *          system clock is already accurate.
  * @param timeinfo The tm struct populated by a successful getLocalTime() call.
  */
 static void _processSuccessfulNtpSync(const struct tm &timeinfo)
 {
-  // Convert the C `tm` struct to an `RTClib::DateTime` object.
-  DateTime time_to_set(
-      timeinfo.tm_year + 1900,
-      timeinfo.tm_mon + 1,
-      timeinfo.tm_mday,
-      timeinfo.tm_hour,
-      timeinfo.tm_min,
-      timeinfo.tm_sec);
+  DateTime time_to_set;
+  int64_t edgeMicros = 0;
+  int64_t localUs;
+  int64_t readMicros;
+  if (getNtpTimeMicros(localUs, readMicros))
+  {
+    int64_t nextSecond = localUs / 1000000 + 1;
+    time_to_set = DateTime((uint32_t)nextSecond);
+    edgeMicros = readMicros + (nextSecond * 1000000 - localUs);
+  }
+  else
+  {
+    // Convert the C `tm` struct to an `RTClib::DateTime` object.
+    time_to_set = DateTime(
+        timeinfo.tm_year + 1900,
+        timeinfo.tm_mon + 1,
+        timeinfo.tm_mday,
+        timeinfo.tm_hour,
+        timeinfo.tm_min,
+        timeinfo.tm_sec);
+  }
 
-  // Update the hardware RTC directly. No manual RTT compensation needed;
-  // the SNTP daemon has already applied it to the system clock.
-  RTC.adjust(time_to_set);
+  // Update the hardware RTC, which also re-anchors the free-running clock.
+  TimeManager::getInstance().adjustRTC(time_to_set, edgeMicros);
 
   // Update DST status in configuration
   ConfigManager::getInstance().setDST(timeinfo.tm_isdst > 0);
 
-  SerialLog::getInstance().print("RTC synchronized with NTP time: ");
-  char timeStr[20];
-  sprintf(timeStr, "%04d-%02d-%02d %02d:%02d:%02d",
-          time_to_set.year(),
-          time_to_set.month(),
-          time_to_set.day(),
-          time_to_set.hour(),
-          time_to_set.minute(),
-          time_to_set.second());
-  SerialLog::getInstance().printf("%s\n", timeStr);
+  LOG_I(LOG_MODULE_TIME, "RTC synchronized with NTP time: %04d-%02d-%02d %02d:%02d:%02d\n",
+        time_to_set.year(),
+        time_to_set.month(),
+        time_to_set.day(),
+        time_to_set.hour(),
+        time_to_set.minute(),
+        time_to_set.second());
 }
 
 /**
@@ -119,7 +151,7 @@ void startNtpSync()
   {
     return;
   }
-  SerialLog::getInstance().printf("Starting non-blocking NTP sync...\n");
+  LOG_D(LOG_MODULE_TIME, "Starting non-blocking NTP sync...\n");
   ntpState = NTP_SYNC_IN_PROGRESS;
   retryCount = 0;
   // Set lastSyncAttemptMs to 0 to trigger an immediate first attempt in updateNtpSync
@@ -148,7 +180,7 @@ NtpSyncState updateNtpSync()
   lastSyncAttemptMs = currentMillis; // Mark the time of this attempt
   retryCount++;
 
-  SerialLog::getInstance().printf("Fetching NTP time (Attempt %d/%d)...\n", retryCount, maxRetries);
+  LOG_D(LOG_MODULE_TIME, "Fetching NTP time (Attempt %d/%d)...\n", retryCount, maxRetries);
 
   struct tm timeinfo;
   if (getNTPData(timeinfo))
@@ -161,7 +193,7 @@ NtpSyncState updateNtpSync()
   // If sync failed, check for retry limit
   if (retryCount >= maxRetries)
   {
-    SerialLog::getInstance().printf("Failed to sync time with NTP server after all retries.\n");
+    LOG_E(LOG_MODULE_TIME, "Failed to sync time with NTP server after all retries.\n");
     ntpState = NTP_SYNC_FAILED; // Update state to failed
     return ntpState;
   }
@@ -170,7 +202,7 @@ NtpSyncState updateNtpSync()
   unsigned long jitter = random(jitterMaxMs + 1);
   unsigned long nextDelay = currentRetryDelay + jitter;
 
-  SerialLog::getInstance().printf("Failed to obtain time. Retrying in approx. %.2f seconds...\n", nextDelay / 1000.0);
+  LOG_W(LOG_MODULE_TIME, "Failed to obtain time. Retrying in approx. %.2f seconds...\n", nextDelay / 1000.0);
 
   // Exponentially increase the base delay for the *next* cycle
   currentRetryDelay *= 2;
@@ -192,7 +224,7 @@ bool syncTime()
 
   for (int i = 1; i <= maxRetries; i++)
   {
-    SerialLog::getInstance().printf("Fetching NTP time (Attempt %d/%d)...\n", i, maxRetries);
+    LOG_D(LOG_MODULE_TIME, "Fetching NTP time (Attempt %d/%d)...\n", i, maxRetries);
 
     esp_task_wdt_reset(); // Feed before the potentially blocking getNTPData
     if (getNTPData(timeinfo))
@@ -207,7 +239,7 @@ bool syncTime()
       unsigned long jitter = random(jitterMaxMs + 1);
       unsigned long totalDelay = delayForNextAttempt + jitter;
 
-      SerialLog::getInstance().printf("Failed to obtain time. Retrying in %.2f seconds...\n", totalDelay / 1000.0);
+      LOG_W(LOG_MODULE_TIME, "Failed to obtain time. Retrying in %.2f seconds...\n", totalDelay / 1000.0);
       
       // Use a loop for the delay to keep the watchdog fed if the delay is long
       unsigned long startDelay = millis();
@@ -224,7 +256,7 @@ bool syncTime()
     }
   }
 
-  SerialLog::getInstance().printf("Failed to sync time with NTP server after all retries.\n");
+  LOG_E(LOG_MODULE_TIME, "Failed to sync time with NTP server after all retries.\n");
   return false;
 }
 
@@ -235,7 +267,7 @@ void resetNtpSync()
 {
   LockGuard lock(ntpMutex);
   ntpState = NTP_SYNC_IDLE;
-  SerialLog::getInstance().print("NTP sync state reset to IDLE.");
+  LOG_D(LOG_MODULE_TIME, "NTP sync state reset to IDLE.");
 }
 
 DateTime getNtpTime()
@@ -243,7 +275,7 @@ DateTime getNtpTime()
   struct tm timeinfo;
   if (!getLocalTime(&timeinfo))
   {
-    SerialLog::getInstance().print("Failed to obtain NTP time.\n");
+    LOG_E(LOG_MODULE_TIME, "Failed to obtain NTP time.\n");
     return DateTime(); // Return an invalid DateTime
   }
 
@@ -255,4 +287,52 @@ DateTime getNtpTime()
       timeinfo.tm_hour,
       timeinfo.tm_min,
       timeinfo.tm_sec);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Reads the system clock as local time, to the microsecond.
+ * @param localUs Receives the local time, in microseconds since the epoch.
+ * @param readMicros Receives esp_timer_get_time() at the moment of the read.
+ * @return False if the system clock has never been set.
+ */
+bool getNtpTimeMicros(int64_t &localUs, int64_t &readMicros)
+{
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  readMicros = esp_timer_get_time();
+  // The same validity test getLocalTime() uses.
+  if (tv.tv_sec < 1451606400) // 2016-01-01
+  {
+    return false;
+  }
+
+  struct tm local;
+  localtime_r(&tv.tv_sec, &local);
+  DateTime localTime(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+  localUs = (int64_t)localTime.unixtime() * 1000000 + tv.tv_usec;
+  return true;
+}
+
+/**
+ * @brief Checks whether the SNTP daemon has set the system clock since the last call.
+ * @return True once per daemon sync.
+ */
+bool takeSntpSyncEvent()
+{
+  return sntpSynced.exchange(false);
+}
+
+/**
+ * @brief Changes how often the SNTP daemon polls its server.
+ * @param intervalMs The poll interval, in ms.
+ */
+void setNtpSyncInterval(uint32_t intervalMs)
+{
+  if (sntp_get_sync_interval() == intervalMs)
+  {
+    return;
+  }
+  sntp_set_sync_interval(intervalMs);
+  sntp_restart();
+  LOG_D(LOG_MODULE_TIME, "NTP: Poll interval set to %lu min.\n", (unsigned long)(intervalMs / 60000));
+}
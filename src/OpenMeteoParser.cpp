@@ -0,0 +1,355 @@
+/**
+ * @file OpenMeteoParser.cpp
+ * @brief Implements the streaming parser for Open-Meteo forecast responses.
+ */
+#include "OpenMeteoParser.h"
+#include <RTClib.h>
+#include <esp_heap_caps.h>
+
+/**
+ * @brief Takes the time of day from an ISO 8601 local time such as "2024-06-01T05:12".
+ * @param iso The time string.
+ * @return Minutes since midnight, or -1 if there is no time of day in it.
+ */
+static int16_t parseMinutesOfDay(const char *iso)
+{
+  const char *time = strchr(iso, 'T');
+  time = (time != nullptr) ? time + 1 : iso;
+  int hour, minute;
+  if (sscanf(time, "%d:%d", &hour, &minute) != 2 || hour < 0 || hour > 23 || minute < 0 || minute > 59)
+  {
+    return -1;
+  }
+  return hour * 60 + minute;
+}
+
+/**
+ * @brief Converts an ISO 8601 local date or date and time to a local unixtime.
+ * @param iso A string such as "2024-06-01" or "2024-06-01T05:00".
+ * @return The local unixtime, or 0 if the string isn't a date.
+ */
+static uint32_t parseLocalTime(const char *iso)
+{
+  int year, month, day, hour = 0, minute = 0;
+  int fields = sscanf(iso, "%d-%d-%dT%d:%d", &year, &month, &day, &hour, &minute);
+  if (fields != 3 && fields != 5)
+  {
+    return 0;
+  }
+  if (year < 2000 || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || hour > 23 || minute < 0 || minute > 59)
+  {
+    return 0;
+  }
+  return DateTime(year, month, day, hour, minute, 0).unixtime();
+}
+
+/**
+ * @brief Starts a parse, clearing the forecast arrays.
+ * @param current Receives the `current` block and the first sunrise and sunset.
+ * @param forecast Receives the `hourly` and `daily` series; null to skip them.
+ */
+OpenMeteoParser::OpenMeteoParser(WeatherData &current, WeatherForecast *forecast)
+    : _current(current), _forecast(forecast)
+{
+  if (_forecast != nullptr)
+  {
+    *_forecast = WeatherForecast();
+  }
+}
+
+/**
+ * @brief Checks that the whole response was read and understood.
+ * @return True if the document was well formed and had a `current` block.
+ */
+bool OpenMeteoParser::finish() const
+{
+  return !_failed && _sawRoot && _depth == 0 && _lex == LEX_VALUE && _sawCurrent;
+}
+
+size_t OpenMeteoParser::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+/**
+ * @brief Parses one chunk of the body.
+ *
+ * Always reports the whole chunk as taken, even after a parse error, since
+ * `HTTPClient::writeToStream()` treats a short write as a stream error and
+ * would stop draining the connection.
+ */
+size_t OpenMeteoParser::write(const uint8_t *buffer, size_t size)
+{
+  size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  if (freeHeap < _minFreeHeap)
+  {
+    _minFreeHeap = freeHeap;
+  }
+
+  _bytes += size;
+  for (size_t i = 0; i < size && !_failed; i++)
+  {
+    feed((char)buffer[i]);
+  }
+  return size;
+}
+
+/**
+ * @brief Feeds one character to the lexer.
+ *
+ * Escapes are kept as the escaped character, which is enough for the ASCII
+ * keys and values the clock reads.
+ */
+void OpenMeteoParser::feed(char c)
+{
+  switch (_lex)
+  {
+  case LEX_STRING:
+    if (c == '\\')
+    {
+      _lex = LEX_STRING_ESCAPE;
+    }
+    else if (c == '"')
+    {
+      _lex = LEX_VALUE;
+      endString();
+    }
+    else
+    {
+      append(c);
+    }
+    return;
+  case LEX_STRING_ESCAPE:
+    append(c);
+    _lex = LEX_STRING;
+    return;
+  case LEX_LITERAL:
+    if (isalnum((unsigned char)c) || c == '-' || c == '+' || c == '.')
+    {
+      append(c);
+      return;
+    }
+    _lex = LEX_VALUE;
+    value(false);
+    break; // The character ending the literal still needs handling.
+  case LEX_VALUE:
+    break;
+  }
+
+  switch (c)
+  {
+  case ' ':
+  case '\t':
+  case '\r':
+  case '\n':
+    break;
+  case '{':
+    open('{');
+    _expectKey = true;
+    break;
+  case '[':
+    open('[');
+    break;
+  case '}':
+    close('{');
+    break;
+  case ']':
+    close('[');
+    break;
+  case ',':
+    if (_depth == 0)
+    {
+      _failed = true;
+    }
+    else if (_types[_depth - 1] == '[')
+    {
+      _index[_depth - 1]++;
+    }
+    else
+    {
+      _expectKey = true;
+    }
+    break;
+  case ':':
+    if (_depth == 0 || _types[_depth - 1] != '{' || !_expectKey)
+    {
+      _failed = true;
+    }
+    _expectKey = false;
+    break;
+  case '"':
+    _tokenLength = 0;
+    _lex = LEX_STRING;
+    break;
+  default:
+    if (_depth == 0 || !(isalnum((unsigned char)c) || c == '-'))
+    {
+      _failed = true;
+      break;
+    }
+    _tokenLength = 0;
+    append(c);
+    _lex = LEX_LITERAL;
+    break;
+  }
+}
+
+void OpenMeteoParser::open(char type)
+{
+  if (_depth >= MAX_DEPTH || (_depth == 0 && _sawRoot))
+  {
+    _failed = true;
+    return;
+  }
+  _types[_depth] = type;
+  _index[_depth] = 0;
+  _depth++;
+  _sawRoot = true;
+}
+
+void OpenMeteoParser::close(char type)
+{
+  if (_depth == 0 || _types[_depth - 1] != type)
+  {
+    _failed = true;
+    return;
+  }
+  _depth--;
+}
+
+void OpenMeteoParser::append(char c)
+{
+  if (_tokenLength < TOKEN_SIZE - 1)
+  {
+    _token[_tokenLength++] = c;
+  }
+}
+
+/**
+ * @brief Handles a completed string, either a key or a value.
+ */
+void OpenMeteoParser::endString()
+{
+  if (_depth > 0 && _types[_depth - 1] == '{' && _expectKey)
+  {
+    if (_depth - 1 < KEY_LEVELS)
+    {
+      memcpy(_keys[_depth - 1], _token, _tokenLength);
+      _keys[_depth - 1][_tokenLength] = '\0';
+    }
+    return;
+  }
+  value(true);
+}
+
+/**
+ * @brief Stores a scalar value if its path is one the clock uses.
+ *
+ * Values directly inside `current` are fields of the current weather; values
+ * in an array directly inside `hourly` or `daily` are series elements.
+ * @param isString Whether the token was a quoted string.
+ */
+void OpenMeteoParser::value(bool isString)
+{
+  _token[_tokenLength] = '\0';
+  if (!isString && strcmp(_token, "null") == 0)
+  {
+    return;
+  }
+
+  if (_depth == 2 && _types[0] == '{' && _types[1] == '{' && strcmp(_keys[0], "current") == 0)
+  {
+    currentValue(_keys[1]);
+  }
+  else if (_depth == 3 && _types[0] == '{' && _types[1] == '{' && _types[2] == '[')
+  {
+    seriesValue(_keys[0], _keys[1], _index[2]);
+  }
+}
+
+void OpenMeteoParser::currentValue(const char *key)
+{
+  float number = strtof(_token, nullptr);
+  if (strcmp(key, "temperature_2m") == 0)
+  {
+    _current.temp = number;
+    _sawCurrent = true;
+  }
+  else if (strcmp(key, "apparent_temperature") == 0)
+    _current.feelsLike = number;
+  else if (strcmp(key, "relative_humidity_2m") == 0)
+    _current.humidity = number;
+  else if (strcmp(key, "wind_speed_10m") == 0)
+    _current.windSpeed = number;
+  else if (strcmp(key, "weather_code") == 0)
+    _current.weatherCode = (int16_t)number;
+  else if (strcmp(key, "cloud_cover") == 0)
+    _current.cloudCover = (int)number;
+  else if (strcmp(key, "pressure_msl") == 0)
+    _current.pressure = number;
+  else if (strcmp(key, "wind_direction_10m") == 0)
+    _current.windDirection = (int)number;
+  else if (strcmp(key, "wind_gusts_10m") == 0)
+    _current.windGusts = number;
+  else if (strcmp(key, "uv_index") == 0)
+    _current.uvIndex = number;
+  else if (strcmp(key, "visibility") == 0)
+    _current.visibility = number;
+  else if (strcmp(key, "precipitation_probability") == 0)
+    _current.rainChance = (int)number;
+}
+
+void OpenMeteoParser::seriesValue(const char *block, const char *key, uint16_t index)
+{
+  if (strcmp(block, "daily") == 0 && index == 0)
+  {
+    if (strcmp(key, "sunrise") == 0)
+    {
+      _current.sunriseMinutes = parseMinutesOfDay(_token);
+      return;
+    }
+    if (strcmp(key, "sunset") == 0)
+    {
+      _current.sunsetMinutes = parseMinutesOfDay(_token);
+      return;
+    }
+  }
+  if (_forecast == nullptr)
+  {
+    return;
+  }
+
+  WeatherForecast &forecast = *_forecast;
+  if (strcmp(block, "hourly") == 0 && index < WeatherForecast::HOURS)
+  {
+    if (strcmp(key, "time") == 0)
+    {
+      forecast.hourTime[index] = parseLocalTime(_token);
+      if (index + 1 > forecast.hourCount)
+        forecast.hourCount = index + 1;
+    }
+    else if (strcmp(key, "temperature_2m") == 0)
+      forecast.hourTemp[index] = strtof(_token, nullptr);
+    else if (strcmp(key, "precipitation_probability") == 0)
+      forecast.hourRain[index] = (uint8_t)constrain(atoi(_token), 0, 100);
+    else if (strcmp(key, "weather_code") == 0)
+      forecast.hourCode[index] = (int16_t)atoi(_token);
+  }
+  else if (strcmp(block, "daily") == 0 && index < WeatherForecast::DAYS)
+  {
+    if (strcmp(key, "time") == 0)
+    {
+      forecast.dayTime[index] = parseLocalTime(_token);
+      if (index + 1 > forecast.dayCount)
+        forecast.dayCount = index + 1;
+    }
+    else if (strcmp(key, "temperature_2m_max") == 0)
+      forecast.dayHigh[index] = strtof(_token, nullptr);
+    else if (strcmp(key, "temperature_2m_min") == 0)
+      forecast.dayLow[index] = strtof(_token, nullptr);
+    else if (strcmp(key, "precipitation_probability_max") == 0)
+      forecast.dayRain[index] = (uint8_t)constrain(atoi(_token), 0, 100);
+    else if (strcmp(key, "weather_code") == 0)
+      forecast.dayCode[index] = (int16_t)atoi(_token);
+  }
+}
@@ -0,0 +1,163 @@
+/**
+ * @file PowerManager.cpp
+ * @brief Implements frequency scaling and the activity locks.
+ */
+
+#include "PowerManager.h"
+#include "SerialLog.h"
+#include <esp_freertos_hooks.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+
+volatile uint32_t PowerManager::s_frequencyTicks[POWER_FREQUENCY_COUNT] = {};
+
+PowerManager::PowerManager()
+{
+  // Locks can be created and taken before esp_pm is configured, so the
+  // display and network can use them from the start of boot.
+  for (int i = 0; i < POWER_LOCK_COUNT; i++)
+  {
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, POWER_LOCK_NAMES[i], &_locks[i]) != ESP_OK)
+    {
+      _locks[i] = nullptr;
+    }
+  }
+}
+
+/**
+ * @brief Turns on frequency scaling.
+ *
+ * esp_pm refuses the configuration if the framework is built without PM
+ * support, and the CPU then stays at the boot frequency.
+ */
+void PowerManager::begin()
+{
+  // Both cores share one clock, so sampling on one of them is enough.
+  if (esp_register_freertos_tick_hook_for_cpu(onTick, 0) != ESP_OK)
+  {
+    LOG_W(LOG_MODULE_SYSTEM, "Power: no tick hook, frequency residency unavailable.\n");
+  }
+
+  if (!POWER_MANAGEMENT)
+  {
+    return;
+  }
+
+  esp_pm_config_esp32s3_t config = {};
+  config.max_freq_mhz = getCpuFrequencyMhz();
+  config.min_freq_mhz = POWER_MIN_CPU_FREQ_MHZ;
+  config.light_sleep_enable = false;
+  esp_err_t err = esp_pm_configure(&config);
+  if (err != ESP_OK)
+  {
+    LOG_W(LOG_MODULE_SYSTEM, "Power: frequency scaling unavailable (%s).\n", esp_err_to_name(err));
+    return;
+  }
+
+  _active = true;
+  LOG_I(LOG_MODULE_SYSTEM, "Power: CPU %d-%d MHz.\n", config.min_freq_mhz, config.max_freq_mhz);
+}
+
+/**
+ * @brief Holds the CPU at full speed until the matching `release()`.
+ * @param kind The activity.
+ */
+void PowerManager::acquire(PowerLockKind kind)
+{
+  if (kind >= POWER_LOCK_COUNT)
+  {
+    return;
+  }
+  if (_locks[kind] != nullptr)
+  {
+    esp_pm_lock_acquire(_locks[kind]);
+  }
+  portENTER_CRITICAL(&_mux);
+  if (_holds[kind]++ == 0)
+  {
+    _heldSince[kind] = esp_timer_get_time();
+    _stats[kind].acquisitions++;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief Ends one `acquire()` of an activity.
+ * @param kind The activity.
+ */
+void PowerManager::release(PowerLockKind kind)
+{
+  if (kind >= POWER_LOCK_COUNT)
+  {
+    return;
+  }
+  portENTER_CRITICAL(&_mux);
+  bool wasHeld = _holds[kind] > 0;
+  if (wasHeld && --_holds[kind] == 0)
+  {
+    _stats[kind].heldUs += esp_timer_get_time() - _heldSince[kind];
+  }
+  portEXIT_CRITICAL(&_mux);
+  if (wasHeld && _locks[kind] != nullptr)
+  {
+    esp_pm_lock_release(_locks[kind]);
+  }
+}
+
+/**
+ * @brief Gets one lock's statistics.
+ * @param kind The lock.
+ * @param stats Receives the statistics.
+ */
+void PowerManager::getLockStats(PowerLockKind kind, LockStats &stats)
+{
+  stats = {};
+  if (kind >= POWER_LOCK_COUNT)
+  {
+    return;
+  }
+  portENTER_CRITICAL(&_mux);
+  stats = _stats[kind];
+  stats.held = _holds[kind] > 0;
+  if (stats.held)
+  {
+    stats.heldUs += esp_timer_get_time() - _heldSince[kind];
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+
+/**
+ * @brief Counts a tick against the CPU clock it interrupted.
+ *
+ * Runs in the tick interrupt of core 0. The ROM's ticks-per-microsecond
+ * figure is updated by every clock switch, so it is the current clock in MHz.
+ */
+void IRAM_ATTR PowerManager::onTick()
+{
+  uint32_t mhz = esp_rom_get_cpu_ticks_per_us();
+  for (int i = 0; i < POWER_FREQUENCY_COUNT; i++)
+  {
+    if (POWER_FREQUENCIES_MHZ[i] == mhz)
+    {
+      s_frequencyTicks[i]++;
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Gets the time spent at each CPU clock since `begin()`.
+ * @param residencyMs Receives one figure per entry of `POWER_FREQUENCIES_MHZ`, in ms.
+ * @return The total sampled time, in ms; 0 if the tick hook could not be registered.
+ */
+uint32_t PowerManager::getResidency(uint32_t residencyMs[POWER_FREQUENCY_COUNT]) const
+{
+  uint32_t totalMs = 0;
+  for (int i = 0; i < POWER_FREQUENCY_COUNT; i++)
+  {
+    residencyMs[i] = s_frequencyTicks[i] * portTICK_PERIOD_MS;
+    totalMs += residencyMs[i];
+  }
+  return totalMs;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file RenderProfiler.cpp
+ * @brief Implements the RenderProfiler's per-page frame rings and percentiles.
+ */
+
+#include "RenderProfiler.h"
+#include "FontManager.h"
+#include "LockGuard.h"
+#include <algorithm>
+#include <cstring>
+
+RenderProfiler::RenderProfiler()
+{
+  _mutex = xSemaphoreCreateMutex();
+  memset(_rings, 0, sizeof(_rings));
+}
+
+void RenderProfiler::setEnabled(bool enabled)
+{
+  LockGuard lock(_mutex);
+  if (enabled && !_enabled)
+  {
+    memset(_rings, 0, sizeof(_rings));
+  }
+  _inFrame = false;
+  _enabled = enabled;
+}
+
+void RenderProfiler::beginFrame(int page)
+{
+  if (!_enabled || page < 0 || page >= MAX_PAGES)
+  {
+    return;
+  }
+  FontManager &fonts = FontManager::getInstance();
+  _page = page;
+  _pushUs = 0;
+  _pixels = 0;
+  _fontLoadsAtStart = fonts.totalLoads();
+  _fontSwitchesAtStart = fonts.totalSwitches();
+  _frameStart = micros();
+  _inFrame = true;
+}
+
+void RenderProfiler::endFrame()
+{
+  if (!_inFrame)
+  {
+    return;
+  }
+  _inFrame = false;
+
+  FontManager &fonts = FontManager::getInstance();
+  Sample sample;
+  sample.frameUs = micros() - _frameStart;
+  sample.pushUs = min(_pushUs, sample.frameUs);
+  sample.pixels = _pixels;
+  sample.fontLoads = fonts.totalLoads() - _fontLoadsAtStart;
+  sample.fontSwitches = fonts.totalSwitches() - _fontSwitchesAtStart;
+
+  LockGuard lock(_mutex);
+  Ring &ring = _rings[_page];
+  ring.samples[ring.next] = sample;
+  ring.next = (ring.next + 1) % RING_SIZE;
+  if (ring.count < RING_SIZE)
+  {
+    ring.count++;
+  }
+}
+
+/**
+ * @brief Sorts the values in place and reads the percentiles off them.
+ */
+RenderProfiler::Percentiles RenderProfiler::percentiles(uint32_t *values, int count)
+{
+  std::sort(values, values + count);
+  return {values[(count - 1) * 50 / 100], values[(count - 1) * 95 / 100], values[count - 1]};
+}
+
+bool RenderProfiler::getPageStats(int page, PageStats &stats)
+{
+  if (page < 0 || page >= MAX_PAGES)
+  {
+    return false;
+  }
+
+  Sample samples[RING_SIZE];
+  int count;
+  {
+    LockGuard lock(_mutex);
+    count = _rings[page].count;
+    memcpy(samples, _rings[page].samples, sizeof(samples));
+  }
+  if (count == 0)
+  {
+    return false;
+  }
+
+  uint32_t frame[RING_SIZE], raster[RING_SIZE], push[RING_SIZE], pixels[RING_SIZE];
+  stats.fontLoads = 0;
+  stats.fontSwitches = 0;
+  for (int i = 0; i < count; i++)
+  {
+    frame[i] = samples[i].frameUs;
+    push[i] = samples[i].pushUs;
+    raster[i] = samples[i].frameUs - samples[i].pushUs;
+    pixels[i] = samples[i].pixels;
+    stats.fontLoads += samples[i].fontLoads;
+    stats.fontSwitches += samples[i].fontSwitches;
+  }
+
+  stats.frames = count;
+  stats.frameUs = percentiles(frame, count);
+  stats.rasterUs = percentiles(raster, count);
+  stats.pushUs = percentiles(push, count);
+  stats.pixels = percentiles(pixels, count);
+  return true;
+}
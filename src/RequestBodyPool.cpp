@@ -0,0 +1,110 @@
+/**
+ * @file RequestBodyPool.cpp
+ * @brief Implements the pooled PSRAM buffers that POST bodies are collected into.
+ */
+
+#include "RequestBodyPool.h"
+#include "LockGuard.h"
+#include "SerialLog.h"
+#include <esp32-hal-psram.h>
+#include <cstring>
+
+RequestBodyPool::RequestBodyPool()
+{
+  static_assert(SLOTS <= 32, "The free mask holds at most 32 slots");
+  _mutex = xSemaphoreCreateMutex();
+  _storage = (uint8_t *)ps_malloc(SLOTS * SLOT_SIZE);
+  if (_storage == nullptr)
+  {
+    LOG_E(LOG_MODULE_WEB, "RequestBodyPool: failed to reserve %u bytes.\n", (unsigned)(SLOTS * SLOT_SIZE));
+    _freeMask = 0;
+    return;
+  }
+  for (int i = 0; i < SLOTS; i++)
+  {
+    _bodies[i].data = (char *)_storage + i * SLOT_SIZE;
+  }
+  _freeMask = (SLOTS == 32) ? 0xFFFFFFFFu : ((1u << SLOTS) - 1);
+}
+
+/**
+ * @brief Takes the lowest free slot.
+ * @param total The Content-Length the slot is taken for.
+ * @return The slot's body, or nullptr if every slot is busy.
+ */
+RequestBody *RequestBodyPool::acquire(size_t total)
+{
+  LockGuard lock(_mutex);
+  if (_freeMask == 0)
+  {
+    return nullptr;
+  }
+  int slot = __builtin_ctz(_freeMask);
+  _freeMask &= ~(1u << slot);
+  RequestBody *body = &_bodies[slot];
+  body->length = 0;
+  body->total = total;
+  return body;
+}
+
+void RequestBodyPool::release(AsyncWebServerRequest *request)
+{
+  RequestBody *body = (RequestBody *)request->_tempObject;
+  if (body == nullptr)
+  {
+    return;
+  }
+  // The request frees a non-null _tempObject itself, so it must never keep a pool slot.
+  request->_tempObject = nullptr;
+  LockGuard lock(_mutex);
+  _freeMask |= 1u << (body - _bodies);
+}
+
+RequestBody *RequestBodyPool::collect(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total, size_t limit)
+{
+  if (index == 0)
+  {
+    if (total == 0)
+    {
+      _rejectedSize++;
+      request->send(411, "text/plain", "Content-Length required");
+      return nullptr;
+    }
+    if (total > limit || total > REQUEST_BODY_MAX_SIZE)
+    {
+      _rejectedSize++;
+      request->send(413, "text/plain", "Payload too large");
+      return nullptr;
+    }
+    RequestBody *body = acquire(total);
+    if (body == nullptr)
+    {
+      _rejectedBusy++;
+      request->send(503, "text/plain", "Server busy, try again");
+      return nullptr;
+    }
+    request->_tempObject = body;
+  }
+
+  RequestBody *body = (RequestBody *)request->_tempObject;
+  if (body == nullptr)
+  {
+    return nullptr; // Already rejected.
+  }
+  if (index + len > body->total)
+  {
+    release(request);
+    _rejectedSize++;
+    request->send(413, "text/plain", "Payload too large");
+    return nullptr;
+  }
+
+  memcpy(body->data + index, data, len);
+  body->length = index + len;
+  if (body->length < body->total)
+  {
+    return nullptr;
+  }
+  body->data[body->length] = '\0';
+  return body;
+}
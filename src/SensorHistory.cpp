@@ -0,0 +1,171 @@
+/**
+ * @file SensorHistory.cpp
+ * @brief Implements the slotted PSRAM ring of indoor readings.
+ */
+
+#include "SensorHistory.h"
+#include "SensorModule.h"
+#include "LockGuard.h"
+#include "SerialLog.h"
+#include <esp_timer.h>
+#include <math.h>
+
+/// @brief The slot a time falls in.
+static int64_t slotAt(int64_t ms)
+{
+  return ms / (int64_t)SENSOR_UPDATE_INTERVAL;
+}
+
+SensorHistory::SensorHistory()
+{
+  _mutex = xSemaphoreCreateMutex();
+}
+
+/**
+ * @brief Allocates the ring in PSRAM; until then `record()` is ignored.
+ */
+void SensorHistory::begin()
+{
+  if (_samples != nullptr)
+  {
+    return;
+  }
+  _samples = (Sample *)ps_malloc(SENSOR_HISTORY_SAMPLES * sizeof(Sample));
+  if (_samples == nullptr)
+  {
+    LOG_E(LOG_MODULE_SENSOR, "SensorHistory: could not allocate %u bytes, history disabled.\n",
+          (unsigned)(SENSOR_HISTORY_SAMPLES * sizeof(Sample)));
+  }
+}
+
+/**
+ * @brief Converts a reading to hundredths, clamped to the int16 range.
+ * @param value The reading, or NAN.
+ * @return The stored value, or GAP for NAN.
+ */
+int16_t SensorHistory::encode(float value)
+{
+  if (isnan(value))
+  {
+    return GAP;
+  }
+  long hundredths = lroundf(value * 100);
+  return (int16_t)constrain(hundredths, (long)INT16_MIN + 1, (long)INT16_MAX);
+}
+
+/// @brief Appends one sample, dropping the oldest once the ring is full.
+void SensorHistory::push(const Sample &sample)
+{
+  _samples[_next] = sample;
+  _next = (_next + 1) % SENSOR_HISTORY_SAMPLES;
+  if (_count < SENSOR_HISTORY_SAMPLES)
+  {
+    _count++;
+  }
+}
+
+/**
+ * @brief Stores a reading in the current slot.
+ *
+ * Slots skipped since the previous reading are filled with gaps.
+ * @param temperatureC The filtered temperature, or NAN if there is none.
+ * @param humidity The filtered relative humidity, or NAN if there is none.
+ */
+void SensorHistory::record(float temperatureC, float humidity)
+{
+  if (_samples == nullptr)
+  {
+    return;
+  }
+  Sample sample = {encode(temperatureC), encode(humidity)};
+  int64_t slot = slotAt(esp_timer_get_time() / 1000);
+
+  LockGuard lock(_mutex);
+  if (_newestSlot >= 0 && slot == _newestSlot)
+  {
+    _samples[(_next + SENSOR_HISTORY_SAMPLES - 1) % SENSOR_HISTORY_SAMPLES] = sample;
+    return;
+  }
+  if (_newestSlot >= 0 && slot > _newestSlot + 1)
+  {
+    const Sample gap = {GAP, GAP};
+    int64_t missed = min<int64_t>(slot - _newestSlot - 1, SENSOR_HISTORY_SAMPLES);
+    for (int64_t i = 0; i < missed; i++)
+    {
+      push(gap);
+    }
+  }
+  push(sample);
+  _newestSlot = slot;
+}
+
+/**
+ * @brief Averages the ring into points of `step` samples each, oldest first.
+ *
+ * Points cover whole multiples of `step` slots, so repeated requests line
+ * up with each other; the oldest and newest points may cover fewer samples.
+ * @param step Samples per point; at least 1.
+ * @param sink Called with each point.
+ * @param context Passed to `sink`.
+ * @param newestAgeMs Receives the milliseconds since the newest point's first slot began.
+ * @return The number of points produced.
+ */
+int SensorHistory::read(uint32_t step, PointSink sink, void *context, uint32_t &newestAgeMs)
+{
+  step = max<uint32_t>(step, 1);
+  newestAgeMs = 0;
+  LockGuard lock(_mutex);
+  if (_samples == nullptr || _count == 0)
+  {
+    return 0;
+  }
+  int64_t newestStartMs = (_newestSlot / step) * step * (int64_t)SENSOR_UPDATE_INTERVAL;
+  newestAgeMs = (uint32_t)(esp_timer_get_time() / 1000 - newestStartMs);
+
+  int points = 0;
+  int64_t firstSlot = _newestSlot - (int64_t)_count + 1;
+  int64_t bucket = firstSlot / step;
+  int32_t tempSum = 0, humiditySum = 0;
+  uint32_t tempCount = 0, humidityCount = 0;
+  uint32_t start = (_next + SENSOR_HISTORY_SAMPLES - _count) % SENSOR_HISTORY_SAMPLES;
+  for (uint32_t i = 0; i <= _count; i++)
+  {
+    if (i == _count || (firstSlot + i) / step != bucket)
+    {
+      Point point;
+      point.temperatureC = tempCount > 0 ? tempSum / 100.0f / tempCount : NAN;
+      point.humidity = humidityCount > 0 ? humiditySum / 100.0f / humidityCount : NAN;
+      sink(point, context);
+      points++;
+      if (i == _count)
+      {
+        break;
+      }
+      bucket = (firstSlot + i) / step;
+      tempSum = humiditySum = 0;
+      tempCount = humidityCount = 0;
+    }
+
+    const Sample &sample = _samples[(start + i) % SENSOR_HISTORY_SAMPLES];
+    if (sample.temperature != GAP)
+    {
+      tempSum += sample.temperature;
+      tempCount++;
+    }
+    if (sample.humidity != GAP)
+    {
+      humiditySum += sample.humidity;
+      humidityCount++;
+    }
+  }
+  return points;
+}
+
+/**
+ * @brief Gets how many samples the ring holds, gaps included.
+ */
+uint32_t SensorHistory::size()
+{
+  LockGuard lock(_mutex);
+  return _count;
+}
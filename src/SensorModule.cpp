@@ -11,18 +11,20 @@
 #include "SensorModule.h"
 #include "ConfigManager.h"
 #include "SerialLog.h"
+#include "I2cBus.h"
+#include "SensorHistory.h"
 #include "driver/temp_sensor.h"
+#include <algorithm>
 #include <math.h>
 
 // Instantiate the global sensor objects declared in the header.
 Adafruit_BME280 BME;
 RTC_Type RTC;
 
-// Static variables to cache the latest sensor readings.
-static float cached_bme_temp_c = 0.0;
-static float cached_rtc_temp_c = 0.0;
-static float cached_core_temp_c = 0.0;
-static float cached_humidity = 0.0;
+// The latest sensor readings, written by the I2C bus task and copied out
+// under the spinlock by readers on either core.
+static SensorReadings cached_readings = {};
+static portMUX_TYPE readings_mux = portMUX_INITIALIZER_UNLOCKED;
 static float cached_offset_c = 0.0;
 static bool bme280_found = false; // Track BME280 sensor status
 static unsigned long lastBmeRetry = 0;
@@ -79,11 +81,99 @@ float calculateCorrectedHumidity(float temp_c, float humidity, float offset_c)
 
   return new_humidity;
 }
+
+/**
+ * @brief Starts the BME280 and puts it in forced mode.
+ *
+ * In forced mode the sensor sleeps between the measurements
+ * handleSensorUpdates() triggers, instead of converting continuously and
+ * warming itself. Pressure is never shown, so its conversion is skipped.
+ * @return True if the sensor answered.
+ */
+static bool beginBme()
+{
+  if (!BME.begin(BME280_I2C_ADDRESS))
+  {
+    return false;
+  }
+  BME.setSampling(Adafruit_BME280::MODE_FORCED, BME280_TEMP_OVERSAMPLING, Adafruit_BME280::SAMPLING_NONE,
+                  BME280_HUMIDITY_OVERSAMPLING, Adafruit_BME280::FILTER_OFF);
+  return true;
+}
+
+/**
+ * @brief Smooths one reading: the median of the last few, then a moving average.
+ *
+ * The median drops single-read spikes; the moving average takes out the
+ * remaining noise.
+ */
+struct ReadingFilter
+{
+  float window[SENSOR_MEDIAN_WINDOW];
+  int count;
+  int next;
+  float smoothed;
+
+  /// @brief Forgets the readings so far, so the next one is taken as is.
+  void reset()
+  {
+    count = 0;
+    next = 0;
+  }
+
+  /**
+   * @brief Adds a reading.
+   * @param value The reading.
+   * @return The smoothed reading.
+   */
+  float update(float value)
+  {
+    window[next] = value;
+    next = (next + 1) % SENSOR_MEDIAN_WINDOW;
+    if (count < SENSOR_MEDIAN_WINDOW)
+    {
+      count++;
+    }
+    float sorted[SENSOR_MEDIAN_WINDOW];
+    memcpy(sorted, window, count * sizeof(float));
+    std::sort(sorted, sorted + count);
+    float median = (count % 2) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+    smoothed = (count == 1) ? median : smoothed + SENSOR_SMOOTHING * (median - smoothed);
+    return smoothed;
+  }
+};
+
+static ReadingFilter tempFilter = {};
+static ReadingFilter humidityFilter = {};
+static bool filterCorrected = false;   // Whether the filters were fed corrected readings
+static float filterCorrection = 0.0;   // The correction they were fed with
+
+/// @brief Restarts both BME280 filters.
+static void resetFilters()
+{
+  tempFilter.reset();
+  humidityFilter.reset();
+}
+
+/**
+ * @brief Applies hysteresis to a displayed value.
+ * @param valid False if `held` means nothing yet.
+ * @param held The value on display.
+ * @param value The new reading.
+ * @param band How far the reading must move before the display follows.
+ * @return The value to display.
+ */
+static float holdWithin(bool valid, float held, float value, float band)
+{
+  return (valid && fabsf(value - held) < band) ? held : value;
+}
 static bool rtc_found = false;        // Track RTC status
 static bool core_temp_started = false; // Track whether temp_sensor_start() was called
 
 /// @brief Stores the timestamp of the last sensor update for interval timing.
 static unsigned long prevSensorMillis = 0;
+static volatile uint32_t sensorGeneration = 0;
+static int32_t lastPublished[4] = {}; // BME temp, humidity, RTC temp (tenths of a unit), found flags
 
 /**
  * @brief Initializes all hardware sensors.
@@ -94,9 +184,10 @@ static unsigned long prevSensorMillis = 0;
  */
 void setupSensors()
 {
+  I2cBus::Lock lock;
   for (int i = 0; i < SENSOR_RETRY_COUNT; ++i)
   {
-    bme280_found = BME.begin(BME280_I2C_ADDRESS);
+    bme280_found = beginBme();
     if (bme280_found)
       break;
     delay(SENSOR_RETRY_DELAY);
@@ -104,7 +195,7 @@ void setupSensors()
 
   if (!bme280_found)
   {
-    SerialLog::getInstance().print("Could not find a valid BME280 sensor, check wiring!");
+    LOG_E(LOG_MODULE_SENSOR, "Could not find a valid BME280 sensor, check wiring!");
     // The device will now rely on the RTC for temperature.
   }
 
@@ -118,7 +209,7 @@ void setupSensors()
 
   if (!rtc_found)
   {
-    SerialLog::getInstance().print("Couldn't find RTC");
+    LOG_E(LOG_MODULE_SENSOR, "Couldn't find RTC");
     // The main loop will now handle the error message.
     return; // Exit early, no point in continuing
   }
@@ -130,6 +221,7 @@ void setupSensors()
   core_temp_started = true;
 
   // Perform an initial sensor read to populate cached values.
+  SensorHistory::getInstance().begin();
   handleSensorUpdates(true);
 }
 
@@ -152,32 +244,50 @@ bool isBmeFound()
 }
 
 /**
- * @brief Gets the primary temperature reading.
+ * @brief Gets the temperature the display shows.
  *
- * Returns the BME280 temperature if available, otherwise falls back to the
- * RTC temperature. The value is converted to the user's preferred unit (C/F).
+ * This is the BME280 temperature if available, otherwise the RTC
+ * temperature, held until it moves by more than SENSOR_TEMP_HYSTERESIS_C.
+ * The value is converted to the user's preferred unit (C/F).
  *
- * @return The current temperature.
+ * @return The displayed temperature.
  */
 float getTemperature()
 {
-  if (bme280_found)
+  float celsius = getSensorReadings().displayTemperatureC;
+  bool useCelsius = ConfigManager::getInstance().snapshot()->useCelsius;
+  if (useCelsius)
   {
-    return getBmeTemperature();
+    return celsius;
   }
   else
   {
-    return getRtcTemperature();
+    return (celsius * 9.0 / 5.0) + 32.0;
   }
 }
 
 /**
- * @brief Gets the last cached humidity reading.
+ * @brief Gets the humidity the display shows.
+ *
+ * The smoothed humidity, held until it moves by more than
+ * SENSOR_HUMIDITY_HYSTERESIS.
  * @return The relative humidity, or -1 if the BME280 is not available.
  */
 float getHumidity()
 {
-  return cached_humidity;
+  return getSensorReadings().displayHumidity;
+}
+
+/**
+ * @brief Copies the latest sensor readings.
+ * @return The readings, in Celsius, with the time they were taken.
+ */
+SensorReadings getSensorReadings()
+{
+  portENTER_CRITICAL(&readings_mux);
+  SensorReadings readings = cached_readings;
+  portEXIT_CRITICAL(&readings_mux);
+  return readings;
 }
 
 /**
@@ -186,14 +296,15 @@ float getHumidity()
  */
 float getBmeTemperature()
 {
-  bool useCelsius = ConfigManager::getInstance().isCelsius();
+  float celsius = getSensorReadings().bmeTemperatureC;
+  bool useCelsius = ConfigManager::getInstance().snapshot()->useCelsius;
   if (useCelsius)
   {
-    return cached_bme_temp_c;
+    return celsius;
   }
   else
   {
-    return (cached_bme_temp_c * 9.0 / 5.0) + 32.0;
+    return (celsius * 9.0 / 5.0) + 32.0;
   }
 }
 
@@ -203,14 +314,15 @@ float getBmeTemperature()
  */
 float getRtcTemperature()
 {
-  bool useCelsius = ConfigManager::getInstance().isCelsius();
+  float celsius = getSensorReadings().rtcTemperatureC;
+  bool useCelsius = ConfigManager::getInstance().snapshot()->useCelsius;
   if (useCelsius)
   {
-    return cached_rtc_temp_c;
+    return celsius;
   }
   else
   {
-    return (cached_rtc_temp_c * 9.0 / 5.0) + 32.0;
+    return (celsius * 9.0 / 5.0) + 32.0;
   }
 }
 
@@ -220,23 +332,25 @@ float getRtcTemperature()
  */
 float getCoreTemperature()
 {
-  bool useCelsius = ConfigManager::getInstance().isCelsius();
+  float celsius = getSensorReadings().coreTemperatureC;
+  bool useCelsius = ConfigManager::getInstance().snapshot()->useCelsius;
   if (useCelsius)
   {
-    return cached_core_temp_c;
+    return celsius;
   }
   else
   {
-    return (cached_core_temp_c * 9.0 / 5.0) + 32.0;
+    return (celsius * 9.0 / 5.0) + 32.0;
   }
 }
 
 /**
  * @brief Periodically reads sensor data and updates the cache.
  *
- * This function is designed to be called in the main loop. It uses a timer
- * to read from the sensors at a defined interval, preventing excessive I2C
- * traffic.
+ * Called by the I2C bus task, which owns the sensors once it has started.
+ * All the reads are made in one hold of the bus, and the new readings are
+ * published together, so a reader never sees a temperature from one batch
+ * and a humidity from another.
  *
  * @param force If true, forces an immediate sensor read, ignoring the timer.
  */
@@ -246,63 +360,129 @@ void handleSensorUpdates(bool force)
   if (force || (now - prevSensorMillis >= SENSOR_UPDATE_INTERVAL))
   {
     prevSensorMillis = now;
-    if (bme280_found)
+    SensorReadings readings = getSensorReadings();
+    bool bmeRead = false; // The BME280 gave readings this time, not just came back
     {
-      float raw_bme_temp_c = BME.readTemperature();
-      float raw_humidity = BME.readHumidity();
-
-      // Check for sensor failure
-      if (isnan(raw_bme_temp_c) || isnan(raw_humidity))
-      {
-        SerialLog::getInstance().print("BME280 read failed (NAN). Attempting to recover...");
-        bme280_found = false;
-        cached_humidity = -1;
-      }
-      else
+      I2cBus::Lock lock;
+      if (bme280_found)
       {
-        if (rtc_found && ConfigManager::getInstance().isTempCorrectionEnabled())
+        // In forced mode each read needs a conversion triggered and waited out first.
+        bool measured = BME.takeForcedMeasurement();
+        float raw_bme_temp_c = measured ? BME.readTemperature() : NAN;
+        float raw_humidity = measured ? BME.readHumidity() : NAN;
+
+        // Check for sensor failure
+        if (isnan(raw_bme_temp_c) || isnan(raw_humidity))
         {
-          float raw_rtc_temp_c = RTC.getTemperature();
-          float correction = ConfigManager::getInstance().getTempCorrection();
-          cached_offset_c = -((raw_rtc_temp_c - raw_bme_temp_c)) + correction;
-          cached_bme_temp_c = raw_bme_temp_c + cached_offset_c;
-          cached_humidity = calculateCorrectedHumidity(raw_bme_temp_c, raw_humidity, cached_offset_c);
+          LOG_W(LOG_MODULE_SENSOR, "BME280 read failed (NAN). Attempting to recover...");
+          bme280_found = false;
+          readings.humidity = -1;
         }
         else
         {
-          // Correction is disabled or RTC is not found, use raw values
-          cached_bme_temp_c = raw_bme_temp_c;
-          cached_humidity = raw_humidity;
-          cached_offset_c = 0.0;
+          ConfigSnapshotRef config = ConfigManager::getInstance().snapshot();
+          bool corrected = rtc_found && config->tempCorrectionEnabled;
+          if (corrected != filterCorrected || (corrected && config->tempCorrection != filterCorrection))
+          {
+            // A new correction would otherwise take the filters a while to settle on.
+            resetFilters();
+            filterCorrected = corrected;
+            filterCorrection = config->tempCorrection;
+          }
+
+          float temp_c;
+          float humidity;
+          if (corrected)
+          {
+            float raw_rtc_temp_c = RTC.getTemperature();
+            float correction = config->tempCorrection;
+            cached_offset_c = -((raw_rtc_temp_c - raw_bme_temp_c)) + correction;
+            temp_c = raw_bme_temp_c + cached_offset_c;
+            humidity = calculateCorrectedHumidity(raw_bme_temp_c, raw_humidity, cached_offset_c);
+          }
+          else
+          {
+            // Correction is disabled or RTC is not found, use raw values
+            temp_c = raw_bme_temp_c;
+            humidity = raw_humidity;
+            cached_offset_c = 0.0;
+          }
+          readings.bmeTemperatureC = tempFilter.update(temp_c);
+          readings.humidity = humidityFilter.update(humidity);
+          bmeRead = true;
         }
       }
-    }
 
-    if (!bme280_found)
-    {
-      cached_humidity = -1; // Indicate that humidity is not available
-      if (now - lastBmeRetry >= BME_RETRY_INTERVAL)
+      if (!bme280_found)
       {
-        lastBmeRetry = now;
-        SerialLog::getInstance().print("Attempting to reconnect BME280...");
-        if (BME.begin(BME280_I2C_ADDRESS))
+        readings.humidity = -1; // Indicate that humidity is not available
+        resetFilters();
+        if (now - lastBmeRetry >= BME_RETRY_INTERVAL)
         {
-          SerialLog::getInstance().print("BME280 recovered!");
-          bme280_found = true;
+          lastBmeRetry = now;
+          LOG_W(LOG_MODULE_SENSOR, "Attempting to reconnect BME280...");
+          if (beginBme())
+          {
+            LOG_I(LOG_MODULE_SENSOR, "BME280 recovered!");
+            bme280_found = true;
+          }
         }
       }
+
+      if (rtc_found)
+      {
+        readings.rtcTemperatureC = RTC.getTemperature();
+      }
+
+      // Only read the core temp sensor if it was successfully started.
+      // If RTC init failed, setupSensors() returned early before temp_sensor_start().
+      if (core_temp_started)
+      {
+        temp_sensor_read_celsius(&readings.coreTemperatureC);
+      }
     }
 
-    if (rtc_found)
+    // The display only follows moves larger than the hysteresis, so noise
+    // around a rounding edge doesn't redraw it every read.
+    bool primed = readings.sampledAtMs != 0;
+    readings.bmeFound = bme280_found;
+    readings.rtcFound = rtc_found;
+    float temp_c = bmeRead ? readings.bmeTemperatureC : (rtc_found ? readings.rtcTemperatureC : NAN);
+    if (!isnan(temp_c))
     {
-      cached_rtc_temp_c = RTC.getTemperature();
+      readings.displayTemperatureC = holdWithin(primed, readings.displayTemperatureC, temp_c, SENSOR_TEMP_HYSTERESIS_C);
     }
-    
-    // Only read the core temp sensor if it was successfully started.
-    // If RTC init failed, setupSensors() returned early before temp_sensor_start().
-    if (core_temp_started)
+    if (bmeRead)
     {
-      temp_sensor_read_celsius(&cached_core_temp_c);
+      readings.displayHumidity = holdWithin(primed && readings.displayHumidity >= 0, readings.displayHumidity,
+                                            readings.humidity, SENSOR_HUMIDITY_HYSTERESIS);
+    }
+    else
+    {
+      readings.displayHumidity = -1;
+    }
+    readings.sampledAtMs = millis();
+    portENTER_CRITICAL(&readings_mux);
+    cached_readings = readings;
+    portEXIT_CRITICAL(&readings_mux);
+
+    SensorHistory::getInstance().record(temp_c, bmeRead ? readings.humidity : NAN);
+
+    int32_t published[4] = {lroundf(readings.bmeTemperatureC * 10), lroundf(readings.humidity * 10),
+                            lroundf(readings.rtcTemperatureC * 10), (bme280_found ? 1 : 0) | (rtc_found ? 2 : 0)};
+    if (memcmp(published, lastPublished, sizeof(published)) != 0)
+    {
+      memcpy(lastPublished, published, sizeof(published));
+      sensorGeneration++;
     }
   }
+}
+
+/**
+ * @brief Gets the sensor generation number.
+ * @return The current sensor generation.
+ */
+uint32_t getSensorGeneration()
+{
+  return sensorGeneration;
 }
\ No newline at end of file
@@ -8,39 +8,51 @@
  * a centralized way to handle log messages.
  */
 #include "SerialLog.h"
+#include "LogStore.h"
+#include "CrashJournal.h"
 #include "UpdateManager.h"
 #include "LockGuard.h"
-#include <esp_attr.h>
+#include <esp32-hal-psram.h>
 #include <time.h>
-
-// RTC Memory for Crash Logging
-#define CRASH_LOG_MAGIC 0xDEADBEEF
-#define CRASH_LOG_SIZE 1024
-
-struct RtcCrashLog
-{
-  uint32_t magic;
-  size_t head;
-  bool wrapped;
-  char buffer[CRASH_LOG_SIZE];
-};
-
-RTC_NOINIT_ATTR RtcCrashLog g_crashLog;
+#include <algorithm>
 
 // Initialize static members
-const char *SerialLog::LOG_FILE_PATH = "/system.log";
-const size_t SerialLog::MAX_LOG_SIZE = 256 * 1024;    // 256KB
-const size_t SerialLog::BUFFER_THRESHOLD = 256;       // 256 Bytes
-const unsigned long SerialLog::FLUSH_INTERVAL = 2000; // 2 Seconds
+const unsigned long SerialLog::FLUSH_INTERVAL = LOG_STORE_SYNC_INTERVAL;
 
 /**
  * @brief Constructs a new SerialLog instance.
  * Initializes the WebSocket on the "/ws" endpoint.
  */
-SerialLog::SerialLog() : _ws("/ws/log"), _lastFlushTime(0)
+SerialLog::SerialLog() : _ws("/ws/log")
 {
   _mutex = xSemaphoreCreateRecursiveMutex();
-  _logBuffer.reserve(BUFFER_THRESHOLD + 64); // Pre-allocate to reduce fragmentation
+  _line.reserve(LOG_SLOT_TEXT_SIZE * 2);
+  _wsBatch.reserve(LOG_WS_BATCH_SIZE + 256);
+  _history = (char *)ps_malloc(LOG_WS_HISTORY_SIZE);
+  for (int i = 0; i < LOG_MODULE_COUNT; i++)
+  {
+    _moduleLevels[i] = DEFAULT_LOG_LEVEL;
+  }
+
+  _slots = (LogSlot *)ps_malloc(LOG_QUEUE_SLOTS * sizeof(LogSlot));
+  if (_slots == nullptr)
+  {
+    _slots = (LogSlot *)malloc(LOG_QUEUE_SLOTS * sizeof(LogSlot));
+  }
+  for (uint32_t i = 0; i < LOG_QUEUE_SLOTS; i++)
+  {
+    _sequence[i].store(i, std::memory_order_relaxed);
+  }
+
+  // Started last: the task may run before the constructor returns.
+  xTaskCreatePinnedToCore(
+      drainTask,
+      "LogDrain",
+      LOG_DRAIN_TASK_STACK_SIZE,
+      this,
+      LOG_DRAIN_TASK_PRIORITY,
+      &_drainTaskHandle,
+      LOG_DRAIN_TASK_CORE);
 }
 
 /**
@@ -64,17 +76,330 @@ void SerialLog::begin(AsyncWebServer *server)
 }
 
 /**
- * @brief Handles periodic tasks, such as flushing the log buffer.
+ * @brief The drain task loop.
+ *
+ * Sleeps until a line is queued, or for at most FLUSH_INTERVAL so buffered
+ * file output is still written when nothing else is logged. While a
+ * WebSocket batch is pending it wakes after LOG_WS_BATCH_INTERVAL instead.
+ *
+ * @param param The SerialLog instance.
+ */
+void SerialLog::drainTask(void *param)
+{
+  SerialLog *self = static_cast<SerialLog *>(param);
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(self->_wsBatch.length() > 0 ? LOG_WS_BATCH_INTERVAL : FLUSH_INTERVAL));
+    self->drain();
+  }
+}
+
+/**
+ * @brief Writes every queued line out and flushes the file when due.
+ *
+ * Only the drain task calls this, so it is the single consumer of the queue.
+ */
+void SerialLog::drain()
+{
+  RecursiveLockGuard lock(_mutex);
+  for (;;)
+  {
+    uint32_t pos = _dequeuePos;
+    std::atomic<uint32_t> &sequence = _sequence[pos & QUEUE_MASK];
+    if (sequence.load(std::memory_order_acquire) != pos + 1)
+    {
+      break; // Empty, or the next slot is still being written.
+    }
+    const LogSlot &slot = _slots[pos & QUEUE_MASK];
+    if (slot.formatter != nullptr)
+    {
+      char buf[256];
+      int length = slot.formatter(buf, sizeof(buf), slot.text);
+      if (length > 0)
+      {
+        _line.concat(buf, std::min<size_t>(length, sizeof(buf) - 1));
+      }
+    }
+    else
+    {
+      _line.concat(slot.text, slot.length);
+    }
+    bool complete = !slot.continued;
+    LineInfo info = slot.info;
+    sequence.store(pos + LOG_QUEUE_SLOTS, std::memory_order_release);
+    _dequeuePos = pos + 1;
+
+    if (complete)
+    {
+      emit(info, _line);
+      _line = "";
+    }
+  }
+
+  uint32_t dropped = _dropped.load(std::memory_order_relaxed);
+  if (dropped != _droppedReported)
+  {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "Log queue full, %u lines dropped\n", dropped - _droppedReported);
+    emit(currentLineInfo(LOG_LEVEL_WARN), buf);
+    _droppedReported = dropped;
+  }
+
+  bool batchDue = _wsBatch.length() > 0 && millis() - _wsBatchStart >= LOG_WS_BATCH_INTERVAL;
+  if (_wsClientConnected.exchange(false) || batchDue)
+  {
+    sendBatch();
+  }
+
+  LogStore::getInstance().syncIfDue(FLUSH_INTERVAL);
+}
+
+/**
+ * @brief Finds the delivery state of a WebSocket client.
+ * @param id The client's id, or 0 for a free entry.
+ * @return The entry, or nullptr if there is none.
+ */
+SerialLog::WsClientState *SerialLog::findWsClient(uint32_t id)
+{
+  for (WsClientState &state : _wsClients)
+  {
+    if (state.id == id)
+    {
+      return &state;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Sends the pending batch to every WebSocket client that can take it.
+ *
+ * The batch is always the tail of the history, so a new client is replayed
+ * the history up to where the batch starts and then gets the batch like
+ * everyone else. A client with LOG_WS_MAX_CLIENT_QUEUE frames still queued
+ * skips the batch; once it catches up it is told how much it missed and
+ * carries on from the newest output.
+ */
+void SerialLog::sendBatch()
+{
+  _ws.cleanupClients();
+  for (WsClientState &state : _wsClients)
+  {
+    if (state.id != 0 && _ws.client(state.id) == nullptr)
+    {
+      state = {};
+    }
+  }
+
+  uint32_t batchStart = _historyTotal - _wsBatch.length();
+  for (AsyncWebSocketClient &client : _ws.getClients())
+  {
+    if (client.status() != WS_CONNECTED)
+    {
+      continue;
+    }
+
+    WsClientState *state = findWsClient(client.id());
+    if (state == nullptr)
+    {
+      state = findWsClient(0);
+      if (state == nullptr)
+      {
+        continue;
+      }
+      state->id = client.id();
+      state->skippedBytes = 0;
+      replayHistory(client, batchStart);
+    }
+
+    if (_wsBatch.length() == 0)
+    {
+      continue;
+    }
+    if (client.queueLen() >= LOG_WS_MAX_CLIENT_QUEUE)
+    {
+      state->skippedBytes += _wsBatch.length();
+      continue;
+    }
+    if (state->skippedBytes > 0)
+    {
+      char note[64];
+      snprintf(note, sizeof(note), "[... %u bytes of log skipped ...]\n", (unsigned)state->skippedBytes);
+      client.text(note);
+      state->skippedBytes = 0;
+    }
+    client.text(_wsBatch.c_str(), _wsBatch.length());
+  }
+  _wsBatch = "";
+}
+
+/**
+ * @brief Sends a client the history up to a position.
+ *
+ * Once the ring has wrapped its oldest line is partly overwritten, so the
+ * replay starts after the first newline.
+ *
+ * @param client The client.
+ * @param end The `_historyTotal` position to stop at.
+ */
+void SerialLog::replayHistory(AsyncWebSocketClient &client, uint32_t end)
+{
+  if (_history == nullptr)
+  {
+    return;
+  }
+
+  uint32_t start = 0;
+  if (end > LOG_WS_HISTORY_SIZE)
+  {
+    start = end - LOG_WS_HISTORY_SIZE;
+    while (start < end && _history[start % LOG_WS_HISTORY_SIZE] != '\n')
+    {
+      start++;
+    }
+    start++;
+  }
+
+  while (start < end)
+  {
+    uint32_t offset = start % LOG_WS_HISTORY_SIZE;
+    size_t length = std::min<size_t>({end - start, LOG_WS_HISTORY_SIZE - offset, LOG_WS_REPLAY_CHUNK});
+    client.text(_history + offset, length);
+    start += length;
+  }
+}
+
+/**
+ * @brief Claims consecutive queue slots for one line.
+ *
+ * The consumer frees slots in order, so the last slot being free means they
+ * all are, and a single CAS on the enqueue position claims the whole run.
+ *
+ * @param count The number of slots.
+ * @param pos Receives the position of the first slot.
+ * @return False if the slots are not free; the line is counted as dropped.
  */
-void SerialLog::loop()
+bool SerialLog::claim(size_t count, uint32_t &pos)
 {
-  if (xSemaphoreTakeRecursive(_mutex, 0) == pdTRUE)
-  { // Non-blocking check
-    if (_logBuffer.length() > 0 && (millis() - _lastFlushTime >= FLUSH_INTERVAL))
+  if (_slots == nullptr)
+  {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  pos = _enqueuePos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    uint32_t last = pos + count - 1;
+    int32_t diff = (int32_t)(_sequence[last & QUEUE_MASK].load(std::memory_order_acquire) - last);
+    if (diff == 0)
     {
-      flush();
+      if (_enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+      {
+        return true;
+      }
     }
-    xSemaphoreGiveRecursive(_mutex);
+    else if (diff < 0)
+    {
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else
+    {
+      pos = _enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+/**
+ * @brief Describes a line being logged by the calling task.
+ * @param level The line's level.
+ * @return The line's info.
+ */
+SerialLog::LineInfo SerialLog::currentLineInfo(LogLevel level)
+{
+  LineInfo info;
+  info.uptimeMs = millis();
+  info.level = level;
+  info.core = xPortGetCoreID();
+  strncpy(info.task, pcTaskGetName(nullptr), sizeof(info.task));
+  return info;
+}
+
+/**
+ * @brief Queues a deferred message and wakes the drain task.
+ * @param level The message's level.
+ * @param formatter Formats the message on the drain task.
+ * @param packed The format pointer followed by the raw arguments.
+ * @param length The size of `packed` in bytes.
+ */
+void SerialLog::enqueueDeferred(LogLevel level, Formatter formatter, const char *packed, size_t length)
+{
+  uint32_t pos;
+  if (!claim(1, pos))
+  {
+    return;
+  }
+
+  LogSlot &slot = _slots[pos & QUEUE_MASK];
+  slot.info = currentLineInfo(level);
+  slot.formatter = formatter;
+  slot.length = length;
+  slot.continued = false;
+  memcpy(slot.text, packed, length);
+  _sequence[pos & QUEUE_MASK].store(pos + 1, std::memory_order_release);
+
+  if (_drainTaskHandle != nullptr)
+  {
+    xTaskNotifyGive(_drainTaskHandle);
+  }
+}
+
+/**
+ * @brief Copies a line into the queue and wakes the drain task.
+ *
+ * A line longer than one slot takes several consecutive slots, claimed
+ * together so lines from other tasks cannot interleave with it. If the slots
+ * are not free the line is dropped; the caller never waits.
+ *
+ * @param level The line's level.
+ * @param text The line.
+ * @param length The length of the line in bytes.
+ */
+void SerialLog::enqueue(LogLevel level, const char *text, size_t length)
+{
+  size_t count = std::max<size_t>(1, (length + LOG_SLOT_TEXT_SIZE - 1) / LOG_SLOT_TEXT_SIZE);
+  if (count > MAX_SLOTS_PER_LINE)
+  {
+    count = MAX_SLOTS_PER_LINE;
+    length = count * LOG_SLOT_TEXT_SIZE;
+  }
+
+  uint32_t pos;
+  if (!claim(count, pos))
+  {
+    return;
+  }
+
+  LineInfo info = currentLineInfo(level);
+  for (size_t i = 0; i < count; i++)
+  {
+    LogSlot &slot = _slots[(pos + i) & QUEUE_MASK];
+    size_t offset = i * LOG_SLOT_TEXT_SIZE;
+    slot.info = info;
+    slot.formatter = nullptr;
+    slot.length = std::min<size_t>(length - offset, LOG_SLOT_TEXT_SIZE);
+    slot.continued = i + 1 < count;
+    memcpy(slot.text, text + offset, slot.length);
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    _sequence[(pos + i) & QUEUE_MASK].store(pos + i + 1, std::memory_order_release);
+  }
+
+  if (_drainTaskHandle != nullptr)
+  {
+    xTaskNotifyGive(_drainTaskHandle);
   }
 }
 
@@ -91,8 +416,14 @@ void SerialLog::onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, Aw
 {
   if (type == WS_EVT_CONNECT)
   {
-    // client connected
+    // client connected; the drain task replays the history to it
     Serial.printf("ws[%s][%u] connect\n", server->url(), client->id());
+    SerialLog &log = getInstance();
+    log._wsClientConnected = true;
+    if (log._drainTaskHandle != nullptr)
+    {
+      xTaskNotifyGive(log._drainTaskHandle);
+    }
   }
   else if (type == WS_EVT_DISCONNECT)
   {
@@ -117,7 +448,6 @@ void SerialLog::onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, Aw
  */
 void SerialLog::setConsoleLoggingEnabled(bool enabled)
 {
-  RecursiveLockGuard lock(_mutex);
   _consoleLoggingEnabled = enabled;
 }
 
@@ -127,7 +457,6 @@ void SerialLog::setConsoleLoggingEnabled(bool enabled)
  */
 void SerialLog::setFileLoggingEnabled(bool enabled)
 {
-  RecursiveLockGuard lock(_mutex);
   _fileLoggingEnabled = enabled;
 }
 
@@ -138,20 +467,21 @@ void SerialLog::setFileLoggingEnabled(bool enabled)
  */
 void SerialLog::setLoggingEnabled(bool enabled)
 {
-  RecursiveLockGuard lock(_mutex);
   _consoleLoggingEnabled = enabled;
   _fileLoggingEnabled = enabled;
 }
 
-/**
- * @brief Prints a message to the Serial port and sends it to all WebSocket clients.
- * @param message The message to be logged.
- */
-// Returns a timestamp prefix string, e.g. "[2026-03-03 21:02:54] " or "[+12345ms] ".
+// Returns the wall time of a queued line, worked back from how long ago it was logged.
 // Uses POSIX time() so it reflects NTP/RTC-synced time automatically.
-static String getTimestamp()
+static time_t getWallClock(uint32_t uptimeMs)
+{
+  return time(nullptr) - (millis() - uptimeMs) / 1000;
+}
+
+// Returns a timestamp prefix string, e.g. "[2026-03-03 21:02:54] " or "[+12345ms] ".
+static String getTimestamp(uint32_t uptimeMs)
 {
-  time_t now = time(nullptr);
+  time_t now = getWallClock(uptimeMs);
   struct tm t;
   localtime_r(&now, &t);
 
@@ -159,7 +489,7 @@ static String getTimestamp()
   // If year is before 2021 the clock hasn't been synced yet — show uptime.
   if (t.tm_year + 1900 < 2021)
   {
-    snprintf(buf, sizeof(buf), "[+%lums] ", (unsigned long)millis());
+    snprintf(buf, sizeof(buf), "[+%lums] ", (unsigned long)uptimeMs);
   }
   else
   {
@@ -170,24 +500,46 @@ static String getTimestamp()
   return String(buf);
 }
 
-void SerialLog::print(const String &message)
+/**
+ * @brief Writes one line to the Serial port, the WebSocket batch and history, the crash journal and the log file.
+ *
+ * Runs on the drain task with the mutex held.
+ * @param info When, where and at what level the line was logged.
+ * @param message The line's text.
+ */
+void SerialLog::emit(const LineInfo &info, const String &message)
 {
-  RecursiveLockGuard lock(_mutex);
+  CrashJournal::getInstance().append(getWallClock(info.uptimeMs), info.uptimeMs, info.task, info.core, info.level,
+                                     message.c_str(), message.length());
 
-  String ts = getTimestamp();
-  String prefixed = ts + message;
+  String prefixed = getTimestamp(info.uptimeMs) + message;
+  if (!prefixed.endsWith("\n"))
+  {
+    prefixed += '\n';
+  }
 
   if (_consoleLoggingEnabled)
   {
-    if (prefixed.endsWith("\n"))
+    Serial.print(prefixed);
+
+    if (_history != nullptr)
     {
-      Serial.print(prefixed);
-      _ws.textAll(prefixed);
+      // Lines are far shorter than the ring, so two copies always cover the wrap.
+      size_t offset = _historyTotal % LOG_WS_HISTORY_SIZE;
+      size_t first = std::min<size_t>(prefixed.length(), LOG_WS_HISTORY_SIZE - offset);
+      memcpy(_history + offset, prefixed.c_str(), first);
+      memcpy(_history, prefixed.c_str() + first, prefixed.length() - first);
     }
-    else
+    _historyTotal += prefixed.length();
+
+    if (_wsBatch.length() == 0)
+    {
+      _wsBatchStart = millis();
+    }
+    _wsBatch += prefixed;
+    if (_wsBatch.length() >= LOG_WS_BATCH_SIZE)
     {
-      Serial.println(prefixed);
-      _ws.textAll(prefixed + "\n");
+      sendBatch();
     }
   }
   if (_fileLoggingEnabled)
@@ -197,248 +549,105 @@ void SerialLog::print(const String &message)
 }
 
 /**
- * @brief Prints a formatted message to the Serial port and sends it to all WebSocket clients.
- * @param format The format string (a la printf).
- * @param ... The arguments for the format string.
+ * @brief Queues a message for the Serial port, WebSocket clients and log file.
+ * @param message The message to be logged.
  */
-void SerialLog::printf(const char *format, ...)
+void SerialLog::print(const String &message)
 {
-  RecursiveLockGuard lock(_mutex);
-
-  // Avoid doing vsnprintf if neither log target is enabled
   if (!_consoleLoggingEnabled && !_fileLoggingEnabled)
     return;
 
-  char buf[256];
+  enqueue(LOG_LEVEL_INFO, message.c_str(), message.length());
+}
+
+/**
+ * @brief Formats a message and queues it for the Serial port, WebSocket clients and log file.
+ * @param format The format string (a la printf).
+ * @param ... The arguments for the format string.
+ */
+void SerialLog::printf(const char *format, ...)
+{
   va_list args;
   va_start(args, format);
-  vsnprintf(buf, sizeof(buf), format, args);
+  vlog(LOG_LEVEL_INFO, format, args);
   va_end(args);
-
-  String ts = getTimestamp();
-  String prefixed = ts + buf;
-
-  if (_consoleLoggingEnabled)
-  {
-    if (prefixed.endsWith("\n"))
-    {
-      Serial.print(prefixed);
-      _ws.textAll(prefixed);
-    }
-    else
-    {
-      Serial.println(prefixed);
-      _ws.textAll(prefixed + "\n");
-    }
-  }
-  if (_fileLoggingEnabled)
-  {
-    logToFile(prefixed.c_str());
-  }
 }
 
 /**
- * @brief Writes a message to the log buffer.
- * @param message The message to write.
+ * @brief Formats a message at a level and queues it.
+ * @param level The message's level.
+ * @param format The format string (a la printf).
+ * @param ... The arguments for the format string.
  */
-void SerialLog::logToFile(const char *message)
+void SerialLog::log(LogLevel level, const char *format, ...)
 {
-  if (UpdateManager::getInstance().isUpdateInProgress())
-    return;
-
-  // Append to RTC Crash Log
-  // We do this here to capture the formatted message.
-  if (g_crashLog.magic == CRASH_LOG_MAGIC)
-  {
-    size_t len = strlen(message);
-    for (size_t i = 0; i < len; i++)
-    {
-      g_crashLog.buffer[g_crashLog.head] = message[i];
-      g_crashLog.head = (g_crashLog.head + 1) % CRASH_LOG_SIZE;
-      if (g_crashLog.head == 0)
-        g_crashLog.wrapped = true;
-    }
-    // Ensure newline in RTC log too
-    if (len == 0 || message[len - 1] != '\n')
-    {
-      g_crashLog.buffer[g_crashLog.head] = '\n';
-      g_crashLog.head = (g_crashLog.head + 1) % CRASH_LOG_SIZE;
-      if (g_crashLog.head == 0)
-        g_crashLog.wrapped = true;
-    }
-  }
-
-  // Mutex is already held by print/printf/loop
-  _logBuffer += message;
-  size_t len = strlen(message);
-  if (len == 0 || message[len - 1] != '\n')
-  {
-    _logBuffer += '\n';
-  }
-
-  if (_logBuffer.length() >= BUFFER_THRESHOLD)
-  {
-    flush();
-  }
+  va_list args;
+  va_start(args, format);
+  vlog(level, format, args);
+  va_end(args);
 }
 
 /**
- * @brief Flushes the log buffer to the file in LittleFS.
- * Assumes the mutex is already held by the caller.
+ * @brief Formats a message and queues it.
+ * @param level The message's level.
+ * @param format The format string.
+ * @param args The arguments for the format string.
  */
-void SerialLog::flush()
+void SerialLog::vlog(LogLevel level, const char *format, va_list args)
 {
-  if (_logBuffer.length() == 0)
+  // Avoid doing vsnprintf if neither log target is enabled
+  if (!_consoleLoggingEnabled && !_fileLoggingEnabled)
     return;
 
-  File logFile = LittleFS.open(LOG_FILE_PATH, "a");
-  if (logFile)
-  {
-    if (logFile.size() >= MAX_LOG_SIZE)
-    {
-      logFile.close();
-      rotateLogFile(); // This assumes rotating doesn't need the mutex or is fast
-      logFile = LittleFS.open(LOG_FILE_PATH, "a");
-    }
-
-    if (logFile)
-    {
-      logFile.print(_logBuffer);
-      logFile.close();
-      _logBuffer = "";
-      _lastFlushTime = millis();
-    }
-  }
-  else
+  char buf[256];
+  int length = vsnprintf(buf, sizeof(buf), format, args);
+  if (length > 0)
   {
-    // If file open fails, clear the buffer early to prevent OOM.
-    // 1024 bytes is enough to hold recent context without risking heap exhaustion.
-    if (_logBuffer.length() > 1024)
-    {
-      _logBuffer = "";
-    }
+    enqueue(level, buf, std::min<size_t>(length, sizeof(buf) - 1));
   }
 }
 
 /**
- * @brief Manually rotates the log file.
- * Thread-safe.
+ * @brief Writes a message to the persistent LogStore.
+ * @param message The message to write.
  */
-void SerialLog::rotate()
+void SerialLog::logToFile(const char *message)
 {
-  RecursiveLockGuard lock(_mutex);
-  rotateLogFile();
+  if (UpdateManager::getInstance().isUpdateInProgress())
+    return;
+
+  LogStore::getInstance().append(message, strlen(message));
 }
 
 /**
- * @brief Rotates the log file when it exceeds the maximum size.
+ * @brief Starts a new log segment.
  */
-void SerialLog::rotateLogFile()
+void SerialLog::rotate()
 {
-  // Mutex should be held by caller
-  String oldLogPath = String(LOG_FILE_PATH) + ".old";
-
-  // Remove the old backup if it exists
-  if (LittleFS.exists(oldLogPath))
-  {
-    LittleFS.remove(oldLogPath);
-  }
-
-  // Rename current log to .old
-  if (LittleFS.exists(LOG_FILE_PATH))
-  {
-    LittleFS.rename(LOG_FILE_PATH, oldLogPath);
-  }
-
-  // Immediately create a new empty log file to minimize the window where it doesn't exist
-  File logFile = LittleFS.open(LOG_FILE_PATH, "w");
-  if (logFile)
-  {
-    logFile.close();
-  }
+  LogStore::getInstance().roll();
 }
 
 /**
  * @brief Logs the reason for the last reset.
+ *
+ * After a crash the previous session's journal is logged too; it stays
+ * available from `/api/log/crash` until the next reset.
  */
 void SerialLog::logResetReason()
 {
-  esp_reset_reason_t reason = esp_reset_reason();
-  String reasonStr;
-
-  switch (reason)
-  {
-  case ESP_RST_UNKNOWN:
-    reasonStr = "Unknown Reset";
-    break;
-  case ESP_RST_POWERON:
-    reasonStr = "Power On Reset";
-    break;
-  case ESP_RST_EXT:
-    reasonStr = "External Reset";
-    break;
-  case ESP_RST_SW:
-    reasonStr = "Software Reset";
-    break;
-  case ESP_RST_PANIC:
-    reasonStr = "Exception/Panic Reset";
-    break;
-  case ESP_RST_INT_WDT:
-    reasonStr = "Interrupt Watchdog Reset";
-    break;
-  case ESP_RST_TASK_WDT:
-    reasonStr = "Task Watchdog Reset";
-    break;
-  case ESP_RST_WDT:
-    reasonStr = "Other Watchdog Reset";
-    break;
-  case ESP_RST_DEEPSLEEP:
-    reasonStr = "Deep Sleep Reset";
-    break;
-  case ESP_RST_BROWNOUT:
-    reasonStr = "Brownout Reset";
-    break;
-  case ESP_RST_SDIO:
-    reasonStr = "SDIO Reset";
-    break;
-  default:
-    reasonStr = "Unknown (" + String((int)reason) + ")";
-    break;
-  }
-
-  print("RESET REASON: " + reasonStr + "\n");
-
-  // Check for crash log in RTC memory
-  if (g_crashLog.magic == CRASH_LOG_MAGIC)
-  {
-    print("--- CRASH DUMP FROM PREVIOUS SESSION ---\n");
-
-    String dump = "";
-    dump.reserve(512);
-    size_t start = g_crashLog.wrapped ? g_crashLog.head : 0;
-    size_t count = g_crashLog.wrapped ? CRASH_LOG_SIZE : g_crashLog.head;
-
-    for (size_t i = 0; i < count; i++)
-    {
-      char c = g_crashLog.buffer[(start + i) % CRASH_LOG_SIZE];
-      dump += c;
-      if (dump.length() >= 512)
-      {
-        print(dump);
-        dump = "";
-      }
-    }
-    if (dump.length() > 0)
+  CrashJournal &journal = CrashJournal::getInstance();
+  printf("RESET REASON: %s (%d)\n", CrashJournal::resetReasonName(journal.resetReason()), (int)journal.resetReason());
+
+  if (journal.wasCrash() && journal.previousCount() > 0)
+  {
+    print("--- CRASH JOURNAL FROM PREVIOUS SESSION ---\n");
+    for (size_t i = 0; i < journal.previousCount(); i++)
     {
-      print(dump);
+      const CrashJournal::Record &record = journal.previousRecord(i);
+      printf("  +%lums core%u %.*s %s: %.*s\n", (unsigned long)record.uptimeMs, record.core,
+             LOG_TASK_NAME_SIZE, record.task, LOG_LEVEL_NAMES[std::min<uint8_t>(record.level, LOG_LEVEL_VERBOSE)],
+             record.length, record.message);
     }
-
-    print("\n--- END CRASH DUMP ---\n");
+    print("--- END CRASH JOURNAL ---\n");
   }
-
-  // Initialize RTC Log for the new session
-  g_crashLog.magic = CRASH_LOG_MAGIC;
-  g_crashLog.head = 0;
-  g_crashLog.wrapped = false;
-  memset(g_crashLog.buffer, 0, CRASH_LOG_SIZE);
 }
@@ -0,0 +1,176 @@
+/**
+ * @file Telemetry.cpp
+ * @brief Implements the Telemetry's sampling of tasks and heaps into a fixed ring.
+ */
+
+#include "Telemetry.h"
+#include "LockGuard.h"
+#include "SerialLog.h"
+#include <esp_freertos_hooks.h>
+#include <esp_heap_caps.h>
+#include <cstring>
+
+const char *const Telemetry::TASK_NAMES[TRACKED_TASKS] = {
+    "loopTask",           // Arduino loop(): buttons, alarms, sensors
+    "LogicTask",          // WiFi, config, weather polling, NTP
+    "RenderTask",         // Display frames
+    "WeatherUpdate",      // Weather fetches and geocoding
+    "async_tcp",          // Web server callbacks
+    "github_update_task", // GitHub OTA download, only while updating
+    "ota_writer",         // GitHub OTA flash writer, only while updating
+};
+
+volatile TaskHandle_t Telemetry::s_tickHandles[TRACKED_TASKS] = {};
+volatile uint32_t Telemetry::s_taskTicks[TRACKED_TASKS] = {};
+volatile uint32_t Telemetry::s_coreTicks[portNUM_PROCESSORS] = {};
+
+Telemetry::Telemetry()
+{
+  _mutex = xSemaphoreCreateMutex();
+  memset(_ring, 0, sizeof(_ring));
+  for (int core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    if (esp_register_freertos_tick_hook_for_cpu(onTick, core) != ESP_OK)
+    {
+      LOG_W(LOG_MODULE_SYSTEM, "Telemetry: no tick hook on core %d, CPU shares will be incomplete.\n", core);
+    }
+  }
+}
+
+/**
+ * @brief Counts a tick against the core and, if it is tracked, the task it interrupted.
+ *
+ * Runs in the tick interrupt of each core.
+ */
+void IRAM_ATTR Telemetry::onTick()
+{
+  s_coreTicks[xPortGetCoreID()]++;
+  TaskHandle_t current = xTaskGetCurrentTaskHandle();
+  for (int i = 0; i < TRACKED_TASKS; i++)
+  {
+    if (s_tickHandles[i] == current)
+    {
+      s_taskTicks[i]++;
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Takes a sample if `TELEMETRY_SAMPLE_INTERVAL` has passed since the last one.
+ */
+void Telemetry::loop()
+{
+  if (_count > 0 && millis() - _lastSample < TELEMETRY_SAMPLE_INTERVAL)
+  {
+    return;
+  }
+  _lastSample = millis();
+  sample();
+}
+
+/**
+ * @brief Takes a sample now and stores it in the ring.
+ *
+ * A task's CPU share is its ticks since the previous sample over the ticks
+ * of one core, so the first sample, and the first after a task is
+ * recreated, have none.
+ */
+void Telemetry::sample()
+{
+  Sample sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.uptimeSeconds = millis() / 1000;
+  sampleHeap(MALLOC_CAP_INTERNAL, sample.internal);
+  sampleHeap(MALLOC_CAP_SPIRAM, sample.psram);
+  for (int i = 0; i < TRACKED_TASKS; i++)
+  {
+    sample.tasks[i].cpuPermille = CPU_UNKNOWN;
+  }
+
+  UBaseType_t taskCount = uxTaskGetSystemState(_taskStatus, TELEMETRY_MAX_TASKS, nullptr);
+  if (taskCount == 0)
+  {
+    LOG_W(LOG_MODULE_SYSTEM, "Telemetry: more tasks than TELEMETRY_MAX_TASKS, tasks not sampled.\n");
+  }
+  uint32_t coreTicks = 0;
+  for (int core = 0; core < portNUM_PROCESSORS; core++)
+  {
+    coreTicks += s_coreTicks[core];
+  }
+  uint32_t elapsed = (coreTicks - _lastCoreTicks) / portNUM_PROCESSORS;
+  _lastCoreTicks = coreTicks;
+
+  for (int i = 0; i < TRACKED_TASKS; i++)
+  {
+    const TaskStatus_t *status = nullptr;
+    for (UBaseType_t t = 0; t < taskCount; t++)
+    {
+      if (strcmp(_taskStatus[t].pcTaskName, TASK_NAMES[i]) == 0)
+      {
+        status = &_taskStatus[t];
+        break;
+      }
+    }
+    if (status == nullptr)
+    {
+      s_tickHandles[i] = nullptr;
+      continue;
+    }
+
+    TaskSample &task = sample.tasks[i];
+    task.present = true;
+    // ESP-IDF stacks are counted in bytes, not words.
+    task.stackFreeBytes = status->usStackHighWaterMark;
+    uint32_t ticks = s_taskTicks[i];
+    if (status->xHandle == s_tickHandles[i] && elapsed > 0)
+    {
+      uint64_t permille = (uint64_t)(ticks - _lastTaskTicks[i]) * 1000 / elapsed;
+      task.cpuPermille = (uint16_t)min(permille, (uint64_t)1000);
+    }
+    _lastTaskTicks[i] = ticks;
+    s_tickHandles[i] = status->xHandle;
+  }
+
+  LockGuard lock(_mutex);
+  _ring[_next] = sample;
+  _next = (_next + 1) % TELEMETRY_RING_SIZE;
+  if (_count < TELEMETRY_RING_SIZE)
+  {
+    _count++;
+  }
+}
+
+/**
+ * @brief Gets the number of samples in the ring.
+ */
+int Telemetry::sampleCount()
+{
+  LockGuard lock(_mutex);
+  return _count;
+}
+
+/**
+ * @brief Copies a sample out of the ring.
+ * @param age 0 for the newest sample, 1 for the one before it, and so on.
+ * @param sample Receives the sample.
+ * @return False if the ring holds fewer than `age + 1` samples.
+ */
+bool Telemetry::getSample(int age, Sample &sample)
+{
+  LockGuard lock(_mutex);
+  if (age < 0 || age >= _count)
+  {
+    return false;
+  }
+  sample = _ring[(_next + TELEMETRY_RING_SIZE - 1 - age) % TELEMETRY_RING_SIZE];
+  return true;
+}
+
+/// @brief Fills a heap region's figures.
+void Telemetry::sampleHeap(uint32_t caps, HeapSample &heap)
+{
+  heap.freeBytes = heap_caps_get_free_size(caps);
+  heap.minFreeBytes = heap_caps_get_minimum_free_size(caps);
+  heap.largestFreeBlock = heap_caps_get_largest_free_block(caps);
+}
@@ -7,8 +7,6 @@
  * alarm checking logic.
  */
 
-// #define LOG_TICKS
-
 #include "TimeManager.h"
 #include "NtpSync.h"
 #include "SensorModule.h"
@@ -16,48 +14,20 @@
 #include "AlarmManager.h"
 #include "SerialLog.h"
 #include "LockGuard.h"
+#include "I2cBus.h"
+#include "Constants.h"
 #include <ctime>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 #include <WiFi.h>
 
 #include <vector>
 #include <algorithm>
 
-DateTime calculateNextRingTime(const Alarm &alarm, const DateTime &now)
-{
-  if (!alarm.isEnabled())
-  {
-    return DateTime(); // Return invalid DateTime
-  }
-
-  // If the alarm is snoozed, the next ring time is the snooze end time.
-  if (alarm.isSnoozed())
-  {
-    return DateTime(alarm.getSnoozeUntil());
-  }
-
-  // Check today
-  if (alarm.getHour() > now.hour() || (alarm.getHour() == now.hour() && alarm.getMinute() > now.minute()))
-  {
-    if (alarm.getDays() == 0 || (alarm.getDays() & (1 << now.dayOfTheWeek())))
-    {
-      return DateTime(now.year(), now.month(), now.day(), alarm.getHour(), alarm.getMinute(), 0);
-    }
-  }
-
-  // Check for the next 7 days
-  for (int i = 1; i <= 7; ++i)
-  {
-    uint8_t dayOfWeek = (now.dayOfTheWeek() + i) % 7;
-    if (alarm.getDays() == 0 || (alarm.getDays() & (1 << dayOfWeek)))
-    {
-      DateTime next = now + TimeSpan(i, 0, 0, 0);
-      return DateTime(next.year(), next.month(), next.day(), alarm.getHour(), alarm.getMinute(), 0);
-    }
-  }
-
-  return DateTime(); // No valid ring time found
-}
+static const uint8_t DS3231_I2C_ADDRESS = 0x68;
+static const uint8_t DS3231_AGING_REGISTER = 0x10;
+static const uint8_t DS3231_CONTROL_REGISTER = 0x0E;
+static const uint8_t DS3231_CONTROL_CONV = 0x20; ///< Starts a temperature conversion, and with it an aging update.
 
 TimeManager::TimeManager()
 {
@@ -79,7 +49,7 @@ void TimeManager::begin()
   initNtp();
 
   // Perform an initial NTP sync attempt at startup.
-  SerialLog::getInstance().print("TimeManager: Performing initial NTP sync...\n");
+  LOG_D(LOG_MODULE_TIME, "TimeManager: Performing initial NTP sync...\n");
   syncWithNTP();
 
   // Right after the first sync we also run the DST check in case the
@@ -103,22 +73,88 @@ void TimeManager::begin()
  */
 bool TimeManager::update()
 {
-  // Use a non-blocking delay to run the update logic frequently (50ms)
-  // to catch the second transition accurately.
-  unsigned long currentMillis = millis();
-  if (currentMillis - lastUpdate < UPDATE_INTERVAL)
+  // Skip the clock read until a poll is due; around the predicted second edge
+  // this is every millisecond, otherwise much less often.
+  if (msUntilNextPoll() > 0)
   {
     return false; // No update occurred.
   }
+  unsigned long currentMillis = millis();
+  unsigned long previousPoll = lastUpdate;
+  int64_t previousPollMicros = _lastPollMicros;
   lastUpdate = currentMillis;
+  _lastPollMicros = esp_timer_get_time();
 
-  DateTime now = getRTCTime();
-  // Only trigger a full update if the second has actually changed.
-  if (now.second() == _lastDecodedSecond)
+  bool anchored;
   {
-    return false;
+    RecursiveLockGuard lock(_mutex);
+    anchored = _anchorTime != 0;
+  }
+
+  DateTime now;
+  if (anchored)
+  {
+    // Free running: the second comes from the ESP32 timer, with no bus traffic.
+    RecursiveLockGuard lock(_mutex);
+    now = clockTime();
+    if (now.second() == _lastDecodedSecond)
+    {
+      return false;
+    }
+    _lastDecodedSecond = now.second();
+    _lastEdgeMicros = _anchorMicros + (_lastPollMicros - _anchorMicros) / 1000000 * 1000000;
+
+    // Keep the edge estimate current, so a resync only has to look around it.
+    _secondEdgeMillis = currentMillis - (unsigned long)(((_lastPollMicros - _anchorMicros) % 1000000) / 1000);
+    if (currentMillis - _anchorMillis >= RTC_RESYNC_INTERVAL)
+    {
+      // Read the next edge from the RTC again.
+      _anchorTime = 0;
+      _rtcLostPower = -1;
+    }
+  }
+  else
+  {
+    now = readRTC();
+    int64_t readMicros = esp_timer_get_time(); // After any wait for the bus.
+    // Only trigger a full update if the second has actually changed.
+    if (now.second() == _lastDecodedSecond)
+    {
+      return false;
+    }
+    _lastDecodedSecond = now.second();
+
+    // The edge happened somewhere after the previous poll. Assuming the earliest
+    // possible moment means the next guard window opens before the real edge,
+    // so the estimate converges to 1 ms within a second of acquiring it. If the
+    // previous poll was a whole second ago (the edge arrived before the guard
+    // window opened), just pull the estimate earlier by the guard time.
+    unsigned long gap = currentMillis - previousPoll;
+    _secondEdgeMillis = (gap <= UPDATE_INTERVAL) ? previousPoll + 1 : currentMillis - SECOND_EDGE_GUARD_MS;
+    _lastEdgeMicros = 0;
+
+    // Once the edge is pinned down to a few milliseconds, run from the timer
+    // and take any pending drift measurement. It fell between the start of
+    // the previous read and the end of this one.
+    if (now.isValid() && readMicros - previousPollMicros <= (int64_t)ANCHOR_MAX_GAP_MS * 1000)
+    {
+      int64_t edgeMicros = (previousPollMicros + readMicros) / 2;
+      _lastEdgeMicros = edgeMicros;
+      measureDrift(now, edgeMicros);
+      if (RTC_FREE_RUNNING)
+      {
+        anchorClock(now, edgeMicros);
+      }
+    }
+  }
+
+  if (currentMillis - _rtcMinuteStart >= 60000)
+  {
+    RecursiveLockGuard lock(_mutex);
+    _rtcTransactionsPerMinute = _rtcTransactions - _rtcTransactionsAtMinute;
+    _rtcTransactionsAtMinute = _rtcTransactions;
+    _rtcMinuteStart = currentMillis;
   }
-  _lastDecodedSecond = now.second();
 
   // Cache the time snapshot for consistent rendering within this frame.
   // This prevents race conditions where the RTC may return a different
@@ -128,9 +164,7 @@ bool TimeManager::update()
     _cachedTime = now;
   }
 
-#ifdef LOG_TICKS
-  SerialLog::getInstance().print("TimeManager: Tick\n");
-#endif
+  LOG_DEFERRED(LOG_LEVEL_VERBOSE, LOG_MODULE_TIME, "TimeManager: Tick\n");
   // Perform routine checks, like the daily time sync and DST change.
   if (currentMillis - _lastDstCheck >= DST_CHECK_INTERVAL)
   {
@@ -157,6 +191,88 @@ bool TimeManager::update()
   return true; // An update occurred.
 }
 
+/**
+ * @brief Gets the time until `update()` will next poll the clock.
+ *
+ * While the clock is free running, this is the time until the ESP32 timer's
+ * next second and no RTC read is made at all.
+ *
+ * Otherwise, with no second-edge estimate, the RTC is polled every `UPDATE_INTERVAL`.
+ * With one, polling pauses until `SECOND_EDGE_GUARD_MS` before the predicted
+ * edge and then runs every millisecond. If the edge hasn't shown up within
+ * `SECOND_EDGE_SEARCH_MS` (e.g. after the RTC was set), the estimate is
+ * dropped and re-acquired with regular polling.
+ *
+ * @return The number of milliseconds until the next poll is due.
+ */
+uint32_t TimeManager::msUntilNextPoll() const
+{
+  {
+    RecursiveLockGuard lock(_mutex);
+    if (_anchorTime != 0)
+    {
+      // Free running: wake just after the timer's next second.
+      int64_t sinceAnchor = esp_timer_get_time() - _anchorMicros;
+      if ((_anchorTime + sinceAnchor / 1000000) % 60 != _lastDecodedSecond)
+      {
+        return 0;
+      }
+      return (uint32_t)((1000000 - sinceAnchor % 1000000 + 999) / 1000);
+    }
+  }
+
+  unsigned long currentMillis = millis();
+  unsigned long sincePoll = currentMillis - lastUpdate;
+
+  if (_secondEdgeMillis != 0)
+  {
+    unsigned long sinceEdge = currentMillis - _secondEdgeMillis;
+    if (sinceEdge < 1000 - SECOND_EDGE_GUARD_MS)
+    {
+      return (1000 - SECOND_EDGE_GUARD_MS) - sinceEdge;
+    }
+    if (sinceEdge < 1000 + SECOND_EDGE_SEARCH_MS)
+    {
+      return sincePoll >= 1 ? 0 : 1;
+    }
+    // Edge not found where predicted; fall back to regular polling.
+  }
+
+  return sincePoll >= UPDATE_INTERVAL ? 0 : UPDATE_INTERVAL - sincePoll;
+}
+
+/**
+ * @brief Predicts the next second edge from the free-running clock.
+ *
+ * This is the moment `update()` will report the new second, so a caller can
+ * sleep until just before it and then wait out the rest precisely.
+ * @return esp_timer_get_time() at the next second edge, or 0 if not free running.
+ */
+int64_t TimeManager::nextSecondEdgeMicros() const
+{
+  RecursiveLockGuard lock(_mutex);
+  if (_anchorTime == 0)
+  {
+    return 0;
+  }
+  int64_t seconds = (esp_timer_get_time() - _anchorMicros) / 1000000;
+  if ((_anchorTime + seconds) % 60 == _lastDecodedSecond)
+  {
+    seconds++;
+  }
+  return _anchorMicros + seconds * 1000000;
+}
+
+/**
+ * @brief Gets when the second last picked up by `update()` began.
+ * @return esp_timer_get_time() at that edge, or 0 if it wasn't pinned down.
+ */
+int64_t TimeManager::lastSecondEdgeMicros() const
+{
+  RecursiveLockGuard lock(_mutex);
+  return _lastEdgeMicros;
+}
+
 /**
  * @brief Performs a blocking NTP sync and updates the last sync date.
  */
@@ -171,7 +287,7 @@ void TimeManager::syncWithNTP()
     // Store the date as a single integer (e.g., 20231026) for easy comparison.
     uint32_t ymd = (uint32_t)now.year() * 10000u + (uint32_t)now.month() * 100u + (uint32_t)now.day();
     lastSyncDate = ymd;
-    SerialLog::getInstance().printf("Marked lastSyncDate = %lu\n", (unsigned long)lastSyncDate);
+    LOG_D(LOG_MODULE_TIME, "Marked lastSyncDate = %lu\n", (unsigned long)lastSyncDate);
   }
 }
 
@@ -186,18 +302,18 @@ bool TimeManager::updateNtp()
   NtpSyncState state = updateNtpSync();
   if (state == NTP_SYNC_SUCCESS)
   {
-    SerialLog::getInstance().print("TimeManager: NTP sync successful.\n");
+    LOG_I(LOG_MODULE_TIME, "TimeManager: NTP sync successful.\n");
     DateTime now = getRTCTime();
     RecursiveLockGuard lock(_mutex);
     uint32_t ymd = (uint32_t)now.year() * 10000u + (uint32_t)now.month() * 100u + (uint32_t)now.day();
     lastSyncDate = ymd;
-    SerialLog::getInstance().printf("Marked lastSyncDate = %lu\n", (unsigned long)lastSyncDate);
+    LOG_D(LOG_MODULE_TIME, "Marked lastSyncDate = %lu\n", (unsigned long)lastSyncDate);
     resetNtpSync();
     return true;
   }
   else if (state == NTP_SYNC_FAILED)
   {
-    SerialLog::getInstance().print("TimeManager: NTP sync failed.\n");
+    LOG_W(LOG_MODULE_TIME, "TimeManager: NTP sync failed.\n");
     resetNtpSync();
   }
   return false;
@@ -212,17 +328,27 @@ bool TimeManager::updateNtp()
  */
 void TimeManager::getFormattedTime(char *buf, size_t bufSize) const
 {
-  DateTime now = getRTCTime();
+  formatTime(getRTCTime(), buf, bufSize);
+}
+
+/**
+ * @brief Formats a time as "HH:MM" or "H:MM", following the 12/24-hour preference.
+ * @param time The time to format.
+ * @param buf Output buffer.
+ * @param bufSize Size of the buffer.
+ */
+void TimeManager::formatTime(const DateTime &time, char *buf, size_t bufSize) const
+{
   if (is24HourFormat())
   {
-    snprintf(buf, bufSize, "%02d:%02d", now.hour(), now.minute());
+    snprintf(buf, bufSize, "%02d:%02d", time.hour(), time.minute());
   }
   else
   {
-    int hour12 = now.hour() % 12;
+    int hour12 = time.hour() % 12;
     if (hour12 == 0)
       hour12 = 12;
-    snprintf(buf, bufSize, "%d:%02d", hour12, now.minute());
+    snprintf(buf, bufSize, "%d:%02d", hour12, time.minute());
   }
 }
 
@@ -319,7 +445,7 @@ String TimeManager::getDayOfWeek() const
 bool TimeManager::is24HourFormat() const
 {
   // Delegate the check to the ConfigManager to centralize settings access.
-  return ConfigManager::getInstance().is24HourFormat();
+  return ConfigManager::getInstance().snapshot()->use24HourFormat;
 }
 
 /**
@@ -338,6 +464,8 @@ uint8_t TimeManager::getHour() const
  *
  * This function is designed to run once a day (e.g., at 3 AM) to correct
  * any clock drift. It compares the current date with the last sync date.
+ * A drift measurement counts as that day's sync, so while the SNTP daemon
+ * is reachable the RTC is only stepped when the drift model says so.
  */
 void TimeManager::checkDailySync()
 {
@@ -355,63 +483,176 @@ void TimeManager::checkDailySync()
     // If the last sync was on a different day, and it's 3 AM or later, we should sync.
     if (lastSyncDate < today)
     {
-      SerialLog::getInstance().print("Performing daily time sync...\n");
+      LOG_I(LOG_MODULE_TIME, "Performing daily time sync...\n");
       startNtpSync(); // This starts the non-blocking NTP sync.
     }
   }
 }
 
 /**
- * @brief Periodically checks the RTC's drift against an NTP server.
+ * @brief Compares the RTC with NTP after each SNTP daemon sync and trims its drift.
  *
- * This function runs at a set interval (e.g., every 4 hours) to compare the
- * local RTC time with the accurate time from an NTP server. If the drift
- * exceeds a predefined threshold, it triggers a non-blocking resynchronization.
+ * A daemon sync asks for the next RTC second edge to be measured against
+ * the fresh system clock; see `measureDrift()`. Each measurement is added
+ * to the drift model, and:
+ * - once the fit is trusted and shows at least DRIFT_TRIM_MIN_PPM, the
+ *   DS3231 aging offset is moved to cancel it and the model starts again;
+ * - once the fit shows the RTC holding its rate, the daemon polls less
+ *   often, up to NTP_SYNC_INTERVAL_MAX;
+ * - if the RTC is more than DRIFT_RESYNC_US out, it is stepped back into
+ *   line at the next second edge.
  */
 void TimeManager::checkDriftAndResync()
 {
-  // How often to check for drift (e.g., every 4 hours).
-  const unsigned long DRIFT_CHECK_INTERVAL = 4 * 60 * 60 * 1000;
-  // The maximum acceptable drift in seconds before forcing a resync.
-  const int DRIFT_THRESHOLD_SECONDS = 2;
+  if (takeSntpSyncEvent())
+  {
+    RecursiveLockGuard lock(_mutex);
+    _driftMeasurePending = true;
+    // Find the RTC's edge afresh rather than trusting the timer.
+    _anchorTime = 0;
+  }
 
-  unsigned long currentMillis = millis();
-  if (currentMillis - lastDriftCheck < DRIFT_CHECK_INTERVAL)
+  uint32_t sampleTime;
+  int64_t offsetUs;
   {
-    return; // Not time for a drift check yet.
+    RecursiveLockGuard lock(_mutex);
+    if (!_driftSampleReady)
+    {
+      return;
+    }
+    _driftSampleReady = false;
+    sampleTime = _driftSampleTime;
+    offsetUs = _driftSampleOffsetUs;
   }
-  
-  if (WiFi.status() != WL_CONNECTED) {
-    return; // Can't check drift without WiFi
+
+  if (_agingOffset == AGING_OFFSET_UNKNOWN)
+  {
+    int8_t aging;
+    if (readAgingOffset(aging))
+    {
+      _agingOffset = aging;
+    }
   }
 
-  lastDriftCheck = currentMillis;
+  RecursiveLockGuard lock(_mutex);
+  _lastNtpOffsetUs = offsetUs;
+  _driftModel.add(sampleTime, offsetUs);
+  DateTime now(sampleTime);
+  lastSyncDate = (uint32_t)now.year() * 10000u + (uint32_t)now.month() * 100u + (uint32_t)now.day();
+  LOG_I(LOG_MODULE_TIME, "RTC is %+ld us from NTP (%u samples).\n", (long)offsetUs, (unsigned)_driftModel.count());
+
+  float ppm;
+  if (_driftModel.fit(ppm))
+  {
+    _driftPpm = ppm;
+    _driftFitted = true;
+    if (fabsf(ppm) >= DRIFT_TRIM_MIN_PPM && _agingOffset != AGING_OFFSET_UNKNOWN)
+    {
+      // A positive aging offset slows the oscillator.
+      int target = constrain(_agingOffset + (int)lroundf(ppm / DS3231_AGING_PPM_PER_LSB), -128, 127);
+      if (target != _agingOffset && writeAgingOffset((int8_t)target))
+      {
+        LOG_I(LOG_MODULE_TIME, "RTC runs %+.2f ppm; aging offset %d -> %d.\n", ppm, _agingOffset, target);
+        _agingOffset = target;
+        _driftModel.reset();
+        _ntpSyncInterval = NTP_SYNC_INTERVAL_MIN;
+        setNtpSyncInterval(_ntpSyncInterval);
+      }
+    }
+    else if (_ntpSyncInterval < NTP_SYNC_INTERVAL_MAX)
+    {
+      _ntpSyncInterval = std::min<uint32_t>(_ntpSyncInterval * 2, NTP_SYNC_INTERVAL_MAX);
+      setNtpSyncInterval(_ntpSyncInterval);
+    }
+  }
 
-  SerialLog::getInstance().print("Performing periodic clock drift check...\n");
+  if (llabs(offsetUs) > DRIFT_RESYNC_US)
+  {
+    LOG_W(LOG_MODULE_TIME, "Drift exceeds threshold. Triggering NTP resync...\n");
+    // The sync sets the RTC to NTP, taking the offset out.
+    _driftModel.step(-offsetUs);
+    _driftStepExpected = true;
+    startNtpSync();
+  }
+}
 
-  // Get the current time from the NTP server without adjusting the RTC.
-  // Feed WDT before potentially blocking call
-  esp_task_wdt_reset();
-  DateTime ntpTime = getNtpTime();
-  if (!ntpTime.isValid())
+/**
+ * @brief Compares an RTC second edge with the system clock, if a comparison is pending.
+ *
+ * The system clock is read now and wound back to the edge by the timer, so
+ * the comparison is as precise as the edge.
+ * @param time The time the RTC changed to.
+ * @param edgeMicros esp_timer_get_time() at the edge.
+ */
+void TimeManager::measureDrift(const DateTime &time, int64_t edgeMicros)
+{
+  RecursiveLockGuard lock(_mutex);
+  if (!_driftMeasurePending)
   {
-    SerialLog::getInstance().print("Drift check failed: Could not get NTP time.\n");
     return;
   }
+  _driftMeasurePending = false;
 
-  // Get the current time from the local RTC.
-  DateTime rtcTime = getRTCTime();
-  // Calculate the time difference.
-  TimeSpan drift = rtcTime - ntpTime;
+  int64_t localUs;
+  int64_t readMicros;
+  if (!getNtpTimeMicros(localUs, readMicros))
+  {
+    return;
+  }
+  int64_t ntpAtEdgeUs = localUs - (readMicros - edgeMicros);
+  _driftSampleTime = (uint32_t)(ntpAtEdgeUs / 1000000);
+  _driftSampleOffsetUs = (int64_t)time.unixtime() * 1000000 - ntpAtEdgeUs;
+  _driftSampleReady = true;
+}
 
-  SerialLog::getInstance().printf("RTC vs NTP drift is %ld seconds.\n", drift.totalseconds());
+/**
+ * @brief Reads the DS3231's aging offset register.
+ * @param offset Receives the offset.
+ * @return False if the RTC did not answer.
+ */
+bool TimeManager::readAgingOffset(int8_t &offset)
+{
+  I2cBus::Lock bus;
+  Wire.beginTransmission(DS3231_I2C_ADDRESS);
+  Wire.write(DS3231_AGING_REGISTER);
+  if (Wire.endTransmission() != 0 || Wire.requestFrom(DS3231_I2C_ADDRESS, (uint8_t)1) != 1)
+  {
+    return false;
+  }
+  offset = (int8_t)Wire.read();
+  return true;
+}
+
+/**
+ * @brief Writes the DS3231's aging offset register and starts a temperature conversion.
+ *
+ * The new offset only takes effect at the next conversion, which otherwise
+ * happens within 64 seconds.
+ * @param offset The new offset.
+ * @return False if the RTC did not answer.
+ */
+bool TimeManager::writeAgingOffset(int8_t offset)
+{
+  I2cBus::Lock bus;
+  Wire.beginTransmission(DS3231_I2C_ADDRESS);
+  Wire.write(DS3231_AGING_REGISTER);
+  Wire.write((uint8_t)offset);
+  if (Wire.endTransmission() != 0)
+  {
+    return false;
+  }
 
-  // If the absolute drift exceeds the threshold, start a non-blocking sync.
-  if (abs(drift.totalseconds()) > DRIFT_THRESHOLD_SECONDS)
+  Wire.beginTransmission(DS3231_I2C_ADDRESS);
+  Wire.write(DS3231_CONTROL_REGISTER);
+  if (Wire.endTransmission() == 0 && Wire.requestFrom(DS3231_I2C_ADDRESS, (uint8_t)1) == 1)
   {
-    SerialLog::getInstance().print("Drift exceeds threshold. Triggering NTP resync...\n");
-    startNtpSync();
+    uint8_t control = Wire.read();
+    Wire.beginTransmission(DS3231_I2C_ADDRESS);
+    Wire.write(DS3231_CONTROL_REGISTER);
+    Wire.write(control | DS3231_CONTROL_CONV);
+    Wire.endTransmission();
   }
+  return true;
 }
 
 void TimeManager::checkDST()
@@ -451,18 +692,15 @@ void TimeManager::checkDST()
   // mktime/localtime_r found a discrepancy, we apply the resolved time.
   if (newDstState != currentDstState)
   {
-    SerialLog::getInstance().printf("DST Change Detected: %d -> %d\n", currentDstState, newDstState);
+    LOG_I(LOG_MODULE_TIME, "DST Change Detected: %d -> %d\n", currentDstState, newDstState);
 
     DateTime adjustedTime(resolved.tm_year + 1900, resolved.tm_mon + 1, resolved.tm_mday,
                           resolved.tm_hour, resolved.tm_min, resolved.tm_sec);
 
-    SerialLog::getInstance().printf("DST transition. Adjusting RTC: %02d:%02d -> %02d:%02d\n",
-                                     now.hour(), now.minute(),
-                                     adjustedTime.hour(), adjustedTime.minute());
-    {
-      RecursiveLockGuard lock(_mutex);
-      RTC.adjust(adjustedTime);
-    }
+    LOG_I(LOG_MODULE_TIME, "DST transition. Adjusting RTC: %02d:%02d -> %02d:%02d\n",
+          now.hour(), now.minute(),
+          adjustedTime.hour(), adjustedTime.minute());
+    adjustRTC(adjustedTime);
 
     ConfigManager::getInstance().setDST(newDstState);
   }
@@ -475,6 +713,10 @@ void TimeManager::updateSnoozeStates()
     return;
   }
   auto &config = ConfigManager::getInstance();
+  if (!config.getAlarmSummary().anyEnabledSnoozed)
+  {
+    return; // Nothing to wake; skip copying the table.
+  }
   std::vector<Alarm> alarms = config.getAllAlarms();
 
   for (auto &alarm : alarms)
@@ -494,7 +736,30 @@ void TimeManager::updateSnoozeStates()
   }
 }
 
+/**
+ * @brief Gets the current time.
+ *
+ * While the clock is free running this is worked out from the ESP32 timer;
+ * otherwise the RTC is read.
+ * @return The current local time.
+ */
 DateTime TimeManager::getRTCTime() const
+{
+  {
+    RecursiveLockGuard lock(_mutex);
+    if (_anchorTime != 0)
+    {
+      return clockTime();
+    }
+  }
+  return readRTC();
+}
+
+/**
+ * @brief Reads the time from the RTC over I2C.
+ * @return The RTC's time, or an invalid DateTime if there is no RTC.
+ */
+DateTime TimeManager::readRTC() const
 {
   // Guard against calling RTC.now() before the I2C bus and RTC hardware are
   // initialized. Without this, an early call (e.g. from AlarmManager::update
@@ -504,28 +769,170 @@ DateTime TimeManager::getRTCTime() const
     return DateTime(); // Returns an invalid DateTime (year < 2000)
   }
   RecursiveLockGuard lock(_mutex);
+  I2cBus::Lock bus;
+  _rtcTransactions++;
   return RTC.now();
 }
 
+/**
+ * @brief Works out the time from the anchor and the ESP32 timer.
+ * @note The caller holds the mutex and has checked that the clock is anchored.
+ * @return The current local time.
+ */
+DateTime TimeManager::clockTime() const
+{
+  return DateTime(_anchorTime + (uint32_t)((esp_timer_get_time() - _anchorMicros) / 1000000));
+}
+
+/**
+ * @brief Starts the free-running clock from an RTC second edge.
+ *
+ * When the clock was anchored before, the difference between where the old
+ * anchor put this edge and where it was seen is the timer's drift against
+ * the RTC since then.
+ * @param time The time the RTC changed to.
+ * @param edgeMicros esp_timer_get_time() at the edge.
+ */
+void TimeManager::anchorClock(const DateTime &time, int64_t edgeMicros)
+{
+  RecursiveLockGuard lock(_mutex);
+  if (_lastAnchorTime != 0)
+  {
+    int64_t predicted = _lastAnchorMicros + (int64_t)(time.unixtime() - _lastAnchorTime) * 1000000;
+    _lastResyncOffsetUs = (int32_t)(edgeMicros - predicted);
+    _resyncs++;
+    LOG_DEFERRED(LOG_LEVEL_DEBUG, LOG_MODULE_TIME, "TimeManager: Re-anchored to RTC, timer was off by %ld us\n",
+                 (long)_lastResyncOffsetUs);
+  }
+  _anchorTime = time.unixtime();
+  _anchorMicros = edgeMicros;
+  _anchorMillis = millis();
+  _lastAnchorTime = _anchorTime;
+  _lastAnchorMicros = _anchorMicros;
+}
+
+/**
+ * @brief Queues a write of the time to the RTC and re-anchors the free-running clock to it.
+ *
+ * The clock takes the new time straight away, and is anchored again once
+ * the I2C bus task has made the write. Unless the drift model asked for
+ * this step, the RTC was moved for some other reason (a timezone or DST
+ * change, or a first sync), so the model starts again.
+ * @param time The new local time.
+ * @param atMicros esp_timer_get_time() at which `time` begins, within the
+ *                 next second; 0 to write as soon as possible.
+ */
+void TimeManager::adjustRTC(const DateTime &time, int64_t atMicros)
+{
+  {
+    RecursiveLockGuard lock(_mutex);
+    _rtcLostPower = 0; // Setting the time clears the oscillator-stop flag.
+    if (_driftStepExpected)
+    {
+      _driftStepExpected = false;
+    }
+    else
+    {
+      _driftModel.reset();
+    }
+    if (RTC_FREE_RUNNING)
+    {
+      // A deliberate jump, not drift. Anchored a second early for a timed
+      // write, so the clock never runs from an edge still to come.
+      _lastAnchorTime = 0;
+      if (atMicros != 0)
+      {
+        anchorClock(DateTime(time.unixtime() - 1), atMicros - 1000000);
+      }
+      else
+      {
+        anchorClock(time, esp_timer_get_time());
+      }
+    }
+  }
+  I2cBus::getInstance().queueRtcAdjust(time, atMicros, onRtcAdjusted);
+}
+
+/**
+ * @brief Re-anchors the free-running clock once the RTC has been written.
+ *
+ * Writing the seconds register restarts the DS3231's countdown chain, so
+ * the moment of the write is a second edge.
+ * @param time The time written.
+ * @param writtenMicros esp_timer_get_time() as the write started.
+ */
+void TimeManager::onRtcAdjusted(const DateTime &time, int64_t writtenMicros)
+{
+  TimeManager &timeManager = getInstance();
+  RecursiveLockGuard lock(timeManager._mutex);
+  timeManager._rtcTransactions++;
+  if (RTC_FREE_RUNNING)
+  {
+    timeManager._lastAnchorTime = 0;
+    timeManager.anchorClock(time, writtenMicros);
+  }
+}
+
+/**
+ * @brief Gets how the clock has been kept.
+ * @return The free-running state and RTC bus counts.
+ */
+RtcClockStats TimeManager::getRtcClockStats() const
+{
+  RecursiveLockGuard lock(_mutex);
+  RtcClockStats stats;
+  stats.lastNtpOffsetUs = _lastNtpOffsetUs;
+  stats.driftPpm = _driftPpm;
+  stats.driftFitted = _driftFitted;
+  stats.driftSamples = _driftModel.count();
+  stats.agingOffset = _agingOffset;
+  stats.ntpSyncInterval = _ntpSyncInterval;
+  stats.freeRunning = _anchorTime != 0;
+  stats.transactionsPerMinute = _rtcTransactionsPerMinute;
+  stats.resyncs = _resyncs;
+  stats.lastResyncOffsetUs = _lastResyncOffsetUs;
+  return stats;
+}
+
 DateTime TimeManager::getCachedTime() const
 {
   RecursiveLockGuard lock(_mutex);
-  // If no time has been cached yet (before first update), return current RTC time
+  // If no time has been cached yet (before first update), return the current time
   if (!_cachedTime.isValid() || _cachedTime.year() < 2000)
   {
-    return RTC.now();
+    return getRTCTime();
   }
   return _cachedTime;
 }
 
+/**
+ * @brief Checks whether the RTC holds a valid time.
+ *
+ * The DS3231's oscillator-stop flag is read once and then only again at
+ * each resync, since it can only be cleared by setting the time.
+ * @return True unless the RTC lost power since it was last set.
+ */
 bool TimeManager::isTimeSet() const
 {
   // The DS3231 RTC has a Lost Power flag that is more reliable than checking
   // the year.
   RecursiveLockGuard lock(_mutex);
-  return !RTC.lostPower();
+  if (_rtcLostPower < 0)
+  {
+    I2cBus::Lock bus;
+    _rtcLostPower = RTC.lostPower() ? 1 : 0;
+    _rtcTransactions++;
+  }
+  return _rtcLostPower == 0;
 }
 
+/**
+ * @brief Triggers the most recent alarm that should have rung in the last 30 minutes.
+ *
+ * Each alarm can only have been due at its own hour and minute, so rather
+ * than testing every alarm against every minute of the window, only today's
+ * and yesterday's occurrence of each alarm are checked against it.
+ */
 void TimeManager::checkMissedAlarms()
 {
   if (AlarmManager::getInstance().isRinging())
@@ -533,66 +940,85 @@ void TimeManager::checkMissedAlarms()
     return;
   }
 
-  SerialLog::getInstance().print("Checking for missed alarms on boot...\n");
+  LOG_D(LOG_MODULE_TIME, "Checking for missed alarms on boot...\n");
 
   DateTime now = getRTCTime();
   // Don't look back further than 30 minutes.
   const uint32_t lookbehindSeconds = 30 * 60;
-  DateTime startTime = now - TimeSpan(lookbehindSeconds);
+  DateTime t = now - TimeSpan(lookbehindSeconds);
+  DateTime startTime = DateTime(t.year(), t.month(), t.day(), t.hour(), t.minute());
+  DateTime yesterday = now - TimeSpan(1, 0, 0, 0);
 
   int8_t mostRecentMissedAlarmId = -1;
-  auto &config = ConfigManager::getInstance();
-
-  // To find the most recent missed alarm, we iterate chronologically through
-  // the look-behind window and check all alarms for each minute. The last
-  // one we find will be the most recent.
-  DateTime t = DateTime(startTime.unixtime());
-  DateTime checkTime = DateTime(t.year(), t.month(), t.day(), t.hour(), t.minute());
+  DateTime mostRecentMissedTime = startTime;
 
   // Get a snapshot of all alarms
-  std::vector<Alarm> alarms = config.getAllAlarms();
+  std::vector<Alarm> alarms = ConfigManager::getInstance().getAllAlarms();
 
-  for (; checkTime <= now; checkTime = checkTime + TimeSpan(0, 0, 1, 0))
+  for (const auto &alarm : alarms)
   {
-    for (const auto &alarm : alarms)
+    if (!alarm.isEnabled() || alarm.isSnoozed())
     {
-      if (alarm.isEnabled() && !alarm.isSnoozed() && alarm.shouldRing(checkTime))
+      continue;
+    }
+
+    const DateTime candidates[] = {
+        DateTime(yesterday.year(), yesterday.month(), yesterday.day(), alarm.getHour(), alarm.getMinute()),
+        DateTime(now.year(), now.month(), now.day(), alarm.getHour(), alarm.getMinute()),
+    };
+    for (const DateTime &candidate : candidates)
+    {
+      // Later alarms, and later entries for the same minute, win.
+      if (candidate >= mostRecentMissedTime && candidate <= now && alarm.shouldRing(candidate))
       {
-        // This alarm should have rung. We record it as the most recent candidate.
-        // If we find another one later in the loop, it will overwrite this one.
         mostRecentMissedAlarmId = alarm.getId();
+        mostRecentMissedTime = candidate;
       }
     }
   }
 
   if (mostRecentMissedAlarmId != -1)
   {
-    SerialLog::getInstance().printf("Found missed alarm %d. Triggering now.\n", mostRecentMissedAlarmId);
+    LOG_I(LOG_MODULE_TIME, "Found missed alarm %d. Triggering now.\n", mostRecentMissedAlarmId);
     AlarmManager::getInstance().trigger(mostRecentMissedAlarmId);
   }
   else
   {
-    SerialLog::getInstance().print("No missed alarms found.\n");
+    LOG_D(LOG_MODULE_TIME, "No missed alarms found.\n");
   }
 }
 
 void TimeManager::handleAlarm()
 {
   RecursiveLockGuard lock(_mutex);
-  if (RTC.alarmFired(1))
+  bool alarm1Fired;
+  bool alarm2Fired;
   {
-    RTC.clearAlarm(1);
-    SerialLog::getInstance().printf("RTC alarm 1 fired for alarm ID %d\n", _rtcAlarm1Id);
+    I2cBus::Lock bus;
+    alarm1Fired = RTC.alarmFired(1);
+    if (alarm1Fired)
+    {
+      RTC.clearAlarm(1);
+    }
+    alarm2Fired = RTC.alarmFired(2);
+    if (alarm2Fired)
+    {
+      RTC.clearAlarm(2);
+    }
+  }
+
+  if (alarm1Fired)
+  {
+    LOG_I(LOG_MODULE_TIME, "RTC alarm 1 fired for alarm ID %d\n", _rtcAlarm1Id);
     if (_rtcAlarm1Id != -1)
     {
       AlarmManager::getInstance().trigger(_rtcAlarm1Id);
     }
   }
 
-  if (RTC.alarmFired(2))
+  if (alarm2Fired)
   {
-    RTC.clearAlarm(2);
-    SerialLog::getInstance().printf("RTC alarm 2 fired for alarm ID %d\n", _rtcAlarm2Id);
+    LOG_I(LOG_MODULE_TIME, "RTC alarm 2 fired for alarm ID %d\n", _rtcAlarm2Id);
     if (_rtcAlarm2Id != -1)
     {
       AlarmManager::getInstance().trigger(_rtcAlarm2Id);
@@ -605,7 +1031,7 @@ void TimeManager::handleAlarm()
 
 void TimeManager::clearRtcAlarms()
 {
-  // Assumes Mutex is held by caller if called internally
+  // Assumes the mutex and the bus are held by the caller
   RTC.clearAlarm(1);
   RTC.clearAlarm(2);
   RTC.disableAlarm(1);
@@ -618,23 +1044,54 @@ void TimeManager::updateNextAlarmsCache()
   updateNextAlarmsCache(getRTCTime());
 }
 
+/**
+ * @brief Brings the schedule of upcoming alarms up to date.
+ *
+ * The alarm table is copied out of ConfigManager only when its generation
+ * has moved. The generation is read first, so an edit that lands during the
+ * copy is picked up again on the next call.
+ * @param now The current time.
+ */
 void TimeManager::updateNextAlarmsCache(const DateTime &now)
 {
   auto &config = ConfigManager::getInstance();
-  std::vector<NextAlarmTime> nextAlarms;
+  uint32_t generation = config.getAlarmGeneration();
 
+  bool changed;
   {
     RecursiveLockGuard lock(_mutex);
     _lastCacheUpdateMinute = now.minute();
+    changed = !_scheduleSynced || generation != _scheduleGeneration;
   }
 
-  std::vector<Alarm> alarms = config.getAllAlarms();
+  std::vector<Alarm> alarms;
+  if (changed)
+  {
+    alarms = config.getAllAlarms();
+  }
+
+  RecursiveLockGuard lock(_mutex);
+  if (changed)
+  {
+    _schedule.sync(alarms, now);
+    _scheduleGeneration = generation;
+    _scheduleSynced = true;
+  }
+  else
+  {
+    _schedule.advance(now);
+  }
+}
+
+std::vector<NextAlarmTime> TimeManager::computeNextAlarms(const std::vector<Alarm> &alarms, const DateTime &now)
+{
+  std::vector<NextAlarmTime> nextAlarms;
   for (const auto &alarm : alarms)
   {
     if (alarm.isEnabled())
     {
-      DateTime next = calculateNextRingTime(alarm, now);
-      if (next.isValid())
+      DateTime next;
+      if (AlarmSchedule::nextRingTime(AlarmSchedule::ruleFor(alarm), now, next))
       {
         nextAlarms.push_back({next, alarm.getId()});
       }
@@ -642,26 +1099,18 @@ void TimeManager::updateNextAlarmsCache(const DateTime &now)
   }
 
   std::sort(nextAlarms.begin(), nextAlarms.end());
-
-  RecursiveLockGuard lock(_mutex);
-  _cachedNextAlarms = nextAlarms;
+  return nextAlarms;
 }
 
 std::vector<NextAlarmTime> TimeManager::getNextAlarms(int count) const
 {
   RecursiveLockGuard lock(_mutex);
-  std::vector<NextAlarmTime> result = _cachedNextAlarms;
-  if (result.size() > count)
-  {
-    result.resize(count);
-  }
-  return result;
+  return _schedule.next(count > 0 ? count : 0);
 }
 
 void TimeManager::setNextAlarms()
 {
   RecursiveLockGuard lock(_mutex);
-  clearRtcAlarms();
 
   // Update cache first to ensure we have latest
   updateNextAlarmsCache();
@@ -669,25 +1118,24 @@ void TimeManager::setNextAlarms()
   // We need at least 2 alarms for RTC setting
   std::vector<NextAlarmTime> nextAlarms = getNextAlarms(2);
 
+  I2cBus::Lock bus;
+  clearRtcAlarms();
+
   if (!nextAlarms.empty())
   {
     _rtcAlarm1Id = nextAlarms[0].id;
     RTC.setAlarm1(nextAlarms[0].time, DS3231_A1_Date);
-    char buf[40];
-    snprintf(buf, sizeof(buf), "Set RTC alarm 1 for %04d-%02d-%02d %02d:%02d:%02d\n",
-             nextAlarms[0].time.year(), nextAlarms[0].time.month(), nextAlarms[0].time.day(),
-             nextAlarms[0].time.hour(), nextAlarms[0].time.minute(), nextAlarms[0].time.second());
-    SerialLog::getInstance().print(buf);
+    LOG_I(LOG_MODULE_TIME, "Set RTC alarm 1 for %04d-%02d-%02d %02d:%02d:%02d\n",
+          nextAlarms[0].time.year(), nextAlarms[0].time.month(), nextAlarms[0].time.day(),
+          nextAlarms[0].time.hour(), nextAlarms[0].time.minute(), nextAlarms[0].time.second());
   }
 
   if (nextAlarms.size() > 1)
   {
     _rtcAlarm2Id = nextAlarms[1].id;
     RTC.setAlarm2(nextAlarms[1].time, DS3231_A2_Date);
-    char buf[40];
-    snprintf(buf, sizeof(buf), "Set RTC alarm 2 for %04d-%02d-%02d %02d:%02d\n",
-             nextAlarms[1].time.year(), nextAlarms[1].time.month(), nextAlarms[1].time.day(),
-             nextAlarms[1].time.hour(), nextAlarms[1].time.minute());
-    SerialLog::getInstance().print(buf);
+    LOG_I(LOG_MODULE_TIME, "Set RTC alarm 2 for %04d-%02d-%02d %02d:%02d\n",
+          nextAlarms[1].time.year(), nextAlarms[1].time.month(), nextAlarms[1].time.day(),
+          nextAlarms[1].time.hour(), nextAlarms[1].time.minute());
   }
 }
@@ -11,17 +11,41 @@
 #include "FirmwareVerifier.h"
 #include "ota_public_key.h"
 #include <Update.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
 #include <ArduinoJson.h>
-#include <HTTPClient.h>
-#include <WiFiClientSecure.h>
+#include "HttpsClient.h"
 #include "NtpSync.h"
 #include "SerialLog.h"
+#include "PowerManager.h"
+#include "Constants.h"
 #if __has_include("version.h")
 #include "version.h"
 #else
 #include "version.h.default"
 #endif
 
+/**
+ * @brief Checks a finished image's hash against its Ed25519 signature, logging the outcome.
+ * @param hash The SHA-256 of the whole image.
+ * @param signature The signature released with it.
+ * @return True if the image is authentic.
+ */
+static bool verifyImageSignature(const uint8_t *hash, const uint8_t *signature)
+{
+    String hashHex = FirmwareVerifier::toHexString(hash, FirmwareVerifier::SHA256_HASH_SIZE);
+    LOG_D(LOG_MODULE_UPDATE, "Firmware SHA-256: %s\n", hashHex.c_str());
+
+    if (!FirmwareVerifier::verifySignature(hash, signature, OTA_PUBLIC_KEY))
+    {
+        LOG_E(LOG_MODULE_UPDATE, "SECURITY: Signature verification FAILED!\n");
+        LOG_E(LOG_MODULE_UPDATE, "Firmware may have been tampered with. Update rejected.\n");
+        return false;
+    }
+    LOG_I(LOG_MODULE_UPDATE, "Signature verification PASSED - firmware is authentic\n");
+    return true;
+}
+
 /**
  * @brief Gets the singleton instance of the UpdateManager.
  * @return A reference to the singleton instance.
@@ -42,14 +66,17 @@ UpdateManager::UpdateManager() {}
  *
  * This function is called repeatedly by the web server's upload handler.
  * It initializes the update process on the first chunk and writes subsequent
- * chunks to the flash memory.
+ * chunks to the flash memory, hashing each one on the way. With an OTA key
+ * configured, an upload without a valid signature is refused before anything
+ * is written.
  *
  * @param data Pointer to the data chunk.
  * @param len Length of the data chunk.
  * @param index Starting index of the chunk in the total file.
- * @param total Total size of the firmware file.
+ * @param total Total size of the upload.
+ * @param signatureHex The hex-encoded Ed25519 signature of the image; read with the first chunk.
  */
-void UpdateManager::handleFileUpload(uint8_t *data, size_t len, size_t index, size_t total)
+void UpdateManager::handleFileUpload(uint8_t *data, size_t len, size_t index, size_t total, const String &signatureHex)
 {
     if (_updateFailed)
     {
@@ -58,18 +85,56 @@ void UpdateManager::handleFileUpload(uint8_t *data, size_t len, size_t index, si
 
     if (index == 0)
     {
-        SerialLog::getInstance().print("Update Start\n");
-        _updateInProgress = true;
+        LOG_I(LOG_MODULE_UPDATE, "Update Start\n");
+        setUpdateInProgress(true);
         _updateFailed = false;
         _lastError = "";
+        _uploadVerified = false;
 
+        if (OTA_KEY_CONFIGURED)
+        {
+            String hex = signatureHex;
+            hex.trim();
+            if (hex.isEmpty())
+            {
+                LOG_E(LOG_MODULE_UPDATE, "SECURITY: Upload rejected - no firmware signature\n");
+                _updateFailed = true;
+                _lastError = "No firmware signature (firmware.sig) was sent";
+            }
+            else if (!FirmwareVerifier::parseHexSignature(hex.c_str(), _uploadSignature))
+            {
+                LOG_E(LOG_MODULE_UPDATE, "SECURITY: Upload rejected - signature unreadable\n");
+                _updateFailed = true;
+                _lastError = "Failed to parse signature file";
+            }
+            else if (!_uploadSha.begin())
+            {
+                _updateFailed = true;
+                _lastError = "Failed to compute firmware hash";
+            }
+            else
+            {
+                _uploadVerified = true;
+            }
+        }
+        else
+        {
+            LOG_W(LOG_MODULE_UPDATE, "WARNING: Updating without signature verification\n");
+        }
 
-        if (!Update.begin(UPDATE_SIZE_UNKNOWN))
+        if (!_updateFailed && !Update.begin(UPDATE_SIZE_UNKNOWN))
         {
             Update.printError(Serial);
             _updateFailed = true;
             _lastError = "Update.begin() failed";
         }
+
+        portENTER_CRITICAL(&_progressMux);
+        _progress = {};
+        _progress.active = !_updateFailed;
+        _progress.total = (int32_t)total;
+        _progressStart = millis();
+        portEXIT_CRITICAL(&_progressMux);
     }
 
     if (_updateFailed)
@@ -77,35 +142,75 @@ void UpdateManager::handleFileUpload(uint8_t *data, size_t len, size_t index, si
         return;
     }
 
-
-    if (Update.write(data, len) != len)
+    unsigned long writeStart = millis();
+    if (_uploadVerified && !_uploadSha.update(data, len))
+    {
+        _updateFailed = true;
+        _lastError = "Failed to compute firmware hash";
+    }
+    else if (Update.write(data, len) != len)
     {
         Update.printError(Serial);
         _updateFailed = true;
         _lastError = "Write failed";
     }
+
+    portENTER_CRITICAL(&_progressMux);
+    _progress.flashMs += millis() - writeStart;
+    if (!_updateFailed)
+    {
+        _progress.bytes += len;
+    }
+    portEXIT_CRITICAL(&_progressMux);
 }
 
 
 /**
  * @brief Finalizes the update process with verification.
+ *
+ * The hash of the uploaded image is checked against its signature before
+ * `Update.end()` makes it the boot partition; a mismatch aborts the update
+ * and the running firmware stays in place.
  * @return True if the update was successful, false otherwise.
  */
 bool UpdateManager::endUpdate()
 {
     bool success = false;
 
+    portENTER_CRITICAL(&_progressMux);
+    _progress.active = false;
+    _progress.elapsedMs = millis() - _progressStart;
+    portEXIT_CRITICAL(&_progressMux);
+
     if (_updateFailed)
     {
-        SerialLog::getInstance().print("Update failed. Not finalizing.\n");
+        LOG_E(LOG_MODULE_UPDATE, "Update failed. Not finalizing.\n");
         Update.abort();
         goto cleanup;
     }
 
+    if (_uploadVerified)
+    {
+        uint8_t hash[FirmwareVerifier::SHA256_HASH_SIZE];
+        if (!_uploadSha.finish(hash))
+        {
+            LOG_E(LOG_MODULE_UPDATE, "Failed to compute firmware hash\n");
+            _lastError = "Failed to compute firmware hash";
+            Update.abort();
+            goto cleanup;
+        }
+
+        if (!verifyImageSignature(hash, _uploadSignature))
+        {
+            _lastError = "Signature verification failed";
+            Update.abort();
+            goto cleanup;
+        }
+    }
 
     if (Update.end(true))
     {
-        SerialLog::getInstance().print("Update Success\n");
+        LOG_I(LOG_MODULE_UPDATE, "Update Success\n");
         success = true;
     }
     else
@@ -116,7 +221,8 @@ bool UpdateManager::endUpdate()
 
 cleanup:
     _updateFailed = false;
-    _updateInProgress = false;
+    _uploadVerified = false;
+    setUpdateInProgress(false);
     return success;
 }
 
@@ -129,6 +235,33 @@ bool UpdateManager::isUpdateInProgress()
     return _updateInProgress;
 }
 
+uint32_t UpdateManager::getGeneration() const
+{
+    return _generation;
+}
+
+/**
+ * @brief Sets the in-progress flag, bumping the generation when it changes.
+ * @param inProgress True while an update is running.
+ */
+void UpdateManager::setUpdateInProgress(bool inProgress)
+{
+    if (_updateInProgress != inProgress)
+    {
+        _updateInProgress = inProgress;
+        _generation++;
+        // Downloads, hashing and flash writes run at full speed until the reboot.
+        if (inProgress)
+        {
+            PowerManager::getInstance().acquire(POWER_LOCK_OTA);
+        }
+        else
+        {
+            PowerManager::getInstance().release(POWER_LOCK_OTA);
+        }
+    }
+}
+
 /**
  * @brief Initiates a firmware update from GitHub with signature verification.
  * @return A string indicating the result of the update check.
@@ -144,7 +277,7 @@ String UpdateManager::handleGithubUpdate()
     time_t now = time(nullptr);
     if (now < 1000000000) // Approx year 2001
     {
-        SerialLog::getInstance().print("Time not set. Attempting NTP sync...\n");
+        LOG_W(LOG_MODULE_UPDATE, "Time not set. Attempting NTP sync...\n");
         // Use a local ntp sync helper to avoid recursion if syncTime calls getNTPData which calls configTime
         if (!syncTime())
         {
@@ -155,32 +288,28 @@ String UpdateManager::handleGithubUpdate()
     
     char timeStr[64];
     strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localtime(&now));
-    SerialLog::getInstance().printf("System time: %s\n", timeStr);
+    LOG_D(LOG_MODULE_UPDATE, "System time: %s\n", timeStr);
 
-    HTTPClient http;
-    WiFiClientSecure client;
-    client.setInsecure();
-    client.setTimeout(10000);
+    HttpsClient::Request request(HTTPS_HOST_GITHUB_API);
+    HTTPClient &http = request.http();
 
     String url = "https://api.github.com/repos/" + String(GITHUB_REPO) + "/releases/latest";
-    http.begin(client, url);
-
-    int httpCode = http.GET();
+    int httpCode = request.get(url);
     if (httpCode != HTTP_CODE_OK)
     {
         String errorMsg = "Error checking for updates. HTTP code: " + String(httpCode) + " " + http.errorToString(httpCode);
-        http.end();
+        request.end();
         return errorMsg;
     }
 
     String payload = http.getString();
-    http.end();
+    request.end();
 
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, payload);
     if (error)
     {
-        SerialLog::getInstance().printf("deserializeJson() failed: %s\n", error.c_str());
+        LOG_E(LOG_MODULE_UPDATE, "deserializeJson() failed: %s\n", error.c_str());
         return "Error parsing update data.";
     }
 
@@ -195,7 +324,7 @@ String UpdateManager::handleGithubUpdate()
         return "No new update found.";
     }
 
-    SerialLog::getInstance().printf("Current version: %s, New version: %s\n", FIRMWARE_VERSION, tagName);
+    LOG_I(LOG_MODULE_UPDATE, "Current version: %s, New version: %s\n", FIRMWARE_VERSION, tagName);
 
     // Look for firmware.bin, firmware.sig, and firmware.sha256
     GithubUpdateInfo *updateInfo = new GithubUpdateInfo();
@@ -218,6 +347,10 @@ String UpdateManager::handleGithubUpdate()
         {
             updateInfo->checksumUrl = downloadUrl;
         }
+        else if (assetName == "firmware-" FIRMWARE_VERSION ".patch")
+        {
+            updateInfo->patchUrl = downloadUrl;
+        }
     }
 
     if (updateInfo->firmwareUrl.isEmpty())
@@ -234,21 +367,22 @@ String UpdateManager::handleGithubUpdate()
     }
 
     // Set flag before creating task so UI locks immediately
-    _updateInProgress = true;
+    setUpdateInProgress(true);
 
-    BaseType_t taskCreated = xTaskCreate(
+    BaseType_t taskCreated = xTaskCreatePinnedToCore(
         &UpdateManager::runGithubUpdateTask,
         "github_update_task",
         16384,
         (void *)updateInfo,
         5,
-        NULL);
+        NULL,
+        OTA_READER_CORE);
 
     if (taskCreated != pdPASS)
     {
-        SerialLog::getInstance().print("Failed to create update task.\n");
+        LOG_E(LOG_MODULE_UPDATE, "Failed to create update task.\n");
         delete updateInfo;
-        _updateInProgress = false;
+        setUpdateInProgress(false);
         return "Failed to start update process.";
     }
 
@@ -265,7 +399,7 @@ void UpdateManager::runGithubUpdateTask(void *pvParameters)
     esp_task_wdt_add(NULL);
     
     GithubUpdateInfo *updateInfo = (GithubUpdateInfo *)pvParameters;
-    getInstance()._updateInProgress = true;
+    getInstance().setUpdateInProgress(true);
     getInstance()._lastError = "";
 
     // Download signature file first (if OTA key is configured)
@@ -274,16 +408,12 @@ void UpdateManager::runGithubUpdateTask(void *pvParameters)
 
     if (OTA_KEY_CONFIGURED && !updateInfo->signatureUrl.isEmpty())
     {
-        HTTPClient http;
-        WiFiClientSecure client;
-        client.setInsecure();
-        client.setTimeout(10000);
-        http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-        SerialLog::getInstance().printf("Connecting to: %s\n", updateInfo->signatureUrl.c_str());
-        http.begin(client, updateInfo->signatureUrl);
+        HttpsClient::Request request(HTTPS_HOST_GITHUB_DOWNLOAD);
+        HTTPClient &http = request.http();
+        LOG_D(LOG_MODULE_UPDATE, "Connecting to: %s\n", updateInfo->signatureUrl.c_str());
 
-        int httpCode = http.GET();
-        SerialLog::getInstance().printf("HTTP Response: %d\n", httpCode);
+        int httpCode = request.get(updateInfo->signatureUrl);
+        LOG_D(LOG_MODULE_UPDATE, "HTTP Response: %d\n", httpCode);
 
         if (httpCode == HTTP_CODE_OK)
         {
@@ -293,204 +423,634 @@ void UpdateManager::runGithubUpdateTask(void *pvParameters)
             if (FirmwareVerifier::parseHexSignature(sigContent.c_str(), signature))
             {
                 hasSignature = true;
-                SerialLog::getInstance().print("Signature file downloaded successfully\n");
+                LOG_I(LOG_MODULE_UPDATE, "Signature file downloaded successfully\n");
             }
             else
             {
-                SerialLog::getInstance().print("Failed to parse signature file\n");
+                LOG_E(LOG_MODULE_UPDATE, "Failed to parse signature file\n");
             }
         }
         else
         {
-            SerialLog::getInstance().printf("Failed to download signature: HTTP %d (%s)\n", httpCode, http.errorToString(httpCode).c_str());
+            LOG_E(LOG_MODULE_UPDATE, "Failed to download signature: HTTP %d (%s)\n", httpCode, http.errorToString(httpCode).c_str());
         }
-        http.end();
+        request.end();
 
         if (!hasSignature)
         {
-            SerialLog::getInstance().print("SECURITY: Cannot proceed without valid signature\n");
+            LOG_E(LOG_MODULE_UPDATE, "SECURITY: Cannot proceed without valid signature\n");
             getInstance()._lastError = "Failed to download or parse signature file";
             delete updateInfo;
-            getInstance()._updateInProgress = false;
+            getInstance().setUpdateInProgress(false);
             vTaskDelete(NULL);
             return;
         }
     }
 
-    // Create fresh client objects for firmware download
-    WiFiClientSecure firmwareClient;
-    HTTPClient firmwareHttp;
-    
-    firmwareClient.setInsecure();
-    firmwareClient.setTimeout(10000);
-    firmwareHttp.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-    SerialLog::getInstance().printf("Connecting to: %s\n", updateInfo->firmwareUrl.c_str());
-    firmwareHttp.begin(firmwareClient, updateInfo->firmwareUrl);
+    // A patch against the running version is a fraction of the image; use it if there is one.
+    if (!updateInfo->patchUrl.isEmpty())
+    {
+        HttpsClient::Request patchRequest(HTTPS_HOST_GITHUB_DOWNLOAD);
+        LOG_D(LOG_MODULE_UPDATE, "Connecting to: %s\n", updateInfo->patchUrl.c_str());
+        int patchCode = patchRequest.get(updateInfo->patchUrl);
+        bool patched = patchCode == HTTP_CODE_OK &&
+                       applyFirmwarePatch(patchRequest.http(), hasSignature ? signature : nullptr);
+        patchRequest.end();
+        if (patched)
+        {
+            LOG_I(LOG_MODULE_UPDATE, "Update successful! Rebooting...\n");
+            delete updateInfo;
+            delay(1000); // Give system time to flush logs before restart
+            ESP.restart();
+            // Never reached, but include for safety
+            vTaskDelete(NULL);
+        }
+        LOG_W(LOG_MODULE_UPDATE, "Delta update failed, downloading the full image instead.\n");
+        getInstance()._lastError = "";
+    }
 
-    int httpCode = firmwareHttp.GET();
-    SerialLog::getInstance().printf("HTTP Response: %d\n", httpCode);
+    // Every exit below deletes this task, so each one ends the request first.
+    HttpsClient::Request firmwareRequest(HTTPS_HOST_GITHUB_DOWNLOAD);
+    HTTPClient &firmwareHttp = firmwareRequest.http();
+    LOG_D(LOG_MODULE_UPDATE, "Connecting to: %s\n", updateInfo->firmwareUrl.c_str());
+
+    int httpCode = firmwareRequest.get(updateInfo->firmwareUrl);
+    LOG_D(LOG_MODULE_UPDATE, "HTTP Response: %d\n", httpCode);
 
     if (httpCode == HTTP_CODE_OK)
     {
         int contentLength = firmwareHttp.getSize();
-        SerialLog::getInstance().printf("Firmware size: %d bytes\n", contentLength);
+        LOG_D(LOG_MODULE_UPDATE, "Firmware size: %d bytes\n", contentLength);
 
-        WiFiClient *stream = firmwareHttp.getStreamPtr();
+        if (!hasSignature)
+        {
+            LOG_W(LOG_MODULE_UPDATE, "WARNING: Updating without signature verification\n");
+        }
 
-        // Allocate buffer for firmware (we need it for signature verification)
-        // For large firmware, we'd use streaming hash, but this is simpler for now
-        uint8_t *firmwareBuffer = nullptr;
-        size_t firmwareLen = 0;
+        if (streamFirmware(firmwareHttp, contentLength, hasSignature ? signature : nullptr))
+        {
+            LOG_I(LOG_MODULE_UPDATE, "Update successful! Rebooting...\n");
+            firmwareRequest.end();
+            delete updateInfo;
+            delay(1000); // Give system time to flush logs before restart
+            ESP.restart();
+            // Never reached, but include for safety
+            vTaskDelete(NULL);
+        }
+        getInstance().setUpdateInProgress(false);
+    }
+    else
+    {
+        LOG_E(LOG_MODULE_UPDATE, "HTTP GET failed, error: %s\n", firmwareHttp.errorToString(httpCode).c_str());
+        getInstance().setUpdateInProgress(false);
+    }
+
+    firmwareRequest.end();
+    delete updateInfo;
+    
+    esp_task_wdt_delete(NULL); // Remove from watchdog before deleting task
+    vTaskDelete(NULL);
+}
 
-        if (OTA_KEY_CONFIGURED && hasSignature)
+/// @brief Header of a delta patch made by scripts/make_firmware_patch.py; little-endian like the ESP32.
+struct __attribute__((packed)) FirmwarePatchHeader
+{
+    char magic[4]; ///< "ECDP"
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t sourceSize; ///< Bytes of the running image the patch was made against.
+    uint8_t sourceHash[FirmwareVerifier::SHA256_HASH_SIZE];
+    uint32_t targetSize; ///< Bytes of the image it rebuilds.
+    uint8_t targetHash[FirmwareVerifier::SHA256_HASH_SIZE];
+};
+
+static const uint8_t FIRMWARE_PATCH_VERSION = 1;
+static const uint8_t FIRMWARE_PATCH_END = 0;
+static const uint8_t FIRMWARE_PATCH_COPY = 1;
+static const uint8_t FIRMWARE_PATCH_INSERT = 2;
+
+/**
+ * @brief Reads exactly `length` bytes of a response body, waiting for them to arrive.
+ * @param http The client holding the response.
+ * @param buffer Receives the bytes.
+ * @param length The number of bytes wanted.
+ * @return True if all of them were read before the connection closed or stalled.
+ */
+static bool readBody(HTTPClient &http, uint8_t *buffer, size_t length)
+{
+    WiFiClient *stream = http.getStreamPtr();
+    size_t done = 0;
+    unsigned long lastData = millis();
+    while (done < length)
+    {
+        esp_task_wdt_reset(); // Feed watchdog during download
+        size_t available = stream->available();
+        if (available == 0)
         {
-            // Need to buffer firmware for signature verification
-            // Use PSRAM for the large firmware buffer to avoid fragmenting internal heap
-            firmwareBuffer = (uint8_t *)ps_malloc(contentLength);
-            if (!firmwareBuffer)
+            if (!http.connected() || millis() - lastData > HTTPS_RESPONSE_TIMEOUT)
             {
-                SerialLog::getInstance().print("Failed to allocate firmware buffer\n");
-                getInstance()._lastError = "Out of memory for firmware buffer";
-                firmwareHttp.end();
-                delete updateInfo;
-                getInstance()._updateInProgress = false;
-                vTaskDelete(NULL);
-                return;
+                return false;
             }
+            delay(1);
+            continue;
+        }
+        size_t read = stream->readBytes(buffer + done, min(available, length - done));
+        done += read;
+        if (read > 0)
+        {
+            lastData = millis();
+        }
+    }
+    return true;
+}
 
-            // Read entire firmware into buffer
-            size_t bytesRead = 0;
-            while (bytesRead < (size_t)contentLength && firmwareHttp.connected())
-            {
-                esp_task_wdt_reset(); // Feed watchdog during download
-                size_t available = stream->available();
-                if (available > 0)
-                {
-                    size_t toRead = min(available, (size_t)contentLength - bytesRead);
-                    size_t read = stream->readBytes(firmwareBuffer + bytesRead, toRead);
-                    bytesRead += read;
-
-                    if (bytesRead % 65536 == 0)
-                    {
-                        SerialLog::getInstance().printf("Downloaded %d / %d bytes\n", bytesRead, contentLength);
-                    }
-                }
-                delay(1);
-            }
-            firmwareLen = bytesRead;
+/**
+ * @brief Rebuilds the new image from a delta patch and the running partition.
+ *
+ * The patch is checked against the running image's hash first, so a patch
+ * for another build is refused before anything is written. Copy ranges are
+ * read from the running partition and literal ranges from the network, a
+ * chunk at a time, and hashed on their way to `Update.write()`. The rebuilt
+ * image must match both the hash in the patch and the release signature
+ * before `Update.end()` makes it bootable.
+ * @param http The client holding the patch response.
+ * @param signature The new image's Ed25519 signature, or null to skip verification.
+ * @return True if the image was rebuilt, verified and marked bootable.
+ */
+bool UpdateManager::applyFirmwarePatch(HTTPClient &http, const uint8_t *signature)
+{
+    UpdateManager &manager = getInstance();
+    const esp_partition_t *running = esp_ota_get_running_partition();
 
-            // Compute hash and verify signature
-            uint8_t hash[FirmwareVerifier::SHA256_HASH_SIZE];
-            if (!FirmwareVerifier::computeSHA256(firmwareBuffer, firmwareLen, hash))
-            {
-                SerialLog::getInstance().print("Failed to compute firmware hash\n");
-                free(firmwareBuffer);
-                firmwareHttp.end();
-                delete updateInfo;
-                getInstance()._updateInProgress = false;
-                vTaskDelete(NULL);
-                return;
-            }
+    FirmwarePatchHeader header;
+    if (!readBody(http, (uint8_t *)&header, sizeof(header)) || memcmp(header.magic, "ECDP", 4) != 0 ||
+        header.version != FIRMWARE_PATCH_VERSION)
+    {
+        LOG_W(LOG_MODULE_UPDATE, "Patch: not a firmware patch\n");
+        return false;
+    }
+    if (running == nullptr || header.sourceSize > running->size)
+    {
+        LOG_W(LOG_MODULE_UPDATE, "Patch: made for a larger image than the running one\n");
+        return false;
+    }
 
-            String hashHex = FirmwareVerifier::toHexString(hash, FirmwareVerifier::SHA256_HASH_SIZE);
-            SerialLog::getInstance().printf("Firmware SHA-256: %s\n", hashHex.c_str());
+    uint8_t *chunk = (uint8_t *)malloc(OTA_CHUNK_SIZE);
+    if (chunk == nullptr)
+    {
+        LOG_E(LOG_MODULE_UPDATE, "Failed to allocate firmware buffer\n");
+        return false;
+    }
 
-            if (!FirmwareVerifier::verifySignature(hash, signature, OTA_PUBLIC_KEY))
-            {
-                SerialLog::getInstance().print("SECURITY: Signature verification FAILED!\n");
-                SerialLog::getInstance().print("Firmware may have been tampered with. Update rejected.\n");
-                getInstance()._lastError = "Signature verification failed";
-                free(firmwareBuffer);
-                firmwareHttp.end();
-                delete updateInfo;
-                getInstance()._updateInProgress = false;
-                vTaskDelete(NULL);
-                return;
-            }
+    // Only a patch made against exactly this image rebuilds the right one.
+    FirmwareVerifier::SHA256Context sha;
+    uint8_t hash[FirmwareVerifier::SHA256_HASH_SIZE];
+    bool sourceMatches = sha.begin();
+    for (uint32_t offset = 0; sourceMatches && offset < header.sourceSize; offset += OTA_CHUNK_SIZE)
+    {
+        esp_task_wdt_reset();
+        size_t length = min((size_t)OTA_CHUNK_SIZE, (size_t)(header.sourceSize - offset));
+        sourceMatches = esp_partition_read(running, offset, chunk, length) == ESP_OK && sha.update(chunk, length);
+    }
+    if (!sourceMatches || !sha.finish(hash) || memcmp(hash, header.sourceHash, sizeof(hash)) != 0)
+    {
+        LOG_W(LOG_MODULE_UPDATE, "Patch: made against another build, not applying\n");
+        free(chunk);
+        return false;
+    }
+
+    if (!sha.begin() || !Update.begin(header.targetSize))
+    {
+        Update.printError(Serial);
+        free(chunk);
+        return false;
+    }
+    LOG_I(LOG_MODULE_UPDATE, "Patch: rebuilding %u bytes from the running image\n", header.targetSize);
+
+    portENTER_CRITICAL(&manager._progressMux);
+    manager._progress = {};
+    manager._progress.active = true;
+    manager._progress.total = (int32_t)header.targetSize;
+    manager._progressStart = millis();
+    portEXIT_CRITICAL(&manager._progressMux);
+
+    uint32_t written = 0;
+    uint32_t patchBytes = sizeof(header);
+    bool failed = false;
+    for (;;)
+    {
+        uint8_t op;
+        uint32_t fields[2];
+        if (!readBody(http, &op, 1))
+        {
+            failed = true;
+            break;
+        }
+        patchBytes += 1;
+        if (op == FIRMWARE_PATCH_END)
+        {
+            break;
+        }
 
-            SerialLog::getInstance().print("Signature verification PASSED - firmware is authentic\n");
+        // A copy names an offset and a length; an insert only a length.
+        size_t fieldBytes = (op == FIRMWARE_PATCH_COPY) ? 8 : 4;
+        if ((op != FIRMWARE_PATCH_COPY && op != FIRMWARE_PATCH_INSERT) || !readBody(http, (uint8_t *)fields, fieldBytes))
+        {
+            failed = true;
+            break;
+        }
+        patchBytes += fieldBytes;
+        uint32_t offset = (op == FIRMWARE_PATCH_COPY) ? fields[0] : 0;
+        uint32_t length = (op == FIRMWARE_PATCH_COPY) ? fields[1] : fields[0];
+        if (length > header.targetSize - written ||
+            (op == FIRMWARE_PATCH_COPY && (offset > header.sourceSize || length > header.sourceSize - offset)))
+        {
+            failed = true;
+            break;
+        }
 
-            // Now write verified firmware
-            if (!Update.begin(firmwareLen))
+        while (length > 0 && !failed)
+        {
+            size_t part = min((size_t)OTA_CHUNK_SIZE, (size_t)length);
+            unsigned long writeStart;
+            if (op == FIRMWARE_PATCH_COPY)
+            {
+                esp_task_wdt_reset();
+                failed = esp_partition_read(running, offset, chunk, part) != ESP_OK;
+                offset += part;
+            }
+            else
+            {
+                failed = !readBody(http, chunk, part);
+                patchBytes += part;
+            }
+            writeStart = millis();
+            if (!failed && (!sha.update(chunk, part) || Update.write(chunk, part) != part))
             {
                 Update.printError(Serial);
-                free(firmwareBuffer);
-                firmwareHttp.end();
-                delete updateInfo;
-                getInstance()._updateInProgress = false;
-                vTaskDelete(NULL);
-                return;
+                failed = true;
             }
 
-            size_t written = Update.write(firmwareBuffer, firmwareLen);
-            free(firmwareBuffer);
-
-            if (written != firmwareLen)
+            portENTER_CRITICAL(&manager._progressMux);
+            manager._progress.flashMs += millis() - writeStart;
+            if (!failed)
             {
-                SerialLog::getInstance().printf("Write failed: wrote %d of %d\n", written, firmwareLen);
-                Update.abort();
-                firmwareHttp.end();
-                delete updateInfo;
-                getInstance()._updateInProgress = false;
-                vTaskDelete(NULL);
-                return;
+                manager._progress.bytes += part;
             }
+            portEXIT_CRITICAL(&manager._progressMux);
+
+            written += part;
+            length -= part;
         }
-        else
+        if (failed)
+        {
+            break;
+        }
+    }
+    free(chunk);
+
+    portENTER_CRITICAL(&manager._progressMux);
+    manager._progress.active = false;
+    manager._progress.elapsedMs = millis() - manager._progressStart;
+    portEXIT_CRITICAL(&manager._progressMux);
+    LOG_I(LOG_MODULE_UPDATE, "Patch: %u bytes downloaded for a %u byte image\n", patchBytes, written);
+
+    if (!failed && written != header.targetSize)
+    {
+        failed = true;
+    }
+    if (!failed && (!sha.finish(hash) || memcmp(hash, header.targetHash, sizeof(hash)) != 0))
+    {
+        LOG_E(LOG_MODULE_UPDATE, "Patch: rebuilt image doesn't match the patch's hash\n");
+        failed = true;
+    }
+    if (!failed && signature != nullptr && !verifyImageSignature(hash, signature))
+    {
+        manager._lastError = "Signature verification failed";
+        failed = true;
+    }
+
+    if (failed)
+    {
+        LOG_E(LOG_MODULE_UPDATE, "Patch: could not rebuild the image\n");
+        Update.abort();
+        return false;
+    }
+
+    // Only now is the new partition made the boot partition.
+    if (!Update.end(true) || !Update.isFinished())
+    {
+        Update.printError(Serial);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief The buffers and queues shared by the download's reader and writer.
+ *
+ * Buffer indices circulate between the two queues: the reader takes a free
+ * one, fills it from the network and queues it as full; the writer hashes
+ * and flashes it and queues it as free again.
+ */
+struct UpdateManager::FirmwarePipeline
+{
+    uint8_t *buffers;                  ///< OTA_PIPELINE_BUFFERS chunks of OTA_CHUNK_SIZE.
+    QueueHandle_t freeBuffers;         ///< Indices of buffers the reader may fill.
+    QueueHandle_t fullBuffers;         ///< Chunks waiting for the writer; an empty one ends the stream.
+    SemaphoreHandle_t writerDone;      ///< Given when the writer has stopped.
+    FirmwareVerifier::SHA256Context *sha; ///< Null to skip hashing.
+    volatile bool failed;              ///< Set by the writer on a hash or flash error.
+    const char *error;                 ///< What failed, for `_lastError`.
+};
+
+/// @brief One filled buffer on its way to the writer.
+struct FirmwareChunk
+{
+    uint8_t buffer;
+    uint16_t length;
+};
+
+/**
+ * @brief Hashes and flashes the buffers the reader fills, until it sends an empty one.
+ * @param parameter The FirmwarePipeline.
+ */
+void UpdateManager::firmwareWriterTask(void *parameter)
+{
+    FirmwarePipeline &pipeline = *static_cast<FirmwarePipeline *>(parameter);
+    UpdateManager &manager = getInstance();
+
+    for (;;)
+    {
+        FirmwareChunk chunk;
+        unsigned long waitStart = millis();
+        xQueueReceive(pipeline.fullBuffers, &chunk, portMAX_DELAY);
+        unsigned long waited = millis() - waitStart;
+        if (chunk.length == 0)
         {
-            // No signature verification (key not configured) - stream directly
-            SerialLog::getInstance().print("WARNING: Updating without signature verification\n");
+            break;
+        }
 
-            if (!Update.begin(contentLength))
+        unsigned long writeStart = millis();
+        if (!pipeline.failed)
+        {
+            uint8_t *data = pipeline.buffers + chunk.buffer * OTA_CHUNK_SIZE;
+            if (pipeline.sha != nullptr && !pipeline.sha->update(data, chunk.length))
             {
-                Update.printError(Serial);
-                firmwareHttp.end();
-                delete updateInfo;
-                getInstance()._updateInProgress = false;
-                vTaskDelete(NULL);
-                return;
+                pipeline.error = "Failed to compute firmware hash";
+                pipeline.failed = true;
             }
-
-            size_t written = Update.writeStream(*stream);
-            if (written != (size_t)contentLength)
+            else if (Update.write(data, chunk.length) != chunk.length)
             {
-                SerialLog::getInstance().printf("Write failed: wrote %d of %d\n", written, contentLength);
+                Update.printError(Serial);
+                pipeline.error = "Write failed";
+                pipeline.failed = true;
             }
         }
+        unsigned long writeTime = millis() - writeStart;
 
-        if (Update.end())
+        portENTER_CRITICAL(&manager._progressMux);
+        manager._progress.writerStallMs += waited;
+        manager._progress.flashMs += writeTime;
+        if (!pipeline.failed)
         {
-            if (Update.isFinished())
+            manager._progress.bytes += chunk.length;
+        }
+        portEXIT_CRITICAL(&manager._progressMux);
+
+        xQueueSend(pipeline.freeBuffers, &chunk.buffer, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(pipeline.writerDone);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Streams a firmware response into the OTA partition, hashing it on the way.
+ *
+ * The calling task reads the network into a ring of OTA_PIPELINE_BUFFERS
+ * chunks while a writer task on OTA_WRITER_CORE hashes each chunk and passes
+ * it to `Update.write()`, so a flash erase no longer holds up the download
+ * and a slow network no longer leaves the flash idle. The image is never
+ * held whole. Flash is written before the signature can be checked, but
+ * the new partition only becomes bootable in `Update.end()`, which runs
+ * after the check; a bad image is aborted and the running firmware stays
+ * the boot partition.
+ * @param http The client holding the response.
+ * @param contentLength The body size, or -1 if the server didn't say.
+ * @param signature The image's Ed25519 signature, or null to skip verification.
+ * @return True if the image was written, verified and marked bootable.
+ */
+bool UpdateManager::streamFirmware(HTTPClient &http, int contentLength, const uint8_t *signature)
+{
+    UpdateManager &manager = getInstance();
+    FirmwareVerifier::SHA256Context sha;
+    if (signature != nullptr && !sha.begin())
+    {
+        LOG_E(LOG_MODULE_UPDATE, "Failed to compute firmware hash\n");
+        manager._lastError = "Failed to compute firmware hash";
+        return false;
+    }
+
+    if (!Update.begin(contentLength > 0 ? (size_t)contentLength : UPDATE_SIZE_UNKNOWN))
+    {
+        Update.printError(Serial);
+        manager._lastError = "Update.begin() failed";
+        return false;
+    }
+
+    FirmwarePipeline pipeline = {};
+    pipeline.buffers = (uint8_t *)malloc(OTA_PIPELINE_BUFFERS * OTA_CHUNK_SIZE);
+    pipeline.freeBuffers = xQueueCreate(OTA_PIPELINE_BUFFERS, sizeof(uint8_t));
+    pipeline.fullBuffers = xQueueCreate(OTA_PIPELINE_BUFFERS + 1, sizeof(FirmwareChunk));
+    pipeline.writerDone = xSemaphoreCreateBinary();
+    pipeline.sha = (signature != nullptr) ? &sha : nullptr;
+
+    bool started = pipeline.buffers != nullptr && pipeline.freeBuffers != nullptr &&
+                   pipeline.fullBuffers != nullptr && pipeline.writerDone != nullptr;
+    if (started)
+    {
+        for (uint8_t i = 0; i < OTA_PIPELINE_BUFFERS; i++)
+        {
+            xQueueSend(pipeline.freeBuffers, &i, 0);
+        }
+        started = xTaskCreatePinnedToCore(&UpdateManager::firmwareWriterTask, "ota_writer", 6144,
+                                          &pipeline, 5, NULL, OTA_WRITER_CORE) == pdPASS;
+    }
+    if (!started)
+    {
+        LOG_E(LOG_MODULE_UPDATE, "Failed to allocate firmware buffer\n");
+        manager._lastError = "Out of memory for firmware buffer";
+        Update.abort();
+        free(pipeline.buffers);
+        if (pipeline.freeBuffers != nullptr)
+            vQueueDelete(pipeline.freeBuffers);
+        if (pipeline.fullBuffers != nullptr)
+            vQueueDelete(pipeline.fullBuffers);
+        if (pipeline.writerDone != nullptr)
+            vSemaphoreDelete(pipeline.writerDone);
+        return false;
+    }
+
+    portENTER_CRITICAL(&manager._progressMux);
+    manager._progress = {};
+    manager._progress.active = true;
+    manager._progress.total = contentLength;
+    manager._progressStart = millis();
+    portEXIT_CRITICAL(&manager._progressMux);
+
+    WiFiClient *stream = http.getStreamPtr();
+    size_t total = 0;
+    bool streamEnded = false;
+    unsigned long lastData = millis();
+    while (!streamEnded && !pipeline.failed && (contentLength < 0 || total < (size_t)contentLength))
+    {
+        // Wait for the writer to hand a buffer back.
+        uint8_t index;
+        unsigned long waitStart = millis();
+        while (xQueueReceive(pipeline.freeBuffers, &index, pdMS_TO_TICKS(100)) != pdTRUE)
+        {
+            esp_task_wdt_reset(); // A long flash erase mustn't trip the watchdog.
+        }
+        unsigned long waited = millis() - waitStart;
+        portENTER_CRITICAL(&manager._progressMux);
+        manager._progress.readerStallMs += waited;
+        portEXIT_CRITICAL(&manager._progressMux);
+        lastData += waited; // Time spent waiting on flash isn't a network stall.
+
+        // Fill it whole, so every flash write but the last is a full chunk.
+        uint8_t *buffer = pipeline.buffers + index * OTA_CHUNK_SIZE;
+        size_t length = 0;
+        while (length < OTA_CHUNK_SIZE && (contentLength < 0 || total + length < (size_t)contentLength))
+        {
+            esp_task_wdt_reset(); // Feed watchdog during download
+            size_t available = stream->available();
+            if (available == 0)
             {
-                SerialLog::getInstance().print("Update successful! Rebooting...\n");
-                firmwareHttp.end();
-                delete updateInfo;
-                delay(1000); // Give system time to flush logs before restart
-                ESP.restart();
-                // Never reached, but include for safety
-                vTaskDelete(NULL);
+                if (!http.connected() || millis() - lastData > HTTPS_RESPONSE_TIMEOUT)
+                {
+                    streamEnded = true;
+                    break;
+                }
+                delay(1);
+                continue;
             }
-            else
+            size_t toRead = min(available, (size_t)OTA_CHUNK_SIZE - length);
+            if (contentLength > 0)
+            {
+                toRead = min(toRead, (size_t)contentLength - total - length);
+            }
+            size_t read = stream->readBytes(buffer + length, toRead);
+            length += read;
+            if (read > 0)
             {
-                SerialLog::getInstance().print("Update not finished. Something went wrong.\n");
-                getInstance()._updateInProgress = false;
+                lastData = millis();
             }
         }
-        else
+
+        if (length == 0)
         {
-            Update.printError(Serial);
-            getInstance()._updateInProgress = false;
+            xQueueSend(pipeline.freeBuffers, &index, 0);
+            break;
+        }
+        FirmwareChunk chunk = {index, (uint16_t)length};
+        xQueueSend(pipeline.fullBuffers, &chunk, portMAX_DELAY);
+
+        if ((total + length) / 65536 != total / 65536)
+        {
+            LOG_D(LOG_MODULE_UPDATE, "Downloaded %u / %d bytes\n", (unsigned)(total + length), contentLength);
         }
+        total += length;
     }
-    else
+
+    // An empty chunk tells the writer the stream is over.
+    FirmwareChunk end = {0, 0};
+    xQueueSend(pipeline.fullBuffers, &end, portMAX_DELAY);
+    while (xSemaphoreTake(pipeline.writerDone, pdMS_TO_TICKS(1000)) != pdTRUE)
     {
-        SerialLog::getInstance().printf("HTTP GET failed, error: %s\n", firmwareHttp.errorToString(httpCode).c_str());
-        getInstance()._updateInProgress = false;
+        esp_task_wdt_reset();
     }
+    free(pipeline.buffers);
+    vQueueDelete(pipeline.freeBuffers);
+    vQueueDelete(pipeline.fullBuffers);
+    vSemaphoreDelete(pipeline.writerDone);
 
-    firmwareHttp.end();
-    delete updateInfo;
-    
-    esp_task_wdt_delete(NULL); // Remove from watchdog before deleting task
-    vTaskDelete(NULL);
+    portENTER_CRITICAL(&manager._progressMux);
+    manager._progress.active = false;
+    manager._progress.elapsedMs = millis() - manager._progressStart;
+    OtaProgress progress = manager._progress;
+    portEXIT_CRITICAL(&manager._progressMux);
+    LOG_I(LOG_MODULE_UPDATE, "Firmware download: %u bytes in %u ms, reader stalled %u ms, writer stalled %u ms, flash %u ms\n",
+          progress.bytes, progress.elapsedMs, progress.readerStallMs, progress.writerStallMs, progress.flashMs);
+
+    bool failed = pipeline.failed;
+    if (failed)
+    {
+        manager._lastError = pipeline.error;
+    }
+    else if (contentLength > 0 && total != (size_t)contentLength)
+    {
+        LOG_E(LOG_MODULE_UPDATE, "Write failed: wrote %u of %d\n", (unsigned)total, contentLength);
+        manager._lastError = "Firmware download incomplete";
+        failed = true;
+    }
+
+    if (!failed && signature != nullptr)
+    {
+        uint8_t hash[FirmwareVerifier::SHA256_HASH_SIZE];
+        if (!sha.finish(hash))
+        {
+            LOG_E(LOG_MODULE_UPDATE, "Failed to compute firmware hash\n");
+            manager._lastError = "Failed to compute firmware hash";
+            failed = true;
+        }
+        else if (!verifyImageSignature(hash, signature))
+        {
+            manager._lastError = "Signature verification failed";
+            failed = true;
+        }
+    }
+
+    if (failed)
+    {
+        Update.abort();
+        return false;
+    }
+
+    // Only now is the new partition made the boot partition.
+    if (!Update.end(true))
+    {
+        Update.printError(Serial);
+        manager._lastError = "Update.end() failed";
+        return false;
+    }
+    if (!Update.isFinished())
+    {
+        LOG_E(LOG_MODULE_UPDATE, "Update not finished. Something went wrong.\n");
+        manager._lastError = "Update not finished";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Gets the progress of the current or last firmware download or upload.
+ * @return A snapshot of the progress.
+ */
+OtaProgress UpdateManager::getDownloadProgress() const
+{
+    portENTER_CRITICAL(&_progressMux);
+    OtaProgress progress = _progress;
+    unsigned long start = _progressStart;
+    portEXIT_CRITICAL(&_progressMux);
+
+    if (progress.active)
+    {
+        progress.elapsedMs = millis() - start;
+    }
+    if (progress.elapsedMs > 0)
+    {
+        progress.kbPerSecond = (uint32_t)((uint64_t)progress.bytes * 1000 / 1024 / progress.elapsedMs);
+    }
+    return progress;
 }
\ No newline at end of file
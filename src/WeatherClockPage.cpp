@@ -11,11 +11,7 @@
 #include "SensorModule.h"
 #include "AlarmManager.h"
 #include "WeatherService.h"
-#include "fonts/DSEG7ModernBold104.h"
-#include "fonts/DSEG14ModernBold32.h"
-#include "fonts/DSEG14ModernBold48.h"
-#include "fonts/DSEG7ModernBold48.h"
-#include "fonts/CenturyGothicBold48.h"
+#include "FontManager.h"
 
 #include <Arduino.h>
 
@@ -31,7 +27,7 @@ WeatherClockPage::~WeatherClockPage()
 
 void WeatherClockPage::onEnter(TFT_eSPI &tft)
 {
-  updateSpriteColors();
+  applyTheme();
   tft.fillScreen(_bgColor);
 
   if (!_spritesCreated)
@@ -46,7 +42,7 @@ void WeatherClockPage::onEnter(TFT_eSPI &tft)
   _lastWeatherData = {};
   _lastWeatherData.indoorTemp = -999.0;
   _lastWeatherData.indoorHumidity = -999.0;
-  _lastWeatherData.outdoorTemp = -999.0;
+  _lastWeatherData.weatherGeneration = UINT32_MAX;
   resetClockFields(_lastWeatherData);
 }
 
@@ -68,12 +64,10 @@ void WeatherClockPage::render(TFT_eSPI &tft)
   renderClockElements(tft, currentData, _lastWeatherData);
 
   // Weather-specific elements
-  if (fabs(currentData.outdoorTemp - _lastWeatherData.outdoorTemp) > 0.1 ||
-      currentData.outdoorCondition != _lastWeatherData.outdoorCondition)
+  if (currentData.weatherGeneration != _lastWeatherData.weatherGeneration)
   {
     drawWeather(tft);
-    _lastWeatherData.outdoorTemp = currentData.outdoorTemp;
-    _lastWeatherData.outdoorCondition = currentData.outdoorCondition;
+    _lastWeatherData.weatherGeneration = currentData.weatherGeneration;
   }
 
   if (fabs(currentData.indoorTemp - _lastWeatherData.indoorTemp) > 0.1)
@@ -103,9 +97,7 @@ void WeatherClockPage::setupLayout(TFT_eSPI &tft)
   int screenWidth = tft.width();
   int screenHeight = tft.height();
 
-  tft.loadFont(DSEG14ModernBold32);
-  int fontHeight = tft.fontHeight();
-  tft.unloadFont();
+  int fontHeight = FontManager::getInstance().fontHeight(FONT_DSEG14_MODERN_BOLD_32);
 
   _weatherY = screenHeight - (fontHeight * 3 + MARGIN + 80);
   _dateY = screenHeight - (fontHeight * 2 + MARGIN + 55);
@@ -123,7 +115,7 @@ void WeatherClockPage::setupSprites(TFT_eSPI &tft)
   setupClockSprites(tft);
 
   _sprWeather.createSprite(tft.width() - 2 * MARGIN, DAY_OF_WEEK_SPRITE_HEIGHT);
-  _sprWeather.loadFont(CenturyGothicBold48);
+  FontManager::getInstance().use(_sprWeather, FONT_CENTURY_GOTHIC_BOLD_48);
   _sprWeather.setTextDatum(MC_DATUM);
 
   // Bottom Row Sprites
@@ -133,75 +125,71 @@ void WeatherClockPage::setupSprites(TFT_eSPI &tft)
   int sensorWidth = (availableWidth - alarmWidth) / 2;
 
   _sprIndoorTemp.createSprite(sensorWidth, TEMP_SPRITE_HEIGHT);
-  _sprIndoorTemp.loadFont(DSEG14ModernBold48);
+  FontManager::getInstance().use(_sprIndoorTemp, FONT_DSEG14_MODERN_BOLD_48);
   _sprIndoorTemp.setTextDatum(ML_DATUM);
 
   _sprBottomAlarm.createSprite(alarmWidth, TEMP_SPRITE_HEIGHT);
-  _sprBottomAlarm.loadFont(DSEG14ModernBold32);
+  FontManager::getInstance().use(_sprBottomAlarm, FONT_DSEG14_MODERN_BOLD_32);
   _sprBottomAlarm.setTextDatum(MC_DATUM);
 
   _sprIndoorHumidity.createSprite(sensorWidth, TEMP_SPRITE_HEIGHT);
-  _sprIndoorHumidity.loadFont(DSEG14ModernBold48);
+  FontManager::getInstance().use(_sprIndoorHumidity, FONT_DSEG14_MODERN_BOLD_48);
   _sprIndoorHumidity.setTextDatum(MR_DATUM);
 
-  updateSpriteColors();
+  applyTheme(true);
 }
 
-void WeatherClockPage::updateSpriteColors()
+void WeatherClockPage::updateSpriteColors(const Theme &theme)
 {
   // Update base colors
-  ClockPage::updateSpriteColors();
-
-  auto &config = ConfigManager::getInstance();
-  uint16_t weatherTempColor = hexToRGB565(config.getWeatherTempColor());
-  uint16_t weatherForecastColor = hexToRGB565(config.getWeatherForecastColor());
-  uint16_t tempColor = hexToRGB565(config.getTempColor());
-  uint16_t humidityColor = hexToRGB565(config.getHumidityColor());
-  uint16_t alarmColor = hexToRGB565(config.getAlarmTextColor());
-
-  _sprWeather.setTextColor(weatherTempColor, _bgColor);
-  _sprIndoorTemp.setTextColor(tempColor, _bgColor);
-  _sprBottomAlarm.setTextColor(alarmColor, _bgColor);
-  _sprIndoorHumidity.setTextColor(humidityColor, _bgColor);
+  ClockPage::updateSpriteColors(theme);
+
+  // The weather sprite holds two ramps: temperature in 0-7, condition in 8-15.
+  _sprWeather.setPaletteRamp(WEATHER_TEMP_PAPER, WEATHER_TEMP_INK, _bgColor, theme.weatherTemp);
+  _sprWeather.setPaletteRamp(WEATHER_FORECAST_PAPER, WEATHER_FORECAST_INK, _bgColor, theme.weatherForecast);
+  _sprWeather.setTextColor(WEATHER_TEMP_INK, WEATHER_TEMP_PAPER);
+  _sprIndoorTemp.setRamp(theme.temp, _bgColor);
+  _sprBottomAlarm.setRamp(theme.alarmText, _bgColor);
+  _sprIndoorHumidity.setRamp(theme.humidity, _bgColor);
 }
 
 void WeatherClockPage::drawWeather(TFT_eSPI &tft)
 {
-  auto &config = ConfigManager::getInstance();
+  ConfigSnapshotRef config = ConfigManager::getInstance().snapshot();
 
   WeatherData wd = WeatherService::getInstance().getCurrentWeather();
-  uint16_t tempColor = hexToRGB565(config.getWeatherTempColor());
-  uint16_t forecastColor = hexToRGB565(config.getWeatherForecastColor());
 
-  _sprWeather.fillSprite(_bgColor);
-  _sprWeather.setTextColor(tempColor, _bgColor);
+  _sprWeather.fillSprite(WEATHER_TEMP_PAPER);
+  _sprWeather.setTextColor(WEATHER_TEMP_INK, WEATHER_TEMP_PAPER);
 
   if (wd.isValid)
   {
     float temp = wd.temp;
-    if (config.isCelsius())
+    if (config->useCelsius)
     {
       temp = (temp - 32.0) * 5.0 / 9.0;
     }
     char tempBuf[10];
     snprintf(tempBuf, sizeof(tempBuf), "%.0f", temp);
-    String unit = config.isCelsius() ? "C" : "F";
+    String unit = config->useCelsius ? "C" : "F";
 
     // Manual drawing with circle
-    _sprWeather.loadFont(CenturyGothicBold48);
+    FontManager::getInstance().use(_sprWeather, FONT_CENTURY_GOTHIC_BOLD_48);
     _sprWeather.setTextDatum(ML_DATUM);
 
     // Calculate widths to center everything as a block
     int tempW = _sprWeather.textWidth(tempBuf);
 
-    _sprWeather.unloadFont();
+    FontManager::getInstance().release(_sprWeather);
     _sprWeather.setTextFont(4);
     int unitW = _sprWeather.textWidth(unit);
     int degreeW = 6; // Estimation for small circle spacing
 
-    _sprWeather.loadFont(CenturyGothicBold48);
+    FontManager::getInstance().use(_sprWeather, FONT_CENTURY_GOTHIC_BOLD_48);
     int spaceW = _sprWeather.textWidth(" ");
-    int condW = _sprWeather.textWidth(wd.condition);
+    char condition[32];
+    snprintf(condition, sizeof(condition), " %s", WeatherService::getConditionFromWMO(wd.weatherCode));
+    int condW = _sprWeather.textWidth(condition + 1);
 
     int totalW = tempW + degreeW + unitW + spaceW + condW;
     int startX = (_sprWeather.width() - totalW) / 2;
@@ -211,7 +199,7 @@ void WeatherClockPage::drawWeather(TFT_eSPI &tft)
     int centerY = (_sprWeather.height() / 2) - 3;
 
     // Draw Temp
-    _sprWeather.setTextColor(tempColor, _bgColor);
+    _sprWeather.setTextColor(WEATHER_TEMP_INK, WEATHER_TEMP_PAPER);
     _sprWeather.setTextDatum(ML_DATUM);
     _sprWeather.drawString(tempBuf, startX, centerY);
 
@@ -224,11 +212,11 @@ void WeatherClockPage::drawWeather(TFT_eSPI &tft)
     int degreeCenterY = centerY - 18;
     int unitTextY = centerY - 7;
 
-    _sprWeather.fillCircle(circleX, degreeCenterY, circleRadius, tempColor);
+    _sprWeather.fillCircle(circleX, degreeCenterY, circleRadius, WEATHER_TEMP_INK);
 
     currentX += (circleRadius * 2) + 4;
 
-    _sprWeather.unloadFont();
+    FontManager::getInstance().release(_sprWeather);
     _sprWeather.setTextFont(4);
     _sprWeather.setTextDatum(ML_DATUM);
     _sprWeather.drawString(unit, currentX + 8, unitTextY);
@@ -236,29 +224,28 @@ void WeatherClockPage::drawWeather(TFT_eSPI &tft)
     currentX += unitW;
 
     // Draw Condition
-    _sprWeather.loadFont(CenturyGothicBold48);
-    _sprWeather.setTextColor(forecastColor, _bgColor);
+    FontManager::getInstance().use(_sprWeather, FONT_CENTURY_GOTHIC_BOLD_48);
+    _sprWeather.setTextColor(WEATHER_FORECAST_INK, WEATHER_FORECAST_PAPER);
     _sprWeather.setTextDatum(ML_DATUM);
-    _sprWeather.drawString(" " + wd.condition, currentX, centerY);
+    _sprWeather.drawString(condition, currentX, centerY);
   }
   else
   {
-    _sprWeather.loadFont(CenturyGothicBold48);
+    FontManager::getInstance().use(_sprWeather, FONT_CENTURY_GOTHIC_BOLD_48);
     _sprWeather.setTextDatum(MC_DATUM);
     _sprWeather.drawString("Weather N/A", _sprWeather.width() / 2, _sprWeather.height() / 2);
   }
 
-  _sprWeather.pushSprite(MARGIN, _weatherY);
+  pushSprite(_sprWeather, MARGIN, _weatherY);
 }
 
 void WeatherClockPage::drawIndoorTemp(TFT_eSPI &tft)
 {
-  auto &config = ConfigManager::getInstance();
-  uint16_t tempColor = hexToRGB565(config.getTempColor());
+  ConfigSnapshotRef config = ConfigManager::getInstance().snapshot();
   float temp = getTemperature();
 
-  _sprIndoorTemp.fillSprite(_bgColor);
-  _sprIndoorTemp.loadFont(DSEG14ModernBold48);
+  _sprIndoorTemp.fillSprite(ArenaSprite::PAPER);
+  FontManager::getInstance().use(_sprIndoorTemp, FONT_DSEG14_MODERN_BOLD_48);
 
   char tempBuf[16];
   snprintf(tempBuf, sizeof(tempBuf), "%.0f", temp);
@@ -269,29 +256,29 @@ void WeatherClockPage::drawIndoorTemp(TFT_eSPI &tft)
   int circleRadius = max(2, fontHeight / 14);
   int circleX = tempWidth + circleRadius + 4;
   int circleY = (_sprIndoorTemp.height() / 2) - (fontHeight / 2) + circleRadius;
-  _sprIndoorTemp.fillCircle(circleX, circleY, circleRadius, tempColor);
+  _sprIndoorTemp.fillCircle(circleX, circleY, circleRadius, ArenaSprite::INK);
 
   // Unit - Use Font 4
-  _sprIndoorTemp.unloadFont();
+  FontManager::getInstance().release(_sprIndoorTemp);
   _sprIndoorTemp.setTextFont(4);
-  char unit = config.isCelsius() ? 'C' : 'F';
+  char unit = config->useCelsius ? 'C' : 'F';
   char unitBuf[2] = {unit, '\0'};
   // Adjust Y for Font 4
   _sprIndoorTemp.drawString(unitBuf, circleX + circleRadius + 6, (_sprIndoorTemp.height() / 2) - 10);
 
-  _sprIndoorTemp.pushSprite(MARGIN, _sensorY);
+  pushSprite(_sprIndoorTemp, MARGIN, _sensorY);
 }
 
 void WeatherClockPage::drawBottomAlarm(TFT_eSPI &tft, const char *alarmText)
 {
-  _sprBottomAlarm.fillSprite(_bgColor);
+  _sprBottomAlarm.fillSprite(ArenaSprite::PAPER);
 
   if (alarmText[0] != '\0')
   {
     _sprBottomAlarm.drawString(alarmText, _sprBottomAlarm.width() / 2, _sprBottomAlarm.height() / 2);
   }
 
-  _sprBottomAlarm.pushSprite(MARGIN + _sensorWidth, _sensorY);
+  pushSprite(_sprBottomAlarm, MARGIN + _sensorWidth, _sensorY);
 }
 
 void WeatherClockPage::drawIndoorHumidity(TFT_eSPI &tft)
@@ -307,10 +294,10 @@ void WeatherClockPage::drawIndoorHumidity(TFT_eSPI &tft)
     snprintf(buf, sizeof(buf), "%.0f%%", humidity);
   }
 
-  _sprIndoorHumidity.fillSprite(_bgColor);
-  _sprIndoorHumidity.loadFont(DSEG14ModernBold48);
+  _sprIndoorHumidity.fillSprite(ArenaSprite::PAPER);
+  FontManager::getInstance().use(_sprIndoorHumidity, FONT_DSEG14_MODERN_BOLD_48);
   _sprIndoorHumidity.drawString(buf, _sprIndoorHumidity.width(), _sprIndoorHumidity.height() / 2);
-  _sprIndoorHumidity.pushSprite(MARGIN + _sensorWidth + _alarmWidth, _sensorY);
+  pushSprite(_sprIndoorHumidity, MARGIN + _sensorWidth + _alarmWidth, _sensorY);
 }
 
 void WeatherClockPage::updateDisplayData(WeatherClockDisplayData &data)
@@ -320,9 +307,8 @@ void WeatherClockPage::updateDisplayData(WeatherClockDisplayData &data)
   data.indoorTemp = getTemperature();
   data.indoorHumidity = getHumidity();
 
-  WeatherData wd = WeatherService::getInstance().getCurrentWeather();
-  data.outdoorTemp = wd.temp;
-  data.outdoorCondition = wd.condition;
+  // The weather itself is only copied when drawWeather() needs it.
+  data.weatherGeneration = WeatherService::getInstance().getWeatherGeneration();
 
   auto &timeManager = TimeManager::getInstance();
   std::vector<NextAlarmTime> alarms = timeManager.getNextAlarms(1);
@@ -351,18 +337,17 @@ void WeatherClockPage::updateDisplayData(WeatherClockDisplayData &data)
 
 void WeatherClockPage::refresh(TFT_eSPI &tft, bool fullRefresh)
 {
-  auto &config = ConfigManager::getInstance();
-  updateSpriteColors();
+  applyTheme();
 
   if (fullRefresh)
   {
     tft.fillScreen(_bgColor);
   }
 
-  if (config.is24HourFormat())
+  if (ConfigManager::getInstance().snapshot()->use24HourFormat)
   {
-    _sprTOD.fillSprite(_bgColor);
-    _sprTOD.pushSprite(_todX, _todY);
+    _sprTOD.fillSprite(ArenaSprite::PAPER);
+    pushSprite(_sprTOD, _todX, _todY);
   }
 
   // Force a redraw of all elements
@@ -371,7 +356,6 @@ void WeatherClockPage::refresh(TFT_eSPI &tft, bool fullRefresh)
   // WeatherClockPage-specific fields
   _lastWeatherData.indoorTemp = -999.0;
   _lastWeatherData.indoorHumidity = -999.0;
-  _lastWeatherData.outdoorTemp = -999.0;
-  _lastWeatherData.outdoorCondition = " ";
+  _lastWeatherData.weatherGeneration = UINT32_MAX;
   strncpy(_lastWeatherData.nextAlarm, "REFRESH", sizeof(_lastWeatherData.nextAlarm));
 }
@@ -4,196 +4,222 @@
 
 #include "Utils.h"
 
+// Layout for the landscape panel: full-width rows and two columns, scaled to
+// the panel's width. Each box is sized for its font's line height so a
+// redraw fully covers the previous text.
+namespace
+{
+  constexpr int16_t COL_MARGIN = 5;
+  constexpr int16_t LEFT_COL_X = COL_MARGIN;
+  constexpr int16_t FONT4_H = 26;
+  constexpr int16_t ROW1_Y = 167;
+  constexpr int16_t ROW2_Y = 222;
+  constexpr int16_t ROW_VALUE_OFFSET = 25;
+
+  /// @brief The width of each of the two columns.
+  int16_t columnWidth(TFT_eSPI *tft)
+  {
+    return tft->width() / 2 - 2 * COL_MARGIN;
+  }
+
+  /// @brief The x-coordinate of the right-hand column.
+  int16_t rightColumnX(TFT_eSPI *tft)
+  {
+    return tft->width() / 2 + COL_MARGIN;
+  }
+}
+
+WeatherPage::WeatherPage(TFT_eSPI *tft)
+    : _dataLayer(tft),
+      _location(0, 10, tft->width(), 20),
+      _temp(40, 57, tft->width() - 80, 56),
+      _condition(0, 126, tft->width(), 28),
+      _feelsLikeLabel(LEFT_COL_X, ROW1_Y, columnWidth(tft), FONT4_H),
+      _feelsLike(LEFT_COL_X, ROW1_Y + ROW_VALUE_OFFSET, columnWidth(tft), FONT4_H),
+      _humidityLabel(rightColumnX(tft), ROW1_Y, columnWidth(tft), FONT4_H),
+      _humidity(rightColumnX(tft), ROW1_Y + ROW_VALUE_OFFSET, columnWidth(tft), FONT4_H),
+      _windLabel(LEFT_COL_X, ROW2_Y, columnWidth(tft), FONT4_H),
+      _wind(LEFT_COL_X, ROW2_Y + ROW_VALUE_OFFSET, columnWidth(tft), FONT4_H),
+      _rainLabel(rightColumnX(tft), ROW2_Y, columnWidth(tft), FONT4_H),
+      _rain(rightColumnX(tft), ROW2_Y + ROW_VALUE_OFFSET, columnWidth(tft), FONT4_H),
+      _attribution(0, tft->height() - 23, tft->width(), 18),
+      _statusLayer(tft),
+      _statusTitle(0, 145, tft->width(), 30),
+      _statusDetail(0, 180, tft->width(), 20)
+{
+  _location.setFont(2);
+  _temp.setFonts(7, 4, 3);
+  _condition.setFont(4);
+  _feelsLikeLabel.setFont(4);
+  _feelsLikeLabel.setText("Feels Like");
+  _feelsLike.setFonts(4, 4, 2);
+  _humidityLabel.setFont(4);
+  _humidityLabel.setText("Humidity");
+  _humidity.setFonts(4, 4);
+  _humidity.setUnit("%", false, 0);
+  _windLabel.setFont(4);
+  _windLabel.setText("Wind");
+  _wind.setFonts(4, 4);
+  _rainLabel.setFont(4);
+  _rainLabel.setText("Rain Chance");
+  _rain.setFonts(4, 4);
+  _rain.setUnit("%", false, 0);
+  _attribution.setFont(2);
+  _attribution.setColor(0x632C); // Dim gray, color565(100, 100, 100)
+  _attribution.setText("Weather data provided by open-meteo.com");
+
+  _dataLayer.add(_location);
+  _dataLayer.add(_temp);
+  _dataLayer.add(_condition);
+  _dataLayer.add(_feelsLikeLabel);
+  _dataLayer.add(_feelsLike);
+  _dataLayer.add(_humidityLabel);
+  _dataLayer.add(_humidity);
+  _dataLayer.add(_windLabel);
+  _dataLayer.add(_wind);
+  _dataLayer.add(_rainLabel);
+  _dataLayer.add(_rain);
+  _dataLayer.add(_attribution);
+
+  _statusTitle.setFont(4);
+  _statusTitle.setText("No Weather Data");
+  _statusDetail.setFont(2);
+
+  _statusLayer.add(_statusTitle);
+  _statusLayer.add(_statusDetail);
+
+  _dataLayer.begin();
+  _statusLayer.begin();
+}
+
 void WeatherPage::onEnter(TFT_eSPI &tft)
 {
-  tft.fillScreen(hexToRGB565(ConfigManager::getInstance().getBackgroundColor()));
-  tft.unloadFont(); // Ensure no custom fonts are loaded
+  FontManager::getInstance().release(tft); // Ensure no custom fonts are loaded
   tft.setTextSize(1);
   tft.setTextDatum(TL_DATUM);
-  _needsRedraw = true;
-  _lastWeatherData.isValid = false; // Force update
+  applyConfig();
+  _needsClear = true;
+  update();
+  render(tft);
 }
 
 void WeatherPage::onExit()
 {
-  // Cleanup if needed
+  _dataLayer.release();
+  _statusLayer.release();
 }
 
 void WeatherPage::update()
 {
-  // Check if weather data changed
-  WeatherData current = WeatherService::getInstance().getCurrentWeather();
-  if (current.isValid && (abs(current.temp - _lastWeatherData.temp) > 0.1 || current.condition != _lastWeatherData.condition))
+  // Also re-read the configuration if it changed (unit C/F, colors, address)
+  if (ConfigManager::getInstance().takeChanges(_configChanges) & (CONFIG_CHANGE_THEME | CONFIG_CHANGE_FORMAT | CONFIG_CHANGE_WEATHER_LOCATION))
   {
-    _needsRedraw = true;
+    applyConfig();
   }
 
-  // Also redraw if Config changed (unit C/F)
-  if (ConfigManager::getInstance().isDirty())
+  // Nothing to copy unless the weather or the units changed.
+  WeatherService &service = WeatherService::getInstance();
+  if (service.getWeatherGeneration() == _weatherGeneration)
   {
-    _needsRedraw = true;
+    return;
+  }
+  WeatherData current = service.getCurrentWeather();
+  _weatherGeneration = current.generation;
+  if (current.isValid != _hasData)
+  {
+    _hasData = current.isValid;
+    _needsClear = true;
+  }
+  if (current.isValid)
+  {
+    applyWeather(current);
   }
 }
 
 void WeatherPage::render(TFT_eSPI &tft)
 {
-  if (_needsRedraw)
+  WidgetLayer &layer = _hasData ? _dataLayer : _statusLayer;
+  if (_needsClear)
   {
-    drawWeather(tft);
-    _needsRedraw = false;
-    _lastWeatherData = WeatherService::getInstance().getCurrentWeather();
+    tft.fillScreen(_bgColor);
+    layer.invalidateAll();
+    _needsClear = false;
+    if (!layer.isReady())
+    {
+      WidgetLayer::drawUnavailable(tft, _bgColor);
+    }
   }
+  layer.render();
 }
 
 void WeatherPage::refresh(TFT_eSPI &tft, bool fullRefresh)
 {
+  applyConfig();
   if (fullRefresh)
   {
-    tft.fillScreen(hexToRGB565(ConfigManager::getInstance().getBackgroundColor()));
+    _needsClear = true;
   }
-  _needsRedraw = true;
+  update();
   render(tft);
 }
 
-void WeatherPage::drawWeather(TFT_eSPI &tft)
+void WeatherPage::applyConfig()
 {
-  // Reset text size to default to avoid scaling issues from previous pages
-  tft.setTextSize(1);
-  tft.setTextDatum(MC_DATUM); // Reset datum to default or what we use
-
-  // Simple text based rendering for now
-
-  uint16_t bg = hexToRGB565(ConfigManager::getInstance().getBackgroundColor());
-  uint16_t txtColor = hexToRGB565(ConfigManager::getInstance().getWeatherTempColor());
-
-  tft.fillScreen(bg);
-
-  WeatherData data = WeatherService::getInstance().getCurrentWeather();
-
-  if (!data.isValid)
-  {
-    tft.setTextColor(hexToRGB565(ConfigManager::getInstance().getErrorTextColor()), bg);
-    tft.setTextDatum(MC_DATUM);
-    tft.drawString("No Weather Data", tft.width() / 2, tft.height() / 2, 4);
-
-    String address = ConfigManager::getInstance().getAddress();
-    if (address.length() == 0)
-    {
-      tft.drawString("Set Address", tft.width() / 2, tft.height() / 2 + 30, 2);
-    }
-    else
-    {
-      tft.drawString("Updating...", tft.width() / 2, tft.height() / 2 + 30, 2);
-    }
-    return;
-  }
+  ConfigSnapshotRef config = ConfigManager::getInstance().snapshot();
 
-  // Temperature
-  float temp = data.temp;
-  String unit = "F";
-  if (ConfigManager::getInstance().isCelsius())
+  if (config->themeGeneration != _themeGeneration)
   {
-    temp = (temp - 32.0) * 5.0 / 9.0;
-    unit = "C";
+    _themeGeneration = config->themeGeneration;
+    const Theme &theme = config->theme;
+
+    _bgColor = theme.background;
+    _dataLayer.setBackground(_bgColor);
+    _statusLayer.setBackground(_bgColor);
+
+    // Use Forecast color for the grid as it is part of the weather info
+    uint16_t forecastColor = theme.weatherForecast;
+    _temp.setColor(theme.weatherTemp);
+    _location.setColor(forecastColor);
+    _condition.setColor(forecastColor);
+    _feelsLikeLabel.setColor(forecastColor);
+    _feelsLike.setColor(forecastColor);
+    _humidityLabel.setColor(forecastColor);
+    _humidity.setColor(forecastColor);
+    _windLabel.setColor(forecastColor);
+    _wind.setColor(forecastColor);
+    _rainLabel.setColor(forecastColor);
+    _rain.setColor(forecastColor);
+    _statusTitle.setColor(theme.errorText);
+    _statusDetail.setColor(theme.errorText);
   }
 
-  String tempStr = String(temp, 1);
-
-  tft.setTextColor(txtColor, bg);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextFont(7);
-
-  int yPos = tft.height() / 2 - 75;
-  tft.drawString(tempStr, tft.width() / 2, yPos, 7);
-
-  int tempWidth = tft.textWidth(tempStr, 7);
-  int unitX = (tft.width() / 2) + (tempWidth / 2) + 8; // Padding
-
-  // Draw degree circle manually to match WeatherClockPage style
-  int circleRadius = 3;
-  int degreeX = unitX - circleRadius;
-  int degreeY = yPos - 20;
+  _celsius = config->useCelsius;
+  _weatherGeneration = UINT32_MAX; // Re-apply the weather in the new units.
+  const char *unit = _celsius ? "C" : "F";
+  _temp.setUnit(unit, true, 5);
+  _feelsLike.setUnit(unit, true, 2);
+  _wind.setUnit(_celsius ? "km/h" : "mph", false, 6);
 
-  tft.fillCircle(degreeX, degreeY, circleRadius, txtColor);
-
-  // Draw Unit Text
-  int unitTextX = degreeX + circleRadius + 4;
-  int unitTextY = yPos - 25;
-
-  tft.setTextFont(4);
-  tft.setTextDatum(TL_DATUM);
-  tft.drawString(unit, unitTextX, unitTextY, 4);
-
-  // Condition
-  tft.setTextFont(4);
-  tft.setTextDatum(MC_DATUM); // Reset datum to center
-  tft.setTextColor(hexToRGB565(ConfigManager::getInstance().getWeatherForecastColor()), bg);
-
-  String condition = data.condition;
-  tft.drawString(condition, tft.width() / 2, yPos + 55, 4);
-
-  // Extended Data Grid
-  // Use Forecast color for these labels too as they are part of weather info
-  tft.setTextColor(hexToRGB565(ConfigManager::getInstance().getWeatherForecastColor()), bg);
-
-  int gridY = yPos + 95;
-  int leftColX = tft.width() / 4;
-  int rightColX = tft.width() * 3 / 4;
-  int rowSpacing = 55;
+  _location.setText(config->address);
+  _statusDetail.setText(config->address[0] == '\0' ? "Set Address" : "Updating...");
+}
 
+void WeatherPage::applyWeather(const WeatherData &data)
+{
+  float temp = data.temp;
   float feelsLike = data.feelsLike;
   float windSpeed = data.windSpeed;
-  String windUnit = "mph";
-  if (ConfigManager::getInstance().isCelsius())
+  if (_celsius)
   {
+    temp = (temp - 32.0) * 5.0 / 9.0;
     feelsLike = (feelsLike - 32.0) * 5.0 / 9.0;
     windSpeed = windSpeed * 1.60934;
-    windUnit = "km/h";
   }
 
-  // Row 1: Feels Like & Humidity
-  tft.setTextDatum(MC_DATUM);
-  tft.drawString("Feels Like", leftColX, gridY, 4);
-
-  // Stylized "Feels Like" with separated unit
-  String feelsLikeStr = String(feelsLike, 1);
-  int valWidth = tft.textWidth(feelsLikeStr, 4);
-  int unitWidth = tft.textWidth(unit, 4);
-  int flCircleRadius = 2;
-  int space = 2;
-  int totalWidth = valWidth + space + (flCircleRadius * 2) + space + unitWidth;
-
-  int startX = leftColX - (totalWidth / 2);
-  int centerY = gridY + 25;
-  int topY = centerY - (tft.fontHeight(4) / 2);
-
-  tft.setTextDatum(TL_DATUM);
-  tft.drawString(feelsLikeStr, startX, topY, 4);
-
-  int flDegreeX = startX + valWidth + space + flCircleRadius;
-  int flDegreeY = topY + flCircleRadius;
-  tft.fillCircle(flDegreeX, flDegreeY, flCircleRadius, hexToRGB565(ConfigManager::getInstance().getWeatherForecastColor()));
-
-  tft.drawString(unit, flDegreeX + flCircleRadius + space, topY, 4);
-
-  tft.setTextDatum(MC_DATUM);
-  tft.drawString("Humidity", rightColX, gridY, 4);
-  tft.drawString(String(data.humidity, 0) + "%", rightColX, gridY + 25, 4);
-
-  // Row 2: Wind & Rain Chance
-  gridY += rowSpacing;
-
-  tft.drawString("Wind", leftColX, gridY, 4);
-  tft.drawString(String(windSpeed, 1) + " " + windUnit, leftColX, gridY + 25, 4);
-
-  tft.drawString("Rain Chance", rightColX, gridY, 4);
-  tft.drawString(String(data.rainChance) + "%", rightColX, gridY + 25, 4);
-
-  // Location
-  tft.setTextDatum(MC_DATUM);
-  tft.drawString(ConfigManager::getInstance().getAddress(), tft.width() / 2, 20, 2);
-
-  // Attribution
-  tft.setTextColor(tft.color565(100, 100, 100), bg); // Dim gray
-  tft.drawString("Weather data provided by open-meteo.com", tft.width() / 2, tft.height() - 15, 2);
+  _temp.setValue(temp, 1);
+  _condition.setText(WeatherService::getConditionFromWMO(data.weatherCode));
+  _feelsLike.setValue(feelsLike, 1);
+  _humidity.setValue(data.humidity, 0);
+  _wind.setValue(windSpeed, 1);
+  _rain.setValue(data.rainChance, 0);
 }
@@ -3,13 +3,21 @@
 #include "SerialLog.h"
 #include "TimeManager.h"
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
+#include "HttpsClient.h"
+#include "GeocodingCache.h"
+#include "OpenMeteoParser.h"
 #include <ArduinoJson.h>
 #include "LockGuard.h"
+#include "Constants.h"
+#include <LittleFS.h>
 #include <esp_task_wdt.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <new>
 
 static const unsigned long WEATHER_UPDATE_INTERVAL = 10 * 60 * 1000; // 10 minutes
+static const int WEATHER_CACHE_VERSION = 2;
+static const float WEATHER_CACHE_LOCATION_TOLERANCE = 0.01f; // Degrees, about a kilometre
 
 // Helper to convert WMO Weather Codes to String Condition
 const char *WeatherService::getConditionFromWMO(int code)
@@ -112,6 +120,9 @@ WeatherService::WeatherService() : _lastUpdate(0), _weatherTaskHandle(NULL)
 /**
  * @brief Creates the persistent weather task. Called once at boot.
  *
+ * The weather cached by the last fetch is loaded first, so pages have data
+ * from the first frame while the task waits for WiFi and fetches afresh.
+ *
  * The task runs forever on Core 0, sleeping on a binary semaphore between
  * updates. This avoids the heap fragmentation caused by repeatedly creating
  * and destroying a 32KB task every 10 minutes.
@@ -120,7 +131,21 @@ void WeatherService::begin()
 {
   _geocodingResult.pending = false;
   _geocodingResult.success = false;
-  
+  GeocodingCache::getInstance().begin();
+  loadCache();
+
+  // The published forecast and the one being parsed live side by side in PSRAM.
+  void *block = ps_malloc(2 * sizeof(WeatherForecast));
+  if (block != nullptr)
+  {
+    _forecast = new (block) WeatherForecast();
+    _forecastScratch = new (_forecast + 1) WeatherForecast();
+  }
+  else
+  {
+    LOG_W(LOG_MODULE_WEATHER, "Weather: no PSRAM for the forecast, fetching current weather only.\n");
+  }
+
   xTaskCreatePinnedToCore(
       weatherTaskEntry,    // Persistent task entry point
       "WeatherUpdate",     // Name of the task
@@ -130,7 +155,7 @@ void WeatherService::begin()
       &_weatherTaskHandle, // Task handle
       0                    // Core 0
   );
-  SerialLog::getInstance().print("Weather task created (persistent).\n");
+  LOG_D(LOG_MODULE_WEATHER, "Weather task created (persistent).\n");
 }
 
 /**
@@ -168,7 +193,7 @@ void WeatherService::weatherTaskEntry(void *parameter)
       }
       if (attempt == 0)
       {
-        SerialLog::getInstance().print("Weather task: WiFi not ready, waiting...\n");
+        LOG_D(LOG_MODULE_WEATHER, "Weather task: WiFi not ready, waiting...\n");
       }
       vTaskDelay(WIFI_RETRY_DELAY);
       esp_task_wdt_reset(); // Keep WDT happy during the wait
@@ -188,16 +213,19 @@ void WeatherService::weatherTaskEntry(void *parameter)
       }
 
       if (hasGeocoding) {
-          SerialLog::getInstance().printf("Weather task: processing geocoding for '%s'\n", query.c_str());
+          LOG_D(LOG_MODULE_WEATHER, "Weather task: processing geocoding for '%s'\n", query.c_str());
           String resolved;
           float lat = 0.0f, lon = 0.0f;
           bool success = service->resolveLocation(query, resolved, lat, lon);
 
           if (success) {
-              ConfigManager::getInstance().setAddress(resolved);
-              ConfigManager::getInstance().setLat(lat);
-              ConfigManager::getInstance().setLon(lon);
-              SerialLog::getInstance().printf("Weather task: location saved: %s (%.4f, %.4f)\n", resolved.c_str(), lat, lon);
+              {
+                  ConfigManager::Transaction transaction(ConfigManager::getInstance());
+                  ConfigManager::getInstance().setAddress(resolved);
+                  ConfigManager::getInstance().setLat(lat);
+                  ConfigManager::getInstance().setLon(lon);
+              }
+              LOG_I(LOG_MODULE_WEATHER, "Weather task: location saved: %s (%.4f, %.4f)\n", resolved.c_str(), lat, lon);
           }
 
           {
@@ -207,17 +235,18 @@ void WeatherService::weatherTaskEntry(void *parameter)
               service->_geocodingResult.lat = lat;
               service->_geocodingResult.lon = lon;
               service->_geocodingResult.pending = false;
+              service->_generation++;
           }
-          SerialLog::getInstance().printf("Weather task: geocoding %s\n", success ? "succeeded" : "failed");
+          LOG_I(LOG_MODULE_WEATHER, "Weather task: geocoding %s\n", success ? "succeeded" : "failed");
       }
 
       // 2. Regular weather update
-      SerialLog::getInstance().print("Weather task: starting weather update...\n");
+      LOG_D(LOG_MODULE_WEATHER, "Weather task: starting weather update...\n");
       service->updateWeather();
     }
     else
     {
-      SerialLog::getInstance().print("Weather task: WiFi unavailable after retries, skipping update.\n");
+      LOG_W(LOG_MODULE_WEATHER, "Weather task: WiFi unavailable after retries, skipping update.\n");
     }
 
     // Always unenroll from WDT before going back to sleep — the task may sleep
@@ -235,6 +264,15 @@ void WeatherService::weatherTaskEntry(void *parameter)
  */
 void WeatherService::loop()
 {
+  // Cached weather stands in until the first fetch, but not forever.
+  WeatherData current = getCurrentWeather();
+  auto &timeManager = TimeManager::getInstance();
+  if (current.isValid && current.isStale && timeManager.isTimeSet() &&
+      timeManager.getRTCTime().unixtime() - current.fetchedAt > WEATHER_CACHE_MAX_AGE && dropStaleWeather())
+  {
+    LOG_W(LOG_MODULE_WEATHER, "Weather: cached weather too old, dropped.\n");
+  }
+
   if (WiFi.status() != WL_CONNECTED)
     return;
 
@@ -264,10 +302,227 @@ String WeatherService::getWindDirectionStr(int degrees)
   return directions[index];
 }
 
+uint32_t WeatherService::getGeneration() const
+{
+  LockGuard lock(_mutex);
+  return _generation;
+}
+
+/**
+ * @brief Copies the current weather under the seqlock.
+ *
+ * The copy is retried if a write started or finished while it was taken.
+ * Writes run in a critical section and take well under a microsecond, so a
+ * retry is rare and short.
+ * @return The current weather.
+ */
 WeatherData WeatherService::getCurrentWeather() const
+{
+  WeatherData data;
+  uint32_t seq;
+  do
+  {
+    seq = _weatherSeq.load(std::memory_order_acquire);
+    data = _currentWeather;
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) != 0 || seq != _weatherSeq.load(std::memory_order_relaxed));
+  return data;
+}
+
+/**
+ * @brief Replaces the current weather, stamping it with the next generation.
+ * @param data The new weather.
+ */
+void WeatherService::publishWeather(const WeatherData &data)
+{
+  portENTER_CRITICAL(&_weatherMux);
+  uint32_t seq = _weatherSeq.load(std::memory_order_relaxed);
+  _weatherSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  _currentWeather = data;
+  _currentWeather.generation = (seq + 2) / 2;
+  _weatherSeq.store(seq + 2, std::memory_order_release);
+  portEXIT_CRITICAL(&_weatherMux);
+
+  LockGuard lock(_mutex);
+  _generation++;
+}
+
+/**
+ * @brief Copies the forecast, under a seqlock like `getCurrentWeather()`.
+ * @param forecast Receives the forecast.
+ * @return False if there is no forecast yet.
+ */
+bool WeatherService::getForecast(WeatherForecast &forecast) const
+{
+  if (_forecast == nullptr)
+  {
+    return false;
+  }
+  uint32_t seq;
+  do
+  {
+    seq = _forecastSeq.load(std::memory_order_acquire);
+    forecast = *_forecast;
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) != 0 || seq != _forecastSeq.load(std::memory_order_relaxed));
+  return forecast.hourCount > 0 || forecast.dayCount > 0;
+}
+
+/**
+ * @brief Replaces the forecast with the one just parsed into `_forecastScratch`.
+ */
+void WeatherService::publishForecast()
+{
+  portENTER_CRITICAL(&_weatherMux);
+  uint32_t seq = _forecastSeq.load(std::memory_order_relaxed);
+  _forecastSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  *_forecast = *_forecastScratch;
+  _forecast->generation = (seq + 2) / 2;
+  _forecastSeq.store(seq + 2, std::memory_order_release);
+  portEXIT_CRITICAL(&_weatherMux);
+}
+
+/**
+ * @brief Gets the fetch counters and the heap the latest fetch took.
+ * @return The counters.
+ */
+WeatherFetchStats WeatherService::getFetchStats() const
 {
   LockGuard lock(_mutex);
-  return _currentWeather;
+  return _fetchStats;
+}
+
+/**
+ * @brief Marks the current weather invalid if it is still the stale cached copy.
+ *
+ * The check is made inside the write, so a fetch that has just replaced the
+ * cached copy is never dropped.
+ * @return True if it was dropped.
+ */
+bool WeatherService::dropStaleWeather()
+{
+  bool dropped = false;
+  portENTER_CRITICAL(&_weatherMux);
+  if (_currentWeather.isValid && _currentWeather.isStale)
+  {
+    uint32_t seq = _weatherSeq.load(std::memory_order_relaxed);
+    _weatherSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _currentWeather.isValid = false;
+    _currentWeather.generation = (seq + 2) / 2;
+    _weatherSeq.store(seq + 2, std::memory_order_release);
+    dropped = true;
+  }
+  portEXIT_CRITICAL(&_weatherMux);
+
+  if (dropped)
+  {
+    LockGuard lock(_mutex);
+    _generation++;
+  }
+  return dropped;
+}
+
+/**
+ * @brief Loads the weather saved by the last successful fetch, marked stale.
+ *
+ * The cache is only used if it was fetched for the configured location.
+ */
+void WeatherService::loadCache()
+{
+  File file = LittleFS.open(WEATHER_CACHE_PATH, "r");
+  if (!file)
+  {
+    return;
+  }
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+  if (error || (doc["v"] | 0) != WEATHER_CACHE_VERSION)
+  {
+    LOG_W(LOG_MODULE_WEATHER, "Weather: cache unreadable, ignored.\n");
+    return;
+  }
+
+  float lat = doc["lat"] | 0.0f;
+  float lon = doc["lon"] | 0.0f;
+  if (fabsf(lat - ConfigManager::getInstance().getLat()) > WEATHER_CACHE_LOCATION_TOLERANCE ||
+      fabsf(lon - ConfigManager::getInstance().getLon()) > WEATHER_CACHE_LOCATION_TOLERANCE)
+  {
+    LOG_W(LOG_MODULE_WEATHER, "Weather: cache is for another location, ignored.\n");
+    return;
+  }
+
+  WeatherData data;
+  data.temp = doc["temp"] | 0.0f;
+  data.feelsLike = doc["feelsLike"] | 0.0f;
+  data.humidity = doc["humidity"] | 0.0f;
+  data.windSpeed = doc["windSpeed"] | 0.0f;
+  data.rainChance = doc["rainChance"] | 0;
+  data.weatherCode = doc["code"] | -1;
+  data.uvIndex = doc["uvIndex"] | 0.0f;
+  data.cloudCover = doc["cloudCover"] | 0;
+  data.pressure = doc["pressure"] | 0.0f;
+  data.visibility = doc["visibility"] | 0.0f;
+  data.windDirection = doc["windDirection"] | 0;
+  data.windGusts = doc["windGusts"] | 0.0f;
+  data.sunriseMinutes = doc["sunrise"] | -1;
+  data.sunsetMinutes = doc["sunset"] | -1;
+  data.fetchedAt = doc["fetchedAt"] | 0;
+  data.isValid = true;
+  data.isStale = true;
+
+  publishWeather(data);
+  LOG_I(LOG_MODULE_WEATHER, "Weather: loaded cached weather fetched at %u.\n", data.fetchedAt);
+}
+
+/**
+ * @brief Saves the weather so it can be shown straight after the next boot.
+ *
+ * The file is written under a temporary name and renamed over the old one,
+ * so a reset mid-write leaves the previous cache intact.
+ * @param data The weather just fetched.
+ * @param lat The latitude it was fetched for.
+ * @param lon The longitude it was fetched for.
+ */
+void WeatherService::saveCache(const WeatherData &data, float lat, float lon)
+{
+  JsonDocument doc;
+  doc["v"] = WEATHER_CACHE_VERSION;
+  doc["lat"] = lat;
+  doc["lon"] = lon;
+  doc["fetchedAt"] = data.fetchedAt;
+  doc["temp"] = data.temp;
+  doc["feelsLike"] = data.feelsLike;
+  doc["humidity"] = data.humidity;
+  doc["windSpeed"] = data.windSpeed;
+  doc["rainChance"] = data.rainChance;
+  doc["code"] = data.weatherCode;
+  doc["uvIndex"] = data.uvIndex;
+  doc["cloudCover"] = data.cloudCover;
+  doc["pressure"] = data.pressure;
+  doc["visibility"] = data.visibility;
+  doc["windDirection"] = data.windDirection;
+  doc["windGusts"] = data.windGusts;
+  doc["sunrise"] = data.sunriseMinutes;
+  doc["sunset"] = data.sunsetMinutes;
+
+  static const char *TEMP_PATH = WEATHER_CACHE_PATH ".tmp";
+  File file = LittleFS.open(TEMP_PATH, "w");
+  if (!file)
+  {
+    LOG_E(LOG_MODULE_WEATHER, "Weather: cannot write the cache.\n");
+    return;
+  }
+  bool written = serializeJson(doc, file) > 0;
+  file.close();
+  if (!written || !LittleFS.rename(TEMP_PATH, WEATHER_CACHE_PATH))
+  {
+    LittleFS.remove(TEMP_PATH);
+    LOG_E(LOG_MODULE_WEATHER, "Weather: cannot write the cache.\n");
+  }
 }
 
 struct StateMap
@@ -279,36 +534,93 @@ struct StateMap
 const StateMap US_STATES[] = {
     {"alabama", "al"}, {"alaska", "ak"}, {"arizona", "az"}, {"arkansas", "ar"}, {"california", "ca"}, {"colorado", "co"}, {"connecticut", "ct"}, {"delaware", "de"}, {"florida", "fl"}, {"georgia", "ga"}, {"hawaii", "hi"}, {"idaho", "id"}, {"illinois", "il"}, {"indiana", "in"}, {"iowa", "ia"}, {"kansas", "ks"}, {"kentucky", "ky"}, {"louisiana", "la"}, {"maine", "me"}, {"maryland", "md"}, {"massachusetts", "ma"}, {"michigan", "mi"}, {"minnesota", "mn"}, {"mississippi", "ms"}, {"missouri", "mo"}, {"montana", "mt"}, {"nebraska", "ne"}, {"nevada", "nv"}, {"new hampshire", "nh"}, {"new jersey", "nj"}, {"new mexico", "nm"}, {"new york", "ny"}, {"north carolina", "nc"}, {"north dakota", "nd"}, {"ohio", "oh"}, {"oklahoma", "ok"}, {"oregon", "or"}, {"pennsylvania", "pa"}, {"rhode island", "ri"}, {"south carolina", "sc"}, {"south dakota", "sd"}, {"tennessee", "tn"}, {"texas", "tx"}, {"utah", "ut"}, {"vermont", "vt"}, {"virginia", "va"}, {"washington", "wa"}, {"west virginia", "wv"}, {"wisconsin", "wi"}, {"wyoming", "wy"}, {"district of columbia", "dc"}};
 
-// Check if a word exists in text as a whole word
-bool checkWordPresence(const String &text, const String &word)
+/**
+ * @brief Finds a string in another, ignoring case.
+ * @param text The text to search.
+ * @param word The string to look for.
+ * @param wholeWord Whether the match must not touch a letter or digit on either side.
+ * @return True if found.
+ */
+static bool containsIgnoreCase(const char *text, const char *word, bool wholeWord)
 {
-  int index = -1;
-  while ((index = text.indexOf(word, index + 1)) != -1)
+  size_t wordLength = strlen(word);
+  if (wordLength == 0)
+  {
+    return false;
+  }
+  for (const char *at = text; *at != '\0'; at++)
   {
-    bool startOk = (index == 0) || !isAlphaNumeric(text.charAt(index - 1));
-    bool endOk = (index + word.length() == text.length()) || !isAlphaNumeric(text.charAt(index + word.length()));
+    if (strncasecmp(at, word, wordLength) != 0)
+    {
+      continue;
+    }
+    if (!wholeWord)
+    {
+      return true;
+    }
+    bool startOk = (at == text) || !isAlphaNumeric(at[-1]);
+    bool endOk = !isAlphaNumeric(at[wordLength]);
     if (startOk && endOk)
+    {
       return true;
+    }
   }
   return false;
 }
 
-// Helper function for the search logic
-bool performGeocodingSearch(String url, String context, String &resolvedAddress, float &lat, float &lon)
+/**
+ * @brief Scores how well a geocoding result matches the rest of the query.
+ *
+ * Reads the fields in place from the response document, so scoring a page
+ * of results allocates nothing.
+ * @param result One entry of the response's `results`.
+ * @param context The full query, e.g. "Paris, Texas" or "Paris, TX".
+ * @return 10 for a matching state or region (name or US abbreviation), plus 1 for a matching country.
+ */
+static int scoreGeocodingResult(JsonObjectConst result, const char *context)
 {
-  HTTPClient http;
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(15);  // 15s cap on TLS handshake (seconds)
+  const char *country = result["country"] | "";
+  const char *countryCode = result["country_code"] | "";
+  const char *admin1 = result["admin1"] | "";
+
+  int score = 0;
+
+  // Direct matches
+  if (containsIgnoreCase(context, admin1, false))
+  {
+    score += 10;
+  }
+  if (containsIgnoreCase(context, country, false))
+  {
+    score += 1;
+  }
 
-  SerialLog::getInstance().printf("Resolving Location: %s\n", url.c_str());
+  // Abbreviation match for US
+  if (strcmp(countryCode, "US") == 0 && admin1[0] != '\0')
+  {
+    for (const auto &state : US_STATES)
+    {
+      if (strcasecmp(admin1, state.name) == 0)
+      {
+        if (containsIgnoreCase(context, state.code, true))
+        {
+          score += 10;
+        }
+        break;
+      }
+    }
+  }
+  return score;
+}
 
-  http.begin(client, url);
-  http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-  http.useHTTP10(true);    // Disable chunked transfer encoding for stream safety
-  http.setTimeout(15000);  // 15s HTTP timeout — well under the 30s WDT
+// Helper function for the search logic
+bool performGeocodingSearch(const String &url, const String &context, String &resolvedAddress, float &lat, float &lon)
+{
+  LOG_D(LOG_MODULE_WEATHER, "Resolving Location: %s\n", url.c_str());
 
-  int httpCode = http.GET();
+  // Fallback searches come back-to-back and share one TLS connection.
+  HttpsClient::Request request(HTTPS_HOST_GEOCODING);
+  int httpCode = request.get(url);
   bool success = false;
 
   if (httpCode == 200)
@@ -322,59 +634,28 @@ bool performGeocodingSearch(String url, String context, String &resolvedAddress,
     filter["results"][0]["country_code"] = true;
     filter["results"][0]["admin1"] = true;
 
+    // A kept-alive response may be chunked, which HTTPClient only decodes
+    // when it reads the body itself.
+    String body = request.http().getString();
+    request.end();
+
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(filter));
+    DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
 
     if (!error)
     {
-      JsonArray results = doc["results"];
+      JsonArrayConst results = doc["results"];
       if (results.size() > 0)
       {
-        int bestIndex = 0;
+        size_t bestIndex = 0;
 
         // If we have a context string (e.g. "Paris, Texas"), try to find the best scoring match
         if (context.length() > 0)
         {
-          String contextLower = context;
-          contextLower.toLowerCase();
           int maxScore = -1;
-
           for (size_t i = 0; i < results.size(); i++)
           {
-            String country = results[i]["country"].as<String>();
-            String countryCode = results[i]["country_code"].as<String>();
-            String admin1 = results[i]["admin1"].as<String>();
-            country.toLowerCase();
-            admin1.toLowerCase();
-
-            int score = 0;
-
-            // Direct matches
-            if (admin1.length() > 0 && contextLower.indexOf(admin1) != -1)
-            {
-              score += 10;
-            }
-            if (country.length() > 0 && contextLower.indexOf(country) != -1)
-            {
-              score += 1;
-            }
-
-            // Abbreviation match for US
-            if (countryCode == "US" && admin1.length() > 0)
-            {
-              for (const auto &state : US_STATES)
-              {
-                if (admin1 == state.name)
-                {
-                  if (checkWordPresence(contextLower, state.code))
-                  {
-                    score += 10;
-                  }
-                  break;
-                }
-              }
-            }
-
+            int score = scoreGeocodingResult(results[i].as<JsonObjectConst>(), context.c_str());
             if (score > maxScore)
             {
               maxScore = score;
@@ -383,56 +664,93 @@ bool performGeocodingSearch(String url, String context, String &resolvedAddress,
           }
           if (maxScore > 0)
           {
-            SerialLog::getInstance().printf("Best context match at index %d (Score: %d)\n", bestIndex, maxScore);
+            LOG_D(LOG_MODULE_WEATHER, "Best context match at index %u (Score: %d)\n", (unsigned)bestIndex, maxScore);
           }
         }
 
-        lat = results[bestIndex]["latitude"];
-        lon = results[bestIndex]["longitude"];
+        JsonObjectConst best = results[bestIndex].as<JsonObjectConst>();
+        lat = best["latitude"];
+        lon = best["longitude"];
 
-        String name = results[bestIndex]["name"].as<String>();
-        String country = results[bestIndex]["country"].as<String>();
-        String admin1 = results[bestIndex]["admin1"].as<String>();
+        const char *name = best["name"] | "";
+        const char *country = best["country"] | "";
+        const char *admin1 = best["admin1"] | "";
 
-        resolvedAddress = name;
-        if (admin1.length() > 0 && admin1 != name)
-          resolvedAddress += ", " + admin1;
-        if (country.length() > 0)
-          resolvedAddress += ", " + country;
+        char address[128];
+        int length = snprintf(address, sizeof(address), "%s", name);
+        if (admin1[0] != '\0' && strcmp(admin1, name) != 0 && length < (int)sizeof(address))
+          length += snprintf(address + length, sizeof(address) - length, ", %s", admin1);
+        if (country[0] != '\0' && length < (int)sizeof(address))
+          snprintf(address + length, sizeof(address) - length, ", %s", country);
+        resolvedAddress = address;
 
         success = true;
-        SerialLog::getInstance().printf("Found: %s (%.4f, %.4f)\n", resolvedAddress.c_str(), lat, lon);
+        LOG_D(LOG_MODULE_WEATHER, "Found: %s (%.4f, %.4f)\n", resolvedAddress.c_str(), lat, lon);
       }
       else
       {
-        SerialLog::getInstance().print("No results in Geocoding response.\n");
+        LOG_W(LOG_MODULE_WEATHER, "No results in Geocoding response.\n");
       }
     }
     else
     {
-      SerialLog::getInstance().printf("JSON Error: %s\n", error.c_str());
+      LOG_E(LOG_MODULE_WEATHER, "JSON Error: %s\n", error.c_str());
     }
   }
   else
   {
-    SerialLog::getInstance().printf("Geocoding HTTP Failed: %d\n", httpCode);
+    LOG_E(LOG_MODULE_WEATHER, "Geocoding HTTP Failed: %d\n", httpCode);
   }
-  http.end();
   return success;
 }
 
 bool WeatherService::resolveLocationAsync(const String &query)
 {
-  if (WiFi.status() != WL_CONNECTED || query.length() == 0)
+  if (query.length() == 0)
+    return false;
+
+  {
+    LockGuard lock(_mutex);
+    if (_geocodingResult.pending)
+      return false; // Already pending
+  }
+
+  // A location resolved before completes here, without touching the network.
+  String resolved;
+  float lat, lon;
+  if (GeocodingCache::getInstance().lookup(query, resolved, lat, lon))
+  {
+    {
+      ConfigManager::Transaction transaction(ConfigManager::getInstance());
+      ConfigManager::getInstance().setAddress(resolved);
+      ConfigManager::getInstance().setLat(lat);
+      ConfigManager::getInstance().setLon(lon);
+    }
+    {
+      LockGuard lock(_mutex);
+      _geocodingResult.success = true;
+      _geocodingResult.resolvedAddress = resolved;
+      _geocodingResult.lat = lat;
+      _geocodingResult.lon = lon;
+      _geocodingResult.pending = false;
+      _generation++;
+    }
+    LOG_D(LOG_MODULE_WEATHER, "Location '%s' found in the geocoding cache: %s\n", query.c_str(), resolved.c_str());
+    forceUpdate();
+    return true;
+  }
+
+  if (WiFi.status() != WL_CONNECTED)
     return false;
 
   LockGuard lock(_mutex);
   if (_geocodingResult.pending)
-    return false; // Already pending
+    return false; // Queued by another caller meanwhile
 
   _geocodingQuery = query;
   _geocodingResult.pending = true;
   _geocodingResult.success = false;
+  _generation++;
 
   // Wake the background task
   xSemaphoreGive(_wakeSignal);
@@ -448,13 +766,24 @@ WeatherService::GeocodingResult WeatherService::getGeocodingResult()
 // Internal worker called by updateLocation() or geocoding task logic
 bool WeatherService::resolveLocation(const String &query, String &resolvedAddress, float &lat, float &lon)
 {
-  if (WiFi.status() != WL_CONNECTED || query.length() == 0)
+  if (query.length() == 0)
+    return false;
+
+  GeocodingCache &cache = GeocodingCache::getInstance();
+  if (cache.lookup(query, resolvedAddress, lat, lon))
+  {
+    LOG_D(LOG_MODULE_WEATHER, "Location '%s' found in the geocoding cache.\n", query.c_str());
+    return true;
+  }
+
+  if (WiFi.status() != WL_CONNECTED)
     return false;
 
   String url = "https://geocoding-api.open-meteo.com/v1/search?name=" + urlEncode(query) + "&count=1&language=en&format=json";
 
   if (performGeocodingSearch(url, "", resolvedAddress, lat, lon))
   {
+    cache.store(query, resolvedAddress, lat, lon);
     return true;
   }
 
@@ -466,6 +795,7 @@ bool WeatherService::resolveLocation(const String &query, String &resolvedAddres
 
     if (performGeocodingSearch(url, query, resolvedAddress, lat, lon))
     {
+      cache.store(query, resolvedAddress, lat, lon);
       return true;
     }
   }
@@ -479,21 +809,24 @@ void WeatherService::updateLocation()
   if (address.length() == 0)
     return;
 
-  SerialLog::getInstance().printf("Updating location for: %s\n", address.c_str());
+  LOG_I(LOG_MODULE_WEATHER, "Updating location for: %s\n", address.c_str());
 
   String resolved;
   float lat, lon;
 
   if (resolveLocation(address, resolved, lat, lon))
   {
-    ConfigManager::getInstance().setLat(lat);
-    ConfigManager::getInstance().setLon(lon);
-    SerialLog::getInstance().printf("Location resolved: %s (%.4f, %.4f)\n", resolved.c_str(), lat, lon);
+    {
+      ConfigManager::Transaction transaction(ConfigManager::getInstance());
+      ConfigManager::getInstance().setLat(lat);
+      ConfigManager::getInstance().setLon(lon);
+    }
+    LOG_I(LOG_MODULE_WEATHER, "Location resolved: %s (%.4f, %.4f)\n", resolved.c_str(), lat, lon);
     updateWeather();
   }
   else
   {
-    SerialLog::getInstance().print("Failed to resolve location.\n");
+    LOG_E(LOG_MODULE_WEATHER, "Failed to resolve location.\n");
   }
 }
 
@@ -517,126 +850,71 @@ void WeatherService::updateWeather()
   }
 
   // Fetch from Open-Meteo
-  HTTPClient http;
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(15);  // 15s cap on TLS handshake (seconds)
-
   // Use reserve to prevent reallocations
   String url;
-  url.reserve(400); 
+  url.reserve(640);
 
   url = "https://api.open-meteo.com/v1/forecast?latitude=";
   url += String(lat, 4);
-  url += "&longitude=";;
+  url += "&longitude=";
   url += String(lon, 4);
-  url += "&current=temperature_2m,relative_humidity_2m,apparent_temperature,weather_code,wind_speed_10m,cloud_cover,pressure_msl,wind_direction_10m,wind_gusts_10m,uv_index,visibility,precipitation_probability&daily=sunrise,sunset&temperature_unit=fahrenheit&wind_speed_unit=mph&precipitation_unit=inch&forecast_days=1&timezone=auto";
-
-  SerialLog::getInstance().printf("Fetching Weather: %s\n", url.c_str());
-  SerialLog::getInstance().printf("Free Heap before Weather Update: %u\n", ESP.getFreeHeap());
-
-  http.begin(client, url);
-  http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS); // Good practice
-  http.useHTTP10(true);                                  // Disable chunked transfer encoding for stream safety
-  http.setTimeout(15000);                                // 15s HTTP timeout — well under the 30s WDT
-  int httpCode = http.GET();
-
-  if (httpCode == 200)
+  url += "&current=temperature_2m,relative_humidity_2m,apparent_temperature,weather_code,wind_speed_10m,cloud_cover,pressure_msl,wind_direction_10m,wind_gusts_10m,uv_index,visibility,precipitation_probability";
+  url += "&hourly=temperature_2m,precipitation_probability,weather_code&forecast_hours=24";
+  url += "&daily=sunrise,sunset,temperature_2m_max,temperature_2m_min,precipitation_probability_max,weather_code&forecast_days=5";
+  url += "&temperature_unit=fahrenheit&wind_speed_unit=mph&precipitation_unit=inch&timezone=auto";
+
+  LOG_D(LOG_MODULE_WEATHER, "Fetching Weather: %s\n", url.c_str());
+  size_t freeBefore = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  int64_t start = esp_timer_get_time();
+
+  HttpsClient::Request request(HTTPS_HOST_WEATHER);
+  int httpCode = request.get(url);
+  if (httpCode != 200)
   {
-    JsonDocument doc;
-
-    // Filter to reduce memory usage
-    JsonDocument filter;
-    filter["current"]["temperature_2m"] = true;
-    filter["current"]["apparent_temperature"] = true;
-    filter["current"]["relative_humidity_2m"] = true;
-    filter["current"]["wind_speed_10m"] = true;
-    filter["current"]["weather_code"] = true;
-
-    filter["current"]["cloud_cover"] = true;
-    filter["current"]["pressure_msl"] = true;
-    filter["current"]["wind_direction_10m"] = true;
-    filter["current"]["wind_gusts_10m"] = true;
-
-    filter["current"]["uv_index"] = true;
-    filter["current"]["visibility"] = true;
-    filter["current"]["precipitation_probability"] = true;
-
-    filter["daily"]["sunrise"] = true;
-    filter["daily"]["sunset"] = true;
-
-    DeserializationError error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(filter));
-
-    if (!error)
-    {
-      float temp = doc["current"]["temperature_2m"];
-      float feelsLike = doc["current"]["apparent_temperature"];
-      float humidity = doc["current"]["relative_humidity_2m"];
-      float windSpeed = doc["current"]["wind_speed_10m"];
-      int code = doc["current"]["weather_code"];
-
-      int cloudCover = doc["current"]["cloud_cover"] | 0;
-      float pressure = doc["current"]["pressure_msl"] | 0.0;
-      int windDirection = doc["current"]["wind_direction_10m"] | 0;
-      float windGusts = doc["current"]["wind_gusts_10m"] | 0.0;
-
-      int rainChance = doc["current"]["precipitation_probability"] | 0;
-      float uvIndex = doc["current"]["uv_index"] | 0.0;
-      float visibility = doc["current"]["visibility"] | 0.0;
-
-      String sunrise = "";
-      String sunset = "";
-      if (!doc["daily"]["sunrise"].isNull() && doc["daily"]["sunrise"].size() > 0)
-      {
-        String raw = doc["daily"]["sunrise"][0].as<String>();
-        int tIndex = raw.indexOf('T');
-        if (tIndex != -1)
-          sunrise = raw.substring(tIndex + 1);
-        else
-          sunrise = raw;
-      }
-      if (!doc["daily"]["sunset"].isNull() && doc["daily"]["sunset"].size() > 0)
-      {
-        String raw = doc["daily"]["sunset"][0].as<String>();
-        int tIndex = raw.indexOf('T');
-        if (tIndex != -1)
-          sunset = raw.substring(tIndex + 1);
-        else
-          sunset = raw;
-      }
+    LOG_E(LOG_MODULE_WEATHER, "Weather HTTP Failed: %d\n", httpCode);
+    return;
+  }
 
-      {
-        LockGuard lock(_mutex);
-        _currentWeather.temp = temp;
-        _currentWeather.feelsLike = feelsLike;
-        _currentWeather.humidity = humidity;
-        _currentWeather.windSpeed = windSpeed;
-        _currentWeather.rainChance = rainChance;
-        _currentWeather.condition = getConditionFromWMO(code);
-
-        _currentWeather.uvIndex = uvIndex;
-        _currentWeather.cloudCover = cloudCover;
-        _currentWeather.pressure = pressure;
-        _currentWeather.visibility = visibility;
-        _currentWeather.windDirection = windDirection;
-        _currentWeather.windGusts = windGusts;
-        _currentWeather.sunrise = sunrise;
-        _currentWeather.sunset = sunset;
-
-        _currentWeather.isValid = true;
-      }
+  // The body streams from the socket buffer into the parser, which writes
+  // the forecast straight into its PSRAM arrays.
+  WeatherData fetched;
+  OpenMeteoParser parser(fetched, _forecastScratch);
+  request.http().writeToStream(&parser);
+  request.end();
+  bool parsed = parser.finish();
 
-      SerialLog::getInstance().printf("Weather Updated: %.1fF, %s\n", temp, _currentWeather.condition.c_str());
-      SerialLog::getInstance().printf("Free Heap after Weather Update: %u\n", ESP.getFreeHeap());
-    }
-    else
+  uint32_t peakHeap = freeBefore > parser.minFreeHeap() ? freeBefore - parser.minFreeHeap() : 0;
+  uint32_t elapsedMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+  {
+    LockGuard lock(_mutex);
+    _fetchStats.fetches++;
+    _fetchStats.parseFailures += parsed ? 0 : 1;
+    _fetchStats.lastBytes = parser.bytes();
+    _fetchStats.lastMs = elapsedMs;
+    _fetchStats.lastPeakHeap = peakHeap;
+    if (peakHeap > _fetchStats.maxPeakHeap)
     {
-      SerialLog::getInstance().printf("JSON Error: %s\n", error.c_str());
+      _fetchStats.maxPeakHeap = peakHeap;
     }
   }
-  else
+
+  if (!parsed)
+  {
+    LOG_E(LOG_MODULE_WEATHER, "Weather: response unreadable after %u bytes.\n", (unsigned)parser.bytes());
+    return;
+  }
+
+  fetched.fetchedAt = TimeManager::getInstance().isTimeSet() ? TimeManager::getInstance().getRTCTime().unixtime() : 0;
+  fetched.isValid = true;
+  fetched.isStale = false;
+  publishWeather(fetched);
+  if (_forecastScratch != nullptr)
   {
-    SerialLog::getInstance().printf("Weather HTTP Failed: %d\n", httpCode);
+    publishForecast();
   }
-  http.end();
+  saveCache(fetched, lat, lon);
+
+  LOG_I(LOG_MODULE_WEATHER, "Weather Updated: %.1fF, %s\n", fetched.temp, getConditionFromWMO(fetched.weatherCode));
+  LOG_I(LOG_MODULE_WEATHER, "Weather: %u bytes in %u ms, peak heap %u bytes\n",
+        (unsigned)parser.bytes(), (unsigned)elapsedMs, (unsigned)peakHeap);
 }
@@ -15,10 +15,14 @@
 #include <ArduinoJson.h>
 #include "SerialLog.h"
 #include "LockGuard.h"
+#include "Constants.h"
+#include <Preferences.h>
+#include <utility>
 
 // --- Static Member Initialization ---
 const char *WiFiManager::AP_SSID = "Clock-Setup";
 volatile bool WiFiManager::_connectionResult = false;
+static const uint8_t FAST_CONNECT_VERSION = 1;
 
 /**
  * @brief Static event handler for WiFi events.
@@ -33,7 +37,6 @@ volatile bool WiFiManager::_connectionResult = false;
  */
 void WiFiManager::wifiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info)
 {
-  auto &logger = SerialLog::getInstance();
   auto &instance = getInstance();
 
   // Protect shared state access in ISR context (technically task context in ESP32)
@@ -54,7 +57,7 @@ void WiFiManager::wifiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info)
       else
       {
         // If the flag is already false, this is a genuine failure.
-        logger.print("\nConnection test failed.\n");
+        LOG_W(LOG_MODULE_WIFI, "Connection test failed.\n");
         instance._testStatus = TEST_FAILED;
         if (instance.isCaptivePortal())
         {
@@ -64,7 +67,7 @@ void WiFiManager::wifiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info)
     }
     else if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
     {
-      logger.print("\nConnection test successful!\n");
+      LOG_I(LOG_MODULE_WIFI, "Connection test successful!\n");
       instance._testStatus = TEST_SUCCESS;
       instance._ignoreDisconnectEvent = false; // Reset flag on success, just in case.
 
@@ -82,8 +85,8 @@ void WiFiManager::wifiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info)
   // --- Standard Event Handling (for when not testing) ---
   if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
   {
-    logger.print("\nWiFi connected! Got IP.\n");
-    logger.printf("IP Address: %s\n", WiFi.localIP().toString().c_str());
+    LOG_I(LOG_MODULE_WIFI, "WiFi connected! Got IP.\n");
+    LOG_I(LOG_MODULE_WIFI, "IP Address: %s\n", WiFi.localIP().toString().c_str());
     // Set the flag to indicate a successful connection.
     _connectionResult = true;
 
@@ -92,7 +95,7 @@ void WiFiManager::wifiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info)
     auto &config = ConfigManager::getInstance();
     if (!config.areWifiCredsValid())
     {
-      logger.print("WiFi credentials validated. Saving flag.\n");
+      LOG_I(LOG_MODULE_WIFI, "WiFi credentials validated. Saving flag.\n");
       config.setWifiCredsValid(true);
       config.save();
     }
@@ -102,13 +105,13 @@ void WiFiManager::wifiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info)
     if (WiFi.isConnected())
     {
       WiFi.mode(WIFI_STA);
-      logger.print("Switched to STA mode. AP is now off.\n");
+      LOG_I(LOG_MODULE_WIFI, "Switched to STA mode. AP is now off.\n");
       ClockWebServer::getInstance().setupMDNS();
     }
   }
   else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
   {
-    logger.print("WiFi lost connection.\n");
+    LOG_W(LOG_MODULE_WIFI, "WiFi lost connection.\n");
     _connectionResult = false;
     // Set _isConnected to false directly, but don't trigger reconnection here.
     instance._isConnected = false;
@@ -151,6 +154,7 @@ void WiFiManager::handleConnection()
   // This is a robust way to handle missed events or state inconsistencies.
   // A true connection requires both a connected status and a valid IP address.
   bool isReallyConnected = (WiFi.status() == WL_CONNECTED && WiFi.localIP() != IPAddress(0, 0, 0, 0));
+  bool justConnected = false;
 
   {
     LockGuard lock(_mutex);
@@ -159,15 +163,16 @@ void WiFiManager::handleConnection()
       _isConnected = isReallyConnected;
       if (_isConnected)
       {
-        SerialLog::getInstance().print("WiFi connection state corrected to CONNECTED by polling.\n");
+        LOG_W(LOG_MODULE_WIFI, "WiFi connection state corrected to CONNECTED by polling.\n");
+        justConnected = true;
       }
       else
       {
-        SerialLog::getInstance().print("WiFi connection state corrected to DISCONNECTED by polling.\n");
+        LOG_W(LOG_MODULE_WIFI, "WiFi connection state corrected to DISCONNECTED by polling.\n");
       }
     }
 
-    if (_isConnected)
+    if (_isConnected && !justConnected)
     {
       if (_isReconnecting)
       {
@@ -177,6 +182,15 @@ void WiFiManager::handleConnection()
     }
   } // Release lock before potentially blocking operations
 
+  if (justConnected)
+  {
+    // A reconnect may have roamed to another access point or been given another lease.
+    saveFastConnect(ConfigManager::getInstance().getWifiSSID());
+    LockGuard lock(_mutex);
+    _isReconnecting = false;
+    return;
+  }
+
   if (ConfigManager::getInstance().getWifiSSID().length() == 0)
   {
     return;
@@ -192,7 +206,7 @@ void WiFiManager::handleConnection()
     {
       if (now - _lastReconnectAttempt > 15000) // 15s timeout
       {
-        SerialLog::getInstance().print("WiFi reconnection timed out.\n");
+        LOG_W(LOG_MODULE_WIFI, "WiFi reconnection timed out.\n");
         _isReconnecting = false;
       }
       return;
@@ -208,7 +222,7 @@ void WiFiManager::handleConnection()
 
   if (shouldReconnect)
   {
-    SerialLog::getInstance().print("Attempting to reconnect WiFi...\n");
+    LOG_I(LOG_MODULE_WIFI, "Attempting to reconnect WiFi...\n");
     WiFi.reconnect();
   }
 }
@@ -236,8 +250,10 @@ WiFiManager::WiFiManager() : _isConnected(false), _dnsServer(nullptr), _pendingR
  * @brief Initializes the WiFi module.
  *
  * Sets a unique hostname, then attempts to connect to the WiFi network using
- * credentials stored in the ConfigManager. If the SSID is not configured or
- * the connection fails, it launches a captive portal for configuration.
+ * credentials stored in the ConfigManager. The access point and channel of
+ * the last good connection are tried first, directly; a full scan follows
+ * only if that fails. If the SSID is not configured or the connection fails,
+ * it launches a captive portal for configuration.
  * It also provides visual feedback on the display during this process.
  *
  * @return True if the captive portal was started, false otherwise.
@@ -256,7 +272,7 @@ bool WiFiManager::begin()
   }
 
   WiFi.setHostname(_hostname.c_str());
-  SerialLog::getInstance().printf("Hostname set to: %s\n", _hostname.c_str());
+  LOG_D(LOG_MODULE_WIFI, "Hostname set to: %s\n", _hostname.c_str());
 
   // Register the event handler
   WiFi.onEvent(wifiEventHandler);
@@ -266,38 +282,70 @@ bool WiFiManager::begin()
   String ssid = ConfigManager::getInstance().getWifiSSID();
   String password = ConfigManager::getInstance().getWifiPassword();
   auto &display = Display::getInstance();
-  auto &logger = SerialLog::getInstance();
 
   if (ssid.length() > 0)
   {
-    logger.printf("WiFiManager: Attempting to connect to SSID: %s\n", ssid.c_str());
+    LOG_I(LOG_MODULE_WIFI, "WiFiManager: Attempting to connect to SSID: %s\n", ssid.c_str());
     display.drawStatusMessage("Connecting to WiFi...");
-    _connectionResult = false; // Reset the flag
-    WiFi.begin(ssid.c_str(), password.c_str());
-
     unsigned long startTime = millis();
-    while (!_connectionResult && millis() - startTime < 15000)
-    { // 15-second timeout
-      delay(100);
-      logger.print(".");
+    bool connected = false;
+    bool direct = false;
+
+    // Go straight to the access point that worked last time, on its channel,
+    // which skips the scan of every channel.
+    if (loadFastConnect(ssid))
+    {
+      const uint8_t *bssid = _fastConnect.bssid;
+      LOG_D(LOG_MODULE_WIFI, "WiFiManager: Trying %02X:%02X:%02X:%02X:%02X:%02X on channel %u\n",
+            bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], _fastConnect.channel);
+#if WIFI_REUSE_DHCP_LEASE
+      if (_fastConnect.ip != 0)
+      {
+        WiFi.config(IPAddress(_fastConnect.ip), IPAddress(_fastConnect.gateway),
+                    IPAddress(_fastConnect.subnet), IPAddress(_fastConnect.dns));
+      }
+#endif
+      _connectionResult = false; // Reset the flag
+      WiFi.begin(ssid.c_str(), password.c_str(), _fastConnect.channel, _fastConnect.bssid);
+      connected = direct = waitForConnection(WIFI_FAST_CONNECT_TIMEOUT);
+
+      if (!connected)
+      {
+        LOG_W(LOG_MODULE_WIFI, "WiFiManager: Direct connect failed, falling back to a full scan.\n");
+        WiFi.disconnect();
+#if WIFI_REUSE_DHCP_LEASE
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Back to DHCP.
+#endif
+      }
     }
 
-    if (_connectionResult)
+    if (!connected)
     {
-      logger.print("\nWiFiManager: Connection successful.\n");
-      LockGuard lock(_mutex);
-      _isConnected = true;
+      _connectionResult = false; // Reset the flag
+      WiFi.begin(ssid.c_str(), password.c_str());
+      connected = waitForConnection(WIFI_CONNECT_TIMEOUT);
+    }
+
+    if (connected)
+    {
+      LOG_I(LOG_MODULE_WIFI, "WiFiManager: Connection successful in %lu ms (%s), %lu ms after boot.\n",
+            millis() - startTime, direct ? "direct" : "full scan", millis());
+      saveFastConnect(ssid);
+      {
+        LockGuard lock(_mutex);
+        _isConnected = true;
+      }
       display.drawStatusMessage(("IP: " + WiFi.localIP().toString()).c_str());
       delay(2000);
     }
     else
     {
-      logger.print("\nWiFiManager: Connection failed after 15 seconds.\n");
+      LOG_E(LOG_MODULE_WIFI, "WiFiManager: Connection failed after %lu ms.\n", millis() - startTime);
     }
   }
   else
   {
-    logger.print("WiFiManager: No SSID configured.\n");
+    LOG_W(LOG_MODULE_WIFI, "WiFiManager: No SSID configured.\n");
   }
 
   bool currentlyConnected;
@@ -315,13 +363,13 @@ bool WiFiManager::begin()
     // Only start captive portal if credentials have not been validated before.
     if (!ConfigManager::getInstance().areWifiCredsValid())
     {
-      logger.print("WiFi credentials are not validated. Starting Captive Portal.\n");
+      LOG_W(LOG_MODULE_WIFI, "WiFi credentials are not validated. Starting Captive Portal.\n");
       startCaptivePortal();
       return true; // Captive portal was started
     }
     else
     {
-      logger.print("WiFi connection failed, but credentials are valid. Skipping captive portal.\n");
+      LOG_W(LOG_MODULE_WIFI, "WiFi connection failed, but credentials are valid. Skipping captive portal.\n");
     }
   }
 
@@ -360,89 +408,197 @@ bool WiFiManager::isCaptivePortal() const
 }
 
 /**
- * @brief Starts a non-blocking WiFi scan.
+ * @brief Starts a non-blocking WiFi scan, unless one is running or the last is still fresh.
+ *
+ * Every open setup page can ask for a scan; those asking within
+ * WIFI_SCAN_FRESHNESS of the last one share its results rather than taking
+ * the radio off-channel again.
+ * @return True if a scan is running; false if the last results are being kept.
  */
-void WiFiManager::startScan()
+bool WiFiManager::startScan()
 {
+  {
+    LockGuard lock(_mutex);
+    if (_scanRunning)
+    {
+      return true;
+    }
+    if (_hasScan && millis() - _scanTime < WIFI_SCAN_FRESHNESS)
+    {
+      return false;
+    }
+    _scanRunning = true;
+    _scanGeneration++;
+  }
+
   // Clear previous scan results before starting a new one.
   WiFi.scanDelete();
-  // Start a non-blocking scan.
-  // The results will be retrieved asynchronously by getScanResults().
-  WiFi.scanNetworks(true);
+  // Start a non-blocking scan. The results are taken by pollScan().
+  if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED)
+  {
+    LockGuard lock(_mutex);
+    _scanRunning = false;
+    _scanGeneration++;
+    return false;
+  }
+  return true;
 }
 
 /**
- * @brief Gets the results of a WiFi scan.
- *
- * This function is non-blocking. It checks the status of the scan and returns
- * a JSON string indicating whether the scan is "idle", "scanning", or
- * contains the results of a completed scan.
- *
- * @return A JSON formatted string with the scan status or results.
+ * @brief Takes the results of a finished scan, freeing the driver's copy.
+ * @return The scan generation.
  */
-String WiFiManager::getScanResults()
+uint32_t WiFiManager::pollScan()
 {
-  int16_t scanResult = WiFi.scanComplete();
-
-  if (scanResult == WIFI_SCAN_FAILED)
-  {
-    // Scan failed, but we don't start a new one here.
-    // We just report that the scan is not running.
-    return "{\"status\":\"idle\"}";
-  }
-  else if (scanResult == WIFI_SCAN_RUNNING)
+  LockGuard lock(_mutex);
+  if (_scanRunning)
   {
-    // Scan is in progress
-    return "{\"status\":\"scanning\"}";
+    int16_t scanResult = WiFi.scanComplete();
+    if (scanResult >= 0)
+    {
+      captureScan(scanResult);
+      WiFi.scanDelete();
+      _scanRunning = false;
+      _scanGeneration++;
+    }
+    else if (scanResult == WIFI_SCAN_FAILED)
+    {
+      _scanRunning = false;
+      _scanGeneration++;
+    }
   }
-  else
+  return _scanGeneration;
+}
+
+/**
+ * @brief Copies a finished scan into `_scanResults`, one entry per SSID. Call with `_mutex` held.
+ *
+ * Access points sharing an SSID keep the strongest; hidden networks are
+ * dropped, since they can't be picked from a list. When there are more
+ * networks than slots, the weakest go.
+ * @param count The number of networks the driver found.
+ */
+void WiFiManager::captureScan(int16_t count)
+{
+  _scanCount = 0;
+  for (int16_t i = 0; i < count; ++i)
   {
-    // Scan is complete, and we have results
-    JsonDocument doc;
-    JsonArray networks = doc.to<JsonArray>();
+    String ssid = WiFi.SSID(i);
+    if (ssid.length() == 0 || ssid.length() >= sizeof(_scanResults[0].ssid))
+    {
+      continue;
+    }
+    int8_t rssi = (int8_t)WiFi.RSSI(i);
 
-    for (int i = 0; i < scanResult; ++i)
+    int slot = -1;
+    for (int j = 0; j < _scanCount; ++j)
     {
-      JsonObject network = networks.add<JsonObject>();
-      network["ssid"] = WiFi.SSID(i);
-      network["rssi"] = WiFi.RSSI(i);
-      network["channel"] = WiFi.channel(i);
-      // Use a string for encryption type for easier parsing on the frontend
-      switch (WiFi.encryptionType(i))
+      if (strcmp(_scanResults[j].ssid, ssid.c_str()) == 0)
       {
-      case WIFI_AUTH_OPEN:
-        network["encryption"] = "OPEN";
-        break;
-      case WIFI_AUTH_WEP:
-        network["encryption"] = "WEP";
-        break;
-      case WIFI_AUTH_WPA_PSK:
-        network["encryption"] = "WPA_PSK";
-        break;
-      case WIFI_AUTH_WPA2_PSK:
-        network["encryption"] = "WPA2_PSK";
-        break;
-      case WIFI_AUTH_WPA_WPA2_PSK:
-        network["encryption"] = "WPA_WPA2_PSK";
-        break;
-      case WIFI_AUTH_WPA2_ENTERPRISE:
-        network["encryption"] = "WPA2_ENTERPRISE";
-        break;
-      case WIFI_AUTH_WPA3_PSK:
-        network["encryption"] = "WPA3_PSK";
-        break;
-      case WIFI_AUTH_WPA2_WPA3_PSK:
-        network["encryption"] = "WPA2_WPA3_PSK";
-        break;
-      default:
-        network["encryption"] = "UNKNOWN";
+        slot = j;
         break;
       }
     }
+    if (slot >= 0 && _scanResults[slot].rssi >= rssi)
+    {
+      continue; // A stronger access point of this network is already kept.
+    }
+    if (slot < 0)
+    {
+      if (_scanCount < WIFI_SCAN_MAX_RESULTS)
+      {
+        slot = _scanCount++;
+      }
+      else if (_scanResults[_scanCount - 1].rssi < rssi)
+      {
+        slot = _scanCount - 1; // Replace the weakest.
+      }
+      else
+      {
+        continue;
+      }
+      strlcpy(_scanResults[slot].ssid, ssid.c_str(), sizeof(_scanResults[slot].ssid));
+    }
+    _scanResults[slot].rssi = rssi;
+    _scanResults[slot].channel = (uint8_t)WiFi.channel(i);
+    _scanResults[slot].encryption = WiFi.encryptionType(i);
+
+    // Move the entry up to keep the list strongest first.
+    while (slot > 0 && _scanResults[slot - 1].rssi < _scanResults[slot].rssi)
+    {
+      std::swap(_scanResults[slot - 1], _scanResults[slot]);
+      slot--;
+    }
+  }
+  _hasScan = true;
+  _scanTime = millis();
+  LOG_D(LOG_MODULE_WIFI, "WiFi scan found %d access points, %u networks.\n", count, _scanCount);
+}
+
+/**
+ * @brief Gets the results of a WiFi scan.
+ *
+ * This function is non-blocking. It fills the document with a status
+ * object ("idle" or "scanning"), or with the array of networks taken from
+ * the last completed scan by pollScan().
+ *
+ * @param doc Receives the scan status or results.
+ */
+void WiFiManager::getScanResults(JsonDocument &doc)
+{
+  LockGuard lock(_mutex);
+  if (_scanRunning)
+  {
+    // Scan is in progress
+    doc["status"] = "scanning";
+    return;
+  }
+  if (!_hasScan)
+  {
+    // No scan has finished, and we don't start a new one here.
+    doc["status"] = "idle";
+    return;
+  }
 
-    String jsonOutput;
-    serializeJson(doc, jsonOutput);
-    return jsonOutput;
+  JsonArray networks = doc.to<JsonArray>();
+  for (int i = 0; i < _scanCount; ++i)
+  {
+    const ScanEntry &entry = _scanResults[i];
+    JsonObject network = networks.add<JsonObject>();
+    network["ssid"] = (const char *)entry.ssid;
+    network["rssi"] = entry.rssi;
+    network["channel"] = entry.channel;
+    // Use a string for encryption type for easier parsing on the frontend
+    switch (entry.encryption)
+    {
+    case WIFI_AUTH_OPEN:
+      network["encryption"] = "OPEN";
+      break;
+    case WIFI_AUTH_WEP:
+      network["encryption"] = "WEP";
+      break;
+    case WIFI_AUTH_WPA_PSK:
+      network["encryption"] = "WPA_PSK";
+      break;
+    case WIFI_AUTH_WPA2_PSK:
+      network["encryption"] = "WPA2_PSK";
+      break;
+    case WIFI_AUTH_WPA_WPA2_PSK:
+      network["encryption"] = "WPA_WPA2_PSK";
+      break;
+    case WIFI_AUTH_WPA2_ENTERPRISE:
+      network["encryption"] = "WPA2_ENTERPRISE";
+      break;
+    case WIFI_AUTH_WPA3_PSK:
+      network["encryption"] = "WPA3_PSK";
+      break;
+    case WIFI_AUTH_WPA2_WPA3_PSK:
+      network["encryption"] = "WPA2_WPA3_PSK";
+      break;
+    default:
+      network["encryption"] = "UNKNOWN";
+      break;
+    }
   }
 }
 
@@ -452,8 +608,7 @@ String WiFiManager::getScanResults()
 void WiFiManager::startCaptivePortal()
 {
   auto &display = Display::getInstance();
-  auto &logger = SerialLog::getInstance();
-  logger.print("\nStarting Captive Portal.\n");
+  LOG_I(LOG_MODULE_WIFI, "Starting Captive Portal.\n");
 
   // Set mode to AP + Station
   WiFi.mode(WIFI_AP_STA);
@@ -461,7 +616,7 @@ void WiFiManager::startCaptivePortal()
   // Start AP
   WiFi.softAP(AP_SSID);
   IPAddress apIP = WiFi.softAPIP();
-  logger.printf("AP IP address: %s\n", apIP.toString().c_str());
+  LOG_I(LOG_MODULE_WIFI, "AP IP address: %s\n", apIP.toString().c_str());
 
   // Start DNS Server
   _dnsServer.reset(new DNSServer());
@@ -471,13 +626,97 @@ void WiFiManager::startCaptivePortal()
   _dnsServer->start(DNS_PORT, "*", apIP);
 
   // Show a message on the display while scanning
-  logger.print("Starting background WiFi scan...\n");
+  LOG_D(LOG_MODULE_WIFI, "Starting background WiFi scan...\n");
   display.drawMultiLineStatusMessage("Please wait...", "Scanning for networks");
-  WiFi.scanDelete();       // Clear previous scan results
-  WiFi.scanNetworks(true); // true = async (non-blocking)
+  startScan();
   delay(5000);
 }
 
+/**
+ * @brief Loads the record of the last good connection.
+ * @param ssid The network about to be joined; a record for another one is ignored.
+ * @return True if there is a usable record for `ssid`, now in `_fastConnect`.
+ */
+bool WiFiManager::loadFastConnect(const String &ssid)
+{
+  Preferences preferences;
+  if (!preferences.begin(WIFI_FAST_CONNECT_NAMESPACE, true))
+  {
+    return false; // Nothing saved yet.
+  }
+  FastConnectRecord record = {};
+  size_t length = preferences.getBytes("ap", &record, sizeof(record));
+  preferences.end();
+
+  if (length != sizeof(record) || record.version != FAST_CONNECT_VERSION)
+  {
+    return false;
+  }
+  _fastConnect = record;
+  record.ssid[sizeof(record.ssid) - 1] = '\0';
+  return ssid == record.ssid && record.channel >= 1 && record.channel <= 14;
+}
+
+/**
+ * @brief Records the current connection's access point and lease, if they changed.
+ *
+ * Called from the main loop, never the WiFi event handler, since NVS writes
+ * from the WiFi task can corrupt flash.
+ * @param ssid The network joined.
+ */
+void WiFiManager::saveFastConnect(const String &ssid)
+{
+  const uint8_t *bssid = WiFi.BSSID();
+  if (bssid == nullptr || ssid.length() >= sizeof(_fastConnect.ssid))
+  {
+    return;
+  }
+
+  FastConnectRecord record;
+  memset(&record, 0, sizeof(record)); // Padding included, for the memcmp below.
+  record.version = FAST_CONNECT_VERSION;
+  strlcpy(record.ssid, ssid.c_str(), sizeof(record.ssid));
+  memcpy(record.bssid, bssid, sizeof(record.bssid));
+  record.channel = WiFi.channel();
+  record.ip = WiFi.localIP();
+  record.gateway = WiFi.gatewayIP();
+  record.subnet = WiFi.subnetMask();
+  record.dns = WiFi.dnsIP(0);
+  if (memcmp(&record, &_fastConnect, sizeof(record)) == 0)
+  {
+    return;
+  }
+
+  Preferences preferences;
+  if (!preferences.begin(WIFI_FAST_CONNECT_NAMESPACE, false))
+  {
+    return;
+  }
+  if (preferences.putBytes("ap", &record, sizeof(record)) == sizeof(record))
+  {
+    _fastConnect = record;
+    LOG_D(LOG_MODULE_WIFI, "WiFiManager: Remembered channel %u and %s for a direct connect.\n",
+          record.channel, WiFi.BSSIDstr().c_str());
+  }
+  preferences.end();
+}
+
+/**
+ * @brief Waits for the event handler to report an IP address.
+ * @param timeout The longest wait, in ms.
+ * @return True if connected in time.
+ */
+bool WiFiManager::waitForConnection(unsigned long timeout)
+{
+  unsigned long startTime = millis();
+  while (!_connectionResult && millis() - startTime < timeout)
+  {
+    delay(100);
+    LOG_V(LOG_MODULE_WIFI, ".");
+  }
+  return _connectionResult;
+}
+
 /**
  * @brief Gets the configured hostname of the device.
  * @return The hostname as a String.
@@ -514,12 +753,11 @@ void WiFiManager::startConnectionTest(const String &ssid, const String &password
   LockGuard lock(_mutex);
   if (_pendingReboot)
   {
-    SerialLog::getInstance().print("Ignoring new connection test, reboot is pending.\n");
+    LOG_W(LOG_MODULE_WIFI, "Ignoring new connection test, reboot is pending.\n");
     return;
   }
 
-  auto &logger = SerialLog::getInstance();
-  logger.printf("Starting connection test for SSID: %s\n", ssid.c_str());
+  LOG_I(LOG_MODULE_WIFI, "Starting connection test for SSID: %s\n", ssid.c_str());
 
   _testSsid = ssid;
   _testPassword = password;
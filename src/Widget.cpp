@@ -0,0 +1,316 @@
+/**
+ * @file Widget.cpp
+ * @brief Implements the retained-mode widgets and the WidgetLayer renderer.
+ */
+
+#include "Widget.h"
+#include "Display.h"
+#include "SerialLog.h"
+#include <cstdarg>
+#include <cstring>
+
+void Widget::setBackground(uint16_t bg)
+{
+  if (bg != _bg)
+  {
+    _bg = bg;
+    _dirty = true;
+  }
+}
+
+// --- LabelWidget ---
+
+void LabelWidget::setText(const char *text)
+{
+  if (strncmp(_text, text, MAX_TEXT - 1) != 0)
+  {
+    strncpy(_text, text, MAX_TEXT - 1);
+    _text[MAX_TEXT - 1] = '\0';
+    _dirty = true;
+  }
+}
+
+void LabelWidget::setTextf(const char *format, ...)
+{
+  char buf[MAX_TEXT];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  setText(buf);
+}
+
+void LabelWidget::setColor(uint16_t color)
+{
+  if (color != _color)
+  {
+    _color = color;
+    _dirty = true;
+  }
+}
+
+void LabelWidget::setFont(uint8_t font)
+{
+  if (font != _font || _smoothFont != FONT_COUNT)
+  {
+    _font = font;
+    _smoothFont = FONT_COUNT;
+    _dirty = true;
+  }
+}
+
+void LabelWidget::setSmoothFont(FontId font)
+{
+  if (font != _smoothFont)
+  {
+    _smoothFont = font;
+    _dirty = true;
+  }
+}
+
+/**
+ * @brief Draws the text at the point of the box selected by the datum.
+ */
+void LabelWidget::draw(TFT_eSprite &sprite)
+{
+  if (_text[0] == '\0')
+  {
+    return;
+  }
+
+  // Column from datum % 3 and row from datum / 3, as in TFT_eSPI; baseline datums use the middle row.
+  int16_t ax = (_datum % 3) * _w / 2;
+  int16_t ay = (_datum > BR_DATUM ? 1 : _datum / 3) * _h / 2;
+
+  sprite.setTextColor(_color, _bg);
+  sprite.setTextDatum(_datum);
+  if (_smoothFont != FONT_COUNT)
+  {
+    FontManager::getInstance().use(sprite, _smoothFont);
+    sprite.drawString(_text, ax, ay);
+  }
+  else
+  {
+    FontManager::getInstance().release(sprite);
+    sprite.drawString(_text, ax, ay, _font);
+  }
+}
+
+// --- ValueWidget ---
+
+void ValueWidget::setValue(float value, uint8_t decimals)
+{
+  char buf[sizeof(_value)];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+  if (strcmp(buf, _value) != 0)
+  {
+    strcpy(_value, buf);
+    _dirty = true;
+  }
+}
+
+void ValueWidget::setUnit(const char *unit, bool degree, uint8_t gap)
+{
+  if (strncmp(_unit, unit, sizeof(_unit) - 1) != 0 || degree != _degree || gap != _gap)
+  {
+    strncpy(_unit, unit, sizeof(_unit) - 1);
+    _unit[sizeof(_unit) - 1] = '\0';
+    _degree = degree;
+    _gap = gap;
+    _dirty = true;
+  }
+}
+
+void ValueWidget::setColor(uint16_t color)
+{
+  if (color != _color)
+  {
+    _color = color;
+    _dirty = true;
+  }
+}
+
+void ValueWidget::setFonts(uint8_t valueFont, uint8_t unitFont, uint8_t degreeRadius)
+{
+  if (valueFont != _valueFont || unitFont != _unitFont || degreeRadius != _degreeRadius)
+  {
+    _valueFont = valueFont;
+    _unitFont = unitFont;
+    _degreeRadius = degreeRadius;
+    _dirty = true;
+  }
+}
+
+/**
+ * @brief Lays out value, degree mark and unit as one horizontally centered group.
+ */
+void ValueWidget::draw(TFT_eSprite &sprite)
+{
+  if (_value[0] == '\0')
+  {
+    return;
+  }
+
+  FontManager::getInstance().release(sprite);
+  int16_t valueW = sprite.textWidth(_value, _valueFont);
+  int16_t unitW = _unit[0] ? sprite.textWidth(_unit, _unitFont) : 0;
+  int16_t markW = _degree ? _degreeRadius * 2 + _gap : 0;
+  int16_t totalW = valueW + ((_unit[0] || _degree) ? _gap : 0) + markW + unitW;
+
+  int16_t x = (_w - totalW) / 2;
+  int16_t top = (_h - sprite.fontHeight(_valueFont)) / 2;
+
+  sprite.setTextColor(_color, _bg);
+  sprite.setTextDatum(TL_DATUM);
+  sprite.drawString(_value, x, top, _valueFont);
+  x += valueW + _gap;
+
+  if (_degree)
+  {
+    sprite.fillCircle(x + _degreeRadius, top + _degreeRadius + 1, _degreeRadius, _color);
+    x += markW;
+  }
+  if (_unit[0])
+  {
+    sprite.drawString(_unit, x, top, _unitFont);
+  }
+}
+
+// --- IconWidget ---
+
+void IconWidget::setState(int32_t state)
+{
+  if (state != _state)
+  {
+    _state = state;
+    _dirty = true;
+  }
+}
+
+void IconWidget::setColor(uint16_t color)
+{
+  if (color != _color)
+  {
+    _color = color;
+    _dirty = true;
+  }
+}
+
+void IconWidget::draw(TFT_eSprite &sprite)
+{
+  if (_drawFn != nullptr)
+  {
+    _drawFn(sprite, _w, _h, _color, _bg, _state);
+  }
+}
+
+// --- WidgetLayer ---
+
+/**
+ * @brief Constructs a new WidgetLayer. The scratch sprite is created by `begin()`.
+ * @param tft A pointer to the TFT_eSPI driver instance.
+ */
+WidgetLayer::WidgetLayer(TFT_eSPI *tft) : _sprite(tft, 16)
+{
+}
+
+WidgetLayer::~WidgetLayer()
+{
+  release();
+}
+
+bool WidgetLayer::add(Widget &widget)
+{
+  if (_count >= MAX_WIDGETS)
+  {
+    LOG_W(LOG_MODULE_DISPLAY, "WidgetLayer: too many widgets.\n");
+    return false;
+  }
+  if (_sprite.created() && (widget.width() > _spriteW || widget.height() > _spriteH))
+  {
+    LOG_W(LOG_MODULE_DISPLAY, "WidgetLayer: %dx%d widget added after begin() does not fit.\n", widget.width(), widget.height());
+    return false;
+  }
+  _widgets[_count++] = &widget;
+  _spriteW = max(_spriteW, widget.width());
+  _spriteH = max(_spriteH, widget.height());
+  return true;
+}
+
+/**
+ * @brief Creates the scratch sprite, sized to the widgets added so far.
+ * @return False if there was no memory for it; `render()` then draws nothing.
+ */
+bool WidgetLayer::begin()
+{
+  if (_sprite.created())
+  {
+    return true;
+  }
+  if (_spriteW <= 0 || _spriteH <= 0 || _sprite.createSprite(_spriteW, _spriteH) == nullptr)
+  {
+    LOG_E(LOG_MODULE_DISPLAY, "WidgetLayer: no memory for a %dx%d sprite, %d widgets will not be drawn.\n",
+          _spriteW, _spriteH, _count);
+    return false;
+  }
+  return true;
+}
+
+void WidgetLayer::drawUnavailable(TFT_eSPI &tft, uint16_t bg)
+{
+  tft.fillScreen(bg);
+  tft.setTextColor(TFT_RED, bg);
+  tft.setTextDatum(MC_DATUM);
+  tft.drawString("Not enough memory for this page", tft.width() / 2, tft.height() / 2, 4);
+}
+
+void WidgetLayer::setBackground(uint16_t bg)
+{
+  for (int i = 0; i < _count; i++)
+  {
+    _widgets[i]->setBackground(bg);
+  }
+}
+
+void WidgetLayer::invalidateAll()
+{
+  for (int i = 0; i < _count; i++)
+  {
+    _widgets[i]->invalidate();
+  }
+}
+
+void WidgetLayer::release()
+{
+  FontManager::getInstance().release(_sprite);
+}
+
+/**
+ * @brief Redraws each dirty widget into the scratch sprite and pushes its box.
+ *
+ * The push copies the pixels into the display's DMA buffers before returning,
+ * so the same sprite can be reused for the next widget straight away.
+ */
+int WidgetLayer::render()
+{
+  int drawn = 0;
+  if (!_sprite.created())
+  {
+    return 0;
+  }
+  for (int i = 0; i < _count; i++)
+  {
+    Widget &widget = *_widgets[i];
+    if (!widget.isDirty())
+    {
+      continue;
+    }
+
+    _sprite.fillRect(0, 0, widget.width(), widget.height(), widget.background());
+    widget.draw(_sprite);
+    Display::getInstance().pushSprite(_sprite, widget.x(), widget.y(), 0, 0, widget.width(), widget.height());
+    widget.markClean();
+    drawn++;
+  }
+  return drawn;
+}
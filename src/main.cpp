@@ -18,6 +18,7 @@
 #include "ConfigManager.h"
 #include "AlarmManager.h"
 #include "SensorModule.h"
+#include "I2cBus.h"
 #include "Display.h"
 #include "TimeManager.h"
 #include "WiFiManager.h"
@@ -26,12 +27,18 @@
 #include "pages/InfoPage.h"
 #include "pages/WeatherPage.h"
 #include "pages/WeatherClockPage.h"
+#include "pages/ForecastPage.h"
 #include "ClockWebServer.h"
 #include "SerialLog.h"
+#include "LogStore.h"
 #include <LittleFS.h>
 #include "ButtonManager.h"
 #include "WeatherService.h"
 #include "UpdateManager.h"
+#include "HttpsClient.h"
+#include "Telemetry.h"
+#include "LoopProfiler.h"
+#include "PowerManager.h"
 #include <esp_task_wdt.h>
 #if __has_include("version.h")
 // This file exists, so we'll include it.
@@ -43,14 +50,6 @@
 
 volatile bool g_alarm_triggered = false;
 
-// --- Global Variables for Timers & Button Handling ---
-unsigned long g_lastLoopTime = 0;
-unsigned long g_bootButtonPressTime = 0;
-
-// --- Button State for Alarm Handling ---
-static unsigned long s_alarmButtonPressTime = 0;
-static bool s_actionTaken = false;
-
 enum AlarmState
 {
   IDLE,
@@ -60,9 +59,11 @@ enum AlarmState
 AlarmState g_alarmState = IDLE;
 
 ButtonManager snoozeButton(SNOOZE_BUTTON_PIN);
+ButtonManager bootButton(BOOT_BUTTON_PIN);
 
 // --- Task Handles ---
 TaskHandle_t g_logicTaskHandle = NULL;
+TaskHandle_t g_loopTaskHandle = NULL; ///< The Arduino loop task, woken early by ISRs.
 
 /**
  * @brief Updates the global alarm state based on the current system status.
@@ -71,7 +72,7 @@ TaskHandle_t g_logicTaskHandle = NULL;
  * should be in the IDLE, RINGING, or SNOOZED state. It checks the
  * AlarmManager and the configuration to make the decision.
  */
-void updateAlarmState(const std::vector<Alarm> &alarms)
+void updateAlarmState(const AlarmSummary &alarms)
 {
   auto &alarmManager = AlarmManager::getInstance();
   AlarmState oldState = g_alarmState;
@@ -85,34 +86,29 @@ void updateAlarmState(const std::vector<Alarm> &alarms)
   }
   else
   {
-    bool anySnoozed = false;
-    for (const auto &alarm : alarms)
-    {
-      if (alarm.isSnoozed())
-      {
-        anySnoozed = true;
-        break;
-      }
-    }
-    newState = anySnoozed ? SNOOZED : IDLE;
+    newState = alarms.anySnoozed ? SNOOZED : IDLE;
   }
 
   // --- Handle State Transitions ---
   if (newState != oldState)
   {
     g_alarmState = newState; // Update the global state
-    SerialLog::getInstance().printf("Alarm state changed from %d to %d\n", oldState, newState);
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Alarm state changed from %d to %d\n", oldState, newState);
+    DisplayManager::getInstance().requestRender(RENDER_EVENT_ALARM);
 
-    // When moving to a state that requires polling, detach the interrupt.
-    // When returning to IDLE, re-attach it.
-    if (newState == IDLE)
-    {
-      snoozeButton.attach();
-    }
-    else
+    // A long press dismisses a ringing alarm or ends a snooze; when idle
+    // every press just cycles pages.
+    switch (newState)
     {
-      snoozeButton.detach();
-      snoozeButton.clearNewPress(); // Ensure no stale presses are carried over
+    case RINGING:
+      snoozeButton.setLongPressTime(ConfigManager::getInstance().getDismissDuration() * 1000);
+      break;
+    case SNOOZED:
+      snoozeButton.setLongPressTime(SNOOZE_DISMISS_HOLD_TIME);
+      break;
+    case IDLE:
+      snoozeButton.setLongPressTime(0);
+      break;
     }
   }
 }
@@ -121,6 +117,17 @@ void updateAlarmState(const std::vector<Alarm> &alarms)
 void IRAM_ATTR onAlarm()
 {
   g_alarm_triggered = true;
+
+  // Wake loop() so the alarm is handled without waiting out LOOP_INTERVAL.
+  if (g_loopTaskHandle != NULL)
+  {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(g_loopTaskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken)
+    {
+      portYIELD_FROM_ISR();
+    }
+  }
 }
 
 /**
@@ -131,8 +138,7 @@ void IRAM_ATTR onAlarm()
  */
 void triggerFactoryReset(const char *source, bool needsConfigInit)
 {
-  auto &logger = SerialLog::getInstance();
-  logger.printf("Factory reset triggered by %s.\n", source);
+  LOG_I(LOG_MODULE_SYSTEM, "Factory reset triggered by %s.\n", source);
 
   // Attempt to show a message on the display.
   Display::getInstance().drawStatusMessage("Resetting...");
@@ -148,32 +154,157 @@ void triggerFactoryReset(const char *source, bool needsConfigInit)
 }
 
 /**
- * @brief Handles the boot button check for factory reset during runtime.
+ * @brief Handles the boot button gestures: holding it triggers a factory reset.
+ * @param now The current millis().
  */
-void handleBootButton()
+void handleBootButton(unsigned long now)
 {
-  if (digitalRead(BOOT_BUTTON_PIN) == LOW)
+  ButtonGesture gesture;
+  while (bootButton.nextGesture(now, gesture))
   {
-    if (g_bootButtonPressTime == 0)
+    switch (gesture.type)
     {
-      // Button was just pressed
-      g_bootButtonPressTime = millis();
-      SerialLog::getInstance().print("Boot button pressed. Timer started for factory reset...\n");
+    case BUTTON_GESTURE_PRESS:
+      LOG_I(LOG_MODULE_SYSTEM, "Boot button pressed. Timer started for factory reset...\n");
+      break;
+    case BUTTON_GESTURE_LONG:
+      // Button has been held for FACTORY_RESET_HOLD_TIME
+      triggerFactoryReset("boot button", false);
+      break;
+    case BUTTON_GESTURE_SHORT:
+      // Button was released before the reset
+      LOG_I(LOG_MODULE_SYSTEM, "Boot button released. Factory reset cancelled.\n");
+      break;
+    default:
+      break;
     }
-    else if (millis() - g_bootButtonPressTime > FACTORY_RESET_HOLD_TIME)
+  }
+}
+
+/**
+ * @brief Acts on a snooze button gesture while an alarm is ringing.
+ *
+ * A short press snoozes the alarm; holding it for the dismiss duration
+ * dismisses it, with a progress bar while it is held.
+ * @param gesture The gesture.
+ */
+void handleRingingGesture(const ButtonGesture &gesture)
+{
+  auto &alarmManager = AlarmManager::getInstance();
+  auto &config = ConfigManager::getInstance();
+  auto &displayManager = DisplayManager::getInstance();
+
+  switch (gesture.type)
+  {
+  case BUTTON_GESTURE_PRESS:
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Alarm active: Button press detected.\n");
+    break;
+
+  case BUTTON_GESTURE_HOLD:
+  {
+    // Update the progress bar while the button is held
+    unsigned long dismissDurationMs = config.getDismissDuration() * 1000;
+    displayManager.setDismissProgress((float)gesture.heldMs / dismissDurationMs);
+    displayManager.requestRender(RENDER_EVENT_BUTTON);
+    break;
+  }
+
+  case BUTTON_GESTURE_LONG:
+  case BUTTON_GESTURE_SHORT:
+  {
+    bool dismiss = gesture.type == BUTTON_GESTURE_LONG;
+    if (dismiss)
     {
-      // Button has been held for 30 seconds
-      triggerFactoryReset("boot button", false);
+      LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Alarm active: Button held. Dismissing.\n");
+    }
+    else
+    {
+      LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Alarm active: Button released. Snoozing.\n");
     }
+    int alarmId = alarmManager.getActiveAlarmId();
+    if (alarmId != -1)
+    {
+      Alarm alarm = config.getAlarmById(alarmId);
+      if (alarm.getId() != 255)
+      {
+        if (dismiss)
+        {
+          alarm.dismiss(TimeManager::getInstance().getRTCTime());
+        }
+        else
+        {
+          alarm.snooze(config.getSnoozeDuration());
+        }
+        config.setAlarmById(alarmId, alarm);
+        config.save();
+      }
+      alarmManager.stop();
+
+      // Reset the progress bar and then force a full render update
+      // to show the new snooze state and ensure the progress bar is cleared.
+      displayManager.setDismissProgress(0.0f);
+      displayManager.requestRender(RENDER_EVENT_ALARM);
+    }
+    break;
   }
-  else
+
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Acts on a snooze button gesture while an alarm is snoozed.
+ *
+ * Holding the button for SNOOZE_DISMISS_HOLD_TIME ends the snooze of every
+ * snoozed alarm, with a progress bar while it is held.
+ * @param gesture The gesture.
+ */
+void handleSnoozedGesture(const ButtonGesture &gesture)
+{
+  auto &config = ConfigManager::getInstance();
+  auto &displayManager = DisplayManager::getInstance();
+
+  switch (gesture.type)
+  {
+  case BUTTON_GESTURE_PRESS:
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Snooze active: Button press detected.\n");
+    break;
+
+  case BUTTON_GESTURE_HOLD:
+    // Update the progress bar while the button is held
+    displayManager.setDismissProgress((float)gesture.heldMs / SNOOZE_DISMISS_HOLD_TIME);
+    displayManager.requestRender(RENDER_EVENT_BUTTON);
+    break;
+
+  case BUTTON_GESTURE_LONG:
   {
-    if (g_bootButtonPressTime > 0)
+    LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_ALARM, "Snooze active: Button held. Ending snooze.\n");
+    // Use a fresh copy here since we need to mutate and save
+    std::vector<Alarm> snoozedAlarms = config.getAllAlarms();
+    for (auto &alarm : snoozedAlarms)
     {
-      // Button was released before the 60-second mark
-      SerialLog::getInstance().print("Boot button released. Factory reset cancelled.\n");
-      g_bootButtonPressTime = 0;
+      if (alarm.isSnoozed())
+      {
+        alarm.dismiss(TimeManager::getInstance().getRTCTime());
+        config.setAlarmById(alarm.getId(), alarm);
+      }
     }
+    config.save();
+
+    // Force the alarm sprite to re-render, which will now be empty
+    displayManager.requestRender(RENDER_EVENT_ALARM);
+    break;
+  }
+
+  case BUTTON_GESTURE_RELEASE:
+    // Whatever happened, the progress bar goes away.
+    displayManager.setDismissProgress(0.0f);
+    displayManager.requestRender(RENDER_EVENT_BUTTON);
+    break;
+
+  default:
+    break;
   }
 }
 
@@ -185,7 +316,7 @@ void handleBootButton()
  */
 void logicTask(void *pvParameters)
 {
-  SerialLog::getInstance().print("Logic Task started on Core 0\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Logic Task started on Core 0\n");
   esp_task_wdt_add(NULL); // Add this task to the WDT
 
   auto &wifiManager = WiFiManager::getInstance();
@@ -196,37 +327,52 @@ void logicTask(void *pvParameters)
   for (;;)
   {
     // Handle WiFi
-    wifiManager.handleDns();
-    wifiManager.handleConnection();
+    {
+      LOOP_PROFILE_SCOPE(LOOP_SCOPE_WIFI);
+      wifiManager.handleDns();
+      wifiManager.handleConnection();
+    }
 
     if (!UpdateManager::getInstance().isUpdateInProgress())
     {
-      config.loop();
+      {
+        LOOP_PROFILE_SCOPE(LOOP_SCOPE_CONFIG);
+        config.loop();
+      }
+      LOOP_PROFILE_SCOPE(LOOP_SCOPE_WEATHER);
       weatherService.loop();
     }
+    HttpsClient::getInstance().closeIdle();
 
     if (!UpdateManager::getInstance().isUpdateInProgress() && wifiManager.isConnected())
     {
+      LOOP_PROFILE_SCOPE(LOOP_SCOPE_NTP);
       timeManager.updateNtp();
       timeManager.checkDailySync();
       timeManager.checkDriftAndResync();
     }
 
-    // Handle Serial Log (WebSocket updates etc)
-    SerialLog::getInstance().loop();
+    // Push changed state to /api/events subscribers
+    {
+      LOOP_PROFILE_SCOPE(LOOP_SCOPE_EVENTS);
+      ClockWebServer::getInstance().publishEvents();
+    }
+
+    // Sample task CPU, stacks and heaps for /api/system/perf
+    Telemetry::getInstance().loop();
 
     // Log heap every minute to track stability and fragmentation
     static unsigned long lastHeapLog = 0;
     if (millis() - lastHeapLog > 60000)
     {
-      SerialLog::getInstance().printf(
-          "Logic Task Heartbeat - Free: %u | Min: %u | MaxAlloc: %u\n",
-          ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+      LOG_D(LOG_MODULE_SYSTEM,
+            "Logic Task Heartbeat - Free: %u | Min: %u | MaxAlloc: %u\n",
+            ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
       lastHeapLog = millis();
     }
 
-    // Yield to prevent watchdog triggers
-    vTaskDelay(pdMS_TO_TICKS(10));
+    // Sleep between passes, so the CPU can idle; the DNS server needs answering sooner.
+    vTaskDelay(pdMS_TO_TICKS(wifiManager.isCaptivePortal() ? LOGIC_TASK_PORTAL_INTERVAL : LOGIC_TASK_INTERVAL));
     esp_task_wdt_reset(); // Feed the watchdog
   }
 }
@@ -238,7 +384,6 @@ void setup()
 {
   Serial.begin(115200);
   pinMode(SNOOZE_BUTTON_PIN, INPUT_PULLUP); // Use Snooze button for boot-time reset
-  auto &logger = SerialLog::getInstance();
 
   // Initialize LittleFS
   if (!LittleFS.begin(true))
@@ -248,10 +393,11 @@ void setup()
   else
   {
     Serial.println("LittleFS Mounted Successfully");
+    LogStore::getInstance().begin();
   }
 
   // Log the reset reason immediately after FS mount
-  logger.logResetReason();
+  SerialLog::getInstance().logResetReason();
 
   // Initialize Task Watchdog Timer (TWDT)
   // 30 seconds timeout, true = panic (reset) on timeout
@@ -261,8 +407,14 @@ void setup()
   bool displayInitialized = false;
 
   // Initialize ConfigManager.
-  logger.print("Initializing ConfigManager...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing ConfigManager...\n");
   ConfigManager::getInstance().begin();
+  {
+    static const char *const LOAD_SOURCES[] = {"defaults", "settings blob", "per-key settings"};
+    ConfigLoadStats loadStats = ConfigManager::getInstance().getLoadStats();
+    LOG_I(LOG_MODULE_SYSTEM, "Config loaded from %s in %lu.%03lu ms\n", LOAD_SOURCES[loadStats.source],
+          (unsigned long)(loadStats.durationUs / 1000), (unsigned long)(loadStats.durationUs % 1000));
+  }
 
   // Check for crash/panic reset and display warning in dev builds
   esp_reset_reason_t reason = esp_reset_reason();
@@ -274,7 +426,7 @@ void setup()
     display.drawMultiLineStatusMessage("CRASH DETECTED", "SAFE MODE...");
 
     // Init minimal systems for logs
-    SerialLog::getInstance().print("Entering Crash Safe Mode...\n");
+    LOG_I(LOG_MODULE_SYSTEM, "Entering Crash Safe Mode...\n");
 
     // Init WiFi
     WiFiManager::getInstance().begin();
@@ -288,7 +440,6 @@ void setup()
     while (true)
     {
       WiFiManager::getInstance().handleConnection();
-      SerialLog::getInstance().loop();
 
       if (WiFi.status() == WL_CONNECTED && !ipDisplayed)
       {
@@ -317,7 +468,7 @@ void setup()
       displayInitialized = true;
     }
 
-    logger.print("Snooze button held. Checking for factory reset...\n");
+    LOG_I(LOG_MODULE_SYSTEM, "Snooze button held. Checking for factory reset...\n");
     display.drawStatusMessage("Hold for factory reset");
 
     unsigned long pressStartTime = millis();
@@ -332,7 +483,7 @@ void setup()
     }
 
     // If the button was released before the 10-second mark, cancel and proceed.
-    logger.print("Snooze button released. Factory reset cancelled.\n");
+    LOG_I(LOG_MODULE_SYSTEM, "Snooze button released. Factory reset cancelled.\n");
     display.drawStatusMessage("Reset cancelled");
     delay(SETUP_CANCEL_DELAY);
   }
@@ -343,43 +494,53 @@ void setup()
   {
     display.begin();
   }
-  pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP); // BOOT button is used for run-time reset
 
-  logger.print("\n\n--- ESP32 Clock Booting Up ---\n");
+  LOG_I(LOG_MODULE_SYSTEM, "--- ESP32 Clock Booting Up ---\n");
+
+  // loop() runs in the same task as setup(); ISRs use this handle to wake it.
+  g_loopTaskHandle = xTaskGetCurrentTaskHandle();
 
   // Initialize the snooze button interrupt
-  logger.print("Initializing Snooze Button...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing Snooze Button...\n");
+  snoozeButton.setNotifyTask(g_loopTaskHandle);
   snoozeButton.begin();
 
+  // The BOOT button is used for run-time reset
+  bootButton.setLongPressTime(FACTORY_RESET_HOLD_TIME);
+  bootButton.setNotifyTask(g_loopTaskHandle);
+  bootButton.begin();
+
   // Initialize the RTC alarm interrupt
-  logger.print("Initializing RTC Interrupt...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing RTC Interrupt...\n");
   pinMode(RTC_INT_PIN, INPUT_PULLUP);
   attachInterrupt(digitalPinToInterrupt(RTC_INT_PIN), onAlarm, FALLING);
 
   // Initialize the Alarm Manager
-  logger.print("Initializing AlarmManager...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing AlarmManager...\n");
   AlarmManager::getInstance().begin();
 
   // Initialize Weather Service
-  logger.print("Initializing WeatherService...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing WeatherService...\n");
   WeatherService::getInstance().begin();
 
   auto &displayManager = DisplayManager::getInstance();
-  logger.print("Initializing DisplayManager...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing DisplayManager...\n");
   displayManager.begin(display.getTft());
   display.drawStatusMessage("Initializing...");
 
   // Add a delay before initializing sensors to allow hardware to stabilize.
-  logger.print("Waiting for hardware to stabilize...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Waiting for hardware to stabilize...\n");
   delay(500);
 
-  logger.print("Initializing Sensors...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing Sensors...\n");
   setupSensors();
+  // From here on the bus task reads the sensors and makes queued RTC writes.
+  I2cBus::getInstance().startTask();
 
   // --- Critical Hardware Checks ---
   if (!isRtcFound())
   {
-    logger.print("CRITICAL: RTC module not found. Halting execution.\n");
+    LOG_E(LOG_MODULE_SYSTEM, "CRITICAL: RTC module not found. Halting execution.\n");
     displayManager.showErrorScreen("RTC MODULE NOT FOUND");
     while (1)
     {
@@ -388,28 +549,29 @@ void setup()
   }
 
   // Initialize WiFi. This will connect or start an AP.
-  logger.print("Initializing WiFiManager...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Initializing WiFiManager...\n");
   bool captivePortalStarted = WiFiManager::getInstance().begin();
 
   // If captive portal is active, enable it on the web server.
   if (captivePortalStarted)
   {
-    logger.print("Captive Portal is active. Enabling on web server.\n");
+    LOG_I(LOG_MODULE_SYSTEM, "Captive Portal is active. Enabling on web server.\n");
     ClockWebServer::getInstance().enableCaptivePortal();
   }
 
   // Start the web server.
-  logger.print("Starting Web Server...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Starting Web Server...\n");
   ClockWebServer::getInstance().begin();
 
   delay(WEB_SERVER_STABILIZATION_DELAY); // Delay for web server stabilization.
 
   // Add pages to the manager.
-  logger.print("Adding pages to DisplayManager...\n");
+  LOG_D(LOG_MODULE_SYSTEM, "Adding pages to DisplayManager...\n");
   displayManager.addPage(std::make_unique<ClockPage>(&display.getTft()));
-  displayManager.addPage(std::make_unique<WeatherPage>());
-  displayManager.addPage(std::make_unique<InfoPage>());
+  displayManager.addPage(std::make_unique<WeatherPage>(&display.getTft()));
+  displayManager.addPage(std::make_unique<InfoPage>(&display.getTft()));
   displayManager.addPage(std::make_unique<WeatherClockPage>(&display.getTft()));
+  displayManager.addPage(std::make_unique<ForecastPage>(&display.getTft()));
 
   // --- Post-WiFi Initialization Logic ---
   auto &timeManager = TimeManager::getInstance();
@@ -418,22 +580,22 @@ void setup()
   // This takes precedence over any other mode.
   if (captivePortalStarted)
   {
-    logger.print("Captive portal is active. Displaying setup instructions.\n");
+    LOG_I(LOG_MODULE_SYSTEM, "Captive portal is active. Displaying setup instructions.\n");
     display.drawMultiLineStatusMessage("Connect to Clock-Setup", "Go to http://192.168.4.1");
   }
   // If not in captive portal mode, check for a successful connection.
   else if (WiFiManager::getInstance().isConnected())
   {
-    logger.print("WiFi connected. Syncing time...\n");
+    LOG_I(LOG_MODULE_SYSTEM, "WiFi connected. Syncing time...\n");
     display.drawStatusMessage("Syncing Time...");
     // Log RTC time validity before syncing
     if (timeManager.isTimeSet())
     {
-      logger.print("RTC time is valid.\n");
+      LOG_I(LOG_MODULE_SYSTEM, "RTC time is valid.\n");
     }
     else
     {
-      logger.print("RTC time is not set or invalid.\n");
+      LOG_W(LOG_MODULE_SYSTEM, "RTC time is not set or invalid.\n");
     }
     timeManager.begin(); // This will perform the initial NTP sync.
     displayManager.setPage(ConfigManager::getInstance().getDefaultPage());
@@ -442,7 +604,7 @@ void setup()
   // Fall back to RTC if the time is valid.
   else if (timeManager.isTimeSet())
   {
-    logger.print("WiFi connection failed. RTC time is valid. Starting in offline mode.\n");
+    LOG_W(LOG_MODULE_SYSTEM, "WiFi connection failed. RTC time is valid. Starting in offline mode.\n");
     display.drawMultiLineStatusMessage("Offline Mode", "AP: Clock-Setup");
     delay(OFFLINE_MODE_MESSAGE_DELAY); // Show the message for 5 seconds.
     displayManager.setPage(ConfigManager::getInstance().getDefaultPage());
@@ -450,10 +612,14 @@ void setup()
   // This case should rarely be hit, but as a fallback, show setup.
   else
   {
-    logger.print("WiFi connection failed and RTC not set. Displaying setup instructions.\n");
+    LOG_W(LOG_MODULE_SYSTEM, "WiFi connection failed and RTC not set. Displaying setup instructions.\n");
     display.drawMultiLineStatusMessage("Connect to Clock-Setup", "Go to http://192.168.4.1");
   }
 
+  // Every task now blocks between its passes, so the CPU can slow down.
+  LOG_D(LOG_MODULE_SYSTEM, "Enabling power management...\n");
+  PowerManager::getInstance().begin();
+
   // Create the Logic Task on Core 0
   xTaskCreatePinnedToCore(
       logicTask,
@@ -465,7 +631,11 @@ void setup()
       0 // Core 0
   );
 
-  logger.print("--- Setup Complete ---\n");
+  // Rendering is driven by its own task on Core 1, woken on each second edge
+  // and whenever loop() or another task requests a frame.
+  displayManager.startRenderTask();
+
+  LOG_I(LOG_MODULE_SYSTEM, "--- Setup Complete ---\n");
 }
 
 /**
@@ -476,14 +646,11 @@ void loop()
 {
   esp_task_wdt_reset(); // Feed the watchdog
 
-  // Implement a non-blocking delay to prevent watchdog timeouts.
+  // Block until the next interval, or until an ISR (RTC alarm, button press)
+  // wakes the task early.
+  bool wokenEarly = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOOP_INTERVAL)) != 0;
+  LOOP_PROFILE_WAKE(wokenEarly);
   unsigned long currentMillis = millis();
-  if (currentMillis - g_lastLoopTime < LOOP_INTERVAL)
-  {
-    delay(1); // Yield to other tasks.
-    return;
-  }
-  g_lastLoopTime = currentMillis;
 
   // --- Core Clock Logic (Runs regardless of WiFi connection) ---
   auto &timeManager = TimeManager::getInstance();
@@ -494,205 +661,92 @@ void loop()
 
   // Perform periodic tasks that don't require WiFi.
   // Note: Config, Weather, WiFi, and SerialLog loops are now in Logic Task (Core 0)
+  // and the RTC tick and page rendering are in the Render Task.
 
-  alarmManager.update();
-  bool timeUpdated = timeManager.update(); // Updates time from the RTC
-  if (g_alarm_triggered)
   {
-    g_alarm_triggered = false;
-    timeManager.handleAlarm();
+    LOOP_PROFILE_SCOPE(LOOP_SCOPE_ALARMS);
+    alarmManager.update();
   }
-  timeManager.updateSnoozeStates();
-  display.updateBrightness();
-  handleSensorUpdates();
-
-  // Update the current display page if the time has changed.
-  if (timeUpdated)
   {
-    displayManager.update();
+    LOOP_PROFILE_SCOPE(LOOP_SCOPE_SNOOZE);
+    if (g_alarm_triggered)
+    {
+      g_alarm_triggered = false;
+      timeManager.handleAlarm();
+    }
+    timeManager.updateSnoozeStates();
+  }
+  {
+    LOOP_PROFILE_SCOPE(LOOP_SCOPE_BRIGHTNESS);
+    display.updateBrightness();
   }
 
-  // Check if settings have changed and need a reload.
-  if (config.isDirty())
+  // React only to the kinds of settings that changed. Brightness is applied
+  // above on every pass, and network settings are read on reconnect.
   {
-    displayManager.refresh();
-    timeManager.setNextAlarms();
-    config.clearDirtyFlag();
-    SerialLog::getInstance().print("Settings changed, refreshing display.\n");
-    // Re-evaluate snooze state and update display
-    timeManager.updateSnoozeStates();
-    displayManager.update();
+    LOOP_PROFILE_SCOPE(LOOP_SCOPE_CONFIG_CHANGES);
+    static ConfigChangeCursor configChanges;
+    uint32_t changes = config.takeChanges(configChanges);
+    if (changes & (CONFIG_CHANGE_ALARMS | CONFIG_CHANGE_TIMEZONE))
+    {
+      // Reprogram the DS3231 alarms and re-evaluate the snooze state.
+      timeManager.setNextAlarms();
+      timeManager.updateSnoozeStates();
+    }
+    if (changes & (CONFIG_CHANGE_THEME | CONFIG_CHANGE_LAYOUT | CONFIG_CHANGE_FORMAT | CONFIG_CHANGE_TIMEZONE | CONFIG_CHANGE_ALARMS | CONFIG_CHANGE_WEATHER_LOCATION))
+    {
+      LOG_DEFERRED(LOG_LEVEL_INFO, LOG_MODULE_CONFIG, "Settings changed (0x%03lx), refreshing display.\n", (unsigned long)changes);
+      displayManager.refresh();
+    }
   }
 
-  // --- Cache alarm state once per loop to avoid redundant heap copies ---
-  std::vector<Alarm> alarms = config.getAllAlarms();
+  // --- Refresh the cached alarm summary only when the alarm table changed ---
+  static AlarmSummary alarms = {};
+  if (alarms.generation != config.getAlarmGeneration())
+  {
+    alarms = config.getAlarmSummary();
+  }
 
   // --- Alarm State Machine ---
+  // Timed to the end of loop(), which is all button and alarm handling.
+  LOOP_PROFILE_SCOPE(LOOP_SCOPE_ALARM_STATE);
   updateAlarmState(alarms);
 
-  // State actions
-  switch (g_alarmState)
+  // State actions. Every edge since the last pass is queued, so a quick
+  // press between passes is still seen.
+  ButtonGesture gesture;
+  while (snoozeButton.nextGesture(currentMillis, gesture))
   {
-  case RINGING:
-    // --- Polling-based logic for when an alarm is active ---
-    if (digitalRead(SNOOZE_BUTTON_PIN) == LOW)
+    switch (g_alarmState)
     {
-      // Button is currently pressed
-      if (s_alarmButtonPressTime == 0)
-      {
-        // Button was just pressed
-        s_alarmButtonPressTime = currentMillis;
-        s_actionTaken = false;
-        SerialLog::getInstance().print("Alarm active: Button press detected.\n");
-      }
-      else if (!s_actionTaken)
-      {
-        // Update the progress bar while the button is held
-        unsigned long dismissDurationMs = config.getDismissDuration() * 1000;
-        float progress = (float)(currentMillis - s_alarmButtonPressTime) / dismissDurationMs;
-        displayManager.setDismissProgress(progress);
-        displayManager.update();
-      }
+    case RINGING:
+      handleRingingGesture(gesture);
+      break;
 
-      if (!s_actionTaken && currentMillis - s_alarmButtonPressTime > (config.getDismissDuration() * 1000))
-      {
-        // Button has been held long enough, dismiss the alarm
-        SerialLog::getInstance().print("Alarm active: Button held. Dismissing.\n");
-        int alarmId = alarmManager.getActiveAlarmId();
-        if (alarmId != -1)
-        {
-          Alarm alarm = config.getAlarmById(alarmId);
-          if (alarm.getId() != 255)
-          {
-            alarm.dismiss(timeManager.getRTCTime());
-            config.setAlarmById(alarmId, alarm);
-            config.save();
-          }
-          alarmManager.stop();
-
-          // Reset the progress bar to 0 and then force a full render update
-          // to show the new snooze state and ensure the progress bar is cleared.
-          displayManager.setDismissProgress(0.0f);
-          displayManager.update();
-        }
-        s_actionTaken = true; // Ensure dismiss is only called once
-      }
-    }
-    else
-    {
-      // Button is not pressed (it's released)
-      if (s_alarmButtonPressTime > 0 && !s_actionTaken)
-      {
-        // Button was released before the dismiss action, so snooze.
-        SerialLog::getInstance().print("Alarm active: Button released. Snoozing.\n");
-        int alarmId = alarmManager.getActiveAlarmId();
-        if (alarmId != -1)
-        {
-          Alarm alarm = config.getAlarmById(alarmId);
-          if (alarm.getId() != 255)
-          {
-            alarm.snooze(config.getSnoozeDuration());
-            config.setAlarmById(alarmId, alarm);
-            config.save();
-          }
-          alarmManager.stop();
-
-          // Reset the progress bar and then force a full render update
-          // to show the new snooze state and ensure the progress bar is cleared.
-          displayManager.setDismissProgress(0.0f);
-          displayManager.update();
-        }
-      }
-      // Always reset the button timer and action flag on release.
-      s_alarmButtonPressTime = 0;
-      s_actionTaken = false;
-    }
-    break;
+    case SNOOZED:
+      handleSnoozedGesture(gesture);
+      break;
 
-  case SNOOZED:
-    // --- Polling-based logic for when an alarm is snoozed ---
-    if (digitalRead(SNOOZE_BUTTON_PIN) == LOW)
-    {
-      // Button is currently pressed
-      if (s_alarmButtonPressTime == 0)
+    case IDLE:
+      if (gesture.type == BUTTON_GESTURE_SHORT)
       {
-        // Button was just pressed
-        s_alarmButtonPressTime = currentMillis;
-        s_actionTaken = false;
-        SerialLog::getInstance().print("Snooze active: Button press detected.\n");
-      }
-      else if (!s_actionTaken)
-      {
-        // Update the progress bar while the button is held
-        float progress = (float)(currentMillis - s_alarmButtonPressTime) / 3000.0f;
-        displayManager.setDismissProgress(progress);
-        displayManager.update();
-      }
-
-      // If the button is held long enough, end the snooze for all snoozed alarms
-      if (!s_actionTaken && currentMillis - s_alarmButtonPressTime > SNOOZE_DISMISS_HOLD_TIME)
-      { // 3-second hold
-        SerialLog::getInstance().print("Snooze active: Button held. Ending snooze.\n");
-        // Use a fresh copy here since we need to mutate and save
-        std::vector<Alarm> snoozedAlarms = config.getAllAlarms();
-        for (auto &alarm : snoozedAlarms)
-        {
-          if (alarm.isSnoozed())
-          {
-            alarm.dismiss(timeManager.getRTCTime());
-            config.setAlarmById(alarm.getId(), alarm);
-          }
-        }
-        config.save();
-
-        // Force the alarm sprite to re-render, which will now be empty
-        displayManager.update();
-
-        s_actionTaken = true; // Ensure action is only called once
+        LOG_DEFERRED(LOG_LEVEL_DEBUG, LOG_MODULE_ALARM, "Button press detected. Duration: %lu ms\n", gesture.heldMs);
+        // A short press cycles pages.
+        displayManager.cyclePage();
       }
-    }
-    else
-    {
-      // Button is not pressed (it's released)
-      if (s_alarmButtonPressTime > 0)
+      else if (gesture.type == BUTTON_GESTURE_DOUBLE)
       {
-        // If the button was being held, reset the progress bar and timer.
-        displayManager.setDismissProgress(0.0f);
-        displayManager.update();
-        s_alarmButtonPressTime = 0;
+        LOG_DEFERRED(LOG_LEVEL_DEBUG, LOG_MODULE_ALARM, "Double press detected.\n");
       }
+      break;
     }
-    break;
-
-  case IDLE:
-    if (snoozeButton.newPressAvailable())
-    {
-      // --- Interrupt-based logic for normal operations (page cycling) ---
-      unsigned long duration = snoozeButton.getPressDuration();
-      snoozeButton.clearNewPress();
-
-      SerialLog::getInstance().printf("Button press detected. Duration: %lu ms\n", duration);
-      // A short press cycles pages.
-      displayManager.cyclePage();
-    }
-    break;
   }
 
-  // --- Update Alarm Icon (reuses cached alarms vector) ---
-  bool anyAlarmEnabled = false;
-  bool anyAlarmSnoozed = false;
-  for (const auto &alarm : alarms)
+  // --- Update Alarm Icon (reuses the cached alarm summary) ---
   {
-    if (alarm.isEnabled())
-    {
-      anyAlarmEnabled = true;
-      if (alarm.isSnoozed())
-      {
-        anyAlarmSnoozed = true;
-      }
-    }
+    LOOP_PROFILE_SCOPE(LOOP_SCOPE_ALARM_ICON);
+    displayManager.drawAlarmIcon(alarms.anyEnabled, alarms.anyEnabledSnoozed);
   }
-  displayManager.drawAlarmIcon(anyAlarmEnabled, anyAlarmSnoozed);
 
-  handleBootButton();
+  handleBootButton(currentMillis);
 }
@@ -0,0 +1,96 @@
+/**
+ * @file test_main.cpp
+ * @brief Unit tests for AlarmSchedule, run on the board with `pio test -f test_alarm_schedule`.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "Alarm.h"
+#include "AlarmSchedule.h"
+
+// Test builds leave src/ out, so compile the unit under test in here.
+#include "../../src/AlarmSchedule.cpp"
+
+namespace
+{
+  // Wednesday 2025-01-15 08:30:00.
+  const DateTime NOW(2025, 1, 15, 8, 30, 0);
+
+  Alarm makeAlarm(uint8_t id, bool enabled, uint8_t hour, uint8_t minute)
+  {
+    Alarm alarm;
+    alarm.setId(id);
+    alarm.setEnabled(enabled);
+    alarm.setHour(hour);
+    alarm.setMinute(minute);
+    return alarm;
+  }
+}
+
+void test_disabled_rule_has_no_ring_time()
+{
+  DateTime time;
+  AlarmSchedule::Rule rule = AlarmSchedule::ruleFor(makeAlarm(0, false, 9, 0));
+  TEST_ASSERT_FALSE(AlarmSchedule::nextRingTime(rule, NOW, time));
+}
+
+void test_enabled_rule_rings_later_today()
+{
+  DateTime time;
+  AlarmSchedule::Rule rule = AlarmSchedule::ruleFor(makeAlarm(0, true, 9, 0));
+  TEST_ASSERT_TRUE(AlarmSchedule::nextRingTime(rule, NOW, time));
+  TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 15, 9, 0, 0).unixtime(), time.unixtime());
+}
+
+void test_disabled_alarm_is_not_scheduled()
+{
+  std::vector<Alarm> alarms = {makeAlarm(0, false, 7, 0), makeAlarm(1, true, 9, 0)};
+  AlarmSchedule schedule;
+  schedule.sync(alarms, NOW);
+
+  TEST_ASSERT_EQUAL(1, schedule.size());
+  std::vector<NextAlarmTime> next = schedule.next(2);
+  TEST_ASSERT_EQUAL(1, next.size());
+  TEST_ASSERT_EQUAL_UINT8(1, next[0].id);
+  TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 15, 9, 0, 0).unixtime(), next[0].time.unixtime());
+
+  // Advancing past the enabled alarm must not bring the disabled one back.
+  schedule.advance(DateTime(2025, 1, 15, 9, 0, 30));
+  next = schedule.next(2);
+  TEST_ASSERT_EQUAL(1, next.size());
+  TEST_ASSERT_EQUAL_UINT8(1, next[0].id);
+  TEST_ASSERT_EQUAL_UINT32(DateTime(2025, 1, 16, 9, 0, 0).unixtime(), next[0].time.unixtime());
+}
+
+void test_enabling_an_alarm_schedules_it()
+{
+  std::vector<Alarm> alarms = {makeAlarm(0, false, 7, 0), makeAlarm(1, true, 9, 0)};
+  AlarmSchedule schedule;
+  schedule.sync(alarms, NOW);
+
+  alarms[0].setEnabled(true);
+  schedule.sync(alarms, NOW);
+
+  std::vector<NextAlarmTime> next = schedule.next(2);
+  TEST_ASSERT_EQUAL(2, next.size());
+  TEST_ASSERT_EQUAL_UINT8(1, next[0].id); // 09:00 today
+  TEST_ASSERT_EQUAL_UINT8(0, next[1].id); // 07:00 tomorrow
+
+  alarms[0].setEnabled(false);
+  schedule.sync(alarms, NOW);
+  TEST_ASSERT_EQUAL(1, schedule.size());
+}
+
+void setup()
+{
+  delay(2000); // Give the serial monitor time to attach.
+  UNITY_BEGIN();
+  RUN_TEST(test_disabled_rule_has_no_ring_time);
+  RUN_TEST(test_enabled_rule_rings_later_today);
+  RUN_TEST(test_disabled_alarm_is_not_scheduled);
+  RUN_TEST(test_enabling_an_alarm_schedules_it);
+  UNITY_END();
+}
+
+void loop()
+{
+}